@@ -148,6 +148,94 @@ int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
                     unsigned char *output );
 #endif /* MBEDTLS_CIPHER_MODE_CBC */
 
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+/**
+ * \brief          AES-XTS context structure
+ *
+ *                 XTS uses two separate AES schedules: one for encrypting
+ *                 or decrypting the data and one for encrypting the tweak.
+ */
+typedef struct
+{
+    mbedtls_aes_context crypt;  /*!<  AES context for the data          */
+    mbedtls_aes_context tweak;  /*!<  AES context for the tweak         */
+}
+mbedtls_aes_xts_context;
+
+/**
+ * \brief          Initialize AES-XTS context
+ *
+ * \param ctx      AES-XTS context to be initialized
+ */
+void mbedtls_aes_xts_init( mbedtls_aes_xts_context *ctx );
+
+/**
+ * \brief          Clear AES-XTS context
+ *
+ * \param ctx      AES-XTS context to be cleared
+ */
+void mbedtls_aes_xts_free( mbedtls_aes_xts_context *ctx );
+
+/**
+ * \brief          AES-XTS key schedule (encryption)
+ *
+ *                 The key is the concatenation of the data key and the
+ *                 tweak key, so keybits is twice the AES key size.
+ *
+ * \param ctx      AES-XTS context to be initialized
+ * \param key      encryption key
+ * \param keybits  must be 256 or 512
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_AES_INVALID_KEY_LENGTH
+ */
+int mbedtls_aes_xts_setkey_enc( mbedtls_aes_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits );
+
+/**
+ * \brief          AES-XTS key schedule (decryption)
+ *
+ *                 The key is the concatenation of the data key and the
+ *                 tweak key, so keybits is twice the AES key size.
+ *
+ * \param ctx      AES-XTS context to be initialized
+ * \param key      decryption key
+ * \param keybits  must be 256 or 512
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_AES_INVALID_KEY_LENGTH
+ */
+int mbedtls_aes_xts_setkey_dec( mbedtls_aes_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits );
+
+/**
+ * \brief          AES-XTS buffer encryption/decryption
+ *
+ *                 Each call processes one complete data unit (e.g. a disk
+ *                 sector); partial progress cannot be saved. The length
+ *                 must be at least 16 bytes and at most 2^20 blocks
+ *                 (NIST SP 800-38E), but need not be a multiple of the
+ *                 block size: the final partial block, if any, is handled
+ *                 with ciphertext stealing.
+ *
+ * \param ctx      AES-XTS context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param length   length of the data unit
+ * \param data_unit the number of the data unit, in little-endian byte
+ *                 order (typically the sector number)
+ * \param input    buffer holding the input data
+ * \param output   buffer holding the output data
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH
+ */
+int mbedtls_aes_crypt_xts( mbedtls_aes_xts_context *ctx,
+                           int mode,
+                           size_t length,
+                           const unsigned char data_unit[16],
+                           const unsigned char *input,
+                           unsigned char *output );
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
 #if defined(MBEDTLS_CIPHER_MODE_CFB)
 /**
  * \brief          AES-CFB128 buffer encryption/decryption.
@@ -0,0 +1,80 @@
+/**
+ * \file aesct.h
+ *
+ * \brief Constant-time bitsliced AES implementation
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_AESCT_H
+#define MBEDTLS_AESCT_H
+
+#include "aes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Constant-time AES-ECB block en(de)cryption
+ *
+ *                 Uses the round keys as expanded by the generic key
+ *                 schedule (including the equivalent inverse cipher
+ *                 schedule built by mbedtls_aes_setkey_dec()).
+ *
+ * \note           A single block costs as much as four: this entry point
+ *                 exists for the non-parallel modes, where the fixed cost
+ *                 is the price of a data-independent execution profile.
+ *
+ * \param ctx      AES context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param input    16-byte input block
+ * \param output   16-byte output block
+ *
+ * \return         0 on success (cannot fail)
+ */
+int mbedtls_aesct_crypt_ecb( mbedtls_aes_context *ctx,
+                     int mode,
+                     const unsigned char input[16],
+                     unsigned char output[16] );
+
+/**
+ * \brief          Constant-time AES-ECB en(de)cryption of four blocks
+ *
+ *                 The bitsliced representation holds four blocks, so this
+ *                 runs at four times the throughput of the single-block
+ *                 entry point. Used by the parallel modes (CTR, CBC
+ *                 decryption, XTS).
+ *
+ * \param ctx      AES context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param input    64 bytes of input data (four blocks)
+ * \param output   64 bytes of output data (four blocks)
+ *
+ * \return         0 on success (cannot fail)
+ */
+int mbedtls_aesct_crypt_ecb_x4( mbedtls_aes_context *ctx,
+                     int mode,
+                     const unsigned char input[64],
+                     unsigned char output[64] );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_AESCT_H */
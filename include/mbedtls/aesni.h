@@ -66,6 +66,26 @@ int mbedtls_aesni_crypt_ecb( mbedtls_aes_context *ctx,
                      const unsigned char input[16],
                      unsigned char output[16] );
 
+/**
+ * \brief          AES-NI AES-ECB block en(de)cryption, four blocks at once
+ *
+ *                 The four blocks are processed interleaved in order to
+ *                 keep the pipelined AES units busy; use this in modes
+ *                 where several blocks can be processed independently
+ *                 (ECB, CTR, CBC decryption).
+ *
+ * \param ctx      AES context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param input    64-byte input block
+ * \param output   64-byte output block
+ *
+ * \return         0 on success (cannot fail)
+ */
+int mbedtls_aesni_crypt_ecb_x4( mbedtls_aes_context *ctx,
+                     int mode,
+                     const unsigned char input[64],
+                     unsigned char output[64] );
+
 /**
  * \brief          GCM multiplication: c = a * b in GF(2^128)
  *
@@ -80,6 +100,23 @@ void mbedtls_aesni_gcm_mult( unsigned char c[16],
                      const unsigned char a[16],
                      const unsigned char b[16] );
 
+/**
+ * \brief          GCM multiplication over four blocks with a single
+ *                 aggregated reduction:
+ *                 x = (x + c0) * h^4 + c1 * h^3 + c2 * h^2 + c3 * h
+ *
+ * \param x        GHASH state, updated in place
+ * \param h        Powers of H: H^4, H^3, H^2, H^1, each byte-reversed
+ * \param c        Four 16-byte input blocks
+ *
+ * \note           x and c are bit strings interpreted as elements of
+ *                 GF(2^128) as per the GCM spec; the powers of H are
+ *                 prepared by the GCM key schedule.
+ */
+void mbedtls_aesni_gcm_mult4( unsigned char x[16],
+                     const unsigned char h[64],
+                     const unsigned char c[64] );
+
 /**
  * \brief           Compute decryption round keys from encryption round keys
  *
@@ -103,6 +140,23 @@ int mbedtls_aesni_setkey_enc( unsigned char *rk,
                       const unsigned char *key,
                       size_t bits );
 
+/**
+ * \brief           Perform key expansion (for decryption)
+ *
+ *                  Generates the encryption round keys internally, then
+ *                  converts them for the equivalent inverse cipher, so the
+ *                  caller doesn't need a separate encryption schedule.
+ *
+ * \param rk        Destination buffer where the round keys are written
+ * \param key       Decryption key
+ * \param bits      Key size in bits (must be 128, 192 or 256)
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_AES_INVALID_KEY_LENGTH
+ */
+int mbedtls_aesni_setkey_dec( unsigned char *rk,
+                      const unsigned char *key,
+                      size_t bits );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,111 @@
+/**
+ * \file armce.h
+ *
+ * \brief ARMv8-A Cryptography Extensions for hardware AES and GHASH
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_ARMCE_H
+#define MBEDTLS_ARMCE_H
+
+#include "aes.h"
+
+#include <stddef.h>
+
+#define MBEDTLS_ARMCE_AES      0x00000001u
+#define MBEDTLS_ARMCE_PMULL    0x00000002u
+#define MBEDTLS_ARMCE_SHA2     0x00000004u
+
+#if defined(__GNUC__) && defined(__aarch64__) && \
+    ! defined(MBEDTLS_HAVE_ARM64)
+#define MBEDTLS_HAVE_ARM64
+#endif
+
+#if defined(MBEDTLS_HAVE_ARM64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          ARMv8-CE features detection routine
+ *
+ * \param what     The feature to detect (MBEDTLS_ARMCE_AES,
+ *                 MBEDTLS_ARMCE_PMULL or MBEDTLS_ARMCE_SHA2)
+ *
+ * \return         1 if CPU has support for the feature, 0 otherwise
+ */
+int mbedtls_armce_has_support( unsigned int what );
+
+/**
+ * \brief          ARMv8-CE AES-ECB block en(de)cryption
+ *
+ *                 Uses the round keys as expanded by the generic key
+ *                 schedule: the AESD/AESIMC flow consumes the same
+ *                 equivalent-inverse-cipher schedule as the table-based
+ *                 decryption path.
+ *
+ * \param ctx      AES context
+ * \param mode     MBEDTLS_AES_ENCRYPT or MBEDTLS_AES_DECRYPT
+ * \param input    16-byte input block
+ * \param output   16-byte output block
+ *
+ * \return         0 on success (cannot fail)
+ */
+int mbedtls_armce_crypt_ecb( mbedtls_aes_context *ctx,
+                     int mode,
+                     const unsigned char input[16],
+                     unsigned char output[16] );
+
+/**
+ * \brief          GCM multiplication: c = a * b in GF(2^128), using PMULL
+ *
+ * \param c        Result
+ * \param a        First operand
+ * \param b        Second operand
+ *
+ * \note           Both operands and result are bit strings interpreted as
+ *                 elements of GF(2^128) as per the GCM spec.
+ */
+void mbedtls_armce_gcm_mult( unsigned char c[16],
+                     const unsigned char a[16],
+                     const unsigned char b[16] );
+
+/**
+ * \brief          SHA-256 compression of one or more consecutive blocks
+ *                 using the SHA256H/SHA256H2 instructions
+ *
+ *                 Also used for SHA-224, which shares the compression
+ *                 function and differs only in its initial state.
+ *
+ * \param state    SHA-256 state, eight 32-bit words, updated in place
+ * \param data     Input data, \c 64 * \p nblocks bytes
+ * \param nblocks  Number of 64-byte blocks to process
+ */
+void mbedtls_armce_sha256_process( uint32_t state[8],
+                     const unsigned char *data,
+                     size_t nblocks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_HAVE_ARM64 */
+
+#endif /* MBEDTLS_ARMCE_H */
@@ -55,6 +55,7 @@
 #define MBEDTLS_ERR_ASN1_INVALID_DATA                     -0x0068  /**< Data is invalid. (not used) */
 #define MBEDTLS_ERR_ASN1_ALLOC_FAILED                     -0x006A  /**< Memory allocation failed */
 #define MBEDTLS_ERR_ASN1_BUF_TOO_SMALL                    -0x006C  /**< Buffer too small when writing ASN.1 data structure. */
+#define MBEDTLS_ERR_ASN1_WANT_DATA                        -0x006E  /**< More input is needed to continue streamed parsing. */
 
 /* \} name */
 
@@ -157,6 +158,24 @@ typedef struct mbedtls_asn1_named_data
 }
 mbedtls_asn1_named_data;
 
+/**
+ * Cursor for pull-based parsing of DER delivered in chunks.
+ *
+ * The cursor does not copy payload data: it borrows the chunk passed to
+ * mbedtls_asn1_stream_feed() and only buffers the few header bytes of an
+ * element whose tag-length header straddles a chunk boundary.
+ */
+typedef struct mbedtls_asn1_stream
+{
+    const unsigned char *chunk; /**< Current input chunk (borrowed).        */
+    size_t chunk_len;           /**< Size of the current chunk.             */
+    size_t chunk_off;           /**< Bytes of the chunk already consumed.   */
+    unsigned char header[6];    /**< Partial tag-length header, saved when
+                                     it straddles a chunk boundary.         */
+    size_t header_len;          /**< Bytes accumulated in \c header.        */
+}
+mbedtls_asn1_stream;
+
 /**
  * \brief       Get the length of an ASN.1 element.
  *              Updates the pointer to immediately behind the length.
@@ -189,6 +208,72 @@ int mbedtls_asn1_get_tag( unsigned char **p,
                   const unsigned char *end,
                   size_t *len, int tag );
 
+/**
+ * \brief       Initialize a streaming cursor.
+ *
+ * \param ctx   The cursor to initialize
+ */
+void mbedtls_asn1_stream_init( mbedtls_asn1_stream *ctx );
+
+/**
+ * \brief       Attach the next input chunk to a streaming cursor.
+ *
+ *              Must only be called when the previous chunk (if any) has
+ *              been fully consumed, that is after a parsing call returned
+ *              MBEDTLS_ERR_ASN1_WANT_DATA or a read came up short. The
+ *              chunk is borrowed, not copied: it must stay valid until
+ *              consumed, but may be a reused network buffer since parsed
+ *              bytes are never revisited.
+ *
+ * \param ctx   The cursor
+ * \param buf   The chunk data
+ * \param len   Size of the chunk in bytes
+ */
+void mbedtls_asn1_stream_feed( mbedtls_asn1_stream *ctx,
+                               const unsigned char *buf, size_t len );
+
+/**
+ * \brief       Streamed version of mbedtls_asn1_get_tag(): get the tag
+ *              and length of the next element, checking the tag.
+ *
+ *              On MBEDTLS_ERR_ASN1_WANT_DATA the header bytes seen so far
+ *              are saved in the cursor; feed the next chunk and call again.
+ *              On MBEDTLS_ERR_ASN1_UNEXPECTED_TAG nothing is consumed, so
+ *              optional elements can be probed with successive tags just
+ *              like with the in-memory API. Entering a constructed element
+ *              leaves its contents on the stream: parse them with further
+ *              calls, using the returned length for bookkeeping.
+ *
+ * \param ctx   The cursor
+ * \param len   The variable that will receive the content length
+ * \param tag   The expected tag
+ *
+ * \return      0 if successful, MBEDTLS_ERR_ASN1_WANT_DATA if the header
+ *              runs past the current chunk, MBEDTLS_ERR_ASN1_UNEXPECTED_TAG
+ *              if tag did not match, MBEDTLS_ERR_ASN1_INVALID_LENGTH if
+ *              the length is unparseable.
+ */
+int mbedtls_asn1_stream_get_tag( mbedtls_asn1_stream *ctx,
+                                 size_t *len, int tag );
+
+/**
+ * \brief       Read up to buf_len content bytes from the stream.
+ *
+ *              Returns as many bytes as the current chunk can provide;
+ *              when the result is short of buf_len, feed the next chunk
+ *              and call again for the remainder. This is how the content
+ *              of a primitive element, or a complete sub-element to hand
+ *              to the in-memory parsers, is collected - or skipped.
+ *
+ * \param ctx   The cursor
+ * \param buf   Destination buffer, or NULL to discard the bytes
+ * \param buf_len Maximum number of bytes to consume
+ *
+ * \return      The number of bytes consumed, possibly 0
+ */
+size_t mbedtls_asn1_stream_read( mbedtls_asn1_stream *ctx,
+                                 unsigned char *buf, size_t buf_len );
+
 /**
  * \brief       Retrieve a boolean ASN.1 tag and its value.
  *              Updates the pointer to immediately behind the full tag.
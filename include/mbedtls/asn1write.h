@@ -29,10 +29,100 @@
 #define MBEDTLS_ASN1_CHK_ADD(g, f) do { if( ( ret = f ) < 0 ) return( ret ); else   \
                                 g += ret; } while( 0 )
 
+/**
+ * As MBEDTLS_ASN1_CHK_ADD(), but writing into an mbedtls_asn1_writer
+ * \c ctx: on MBEDTLS_ERR_ASN1_BUF_TOO_SMALL the writer's buffer is grown
+ * (discarding any partial write) and the call is retried. The expression
+ * \c f must address the buffer through \c (ctx)->p and \c (ctx)->buf so
+ * that the retry sees the new buffer.
+ */
+#define MBEDTLS_ASN1_CHK_ADD_GROW(g, ctx, f)                                    \
+    do {                                                                        \
+        size_t asn1_wr_mark = (size_t)( (ctx)->buf + (ctx)->size - (ctx)->p );  \
+        while( ( ret = f ) == MBEDTLS_ERR_ASN1_BUF_TOO_SMALL )                  \
+            if( ( ret = mbedtls_asn1_writer_grow( (ctx), asn1_wr_mark ) ) != 0 )\
+                return( ret );                                                  \
+        if( ret < 0 ) return( ret ); else g += ret;                             \
+    } while( 0 )
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * \brief           Growable buffer for the backwards ASN.1 writing functions.
+ *
+ *                  Data is written back-to-front between \c buf and
+ *                  \c buf + \c size, with \c p as the current position, so
+ *                  the usual writing functions can be called as
+ *                  f( &wr.p, wr.buf, ... ). When one of them runs out of
+ *                  room, mbedtls_asn1_writer_grow() moves the bytes written
+ *                  so far to the end of a larger buffer and the call can be
+ *                  retried; MBEDTLS_ASN1_CHK_ADD_GROW() does this
+ *                  automatically.
+ */
+typedef struct
+{
+    unsigned char *buf;     /*!< owned buffer, NULL until first allocation  */
+    size_t size;            /*!< total size of \c buf                       */
+    unsigned char *p;       /*!< current position, moves towards \c buf     */
+}
+mbedtls_asn1_writer;
+
+/**
+ * \brief           Initialize a writer (no buffer is allocated yet)
+ *
+ * \param ctx       writer to initialize
+ */
+void mbedtls_asn1_writer_init( mbedtls_asn1_writer *ctx );
+
+/**
+ * \brief           Allocate the writer's initial buffer. Optional: the
+ *                  buffer is otherwise allocated on the first grow.
+ *
+ * \param ctx       writer to set up
+ * \param size      initial buffer size, or 0 for the default
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_ASN1_ALLOC_FAILED
+ */
+int mbedtls_asn1_writer_setup( mbedtls_asn1_writer *ctx, size_t size );
+
+/**
+ * \brief           Enlarge the writer's buffer, preserving the \p written
+ *                  bytes at its end. Bytes below that mark (from a partial
+ *                  write) are discarded and \c p is reset to the mark.
+ *
+ * \param ctx       writer to grow
+ * \param written   number of valid bytes at the end of the buffer
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_ASN1_ALLOC_FAILED
+ */
+int mbedtls_asn1_writer_grow( mbedtls_asn1_writer *ctx, size_t written );
+
+/**
+ * \brief           Discard the written data but keep the buffer, so the
+ *                  writer can be reused without reallocating
+ *
+ * \param ctx       writer to reset
+ */
+void mbedtls_asn1_writer_reset( mbedtls_asn1_writer *ctx );
+
+/**
+ * \brief           Get the number of bytes written so far
+ *
+ * \param ctx       writer to query
+ *
+ * \return          length of the data ending at \c buf + \c size
+ */
+size_t mbedtls_asn1_writer_len( const mbedtls_asn1_writer *ctx );
+
+/**
+ * \brief           Free the writer's buffer (after wiping it)
+ *
+ * \param ctx       writer to free
+ */
+void mbedtls_asn1_writer_free( mbedtls_asn1_writer *ctx );
+
 /**
  * \brief           Write a length field in ASN.1 format
  *                  Note: function works backwards in data buffer
@@ -66,6 +66,19 @@
 #define MBEDTLS_MPI_WINDOW_SIZE                           6        /**< Maximum windows size used. */
 #endif /* !MBEDTLS_MPI_WINDOW_SIZE */
 
+#if !defined(MBEDTLS_MPI_KARATSUBA_THRESHOLD)
+/*
+ * Minimum number of limbs in both operands for mbedtls_mpi_mul_mpi() to
+ * use Karatsuba multiplication instead of the schoolbook loop.
+ * Default: 32 (2048-bit operands with 64-bit limbs)
+ *
+ * Lowering this helps large RSA/DHM operations at the cost of a scratch
+ * allocation per top-level multiplication; raising it (or setting it
+ * larger than MBEDTLS_MPI_MAX_LIMBS) restores the pure schoolbook path.
+ */
+#define MBEDTLS_MPI_KARATSUBA_THRESHOLD                   32       /**< Minimum limbs for Karatsuba. */
+#endif /* !MBEDTLS_MPI_KARATSUBA_THRESHOLD */
+
 #if !defined(MBEDTLS_MPI_MAX_SIZE)
 /*
  * Maximum size of MPIs allowed in bits and bytes for user-MPIs.
@@ -265,6 +278,20 @@ int mbedtls_mpi_lset( mbedtls_mpi *X, mbedtls_mpi_sint z );
  */
 int mbedtls_mpi_get_bit( const mbedtls_mpi *X, size_t pos );
 
+/**
+ * \brief          Get a run of bits from X in a single word-wide read
+ *
+ * \param X        MPI to use
+ * \param pos      Zero-based index of the least significant bit to get
+ * \param count    Number of bits to get, at most 8 * sizeof(mbedtls_mpi_uint)
+ *
+ * \return         The count bits of X starting at pos, with the bit at pos
+ *                 in the least significant position; bits beyond the end
+ *                 of X read as 0
+ */
+mbedtls_mpi_uint mbedtls_mpi_get_bits( const mbedtls_mpi *X, size_t pos,
+                                       size_t count );
+
 /**
  * \brief          Set a bit of X to a specific value of 0 or 1
  *
@@ -629,6 +656,32 @@ int mbedtls_mpi_mod_int( mbedtls_mpi_uint *r, const mbedtls_mpi *A, mbedtls_mpi_
  */
 int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi *E, const mbedtls_mpi *N, mbedtls_mpi *_RR );
 
+/**
+ * \brief          Interleaved double exponentiation (Shamir's trick):
+ *                 X = A1^E1 * A2^E2 mod N
+ *
+ * \param X        Destination MPI
+ * \param A1       First base MPI
+ * \param E1       First exponent MPI
+ * \param A2       Second base MPI
+ * \param E2       Second exponent MPI
+ * \param N        Modular MPI
+ * \param _RR      Speed-up MPI used for recalculations, see
+ *                 mbedtls_mpi_exp_mod()
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_MPI_ALLOC_FAILED if memory allocation failed,
+ *                 MBEDTLS_ERR_MPI_BAD_INPUT_DATA if N is negative or even or
+ *                 if E1 or E2 is negative
+ *
+ * \warning        Unlike mbedtls_mpi_exp_mod(), the exponent bits are
+ *                 scanned in variable time. Only use this with public
+ *                 values, e.g. for signature verification.
+ */
+int mbedtls_mpi_exp_mod2( mbedtls_mpi *X, const mbedtls_mpi *A1, const mbedtls_mpi *E1,
+                  const mbedtls_mpi *A2, const mbedtls_mpi *E2,
+                  const mbedtls_mpi *N, mbedtls_mpi *_RR );
+
 /**
  * \brief          Fill an MPI X with size bytes of random
  *
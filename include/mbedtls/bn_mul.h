@@ -652,6 +652,39 @@
 
 #endif /* ARMv3 */
 
+#if defined(__aarch64__)
+
+#define MULADDC_INIT                            \
+    asm(
+
+#define MULADDC_CORE                            \
+            "ldr    x4, [%2], #8    \n\t"       \
+            "ldr    x5, [%1]        \n\t"       \
+            "mul    x6, x4, %3      \n\t"       \
+            "umulh  x7, x4, %3      \n\t"       \
+            "adds   x5, x5, x6      \n\t"       \
+            "adc    x7, x7, xzr     \n\t"       \
+            "adds   x5, x5, %0      \n\t"       \
+            "adc    %0, x7, xzr     \n\t"       \
+            "str    x5, [%1], #8    \n\t"
+
+#define MULADDC_HUIT                            \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE                        \
+            MULADDC_CORE
+
+#define MULADDC_STOP                            \
+         : "+r" (c),  "+r" (d), "+r" (s)        \
+         : "r" (b)                              \
+         : "x4", "x5", "x6", "x7", "cc", "memory" );
+
+#endif /* Aarch64 */
+
 #if defined(__alpha__)
 
 #define MULADDC_INIT                    \
@@ -0,0 +1,191 @@
+/**
+ * \file byte_order.h
+ *
+ * \brief Packed integer load/store macros shared by the primitives
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_BYTE_ORDER_H
+#define MBEDTLS_BYTE_ORDER_H
+
+#include <string.h>
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_HAVE_INT32) || defined(MBEDTLS_HAVE_INT64) || 1
+#include <stdint.h>
+#endif
+
+#if ( defined(__ARMCC_VERSION) || defined(_MSC_VER) ) && !defined(inline)
+#define inline __inline
+#endif
+
+/*
+ * GET_UINT32_LE( n, b, i ) and friends read or write an integer at byte
+ * offset i of buffer b in the stated byte order, with no alignment
+ * requirement on b + i.
+ *
+ * Where the compiler advertises its byte order, the macros compile to a
+ * single (possibly unaligned) word access plus at most a byte swap: the
+ * memcpy idiom below is recognized by every toolchain we ship on and
+ * collapses to one load or store even on strict-alignment targets,
+ * instead of the four loads plus shifts of the portable fallback. The
+ * fallback keeps unknown compilers working.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MBEDTLS_BSWAP32( x )    __builtin_bswap32( x )
+#define MBEDTLS_BSWAP64( x )    __builtin_bswap64( x )
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && defined(MBEDTLS_BSWAP32)
+#define MBEDTLS_ENDIAN_LITTLE
+#elif defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ && defined(MBEDTLS_BSWAP32)
+#define MBEDTLS_ENDIAN_BIG
+#endif
+
+#if defined(MBEDTLS_ENDIAN_LITTLE) || defined(MBEDTLS_ENDIAN_BIG)
+
+static inline uint32_t mbedtls_get_unaligned_uint32( const unsigned char *p )
+{
+    uint32_t n;
+    memcpy( &n, p, sizeof( n ) );
+    return( n );
+}
+
+static inline void mbedtls_put_unaligned_uint32( unsigned char *p, uint32_t n )
+{
+    memcpy( p, &n, sizeof( n ) );
+}
+
+static inline uint64_t mbedtls_get_unaligned_uint64( const unsigned char *p )
+{
+    uint64_t n;
+    memcpy( &n, p, sizeof( n ) );
+    return( n );
+}
+
+static inline void mbedtls_put_unaligned_uint64( unsigned char *p, uint64_t n )
+{
+    memcpy( p, &n, sizeof( n ) );
+}
+
+#if defined(MBEDTLS_ENDIAN_LITTLE)
+
+#define GET_UINT32_LE( n, b, i )                                        \
+    do { (n) = mbedtls_get_unaligned_uint32( (b) + (i) ); } while( 0 )
+#define PUT_UINT32_LE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint32( (b) + (i), (uint32_t)( n ) ); } while( 0 )
+#define GET_UINT32_BE( n, b, i )                                        \
+    do { (n) = MBEDTLS_BSWAP32( mbedtls_get_unaligned_uint32( (b) + (i) ) ); } while( 0 )
+#define PUT_UINT32_BE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint32( (b) + (i), MBEDTLS_BSWAP32( (uint32_t)( n ) ) ); } while( 0 )
+#define GET_UINT64_BE( n, b, i )                                        \
+    do { (n) = MBEDTLS_BSWAP64( mbedtls_get_unaligned_uint64( (b) + (i) ) ); } while( 0 )
+#define PUT_UINT64_BE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint64( (b) + (i), MBEDTLS_BSWAP64( (uint64_t)( n ) ) ); } while( 0 )
+
+#else /* MBEDTLS_ENDIAN_LITTLE */
+
+#define GET_UINT32_LE( n, b, i )                                        \
+    do { (n) = MBEDTLS_BSWAP32( mbedtls_get_unaligned_uint32( (b) + (i) ) ); } while( 0 )
+#define PUT_UINT32_LE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint32( (b) + (i), MBEDTLS_BSWAP32( (uint32_t)( n ) ) ); } while( 0 )
+#define GET_UINT32_BE( n, b, i )                                        \
+    do { (n) = mbedtls_get_unaligned_uint32( (b) + (i) ); } while( 0 )
+#define PUT_UINT32_BE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint32( (b) + (i), (uint32_t)( n ) ); } while( 0 )
+#define GET_UINT64_BE( n, b, i )                                        \
+    do { (n) = mbedtls_get_unaligned_uint64( (b) + (i) ); } while( 0 )
+#define PUT_UINT64_BE( n, b, i )                                        \
+    do { mbedtls_put_unaligned_uint64( (b) + (i), (uint64_t)( n ) ); } while( 0 )
+
+#endif /* MBEDTLS_ENDIAN_LITTLE */
+
+#else /* MBEDTLS_ENDIAN_LITTLE || MBEDTLS_ENDIAN_BIG */
+
+/*
+ * Portable byte-by-byte fallback for compilers that do not advertise
+ * their byte order
+ */
+#define GET_UINT32_LE( n, b, i )                        \
+    do {                                                \
+        (n) = ( (uint32_t) (b)[(i)    ]       )         \
+            | ( (uint32_t) (b)[(i) + 1] <<  8 )         \
+            | ( (uint32_t) (b)[(i) + 2] << 16 )         \
+            | ( (uint32_t) (b)[(i) + 3] << 24 );        \
+    } while( 0 )
+
+#define PUT_UINT32_LE( n, b, i )                                \
+    do {                                                        \
+        (b)[(i)    ] = (unsigned char) ( ( (n)       ) & 0xFF );\
+        (b)[(i) + 1] = (unsigned char) ( ( (n) >>  8 ) & 0xFF );\
+        (b)[(i) + 2] = (unsigned char) ( ( (n) >> 16 ) & 0xFF );\
+        (b)[(i) + 3] = (unsigned char) ( ( (n) >> 24 ) & 0xFF );\
+    } while( 0 )
+
+#define GET_UINT32_BE( n, b, i )                        \
+    do {                                                \
+        (n) = ( (uint32_t) (b)[(i)    ] << 24 )         \
+            | ( (uint32_t) (b)[(i) + 1] << 16 )         \
+            | ( (uint32_t) (b)[(i) + 2] <<  8 )         \
+            | ( (uint32_t) (b)[(i) + 3]       );        \
+    } while( 0 )
+
+#define PUT_UINT32_BE( n, b, i )                        \
+    do {                                                \
+        (b)[(i)    ] = (unsigned char) ( (n) >> 24 );   \
+        (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );   \
+        (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );   \
+        (b)[(i) + 3] = (unsigned char) ( (n)       );   \
+    } while( 0 )
+
+#define GET_UINT64_BE( n, b, i )                        \
+    do {                                                \
+        (n) = ( (uint64_t) (b)[(i)    ] << 56 )         \
+            | ( (uint64_t) (b)[(i) + 1] << 48 )         \
+            | ( (uint64_t) (b)[(i) + 2] << 40 )         \
+            | ( (uint64_t) (b)[(i) + 3] << 32 )         \
+            | ( (uint64_t) (b)[(i) + 4] << 24 )         \
+            | ( (uint64_t) (b)[(i) + 5] << 16 )         \
+            | ( (uint64_t) (b)[(i) + 6] <<  8 )         \
+            | ( (uint64_t) (b)[(i) + 7]       );        \
+    } while( 0 )
+
+#define PUT_UINT64_BE( n, b, i )                        \
+    do {                                                \
+        (b)[(i)    ] = (unsigned char) ( (n) >> 56 );   \
+        (b)[(i) + 1] = (unsigned char) ( (n) >> 48 );   \
+        (b)[(i) + 2] = (unsigned char) ( (n) >> 40 );   \
+        (b)[(i) + 3] = (unsigned char) ( (n) >> 32 );   \
+        (b)[(i) + 4] = (unsigned char) ( (n) >> 24 );   \
+        (b)[(i) + 5] = (unsigned char) ( (n) >> 16 );   \
+        (b)[(i) + 6] = (unsigned char) ( (n) >>  8 );   \
+        (b)[(i) + 7] = (unsigned char) ( (n)       );   \
+    } while( 0 )
+
+#endif /* MBEDTLS_ENDIAN_LITTLE || MBEDTLS_ENDIAN_BIG */
+
+#endif /* byte_order.h */
@@ -38,9 +38,32 @@ extern "C" {
  */
 typedef struct {
     mbedtls_cipher_context_t cipher_ctx;    /*!< cipher context used */
+
+    /* Session-bound parameters, see mbedtls_ccm_bind() */
+    unsigned char bound;        /*!< nonce/tag lengths bound?              */
+    unsigned char b0_flags;     /*!< precomputed B_0 flags (add bit clear) */
+    unsigned char ctr_flags;    /*!< precomputed counter block flags       */
+    unsigned char q;            /*!< length of the message length field    */
+    unsigned char iv_len;       /*!< bound nonce length                    */
+    unsigned char tag_len;      /*!< bound tag length                      */
 }
 mbedtls_ccm_context;
 
+/**
+ * \brief          One packet of a CCM batch, see mbedtls_ccm_encrypt_batch()
+ */
+typedef struct {
+    const unsigned char *iv;    /*!< nonce, of the bound length            */
+    const unsigned char *add;   /*!< additional authenticated data         */
+    size_t add_len;             /*!< length of additional data             */
+    const unsigned char *input; /*!< input data                            */
+    size_t length;              /*!< length of the input data              */
+    unsigned char *output;      /*!< output buffer, 'length' bytes         */
+    unsigned char *tag;         /*!< tag, of the bound length: written on
+                                     encryption, read on decryption        */
+}
+mbedtls_ccm_packet;
+
 /**
  * \brief           Initialize CCM context (just makes references valid)
  *                  Makes the context ready for mbedtls_ccm_setkey() or
@@ -126,6 +149,118 @@ int mbedtls_ccm_auth_decrypt( mbedtls_ccm_context *ctx, size_t length,
                       const unsigned char *input, unsigned char *output,
                       const unsigned char *tag, size_t tag_len );
 
+/**
+ * \brief           CCM buffer encryption from scattered input, for example
+ *                  straight from application buffers into a record buffer
+ *                  without assembling the input first
+ *
+ * \param ctx       CCM context
+ * \param iov       input segments
+ * \param iov_count number of input segments
+ * \param iv        nonce (initialization vector)
+ * \param iv_len    length of IV in bytes
+ *                  must be 2, 3, 4, 5, 6, 7 or 8
+ * \param add       additional data
+ * \param add_len   length of additional data in bytes
+ *                  must be less than 2^16 - 2^8
+ * \param output    buffer for holding the output data; must be at least
+ *                  as large as the total length of the input segments,
+ *                  and must not overlap them
+ * \param tag       buffer for holding the tag
+ * \param tag_len   length of the tag to generate in bytes
+ *                  must be 4, 6, 8, 10, 14 or 16
+ *
+ * \return          0 if successful
+ */
+int mbedtls_ccm_encrypt_and_tag_iov( mbedtls_ccm_context *ctx,
+                         const mbedtls_iovec *iov, size_t iov_count,
+                         const unsigned char *iv, size_t iv_len,
+                         const unsigned char *add, size_t add_len,
+                         unsigned char *output,
+                         unsigned char *tag, size_t tag_len );
+
+/**
+ * \brief           CCM buffer authenticated decryption from scattered input
+ *
+ * \param ctx       CCM context
+ * \param iov       input segments
+ * \param iov_count number of input segments
+ * \param iv        initialization vector
+ * \param iv_len    length of IV
+ * \param add       additional data
+ * \param add_len   length of additional data
+ * \param output    buffer for holding the output data; must be at least
+ *                  as large as the total length of the input segments,
+ *                  and must not overlap them
+ * \param tag       buffer holding the tag
+ * \param tag_len   length of the tag
+ *
+ * \return         0 if successful and authenticated,
+ *                 MBEDTLS_ERR_CCM_AUTH_FAILED if tag does not match
+ */
+int mbedtls_ccm_auth_decrypt_iov( mbedtls_ccm_context *ctx,
+                      const mbedtls_iovec *iov, size_t iov_count,
+                      const unsigned char *iv, size_t iv_len,
+                      const unsigned char *add, size_t add_len,
+                      unsigned char *output,
+                      const unsigned char *tag, size_t tag_len );
+
+/**
+ * \brief           Bind nonce and tag lengths to the context
+ *
+ *                  In a session all packets share the key, nonce length and
+ *                  tag length (eg 13 and 8 for the CCM_8 TLS ciphersuites);
+ *                  binding them validates them and precomputes the B_0 and
+ *                  counter flag bytes once, so that the batch functions
+ *                  below have no per-packet parameter processing left.
+ *
+ * \param ctx       CCM context with the key already set
+ * \param iv_len    nonce length in bytes for all packets,
+ *                  must be 7, 8, 9, 10, 11, 12 or 13
+ * \param tag_len   tag length in bytes for all packets,
+ *                  must be 4, 6, 8, 10, 12, 14 or 16
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_CCM_BAD_INPUT
+ */
+int mbedtls_ccm_bind( mbedtls_ccm_context *ctx,
+                      size_t iv_len, size_t tag_len );
+
+/**
+ * \brief           Encrypt and tag an array of packets with bound parameters
+ *
+ *                  Intended for high-rate streams of small datagrams, where
+ *                  per-call setup otherwise rivals the payload crypto cost.
+ *
+ * \param ctx       CCM context with key set and mbedtls_ccm_bind() done
+ * \param pkt       packets to process; tags are written out
+ * \param count     number of packets
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_CCM_BAD_INPUT; packets
+ *                  before a failing one have been processed
+ */
+int mbedtls_ccm_encrypt_batch( mbedtls_ccm_context *ctx,
+                               const mbedtls_ccm_packet *pkt, size_t count );
+
+/**
+ * \brief           Decrypt and authenticate an array of packets with bound
+ *                  parameters
+ *
+ * \param ctx       CCM context with key set and mbedtls_ccm_bind() done
+ * \param pkt       packets to process; tags are read and checked
+ * \param count     number of packets
+ * \param done      if not NULL, set to the number of packets successfully
+ *                  processed, whatever the return value
+ *
+ * \return          0 if all packets were authentic,
+ *                  MBEDTLS_ERR_CCM_AUTH_FAILED on the first packet whose
+ *                  tag does not match (its output is zeroized, remaining
+ *                  packets are not processed),
+ *                  or MBEDTLS_ERR_CCM_BAD_INPUT
+ */
+int mbedtls_ccm_decrypt_batch( mbedtls_ccm_context *ctx,
+                               const mbedtls_ccm_packet *pkt, size_t count,
+                               size_t *done );
+
 #if defined(MBEDTLS_SELF_TEST) && defined(MBEDTLS_AES_C)
 /**
  * \brief          Checkup routine
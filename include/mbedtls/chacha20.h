@@ -0,0 +1,151 @@
+/**
+ * \file chacha20.h
+ *
+ * \brief The ChaCha20 stream cipher (RFC 7539)
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_CHACHA20_H
+#define MBEDTLS_CHACHA20_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA               -0x0054  /**< Invalid input parameter(s). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          ChaCha20 context structure
+ */
+typedef struct
+{
+    uint32_t state[16];             /*!<  cipher state (before round function) */
+    unsigned char keystream[64];    /*!<  leftover keystream bytes             */
+    size_t keystream_used;          /*!<  number of keystream bytes consumed   */
+}
+mbedtls_chacha20_context;
+
+/**
+ * \brief          Initialize ChaCha20 context
+ *
+ * \param ctx      ChaCha20 context to be initialized
+ */
+void mbedtls_chacha20_init( mbedtls_chacha20_context *ctx );
+
+/**
+ * \brief          Clear ChaCha20 context
+ *
+ * \param ctx      ChaCha20 context to be cleared
+ */
+void mbedtls_chacha20_free( mbedtls_chacha20_context *ctx );
+
+/**
+ * \brief          ChaCha20 key schedule
+ *
+ * \param ctx      ChaCha20 context to be initialized
+ * \param key      256-bit key
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA
+ */
+int mbedtls_chacha20_setkey( mbedtls_chacha20_context *ctx,
+                             const unsigned char key[32] );
+
+/**
+ * \brief          Set the nonce and initial counter, starting a new stream
+ *
+ * \note           A key must have been set with mbedtls_chacha20_setkey()
+ *                 before calling this function.
+ *
+ * \param ctx      ChaCha20 context
+ * \param nonce    96-bit nonce
+ * \param counter  initial 32-bit block counter (0 in most protocols)
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA
+ */
+int mbedtls_chacha20_starts( mbedtls_chacha20_context *ctx,
+                             const unsigned char nonce[12],
+                             uint32_t counter );
+
+/**
+ * \brief          Encrypt or decrypt data (the operations are identical)
+ *
+ *                 May be called repeatedly to process a stream in chunks
+ *                 of any size.
+ *
+ * \param ctx      ChaCha20 context
+ * \param size     length of the input data
+ * \param input    buffer holding the input data
+ * \param output   buffer for the output data (may equal input)
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA
+ */
+int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
+                             size_t size,
+                             const unsigned char *input,
+                             unsigned char *output );
+
+/**
+ * \brief          Encrypt or decrypt a buffer with a one-time key/nonce
+ *
+ *                 Convenience wrapper around setkey/starts/update using a
+ *                 temporary context.
+ *
+ * \param key      256-bit key
+ * \param nonce    96-bit nonce
+ * \param counter  initial 32-bit block counter
+ * \param size     length of the input data
+ * \param input    buffer holding the input data
+ * \param output   buffer for the output data (may equal input)
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA
+ */
+int mbedtls_chacha20_crypt( const unsigned char key[32],
+                            const unsigned char nonce[12],
+                            uint32_t counter,
+                            size_t size,
+                            const unsigned char *input,
+                            unsigned char *output );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         0 if successful, or 1 if the test failed
+ */
+int mbedtls_chacha20_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* chacha20.h */
@@ -0,0 +1,152 @@
+/**
+ * \file chachapoly.h
+ *
+ * \brief The ChaCha20-Poly1305 AEAD construction (RFC 7539)
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_CHACHAPOLY_H
+#define MBEDTLS_CHACHAPOLY_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "chacha20.h"
+#include "poly1305.h"
+
+#define MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA             -0x0053  /**< Invalid input parameter(s). */
+#define MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED                -0x0055  /**< Authenticated decryption failed: data was not authentic. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          ChaCha20-Poly1305 context structure
+ */
+typedef struct
+{
+    mbedtls_chacha20_context chacha20_ctx;  /*!<  encryption engine         */
+    mbedtls_poly1305_context poly1305_ctx;  /*!<  authenticator engine      */
+}
+mbedtls_chachapoly_context;
+
+/**
+ * \brief          Initialize ChaCha20-Poly1305 context
+ *
+ * \param ctx      context to be initialized
+ */
+void mbedtls_chachapoly_init( mbedtls_chachapoly_context *ctx );
+
+/**
+ * \brief          Clear ChaCha20-Poly1305 context
+ *
+ * \param ctx      context to be cleared
+ */
+void mbedtls_chachapoly_free( mbedtls_chachapoly_context *ctx );
+
+/**
+ * \brief          ChaCha20-Poly1305 key schedule
+ *
+ * \param ctx      context to be initialized
+ * \param key      256-bit key
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA
+ */
+int mbedtls_chachapoly_setkey( mbedtls_chachapoly_context *ctx,
+                               const unsigned char key[32] );
+
+/**
+ * \brief          Encrypt a buffer and compute its authentication tag
+ *
+ * \note           The nonce must not be used more than once with the same
+ *                 key; in TLS it is derived from the record sequence
+ *                 number.
+ *
+ * \param ctx      context holding the key
+ * \param length   length of the input data
+ * \param nonce    96-bit nonce
+ * \param aad      additional data to authenticate (may be NULL if aad_len
+ *                 is 0)
+ * \param aad_len  length of the additional data
+ * \param input    buffer holding the input data
+ * \param output   buffer for the output data (may equal input)
+ * \param tag      buffer for the 128-bit authentication tag
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA
+ */
+int mbedtls_chachapoly_encrypt_and_tag( mbedtls_chachapoly_context *ctx,
+                                        size_t length,
+                                        const unsigned char nonce[12],
+                                        const unsigned char *aad,
+                                        size_t aad_len,
+                                        const unsigned char *input,
+                                        unsigned char *output,
+                                        unsigned char tag[16] );
+
+/**
+ * \brief          Authenticate and decrypt a buffer
+ *
+ *                 The tag is checked in constant time before any plaintext
+ *                 is released; on authentication failure the output buffer
+ *                 is zeroed.
+ *
+ * \param ctx      context holding the key
+ * \param length   length of the input data
+ * \param nonce    96-bit nonce
+ * \param aad      additional authenticated data (may be NULL if aad_len
+ *                 is 0)
+ * \param aad_len  length of the additional data
+ * \param tag      128-bit authentication tag to verify
+ * \param input    buffer holding the input data
+ * \param output   buffer for the output data (may equal input)
+ *
+ * \return         0 if successful and authenticated, or
+ *                 MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED if the tag does not
+ *                 match, or
+ *                 MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA
+ */
+int mbedtls_chachapoly_auth_decrypt( mbedtls_chachapoly_context *ctx,
+                                     size_t length,
+                                     const unsigned char nonce[12],
+                                     const unsigned char *aad,
+                                     size_t aad_len,
+                                     const unsigned char tag[16],
+                                     const unsigned char *input,
+                                     unsigned char *output );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         0 if successful, or 1 if the test failed
+ */
+int mbedtls_chachapoly_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* chachapoly.h */
@@ -70,6 +70,11 @@
 #error "MBEDTLS_AESNI_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_CHACHAPOLY_C) && \
+    ( !defined(MBEDTLS_CHACHA20_C) || !defined(MBEDTLS_POLY1305_C) )
+#error "MBEDTLS_CHACHAPOLY_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_CTR_DRBG_C) && !defined(MBEDTLS_AES_C)
 #error "MBEDTLS_CTR_DRBG_C defined, but not all prerequisites"
 #endif
@@ -108,6 +113,14 @@
 #error "MBEDTLS_ECP_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE) && !defined(MBEDTLS_ECP_C)
+#error "MBEDTLS_ECP_COMB_TABLE_CACHE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_RESTARTABLE) && !defined(MBEDTLS_ECP_C)
+#error "MBEDTLS_ECP_RESTARTABLE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_ENTROPY_C) && (!defined(MBEDTLS_SHA512_C) &&      \
                                     !defined(MBEDTLS_SHA256_C))
 #error "MBEDTLS_ENTROPY_C defined, but not all prerequisites"
@@ -126,15 +139,31 @@
 #error "MBEDTLS_ENTROPY_FORCE_SHA256 defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_ENTROPY_PREFETCH) && !defined(MBEDTLS_ENTROPY_C)
+#error "MBEDTLS_ENTROPY_PREFETCH defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_GCM_C) && (                                        \
         !defined(MBEDTLS_AES_C) && !defined(MBEDTLS_CAMELLIA_C) )
 #error "MBEDTLS_GCM_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_GCM_LARGETABLE) && !defined(MBEDTLS_GCM_C)
+#error "MBEDTLS_GCM_LARGETABLE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_HAVEGE_C) && !defined(MBEDTLS_TIMING_C)
 #error "MBEDTLS_HAVEGE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_TIMING_COARSE) && !defined(MBEDTLS_TIMING_C)
+#error "MBEDTLS_TIMING_COARSE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_TIMING_TRACE) && !defined(MBEDTLS_TIMING_C)
+#error "MBEDTLS_TIMING_TRACE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_HMAC_DRBG_C) && !defined(MBEDTLS_MD_C)
 #error "MBEDTLS_HMAC_DRBG_C defined, but not all prerequisites"
 #endif
@@ -193,6 +222,15 @@
 #error "MBEDTLS_MEMORY_BUFFER_ALLOC_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_MEMORY_TAGGING) && !defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+#error "MBEDTLS_MEMORY_TAGGING defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_MEMORY_ARENAS) && ( !defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) || \
+    !defined(MBEDTLS_THREADING_PTHREAD) )
+#error "MBEDTLS_MEMORY_ARENAS defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_PADLOCK_C) && !defined(MBEDTLS_HAVE_ASM)
 #error "MBEDTLS_PADLOCK_C defined, but not all prerequisites"
 #endif
@@ -357,6 +395,10 @@
 #error "MBEDTLS_X509_RSASSA_PSS_SUPPORT defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SHA256MB_C) && !defined(MBEDTLS_SHA256_C)
+#error "MBEDTLS_SHA256MB_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_SSL3) && ( !defined(MBEDTLS_MD5_C) ||     \
     !defined(MBEDTLS_SHA1_C) )
 #error "MBEDTLS_SSL_PROTO_SSL3 defined, but not all prerequisites"
@@ -396,6 +438,27 @@
 #error "MBEDTLS_SSL_SRV_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_TRANSFORM_POOL defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_HANDSHAKE_POOL defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_STATS) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_STATS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_HS_TIMING) && ( !defined(MBEDTLS_SSL_TLS_C) || \
+    !defined(MBEDTLS_TIMING_C) )
+#error "MBEDTLS_SSL_HS_TIMING defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_OUT_DOUBLE_BUFFER defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_TLS_C) && (!defined(MBEDTLS_SSL_PROTO_SSL3) && \
     !defined(MBEDTLS_SSL_PROTO_TLS1) && !defined(MBEDTLS_SSL_PROTO_TLS1_1) && \
     !defined(MBEDTLS_SSL_PROTO_TLS1_2))
@@ -432,6 +495,11 @@
 #error "MBEDTLS_SSL_DTLS_BADMAC_LIMIT  defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE) &&                                     \
+    ( !defined(MBEDTLS_ECDH_C) || !defined(MBEDTLS_SSL_SRV_C) )
+#error "MBEDTLS_SSL_ECDH_REUSE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC) &&   \
     !defined(MBEDTLS_SSL_PROTO_TLS1)   &&      \
     !defined(MBEDTLS_SSL_PROTO_TLS1_1) &&      \
@@ -446,6 +514,26 @@
 #error "MBEDTLS_SSL_EXTENDED_MASTER_SECRET defined, but not all prerequsites"
 #endif
 
+#if defined(MBEDTLS_SSL_BIO_PAIR_C) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_BIO_PAIR_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_C) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_CACHE_SHM_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_DEMUX_C) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_DEMUX_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_PSK_STORE_C) && !defined(MBEDTLS_SSL_SRV_C)
+#error "MBEDTLS_SSL_PSK_STORE_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_SCHED_C) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_SCHED_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_TICKET_C) && !defined(MBEDTLS_CIPHER_C)
 #error "MBEDTLS_SSL_TICKET_C defined, but not all prerequisites"
 #endif
@@ -455,11 +543,49 @@
 #error "MBEDTLS_SSL_CBC_RECORD_SPLITTING defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING) && !defined(MBEDTLS_CIPHER_MODE_CBC)
+#error "MBEDTLS_SSL_RECORD_PADDING defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_RECORD_KEY_EXPORT defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE) && !defined(MBEDTLS_SSL_TLS_C)
+#error "MBEDTLS_SSL_RECORD_SPECIALIZE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH) && defined(MBEDTLS_CIPHER_C) && \
+    ( !defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) ||     \
+      defined(MBEDTLS_DES_C) || defined(MBEDTLS_BLOWFISH_C) ||      \
+      defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CHACHA20_C) ||     \
+      defined(MBEDTLS_CIPHER_NULL_CIPHER) )
+#error "MBEDTLS_SINGLE_BACKEND_DISPATCH requires AES as the only cipher module"
+#endif
+
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH) && defined(MBEDTLS_MD_C) && \
+    ( defined(MBEDTLS_MD2_C) + defined(MBEDTLS_MD4_C) +             \
+      defined(MBEDTLS_MD5_C) + defined(MBEDTLS_RIPEMD160_C) +       \
+      defined(MBEDTLS_SHA1_C) + defined(MBEDTLS_SHA256_C) +         \
+      defined(MBEDTLS_SHA512_C) != 1 )
+#error "MBEDTLS_SINGLE_BACKEND_DISPATCH requires exactly one hash module"
+#endif
+
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION) && \
         !defined(MBEDTLS_X509_CRT_PARSE_C)
 #error "MBEDTLS_SSL_SERVER_NAME_INDICATION defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_FALSE_START) && \
+    ( !defined(MBEDTLS_SSL_CLI_C) || !defined(MBEDTLS_SSL_PROTO_TLS1_2) )
+#error "MBEDTLS_SSL_FALSE_START defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE) && \
+    ( !defined(MBEDTLS_SSL_SRV_C) || !defined(MBEDTLS_X509_CRT_PARSE_C) )
+#error "MBEDTLS_SSL_ASYNC_PRIVATE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_THREADING_PTHREAD)
 #if !defined(MBEDTLS_THREADING_C) || defined(MBEDTLS_THREADING_IMPL)
 #error "MBEDTLS_THREADING_PTHREAD defined, but not all prerequisites"
@@ -474,6 +600,10 @@
 #define MBEDTLS_THREADING_IMPL
 #endif
 
+#if defined(MBEDTLS_THREADING_SPIN) && !defined(MBEDTLS_THREADING_PTHREAD)
+#error "MBEDTLS_THREADING_SPIN defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_THREADING_C) && !defined(MBEDTLS_THREADING_IMPL)
 #error "MBEDTLS_THREADING_C defined, single threading implementation required"
 #endif
@@ -499,10 +629,40 @@
 #error "MBEDTLS_X509_CRT_PARSE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C) && ( !defined(MBEDTLS_X509_CRT_PARSE_C) || \
+    !defined(MBEDTLS_SHA256_C) )
+#error "MBEDTLS_X509_CRT_CACHE_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_TRUST_C) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_TRUST_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C) && ( !defined(MBEDTLS_X509_CRT_PARSE_C) || \
+    !defined(MBEDTLS_SHA256_C) )
+#error "MBEDTLS_X509_VERIFY_CACHE_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CRT_LAZY_EXTENSIONS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_ARENA) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CRT_ARENA defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CRT_HOST_TABLE defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_CRL_PARSE_C) && ( !defined(MBEDTLS_X509_USE_C) )
 #error "MBEDTLS_X509_CRL_PARSE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_X509_CRL_SET_C) && !defined(MBEDTLS_X509_CRL_PARSE_C)
+#error "MBEDTLS_X509_CRL_SET_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_CSR_PARSE_C) && ( !defined(MBEDTLS_X509_USE_C) )
 #error "MBEDTLS_X509_CSR_PARSE_C defined, but not all prerequisites"
 #endif
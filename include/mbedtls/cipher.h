@@ -35,6 +35,10 @@
 
 #include <stddef.h>
 
+#if defined(MBEDTLS_MD_C)
+#include "md.h"
+#endif
+
 #if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C)
 #define MBEDTLS_CIPHER_MODE_AEAD
 #endif
@@ -74,6 +78,7 @@ typedef enum {
     MBEDTLS_CIPHER_ID_CAMELLIA,
     MBEDTLS_CIPHER_ID_BLOWFISH,
     MBEDTLS_CIPHER_ID_ARC4,
+    MBEDTLS_CIPHER_ID_CHACHA20,
 } mbedtls_cipher_id_t;
 
 typedef enum {
@@ -126,6 +131,9 @@ typedef enum {
     MBEDTLS_CIPHER_CAMELLIA_128_CCM,
     MBEDTLS_CIPHER_CAMELLIA_192_CCM,
     MBEDTLS_CIPHER_CAMELLIA_256_CCM,
+    MBEDTLS_CIPHER_AES_128_XTS,
+    MBEDTLS_CIPHER_AES_256_XTS,
+    MBEDTLS_CIPHER_CHACHA20_POLY1305,
 } mbedtls_cipher_type_t;
 
 typedef enum {
@@ -138,6 +146,8 @@ typedef enum {
     MBEDTLS_MODE_GCM,
     MBEDTLS_MODE_STREAM,
     MBEDTLS_MODE_CCM,
+    MBEDTLS_MODE_XTS,
+    MBEDTLS_MODE_CHACHAPOLY,
 } mbedtls_cipher_mode_t;
 
 typedef enum {
@@ -170,6 +180,15 @@ enum {
 /** Maximum block size of any cipher, in bytes */
 #define MBEDTLS_MAX_BLOCK_LENGTH   16
 
+/**
+ * Input buffer segment, for the scatter-gather variants of the AEAD
+ * functions (see for example mbedtls_gcm_crypt_and_tag_iov()).
+ */
+typedef struct {
+    const unsigned char *base;  /**< start of the segment */
+    size_t len;                 /**< length of the segment, in bytes */
+} mbedtls_iovec;
+
 /**
  * Base cipher information (opaque struct).
  */
@@ -308,6 +327,12 @@ void mbedtls_cipher_free( mbedtls_cipher_context_t *ctx );
  *                      will be required to call mbedtls_cipher_init() on the structure
  *                      first.
  *
+ * \note                May be called again on a context that is already set
+ *                      up: when the new cipher shares the base implementation
+ *                      of the old one, the underlying context is reused
+ *                      instead of reallocated (it keeps the previous key
+ *                      schedule until the next mbedtls_cipher_setkey()).
+ *
  * \param ctx           context to initialise. May not be NULL.
  * \param cipher_info   cipher to use.
  *
@@ -544,6 +569,68 @@ int mbedtls_cipher_update_ad( mbedtls_cipher_context_t *ctx,
 int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *input,
                    size_t ilen, unsigned char *output, size_t *olen );
 
+/**
+ * \brief               Variant of mbedtls_cipher_update() for callers that
+ *                      always pass block-aligned buffers. For ECB and CBC
+ *                      the data is handed to the underlying cipher in one
+ *                      go, bypassing the block-stitching state machine and
+ *                      its copies; other modes are forwarded unchanged.
+ *
+ * \param ctx           generic cipher context
+ * \param input         buffer holding the input data
+ * \param ilen          length of the input data; for ECB and CBC must be a
+ *                      multiple of the block size
+ * \param output        buffer for the output data, at least ilen bytes.
+ *                      For ECB and CBC it may be the same buffer as input.
+ * \param olen          length of the output data, will be filled with the
+ *                      actual number of bytes written
+ *
+ * \returns             0 on success, MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA if
+ *                      ilen is not block-aligned or the context holds
+ *                      buffered data from mbedtls_cipher_update(), or a
+ *                      cipher specific error code.
+ *
+ * \note                For ECB and CBC every byte is processed immediately,
+ *                      so nothing is retained for mbedtls_cipher_finish():
+ *                      with CBC decryption this requires
+ *                      MBEDTLS_PADDING_NONE.
+ */
+int mbedtls_cipher_update_aligned( mbedtls_cipher_context_t *ctx,
+                   const unsigned char *input, size_t ilen,
+                   unsigned char *output, size_t *olen );
+
+#if defined(MBEDTLS_MD_C)
+/**
+ * \brief               Cipher a buffer and feed an HMAC over it in one
+ *                      pass. The input is processed in cache-sized
+ *                      chunks, each ciphered and then HMACed while still
+ *                      in cache, which beats a full cipher pass followed
+ *                      by a full digest pass for bulk data.
+ *
+ * \param ctx           generic cipher context
+ * \param md_ctx        message digest context with HMAC started
+ * \param input         buffer holding the input data
+ * \param ilen          length of the input data
+ * \param output        buffer for the output data. Should be able to hold at
+ *                      least ilen + block_size.
+ * \param olen          length of the output data, will be filled with the
+ *                      actual number of bytes written
+ * \param mac_output    non-zero to HMAC the ciphered output
+ *                      (encrypt-then-MAC), zero to HMAC the input
+ *                      (MAC-then-decrypt)
+ *
+ * \returns             0 on success, MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA if
+ *                      parameter verification fails, or the first error
+ *                      from mbedtls_cipher_update() or
+ *                      mbedtls_md_hmac_update()
+ */
+int mbedtls_cipher_update_hmac( mbedtls_cipher_context_t *ctx,
+                   mbedtls_md_context_t *md_ctx,
+                   const unsigned char *input, size_t ilen,
+                   unsigned char *output, size_t *olen,
+                   int mac_output );
+#endif /* MBEDTLS_MD_C */
+
 /**
  * \brief               Generic cipher finalisation function. If data still
  *                      needs to be flushed from an incomplete block, data
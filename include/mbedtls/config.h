@@ -292,6 +292,19 @@
  */
 //#define MBEDTLS_ENTROPY_HARDWARE_ALT
 
+/**
+ * \def MBEDTLS_ENTROPY_RDSEED
+ *
+ * Register the CPU's RDSEED instruction (falling back to RDRAND) as a
+ * strong entropy source on x86-64. Availability is detected with CPUID at
+ * run time, so the source is only registered on CPUs that have it; on
+ * other platforms this option compiles to nothing. Reading the on-chip
+ * DRNG avoids a syscall or /dev/urandom access per entropy poll.
+ *
+ * Comment this macro to disable the RDSEED entropy source.
+ */
+#define MBEDTLS_ENTROPY_RDSEED
+
 /**
  * \def MBEDTLS_AES_ROM_TABLES
  *
@@ -331,6 +344,13 @@
  */
 #define MBEDTLS_CIPHER_MODE_CTR
 
+/**
+ * \def MBEDTLS_CIPHER_MODE_XTS
+ *
+ * Enable Xor-encrypt-xor with ciphertext stealing mode (XTS) for AES.
+ */
+#define MBEDTLS_CIPHER_MODE_XTS
+
 /**
  * \def MBEDTLS_CIPHER_NULL_CIPHER
  *
@@ -364,6 +384,24 @@
  */
 //#define MBEDTLS_CIPHER_NULL_CIPHER
 
+/**
+ * \def MBEDTLS_SINGLE_BACKEND_DISPATCH
+ *
+ * In minimal single-suite builds, collapse the cipher and md layer
+ * dispatch to direct calls into the one compiled-in backend instead of
+ * going through the mbedtls_cipher_base_t / mbedtls_md_info_t function
+ * pointers, so the backend can be inlined and unused paths are
+ * eliminated.
+ *
+ * Requires AES as the only cipher module and exactly one hash module;
+ * check_config.h rejects configurations that still pull in more than
+ * one backend, which also serves as a build-time check that a profile
+ * is as small as intended.
+ *
+ * Uncomment this macro in single-suite reduced configurations.
+ */
+//#define MBEDTLS_SINGLE_BACKEND_DISPATCH
+
 /**
  * \def MBEDTLS_CIPHER_PADDING_XXX
  *
@@ -439,6 +477,43 @@
  */
 #define MBEDTLS_ECP_NIST_OPTIM
 
+/**
+ * \def MBEDTLS_ECP_COMB_TABLE_CACHE
+ *
+ * Share the comb tables computed for the base points of well-known curves
+ * in a process-wide cache, keyed by group id, instead of storing one table
+ * per group.
+ *
+ * This saves time and memory when many short-lived groups use the same
+ * curve, for example one group per TLS handshake. The cached tables live
+ * until mbedtls_ecp_comb_cache_free() is called; in multi-threaded
+ * programs the cache is protected by mbedtls_threading_ecp_mutex
+ * (requires MBEDTLS_THREADING_C).
+ *
+ * Uncomment this macro to enable the shared comb table cache.
+ */
+//#define MBEDTLS_ECP_COMB_TABLE_CACHE
+
+/**
+ * \def MBEDTLS_ECP_RESTARTABLE
+ *
+ * Enable "non-blocking" ECC operations that can return early and be resumed.
+ *
+ * Once a maximum number of basic operations per call has been set with
+ * mbedtls_ecp_set_max_ops(), the _restartable variants of ECP, ECDH and
+ * ECDSA functions return MBEDTLS_ERR_ECP_IN_PROGRESS when the budget is
+ * exhausted, and pick up where they left off when called again. This bounds
+ * the time spent in a single call, so a single-threaded event loop can
+ * service other traffic while an expensive point multiplication is in
+ * progress.
+ *
+ * Note: only short Weierstrass curves are sliced; operations on Montgomery
+ * curves always run to completion.
+ *
+ * Uncomment this macro to enable restartable ECC computations.
+ */
+//#define MBEDTLS_ECP_RESTARTABLE
+
 /**
  * \def MBEDTLS_ECDSA_DETERMINISTIC
  *
@@ -740,6 +815,33 @@
  */
 #define MBEDTLS_FS_IO
 
+/**
+ * \def MBEDTLS_CTR_DRBG_FORK_CHECK
+ *
+ * Detect forked processes in mbedtls_ctr_drbg_random() and force a reseed
+ * in the child, so parent and child never produce the same output stream.
+ *
+ * The check compares getpid() against the process that (re)seeded the
+ * context, so this option is only available on POSIX platforms.
+ *
+ * Uncomment this macro to reseed CTR_DRBG contexts automatically on fork.
+ */
+//#define MBEDTLS_CTR_DRBG_FORK_CHECK
+
+/**
+ * \def MBEDTLS_GCM_LARGETABLE
+ *
+ * Use a 256-entry (4K per context) precomputed table for the GCM
+ * multiplication instead of the default 16-entry one, halving the table
+ * lookups per block. Only affects platforms without a carry-less
+ * multiplication instruction (on those, the table is not used at all).
+ *
+ * Requires: MBEDTLS_GCM_C
+ *
+ * Uncomment this macro to trade memory for GCM speed.
+ */
+//#define MBEDTLS_GCM_LARGETABLE
+
 /**
  * \def MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES
  *
@@ -780,6 +882,43 @@
  */
 //#define MBEDTLS_ENTROPY_FORCE_SHA256
 
+/**
+ * \def MBEDTLS_ENTROPY_PREFETCH
+ *
+ * Keep a small pool of pre-gathered entropy blocks in the entropy context.
+ *
+ * With this enabled, mbedtls_entropy_prefetch() gathers all sources and
+ * stores the resulting block in the pool; while the pool is non-empty,
+ * mbedtls_entropy_func() serves requests from it with a short copy under
+ * the context mutex. Call mbedtls_entropy_prefetch() from idle moments so
+ * that DRBG reseeds on busy threads do not stall on a full source poll.
+ *
+ * Requires: MBEDTLS_ENTROPY_C
+ *
+ * Costs MBEDTLS_ENTROPY_PREFETCH_BLOCKS entropy blocks of RAM per context.
+ *
+ * Uncomment this macro to enable the pre-gathered entropy pool.
+ */
+//#define MBEDTLS_ENTROPY_PREFETCH
+
+/**
+ * \def MBEDTLS_MD_HMAC_CACHE
+ *
+ * Cache the digest states resulting from the inner and outer HMAC key pads
+ * in the generic message digest layer.
+ *
+ * With this enabled, mbedtls_md_hmac_reset() and mbedtls_md_hmac_finish()
+ * restore a saved state instead of re-compressing a key pad block, saving
+ * two digest block compressions per HMAC computation. This helps most for
+ * short inputs: the TLS 1.2 PRF, per-record MACs of small records and
+ * HMAC_DRBG roughly double in speed.
+ *
+ * Costs two extra digest contexts per HMAC context.
+ *
+ * Comment this macro to save RAM on constrained systems.
+ */
+#define MBEDTLS_MD_HMAC_CACHE
+
 /**
  * \def MBEDTLS_MEMORY_DEBUG
  *
@@ -805,6 +944,60 @@
  */
 //#define MBEDTLS_MEMORY_BACKTRACE
 
+/**
+ * \def MBEDTLS_MEMORY_TAGGING
+ *
+ * Attribute buffer allocator usage to library subsystems. The instrumented
+ * call sites (bignum, X.509 parsing, SSL buffers, cipher contexts) tag
+ * their allocations, and per-tag current and peak usage can be read with
+ * mbedtls_memory_buffer_alloc_tag_cur_get() / _tag_max_get(), making it
+ * possible to tell which subsystem is responsible for a RAM budget
+ * overrun without bisecting.
+ *
+ * Requires: MBEDTLS_MEMORY_BUFFER_ALLOC_C
+ *
+ * Uncomment this macro to enable per-subsystem allocation statistics.
+ */
+//#define MBEDTLS_MEMORY_TAGGING
+
+/**
+ * \def MBEDTLS_MEMORY_ARENAS
+ *
+ * Give each thread its own arena, carved out of the buffer allocator's
+ * master buffer on first allocation. A thread allocates and frees within
+ * its arena without taking the heap mutex; blocks freed from another
+ * thread are queued back to the owning arena and reclaimed on its next
+ * allocation. This removes the single-lock bottleneck that otherwise
+ * serializes all handshake allocations on many-core servers.
+ *
+ * The arena size and count can be tuned with MBEDTLS_MEMORY_ARENA_SIZE
+ * and MBEDTLS_MEMORY_ARENA_MAX (see memory_buffer_alloc.h). Threads
+ * beyond the arena count, and requests too large for an arena, fall back
+ * to the mutex-protected master heap.
+ *
+ * Requires: MBEDTLS_MEMORY_BUFFER_ALLOC_C
+ *           MBEDTLS_THREADING_PTHREAD
+ *
+ * Uncomment this macro to enable per-thread allocation arenas.
+ */
+//#define MBEDTLS_MEMORY_ARENAS
+
+/**
+ * \def MBEDTLS_MPI_MUL_WIDE
+ *
+ * Use a double-width multiply-accumulate loop, unrolled four limbs per
+ * iteration, for the inner multiplication helper in bignum.c instead of the
+ * MULADDC assembly macros from bn_mul.h.
+ *
+ * Requires a double-width integer type (see MBEDTLS_HAVE_UDBL in bignum.h).
+ * On compilers that map such a type to a single widening multiply
+ * instruction this can outperform the generic assembly, in particular for
+ * RSA and DHM. Benchmark on your target before enabling.
+ *
+ * Uncomment this macro to use the double-width multiplication loop.
+ */
+//#define MBEDTLS_MPI_MUL_WIDE
+
 /**
  * \def MBEDTLS_PK_RSA_ALT_SUPPORT
  *
@@ -911,6 +1104,20 @@
  */
 //#define MBEDTLS_SSL_DEBUG_ALL
 
+/** \def MBEDTLS_SSL_ECDH_REUSE
+ *
+ * Enable support for amortizing the server's ephemeral ECDHE key over a
+ * bounded window of handshakes, configured with
+ * mbedtls_ssl_conf_ecdh_reuse(). This saves one mbedtls_ecp_mul() per
+ * handshake at the cost of coarser forward secrecy: all handshakes served
+ * from the same cached keypair share its secret.
+ *
+ * Requires: MBEDTLS_ECDH_C, MBEDTLS_SSL_SRV_C
+ *
+ * Uncomment this macro to enable shared ephemeral ECDHE keys for servers.
+ */
+//#define MBEDTLS_SSL_ECDH_REUSE
+
 /** \def MBEDTLS_SSL_ENCRYPT_THEN_MAC
  *
  * Enable support for Encrypt-then-MAC, RFC 7366.
@@ -964,6 +1171,37 @@
  */
 #define MBEDTLS_SSL_FALLBACK_SCSV
 
+/**
+ * \def MBEDTLS_SSL_FALSE_START
+ *
+ * Enable support for TLS False Start on the client: when enabled with
+ * mbedtls_ssl_conf_false_start(), mbedtls_ssl_write() may send application
+ * data right after the client's Finished message instead of waiting for the
+ * server's, saving one round-trip on full handshakes. Following
+ * draft-ietf-tls-falsestart, this is only done for TLS 1.2 handshakes that
+ * negotiated a forward-secret key exchange with an AEAD cipher.
+ *
+ * Requires: MBEDTLS_SSL_CLI_C, MBEDTLS_SSL_PROTO_TLS1_2
+ *
+ * Comment this macro to disable support for TLS False Start.
+ */
+#define MBEDTLS_SSL_FALSE_START
+
+/**
+ * \def MBEDTLS_SSL_HS_TIMING
+ *
+ * Record a timing breakdown of each handshake: cycles spent in every
+ * handshake state, cycles spent waiting between steps (network round
+ * trips), and the total duration, readable after completion via
+ * mbedtls_ssl_get_hs_timing(). Adds two mbedtls_timing_hardclock() reads
+ * per handshake step and a small fixed array to every context.
+ *
+ * Requires: MBEDTLS_TIMING_C
+ *
+ * Uncomment this macro to enable the handshake timing breakdown
+ */
+//#define MBEDTLS_SSL_HS_TIMING
+
 /**
  * \def MBEDTLS_SSL_HW_RECORD_ACCEL
  *
@@ -974,6 +1212,25 @@
  */
 //#define MBEDTLS_SSL_HW_RECORD_ACCEL
 
+/**
+ * \def MBEDTLS_SSL_OUT_DOUBLE_BUFFER
+ *
+ * Double-buffer the record output path: when a non-blocking f_send
+ * cannot take a full application data record, retire the output buffer
+ * and let its remaining bytes drain on later calls while the next record
+ * is encrypted into a spare buffer, instead of returning
+ * MBEDTLS_ERR_SSL_WANT_WRITE before any new work is done. On streaming
+ * workloads this overlaps record protection with socket writes.
+ *
+ * mbedtls_ssl_write() then reports a record as written once it is
+ * encrypted and queued; at most one retired buffer is pending, so memory
+ * use is bounded by one extra output buffer per context. TLS stream
+ * transports only; DTLS is unaffected.
+ *
+ * Uncomment this macro to enable output double-buffering
+ */
+//#define MBEDTLS_SSL_OUT_DOUBLE_BUFFER
+
 /**
  * \def MBEDTLS_SSL_CBC_RECORD_SPLITTING
  *
@@ -986,6 +1243,49 @@
  */
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING
 
+/**
+ * \def MBEDTLS_SSL_RECORD_PADDING
+ *
+ * Enable mbedtls_ssl_conf_record_pad(), which rounds the padding of
+ * outgoing CBC records up to a configurable boundary so record lengths
+ * reveal less about the plaintext length (TLS padding may cover up to
+ * 256 bytes, not just the minimum needed to fill a block).
+ *
+ * Comment this macro to disable length-hiding record padding.
+ */
+#define MBEDTLS_SSL_RECORD_PADDING
+
+/**
+ * \def MBEDTLS_SSL_RECORD_KEY_EXPORT
+ *
+ * Enable mbedtls_ssl_get_record_keys(), which extracts the negotiated
+ * record protection keys, IVs and sequence numbers from an established
+ * connection, e.g. to program kernel TLS offload (setsockopt TLS_TX) and
+ * serve bulk data with sendfile() while the library only handles the
+ * handshake.
+ *
+ * This keeps a copy of the raw traffic keys in RAM for the lifetime of
+ * the connection; leave it disabled unless the application hands record
+ * protection to another engine.
+ *
+ * Uncomment this macro to enable extraction of record keys.
+ */
+//#define MBEDTLS_SSL_RECORD_KEY_EXPORT
+
+/**
+ * \def MBEDTLS_SSL_RECORD_SPECIALIZE
+ *
+ * Bind a record protection function specialized for the negotiated
+ * ciphersuite family (stream, AEAD, CBC with MAC-then-encrypt or
+ * encrypt-then-MAC) to the transform when keys are derived, instead of
+ * examining the cipher mode for every record. Each record then takes one
+ * indirect call into straight-line code, which helps on small records.
+ *
+ * Uncomment this macro to select the record processing path per
+ * connection rather than per record.
+ */
+//#define MBEDTLS_SSL_RECORD_SPECIALIZE
+
 /**
  * \def MBEDTLS_SSL_RENEGOTIATION
  *
@@ -1102,6 +1402,23 @@
  */
 #define MBEDTLS_SSL_ALPN
 
+/**
+ * \def MBEDTLS_SSL_ASYNC_PRIVATE
+ *
+ * Enable offloading of the server's private key operations (the
+ * ServerKeyExchange signature and the decryption of an RSA-encrypted
+ * premaster secret) to external callbacks, set with
+ * mbedtls_ssl_conf_async_private_cb(). While such an operation is pending
+ * the handshake functions return MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS, so an
+ * event loop can run the operation on a worker thread or a hardware
+ * accelerator and keep serving other connections meanwhile.
+ *
+ * Requires: MBEDTLS_SSL_SRV_C, MBEDTLS_X509_CRT_PARSE_C
+ *
+ * Comment this macro to disable asynchronous private key operations.
+ */
+#define MBEDTLS_SSL_ASYNC_PRIVATE
+
 /**
  * \def MBEDTLS_SSL_DTLS_ANTI_REPLAY
  *
@@ -1171,6 +1488,19 @@
  */
 #define MBEDTLS_SSL_SERVER_NAME_INDICATION
 
+/**
+ * \def MBEDTLS_SSL_STATS
+ *
+ * Maintain per-context event counters (records, bytes, handshakes,
+ * renegotiations, MAC failures) in the SSL record and handshake paths,
+ * readable via mbedtls_ssl_get_stats(). Counting is a plain increment on
+ * fields of the context, so it is cheap enough to leave enabled in
+ * production, unlike MBEDTLS_DEBUG_C.
+ *
+ * Comment this macro to disable SSL event counters
+ */
+#define MBEDTLS_SSL_STATS
+
 /**
  * \def MBEDTLS_SSL_TRUNCATED_HMAC
  *
@@ -1180,6 +1510,40 @@
  */
 #define MBEDTLS_SSL_TRUNCATED_HMAC
 
+/**
+ * \def MBEDTLS_SSL_TRANSFORM_POOL
+ *
+ * Keep the record transform of a closed or renegotiated connection, with its
+ * heap-allocated cipher contexts, for reuse by the next handshake on the same
+ * SSL context instead of freeing and reallocating it. Saves four heap
+ * round-trips per handshake on servers that recycle SSL contexts across
+ * connections with mbedtls_ssl_session_reset().
+ *
+ * \note The pooled cipher contexts hold their previous key schedule until
+ *       the next handshake rekeys them.
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * Uncomment this macro to enable transform reuse in SSL
+ */
+//#define MBEDTLS_SSL_TRANSFORM_POOL
+
+/**
+ * \def MBEDTLS_SSL_HANDSHAKE_POOL
+ *
+ * Enable recycling of the fixed-size per-handshake structures
+ * (mbedtls_ssl_handshake_params, mbedtls_ssl_transform and
+ * mbedtls_ssl_session) through a freelist pool attached to the SSL
+ * configuration with mbedtls_ssl_conf_handshake_pool(). Replaces the six
+ * allocator calls per connection with O(1) list operations, avoiding
+ * heap fragmentation on long-running, high connection-rate servers.
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * Uncomment this macro to enable the handshake structure pool
+ */
+//#define MBEDTLS_SSL_HANDSHAKE_POOL
+
 /**
  * \def MBEDTLS_THREADING_ALT
  *
@@ -1202,6 +1566,66 @@
  */
 //#define MBEDTLS_THREADING_PTHREAD
 
+/**
+ * \def MBEDTLS_THREADING_SPIN
+ *
+ * Spin briefly before blocking in the pthread mutex wrapper. The
+ * critical sections in this library (RSA blinding update, session cache
+ * lookup, ticket keys) hold their locks for far less than the cost of a
+ * futex sleep and wakeup, so under contention a bounded trylock loop
+ * with pause instructions usually acquires the lock without going to the
+ * kernel. The spin bound adapts per mutex to how long acquisition took
+ * recently. Uncontended cost is unchanged (one trylock).
+ *
+ * Not recommended on single-core targets, where spinning only delays the
+ * lock holder.
+ *
+ * Requires: MBEDTLS_THREADING_PTHREAD
+ *
+ * Uncomment this to spin before blocking on contended mutexes.
+ */
+//#define MBEDTLS_THREADING_SPIN
+
+/**
+ * \def MBEDTLS_TIMING_COARSE
+ *
+ * Read mbedtls_timing_get_timer() from the kernel's coarse monotonic
+ * clock (CLOCK_MONOTONIC_COARSE) where the platform offers it, instead
+ * of gettimeofday(). The coarse clock is the scheduler tick the kernel
+ * maintains anyway and reading it is a plain memory load through the
+ * vDSO, so timer polling stops costing anything even when DTLS checks
+ * the retransmit timer on every packet.
+ *
+ * The timer resolution drops to the kernel tick (typically 1-4 ms),
+ * which is ample for the millisecond-granularity DTLS timers but too
+ * coarse for benchmarking; platforms without CLOCK_MONOTONIC_COARSE
+ * silently keep the default path.
+ *
+ * Requires: MBEDTLS_TIMING_C
+ *
+ * Uncomment this to enable the coarse clock for timer reads.
+ */
+//#define MBEDTLS_TIMING_COARSE
+
+/**
+ * \def MBEDTLS_TIMING_TRACE
+ *
+ * Compile in cycle-counter trace points around the expensive crypto
+ * operations (RSA private key operations, ECP scalar multiplication,
+ * modular exponentiation, SSL record encryption). Each completed
+ * operation appends an (operation, cycles) record to a ring buffer
+ * supplied via mbedtls_timing_trace_setup(), from which an application
+ * can build per-operation latency histograms without a profiler.
+ *
+ * Until a ring is installed the trace points only cost two reads of the
+ * cycle counter per operation.
+ *
+ * Requires: MBEDTLS_TIMING_C
+ *
+ * Uncomment this to enable crypto operation tracing.
+ */
+//#define MBEDTLS_TIMING_TRACE
+
 /**
  * \def MBEDTLS_VERSION_FEATURES
  *
@@ -1235,6 +1659,73 @@
  */
 //#define MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION
 
+/**
+ * \def MBEDTLS_X509_CRT_LAZY_EXTENSIONS
+ *
+ * If set, the X509 parser records the raw subjectAltName and
+ * extendedKeyUsage extension data instead of building the name and OID
+ * lists up front, and the lists are built on first use (hostname
+ * matching, extended key usage checks, certificate info). This cuts the
+ * allocations per parsed certificate from dozens to a handful on paths
+ * that never look at these lists.
+ *
+ * \note  Errors in these extensions are then reported when they are
+ *        first used instead of at parse time, and applications that walk
+ *        crt->subject_alt_names or crt->ext_key_usage directly must call
+ *        mbedtls_x509_crt_materialize_exts() first.
+ *
+ * Uncomment this macro to defer extension parsing.
+ */
+//#define MBEDTLS_X509_CRT_LAZY_EXTENSIONS
+
+/**
+ * \def MBEDTLS_X509_CRT_ARENA
+ *
+ * If set, each parsed certificate carries a single arena allocation,
+ * sized by a pre-scan of the DER structure, that holds all of its name
+ * and sequence list nodes. This replaces the per-node heap allocations
+ * made while parsing and lets mbedtls_x509_crt_free() release them in
+ * one call, which reduces allocator traffic and fragmentation when
+ * certificates are parsed and freed at a high rate.
+ *
+ * \note  Signature options (sig_opts) and the public key context keep
+ *        their own allocations; only the X.509-layer linked lists are
+ *        arena-backed.
+ *
+ * Uncomment this macro to use arena allocation for certificates.
+ */
+//#define MBEDTLS_X509_CRT_ARENA
+
+/**
+ * \def MBEDTLS_X509_CRT_HOST_TABLE
+ *
+ * If set, the first hostname check against a certificate builds a
+ * lowercased, sorted table of the names it is valid for (subjectAltName
+ * entries, or CN attributes when there is no SAN), and later checks are
+ * a binary search over that table instead of a case-folding walk of the
+ * ASN.1 lists. Worthwhile for servers and proxies that verify the same
+ * certificates against hostnames at a high rate.
+ *
+ * Comment this macro to save one pointer per certificate and the table
+ * allocations.
+ */
+#define MBEDTLS_X509_CRT_HOST_TABLE
+
+/**
+ * \def MBEDTLS_X509_DN_CACHE
+ *
+ * If set, parsing a certificate renders its subject and issuer names to
+ * printable form once, and mbedtls_x509_crt_subject_dn() /
+ * mbedtls_x509_crt_issuer_dn() return the cached string. Applications
+ * that log distinguished names per connection (audit trails, access
+ * logs) then skip the OID lookups and character filtering of
+ * mbedtls_x509_dn_gets() on every use.
+ *
+ * Comment this macro to save two pointers and the rendered strings per
+ * certificate.
+ */
+#define MBEDTLS_X509_DN_CACHE
+
 /**
  * \def MBEDTLS_X509_CHECK_KEY_USAGE
  *
@@ -1316,6 +1807,43 @@
  */
 #define MBEDTLS_AESNI_C
 
+/**
+ * \def MBEDTLS_ARMCE_C
+ *
+ * Enable ARMv8-A Cryptography Extensions support on AArch64.
+ *
+ * Module:  library/armce.c
+ * Caller:  library/aes.c
+ *          library/gcm.c
+ *          library/sha256.c
+ *
+ * This module adds support for the AES, PMULL and SHA-256 instructions
+ * on AArch64.
+ * Support is detected at runtime, so it is safe to leave this enabled when
+ * building for processors without the extensions.
+ */
+#define MBEDTLS_ARMCE_C
+
+/**
+ * \def MBEDTLS_AESCT_C
+ *
+ * Enable the constant-time bitsliced AES implementation.
+ *
+ * Module:  library/aesct.c
+ * Caller:  library/aes.c
+ *
+ * When no hardware AES engine is available at runtime, AES is computed
+ * with boolean operations on a bitsliced state instead of the lookup
+ * tables, removing the cache-timing leak of the table-based code. The
+ * bitsliced form holds four blocks, so the parallel modes (CTR, CBC
+ * decryption, XTS) run at full speed while the serial modes pay up to a
+ * factor of four. Has no effect on blocks processed by AES-NI.
+ *
+ * Uncomment to trade bulk AES performance for constant-time execution
+ * on platforms without hardware AES.
+ */
+//#define MBEDTLS_AESCT_C
+
 /**
  * \def MBEDTLS_AES_C
  *
@@ -1560,6 +2088,30 @@
  */
 #define MBEDTLS_CERTS_C
 
+/**
+ * \def MBEDTLS_CHACHA20_C
+ *
+ * Enable the ChaCha20 stream cipher.
+ *
+ * Module:  library/chacha20.c
+ * Caller:  library/chachapoly.c
+ */
+#define MBEDTLS_CHACHA20_C
+
+/**
+ * \def MBEDTLS_CHACHAPOLY_C
+ *
+ * Enable the ChaCha20-Poly1305 AEAD algorithm.
+ *
+ * Module:  library/chachapoly.c
+ *
+ * Requires: MBEDTLS_CHACHA20_C, MBEDTLS_POLY1305_C
+ *
+ * This module enables the CHACHA20-POLY1305 ciphersuites, if other
+ * requisites are enabled as well.
+ */
+#define MBEDTLS_CHACHAPOLY_C
+
 /**
  * \def MBEDTLS_CIPHER_C
  *
@@ -2019,6 +2571,16 @@
  */
 #define MBEDTLS_PLATFORM_C
 
+/**
+ * \def MBEDTLS_POLY1305_C
+ *
+ * Enable the Poly1305 one-time message authenticator.
+ *
+ * Module:  library/poly1305.c
+ * Caller:  library/chachapoly.c
+ */
+#define MBEDTLS_POLY1305_C
+
 /**
  * \def MBEDTLS_RIPEMD160_C
  *
@@ -2081,6 +2643,23 @@
  */
 #define MBEDTLS_SHA256_C
 
+/**
+ * \def MBEDTLS_SHA256MB_C
+ *
+ * Enable multi-buffer SHA-256 with AVX2 on x86-64.
+ *
+ * Module:  library/sha256mb.c
+ * Caller:  library/md.c
+ *
+ * Requires: MBEDTLS_SHA256_C, MBEDTLS_HAVE_ASM
+ *
+ * This module hashes independent buffers eight at a time in the 32-bit
+ * lanes of AVX2 vectors; mbedtls_md_multi() uses it for SHA-224/SHA-256.
+ * Support is detected at runtime, so it is safe to leave this enabled
+ * when building for processors without AVX2.
+ */
+#define MBEDTLS_SHA256MB_C
+
 /**
  * \def MBEDTLS_SHA512_C
  *
@@ -2096,6 +2675,35 @@
  */
 #define MBEDTLS_SHA512_C
 
+/**
+ * \def MBEDTLS_SHANI_C
+ *
+ * Enable SHA extensions support on x86-64.
+ *
+ * Module:  library/shani.c
+ * Caller:  library/sha256.c
+ *
+ * Requires: MBEDTLS_HAVE_ASM
+ *
+ * This module adds support for the SHA-NI instructions on x86-64.
+ * Support is detected at runtime, so it is safe to leave this enabled
+ * when building for processors without the extensions.
+ */
+#define MBEDTLS_SHANI_C
+
+/**
+ * \def MBEDTLS_SSL_BIO_PAIR_C
+ *
+ * Enable an in-memory BIO pair: two SSL contexts plugged into the two
+ * ends of a pair exchange records through ring buffers instead of a
+ * socket, for test harnesses and for stacking TLS inside TLS.
+ *
+ * Module:  library/ssl_bio.c
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ */
+#define MBEDTLS_SSL_BIO_PAIR_C
+
 /**
  * \def MBEDTLS_SSL_CACHE_C
  *
@@ -2108,6 +2716,21 @@
  */
 #define MBEDTLS_SSL_CACHE_C
 
+/**
+ * \def MBEDTLS_SSL_CACHE_SHM_C
+ *
+ * Enable an SSL session cache over POSIX shared memory, so the workers
+ * of a pre-forking server resume each other's sessions. Readers are
+ * lock-free (per-slot seqlock plus checksum).
+ *
+ * Module:  library/ssl_cache_shm.c
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * This module only works on Unix.
+ */
+//#define MBEDTLS_SSL_CACHE_SHM_C
+
 /**
  * \def MBEDTLS_SSL_COOKIE_C
  *
@@ -2118,6 +2741,46 @@
  */
 #define MBEDTLS_SSL_COOKIE_C
 
+/**
+ * \def MBEDTLS_SSL_DEMUX_C
+ *
+ * Enable a hash table mapping peer transport addresses to connections,
+ * so DTLS servers reading many clients from one socket can route each
+ * datagram to its mbedtls_ssl_context in O(1).
+ *
+ * Module:  library/ssl_demux.c
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ */
+#define MBEDTLS_SSL_DEMUX_C
+
+/**
+ * \def MBEDTLS_SSL_PSK_STORE_C
+ *
+ * Enable a built-in PSK identity store: a hash table over identity
+ * bytes with lock-free lookups, for servers with many PSK clients
+ * where a single configured PSK or a callback with its own locking
+ * does not scale.
+ *
+ * Module:  library/ssl_psk_store.c
+ *
+ * Requires: MBEDTLS_SSL_SRV_C and a PSK key exchange
+ */
+#define MBEDTLS_SSL_PSK_STORE_C
+
+/**
+ * \def MBEDTLS_SSL_SCHED_C
+ *
+ * Enable a round-robin scheduler for many concurrent SSL handshakes, so
+ * that connection storms share crypto time instead of being served to
+ * completion in arrival order.
+ *
+ * Module:  library/ssl_sched.c
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ */
+#define MBEDTLS_SSL_SCHED_C
+
 /**
  * \def MBEDTLS_SSL_TICKET_C
  *
@@ -2218,6 +2881,21 @@
  */
 #define MBEDTLS_VERSION_C
 
+/**
+ * \def MBEDTLS_WARMUP_C
+ *
+ * Enable mbedtls_warmup(), which precomputes the tables the library
+ * otherwise builds lazily on first use (AES S-box and round tables, the
+ * shared ECP comb table cache), so the cost is paid during process
+ * initialization rather than on the first request after a deploy.
+ *
+ * Module:  library/warmup.c
+ *
+ * This module has no effect on behaviour, only on when one-time setup
+ * work happens.
+ */
+#define MBEDTLS_WARMUP_C
+
 /**
  * \def MBEDTLS_X509_USE_C
  *
@@ -2251,6 +2929,49 @@
  */
 #define MBEDTLS_X509_CRT_PARSE_C
 
+/**
+ * \def MBEDTLS_X509_CRT_CACHE_C
+ *
+ * Enable a refcounted cache of parsed certificates keyed by a digest of
+ * the raw DER, so that repeatedly presented certificates are parsed once
+ * and shared instead of re-allocating their ASN.1 nodes per connection.
+ *
+ * Module:  library/x509_crt_cache.c
+ * Caller:  library/ssl_tls.c
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C, MBEDTLS_SHA256_C
+ */
+#define MBEDTLS_X509_CRT_CACHE_C
+
+/**
+ * \def MBEDTLS_X509_TRUST_C
+ *
+ * Enable a hash index over the subject names of a trusted CA list, so
+ * that certificate verification against large CA bundles finds candidate
+ * issuers in O(1) instead of scanning the whole linked list.
+ *
+ * Module:  library/x509_trust.c
+ * Caller:  library/ssl_tls.c
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ */
+#define MBEDTLS_X509_TRUST_C
+
+/**
+ * \def MBEDTLS_X509_VERIFY_CACHE_C
+ *
+ * Enable memoization of certificate chain verification results, so that
+ * servers verifying the same client chains over and over skip the
+ * repeated signature checks (a full RSA operation per certificate).
+ * Results expire after a configurable timeout.
+ *
+ * Module:  library/x509_verify_cache.c
+ * Caller:  library/ssl_tls.c
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C, MBEDTLS_SHA256_C
+ */
+#define MBEDTLS_X509_VERIFY_CACHE_C
+
 /**
  * \def MBEDTLS_X509_CRL_PARSE_C
  *
@@ -2265,6 +2986,21 @@
  */
 #define MBEDTLS_X509_CRL_PARSE_C
 
+/**
+ * \def MBEDTLS_X509_CRL_SET_C
+ *
+ * Enable the compact sorted-array representation of CRL revocation data,
+ * for revocation checks against very large CRLs: one allocation, binary
+ * search lookups, delta CRL merging, and in-place attachment of
+ * preprocessed (e.g. memory-mapped) record files.
+ *
+ * Module:  library/x509_crl_set.c
+ * Caller:
+ *
+ * Requires: MBEDTLS_X509_CRL_PARSE_C
+ */
+#define MBEDTLS_X509_CRL_SET_C
+
 /**
  * \def MBEDTLS_X509_CSR_PARSE_C
  *
@@ -2371,6 +3107,12 @@
 //#define MBEDTLS_ENTROPY_MAX_SOURCES                20 /**< Maximum number of sources supported */
 //#define MBEDTLS_ENTROPY_MAX_GATHER                128 /**< Maximum amount requested from entropy sources */
 
+/* Debug options */
+//#define MBEDTLS_DEBUG_MAX_LEVEL            1 /**< Discard debug call sites above this level at compile time */
+
+/* MD options */
+//#define MBEDTLS_MD_FILE_CHUNK_SIZE     65536 /**< Read size used by mbedtls_md_file(), amortizes the I/O over the hashing */
+
 /* Memory buffer allocator options */
 //#define MBEDTLS_MEMORY_ALIGN_MULTIPLE      4 /**< Align on multiples of this value */
 
@@ -2403,6 +3145,7 @@
 //#define MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME     86400 /**< Lifetime of session tickets (if enabled) */
 //#define MBEDTLS_PSK_MAX_LEN               32 /**< Max size of TLS pre-shared keys, in bytes (default 256 bits) */
 //#define MBEDTLS_SSL_COOKIE_TIMEOUT        60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
+//#define MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE  64 /**< Size of the DTLS record replay window, in records; must be a power of two >= 64. Raise on links with deep reordering so late records are not dropped as replays */
 
 /**
  * Complete list of ciphersuites to use, in order of preference.
@@ -0,0 +1,149 @@
+/**
+ * \file constant_time.h
+ *
+ * \brief Constant-time buffer utilities
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_CONSTANT_TIME_H
+#define MBEDTLS_CONSTANT_TIME_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Compare two buffers without leaking their contents
+ *                 through timing
+ *
+ *                 The execution time depends only on \p n, not on the
+ *                 position or number of differing bytes. Words are
+ *                 compared where possible, so this is also faster than a
+ *                 byte loop on the sizes typical for MACs and hashes.
+ *
+ * \param a        First buffer
+ * \param b        Second buffer
+ * \param n        Number of bytes to compare
+ *
+ * \return         0 if the \p n bytes are equal, non-zero otherwise
+ */
+int mbedtls_ct_memcmp( const void *a, const void *b, size_t n );
+
+/**
+ * \brief          Conditionally overwrite a buffer, without leaking the
+ *                 condition through timing
+ *
+ *                 The same memory accesses are performed whether the copy
+ *                 happens or not.
+ *
+ * \param condition 1 to copy \p src to \p dest, 0 to leave \p dest
+ *                  unchanged; no other value may be passed
+ * \param dest     Destination buffer
+ * \param src      Source buffer
+ * \param len      Number of bytes to (conditionally) copy
+ */
+void mbedtls_ct_memcpy_if( unsigned char condition,
+                           unsigned char *dest, const unsigned char *src,
+                           size_t len );
+
+/**
+ * \brief          Tell whether two sizes are equal, without branching
+ *                 on the values
+ *
+ * \param a        First size
+ * \param b        Second size
+ *
+ * \return         1 if \p a == \p b, 0 otherwise
+ */
+unsigned char mbedtls_ct_size_eq( size_t a, size_t b );
+
+/**
+ * \brief          Tell whether one size is strictly greater than
+ *                 another, without branching on the values
+ *
+ * \param a        First size
+ * \param b        Second size
+ *
+ * \return         1 if \p a > \p b, 0 otherwise
+ */
+unsigned char mbedtls_ct_size_gt( size_t a, size_t b );
+
+/**
+ * \brief          Choose between two sizes without branching on the
+ *                 condition
+ *
+ * \param condition 1 to return \p if1, 0 to return \p if0; no other
+ *                  value may be passed
+ * \param if1      Value returned when \p condition is 1
+ * \param if0      Value returned when \p condition is 0
+ *
+ * \return         \p if1 or \p if0
+ */
+size_t mbedtls_ct_size_if( unsigned char condition, size_t if1, size_t if0 );
+
+/**
+ * \brief          Shift the content of a buffer towards its start by
+ *                 a secret number of bytes, zero-filling at the end,
+ *                 with a memory access pattern that depends only on
+ *                 \p total
+ *
+ * \param start    Buffer to shift
+ * \param total    Size of the buffer (public)
+ * \param offset   Number of bytes to shift by, at most \p total
+ *                 (secret)
+ */
+void mbedtls_ct_mem_move_to_left( void *start, size_t total, size_t offset );
+
+/**
+ * \brief          Copy \p len bytes from a secret offset within a buffer,
+ *                 without leaking the offset through memory access
+ *                 patterns
+ *
+ *                 Every candidate offset in [\p offset_min, \p offset_max]
+ *                 is visited; only the data at \p offset ends up in
+ *                 \p dest. The buffer must be readable up to
+ *                 \p offset_max + \p len bytes.
+ *
+ * \param dest     Destination buffer, \p len bytes
+ * \param src      Source buffer
+ * \param offset   Secret offset to copy from
+ * \param offset_min Minimum possible value of \p offset (public)
+ * \param offset_max Maximum possible value of \p offset (public)
+ * \param len      Number of bytes to copy
+ */
+void mbedtls_ct_memcpy_offset( unsigned char *dest, const unsigned char *src,
+                               size_t offset, size_t offset_min,
+                               size_t offset_max, size_t len );
+
+/**
+ * \brief          Clear sensitive data in a way the compiler cannot
+ *                 optimize out
+ *
+ * \param v        Buffer to clear
+ * \param n        Number of bytes to clear
+ */
+void mbedtls_zeroize( void *v, size_t n );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* constant_time.h */
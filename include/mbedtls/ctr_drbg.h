@@ -26,6 +26,10 @@
 
 #include "aes.h"
 
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+#include <sys/types.h>
+#endif
+
 #if defined(MBEDTLS_THREADING_C)
 #include "mbedtls/threading.h"
 #endif
@@ -96,6 +100,14 @@ typedef struct
     int reseed_interval;        /*!<  reseed interval   */
 
     mbedtls_aes_context aes_ctx;        /*!<  AES context       */
+    mbedtls_aes_context df_aes_ctx;     /*!<  AES context keyed with the
+                                              constant derivation function
+                                              key       */
+    int df_aes_set;             /*!<  df_aes_ctx is keyed   */
+
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+    pid_t pid;                  /*!<  process that (re)seeded the context   */
+#endif
 
     /*
      * Callbacks (Entropy)
@@ -40,29 +40,66 @@
 
 #define MBEDTLS_DEBUG_STRIP_PARENS( ... )   __VA_ARGS__
 
-#define MBEDTLS_SSL_DEBUG_MSG( level, args )                    \
-    mbedtls_debug_print_msg( ssl, level, __FILE__, __LINE__,    \
-                             MBEDTLS_DEBUG_STRIP_PARENS args )
-
-#define MBEDTLS_SSL_DEBUG_RET( level, text, ret )                \
-    mbedtls_debug_print_ret( ssl, level, __FILE__, __LINE__, text, ret )
+/*
+ * When MBEDTLS_DEBUG_MAX_LEVEL is set, call sites above that level are
+ * removed by the compiler: the level argument is a literal at every call
+ * site, so the condition folds to a constant and the call, its arguments
+ * and its format string all disappear from the binary. This makes it
+ * affordable to ship with level-1 diagnostics compiled in while the
+ * verbose levels cost nothing.
+ */
+#if defined(MBEDTLS_DEBUG_MAX_LEVEL)
+#define MBEDTLS_SSL_DEBUG_ACTIVE( level )   ( ( level ) <= MBEDTLS_DEBUG_MAX_LEVEL )
+#else
+#define MBEDTLS_SSL_DEBUG_ACTIVE( level )   1
+#endif
 
-#define MBEDTLS_SSL_DEBUG_BUF( level, text, buf, len )           \
-    mbedtls_debug_print_buf( ssl, level, __FILE__, __LINE__, text, buf, len )
+#define MBEDTLS_SSL_DEBUG_MSG( level, args )                            \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_msg( ssl, level, __FILE__, __LINE__,    \
+                                     MBEDTLS_DEBUG_STRIP_PARENS args ); \
+    } while( 0 )
+
+#define MBEDTLS_SSL_DEBUG_RET( level, text, ret )                       \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_ret( ssl, level, __FILE__, __LINE__,    \
+                                     text, ret );                       \
+    } while( 0 )
+
+#define MBEDTLS_SSL_DEBUG_BUF( level, text, buf, len )                  \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_buf( ssl, level, __FILE__, __LINE__,    \
+                                     text, buf, len );                  \
+    } while( 0 )
 
 #if defined(MBEDTLS_BIGNUM_C)
-#define MBEDTLS_SSL_DEBUG_MPI( level, text, X )                  \
-    mbedtls_debug_print_mpi( ssl, level, __FILE__, __LINE__, text, X )
+#define MBEDTLS_SSL_DEBUG_MPI( level, text, X )                         \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_mpi( ssl, level, __FILE__, __LINE__,    \
+                                     text, X );                         \
+    } while( 0 )
 #endif
 
 #if defined(MBEDTLS_ECP_C)
-#define MBEDTLS_SSL_DEBUG_ECP( level, text, X )                  \
-    mbedtls_debug_print_ecp( ssl, level, __FILE__, __LINE__, text, X )
+#define MBEDTLS_SSL_DEBUG_ECP( level, text, X )                         \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_ecp( ssl, level, __FILE__, __LINE__,    \
+                                     text, X );                         \
+    } while( 0 )
 #endif
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
-#define MBEDTLS_SSL_DEBUG_CRT( level, text, crt )                \
-    mbedtls_debug_print_crt( ssl, level, __FILE__, __LINE__, text, crt )
+#define MBEDTLS_SSL_DEBUG_CRT( level, text, crt )                       \
+    do {                                                                \
+        if( MBEDTLS_SSL_DEBUG_ACTIVE( level ) )                         \
+            mbedtls_debug_print_crt( ssl, level, __FILE__, __LINE__,    \
+                                     text, crt );                       \
+    } while( 0 )
 #endif
 
 #else /* MBEDTLS_DEBUG_C */
@@ -89,6 +126,49 @@ extern "C" {
  */
 void mbedtls_debug_set_threshold( int threshold );
 
+/*
+ * Record types for the raw debug sink
+ */
+#define MBEDTLS_DEBUG_TYPE_MSG      0   /**< formatted message, data is NULL  */
+#define MBEDTLS_DEBUG_TYPE_RET      1   /**< data points to the int value     */
+#define MBEDTLS_DEBUG_TYPE_BUF      2   /**< data is the dumped buffer        */
+#define MBEDTLS_DEBUG_TYPE_MPI      3   /**< data is the limb array, native
+                                             limb order and endianness        */
+#define MBEDTLS_DEBUG_TYPE_CRT      4   /**< data is the DER certificate      */
+
+/**
+ * \brief   One entry handed to a raw debug sink
+ */
+typedef struct
+{
+    int level;                  /*!< debug level of the entry               */
+    const char *file;           /*!< source file of the call site           */
+    int line;                   /*!< source line of the call site           */
+    int type;                   /*!< one of the MBEDTLS_DEBUG_TYPE_* values */
+    const char *text;           /*!< message or name of the dumped item     */
+    const unsigned char *data;  /*!< raw payload, NULL for plain messages   */
+    size_t len;                 /*!< length of the payload in bytes         */
+} mbedtls_debug_raw_record;
+
+/**
+ * \brief   Install a raw debug sink, replacing the textual callbacks
+ *
+ *          When a sink is installed, buffers, MPIs and certificates are
+ *          handed over as one binary record each instead of being
+ *          rendered to hex line by line, so diagnostics can stay enabled
+ *          in production at a fraction of the formatting cost. Records
+ *          only borrow their pointers for the duration of the call.
+ *
+ *          The sink is global, like the threshold, which still applies.
+ *          Pass NULL to restore the per-config textual callbacks.
+ *
+ * \param f_raw     callback invoked for each record
+ * \param p_raw     opaque context passed to the callback
+ */
+void mbedtls_debug_set_raw_sink( void (*f_raw)( void *,
+                                     const mbedtls_debug_raw_record * ),
+                                 void *p_raw );
+
 void mbedtls_debug_print_msg( const mbedtls_ssl_context *ssl, int level,
                               const char *file, int line,
                               const char *format, ... );
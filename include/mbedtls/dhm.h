@@ -144,6 +144,22 @@
 extern "C" {
 #endif
 
+/**
+ * Well-known groups the library carries in preparsed form, with the
+ * Montgomery constant R^2 mod P precomputed, so that selecting one
+ * costs a few binary reads instead of hex parsing and a modular
+ * reduction per handshake
+ */
+typedef enum
+{
+    MBEDTLS_DHM_GROUP_NONE = 0,         /*!<  custom parameters     */
+    MBEDTLS_DHM_GROUP_RFC3526_2048,     /*!<  RFC 3526 group 14     */
+    MBEDTLS_DHM_GROUP_RFC3526_3072,     /*!<  RFC 3526 group 15     */
+    MBEDTLS_DHM_GROUP_RFC3526_4096,     /*!<  RFC 3526 group 16     */
+    MBEDTLS_DHM_GROUP_RFC5114_2048,     /*!<  RFC 5114 group 2.2    */
+}
+mbedtls_dhm_group_id;
+
 /**
  * \brief          DHM context structure
  */
@@ -160,6 +176,8 @@ typedef struct
     mbedtls_mpi Vi;     /*!<  blinding value    */
     mbedtls_mpi Vf;     /*!<  un-blinding value */
     mbedtls_mpi pX;     /*!<  previous X        */
+    int group_id;       /*!<  well-known group the parameters come
+                              from, or MBEDTLS_DHM_GROUP_NONE */
 }
 mbedtls_dhm_context;
 
@@ -170,6 +188,22 @@ mbedtls_dhm_context;
  */
 void mbedtls_dhm_init( mbedtls_dhm_context *ctx );
 
+/**
+ * \brief          Load a well-known group into a DHM context
+ *
+ *                 Sets P, G and the cached Montgomery constant from
+ *                 the library's preparsed form. The range checks on
+ *                 the context's own values are skipped in later calls,
+ *                 since the group is known good.
+ *
+ * \param ctx      DHM context
+ * \param group_id group to load
+ *
+ * \return         0 if successful, or an MBEDTLS_ERR_DHM_XXX error code
+ */
+int mbedtls_dhm_set_group( mbedtls_dhm_context *ctx,
+                           mbedtls_dhm_group_id group_id );
+
 /**
  * \brief          Parse the ServerKeyExchange parameters
  *
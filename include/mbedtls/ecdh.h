@@ -96,6 +96,32 @@ int mbedtls_ecdh_compute_shared( mbedtls_ecp_group *grp, mbedtls_mpi *z,
                          int (*f_rng)(void *, unsigned char *, size_t),
                          void *p_rng );
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/**
+ * \brief           Restartable version of \c mbedtls_ecdh_compute_shared()
+ *
+ * \param grp       ECP group
+ * \param z         Destination MPI (shared secret)
+ * \param Q         Public key from other party
+ * \param d         Our secret exponent (private key)
+ * \param f_rng     RNG function (see notes for
+ *                  \c mbedtls_ecdh_compute_shared())
+ * \param p_rng     RNG parameter
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  operation budget was exhausted (call again with the same
+ *                  parameters to continue),
+ *                  or a MBEDTLS_ERR_ECP_XXX or MBEDTLS_MPI_XXX error code
+ */
+int mbedtls_ecdh_compute_shared_restartable( mbedtls_ecp_group *grp,
+                         mbedtls_mpi *z,
+                         const mbedtls_ecp_point *Q, const mbedtls_mpi *d,
+                         int (*f_rng)(void *, unsigned char *, size_t),
+                         void *p_rng,
+                         mbedtls_ecp_restart_ctx *rs );
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /**
  * \brief           Initialize context
  *
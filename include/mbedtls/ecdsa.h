@@ -27,6 +27,14 @@
 #include "ecp.h"
 #include "md.h"
 
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+#include "hmac_drbg.h"
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+#include "threading.h"
+#endif
+
 /*
  * RFC 4492 page 20:
  *
@@ -47,10 +55,61 @@
 /** Maximum size of an ECDSA signature in bytes */
 #define MBEDTLS_ECDSA_MAX_LEN  ( 3 + 2 * ( 3 + MBEDTLS_ECP_MAX_BYTES ) )
 
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+/**
+ * \brief           ECDSA context structure
+ *
+ * \note            Starts with the members of an mbedtls_ecp_keypair, in
+ *                  the same order, so generic EC key code can keep
+ *                  addressing the key parts. The trailing HMAC-DRBG
+ *                  context is kept across deterministic signatures and
+ *                  re-seeded in place per message, saving its md setup
+ *                  (two heap allocations) on every signature.
+ */
+typedef struct
+{
+    mbedtls_ecp_group grp;      /*!<  Elliptic curve and base point     */
+    mbedtls_mpi d;              /*!<  our secret value                  */
+    mbedtls_ecp_point Q;        /*!<  our public value                  */
+    mbedtls_hmac_drbg_context det_rng;  /*!<  reusable signing DRBG     */
+}
+mbedtls_ecdsa_context;
+#else
 /**
  * \brief           ECDSA context structure
  */
 typedef mbedtls_ecp_keypair mbedtls_ecdsa_context;
+#endif /* MBEDTLS_ECDSA_DETERMINISTIC */
+
+#if !defined(MBEDTLS_ECDSA_NONCE_CACHE_SIZE)
+#define MBEDTLS_ECDSA_NONCE_CACHE_SIZE  8 /**< Maximum precomputed nonces held by a cache */
+#endif
+
+/**
+ * \brief           Cache of precomputed signing nonces
+ *
+ *                  Holds ready ( r = (x of kG) mod N, k^-1 mod N ) pairs for
+ *                  one curve, so that the per-signature work in
+ *                  mbedtls_ecdsa_sign_cached() reduces to two modular
+ *                  multiplications. The pairs depend only on the curve, not
+ *                  on the signing key.
+ *
+ *                  Refill the cache with mbedtls_ecdsa_nonce_cache_fill(),
+ *                  typically from a background thread; with
+ *                  MBEDTLS_THREADING_C defined, filling and signing may run
+ *                  concurrently.
+ */
+typedef struct
+{
+    mbedtls_ecp_group_id grp_id;                        /*!<  curve the nonces are for  */
+    size_t count;                                       /*!<  number of ready nonces    */
+    mbedtls_mpi r[MBEDTLS_ECDSA_NONCE_CACHE_SIZE];      /*!<  x coordinate of kG mod N  */
+    mbedtls_mpi k_inv[MBEDTLS_ECDSA_NONCE_CACHE_SIZE];  /*!<  k^-1 mod N                */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;                    /*!<  guards count and entries  */
+#endif
+}
+mbedtls_ecdsa_nonce_cache;
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,6 +136,71 @@ int mbedtls_ecdsa_sign( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
                 const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
                 int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
 
+/**
+ * \brief           Initialize a nonce cache
+ *
+ * \param cache     Cache to initialize
+ */
+void mbedtls_ecdsa_nonce_cache_init( mbedtls_ecdsa_nonce_cache *cache );
+
+/**
+ * \brief           Free the components of a nonce cache
+ *
+ * \param cache     Cache to free
+ */
+void mbedtls_ecdsa_nonce_cache_free( mbedtls_ecdsa_nonce_cache *cache );
+
+/**
+ * \brief           Top up a nonce cache with precomputed nonces for the
+ *                  given group
+ *
+ *                  This performs the expensive part of signing (ephemeral
+ *                  keypair generation and modular inversion) ahead of time;
+ *                  call it whenever the signing thread is idle, or from a
+ *                  dedicated thread.
+ *
+ * \param cache     Cache to fill
+ * \param grp       ECP group the nonces are for; a cache holds nonces for
+ *                  one curve at a time, switching groups drops any pending
+ *                  nonces
+ * \param f_rng     RNG function
+ * \param p_rng     RNG parameter
+ *
+ * \return          0 if successful,
+ *                  or a MBEDTLS_ERR_ECP_XXX or MBEDTLS_MPI_XXX error code
+ */
+int mbedtls_ecdsa_nonce_cache_fill( mbedtls_ecdsa_nonce_cache *cache,
+                mbedtls_ecp_group *grp,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
+
+/**
+ * \brief           Compute an ECDSA signature using a precomputed nonce
+ *                  when one is available
+ *
+ *                  With a ready nonce this costs two modular
+ *                  multiplications; with an empty cache (or one filled for
+ *                  another curve) it behaves exactly like
+ *                  mbedtls_ecdsa_sign().
+ *
+ * \param grp       ECP group
+ * \param cache     Nonce cache to draw from
+ * \param r         First output integer
+ * \param s         Second output integer
+ * \param d         Private signing key
+ * \param buf       Message hash
+ * \param blen      Length of buf
+ * \param f_rng     RNG function (used when falling back)
+ * \param p_rng     RNG parameter
+ *
+ * \return          0 if successful,
+ *                  or a MBEDTLS_ERR_ECP_XXX or MBEDTLS_MPI_XXX error code
+ */
+int mbedtls_ecdsa_sign_cached( mbedtls_ecp_group *grp,
+                mbedtls_ecdsa_nonce_cache *cache,
+                mbedtls_mpi *r, mbedtls_mpi *s,
+                const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
+
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
 /**
  * \brief           Compute ECDSA signature of a previously hashed message,
@@ -116,6 +240,92 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
                   const unsigned char *buf, size_t blen,
                   const mbedtls_ecp_point *Q, const mbedtls_mpi *r, const mbedtls_mpi *s);
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/**
+ * \brief           Restart context for restartable ECDSA operations
+ *
+ *                  Initialize with mbedtls_ecdsa_restart_init(), pass to the
+ *                  _restartable functions, free with
+ *                  mbedtls_ecdsa_restart_free(). A context must not be
+ *                  shared between a signature and a verification, nor
+ *                  between operations on different inputs.
+ */
+typedef struct
+{
+    mbedtls_mpi k;              /*!< ephemeral secret (signature)          */
+    mbedtls_mpi u1;             /*!< first scalar (verification)           */
+    mbedtls_mpi u2;             /*!< second scalar (verification)          */
+    unsigned char cheap_done;   /*!< non-ECP steps already performed       */
+    mbedtls_ecp_restart_ctx rs; /*!< state of the ECP operation            */
+}
+mbedtls_ecdsa_restart_ctx;
+
+/**
+ * \brief           Initialize a restart context
+ *
+ * \param ctx       Context to initialize
+ */
+void mbedtls_ecdsa_restart_init( mbedtls_ecdsa_restart_ctx *ctx );
+
+/**
+ * \brief           Free the components of a restart context
+ *
+ * \param ctx       Context to free
+ */
+void mbedtls_ecdsa_restart_free( mbedtls_ecdsa_restart_ctx *ctx );
+
+/**
+ * \brief           Restartable version of \c mbedtls_ecdsa_sign()
+ *
+ *                  Performs at most the number of basic operations set by
+ *                  mbedtls_ecp_set_max_ops() per call, then returns
+ *                  MBEDTLS_ERR_ECP_IN_PROGRESS; call again with the same
+ *                  parameters to continue. With rs set to NULL or no limit
+ *                  set, equivalent to \c mbedtls_ecdsa_sign().
+ *
+ * \param grp       ECP group
+ * \param r         First output integer
+ * \param s         Second output integer
+ * \param d         Private signing key
+ * \param buf       Message hash
+ * \param blen      Length of buf
+ * \param f_rng     RNG function
+ * \param p_rng     RNG parameter
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  operation budget was exhausted,
+ *                  or a MBEDTLS_ERR_ECP_XXX or MBEDTLS_MPI_XXX error code
+ */
+int mbedtls_ecdsa_sign_restartable( mbedtls_ecp_group *grp,
+                mbedtls_mpi *r, mbedtls_mpi *s,
+                const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+                mbedtls_ecdsa_restart_ctx *rs );
+
+/**
+ * \brief           Restartable version of \c mbedtls_ecdsa_verify()
+ *
+ * \param grp       ECP group
+ * \param buf       Message hash
+ * \param blen      Length of buf
+ * \param Q         Public key to use for verification
+ * \param r         First integer of the signature
+ * \param s         Second integer of the signature
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  operation budget was exhausted,
+ *                  MBEDTLS_ERR_ECP_BAD_INPUT_DATA if signature is invalid
+ *                  or a MBEDTLS_ERR_ECP_XXX or MBEDTLS_MPI_XXX error code
+ */
+int mbedtls_ecdsa_verify_restartable( mbedtls_ecp_group *grp,
+                  const unsigned char *buf, size_t blen,
+                  const mbedtls_ecp_point *Q,
+                  const mbedtls_mpi *r, const mbedtls_mpi *s,
+                  mbedtls_ecdsa_restart_ctx *rs );
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /**
  * \brief           Compute ECDSA signature and write it to buffer,
  *                  serialized as defined in RFC 4492 page 20.
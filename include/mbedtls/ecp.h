@@ -37,6 +37,7 @@
 #define MBEDTLS_ERR_ECP_RANDOM_FAILED                     -0x4D00  /**< Generation of random value, such as (ephemeral) key, failed. */
 #define MBEDTLS_ERR_ECP_INVALID_KEY                       -0x4C80  /**< Invalid private or public key. */
 #define MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH                  -0x4C00  /**< Signature is valid but shorter than the user-supplied length. */
+#define MBEDTLS_ERR_ECP_IN_PROGRESS                       -0x4B80  /**< Operation in progress, call again with the same parameters to continue. */
 
 #ifdef __cplusplus
 extern "C" {
@@ -126,8 +127,14 @@ mbedtls_ecp_point;
  * than pbits, so that the integer may be efficiently brought in the 0..P-1
  * range by a few additions or substractions. It must return 0 on success and
  * non-zero on failure.
+ *
+ * The field_mul/field_sqr/field_add pointers, when non-NULL, provide
+ * specialized field arithmetic for the curve: each computes its result
+ * fully reduced in the 0..P-1 range, from operands in that same range.
+ * They are installed by mbedtls_ecp_group_load() for curves that have a
+ * dedicated implementation; when NULL the generic bignum path is used.
  */
-typedef struct
+typedef struct mbedtls_ecp_group
 {
     mbedtls_ecp_group_id id;    /*!<  internal group identifier                     */
     mbedtls_mpi P;              /*!<  prime modulus of the base field               */
@@ -139,11 +146,21 @@ typedef struct
     size_t nbits;       /*!<  number of bits in 1. P, or 2. private keys    */
     unsigned int h;     /*!<  internal: 1 if the constants are static       */
     int (*modp)(mbedtls_mpi *); /*!<  function for fast reduction mod P             */
+    int (*field_mul)( const struct mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                      const mbedtls_mpi *A, const mbedtls_mpi *B );
+                                /*!<  specialized X = A * B mod P, or NULL          */
+    int (*field_sqr)( const struct mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                      const mbedtls_mpi *A );
+                                /*!<  specialized X = A^2 mod P, or NULL            */
+    int (*field_add)( const struct mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                      const mbedtls_mpi *A, const mbedtls_mpi *B );
+                                /*!<  specialized X = A + B mod P, or NULL          */
     int (*t_pre)(mbedtls_ecp_point *, void *);  /*!< unused                         */
     int (*t_post)(mbedtls_ecp_point *, void *); /*!< unused                         */
     void *t_data;                       /*!< unused                         */
     mbedtls_ecp_point *T;       /*!<  pre-computed points for ecp_mul_comb()        */
     size_t T_size;      /*!<  number for pre-computed points                */
+    mbedtls_mpi RR_N;   /*!<  cached R^2 mod N for exponentiation mod N     */
 }
 mbedtls_ecp_group;
 
@@ -221,6 +238,36 @@ mbedtls_ecp_keypair;
 
 /* \} name SECTION: Module settings */
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/**
+ * \brief           Restart context for resumable point multiplication.
+ *
+ *                  All fields are for internal use: initialize with
+ *                  mbedtls_ecp_restart_init(), pass to the _restartable
+ *                  functions, free with mbedtls_ecp_restart_free(). A
+ *                  context may be reused for a new operation once the
+ *                  previous one returned 0 or a fatal error.
+ */
+typedef struct
+{
+    int state;                  /*!< operation progress                   */
+    unsigned char w;            /*!< comb window size                     */
+    unsigned char pre_len;      /*!< number of precomputed points         */
+    unsigned char m_is_odd;     /*!< sign bookkeeping for the recoding    */
+    unsigned char phase;        /*!< progress of a multi-mul operation    */
+    size_t i;                   /*!< outer loop progress                  */
+    size_t j;                   /*!< inner loop progress                  */
+    size_t d;                   /*!< number of comb windows               */
+    unsigned char k[ ( MBEDTLS_ECP_MAX_BITS + 1 ) / 2 + 1 ];
+                                /*!< comb recoding of the scalar          */
+    mbedtls_ecp_point R;        /*!< partial result                       */
+    mbedtls_ecp_point mP;       /*!< first term of a linear combination   */
+    mbedtls_ecp_point *T;       /*!< owned table of precomputed points    */
+    const mbedtls_ecp_point *Tc;/*!< table in use (owned or shared)       */
+}
+mbedtls_ecp_restart_ctx;
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /*
  * Point formats, from RFC 4492's enum ECPointFormat
  */
@@ -449,6 +496,34 @@ int mbedtls_ecp_tls_write_point( const mbedtls_ecp_group *grp, const mbedtls_ecp
  */
 int mbedtls_ecp_group_load( mbedtls_ecp_group *grp, mbedtls_ecp_group_id index );
 
+/**
+ * \brief           Retrieve the precomputed comb table for the base point
+ *                  of a well-known curve, if one was compiled in.
+ *
+ *                  For internal use by the point multiplication code only;
+ *                  the layout of the returned table is tied to the comb
+ *                  algorithm in ecp.c.
+ *
+ * \param id        Curve identifier
+ * \param w         Comb window size the table must have been built for
+ *
+ * \return          Pointer to a read-only table of 2^(w-1) points,
+ *                  or NULL if no matching table is available.
+ */
+const mbedtls_ecp_point *mbedtls_ecp_comb_table_lookup( mbedtls_ecp_group_id id,
+                                                        unsigned char w );
+
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+/**
+ * \brief           Free the process-wide comb table cache.
+ *
+ * \note            Call this at the end of the program, after all threads
+ *                  using ECP are done; it is not protected against
+ *                  concurrent ECP operations.
+ */
+void mbedtls_ecp_comb_cache_free( void );
+#endif /* MBEDTLS_ECP_COMB_TABLE_CACHE */
+
 /**
  * \brief           Set a group from a TLS ECParameters record
  *
@@ -508,6 +583,110 @@ int mbedtls_ecp_mul( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
              int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/**
+ * \brief           Set the maximum number of basic operations (in units of
+ *                  field multiplications) performed per call to the
+ *                  _restartable functions before they save their state and
+ *                  return MBEDTLS_ERR_ECP_IN_PROGRESS.
+ *
+ *                  Lower values mean shorter time slices (a point doubling
+ *                  counts as 8, an addition as 11, an inversion as 120).
+ *                  0 (the default) disables slicing: the _restartable
+ *                  functions then run to completion.
+ *
+ * \param max_ops   Maximum number of basic operations per call, or 0
+ */
+void mbedtls_ecp_set_max_ops( unsigned max_ops );
+
+/**
+ * \brief           Initialize a restart context (makes it ready for use or
+ *                  freeing)
+ *
+ * \param rs        Restart context
+ */
+void mbedtls_ecp_restart_init( mbedtls_ecp_restart_ctx *rs );
+
+/**
+ * \brief           Free the components of a restart context, aborting any
+ *                  operation in progress
+ *
+ * \param rs        Restart context
+ */
+void mbedtls_ecp_restart_free( mbedtls_ecp_restart_ctx *rs );
+
+/**
+ * \brief           Restartable version of mbedtls_ecp_mul()
+ *
+ *                  Performs at most the configured number of basic
+ *                  operations (see mbedtls_ecp_set_max_ops()), then returns
+ *                  MBEDTLS_ERR_ECP_IN_PROGRESS; call again with the same
+ *                  arguments to continue. R is only written once the
+ *                  operation completes.
+ *
+ * \note            Only curves in short Weierstrass form can be sliced;
+ *                  for Montgomery curves the operation runs to completion.
+ *
+ * \param grp       ECP group
+ * \param R         Destination point
+ * \param m         Integer by which to multiply
+ * \param P         Point to multiply
+ * \param f_rng     RNG function (see mbedtls_ecp_mul())
+ * \param p_rng     RNG parameter
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  maximum number of operations was reached, or a
+ *                  MBEDTLS_ERR_ECP_XXX or MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_mul_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+             mbedtls_ecp_restart_ctx *rs );
+
+/**
+ * \brief           Restartable version of mbedtls_ecp_muladd():
+ *                  the two multiplications are sliced one after the other
+ *
+ * \param grp       ECP group (must be a short Weierstrass group)
+ * \param R         Destination point
+ * \param m         Integer by which to multiply P
+ * \param P         Point to multiply by m
+ * \param n         Integer by which to multiply Q
+ * \param Q         Point to be multiplied by n
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  maximum number of operations was reached, or a
+ *                  MBEDTLS_ERR_ECP_XXX or MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_muladd_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
+             mbedtls_ecp_restart_ctx *rs );
+
+/**
+ * \brief           Restartable version of mbedtls_ecp_gen_keypair():
+ *                  the secret value is generated on the first call, the
+ *                  public point is computed with the sliced multiplication
+ *
+ * \param grp       ECP group
+ * \param d         Destination MPI (secret part)
+ * \param Q         Destination point (public part)
+ * \param f_rng     RNG function
+ * \param p_rng     RNG parameter
+ * \param rs        Restart context
+ *
+ * \return          0 if successful, MBEDTLS_ERR_ECP_IN_PROGRESS if the
+ *                  maximum number of operations was reached, or a
+ *                  MBEDTLS_ERR_ECP_XXX or MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_gen_keypair_restartable( mbedtls_ecp_group *grp,
+             mbedtls_mpi *d, mbedtls_ecp_point *Q,
+             int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+             mbedtls_ecp_restart_ctx *rs );
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /**
  * \brief           Multiplication and addition of two points by integers:
  *                  R = m * P + n * Q
@@ -532,6 +711,107 @@ int mbedtls_ecp_muladd( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
              const mbedtls_mpi *n, const mbedtls_ecp_point *Q );
 
+/**
+ * \brief           Normalize a batch of points in Jacobian coordinates,
+ *                  sharing a single modular inversion between them
+ *                  (Montgomery's simultaneous-inversion trick)
+ *
+ * \note            Points at infinity (Z == 0) are left untouched, all
+ *                  others end up with Z == 1.
+ *
+ * \param grp       ECP group (must be a short Weierstrass group)
+ * \param T         Array of t_len pointers to the points to normalize
+ * \param t_len     Number of points
+ *
+ * \return          0 if successful,
+ *                  MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE for Montgomery
+ *                  curves, or MBEDTLS_ERR_MPI_XXX on error
+ */
+int mbedtls_ecp_normalize_many( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point *T[], size_t t_len );
+
+/**
+ * \brief           Batch version of mbedtls_ecp_muladd():
+ *                  R[i] = m[i] * P[i] + n[i] * Q[i] for 0 <= i < len,
+ *                  with a single shared inversion for the conversion of
+ *                  all results back to affine coordinates
+ *
+ * \note            Like mbedtls_ecp_muladd(), this function does not
+ *                  guarantee a constant execution flow and timing, so it
+ *                  must only be used with public values, typically
+ *                  signature verification.
+ *
+ * \param grp       ECP group (must be a short Weierstrass group)
+ * \param R         Array of len pointers to the destination points
+ * \param m         Array of len integers by which to multiply the P[i]
+ * \param P         Array of len pointers to the points to multiply by m[i]
+ * \param n         Array of len integers by which to multiply the Q[i]
+ * \param Q         Array of len pointers to the points to multiply by n[i]
+ * \param len       Number of linear combinations to compute
+ *
+ * \return          0 if successful, or a MBEDTLS_ERR_ECP_XXX or
+ *                  MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_muladd_many( mbedtls_ecp_group *grp, mbedtls_ecp_point *R[],
+             const mbedtls_mpi *m[], const mbedtls_ecp_point *P[],
+             const mbedtls_mpi *n[], const mbedtls_ecp_point *Q[],
+             size_t len );
+
+/**
+ * \brief           Variable-time multiplication R = m * P using wNAF
+ *
+ *                  This skips the side-channel countermeasures of
+ *                  mbedtls_ecp_mul() (full-table scans, coordinate
+ *                  randomization), making it noticeably faster.
+ *
+ * \warning         Execution time and memory access patterns depend on m
+ *                  and P. This function must only be used when both are
+ *                  public values, typically signature verification. Use
+ *                  mbedtls_ecp_mul() whenever any input is secret.
+ *
+ * \param grp       ECP group (must be a short Weierstrass group)
+ * \param R         Destination point
+ * \param m         Integer by which to multiply, 0 <= m < N
+ * \param P         Point to multiply (must be a valid public key)
+ *
+ * \return          0 if successful,
+ *                  MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE for Montgomery
+ *                  curves, MBEDTLS_ERR_ECP_INVALID_KEY if P is not valid,
+ *                  MBEDTLS_ERR_ECP_BAD_INPUT_DATA if m is out of range,
+ *                  or a MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_mul_vartime( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P );
+
+/**
+ * \brief           Variable-time linear combination R = m * P + n * Q
+ *
+ *                  The two scalars are recoded in wNAF and processed in a
+ *                  single interleaved loop, so the doublings are shared:
+ *                  this is nearly twice as fast as two separate
+ *                  multiplications, which is what mbedtls_ecp_muladd()
+ *                  performs.
+ *
+ * \warning         Like mbedtls_ecp_mul_vartime(), this function must only
+ *                  be used with public values.
+ *
+ * \param grp       ECP group (must be a short Weierstrass group)
+ * \param R         Destination point
+ * \param m         Integer by which to multiply P, 0 <= m < N
+ * \param P         Point to multiply by m (must be a valid public key)
+ * \param n         Integer by which to multiply Q, 0 <= n < N
+ * \param Q         Point to multiply by n (must be a valid public key)
+ *
+ * \return          0 if successful,
+ *                  MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE for Montgomery
+ *                  curves, MBEDTLS_ERR_ECP_INVALID_KEY if P or Q is not
+ *                  valid, MBEDTLS_ERR_ECP_BAD_INPUT_DATA if m or n is out
+ *                  of range, or a MBEDTLS_ERR_MPI_XXX error code
+ */
+int mbedtls_ecp_muladd_vartime( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q );
+
 /**
  * \brief           Check that a point is a valid public key on this curve
  *
@@ -76,6 +76,10 @@
 
 #if defined(MBEDTLS_ENTROPY_SHA512_ACCUMULATOR)
 #define MBEDTLS_ENTROPY_BLOCK_SIZE      64      /**< Block size of entropy accumulator (SHA-512) */
+
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+#define MBEDTLS_ENTROPY_PREFETCH_BLOCKS     4   /**< Blocks kept in the pre-gathered pool */
+#endif
 #else
 #define MBEDTLS_ENTROPY_BLOCK_SIZE      32      /**< Block size of entropy accumulator (SHA-256) */
 #endif
@@ -129,6 +133,11 @@ typedef struct
 #endif
     int             source_count;
     mbedtls_entropy_source_state    source[MBEDTLS_ENTROPY_MAX_SOURCES];
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+    unsigned char   pool[MBEDTLS_ENTROPY_PREFETCH_BLOCKS]
+                        [MBEDTLS_ENTROPY_BLOCK_SIZE]; /**< pre-gathered blocks */
+    size_t          pool_count; /**< number of blocks available in the pool */
+#endif
 #if defined(MBEDTLS_HAVEGE_C)
     mbedtls_havege_state    havege_data;
 #endif
@@ -196,6 +205,23 @@ int mbedtls_entropy_gather( mbedtls_entropy_context *ctx );
  */
 int mbedtls_entropy_func( void *data, unsigned char *output, size_t len );
 
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+/**
+ * \brief           Gather entropy ahead of time into the context's pool
+ *
+ *                  Call this from idle moments; while the pool is non-empty,
+ *                  mbedtls_entropy_func() serves requests from it with a
+ *                  short copy instead of polling every source under the
+ *                  context mutex. Each call fills at most one block.
+ *
+ * \param ctx       Entropy context
+ *
+ * \return          0 if successful (including when the pool is already
+ *                  full), or a source failure code
+ */
+int mbedtls_entropy_prefetch( mbedtls_entropy_context *ctx );
+#endif /* MBEDTLS_ENTROPY_PREFETCH */
+
 /**
  * \brief           Add data to the accumulator manually
  *                  (Thread-safe if MBEDTLS_THREADING_C is enabled)
@@ -43,6 +43,7 @@ extern "C" {
 #define MBEDTLS_ENTROPY_MIN_HAVEGE       32     /**< Minimum for HAVEGE             */
 #define MBEDTLS_ENTROPY_MIN_HARDCLOCK     4     /**< Minimum for mbedtls_timing_hardclock()        */
 #define MBEDTLS_ENTROPY_MIN_HARDWARE     32     /**< Minimum for the hardware source */
+#define MBEDTLS_ENTROPY_MIN_RDSEED       32     /**< Minimum for the RDSEED source  */
 
 #if !defined(MBEDTLS_NO_PLATFORM_ENTROPY)
 /**
@@ -70,6 +71,26 @@ int mbedtls_hardclock_poll( void *data,
                     unsigned char *output, size_t len, size_t *olen );
 #endif
 
+#if defined(MBEDTLS_ENTROPY_RDSEED)
+/**
+ * \brief           Check whether the CPU offers RDSEED or RDRAND
+ *
+ * \return          1 if either instruction is available, 0 otherwise
+ *                  (always 0 on platforms other than x86-64)
+ */
+int mbedtls_rdseed_has_support( void );
+
+/**
+ * \brief           RDSEED-based entropy poll callback, using RDRAND when
+ *                  RDSEED is unavailable or temporarily exhausted
+ *
+ * \note            Only call when mbedtls_rdseed_has_support() returns 1;
+ *                  mbedtls_entropy_init() checks before registering it.
+ */
+int mbedtls_rdseed_poll( void *data,
+                         unsigned char *output, size_t len, size_t *olen );
+#endif
+
 #if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
 /**
  * \brief           Entropy poll callback for a hardware source
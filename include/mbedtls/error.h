@@ -67,6 +67,9 @@
  * PBKDF2    1  0x007C-0x007C
  * HMAC_DRBG 4  0x0003-0x0009
  * CCM       2                  0x000D-0x000F
+ * CHACHA20  1  0x0054-0x0054
+ * POLY1305  1  0x0058-0x0058
+ * CHACHAPOLY 2                 0x0047-0x0049
  *
  * High-level module nr (3 bits - 0x0...-0x7...)
  * Name      ID  Nr of Errors
@@ -101,6 +104,34 @@ extern "C" {
  */
 void mbedtls_strerror( int errnum, char *buffer, size_t buflen );
 
+/**
+ * \brief Translate the high-level part of an mbed TLS error code into a
+ *        string representation.
+ *
+ * This function returns a const pointer to an un-modifiable string, so it
+ * can be called on every failure without a buffer or any copying.
+ *
+ * \param errnum    error code
+ *
+ * \return The string representation of the high-level part of the error
+ *         code, or NULL if it is unknown.
+ */
+const char *mbedtls_high_level_strerr( int errnum );
+
+/**
+ * \brief Translate the low-level part of an mbed TLS error code into a
+ *        string representation.
+ *
+ * This function returns a const pointer to an un-modifiable string, so it
+ * can be called on every failure without a buffer or any copying.
+ *
+ * \param errnum    error code
+ *
+ * \return The string representation of the low-level part of the error
+ *         code, or NULL if it is unknown.
+ */
+const char *mbedtls_low_level_strerr( int errnum );
+
 #ifdef __cplusplus
 }
 #endif
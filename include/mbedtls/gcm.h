@@ -45,11 +45,19 @@ typedef struct {
     mbedtls_cipher_context_t cipher_ctx;/*!< cipher context used */
     uint64_t HL[16];            /*!< Precalculated HTable */
     uint64_t HH[16];            /*!< Precalculated HTable */
+#if defined(MBEDTLS_GCM_LARGETABLE)
+    uint64_t HL8[256];          /*!< Precalculated 8-bit HTable */
+    uint64_t HH8[256];          /*!< Precalculated 8-bit HTable */
+#endif
+#if defined(MBEDTLS_AESNI_C)
+    unsigned char HP[64];       /*!< H^4..H^1, byte-reversed, for CLMUL */
+#endif
     uint64_t len;               /*!< Total data length */
     uint64_t add_len;           /*!< Total add length */
     unsigned char base_ectr[16];/*!< First ECTR for tag */
     unsigned char y[16];        /*!< Y working value */
     unsigned char buf[16];      /*!< buf working value */
+    unsigned char ectr[16];     /*!< keystream of the current partial block */
     int mode;                   /*!< Encrypt or Decrypt */
 }
 mbedtls_gcm_context;
@@ -144,6 +152,71 @@ int mbedtls_gcm_auth_decrypt( mbedtls_gcm_context *ctx,
                       const unsigned char *input,
                       unsigned char *output );
 
+/**
+ * \brief           GCM buffer encryption/decryption from scattered input,
+ *                  for example straight from application buffers into a
+ *                  record buffer without assembling the input first
+ *
+ * \note The output buffer must not overlap the input segments.
+ *
+ * \param ctx       GCM context
+ * \param mode      MBEDTLS_GCM_ENCRYPT or MBEDTLS_GCM_DECRYPT
+ * \param iov       input segments
+ * \param iov_count number of input segments
+ * \param iv        initialization vector
+ * \param iv_len    length of IV
+ * \param add       additional data
+ * \param add_len   length of additional data
+ * \param output    buffer for holding the output data; must be at least
+ *                  as large as the total length of the input segments
+ * \param tag_len   length of the tag to generate
+ * \param tag       buffer for holding the tag
+ *
+ * \return         0 if successful
+ */
+int mbedtls_gcm_crypt_and_tag_iov( mbedtls_gcm_context *ctx,
+                       int mode,
+                       const mbedtls_iovec *iov,
+                       size_t iov_count,
+                       const unsigned char *iv,
+                       size_t iv_len,
+                       const unsigned char *add,
+                       size_t add_len,
+                       unsigned char *output,
+                       size_t tag_len,
+                       unsigned char *tag );
+
+/**
+ * \brief           GCM buffer authenticated decryption from scattered input
+ *
+ * \note The output buffer must not overlap the input segments.
+ *
+ * \param ctx       GCM context
+ * \param iov       input segments
+ * \param iov_count number of input segments
+ * \param iv        initialization vector
+ * \param iv_len    length of IV
+ * \param add       additional data
+ * \param add_len   length of additional data
+ * \param tag       buffer holding the tag
+ * \param tag_len   length of the tag
+ * \param output    buffer for holding the output data; must be at least
+ *                  as large as the total length of the input segments
+ *
+ * \return         0 if successful and authenticated,
+ *                 MBEDTLS_ERR_GCM_AUTH_FAILED if tag does not match
+ */
+int mbedtls_gcm_auth_decrypt_iov( mbedtls_gcm_context *ctx,
+                      const mbedtls_iovec *iov,
+                      size_t iov_count,
+                      const unsigned char *iv,
+                      size_t iv_len,
+                      const unsigned char *add,
+                      size_t add_len,
+                      const unsigned char *tag,
+                      size_t tag_len,
+                      unsigned char *output );
+
 /**
  * \brief           Generic GCM stream start function
  *
@@ -165,9 +238,11 @@ int mbedtls_gcm_starts( mbedtls_gcm_context *ctx,
 
 /**
  * \brief           Generic GCM update function. Encrypts/decrypts using the
- *                  given GCM context. Expects input to be a multiple of 16
- *                  bytes! Only the last call before mbedtls_gcm_finish() can be less
- *                  than 16 bytes!
+ *                  given GCM context. May be called repeatedly with chunks
+ *                  of arbitrary length: a trailing partial block is carried
+ *                  in the context, so the next call continues its keystream
+ *                  and its GHASH contribution is folded in once the block
+ *                  completes, or at mbedtls_gcm_finish().
  *
  * \note On decryption, the output buffer cannot be the same as input buffer.
  *       If buffers overlap, the output buffer must trail at least 8 bytes
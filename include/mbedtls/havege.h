@@ -38,6 +38,8 @@ extern "C" {
 typedef struct
 {
     int PT1, PT2, offset[2];
+    int rounds;     /*!< iterations per fill, calibrated at init against
+                         the jitter of the hardware clock               */
     int pool[MBEDTLS_HAVEGE_COLLECT_SIZE];
     int WALK[8192];
 }
@@ -0,0 +1,54 @@
+/**
+ * \file hints.h
+ *
+ * \brief Portable compiler hints: branch expectations and data prefetch
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_HINTS_H
+#define MBEDTLS_HINTS_H
+
+/*
+ * These are pure performance annotations: on compilers without the
+ * underlying builtins they disappear entirely, so they must never be
+ * relied on for correctness, and should only decorate sites where
+ * profiling has shown demand misses or a strongly biased branch.
+ *
+ * MBEDTLS_LIKELY / MBEDTLS_UNLIKELY wrap a condition whose outcome is
+ * almost always true / false (e.g. error paths). MBEDTLS_PREFETCH_R /
+ * MBEDTLS_PREFETCH_W request a read / write prefetch of the cache line
+ * holding the given address.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+
+#define MBEDTLS_LIKELY( cond )      __builtin_expect( !!( cond ), 1 )
+#define MBEDTLS_UNLIKELY( cond )    __builtin_expect( !!( cond ), 0 )
+#define MBEDTLS_PREFETCH_R( addr )  __builtin_prefetch( ( addr ), 0 )
+#define MBEDTLS_PREFETCH_W( addr )  __builtin_prefetch( ( addr ), 1 )
+
+#else /* __GNUC__ || __clang__ */
+
+#define MBEDTLS_LIKELY( cond )      ( cond )
+#define MBEDTLS_UNLIKELY( cond )    ( cond )
+#define MBEDTLS_PREFETCH_R( addr )  do { } while( 0 )
+#define MBEDTLS_PREFETCH_W( addr )  do { } while( 0 )
+
+#endif /* __GNUC__ || __clang__ */
+
+#endif /* hints.h */
@@ -88,6 +88,11 @@ typedef struct
                                      reseed before every random generation) */
     int reseed_interval;        /*!< reseed interval   */
 
+    /* Batched generation (see mbedtls_hmac_drbg_set_batch()) */
+    unsigned char *batch;       /*!< buffered output, NULL when disabled     */
+    size_t batch_len;           /*!< capacity of the batch buffer            */
+    size_t batch_left;          /*!< buffered bytes not yet handed out       */
+
     /* Callbacks */
     int (*f_entropy)(void *, unsigned char *, size_t); /*!< entropy function */
     void *p_entropy;            /*!< context for the entropy function        */
@@ -188,6 +193,33 @@ void mbedtls_hmac_drbg_set_entropy_len( mbedtls_hmac_drbg_context *ctx,
 void mbedtls_hmac_drbg_set_reseed_interval( mbedtls_hmac_drbg_context *ctx,
                                     int interval );
 
+/**
+ * \brief               Enable batched generation (Default: off)
+ *
+ *                      With a batch buffer set, requests without additional
+ *                      data that fit in the buffer are served from it, and a
+ *                      refill generates len bytes in a single cycle. This
+ *                      amortizes the two-pass state update over many small
+ *                      draws (nonce generation and the like).
+ *
+ * \note                The output stream then equals that of one len-byte
+ *                      request per refill rather than one request per call,
+ *                      so do not enable this where the exact per-call output
+ *                      sequence matters (e.g. deterministic ECDSA or replaying
+ *                      NIST test vectors). Additional data and reseeding
+ *                      invalidate the unread part of the buffer.
+ *
+ * \param ctx           HMAC_DRBG context, already seeded
+ * \param len           Batch size in bytes (at most
+ *                      MBEDTLS_HMAC_DRBG_MAX_REQUEST), or 0 to disable
+ *
+ * \return              0 if successful, or
+ *                      MBEDTLS_ERR_HMAC_DRBG_REQUEST_TOO_BIG, or
+ *                      MBEDTLS_ERR_MD_ALLOC_FAILED.
+ */
+int mbedtls_hmac_drbg_set_batch( mbedtls_hmac_drbg_context *ctx,
+                                 size_t len );
+
 /**
  * \brief               HMAC_DRBG update state
  *
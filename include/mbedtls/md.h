@@ -26,6 +26,12 @@
 #ifndef MBEDTLS_MD_H
 #define MBEDTLS_MD_H
 
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
 #include <stddef.h>
 
 #if ( defined(__ARMCC_VERSION) || defined(_MSC_VER) ) && !defined(inline)
@@ -37,6 +43,20 @@
 #define MBEDTLS_ERR_MD_ALLOC_FAILED                       -0x5180  /**< Failed to allocate memory. */
 #define MBEDTLS_ERR_MD_FILE_IO_ERROR                      -0x5200  /**< Opening or reading of file failed. */
 
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_MD_FILE_CHUNK_SIZE
+#define MBEDTLS_MD_FILE_CHUNK_SIZE   65536 /**< Read size used by mbedtls_md_file(), amortizes the I/O over the hashing */
+#endif
+
+/* \} name SECTION: Module settings */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -60,6 +80,12 @@ typedef enum {
 #define MBEDTLS_MD_MAX_SIZE         32  /* longest known is SHA256 or less */
 #endif
 
+#if defined(MBEDTLS_SHA512_C)
+#define MBEDTLS_MD_MAX_BLOCK_SIZE  128  /* longest known is SHA384/512 */
+#else
+#define MBEDTLS_MD_MAX_BLOCK_SIZE   64
+#endif
+
 /**
  * Opaque struct defined in md_internal.h
  */
@@ -77,6 +103,15 @@ typedef struct {
 
     /** HMAC part of the context */
     void *hmac_ctx;
+
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    /** Digest state cached right after absorbing the ipad block,
+     *  cloned back instead of recomputed by mbedtls_md_hmac_reset() */
+    void *hmac_ipad_ctx;
+
+    /** Same for the opad block, used by mbedtls_md_hmac_finish() */
+    void *hmac_opad_ctx;
+#endif
 } mbedtls_md_context_t;
 
 /**
@@ -167,9 +202,13 @@ int mbedtls_md_setup( mbedtls_md_context_t *ctx, const mbedtls_md_info_t *md_inf
  * \brief           Clone the state of an MD context
  *
  * \note            The two contexts must have been setup to the same type
- *                  (cloning from SHA-256 to SHA-512 make no sense).
+ *                  (cloning from SHA-256 to SHA-512 make no sense), and
+ *                  either both or neither with HMAC enabled.
  *
- * \warning         Only clones the MD state, not the HMAC state! (for now)
+ * \note            When both contexts were setup for HMAC, the HMAC state
+ *                  (key pads and any cached pad states) is cloned as well,
+ *                  so the destination can checkpoint a partly-authenticated
+ *                  message.
  *
  * \param dst       The destination context
  * \param src       The context to be cloned
@@ -260,6 +299,28 @@ int mbedtls_md_finish( mbedtls_md_context_t *ctx, unsigned char *output );
 int mbedtls_md( const mbedtls_md_info_t *md_info, const unsigned char *input, size_t ilen,
         unsigned char *output );
 
+/**
+ * \brief          Output[i] = message_digest( input buffer i )
+ *
+ *                 Hashes count independent buffers. Equivalent to calling
+ *                 mbedtls_md() on each buffer in turn, but when a
+ *                 lane-parallel kernel is available for the digest (see
+ *                 MBEDTLS_SHA256MB_C) several buffers are hashed at once
+ *                 in the lanes of SIMD vectors.
+ *
+ * \param md_info  message digest info
+ * \param count    number of input buffers
+ * \param inputs   count buffers holding the data
+ * \param ilens    length of each input buffer
+ * \param outputs  count generic message digest checksum results
+ *
+ * \returns        0 on success, MBEDTLS_ERR_MD_BAD_INPUT_DATA if parameter
+ *                 verification fails.
+ */
+int mbedtls_md_multi( const mbedtls_md_info_t *md_info, size_t count,
+        const unsigned char *const *inputs, const size_t *ilens,
+        unsigned char *const *outputs );
+
 #if defined(MBEDTLS_FS_IO)
 /**
  * \brief          Output = message_digest( file contents )
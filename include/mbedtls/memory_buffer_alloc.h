@@ -44,6 +44,14 @@
 #define MBEDTLS_MEMORY_ALIGN_MULTIPLE       4 /**< Align on multiples of this value */
 #endif
 
+#if !defined(MBEDTLS_MEMORY_ARENA_SIZE)
+#define MBEDTLS_MEMORY_ARENA_SIZE       65536 /**< Bytes carved from the heap for each per-thread arena (see MBEDTLS_MEMORY_ARENAS) */
+#endif
+
+#if !defined(MBEDTLS_MEMORY_ARENA_MAX)
+#define MBEDTLS_MEMORY_ARENA_MAX           16 /**< Maximum number of per-thread arenas */
+#endif
+
 /* \} name SECTION: Module settings */
 
 #define MBEDTLS_MEMORY_VERIFY_NONE         0
@@ -51,6 +59,17 @@
 #define MBEDTLS_MEMORY_VERIFY_FREE         (1 << 1)
 #define MBEDTLS_MEMORY_VERIFY_ALWAYS       (MBEDTLS_MEMORY_VERIFY_ALLOC | MBEDTLS_MEMORY_VERIFY_FREE)
 
+/*
+ * Subsystem tags for attributed allocation statistics
+ * (see MBEDTLS_MEMORY_TAGGING)
+ */
+#define MBEDTLS_MEMORY_TAG_OTHER           0 /**< untagged call sites        */
+#define MBEDTLS_MEMORY_TAG_MPI             1 /**< bignum limb buffers        */
+#define MBEDTLS_MEMORY_TAG_X509            2 /**< certificate parsing        */
+#define MBEDTLS_MEMORY_TAG_SSL             3 /**< SSL I/O and handshake      */
+#define MBEDTLS_MEMORY_TAG_CIPHER          4 /**< cipher contexts            */
+#define MBEDTLS_MEMORY_TAG_COUNT           5
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -118,6 +137,48 @@ void mbedtls_memory_buffer_alloc_max_reset( void );
 void mbedtls_memory_buffer_alloc_cur_get( size_t *cur_used, size_t *cur_blocks );
 #endif /* MBEDTLS_MEMORY_DEBUG */
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+/**
+ * \brief   Set the subsystem tag recorded on subsequent allocations
+ *
+ *          The instrumented call sites in the library bracket their
+ *          allocations with this; applications can do the same for their
+ *          own pools. The tag is a single global: with MBEDTLS_THREADING_C
+ *          enabled, allocations made concurrently by other threads may be
+ *          attributed to the tag set here.
+ *
+ * \param tag   One of the MBEDTLS_MEMORY_TAG_* values
+ *
+ * \return      The previously set tag, so callers can restore it
+ */
+int mbedtls_memory_buffer_set_tag( int tag );
+
+/**
+ * \brief   Get the peak usage of one subsystem tag so far
+ *
+ * \param tag           One of the MBEDTLS_MEMORY_TAG_* values
+ * \param max_used      Peak number of bytes held under this tag
+ * \param max_blocks    Peak number of blocks held under this tag
+ */
+void mbedtls_memory_buffer_alloc_tag_max_get( int tag, size_t *max_used,
+                                              size_t *max_blocks );
+
+/**
+ * \brief   Get the current usage of one subsystem tag
+ *
+ * \param tag           One of the MBEDTLS_MEMORY_TAG_* values
+ * \param cur_used      Number of bytes currently held under this tag
+ * \param cur_blocks    Number of blocks currently held under this tag
+ */
+void mbedtls_memory_buffer_alloc_tag_cur_get( int tag, size_t *cur_used,
+                                              size_t *cur_blocks );
+
+/**
+ * \brief   Reset the per-tag peak statistics
+ */
+void mbedtls_memory_buffer_alloc_tag_max_reset( void );
+#endif /* MBEDTLS_MEMORY_TAGGING */
+
 /**
  * \brief   Verifies that all headers in the memory buffer are correct
  *          and contain sane values. Helps debug buffer-overflow errors.
@@ -46,12 +46,17 @@
 #define MBEDTLS_ERR_NET_UNKNOWN_HOST                      -0x0052  /**< Failed to get an IP address for the given hostname. */
 #define MBEDTLS_ERR_NET_BUFFER_TOO_SMALL                  -0x0043  /**< Buffer is too small to hold the data. */
 #define MBEDTLS_ERR_NET_INVALID_CONTEXT                   -0x0045  /**< The context is invalid, eg because it was free()ed. */
+#define MBEDTLS_ERR_NET_POLL_FAILED                       -0x0047  /**< Polling the net context failed. */
+#define MBEDTLS_ERR_NET_BAD_INPUT_DATA                    -0x0049  /**< Input invalid. */
 
 #define MBEDTLS_NET_LISTEN_BACKLOG         10 /**< The backlog that listen() should use. */
 
 #define MBEDTLS_NET_PROTO_TCP 0 /**< The TCP transport protocol */
 #define MBEDTLS_NET_PROTO_UDP 1 /**< The UDP transport protocol */
 
+#define MBEDTLS_NET_POLL_READ  1 /**< Used in \c mbedtls_net_poll to check for pending data  */
+#define MBEDTLS_NET_POLL_WRITE 2 /**< Used in \c mbedtls_net_poll to check if write possible */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -94,6 +99,51 @@ void mbedtls_net_init( mbedtls_net_context *ctx );
  */
 int mbedtls_net_connect( mbedtls_net_context *ctx, const char *host, const char *port, int proto );
 
+/**
+ * \brief          Initiate a connection with host:port in the given protocol,
+ *                 without waiting for it to complete
+ *
+ * \param ctx      Socket to use
+ * \param host     Host to connect to
+ * \param port     Port to connect to
+ * \param proto    Protocol: MBEDTLS_NET_PROTO_TCP or MBEDTLS_NET_PROTO_UDP
+ *
+ * \return         0 if the connection completed immediately,
+ *                 MBEDTLS_ERR_SSL_WANT_WRITE if it is in progress
+ *                 (poll the socket for writability, then call
+ *                 mbedtls_net_connect_finish()), or one of:
+ *                      MBEDTLS_ERR_NET_SOCKET_FAILED,
+ *                      MBEDTLS_ERR_NET_UNKNOWN_HOST,
+ *                      MBEDTLS_ERR_NET_CONNECT_FAILED
+ *
+ * \note           The socket is left non-blocking, ready for use with an
+ *                 event loop and the f_recv/f_send callbacks. Name
+ *                 resolution is still synchronous: pass a literal address
+ *                 if that matters.
+ *
+ * \note           Only one address of the host is tried. On
+ *                 MBEDTLS_ERR_NET_CONNECT_FAILED the caller may free the
+ *                 context and call this function again to try another.
+ */
+int mbedtls_net_connect_start( mbedtls_net_context *ctx, const char *host,
+                               const char *port, int proto );
+
+/**
+ * \brief          Check whether a connection initiated with
+ *                 mbedtls_net_connect_start() has completed
+ *
+ *                 To be called once the socket polls writable (or to probe
+ *                 the connection state at any time).
+ *
+ * \param ctx      Socket on which the connection was initiated
+ *
+ * \return         0 if the connection is established,
+ *                 MBEDTLS_ERR_SSL_WANT_WRITE if it is still in progress,
+ *                 MBEDTLS_ERR_NET_CONNECT_FAILED if it failed, or
+ *                 MBEDTLS_ERR_NET_INVALID_CONTEXT
+ */
+int mbedtls_net_connect_finish( mbedtls_net_context *ctx );
+
 /**
  * \brief          Create a receiving socket on bind_ip:port in the chosen
  *                 protocol. If bind_ip == NULL, all interfaces are bound.
@@ -150,6 +200,81 @@ int mbedtls_net_set_block( mbedtls_net_context *ctx );
  */
 int mbedtls_net_set_nonblock( mbedtls_net_context *ctx );
 
+/**
+ * \brief          Get the file descriptor wrapped by a context, for
+ *                 registration with select()/poll()/epoll/kqueue
+ *
+ * \param ctx      Socket
+ *
+ * \return         The file descriptor, or -1 if the context is unset
+ */
+int mbedtls_net_fd( const mbedtls_net_context *ctx );
+
+/**
+ * \brief          Check and wait for the socket to become readable and/or
+ *                 writable
+ *
+ *                 This is the building block for single-socket event loops:
+ *                 map MBEDTLS_ERR_SSL_WANT_READ to MBEDTLS_NET_POLL_READ
+ *                 and MBEDTLS_ERR_SSL_WANT_WRITE to MBEDTLS_NET_POLL_WRITE,
+ *                 then retry the SSL call that wanted I/O. Applications
+ *                 multiplexing many sockets should register the descriptor
+ *                 from mbedtls_net_fd() with poll()/epoll/kqueue instead;
+ *                 see programs/ssl/ssl_epoll_server.c.
+ *
+ * \param ctx      Socket to check
+ * \param rw       Bitflag composed of MBEDTLS_NET_POLL_READ and
+ *                 MBEDTLS_NET_POLL_WRITE specifying the events to wait for
+ * \param timeout  Maximal amount of time to wait before returning,
+ *                 in milliseconds. If 0, this function returns immediately.
+ *                 If (uint32_t) -1, waits potentially forever.
+ *
+ * \return         Bitflag composed of MBEDTLS_NET_POLL_READ and
+ *                 MBEDTLS_NET_POLL_WRITE for the events that are ready
+ *                 (0 on timeout), or MBEDTLS_ERR_NET_INVALID_CONTEXT if
+ *                 the context is unset, or MBEDTLS_ERR_NET_POLL_FAILED
+ */
+int mbedtls_net_poll( mbedtls_net_context *ctx, uint32_t rw, uint32_t timeout );
+
+/**
+ * \brief          Enable or disable Nagle's algorithm (TCP_NODELAY) on a
+ *                 connected TCP socket
+ *
+ * \param ctx      Socket
+ * \param nodelay  Non-zero to disable Nagle's algorithm (send small
+ *                 segments immediately), zero to re-enable it
+ *
+ * \note           Disabling Nagle's algorithm removes the delay before
+ *                 small records are sent, at the cost of more (and
+ *                 smaller) TCP segments; consider coalescing records
+ *                 instead (see mbedtls_ssl_conf_output_coalescing()).
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_NET_INVALID_CONTEXT if
+ *                 the context is unset, or MBEDTLS_ERR_NET_SOCKET_FAILED
+ */
+int mbedtls_net_set_nodelay( mbedtls_net_context *ctx, int nodelay );
+
+/**
+ * \brief          Hold back partial TCP segments until the cork is
+ *                 removed (TCP_CORK)
+ *
+ * \param ctx      Socket
+ * \param cork     Non-zero to hold back partial segments,
+ *                 zero to release them
+ *
+ * \note           Corking while writing a burst of small records and
+ *                 uncorking afterwards makes the kernel pack them into
+ *                 full-size segments, without the delays that Nagle's
+ *                 algorithm can introduce.
+ *
+ * \note           Only available on Linux; elsewhere this function does
+ *                 nothing and returns MBEDTLS_ERR_NET_SOCKET_FAILED.
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_NET_INVALID_CONTEXT if
+ *                 the context is unset, or MBEDTLS_ERR_NET_SOCKET_FAILED
+ */
+int mbedtls_net_set_cork( mbedtls_net_context *ctx, int cork );
+
 /**
  * \brief          Portable usleep helper
  *
@@ -212,6 +337,47 @@ int mbedtls_net_send( void *ctx, const unsigned char *buf, size_t len );
 int mbedtls_net_recv_timeout( void *ctx, unsigned char *buf, size_t len,
                       uint32_t timeout );
 
+/**
+ * \brief          Read up to 'count' datagrams with a single system call,
+ *                 where the platform supports it (recvmmsg() on Linux;
+ *                 elsewhere a single datagram is read per call).
+ *
+ * \param ctx      Socket
+ * \param bufs     Array of 'count' buffers to write to
+ * \param lens     On entry, the capacity of each buffer;
+ *                 on return, the length of each datagram received
+ * \param count    Number of entries in bufs and lens
+ *
+ * \return         the number of datagrams received (at least 1),
+ *                 or a non-zero error code; with a non-blocking socket,
+ *                 MBEDTLS_ERR_SSL_WANT_READ indicates read() would block.
+ *
+ * \note           Intended for use as the f_recv_batch callback of
+ *                 \c mbedtls_ssl_set_bio_batch() on a datagram socket.
+ */
+int mbedtls_net_recvmmsg( void *ctx, unsigned char **bufs, size_t *lens,
+                          size_t count );
+
+/**
+ * \brief          Send up to 'count' datagrams with a single system call,
+ *                 where the platform supports it (sendmmsg() on Linux;
+ *                 elsewhere a single datagram is sent per call).
+ *
+ * \param ctx      Socket
+ * \param bufs     Array of 'count' buffers to read from
+ * \param lens     The length of each datagram to send
+ * \param count    Number of entries in bufs and lens
+ *
+ * \return         the number of datagrams sent (at least 1),
+ *                 or a non-zero error code; with a non-blocking socket,
+ *                 MBEDTLS_ERR_SSL_WANT_WRITE indicates write() would block.
+ *
+ * \note           Intended for use as the f_send_batch callback of
+ *                 \c mbedtls_ssl_set_bio_batch() on a datagram socket.
+ */
+int mbedtls_net_sendmmsg( void *ctx, const unsigned char **bufs,
+                          const size_t *lens, size_t count );
+
 /**
  * \brief          Gracefully shutdown the connection and free associated data
  *
@@ -59,6 +59,7 @@
 #define MBEDTLS_ERR_PK_UNKNOWN_NAMED_CURVE -0x3A00  /**< Elliptic curve is unsupported (only NIST curves are supported). */
 #define MBEDTLS_ERR_PK_FEATURE_UNAVAILABLE -0x3980  /**< Unavailable feature, e.g. RSA disabled for RSA key. */
 #define MBEDTLS_ERR_PK_SIG_LEN_MISMATCH    -0x3900  /**< The signature is valid but its length is less than expected. */
+#define MBEDTLS_ERR_PK_IN_PROGRESS         -0x3880  /**< The asynchronous operation is not completed yet. */
 
 
 #ifdef __cplusplus
@@ -344,6 +345,83 @@ int mbedtls_pk_sign( mbedtls_pk_context *ctx, mbedtls_md_type_t md_alg,
              unsigned char *sig, size_t *sig_len,
              int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
 
+/**
+ * \brief           Context for a split (start/poll) signature operation
+ *
+ *                  For the built-in key types the operation completes
+ *                  synchronously on the first mbedtls_pk_sign_poll() call,
+ *                  which a server can schedule off its event loop. Key
+ *                  types providing the async entries of mbedtls_pk_info_t
+ *                  (e.g. engines driving external hardware) run truly in
+ *                  the background between start and poll.
+ */
+typedef struct
+{
+    mbedtls_pk_context *pk;     /*!< key the operation was started on,
+                                     NULL when no operation is pending     */
+    void *op_ctx;               /*!< engine operation state, if any        */
+    mbedtls_md_type_t md_alg;   /*!< pending hash algorithm                */
+    const unsigned char *hash;  /*!< pending hash to sign                  */
+    size_t hash_len;            /*!< length of \c hash                     */
+    int (*f_rng)(void *, unsigned char *, size_t); /*!< pending RNG        */
+    void *p_rng;                /*!< pending RNG context                   */
+}
+mbedtls_pk_async;
+
+/**
+ * \brief           Initialize an asynchronous signature context
+ *
+ * \param ctx       Context to initialize
+ */
+void mbedtls_pk_async_init( mbedtls_pk_async *ctx );
+
+/**
+ * \brief           Start making a signature; the result is collected with
+ *                  mbedtls_pk_sign_poll()
+ *
+ * \param ctx       Asynchronous operation context (initialized and idle)
+ * \param pk        PK context to use
+ * \param md_alg    Hash algorithm used (see notes of mbedtls_pk_sign())
+ * \param hash      Hash of the message to sign; must stay valid until the
+ *                  operation completes or is cancelled
+ * \param hash_len  Hash length or 0 (see notes of mbedtls_pk_sign())
+ * \param f_rng     RNG function; must stay usable until completion
+ * \param p_rng     RNG parameter
+ *
+ * \return          0 on success (operation pending),
+ *                  MBEDTLS_ERR_PK_BAD_INPUT_DATA if another operation is
+ *                  pending on \p ctx, or a specific error code
+ */
+int mbedtls_pk_sign_start( mbedtls_pk_async *ctx, mbedtls_pk_context *pk,
+                           mbedtls_md_type_t md_alg,
+                           const unsigned char *hash, size_t hash_len,
+                           int (*f_rng)(void *, unsigned char *, size_t),
+                           void *p_rng );
+
+/**
+ * \brief           Collect the result of a started signature
+ *
+ * \param ctx       Asynchronous operation context with a pending operation
+ * \param sig       Place to write the signature
+ * \param sig_len   Number of bytes written
+ *
+ * \return          0 on success, MBEDTLS_ERR_PK_IN_PROGRESS if the
+ *                  operation is still running (call again later), or a
+ *                  specific error code. Any return value other than
+ *                  MBEDTLS_ERR_PK_IN_PROGRESS ends the operation and
+ *                  leaves the context idle.
+ */
+int mbedtls_pk_sign_poll( mbedtls_pk_async *ctx,
+                          unsigned char *sig, size_t *sig_len );
+
+/**
+ * \brief           Cancel a pending signature operation, if any, and
+ *                  leave the context idle
+ *
+ * \param ctx       Asynchronous operation context
+ */
+void mbedtls_pk_sign_cancel( mbedtls_pk_async *ctx );
+
 /**
  * \brief           Decrypt message (including padding if relevant).
  *
@@ -83,6 +83,22 @@ struct mbedtls_pk_info_t
     /** Interface with the debug module */
     void (*debug_func)( const void *ctx, mbedtls_pk_debug_item *items );
 
+    /** Start an asynchronous signature (optional, NULL for the built-in
+     *  key types; engines driving external hardware can set all three
+     *  async entries to overlap signing with other work) */
+    int (*sign_start_func)( void *ctx, mbedtls_md_type_t md_alg,
+                            const unsigned char *hash, size_t hash_len,
+                            int (*f_rng)(void *, unsigned char *, size_t),
+                            void *p_rng, void **op_ctx );
+
+    /** Poll an asynchronous signature; returns MBEDTLS_ERR_PK_IN_PROGRESS
+     *  while the operation is still running (optional) */
+    int (*sign_poll_func)( void *ctx, void *op_ctx,
+                           unsigned char *sig, size_t *sig_len );
+
+    /** Cancel an asynchronous signature and release its state (optional) */
+    void (*sign_cancel_func)( void *ctx, void *op_ctx );
+
 };
 #if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
 /* Container for RSA-alt */
@@ -0,0 +1,140 @@
+/**
+ * \file poly1305.h
+ *
+ * \brief The Poly1305 one-time message authenticator (RFC 7539)
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_POLY1305_H
+#define MBEDTLS_POLY1305_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA               -0x0058  /**< Invalid input parameter(s). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Poly1305 context structure
+ *
+ * \warning        A Poly1305 key must only ever be used to authenticate a
+ *                 single message; in an AEAD construction a fresh key is
+ *                 derived from the nonce for every record.
+ */
+typedef struct
+{
+    uint32_t r[4];                  /*!<  clamped key part r                   */
+    uint32_t s[4];                  /*!<  key part s, added at the end         */
+    uint32_t acc[5];                /*!<  accumulator, 130 bits                */
+    unsigned char queue[16];        /*!<  pending partial block                */
+    size_t queue_len;               /*!<  bytes pending in queue               */
+}
+mbedtls_poly1305_context;
+
+/**
+ * \brief          Initialize Poly1305 context
+ *
+ * \param ctx      Poly1305 context to be initialized
+ */
+void mbedtls_poly1305_init( mbedtls_poly1305_context *ctx );
+
+/**
+ * \brief          Clear Poly1305 context
+ *
+ * \param ctx      Poly1305 context to be cleared
+ */
+void mbedtls_poly1305_free( mbedtls_poly1305_context *ctx );
+
+/**
+ * \brief          Set the one-time key and start a new computation
+ *
+ * \param ctx      Poly1305 context
+ * \param key      256-bit one-time key
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA
+ */
+int mbedtls_poly1305_starts( mbedtls_poly1305_context *ctx,
+                             const unsigned char key[32] );
+
+/**
+ * \brief          Feed an input buffer into the ongoing computation
+ *
+ * \param ctx      Poly1305 context
+ * \param input    buffer holding the input data
+ * \param ilen     length of the input data
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA
+ */
+int mbedtls_poly1305_update( mbedtls_poly1305_context *ctx,
+                             const unsigned char *input,
+                             size_t ilen );
+
+/**
+ * \brief          Produce the 128-bit authenticator
+ *
+ * \param ctx      Poly1305 context
+ * \param mac      buffer for the authenticator
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA
+ */
+int mbedtls_poly1305_finish( mbedtls_poly1305_context *ctx,
+                             unsigned char mac[16] );
+
+/**
+ * \brief          Authenticate a buffer with a one-time key
+ *
+ * \param key      256-bit one-time key
+ * \param input    buffer holding the input data
+ * \param ilen     length of the input data
+ * \param mac      buffer for the authenticator
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA
+ */
+int mbedtls_poly1305_mac( const unsigned char key[32],
+                          const unsigned char *input,
+                          size_t ilen,
+                          unsigned char mac[16] );
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Checkup routine
+ *
+ * \return         0 if successful, or 1 if the test failed
+ */
+int mbedtls_poly1305_self_test( int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* poly1305.h */
@@ -105,6 +105,13 @@ typedef struct
                                       specified in the mbedtls_md.h header file
                                       for the EME-OAEP and EMSA-PSS
                                       encoding                          */
+#if defined(MBEDTLS_PKCS1_V21)
+    mbedtls_md_context_t mgf_ctx;   /*!<  cached digest context for MGF1
+                                          and PSS/OAEP hashing          */
+    unsigned char lhash[MBEDTLS_MD_MAX_SIZE]; /*!<  cached hash of the
+                                          empty OAEP label              */
+    int lhash_set;              /*!<  lhash is valid                    */
+#endif
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_threading_mutex_t mutex;    /*!<  Thread-safety mutex       */
 #endif
@@ -197,6 +204,29 @@ int mbedtls_rsa_check_privkey( const mbedtls_rsa_context *ctx );
  */
 int mbedtls_rsa_check_pub_priv( const mbedtls_rsa_context *pub, const mbedtls_rsa_context *prv );
 
+/**
+ * \brief          Precompute the helper values cached in an RSA context
+ *
+ *                 Fills in the Montgomery constants for N (and P, Q when a
+ *                 private key is present) that are otherwise computed lazily
+ *                 on the first call to mbedtls_rsa_public() or
+ *                 mbedtls_rsa_private(), and optionally sets up the initial
+ *                 blinding values.
+ *
+ * \param ctx      RSA context, set up with at least N and E
+ * \param f_rng    RNG function, may be NULL. If a private key is present and
+ *                 f_rng is not NULL, the blinding values are seeded too.
+ * \param p_rng    RNG parameter
+ *
+ * \return         0 if successful, or an MBEDTLS_ERR_RSA_XXX error code
+ *
+ * \note           Calling this at key-load time moves the one-time setup
+ *                 cost out of the first RSA operation on the context.
+ */
+int mbedtls_rsa_precompute( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng );
+
 /**
  * \brief          Do an RSA public key operation
  *
@@ -237,6 +267,34 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
                  const unsigned char *input,
                  unsigned char *output );
 
+/**
+ * \brief          Do a batch of RSA private key operations
+ *
+ * \param ctx      RSA context
+ * \param f_rng    RNG function (Needed for blinding)
+ * \param p_rng    RNG parameter
+ * \param n_ops    Number of operations in the batch
+ * \param input    Input buffer holding n_ops contiguous blocks of
+ *                 ctx->len bytes
+ * \param output   Output buffer with room for n_ops blocks of
+ *                 ctx->len bytes
+ *
+ * \return         0 if successful, or an MBEDTLS_ERR_RSA_XXX error code
+ *
+ * \note           Compared to calling mbedtls_rsa_private() in a loop,
+ *                 this performs a single blinding update for the whole
+ *                 batch (refreshing the values by squaring between
+ *                 operations) and fills the Montgomery caches under the
+ *                 mutex up front, so the exponentiations themselves run
+ *                 without holding the context mutex.
+ */
+int mbedtls_rsa_private_batch( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng,
+                 size_t n_ops,
+                 const unsigned char *input,
+                 unsigned char *output );
+
 /**
  * \brief          Generic wrapper to perform a PKCS#1 encryption using the
  *                 mode from the context. Add the message padding, then do an
@@ -0,0 +1,124 @@
+/**
+ * \file selftest.h
+ *
+ * \brief Run the compiled-in self-tests, optionally in parallel
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SELFTEST_H
+#define MBEDTLS_SELFTEST_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stdint.h>
+
+/*
+ * Component identifiers, usable as bits in the lazy mask of
+ * mbedtls_self_test_all(). Components whose module is not compiled in
+ * are simply skipped.
+ */
+#define MBEDTLS_SELF_TEST_MD2         0x00000001
+#define MBEDTLS_SELF_TEST_MD4         0x00000002
+#define MBEDTLS_SELF_TEST_MD5         0x00000004
+#define MBEDTLS_SELF_TEST_RIPEMD160   0x00000008
+#define MBEDTLS_SELF_TEST_SHA1        0x00000010
+#define MBEDTLS_SELF_TEST_SHA256      0x00000020
+#define MBEDTLS_SELF_TEST_SHA512      0x00000040
+#define MBEDTLS_SELF_TEST_ARC4        0x00000080
+#define MBEDTLS_SELF_TEST_DES         0x00000100
+#define MBEDTLS_SELF_TEST_AES         0x00000200
+#define MBEDTLS_SELF_TEST_GCM         0x00000400
+#define MBEDTLS_SELF_TEST_CCM         0x00000800
+#define MBEDTLS_SELF_TEST_BASE64      0x00001000
+#define MBEDTLS_SELF_TEST_MPI         0x00002000
+#define MBEDTLS_SELF_TEST_RSA         0x00004000
+#define MBEDTLS_SELF_TEST_XTEA        0x00008000
+#define MBEDTLS_SELF_TEST_CAMELLIA    0x00010000
+#define MBEDTLS_SELF_TEST_CTR_DRBG    0x00020000
+#define MBEDTLS_SELF_TEST_HMAC_DRBG   0x00040000
+#define MBEDTLS_SELF_TEST_ECP         0x00080000
+#define MBEDTLS_SELF_TEST_DHM         0x00100000
+#define MBEDTLS_SELF_TEST_ENTROPY     0x00200000
+#define MBEDTLS_SELF_TEST_PKCS5       0x00400000
+#define MBEDTLS_SELF_TEST_TIMING      0x00800000
+#define MBEDTLS_SELF_TEST_CHACHA20    0x01000000
+#define MBEDTLS_SELF_TEST_POLY1305    0x02000000
+#define MBEDTLS_SELF_TEST_CHACHAPOLY  0x04000000
+
+#define MBEDTLS_SELF_TEST_ALL         0x07FFFFFF
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(MBEDTLS_SELF_TEST)
+/**
+ * \brief          Run the self-tests of every compiled-in crypto module,
+ *                 minus the deferred ones
+ *
+ *                 With MBEDTLS_THREADING_PTHREAD and parallel_threads > 1
+ *                 the tests are spread over that many threads, cutting
+ *                 boot time on startup policies that mandate them on
+ *                 every worker start. Components listed in lazy_mask are
+ *                 not run here but recorded, to be checked on first use
+ *                 with mbedtls_self_test_check().
+ *
+ * \note           Call this once, from the main thread, before the
+ *                 deferred components can be reached. With verbose
+ *                 output and several threads the per-test messages may
+ *                 interleave.
+ *
+ * \param parallel_threads  number of worker threads to use; values <= 1
+ *                          (or builds without MBEDTLS_THREADING_PTHREAD)
+ *                          run the tests serially
+ * \param lazy_mask         OR of MBEDTLS_SELF_TEST_* components to defer
+ * \param verbose           1 for test output, 0 for silence
+ *
+ * \return         0 if all tests that ran passed, or 1 otherwise
+ */
+int mbedtls_self_test_all( int parallel_threads, uint32_t lazy_mask,
+                           int verbose );
+
+/**
+ * \brief          Make sure one component's self-test has passed,
+ *                 running it now if it was deferred
+ *
+ *                 Call sites guarding a rarely-used primitive invoke
+ *                 this before first use; the result is cached, so all
+ *                 calls after the first are a mask check. Thread-safe
+ *                 when MBEDTLS_THREADING_C is enabled.
+ *
+ * \param component one MBEDTLS_SELF_TEST_* value
+ * \param verbose   1 for test output, 0 for silence
+ *
+ * \return         0 if the component's test passed (or the module is
+ *                 not compiled in), or 1 otherwise
+ */
+int mbedtls_self_test_check( uint32_t component, int verbose );
+#endif /* MBEDTLS_SELF_TEST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* selftest.h */
@@ -0,0 +1,80 @@
+/**
+ * \file sha256mb.h
+ *
+ * \brief Multi-buffer SHA-256 with AVX2 on x86-64
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SHA256MB_H
+#define MBEDTLS_SHA256MB_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stddef.h>
+
+#if defined(MBEDTLS_HAVE_ASM) && defined(__GNUC__) &&  \
+    ( defined(__amd64__) || defined(__x86_64__) )   &&  \
+    ! defined(MBEDTLS_HAVE_X86_64)
+#define MBEDTLS_HAVE_X86_64
+#endif
+
+#if defined(MBEDTLS_HAVE_X86_64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          AVX2 support detection routine
+ *
+ * \return         1 if the CPU and OS support AVX2, 0 otherwise
+ */
+int mbedtls_sha256mb_has_support( void );
+
+/**
+ * \brief          Hash several independent buffers, eight at a time in
+ *                 the 32-bit lanes of AVX2 vectors
+ *
+ *                 The lane-parallel kernel covers the whole blocks common
+ *                 to a group of eight buffers; the remaining blocks and
+ *                 padding of each buffer are finished serially. Buffers of
+ *                 similar length therefore get close to the full speedup.
+ *
+ * \param is224    0 = use SHA-256, 1 = use SHA-224
+ * \param count    Number of buffers
+ * \param inputs   \p count buffers to hash
+ * \param ilens    Length in bytes of each buffer
+ * \param outputs  \p count checksum buffers, 32 (or 28) bytes each
+ */
+void mbedtls_sha256mb_hash( int is224, size_t count,
+                            const unsigned char *const *inputs,
+                            const size_t *ilens,
+                            unsigned char *const *outputs );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_HAVE_X86_64 */
+
+#endif /* MBEDTLS_SHA256MB_H */
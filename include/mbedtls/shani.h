@@ -0,0 +1,75 @@
+/**
+ * \file shani.h
+ *
+ * \brief SHA-NI extensions for hardware SHA-256 on x86-64
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SHANI_H
+#define MBEDTLS_SHANI_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(MBEDTLS_HAVE_ASM) && defined(__GNUC__) &&  \
+    ( defined(__amd64__) || defined(__x86_64__) )   &&  \
+    ! defined(MBEDTLS_HAVE_X86_64)
+#define MBEDTLS_HAVE_X86_64
+#endif
+
+#if defined(MBEDTLS_HAVE_X86_64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          SHA-NI features detection routine
+ *
+ * \return         1 if CPU has support for the SHA extensions, 0 otherwise
+ */
+int mbedtls_shani_has_support( void );
+
+/**
+ * \brief          SHA-256 compression of one or more consecutive blocks
+ *
+ *                 Also used for SHA-224, which shares the compression
+ *                 function and differs only in its initial state.
+ *
+ * \param state    SHA-256 state, eight 32-bit words, updated in place
+ * \param data     Input data, \c 64 * \p nblocks bytes
+ * \param nblocks  Number of 64-byte blocks to process
+ */
+void mbedtls_shani_sha256_process( uint32_t state[8],
+                     const unsigned char *data,
+                     size_t nblocks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_HAVE_X86_64 */
+
+#endif /* MBEDTLS_SHANI_H */
@@ -40,6 +40,18 @@
 #include "x509_crl.h"
 #endif
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+#include "x509_crt_cache.h"
+#endif
+
+#if defined(MBEDTLS_X509_TRUST_C)
+#include "x509_trust.h"
+#endif
+
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+#include "x509_verify_cache.h"
+#endif
+
 #if defined(MBEDTLS_DHM_C)
 #include "dhm.h"
 #endif
@@ -52,6 +64,22 @@
 #include "zlib.h"
 #endif
 
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2) && defined(MBEDTLS_SHA256_C)
+#include "sha256.h"
+#endif
+
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2) && defined(MBEDTLS_SHA512_C)
+#include "sha512.h"
+#endif
+
+#if defined(MBEDTLS_TIMING_C)
+#include "timing.h"
+#endif
+
+#if defined(MBEDTLS_SSL_ECDH_REUSE) && defined(MBEDTLS_THREADING_C)
+#include "threading.h"
+#endif
+
 #if defined(MBEDTLS_HAVE_TIME)
 #include <time.h>
 #endif
@@ -126,6 +154,8 @@
 #define MBEDTLS_ERR_SSL_WANT_READ                         -0x6900  /**< Connection requires a read call. */
 #define MBEDTLS_ERR_SSL_WANT_WRITE                        -0x6880  /**< Connection requires a write call. */
 #define MBEDTLS_ERR_SSL_TIMEOUT                           -0x6800  /**< The operation timed out. */
+#define MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS                 -0x6780  /**< An asynchronous private key operation is still in progress. */
+#define MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH            -0x6700  /**< Session ticket is valid but should be renewed. */
 
 /*
  * Various constants
@@ -168,15 +198,28 @@
 #define MBEDTLS_SSL_VERIFY_REQUIRED             2
 #define MBEDTLS_SSL_VERIFY_UNSET                3 /* Used only for sni_authmode */
 
+#define MBEDTLS_SSL_CERT_RETAIN_FULL            0
+#define MBEDTLS_SSL_CERT_RETAIN_LEAF            1
+#define MBEDTLS_SSL_CERT_RETAIN_DIGEST          2
+#define MBEDTLS_SSL_CERT_RETAIN_NONE            3
+
+#define MBEDTLS_SSL_PEER_CERT_DIGEST_LEN        32  /* SHA-256 */
+
 #define MBEDTLS_SSL_LEGACY_RENEGOTIATION        0
 #define MBEDTLS_SSL_SECURE_RENEGOTIATION        1
 
 #define MBEDTLS_SSL_RENEGOTIATION_DISABLED      0
 #define MBEDTLS_SSL_RENEGOTIATION_ENABLED       1
 
+#define MBEDTLS_SSL_REKEY_DISABLED              0
+#define MBEDTLS_SSL_REKEY_ENABLED               1
+
 #define MBEDTLS_SSL_ANTI_REPLAY_DISABLED        0
 #define MBEDTLS_SSL_ANTI_REPLAY_ENABLED         1
 
+#define MBEDTLS_SSL_READ_AHEAD_DISABLED         0
+#define MBEDTLS_SSL_READ_AHEAD_ENABLED          1
+
 #define MBEDTLS_SSL_RENEGOTIATION_NOT_ENFORCED  -1
 #define MBEDTLS_SSL_RENEGO_MAX_RECORDS_DEFAULT  16
 
@@ -194,6 +237,9 @@
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED    0
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_ENABLED     1
 
+#define MBEDTLS_SSL_FALSE_START_DISABLED        0
+#define MBEDTLS_SSL_FALSE_START_ENABLED         1
+
 #define MBEDTLS_SSL_ARC4_ENABLED                0
 #define MBEDTLS_SSL_ARC4_DISABLED               1
 
@@ -207,6 +253,13 @@
 #define MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MIN    1000
 #define MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MAX   60000
 
+/*
+ * Number of datagrams read per call to the batched receive callback set
+ * with mbedtls_ssl_set_bio_batch(). Datagrams beyond the first are held
+ * in the SSL context until the record layer is ready for them.
+ */
+#define MBEDTLS_SSL_DGRAM_BATCH                 4
+
 /**
  * \name SECTION: Module settings
  *
@@ -232,6 +285,22 @@
 #define MBEDTLS_SSL_MAX_CONTENT_LEN         16384   /**< Size of the input / output buffer */
 #endif
 
+/*
+ * Size of the DTLS record anti-replay window, in records. Records older
+ * than the window are dropped as replays even if never seen, so links
+ * with deep reordering need a wider window. Must be a power of two, at
+ * least 64; each 64 records cost 8 bytes per context.
+ */
+#if !defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE)
+#define MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE  64 /**< Size of the replay window, in records */
+#endif
+
+#if MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE < 64 ||                    \
+    ( MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE &                        \
+      ( MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE - 1 ) ) != 0
+#error "MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE must be a power of two >= 64"
+#endif
+
 /* \} name SECTION: Module settings */
 
 /*
@@ -432,6 +501,9 @@ typedef struct mbedtls_ssl_handshake_params mbedtls_ssl_handshake_params;
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 typedef struct mbedtls_ssl_key_cert mbedtls_ssl_key_cert;
 #endif
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+typedef struct mbedtls_ssl_sni_entry mbedtls_ssl_sni_entry;
+#endif
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 typedef struct mbedtls_ssl_flight_item mbedtls_ssl_flight_item;
 #endif
@@ -450,8 +522,36 @@ struct mbedtls_ssl_session
     unsigned char id[32];       /*!< session identifier */
     unsigned char master[48];   /*!< the master secret  */
 
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2)
+    /*
+     * Cached HMAC pad states of the TLS 1.2 PRF, keyed by the master
+     * secret. Filled the first time the PRF runs over this session's
+     * master secret and reused on resumption, saving the HMAC re-keying
+     * in every key expansion and Finished computation. Plain hash
+     * contexts (no pointers) so sessions stay safe to copy wholesale,
+     * as the session cache does.
+     */
+    int prf_keyed;              /*!< mbedtls_md_type_t the cached states
+                                     are for, or 0 if not filled yet     */
+#if defined(MBEDTLS_SHA256_C)
+    mbedtls_sha256_context prf_ipad256; /*!< SHA-256 state after i-pad  */
+    mbedtls_sha256_context prf_opad256; /*!< SHA-256 state after o-pad  */
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    mbedtls_sha512_context prf_ipad384; /*!< SHA-384 state after i-pad  */
+    mbedtls_sha512_context prf_opad384; /*!< SHA-384 state after o-pad  */
+#endif
+#endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     mbedtls_x509_crt *peer_cert;        /*!< peer X.509 cert chain */
+#if defined(MBEDTLS_SHA256_C)
+    /*!< SHA-256 of the peer's leaf certificate, kept in place of (or in
+     *   addition to) the chain depending on the retention policy, see
+     *   mbedtls_ssl_conf_cert_retention() */
+    unsigned char peer_cert_digest[MBEDTLS_SSL_PEER_CERT_DIGEST_LEN];
+    unsigned char peer_cert_digest_set; /*!< is peer_cert_digest valid? */
+#endif /* MBEDTLS_SHA256_C */
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
     uint32_t verify_result;          /*!<  verification result     */
 
@@ -474,6 +574,55 @@ struct mbedtls_ssl_session
 #endif
 };
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+/**
+ * Server-side shared ephemeral ECDH key with a bounded reuse policy.
+ *
+ * One such object can be referenced by a configuration (and thus shared by
+ * all its contexts) via \c mbedtls_ssl_conf_ecdh_reuse(); the keypair is
+ * regenerated once the use or age limit is exceeded, or when a handshake
+ * negotiates a different curve.
+ */
+typedef struct
+{
+    mbedtls_ecp_group_id grp_id;    /*!< curve the keypair belongs to   */
+    mbedtls_mpi d;                  /*!< cached secret value            */
+    mbedtls_ecp_point Q;            /*!< cached public value            */
+    int uses;                       /*!< handshakes served so far       */
+    int max_uses;                   /*!< regenerate after that many     */
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t created;                 /*!< generation timestamp           */
+    uint32_t max_age;               /*!< lifetime in seconds, 0 = none  */
+#endif
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;
+#endif
+}
+mbedtls_ssl_ecdh_reuse_context;
+#endif /* MBEDTLS_SSL_ECDH_REUSE */
+
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+/**
+ * Freelists of retired fixed-size handshake substructures.
+ *
+ * One such pool can be referenced by a configuration (and thus shared by
+ * all its contexts) via \c mbedtls_ssl_conf_handshake_pool(); released
+ * \c mbedtls_ssl_handshake_params, \c mbedtls_ssl_transform and
+ * \c mbedtls_ssl_session structures are then kept for the next handshake
+ * instead of going back to the allocator.
+ */
+typedef struct
+{
+    void *free_list[3];             /*!< one freelist per structure type;
+                                         a released structure holds the
+                                         link pointer in its first bytes  */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;
+#endif
+}
+mbedtls_ssl_handshake_pool;
+#endif /* MBEDTLS_SSL_HANDSHAKE_POOL */
+
 /**
  * SSL/TLS configuration to be shared between mbedtls_ssl_context structures.
  */
@@ -486,6 +635,17 @@ struct mbedtls_ssl_config
      */
 
     const int *ciphersuite_list[4]; /*!< allowed ciphersuites per version   */
+    const mbedtls_ssl_ciphersuite_t **ciphersuite_info_list[4];
+                                    /*!< resolved counterparts of
+                                         ciphersuite_list, index-aligned;
+                                         NULL if resolution failed          */
+    unsigned char *ciphersuite_gate[4];
+                                    /*!< per-version acceptance flags for
+                                         ciphersuite_list, index-aligned,
+                                         resolved at configuration time
+                                         (MBEDTLS_SSL_SUITE_GATE_* in
+                                         ssl_internal.h); NULL if
+                                         resolution failed                  */
 
     /** Callback for printing debug output                                  */
     void (*f_dbg)(void *, int, const char *, int, const char *);
@@ -501,10 +661,24 @@ struct mbedtls_ssl_config
     int (*f_set_cache)(void *, const mbedtls_ssl_session *);
     void *p_cache;                  /*!< context for cache callbacks        */
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+    /** Shared ephemeral ECDH key for servers, or NULL                      */
+    mbedtls_ssl_ecdh_reuse_context *ecdh_reuse;
+#endif
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+    /** Pool of retired handshake substructures, or NULL                    */
+    mbedtls_ssl_handshake_pool *hs_pool;
+#endif
+
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     /** Callback for setting cert according to SNI extension                */
     int (*f_sni)(void *, mbedtls_ssl_context *, const unsigned char *, size_t);
     void *p_sni;                    /*!< context for SNI callback           */
+
+    /** Built-in SNI certificate table (see mbedtls_ssl_conf_sni_cert())    */
+    mbedtls_ssl_sni_entry **sni_table;  /*!< hash buckets over DNS names    */
+    size_t sni_table_size;          /*!< number of buckets                  */
+    size_t sni_table_count;         /*!< number of entries                  */
 #endif
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
@@ -538,24 +712,64 @@ struct mbedtls_ssl_config
     void *p_ticket;                 /*!< context for the ticket callbacks   */
 #endif /* MBEDTLS_SSL_SESSION_TICKETS && MBEDTLS_SSL_SRV_C */
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+    /** Callback to start an external signature operation                   */
+    int (*f_async_sign)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                         mbedtls_md_type_t, const unsigned char *, size_t );
+    /** Callback to start an external decryption operation                  */
+    int (*f_async_decrypt)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                            const unsigned char *, size_t );
+    /** Callback to collect the result of an external operation             */
+    int (*f_async_resume)( mbedtls_ssl_context *, unsigned char *,
+                           size_t *, size_t );
+    /** Callback to cancel an outstanding external operation                */
+    void (*f_async_cancel)( mbedtls_ssl_context * );
+    void *p_async;                  /*!< context for the async callbacks    */
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     const mbedtls_x509_crt_profile *cert_profile; /*!< verification profile */
     mbedtls_ssl_key_cert *key_cert; /*!< own certificate/key pair(s)        */
     mbedtls_x509_crt *ca_chain;     /*!< trusted CAs                        */
     mbedtls_x509_crl *ca_crl;       /*!< trusted CAs CRLs                   */
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    mbedtls_x509_crt_cache *crt_cache; /*!< cache for peer certificates     */
+#endif
+#if defined(MBEDTLS_X509_TRUST_C)
+    const mbedtls_x509_trust *ca_trust; /*!< indexed trusted CAs            */
+#endif
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+    mbedtls_x509_verify_cache *vrfy_cache; /*!< memoized verify results     */
+#endif
+    const mbedtls_x509_verify_executor *vrfy_executor; /*!< parallel chain
+                                         verification (or NULL)             */
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__SIGNATURE_ENABLED)
     const int *sig_hashes;          /*!< allowed signature hashes           */
+    unsigned char sig_hash_rank[MBEDTLS_SSL_HASH_SHA512 + 1];
+                                    /*!< TLS HashAlgorithm code to its rank
+                                         in sig_hashes plus one, 0 if not
+                                         allowed; kept in sync with
+                                         sig_hashes                        */
+    unsigned char sig_hash_by_rank[MBEDTLS_SSL_HASH_SHA512 + 1];
+                                    /*!< inverse table: rank back to the
+                                         TLS HashAlgorithm code            */
 #endif
 
 #if defined(MBEDTLS_ECP_C)
     const mbedtls_ecp_group_id *curve_list; /*!< allowed curves             */
+    uint32_t curve_mask;            /*!< allowed curves as a bitmask of
+                                         1 << MBEDTLS_ECP_DP_XXX, kept in
+                                         sync with curve_list              */
 #endif
 
 #if defined(MBEDTLS_DHM_C)
     mbedtls_mpi dhm_P;              /*!< prime modulus for DHM              */
     mbedtls_mpi dhm_G;              /*!< generator for DHM                  */
+    int dhm_group;                  /*!< well-known DHM group to use
+                                         instead of dhm_P/dhm_G, or
+                                         MBEDTLS_DHM_GROUP_NONE            */
 #endif
 
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED)
@@ -575,11 +789,31 @@ struct mbedtls_ssl_config
 
     uint32_t read_timeout;          /*!< timeout for mbedtls_ssl_read (ms)  */
 
+    size_t in_content_len;          /*!< desired content size of the input
+                                         buffer, or 0 for the default       */
+    size_t out_content_len;         /*!< desired content size of the output
+                                         buffer, or 0 for the default       */
+
+    size_t out_coalesce;            /*!< hold small outgoing records back
+                                         until this many bytes are pending,
+                                         or 0 to send each record (TLS)     */
+
+    size_t dyn_rec_start;           /*!< initial record size limit when
+                                         sizing records dynamically, or 0
+                                         to always use full-size records    */
+    size_t dyn_rec_grow;            /*!< bytes to send at the current limit
+                                         before doubling it                 */
+    uint32_t dyn_rec_idle;          /*!< idle time (ms) after which the
+                                         limit falls back to the initial
+                                         value, or 0 to never fall back     */
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     uint32_t hs_timeout_min;        /*!< initial value of the handshake
                                          retransmission timeout (ms)        */
     uint32_t hs_timeout_max;        /*!< maximum value of the handshake
                                          retransmission timeout (ms)        */
+    unsigned int hs_burst;          /*!< maximum records per handshake
+                                         retransmission burst (0: no limit) */
 #endif
 
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
@@ -590,6 +824,7 @@ struct mbedtls_ssl_config
 
 #if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
     unsigned int badmac_limit;      /*!< limit of records with a bad MAC    */
+    unsigned int badhdr_limit;      /*!< limit of records with a bad header */
 #endif
 
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
@@ -601,6 +836,11 @@ struct mbedtls_ssl_config
     unsigned char min_major_ver;    /*!< min. major version used            */
     unsigned char min_minor_ver;    /*!< min. minor version used            */
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+    uint16_t record_pad;            /*!< pad outgoing CBC records to a
+                                         multiple of this (0: minimal pad)  */
+#endif
+
     /*
      * Flags (bitfields)
      */
@@ -628,8 +868,12 @@ struct mbedtls_ssl_config
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     unsigned int cbc_record_splitting : 1;  /*!< do cbc record splitting    */
 #endif
+    unsigned int read_ahead : 1;    /*!< drain all buffered TLS records?    */
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     unsigned int disable_renegotiation : 1; /*!< disable renegotiation?     */
+#if defined(MBEDTLS_SSL_SRV_C)
+    unsigned int rekey : 1;         /*!< accept abbreviated rekeying?       */
+#endif
 #endif
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
     unsigned int trunc_hmac : 1;    /*!< negotiate truncated hmac?          */
@@ -640,29 +884,130 @@ struct mbedtls_ssl_config
 #if defined(MBEDTLS_SSL_FALLBACK_SCSV) && defined(MBEDTLS_SSL_CLI_C)
     unsigned int fallback : 1;      /*!< is this a fallback?                */
 #endif
+#if defined(MBEDTLS_SSL_FALSE_START)
+    unsigned int false_start : 1;   /*!< send early data after our Finished? */
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    unsigned int cert_retain : 2;   /*!< MBEDTLS_SSL_CERT_RETAIN_XXX        */
+#endif
+    unsigned int frozen : 1;        /*!< no more changes accepted, see
+                                         mbedtls_ssl_config_freeze()        */
 };
 
+#if defined(MBEDTLS_SSL_STATS)
+/**
+ * Per-context event counters, updated inline in the record and handshake
+ * paths with plain increments (no formatting, no locking: a context is
+ * only ever driven from one thread at a time). Snapshot them with
+ * \c mbedtls_ssl_get_stats() to feed an external metrics collector.
+ */
+typedef struct
+{
+    uint64_t records_in;        /*!<  records received and accepted     */
+    uint64_t records_out;       /*!<  records sent                      */
+    uint64_t bytes_in;          /*!<  payload bytes received            */
+    uint64_t bytes_out;         /*!<  payload bytes sent                */
+    uint64_t handshakes;        /*!<  handshakes completed              */
+    uint64_t resumptions;       /*!<  completed handshakes that were
+                                      session resumptions               */
+    uint64_t renegotiations;    /*!<  renegotiations started            */
+    uint64_t mac_failures;      /*!<  records rejected for a bad MAC    */
+    uint64_t records_dropped;   /*!<  DTLS records silently discarded
+                                      before or after decryption        */
+}
+mbedtls_ssl_stats;
+#endif /* MBEDTLS_SSL_STATS */
+
+#if defined(MBEDTLS_SSL_HS_TIMING)
+/**
+ * Number of entries in the per-state table of mbedtls_ssl_hs_timing:
+ * one per ::mbedtls_ssl_states value
+ */
+#define MBEDTLS_SSL_HS_TIMING_STATES \
+    ( MBEDTLS_SSL_SERVER_HELLO_VERIFY_REQUEST_SENT + 1 )
+
+/**
+ * Timing breakdown of a handshake, maintained by
+ * mbedtls_ssl_handshake_step() and snapshotted with
+ * \c mbedtls_ssl_get_hs_timing(). All durations are in
+ * mbedtls_timing_hardclock() units. Time inside a step is charged to the
+ * state the step was entered in, so crypto-heavy states (key exchange,
+ * certificate verification) can be told apart from parsing; time between
+ * steps is the network round trips and application scheduling the
+ * handshake spent waiting on.
+ */
+typedef struct
+{
+    unsigned long state_cycles[MBEDTLS_SSL_HS_TIMING_STATES];
+                                /*!<  time spent inside handshake steps,
+                                      indexed by ::mbedtls_ssl_states     */
+    unsigned long wait_cycles;  /*!<  time between steps: network round
+                                      trips and scheduling delays         */
+    unsigned long total_cycles; /*!<  first step entered to completion    */
+    unsigned int steps;         /*!<  handshake steps executed            */
+    unsigned char done;         /*!<  nonzero once the handshake has
+                                      completed and the figures are final */
+}
+mbedtls_ssl_hs_timing;
+#endif /* MBEDTLS_SSL_HS_TIMING */
 
 struct mbedtls_ssl_context
 {
     const mbedtls_ssl_config *conf; /*!< configuration information          */
 
     /*
-     * Miscellaneous
+     * Record-path hot state
+     *
+     * Everything the record header parser and ssl_decrypt_buf() /
+     * ssl_encrypt_buf() dereference for every record is packed here at
+     * the top of the context, one direction after the other, so the
+     * steady-state record path touches one or two cache lines per
+     * direction instead of chasing fields scattered over the whole
+     * structure. Keep configuration and handshake-only fields out of
+     * this block.
      */
     int state;                  /*!< SSL handshake: current state     */
+    int major_ver;              /*!< equal to  MBEDTLS_SSL_MAJOR_VERSION_3    */
+    int minor_ver;              /*!< either 0 (SSL3) or 1 (TLS1.0)    */
+    int in_msgtype;             /*!< record header: message type      */
+
+    mbedtls_ssl_transform *transform_in;        /*!<  current transform params (in)   */
+    unsigned char *in_ctr;      /*!< 64-bit incoming message counter
+                                     TLS: maintained by us
+                                     DTLS: read from peer             */
+    unsigned char *in_hdr;      /*!< start of record header           */
+    unsigned char *in_len;      /*!< two-bytes message length field   */
+    unsigned char *in_iv;       /*!< ivlen-byte IV                    */
+    unsigned char *in_msg;      /*!< message contents (in_iv+ivlen)   */
+    unsigned char *in_offt;     /*!< read offset in application data  */
+    size_t in_msglen;           /*!< record header: message length    */
+    size_t in_left;             /*!< amount of data read so far       */
+
+    mbedtls_ssl_transform *transform_out;       /*!<  current transform params (out)  */
+    unsigned char *out_ctr;     /*!< 64-bit outgoing message counter  */
+    unsigned char *out_hdr;     /*!< start of record header           */
+    unsigned char *out_len;     /*!< two-bytes message length field   */
+    unsigned char *out_iv;      /*!< ivlen-byte IV                    */
+    unsigned char *out_msg;     /*!< message contents (out_iv+ivlen)  */
+    int out_msgtype;            /*!< record header: message type      */
+    size_t out_msglen;          /*!< record header: message length    */
+    size_t out_left;            /*!< amount of data not yet written   */
+
+    /*
+     * Miscellaneous
+     */
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     int renego_status;          /*!< Initial, in progress, pending?   */
     int renego_records_seen;    /*!< Records since renego request, or with DTLS,
                                   number of retransmissions of request if
                                   renego_max_records is < 0           */
+    int rekey;                  /*!< current renegotiation is an
+                                  abbreviated rekey                   */
 #endif
 
-    int major_ver;              /*!< equal to  MBEDTLS_SSL_MAJOR_VERSION_3    */
-    int minor_ver;              /*!< either 0 (SSL3) or 1 (TLS1.0)    */
-
 #if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
     unsigned badmac_seen;       /*!< records with a bad MAC received    */
+    unsigned badhdr_seen;       /*!< records with a bad header received */
 #endif
 
     /*
@@ -671,6 +1016,11 @@ struct mbedtls_ssl_context
     int (*f_send)(void *, const unsigned char *, size_t);
     int (*f_recv)(void *, unsigned char *, size_t);
     int (*f_recv_timeout)(void *, unsigned char *, size_t, uint32_t);
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    int (*f_send_batch)(void *, const unsigned char **, const size_t *,
+                        size_t);
+    int (*f_recv_batch)(void *, unsigned char **, size_t *, size_t);
+#endif
     void *p_bio;                /*!< context for I/O operations   */
 
     /*
@@ -686,11 +1036,14 @@ struct mbedtls_ssl_context
 
     /*
      * Record layer transformations
+     * (transform_in/transform_out live in the hot block at the top)
      */
-    mbedtls_ssl_transform *transform_in;        /*!<  current transform params (in)   */
-    mbedtls_ssl_transform *transform_out;       /*!<  current transform params (in)   */
     mbedtls_ssl_transform *transform;           /*!<  negotiated transform params     */
     mbedtls_ssl_transform *transform_negotiate; /*!<  transform params in negotiation */
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+    mbedtls_ssl_transform *transform_pool;      /*!<  retired transform kept for
+                                                      reuse by the next handshake    */
+#endif
 
     /*
      * Timers
@@ -701,48 +1054,75 @@ struct mbedtls_ssl_context
 
     /*
      * Record layer (incoming data)
+     * (the per-record fields live in the hot block at the top)
      */
     unsigned char *in_buf;      /*!< input buffer                     */
-    unsigned char *in_ctr;      /*!< 64-bit incoming message counter
-                                     TLS: maintained by us
-                                     DTLS: read from peer             */
-    unsigned char *in_hdr;      /*!< start of record header           */
-    unsigned char *in_len;      /*!< two-bytes message length field   */
-    unsigned char *in_iv;       /*!< ivlen-byte IV                    */
-    unsigned char *in_msg;      /*!< message contents (in_iv+ivlen)   */
-    unsigned char *in_offt;     /*!< read offset in application data  */
-
-    int in_msgtype;             /*!< record header: message type      */
-    size_t in_msglen;           /*!< record header: message length    */
-    size_t in_left;             /*!< amount of data read so far       */
+    size_t in_buf_len;          /*!< current size of the input buffer,
+                                     or 0 if it has been released      */
+    size_t in_buf_hwm;          /*!< bytes of the input buffer used since
+                                     the last reset (high-water mark)  */
+    unsigned char saved_in_ctr[8];  /*!< incoming counter saved while
+                                     the input buffer is released      */
+    size_t next_record_offset;  /*!< offset of the next record in the
+                                     input buffer (0 if none pending) */
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     uint16_t in_epoch;          /*!< DTLS epoch for incoming records  */
-    size_t next_record_offset;  /*!< offset of the next record in datagram
-                                     (equal to in_left if none)       */
+    unsigned char *dgram_held[MBEDTLS_SSL_DGRAM_BATCH - 1];
+                                /*!< datagrams from the last batched read
+                                     not yet passed to the record layer */
+    size_t dgram_held_len[MBEDTLS_SSL_DGRAM_BATCH - 1];
+                                /*!< length of each held datagram     */
+    unsigned char dgram_held_first; /*!< index of oldest held datagram */
+    unsigned char dgram_held_count; /*!< number of held datagrams     */
+    uint16_t mtu;               /*!< path MTU, used to fragment outgoing
+                                     handshake messages (0 = unset)    */
 #endif
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
     uint64_t in_window_top;     /*!< last validated record seq_num    */
-    uint64_t in_window;         /*!< bitmask for replay detection     */
+    uint64_t in_window[MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE / 64 + 1];
+                                /*!< ring bitmap for replay detection;
+                                     the spare word keeps sliding O(1) */
 #endif
 
     size_t in_hslen;            /*!< current handshake message length,
                                      including the handshake header   */
     int nb_zero;                /*!< # of 0-length encrypted messages */
     int record_read;            /*!< record is already present        */
+    int pending_fatal;          /*!< error hit while draining buffered
+                                     records, returned by the next read */
 
     /*
      * Record layer (outgoing data)
+     * (the per-record fields live in the hot block at the top)
      */
     unsigned char *out_buf;     /*!< output buffer                    */
-    unsigned char *out_ctr;     /*!< 64-bit outgoing message counter  */
-    unsigned char *out_hdr;     /*!< start of record header           */
-    unsigned char *out_len;     /*!< two-bytes message length field   */
-    unsigned char *out_iv;      /*!< ivlen-byte IV                    */
-    unsigned char *out_msg;     /*!< message contents (out_iv+ivlen)  */
-
-    int out_msgtype;            /*!< record header: message type      */
-    size_t out_msglen;          /*!< record header: message length    */
-    size_t out_left;            /*!< amount of data not yet written   */
+    size_t out_held;            /*!< bytes of complete records held
+                                     back for coalescing (TLS only)    */
+    size_t dyn_rec_cur;         /*!< current dynamic record size limit,
+                                     or 0 if not yet in use            */
+    size_t dyn_rec_sent;        /*!< bytes sent at the current limit  */
+#if defined(MBEDTLS_TIMING_C)
+    struct mbedtls_timing_hr_time dyn_rec_last; /*!< time of the last
+                                     application data record           */
+#endif
+    size_t out_buf_len;         /*!< current size of the output buffer,
+                                     or 0 if it has been released      */
+    size_t out_buf_hwm;         /*!< bytes of the output buffer used since
+                                     the last reset (high-water mark)  */
+    unsigned char saved_out_ctr[8]; /*!< outgoing counter saved while
+                                     the output buffer is released     */
+
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    unsigned char *out_spare;   /*!< spare output buffer: swapped in when
+                                     the active buffer is retired with
+                                     unsent bytes, so the next record can
+                                     be encrypted while those drain      */
+    size_t out_spare_len;       /*!< size of the spare buffer         */
+    unsigned char *out_drain;   /*!< unsent bytes of the retired buffer,
+                                     sent before anything else on the
+                                     next flush                         */
+    size_t out_drain_len;       /*!< number of unsent retired bytes   */
+#endif
 
 #if defined(MBEDTLS_ZLIB_SUPPORT)
     unsigned char *compress_buf;        /*!<  zlib data buffer        */
@@ -787,6 +1167,21 @@ struct mbedtls_ssl_context
     char own_verify_data[MBEDTLS_SSL_VERIFY_DATA_MAX_LEN]; /*!<  previous handshake verify data */
     char peer_verify_data[MBEDTLS_SSL_VERIFY_DATA_MAX_LEN]; /*!<  previous handshake verify data */
 #endif
+
+#if defined(MBEDTLS_SSL_STATS)
+    mbedtls_ssl_stats stats;            /*!<  event counters, see
+                                              mbedtls_ssl_get_stats()       */
+#endif
+
+#if defined(MBEDTLS_SSL_HS_TIMING)
+    mbedtls_ssl_hs_timing hs_timing;    /*!<  timing breakdown of the
+                                              current or last handshake, see
+                                              mbedtls_ssl_get_hs_timing()   */
+    unsigned long hs_timing_start;      /*!<  hardclock when the first step
+                                              of the handshake was entered  */
+    unsigned long hs_timing_last;       /*!<  hardclock when the last step
+                                              returned                      */
+#endif
 };
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
@@ -1001,6 +1396,72 @@ void mbedtls_ssl_set_bio( mbedtls_ssl_context *ssl,
         int (*f_recv)(void *, unsigned char *, size_t),
         int (*f_recv_timeout)(void *, unsigned char *, size_t, uint32_t) );
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+/**
+ * \brief          Set the underlying batched BIO callbacks for write and
+ *                 read. (DTLS only.)
+ *
+ * \param ssl      SSL context
+ * \param p_bio    parameter (context) shared by BIO callbacks
+ * \param f_send_batch  batched write callback, or NULL
+ * \param f_recv_batch  batched read callback, or NULL
+ *
+ * \note           Both callbacks take arrays of 'count' buffers and lengths
+ *                 and return the number of datagrams written/read (at least
+ *                 1), or one of the error codes accepted from f_send/f_recv.
+ *                 On read, the length array holds the buffer capacities on
+ *                 entry and the datagram lengths on return.
+ *                 \c mbedtls_net_sendmmsg() and \c mbedtls_net_recvmmsg()
+ *                 follow this convention.
+ *
+ * \note           When f_recv_batch is set, it is used instead of
+ *                 f_recv/f_recv_timeout: up to MBEDTLS_SSL_DGRAM_BATCH
+ *                 datagrams are read per call, cutting syscall overhead
+ *                 under load. Datagrams beyond the first are held in the
+ *                 SSL context (storage for them is allocated on first use)
+ *                 and consumed by subsequent record reads before any
+ *                 further call to the callback. Since the callback carries
+ *                 no timeout, sockets must be non-blocking and timers
+ *                 (\c mbedtls_ssl_set_timer_cb()) handle retransmission.
+ *
+ * \note           When f_send_batch is set and no f_send callback is
+ *                 configured, outgoing records are sent through it one
+ *                 datagram at a time, so a single pair of batched callbacks
+ *                 is enough for both directions.
+ */
+void mbedtls_ssl_set_bio_batch( mbedtls_ssl_context *ssl,
+        void *p_bio,
+        int (*f_send_batch)(void *, const unsigned char **, const size_t *,
+                            size_t),
+        int (*f_recv_batch)(void *, unsigned char **, size_t *, size_t) );
+
+/**
+ * \brief          Set the path MTU for outgoing handshake fragmentation
+ *                 (DTLS only; default: 0, no fragmentation)
+ *
+ *                 Outgoing handshake messages that would not fit in a
+ *                 datagram of \p mtu bytes (typically a Certificate chain)
+ *                 are split into several handshake fragments, which the
+ *                 peer reassembles. Without an MTU, such messages are sent
+ *                 in a single oversized datagram and usually dropped by
+ *                 the network.
+ *
+ * \note           This can be called at any time, so an application doing
+ *                 path MTU discovery can lower the value when it learns of
+ *                 a tighter path. The value is also capped by the maximum
+ *                 fragment length negotiated through the RFC 6066
+ *                 extension, if any.
+ *
+ * \note           Application data is not fragmented: it is still bounded
+ *                 by the (negotiated) maximum fragment length only.
+ *
+ * \param ssl      SSL context
+ * \param mtu      Datagram payload size the path is known to carry,
+ *                 or 0 to disable handshake fragmentation
+ */
+void mbedtls_ssl_set_mtu( mbedtls_ssl_context *ssl, uint16_t mtu );
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
 /**
  * \brief          Set the timeout period for mbedtls_ssl_read()
  *                 (Default: no timeout.)
@@ -1019,6 +1480,32 @@ void mbedtls_ssl_set_bio( mbedtls_ssl_context *ssl,
  */
 void mbedtls_ssl_conf_read_timeout( mbedtls_ssl_config *conf, uint32_t timeout );
 
+/**
+ * \brief          Enable or disable TLS record read-ahead
+ *                 (Default: MBEDTLS_SSL_READ_AHEAD_DISABLED)
+ *
+ *                 With read-ahead enabled, the record layer asks the
+ *                 transport for as much data as the input buffer holds
+ *                 instead of exactly one record, and mbedtls_ssl_read()
+ *                 drains every complete application data record already
+ *                 buffered into the caller's buffer in one call. A bulk
+ *                 of small records arriving in one TCP segment is then
+ *                 processed with a single receive call and returned as
+ *                 one contiguous span.
+ *
+ * \note           The SSL layer may read past the current record, so
+ *                 the underlying transport must carry nothing but this
+ *                 TLS connection. Ignored for DTLS, where reads are
+ *                 datagram-sized already, and when the library is built
+ *                 with MBEDTLS_ZLIB_SUPPORT, since decompression expands
+ *                 records in place.
+ *
+ * \param conf     SSL configuration
+ * \param enable   MBEDTLS_SSL_READ_AHEAD_ENABLED or
+ *                 MBEDTLS_SSL_READ_AHEAD_DISABLED
+ */
+void mbedtls_ssl_conf_read_ahead( mbedtls_ssl_config *conf, int enable );
+
 /**
  * \brief          Set the timer callbacks
  *                 (Mandatory for DTLS.)
@@ -1084,6 +1571,8 @@ typedef int mbedtls_ssl_ticket_write_t( void *p_ticket,
  * \param len       Length of the ticket.
  *
  * \return          0 if successful, or
+ *                  MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH if the session was
+ *                  loaded but a fresh ticket should be issued to the client, or
  *                  MBEDTLS_ERR_SSL_INVALID_MAC if not authentic, or
  *                  MBEDTLS_ERR_SSL_SESSION_TICKET_EXPIRED if expired, or
  *                  any other non-zero code for other failures.
@@ -1114,6 +1603,104 @@ void mbedtls_ssl_conf_session_tickets_cb( mbedtls_ssl_config *conf,
         void *p_ticket );
 #endif /* MBEDTLS_SSL_SESSION_TICKETS && MBEDTLS_SSL_SRV_C */
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+/**
+ * \brief          Configure asynchronous private key operation callbacks
+ *                 (server-side only).
+ *
+ *                 When these callbacks are set, the server offers private
+ *                 key operations (the ServerKeyExchange signature and the
+ *                 decryption of an RSA-encrypted premaster secret) to
+ *                 \p f_async_sign / \p f_async_decrypt instead of running
+ *                 them itself, so they can be shipped to a worker thread
+ *                 or an external accelerator while the calling event loop
+ *                 keeps serving other connections.
+ *
+ *                 A start callback must return 0 if it started the
+ *                 operation, MBEDTLS_ERR_SSL_HW_ACCEL_FALLTHROUGH to have
+ *                 the library fall back to the built-in software
+ *                 implementation for this operation, or another negative
+ *                 error code to abort the handshake.
+ *
+ *                 After a start callback returns 0, the function that was
+ *                 driving the handshake returns
+ *                 MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS. Calling it again
+ *                 invokes \p f_async_resume, which must either write the
+ *                 result (signature or decrypted premaster secret) to the
+ *                 output buffer and return 0, return
+ *                 MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS if the operation has
+ *                 not completed yet, or return another negative error
+ *                 code to abort the handshake.
+ *
+ *                 \p f_async_cancel is called if the connection is closed
+ *                 or reset while an operation is outstanding, ie when a
+ *                 started operation will never be resumed.
+ *
+ *                 The callbacks may keep per-operation state with
+ *                 \c mbedtls_ssl_set_async_operation_data(); the sign and
+ *                 decrypt callbacks receive the certificate whose private
+ *                 key is to be used, which with multiple own certificates
+ *                 or SNI identifies the key. For signatures, a hash
+ *                 length of 0 means the length is implied by the given
+ *                 hash algorithm, as with mbedtls_pk_sign().
+ *
+ * \param conf            SSL configuration context
+ * \param f_async_sign    Callback to start a signature operation, or NULL
+ * \param f_async_decrypt Callback to start a decryption operation, or NULL
+ * \param f_async_resume  Callback to collect an operation's result
+ *                        (must not be NULL if a start callback is set)
+ * \param f_async_cancel  Callback to cancel an operation, or NULL
+ * \param p_async         Configuration-wide context for the callbacks,
+ *                        retrievable inside them with
+ *                        \c mbedtls_ssl_conf_get_async_config_data()
+ */
+void mbedtls_ssl_conf_async_private_cb( mbedtls_ssl_config *conf,
+        int (*f_async_sign)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                             mbedtls_md_type_t, const unsigned char *, size_t ),
+        int (*f_async_decrypt)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                                const unsigned char *, size_t ),
+        int (*f_async_resume)( mbedtls_ssl_context *, unsigned char *,
+                               size_t *, size_t ),
+        void (*f_async_cancel)( mbedtls_ssl_context * ),
+        void *p_async );
+
+/**
+ * \brief          Retrieve the configuration-wide context that was given
+ *                 to \c mbedtls_ssl_conf_async_private_cb()
+ *
+ * \param conf     SSL configuration context
+ *
+ * \return         The asynchronous callback context, or NULL if none set
+ */
+void *mbedtls_ssl_conf_get_async_config_data( const mbedtls_ssl_config *conf );
+
+/**
+ * \brief          Retrieve the per-operation context set by the
+ *                 asynchronous callbacks for the current handshake
+ *
+ * \param ssl      SSL context
+ *
+ * \return         The value set with
+ *                 \c mbedtls_ssl_set_async_operation_data(), or NULL if
+ *                 none was set or no handshake is in progress
+ */
+void *mbedtls_ssl_get_async_operation_data( const mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          Attach a per-operation context to the current handshake,
+ *                 for use by the asynchronous callbacks
+ *
+ * \note           The library never frees this: the callbacks own it and
+ *                 must release it from \c f_async_resume or
+ *                 \c f_async_cancel.
+ *
+ * \param ssl      SSL context
+ * \param ctx      Opaque context to attach
+ */
+void mbedtls_ssl_set_async_operation_data( mbedtls_ssl_context *ssl,
+                                           void *ctx );
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
 /**
  * \brief          Callback type: generate a cookie
  *
@@ -1247,6 +1834,27 @@ void mbedtls_ssl_conf_dtls_anti_replay( mbedtls_ssl_config *conf, char mode );
  *                 many bogus packets.
  */
 void mbedtls_ssl_conf_dtls_badmac_limit( mbedtls_ssl_config *conf, unsigned limit );
+
+/**
+ * \brief          Set a limit on the number of records with an invalid
+ *                 header before terminating the connection.
+ *                 (DTLS only, no effect on TLS.)
+ *                 Default: 0 (disabled).
+ *
+ * \param conf     SSL configuration
+ * \param limit    Limit, or 0 to disable.
+ *
+ * \note           This is the header-stage counterpart of
+ *                 \c mbedtls_ssl_conf_dtls_badmac_limit(): it counts the
+ *                 records discarded before any decryption work (unknown
+ *                 type, wrong version, wrong epoch, replayed sequence
+ *                 number or bad length), which an attacker can produce
+ *                 without any knowledge of the connection keys. Since
+ *                 rejecting them is much cheaper than a failed
+ *                 authenticated decryption, a proportionally higher limit
+ *                 than the bad-MAC one is usually appropriate.
+ */
+void mbedtls_ssl_conf_dtls_badhdr_limit( mbedtls_ssl_config *conf, unsigned limit );
 #endif /* MBEDTLS_SSL_DTLS_BADMAC_LIMIT */
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -1267,6 +1875,28 @@ void mbedtls_ssl_conf_dtls_badmac_limit( mbedtls_ssl_config *conf, unsigned limi
  *                 network congestion by causing more retransmissions.
  */
 void mbedtls_ssl_conf_handshake_timeout( mbedtls_ssl_config *conf, uint32_t min, uint32_t max );
+
+/**
+ * \brief          Set a limit on the number of records sent per call when
+ *                 retransmitting a handshake flight.
+ *                 (DTLS only, no effect on TLS.)
+ *
+ * \param conf     SSL configuration
+ * \param burst    Maximum number of records per retransmission burst,
+ *                 or 0 for no limit (the default).
+ *
+ * \note           When the limit is hit, the function driving the handshake
+ *                 returns MBEDTLS_ERR_SSL_WANT_WRITE and sends the rest of
+ *                 the flight on subsequent calls, giving the network a
+ *                 chance to drain in between. This helps avoid bursts of
+ *                 datagrams overflowing intermediate buffers when flights
+ *                 are large (eg long certificate chains).
+ *
+ * \note           The initial transmission of a flight is already paced one
+ *                 record per handshake step; this limit only applies to
+ *                 retransmissions.
+ */
+void mbedtls_ssl_conf_handshake_burst( mbedtls_ssl_config *conf, unsigned int burst );
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
 #if defined(MBEDTLS_SSL_SRV_C)
@@ -1313,6 +1943,86 @@ void mbedtls_ssl_conf_session_cache( mbedtls_ssl_config *conf,
         int (*f_set_cache)(void *, const mbedtls_ssl_session *) );
 #endif /* MBEDTLS_SSL_SRV_C */
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+/**
+ * \brief          Initialize an ECDH reuse context (just makes it ready for
+ *                 mbedtls_ssl_conf_ecdh_reuse() or freeing)
+ *
+ * \param ctx      ECDH reuse context
+ */
+void mbedtls_ssl_ecdh_reuse_init( mbedtls_ssl_ecdh_reuse_context *ctx );
+
+/**
+ * \brief          Free the keypair held by an ECDH reuse context
+ *
+ * \param ctx      ECDH reuse context
+ */
+void mbedtls_ssl_ecdh_reuse_free( mbedtls_ssl_ecdh_reuse_context *ctx );
+
+/**
+ * \brief          Amortize the server's ephemeral ECDHE key over a bounded
+ *                 window of handshakes (server-side only)
+ *
+ *                 This trades some forward secrecy granularity for one
+ *                 mbedtls_ecp_mul() less per handshake: all handshakes
+ *                 served from the same cached keypair share its secret.
+ *                 The keypair is regenerated after max_uses handshakes,
+ *                 after max_age seconds, and whenever a handshake selects
+ *                 a different curve than the cached one.
+ *
+ * \param conf     SSL configuration
+ * \param ctx      ECDH reuse context, initialized with
+ *                 mbedtls_ssl_ecdh_reuse_init(); must remain valid as long
+ *                 as the configuration is in use, and may be shared by
+ *                 several configurations
+ * \param max_uses maximum number of handshakes served per keypair
+ * \param max_age  maximum keypair lifetime in seconds, 0 for no limit
+ *                 (ignored if MBEDTLS_HAVE_TIME is undefined)
+ */
+void mbedtls_ssl_conf_ecdh_reuse( mbedtls_ssl_config *conf,
+                                  mbedtls_ssl_ecdh_reuse_context *ctx,
+                                  int max_uses, uint32_t max_age );
+#endif /* MBEDTLS_SSL_ECDH_REUSE */
+
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+/**
+ * \brief          Initialize a handshake structure pool (just makes it
+ *                 ready for mbedtls_ssl_conf_handshake_pool() or freeing)
+ *
+ * \param pool     handshake structure pool
+ */
+void mbedtls_ssl_handshake_pool_init( mbedtls_ssl_handshake_pool *pool );
+
+/**
+ * \brief          Free every structure held by a handshake pool
+ *
+ * \note           Only call this after the contexts of every configuration
+ *                 referencing the pool have been freed.
+ *
+ * \param pool     handshake structure pool
+ */
+void mbedtls_ssl_handshake_pool_free( mbedtls_ssl_handshake_pool *pool );
+
+/**
+ * \brief          Recycle the per-handshake substructures through a pool
+ *
+ *                 Every handshake needs one mbedtls_ssl_handshake_params,
+ *                 one mbedtls_ssl_transform and one mbedtls_ssl_session,
+ *                 normally obtained with three allocator calls and freed
+ *                 again when the connection ends. With a pool configured,
+ *                 released structures go on a freelist and are handed to
+ *                 the next handshake in O(1), sparing the allocator
+ *                 traffic and the fragmentation it causes on long uptimes.
+ *
+ * \param conf     SSL configuration
+ * \param pool     pool initialized with mbedtls_ssl_handshake_pool_init();
+ *                 must remain valid as long as the configuration is in
+ *                 use, and may be shared by several configurations
+ */
+void mbedtls_ssl_conf_handshake_pool( mbedtls_ssl_config *conf,
+                                      mbedtls_ssl_handshake_pool *pool );
+#endif /* MBEDTLS_SSL_HANDSHAKE_POOL */
+
 #if defined(MBEDTLS_SSL_CLI_C)
 /**
  * \brief          Request resumption of session (client-side only)
@@ -1382,6 +2092,42 @@ void mbedtls_ssl_conf_ciphersuites_for_version( mbedtls_ssl_config *conf,
 void mbedtls_ssl_conf_cert_profile( mbedtls_ssl_config *conf,
                                     mbedtls_x509_crt_profile *profile );
 
+/**
+ * \brief          Set how much of the peer's certificate chain is kept
+ *                 in the session after verification
+ *                 (Default: MBEDTLS_SSL_CERT_RETAIN_FULL)
+ *
+ *                 The chain kept in the session is a deep copy of the one
+ *                 received during the handshake, and is duplicated again
+ *                 into the session cache; with a typical chain this is
+ *                 by far the largest part of a cached session. Resumption
+ *                 itself never needs it, so sessions can retain less:
+ *
+ *                 MBEDTLS_SSL_CERT_RETAIN_FULL    the whole chain (default)
+ *                 MBEDTLS_SSL_CERT_RETAIN_LEAF    only the peer's own cert
+ *                 MBEDTLS_SSL_CERT_RETAIN_DIGEST  only a SHA-256 of the
+ *                                 peer's cert, available through
+ *                                 mbedtls_ssl_get_peer_cert_digest()
+ *                                 (requires MBEDTLS_SHA256_C, behaves as
+ *                                 RETAIN_NONE without it)
+ *                 MBEDTLS_SSL_CERT_RETAIN_NONE    nothing
+ *
+ * \note           With less than the full chain retained,
+ *                 mbedtls_ssl_get_peer_cert() returns the leaf only or
+ *                 NULL. The policy takes effect after verification and
+ *                 does not affect it, nor the verify callback, which
+ *                 still sees the whole chain.
+ *
+ * \note           A client refuses renegotiation when the retained
+ *                 information is not enough to check that the server's
+ *                 certificate did not change (that is, with RETAIN_NONE,
+ *                 or RETAIN_DIGEST without MBEDTLS_SHA256_C).
+ *
+ * \param conf     SSL configuration
+ * \param retain   Retention policy, one of MBEDTLS_SSL_CERT_RETAIN_XXX
+ */
+void mbedtls_ssl_conf_cert_retention( mbedtls_ssl_config *conf, int retain );
+
 /**
  * \brief          Set the data required to verify peer certificate
  *
@@ -1393,6 +2139,91 @@ void mbedtls_ssl_conf_ca_chain( mbedtls_ssl_config *conf,
                                mbedtls_x509_crt *ca_chain,
                                mbedtls_x509_crl *ca_crl );
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+/**
+ * \brief          Set a cache for parsing peer certificates
+ *                 (Default: NULL, every chain is parsed from scratch)
+ *
+ *                 With a cache set, certificates in incoming Certificate
+ *                 messages are looked up by a digest of their raw DER and
+ *                 shared between connections instead of being re-parsed,
+ *                 which saves a significant number of allocations when
+ *                 peers keep presenting the same few (CA) certificates.
+ *
+ * \note           The cache may be shared by several configurations and,
+ *                 with MBEDTLS_THREADING_C, several threads. It must
+ *                 remain valid until every context using it has freed its
+ *                 peer certificates.
+ *
+ * \param conf     SSL configuration
+ * \param cache    Certificate cache, set up with
+ *                 mbedtls_x509_crt_cache_setup()
+ */
+void mbedtls_ssl_conf_cert_cache( mbedtls_ssl_config *conf,
+                                  mbedtls_x509_crt_cache *cache );
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+
+#if defined(MBEDTLS_X509_TRUST_C)
+/**
+ * \brief          Set an indexed trust store to verify peer certificates
+ *                 against, instead of a plain CA list
+ *
+ *                 With a large CA bundle loaded, issuer lookup through
+ *                 the index is O(1) where the list set with
+ *                 mbedtls_ssl_conf_ca_chain() is scanned linearly.
+ *                 Takes precedence over mbedtls_ssl_conf_ca_chain() but
+ *                 not over a CA chain set by the SNI callback.
+ *
+ * \param conf     SSL configuration
+ * \param ca_trust indexed trust store (see x509_trust.h); the store and
+ *                 the certificates it indexes must outlive the
+ *                 configuration
+ * \param ca_crl   trusted CA CRLs
+ */
+void mbedtls_ssl_conf_ca_trust( mbedtls_ssl_config *conf,
+                                const mbedtls_x509_trust *ca_trust,
+                                mbedtls_x509_crl *ca_crl );
+#endif /* MBEDTLS_X509_TRUST_C */
+
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+/**
+ * \brief          Set a cache memoizing peer certificate verification
+ *                 results (Default: NULL, every chain is fully verified)
+ *
+ *                 With a cache set, a chain already verified against the
+ *                 same CAs within the cache's timeout skips the signature
+ *                 checks. The cache is bypassed when a verification
+ *                 callback is configured, since the callback must see
+ *                 every certificate. Flush the cache whenever the trusted
+ *                 CAs or CRLs change.
+ *
+ * \param conf     SSL configuration
+ * \param cache    Verification cache, set up with
+ *                 mbedtls_x509_verify_cache_setup()
+ */
+void mbedtls_ssl_conf_verify_cache( mbedtls_ssl_config *conf,
+                                    mbedtls_x509_verify_cache *cache );
+#endif /* MBEDTLS_X509_VERIFY_CACHE_C */
+
+/**
+ * \brief          Set an executor running the peer chain's signature
+ *                 checks in parallel (Default: NULL, checks run inline)
+ *
+ *                 With an executor set, certificate verification during
+ *                 the handshake uses mbedtls_x509_crt_verify_pipelined(),
+ *                 so the chain-link signature checks of a deep chain run
+ *                 concurrently on the executor's threads. The executor is
+ *                 only used when no verification callback is configured
+ *                 and no indexed trust store is in use; otherwise the
+ *                 serial path is taken.
+ *
+ * \param conf     SSL configuration
+ * \param executor Task executor (see x509_crt.h), which must remain
+ *                 valid for the lifetime of the configuration, or NULL
+ */
+void mbedtls_ssl_conf_verify_executor( mbedtls_ssl_config *conf,
+                            const mbedtls_x509_verify_executor *executor );
+
 /**
  * \brief          Set own certificate chain and private key
  *
@@ -1510,6 +2341,20 @@ int mbedtls_ssl_conf_dh_param( mbedtls_ssl_config *conf, const char *dhm_P, cons
  * \return         0 if successful
  */
 int mbedtls_ssl_conf_dh_param_ctx( mbedtls_ssl_config *conf, mbedtls_dhm_context *dhm_ctx );
+
+/**
+ * \brief          Use one of the library's well-known Diffie-Hellman
+ *                 groups (server-side only). Cheaper per handshake
+ *                 than mbedtls_ssl_conf_dh_param(): the parameters are
+ *                 preparsed and the Montgomery constant for the
+ *                 modular exponentiation comes precomputed.
+ *
+ * \param conf     SSL configuration
+ * \param group_id group to use, see mbedtls_dhm_group_id
+ *
+ * \return         0 if successful
+ */
+int mbedtls_ssl_conf_dh_group( mbedtls_ssl_config *conf, mbedtls_dhm_group_id group_id );
 #endif /* MBEDTLS_DHM_C && defined(MBEDTLS_SSL_SRV_C) */
 
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
@@ -1668,6 +2513,46 @@ void mbedtls_ssl_conf_sni( mbedtls_ssl_config *conf,
                   int (*f_sni)(void *, mbedtls_ssl_context *, const unsigned char *,
                                size_t),
                   void *p_sni );
+
+/**
+ * \brief          Register a certificate for built-in selection by server
+ *                 name (optional, server-side only).
+ *
+ *                 The certificate is indexed in a hash table under the DNS
+ *                 names it contains: the subjectAltName dNSName entries, or
+ *                 the subject CN if the certificate has no subjectAltName
+ *                 extension. Wildcard names ("*.example.com") are supported
+ *                 with the same semantics as certificate verification: the
+ *                 wildcard stands for exactly one label.
+ *
+ *                 When the client sends a ServerName extension and no
+ *                 \c mbedtls_ssl_conf_sni() callback is set, the requested
+ *                 name is looked up in the table and all matching
+ *                 certificates are offered for ciphersuite-based selection,
+ *                 so a name may be registered with both an RSA and an EC
+ *                 certificate. Lookup cost is independent of the number of
+ *                 registered certificates. If no name matches, the
+ *                 certificates configured with mbedtls_ssl_conf_own_cert()
+ *                 are used, as for clients not sending the extension.
+ *
+ *                 A callback set with mbedtls_ssl_conf_sni() takes
+ *                 precedence over the table.
+ *
+ * \note           Like mbedtls_ssl_conf_own_cert(), this function keeps
+ *                 references: own_cert and pk_key must outlive the
+ *                 configuration.
+ *
+ * \param conf     SSL configuration
+ * \param own_cert own public certificate chain
+ * \param pk_key   own private key
+ *
+ * \return         0 on success, MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the
+ *                 certificate contains no usable name, or
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED on memory allocation failure
+ */
+int mbedtls_ssl_conf_sni_cert( mbedtls_ssl_config *conf,
+                               mbedtls_x509_crt *own_cert,
+                               mbedtls_pk_context *pk_key );
 #endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
 
 #if defined(MBEDTLS_SSL_ALPN)
@@ -1821,6 +2706,95 @@ void mbedtls_ssl_conf_arc4_support( mbedtls_ssl_config *conf, char arc4 );
 int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_code );
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+/**
+ * \brief          Set the content size of the I/O buffers for established
+ *                 connections (Default: MBEDTLS_SSL_MAX_CONTENT_LEN for both)
+ *
+ *                 The handshake always uses full-size buffers; once it
+ *                 completes, each buffer is shrunk to the configured size
+ *                 (plus space for record headers etc.). This allows servers
+ *                 with many mostly-idle connections to keep per-connection
+ *                 memory low without a custom build.
+ *
+ * \note           If an incoming record is larger than the configured input
+ *                 size, the input buffer is transparently grown back, up to
+ *                 the compile-time maximum, so interoperability is preserved.
+ *                 To also bound the peer's record size, use
+ *                 mbedtls_ssl_conf_max_frag_len().
+ *
+ * \note           The output size bounds the length of records we emit,
+ *                 like a shorter MBEDTLS_SSL_MAX_CONTENT_LEN would:
+ *                 mbedtls_ssl_write() with a larger buffer performs a
+ *                 partial write on TLS and fails on DTLS.
+ *
+ * \param conf     SSL configuration
+ * \param in_len   maximum content length for the input buffer,
+ *                 or 0 to keep the compile-time default
+ * \param out_len  maximum content length for the output buffer,
+ *                 or 0 to keep the compile-time default
+ */
+void mbedtls_ssl_conf_buffer_sizes( mbedtls_ssl_config *conf,
+                                    size_t in_len, size_t out_len );
+
+/**
+ * \brief          Coalesce small outgoing records into fewer network
+ *                 writes (Default: disabled)
+ *
+ *                 When a watermark is set, application data records
+ *                 smaller than it are kept in the output buffer instead
+ *                 of being sent right away; they go out in a single
+ *                 send once the pending bytes reach the watermark, when
+ *                 a record no longer fits in the buffer, when anything
+ *                 other than application data is written, or on an
+ *                 explicit mbedtls_ssl_flush(). This avoids one TCP
+ *                 segment (and one syscall) per small record without
+ *                 touching socket options.
+ *
+ * \note           TLS only: with DTLS each record is a datagram and is
+ *                 never held back. Held records count as written, so
+ *                 callers must flush (or write something larger) before
+ *                 blocking on a response from the peer.
+ *
+ * \param conf      SSL configuration
+ * \param watermark Pending-byte threshold that triggers transmission,
+ *                  or 0 to send every record immediately
+ */
+void mbedtls_ssl_conf_output_coalescing( mbedtls_ssl_config *conf,
+                                         size_t watermark );
+
+/**
+ * \brief          Size outgoing application data records dynamically
+ *                 (Default: disabled, records are only bounded by the
+ *                 maximum fragment length)
+ *
+ *                 A full-size first record must be completely received
+ *                 (possibly over several TCP segments, and retransmitted
+ *                 losses) before the peer can decrypt anything, which
+ *                 hurts time-to-first-byte on fresh or lossy
+ *                 connections. With dynamic sizing, records start at
+ *                 \p start_len bytes of payload; every time \p
+ *                 grow_bytes have been sent at the current limit it
+ *                 doubles, up to MBEDTLS_SSL_MAX_CONTENT_LEN, so bulk
+ *                 transfers quickly reach full-size records. After \p
+ *                 idle_ms milliseconds without application data the
+ *                 limit falls back to \p start_len.
+ *
+ * \note           Idle fallback needs MBEDTLS_TIMING_C and is skipped
+ *                 otherwise (or when \p idle_ms is 0). TLS only: DTLS
+ *                 records are already sized by the datagram.
+ *
+ * \param conf       SSL configuration
+ * \param start_len  initial record payload limit in bytes,
+ *                   or 0 to disable dynamic sizing
+ * \param grow_bytes bytes to send at a given limit before doubling it
+ * \param idle_ms    idle time after which the limit is reset,
+ *                   or 0 to never reset it
+ */
+void mbedtls_ssl_conf_dynamic_record_sizing( mbedtls_ssl_config *conf,
+                                             size_t start_len,
+                                             size_t grow_bytes,
+                                             uint32_t idle_ms );
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 /**
  * \brief          Activate negotiation of truncated HMAC
@@ -1848,6 +2822,34 @@ void mbedtls_ssl_conf_truncated_hmac( mbedtls_ssl_config *conf, int truncate );
 void mbedtls_ssl_conf_cbc_record_splitting( mbedtls_ssl_config *conf, char split );
 #endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+/**
+ * \brief          Set the length-hiding padding boundary for outgoing
+ *                 records on CBC ciphersuites.
+ *                 (Default: 0, minimal padding only.)
+ *
+ *                 TLS block cipher padding may cover up to 256 bytes, not
+ *                 just what is needed to fill the last block. With a
+ *                 non-zero boundary, the protected length of each outgoing
+ *                 record is rounded up to a multiple of the boundary, so
+ *                 observed record sizes no longer track plaintext sizes
+ *                 byte for byte. The pad bytes are fixed by the protocol
+ *                 (each holds the pad length), so this costs no random
+ *                 generation, only the encryption of the extra blocks.
+ *
+ * \note           The boundary is rounded up to a multiple of the cipher
+ *                 block size, and the total padding of a record is capped
+ *                 at 256 bytes, which also caps the useful boundary.
+ *                 AEAD and stream ciphersuites have no record padding in
+ *                 TLS 1.2 and are not affected.
+ *
+ * \param conf     SSL configuration
+ * \param boundary pad records to a multiple of this many bytes (0 to
+ *                 restore minimal padding)
+ */
+void mbedtls_ssl_conf_record_pad( mbedtls_ssl_config *conf, size_t boundary );
+#endif /* MBEDTLS_SSL_RECORD_PADDING */
+
 #if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
 /**
  * \brief          Enable / Disable session tickets (client only).
@@ -1862,6 +2864,34 @@ void mbedtls_ssl_conf_cbc_record_splitting( mbedtls_ssl_config *conf, char split
 void mbedtls_ssl_conf_session_tickets( mbedtls_ssl_config *conf, int use_tickets );
 #endif /* MBEDTLS_SSL_SESSION_TICKETS && MBEDTLS_SSL_CLI_C */
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+/**
+ * \brief          Enable / Disable TLS False Start (client only).
+ *                 (Default: MBEDTLS_SSL_FALSE_START_DISABLED.)
+ *
+ *                 When enabled, mbedtls_ssl_write() on a fresh connection
+ *                 sends application data as soon as our Finished message is
+ *                 out, without waiting for the server's, saving one
+ *                 round-trip. The early data is encrypted under the
+ *                 negotiated keys; what is lost is only the confirmation
+ *                 that the server owns the key, which arrives with its
+ *                 Finished and is still verified before anything is read.
+ *
+ * \note           Following draft-ietf-tls-falsestart, early data is only
+ *                 sent on full TLS 1.2 handshakes that negotiated a
+ *                 forward-secret key exchange with an AEAD cipher;
+ *                 otherwise mbedtls_ssl_write() waits for the handshake to
+ *                 complete as usual. Consider restricting the ciphersuite
+ *                 list to suites you would allow a man-in-the-middle to
+ *                 pick when enabling this.
+ *
+ * \param conf     SSL configuration
+ * \param false_start  MBEDTLS_SSL_FALSE_START_ENABLED or
+ *                     MBEDTLS_SSL_FALSE_START_DISABLED
+ */
+void mbedtls_ssl_conf_false_start( mbedtls_ssl_config *conf, int false_start );
+#endif /* MBEDTLS_SSL_FALSE_START */
+
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
 /**
  * \brief          Enable / Disable renegotiation support for connection when
@@ -1881,6 +2911,28 @@ void mbedtls_ssl_conf_session_tickets( mbedtls_ssl_config *conf, int use_tickets
  *                                             MBEDTLS_SSL_RENEGOTIATION_DISABLED)
  */
 void mbedtls_ssl_conf_renegotiation( mbedtls_ssl_config *conf, int renegotiation );
+
+#if defined(MBEDTLS_SSL_SRV_C)
+/**
+ * \brief          Enable / Disable abbreviated rekeying on a server
+ *                 (Default: MBEDTLS_SSL_REKEY_DISABLED)
+ *
+ *                 When enabled, a renegotiation in which the client resumes
+ *                 the session currently in use is accepted as an abbreviated
+ *                 handshake: the authenticated peer identity is kept and a
+ *                 fresh key block is derived from the existing master secret
+ *                 and new randoms, skipping the certificate exchange and
+ *                 asymmetric operations. See \c mbedtls_ssl_rekey().
+ *
+ * \note           Renegotiation support itself must also be enabled with
+ *                 \c mbedtls_ssl_conf_renegotiation().
+ *
+ * \param conf     SSL configuration
+ * \param rekey    Enable or disable (MBEDTLS_SSL_REKEY_ENABLED or
+ *                                    MBEDTLS_SSL_REKEY_DISABLED)
+ */
+void mbedtls_ssl_conf_rekey( mbedtls_ssl_config *conf, int rekey );
+#endif /* MBEDTLS_SSL_SRV_C */
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
 /**
@@ -1982,6 +3034,37 @@ void mbedtls_ssl_conf_renegotiation_period( mbedtls_ssl_config *conf,
  */
 size_t mbedtls_ssl_get_bytes_avail( const mbedtls_ssl_context *ssl );
 
+#if defined(MBEDTLS_SSL_STATS)
+/**
+ * \brief          Snapshot the event counters of a context
+ *
+ *                 Counters start at zero when the context is set up and
+ *                 are never reset, so successive snapshots can be
+ *                 subtracted to get rates.
+ *
+ * \param ssl      SSL context
+ * \param stats    Structure the counters are copied to
+ */
+void mbedtls_ssl_get_stats( const mbedtls_ssl_context *ssl,
+                            mbedtls_ssl_stats *stats );
+#endif /* MBEDTLS_SSL_STATS */
+
+#if defined(MBEDTLS_SSL_HS_TIMING)
+/**
+ * \brief          Snapshot the timing breakdown of the last handshake
+ *
+ *                 The figures are only final once \c done is nonzero;
+ *                 before that they cover the handshake in progress. They
+ *                 are reset when the next handshake (including a
+ *                 renegotiation) starts.
+ *
+ * \param ssl      SSL context
+ * \param timing   Structure the breakdown is copied to
+ */
+void mbedtls_ssl_get_hs_timing( const mbedtls_ssl_context *ssl,
+                                mbedtls_ssl_hs_timing *timing );
+#endif /* MBEDTLS_SSL_HS_TIMING */
+
 /**
  * \brief          Return the result of the certificate verification
  *
@@ -2041,6 +3124,20 @@ int mbedtls_ssl_get_record_expansion( const mbedtls_ssl_context *ssl );
  * \return         the current peer certificate
  */
 const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert( const mbedtls_ssl_context *ssl );
+
+#if defined(MBEDTLS_SHA256_C)
+/**
+ * \brief          Return the SHA-256 of the peer's certificate, if one was
+ *                 retained (see \c mbedtls_ssl_conf_cert_retention())
+ *
+ * \param ssl      SSL context
+ *
+ * \return         Pointer to MBEDTLS_SSL_PEER_CERT_DIGEST_LEN bytes owned
+ *                 by the session, or NULL if no digest was stored
+ */
+const unsigned char *mbedtls_ssl_get_peer_cert_digest(
+                                            const mbedtls_ssl_context *ssl );
+#endif /* MBEDTLS_SHA256_C */
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
 #if defined(MBEDTLS_SSL_CLI_C)
@@ -2063,6 +3160,108 @@ const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert( const mbedtls_ssl_context *ss
 int mbedtls_ssl_get_session( const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session );
 #endif /* MBEDTLS_SSL_CLI_C */
 
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+/**
+ * Negotiated record protection parameters of an established connection,
+ * as extracted by mbedtls_ssl_get_record_keys()
+ */
+typedef struct
+{
+    mbedtls_cipher_type_t cipher;   /*!< record protection cipher         */
+    int minor_ver;                  /*!< negotiated minor version
+                                         (MBEDTLS_SSL_MINOR_VERSION_XXX)   */
+    size_t key_len;                 /*!< length of the keys in bytes      */
+    size_t iv_len;                  /*!< length of the per-record IV      */
+    size_t fixed_iv_len;            /*!< implicit part of the IV (AEAD)   */
+    size_t mac_len;                 /*!< length of the record MAC, 0 with
+                                         an AEAD cipher                    */
+    unsigned char tx_key[32];       /*!< key protecting outgoing records  */
+    unsigned char rx_key[32];       /*!< key protecting incoming records  */
+    unsigned char tx_iv[16];        /*!< IV (AEAD: implicit part/salt)
+                                         for outgoing records              */
+    unsigned char rx_iv[16];        /*!< IV (AEAD: implicit part/salt)
+                                         for incoming records              */
+    unsigned char tx_seq[8];        /*!< sequence number of the next
+                                         outgoing record (big-endian)      */
+    unsigned char rx_seq[8];        /*!< sequence number of the next
+                                         incoming record (big-endian)      */
+} mbedtls_ssl_record_keys;
+
+/**
+ * \brief          Extract the negotiated record protection keys, IVs and
+ *                 sequence numbers of an established connection
+ *
+ *                 This is everything needed to program an external record
+ *                 protection engine such as kernel TLS (setsockopt TLS_TX
+ *                 on Linux) and serve bulk data with sendfile(), bypassing
+ *                 the library's record layer.
+ *
+ * \warning        Once records are produced or consumed outside the
+ *                 library, its sequence numbers are stale: do not write or
+ *                 read application data through this context any more.
+ *
+ * \note           Wipe the structure with mbedtls_zeroize() or similar as
+ *                 soon as the keys have been handed over.
+ *
+ * \param ssl      SSL context (TLS only, after the handshake)
+ * \param keys     structure to fill in
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_BAD_INPUT_DATA if
+ *                 the handshake is not over (or DTLS is in use)
+ */
+int mbedtls_ssl_get_record_keys( const mbedtls_ssl_context *ssl,
+                                 mbedtls_ssl_record_keys *keys );
+#endif /* MBEDTLS_SSL_RECORD_KEY_EXPORT */
+
+/**
+ * \brief          Serialize a session into a flat buffer
+ *
+ *                 The resulting blob is self-contained (the peer certificate
+ *                 is embedded in its ASN.1 form, not as a pointer), so it can
+ *                 be stored in shared memory or an external cache and loaded
+ *                 back with mbedtls_ssl_session_load(). This is the format
+ *                 session tickets already use on the wire, and the natural
+ *                 building block for session cache callbacks
+ *                 (see mbedtls_ssl_conf_session_cache()) backed by a store
+ *                 shared between processes or hosts.
+ *
+ * \warning        The encoding contains a raw copy of the session structure,
+ *                 so it is only valid between instances of the same library
+ *                 version, built with the same configuration, on the same
+ *                 architecture — fine for fork()ed workers or a fleet of
+ *                 identical builds, but not a portable interchange format.
+ *
+ * \param session  session to serialize
+ * \param buf      output buffer
+ * \param buf_len  size of the output buffer
+ * \param olen     on success, number of bytes written
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL if buf is too small
+ */
+int mbedtls_ssl_session_save( const mbedtls_ssl_session *session,
+                              unsigned char *buf, size_t buf_len,
+                              size_t *olen );
+
+/**
+ * \brief          Load a session from a buffer written by
+ *                 mbedtls_ssl_session_save()
+ *
+ *                 On success the session owns freshly allocated copies of
+ *                 the embedded data; free it with mbedtls_ssl_session_free().
+ *
+ * \param session  session structure to fill (should be freshly initialized
+ *                 or freed, its previous content is overwritten)
+ * \param buf      serialized session
+ * \param len      length of the serialized session
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the buffer is malformed,
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED if memory allocation failed
+ */
+int mbedtls_ssl_session_load( mbedtls_ssl_session *session,
+                              const unsigned char *buf, size_t len );
+
 /**
  * \brief          Perform the SSL handshake
  *
@@ -2106,6 +3305,30 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl );
  * \return         0 if successful, or any mbedtls_ssl_handshake() return value.
  */
 int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl );
+
+#if defined(MBEDTLS_SSL_CLI_C)
+/**
+ * \brief          Initiate an abbreviated rekey on the running connection
+ *                 (client-only).
+ *
+ *                 This is a renegotiation that resumes the current session:
+ *                 the peer identity established by the initial handshake is
+ *                 kept and a fresh key block is derived from the existing
+ *                 master secret and new randoms, so no certificate exchange
+ *                 or asymmetric crypto takes place. Intended for long-lived
+ *                 connections that must refresh their traffic keys
+ *                 periodically.
+ *
+ *                 If the server declines to resume (e.g. abbreviated
+ *                 rekeying is not enabled on its side), the handshake
+ *                 falls back to a full renegotiation.
+ *
+ * \param ssl      SSL context
+ *
+ * \return         0 if successful, or any mbedtls_ssl_handshake() return value.
+ */
+int mbedtls_ssl_rekey( mbedtls_ssl_context *ssl );
+#endif /* MBEDTLS_SSL_CLI_C */
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
 /**
@@ -2121,6 +3344,43 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl );
  */
 int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len );
 
+/**
+ * \brief          Borrow the pending application data without copying it
+ *
+ *                 On success, buf points into the SSL input buffer at the
+ *                 unconsumed application data of the current record and len
+ *                 holds its length (0 at EOF). The caller parses the data in
+ *                 place and reports how much it used with
+ *                 mbedtls_ssl_read_consume(); unconsumed bytes are returned
+ *                 again by the next read or borrow.
+ *
+ * \warning        The borrowed bytes live in the SSL input buffer: they are
+ *                 only valid until the next library call on this context
+ *                 that receives data, and writing to them is not allowed.
+ *
+ * \param ssl      SSL context
+ * \param buf      set to the start of the pending application data
+ * \param len      set to the number of bytes available
+ *
+ * \return         0 if successful (including EOF, with len set to 0),
+ *                 or a negative error code.
+ */
+int mbedtls_ssl_read_borrow( mbedtls_ssl_context *ssl,
+                             const unsigned char **buf, size_t *len );
+
+/**
+ * \brief          Consume bytes previously borrowed with
+ *                 mbedtls_ssl_read_borrow()
+ *
+ * \param ssl      SSL context
+ * \param len      number of bytes consumed, at most the length returned
+ *                 by the borrow call
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_BAD_INPUT_DATA if
+ *                 len exceeds the pending data or nothing is borrowed.
+ */
+int mbedtls_ssl_read_consume( mbedtls_ssl_context *ssl, size_t len );
+
 /**
  * \brief          Write exactly 'len' application data bytes
  *
@@ -2145,6 +3405,52 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
  */
 int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len );
 
+/**
+ * Buffer fragment for \c mbedtls_ssl_writev()
+ */
+typedef struct
+{
+    const unsigned char *base;  /*!< start of the fragment  */
+    size_t len;                 /*!< length of the fragment */
+} mbedtls_ssl_iovec;
+
+/**
+ * \brief          Write application data gathered from several fragments
+ *
+ *                 Equivalent to concatenating the fragments and calling
+ *                 mbedtls_ssl_write(), but assembles them directly in the
+ *                 output record buffer, so e.g. a protocol header and a
+ *                 payload can be sent without being copied into a
+ *                 contiguous buffer first.
+ *
+ * \param ssl      SSL context
+ * \param iov      array of fragments to send, in order
+ * \param iovcnt   number of fragments
+ *
+ * \return         the number of bytes actually written (may be less than
+ *                 the sum of the fragment lengths), or a negative error
+ *                 code. The same retry rules as for mbedtls_ssl_write()
+ *                 apply: after MBEDTLS_ERR_SSL_WANT_WRITE, call again with
+ *                 the same arguments.
+ */
+int mbedtls_ssl_writev( mbedtls_ssl_context *ssl,
+                        const mbedtls_ssl_iovec *iov, size_t iovcnt );
+
+/**
+ * \brief          Transmit any records held back for coalescing
+ *                 (see mbedtls_ssl_conf_output_coalescing())
+ *
+ *                 Call this at the end of a burst of small writes, before
+ *                 waiting for the peer's answer.
+ *
+ * \param ssl      SSL context
+ *
+ * \return         0 if successful (or nothing was pending), or
+ *                 MBEDTLS_ERR_SSL_WANT_WRITE: in that case call this
+ *                 function again before writing new application data.
+ */
+int mbedtls_ssl_flush( mbedtls_ssl_context *ssl );
+
 /**
  * \brief           Send an alert message
  *
@@ -2165,6 +3471,25 @@ int mbedtls_ssl_send_alert_message( mbedtls_ssl_context *ssl,
  */
 int mbedtls_ssl_close_notify( mbedtls_ssl_context *ssl );
 
+/**
+ * \brief          Free the I/O buffers of an idle connection
+ *
+ *                 Intended to be called from an event loop between records
+ *                 on mostly-idle connections: the record buffers are the
+ *                 dominant part of a connection's memory footprint, and this
+ *                 releases them while keeping all session and transform
+ *                 state. They are transparently re-allocated by the next
+ *                 call to mbedtls_ssl_read(), mbedtls_ssl_write() etc.
+ *
+ * \note           Best effort: a buffer that still holds pending data, or
+ *                 that is in use by an ongoing handshake, is simply kept.
+ *                 DTLS contexts are left untouched since the retransmission
+ *                 code needs the buffers.
+ *
+ * \param ssl      SSL context
+ */
+void mbedtls_ssl_release_buffers( mbedtls_ssl_context *ssl );
+
 /**
  * \brief          Free referenced items in an SSL context and clear memory
  *
@@ -2203,6 +3528,34 @@ void mbedtls_ssl_config_init( mbedtls_ssl_config *conf );
 int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
                                  int endpoint, int transport, int preset );
 
+/**
+ * \brief          Declare a configuration complete and immutable
+ *
+ *                 A configuration is safe to share between contexts on
+ *                 different threads without locking only as long as nobody
+ *                 mutates it. Freezing makes that contract explicit: after
+ *                 this call the setters that can report errors refuse to
+ *                 modify the configuration (the void ones must simply not
+ *                 be called any more), so all remaining accesses are reads
+ *                 and contexts can be set up from any thread.
+ *
+ *                 Together with a handshake pool (see
+ *                 \c mbedtls_ssl_conf_handshake_pool()) this enables
+ *                 "prepared contexts": call mbedtls_ssl_setup() on a batch
+ *                 of contexts ahead of time, park them, and at accept time
+ *                 only attach the socket with mbedtls_ssl_set_bio(). When a
+ *                 connection ends, mbedtls_ssl_session_reset() returns the
+ *                 context to the parked state without releasing its I/O
+ *                 buffers, so no allocation happens on the accept path.
+ *
+ * \param conf     SSL configuration to freeze; it must be fully set up
+ *                 (at least an RNG from \c mbedtls_ssl_conf_rng())
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_BAD_INPUT_DATA if
+ *                 no RNG has been configured
+ */
+int mbedtls_ssl_config_freeze( mbedtls_ssl_config *conf );
+
 /**
  * \brief          Free an SSL configuration context
  *
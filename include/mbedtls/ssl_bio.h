@@ -0,0 +1,216 @@
+/**
+ * \file ssl_bio.h
+ *
+ * \brief In-memory BIO pair for connecting two SSL contexts
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SSL_BIO_H
+#define MBEDTLS_SSL_BIO_H
+
+#include "ssl.h"
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_SSL_BIO_BUFFER_SIZE
+#define MBEDTLS_SSL_BIO_BUFFER_SIZE ( MBEDTLS_SSL_MAX_CONTENT_LEN + 1024 )
+                        /**< Default per-direction buffer, sized to hold at
+                         *   least one maximum-size record with its overhead */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MBEDTLS_SSL_BIO_ENDPOINT_A      0
+#define MBEDTLS_SSL_BIO_ENDPOINT_B      1
+
+/**
+ * \brief   One direction of the pair: a ring buffer with a single writer
+ *          and a single reader (opaque to the application)
+ *
+ *          The writer only advances \c wr and the reader only advances
+ *          \c rd; both are free-running byte counts, so the two sides can
+ *          run on different threads without locking as long as each side
+ *          has a single caller at a time.
+ */
+typedef struct
+{
+    unsigned char *buf;                 /*!< storage                      */
+    size_t size;                        /*!< storage size in bytes        */
+    volatile size_t wr;                 /*!< total bytes written          */
+    volatile size_t rd;                 /*!< total bytes read             */
+
+    void (*f_data)( void *, size_t );   /*!< called when a write brings the
+                                             readable count up across
+                                             data_lwm                     */
+    void (*f_space)( void *, size_t );  /*!< called when a read brings the
+                                             free space up across
+                                             space_lwm                    */
+    void *p_notify;                     /*!< context for the callbacks    */
+    size_t data_lwm;                    /*!< readable-bytes watermark     */
+    size_t space_lwm;                   /*!< free-space watermark         */
+}
+mbedtls_ssl_bio_ring;
+
+/**
+ * \brief   One end of the pair: what to pass to mbedtls_ssl_set_bio()
+ */
+typedef struct
+{
+    mbedtls_ssl_bio_ring *in;           /*!< ring this end reads from     */
+    mbedtls_ssl_bio_ring *out;          /*!< ring this end writes to      */
+}
+mbedtls_ssl_bio_endpoint;
+
+/**
+ * \brief   A connected pair of in-memory transport endpoints
+ *
+ *          Two SSL contexts whose BIOs are the two endpoints of a pair
+ *          exchange records entirely in memory: no sockets, no syscalls.
+ *          This is meant for test harnesses and for stacking, eg running
+ *          a TLS session over the plaintext side of an outer TLS session,
+ *          where the glue code moves bytes between the pair and the outer
+ *          context.
+ *
+ *          Each direction is a single-producer single-consumer ring, so
+ *          the two contexts may live on different threads; the watermark
+ *          callbacks can then wake the other side instead of polling.
+ */
+typedef struct
+{
+    mbedtls_ssl_bio_ring ring[2];       /*!< ring[0] carries A to B       */
+    mbedtls_ssl_bio_endpoint ep[2];     /*!< the two attachment points    */
+}
+mbedtls_ssl_bio_pair_context;
+
+/**
+ * \brief          Initialize a BIO pair (just makes it ready for
+ *                 mbedtls_ssl_bio_pair_setup() or
+ *                 mbedtls_ssl_bio_pair_free())
+ *
+ * \param ctx      BIO pair context
+ */
+void mbedtls_ssl_bio_pair_init( mbedtls_ssl_bio_pair_context *ctx );
+
+/**
+ * \brief          Allocate the two direction buffers
+ *
+ * \param ctx      BIO pair context
+ * \param bufsize  Size of each direction's buffer in bytes, or 0 for
+ *                 MBEDTLS_SSL_BIO_BUFFER_SIZE. Smaller buffers exercise
+ *                 partial-write paths; they must still hold a full record
+ *                 eventually, which mbedtls_ssl_bio_send()'s partial
+ *                 acceptance guarantees as long as the reader drains.
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_ALLOC_FAILED
+ */
+int mbedtls_ssl_bio_pair_setup( mbedtls_ssl_bio_pair_context *ctx,
+                                size_t bufsize );
+
+/**
+ * \brief          Get one end of the pair, to use as the bio context with
+ *                 mbedtls_ssl_set_bio( ssl, ep, mbedtls_ssl_bio_send,
+ *                 mbedtls_ssl_bio_recv, NULL )
+ *
+ * \param ctx      BIO pair context, already set up
+ * \param end      MBEDTLS_SSL_BIO_ENDPOINT_A or MBEDTLS_SSL_BIO_ENDPOINT_B
+ *
+ * \return         The endpoint, or NULL if ctx is not set up or end is
+ *                 out of range
+ */
+mbedtls_ssl_bio_endpoint *mbedtls_ssl_bio_pair_endpoint(
+                                mbedtls_ssl_bio_pair_context *ctx, int end );
+
+/**
+ * \brief          Set the watermark callbacks for one endpoint
+ *
+ *                 \p f_data runs when a write by the peer moves this
+ *                 endpoint's readable byte count from below \p data_lwm
+ *                 to at least \p data_lwm; \p f_space runs when a read by
+ *                 the peer moves this endpoint's free outgoing space from
+ *                 below \p space_lwm to at least \p space_lwm. Both
+ *                 receive \p p_notify and the new count.
+ *
+ * \note           The callbacks run on the peer's thread, from inside
+ *                 mbedtls_ssl_bio_send() or mbedtls_ssl_bio_recv(); they
+ *                 should only signal (eg post a semaphore), not re-enter
+ *                 the pair.
+ *
+ * \param ep       Endpoint to notify about
+ * \param data_lwm Readable-bytes threshold, 0 for 1 (any data)
+ * \param space_lwm Free-space threshold, 0 for 1 (any space)
+ * \param f_data   Data-available callback, or NULL
+ * \param f_space  Space-available callback, or NULL
+ * \param p_notify Context passed to both callbacks
+ */
+void mbedtls_ssl_bio_set_watermarks( mbedtls_ssl_bio_endpoint *ep,
+                                     size_t data_lwm, size_t space_lwm,
+                                     void (*f_data)( void *, size_t ),
+                                     void (*f_space)( void *, size_t ),
+                                     void *p_notify );
+
+/**
+ * \brief          Number of bytes an endpoint could read right now
+ */
+size_t mbedtls_ssl_bio_pending( const mbedtls_ssl_bio_endpoint *ep );
+
+/**
+ * \brief          Number of bytes an endpoint could write right now
+ */
+size_t mbedtls_ssl_bio_space( const mbedtls_ssl_bio_endpoint *ep );
+
+/**
+ * \brief          Write callback for the pair (see mbedtls_ssl_send_t)
+ *
+ *                 Accepts a partial write when the ring is nearly full;
+ *                 returns MBEDTLS_ERR_SSL_WANT_WRITE when it is full.
+ */
+int mbedtls_ssl_bio_send( void *ep, const unsigned char *buf, size_t len );
+
+/**
+ * \brief          Read callback for the pair (see mbedtls_ssl_recv_t)
+ *
+ *                 Returns MBEDTLS_ERR_SSL_WANT_READ when no data is
+ *                 buffered.
+ */
+int mbedtls_ssl_bio_recv( void *ep, unsigned char *buf, size_t len );
+
+/**
+ * \brief          Free the buffers of a BIO pair
+ *
+ *                 Must not race sends or receives on either endpoint.
+ *
+ * \param ctx      BIO pair context
+ */
+void mbedtls_ssl_bio_pair_free( mbedtls_ssl_bio_pair_context *ctx );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_bio.h */
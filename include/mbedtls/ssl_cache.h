@@ -46,6 +46,10 @@
 #define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50   /*!< Maximum entries in cache */
 #endif
 
+#if !defined(MBEDTLS_SSL_CACHE_SHARDS)
+#define MBEDTLS_SSL_CACHE_SHARDS                   16   /*!< Independently locked cache shards */
+#endif
+
 /* \} name SECTION: Module settings */
 
 #ifdef __cplusplus
@@ -53,6 +57,7 @@ extern "C" {
 #endif
 
 typedef struct mbedtls_ssl_cache_context mbedtls_ssl_cache_context;
+typedef struct mbedtls_ssl_cache_shard mbedtls_ssl_cache_shard;
 typedef struct mbedtls_ssl_cache_entry mbedtls_ssl_cache_entry;
 
 /**
@@ -67,20 +72,45 @@ struct mbedtls_ssl_cache_entry
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     mbedtls_x509_buf peer_cert;         /*!< entry peer_cert    */
 #endif
-    mbedtls_ssl_cache_entry *next;      /*!< chain pointer      */
+    mbedtls_ssl_cache_entry *next;      /*!< bucket chain pointer */
+    mbedtls_ssl_cache_entry *lru_prev;  /*!< older entry in the shard  */
+    mbedtls_ssl_cache_entry *lru_next;  /*!< newer entry in the shard  */
+};
+
+/**
+ * \brief   An independently locked part of the cache: a hash table over
+ *          session IDs, with chained buckets (allocated on first use,
+ *          sized from the configured maximum number of entries), plus
+ *          an eviction list ordered from oldest to newest entry
+ */
+struct mbedtls_ssl_cache_shard
+{
+    mbedtls_ssl_cache_entry **buckets;  /*!< hash buckets           */
+    mbedtls_ssl_cache_entry *lru_head;  /*!< oldest entry           */
+    mbedtls_ssl_cache_entry *lru_tail;  /*!< newest entry           */
+    int num_buckets;            /*!< number of buckets      */
+    int count;                  /*!< entries in this shard  */
+    size_t bytes;               /*!< memory used by entries */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_rwlock_t rwlock;  /*!< shard lock: lookups
+                                             take it shared          */
+#endif
 };
 
 /**
  * \brief Cache context
+ *
+ *        Sessions are spread over MBEDTLS_SSL_CACHE_SHARDS shards by a
+ *        hash of their ID, so that concurrent lookups only contend when
+ *        they hit the same shard.
  */
 struct mbedtls_ssl_cache_context
 {
-    mbedtls_ssl_cache_entry *chain;     /*!< start of the chain     */
+    mbedtls_ssl_cache_shard shards[MBEDTLS_SSL_CACHE_SHARDS];   /*!< cache shards */
     int timeout;                /*!< cache entry timeout    */
     int max_entries;            /*!< maximum entries        */
-#if defined(MBEDTLS_THREADING_C)
-    mbedtls_threading_mutex_t mutex;    /*!< mutex                  */
-#endif
+    size_t max_bytes;           /*!< maximum memory used by
+                                     entries, or 0 for no limit */
 };
 
 /**
@@ -125,11 +155,35 @@ void mbedtls_ssl_cache_set_timeout( mbedtls_ssl_cache_context *cache, int timeou
  * \brief          Set the cache timeout
  *                 (Default: MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES (50))
  *
+ * \note           The limit is enforced per shard, as max / \c
+ *                 MBEDTLS_SSL_CACHE_SHARDS entries each. The hash buckets
+ *                 of a shard are sized from this value when the shard
+ *                 receives its first entry, so call this before the cache
+ *                 is used.
+ *
  * \param cache    SSL cache context
  * \param max      cache entry maximum
  */
 void mbedtls_ssl_cache_set_max_entries( mbedtls_ssl_cache_context *cache, int max );
 
+/**
+ * \brief          Set the maximum memory used by cache entries
+ *                 (Default: 0, no limit)
+ *
+ *                 Entries carry a copy of the peer's certificate, whose
+ *                 size is not under our control, so a pure entry-count
+ *                 limit does not bound memory. When the budget is
+ *                 exceeded, the oldest entries are evicted.
+ *
+ * \note           Like the entry limit, the budget is enforced per shard,
+ *                 as max / \c MBEDTLS_SSL_CACHE_SHARDS bytes each.
+ *
+ * \param cache    SSL cache context
+ * \param max      maximum number of bytes used by cache entries,
+ *                 or 0 for no limit
+ */
+void mbedtls_ssl_cache_set_max_bytes( mbedtls_ssl_cache_context *cache, size_t max );
+
 /**
  * \brief          Free referenced items in a cache context and clear memory
  *
@@ -0,0 +1,194 @@
+/**
+ * \file ssl_cache_shm.h
+ *
+ * \brief SSL session cache over POSIX shared memory
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SSL_CACHE_SHM_H
+#define MBEDTLS_SSL_CACHE_SHM_H
+
+#include "ssl.h"
+
+#include <stdint.h>
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT)
+#define MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT   86400   /*!< 1 day  */
+#endif
+
+#if !defined(MBEDTLS_SSL_CACHE_SHM_DEFAULT_ENTRIES)
+#define MBEDTLS_SSL_CACHE_SHM_DEFAULT_ENTRIES     512   /*!< Slots in the shared table */
+#endif
+
+#if !defined(MBEDTLS_SSL_CACHE_SHM_CERT_LEN)
+#define MBEDTLS_SSL_CACHE_SHM_CERT_LEN           1536   /*!< Bytes reserved per slot for the peer certificate */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mbedtls_ssl_cache_shm_entry mbedtls_ssl_cache_shm_entry;
+typedef struct mbedtls_ssl_cache_shm_table mbedtls_ssl_cache_shm_table;
+typedef struct mbedtls_ssl_cache_shm_context mbedtls_ssl_cache_shm_context;
+
+/**
+ * \brief   One slot of the shared table. The table is direct-mapped:
+ *          a session lives in the slot picked by a hash of its ID and
+ *          a colliding session simply overwrites it.
+ *
+ *          Each slot is protected by a seqlock: the writer makes \c seq
+ *          odd, updates the slot, then makes it even again; a reader
+ *          retries if \c seq was odd or changed while it copied the
+ *          slot. Two workers storing into the same slot at the same
+ *          time can still interleave their writes, so the slot also
+ *          carries a checksum of its content and a torn slot is simply
+ *          a cache miss, never a bogus session.
+ */
+struct mbedtls_ssl_cache_shm_entry
+{
+    volatile uint32_t seq;      /*!< seqlock, odd while being written */
+    uint32_t checksum;          /*!< FNV-1a over timestamp..cert      */
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t timestamp;           /*!< entry timestamp                  */
+#endif
+    mbedtls_ssl_session session;        /*!< entry session, pointer
+                                             members always NULL      */
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    size_t cert_len;            /*!< peer certificate length, or 0    */
+    unsigned char cert[MBEDTLS_SSL_CACHE_SHM_CERT_LEN]; /*!< raw DER  */
+#endif
+};
+
+/**
+ * \brief   Header of the shared mapping, followed by the slots
+ */
+struct mbedtls_ssl_cache_shm_table
+{
+    uint32_t num_entries;       /*!< number of slots                  */
+    volatile uint32_t magic;    /*!< set last by the creator, so other
+                                     processes attaching to a named
+                                     segment wait for a complete table */
+    mbedtls_ssl_cache_shm_entry entries[1];     /*!< the slots        */
+};
+
+/**
+ * \brief Cache context, process-local. The table it points to lives in
+ *        shared memory: either an anonymous mapping inherited across
+ *        fork(), or a named POSIX shared memory object.
+ */
+struct mbedtls_ssl_cache_shm_context
+{
+    mbedtls_ssl_cache_shm_table *table; /*!< the shared table         */
+    size_t map_len;             /*!< length of the mapping            */
+    int timeout;                /*!< cache entry timeout              */
+    int fd;                     /*!< shm object fd, or -1 if anonymous */
+    int created;                /*!< did we create the shm object?    */
+    char *name;                 /*!< shm object name, or NULL         */
+};
+
+/**
+ * \brief          Initialize an SSL shared-memory cache context
+ *
+ * \param cache    SSL cache context
+ */
+void mbedtls_ssl_cache_shm_init( mbedtls_ssl_cache_shm_context *cache );
+
+/**
+ * \brief          Create or attach to the shared table
+ *
+ *                 With \p name == NULL the table is an anonymous shared
+ *                 mapping: call this before fork() and every worker
+ *                 shares it, which is all a pre-forking server like
+ *                 ssl_fork_server needs. With a name (leading '/', see
+ *                 shm_open()) unrelated processes can attach to the
+ *                 same table; whoever creates the object sizes and
+ *                 initializes it, later callers adopt its slot count.
+ *
+ * \param cache    SSL cache context
+ * \param name     POSIX shared memory object name, or NULL for an
+ *                 anonymous fork-shared mapping
+ * \param num_entries  slots in the table, or 0 for
+ *                 MBEDTLS_SSL_CACHE_SHM_DEFAULT_ENTRIES
+ *
+ * \return         0 if successful, or 1 on error
+ */
+int mbedtls_ssl_cache_shm_setup( mbedtls_ssl_cache_shm_context *cache,
+                                 const char *name,
+                                 uint32_t num_entries );
+
+/**
+ * \brief          Cache get callback implementation
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ * \param data     SSL cache context
+ * \param session  session to retrieve entry for
+ *
+ * \return         0 if successful, or 1 on miss
+ */
+int mbedtls_ssl_cache_shm_get( void *data, mbedtls_ssl_session *session );
+
+/**
+ * \brief          Cache set callback implementation
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ * \param data     SSL cache context
+ * \param session  session to store entry for
+ *
+ * \return         0 if successful, or 1 on error
+ */
+int mbedtls_ssl_cache_shm_set( void *data, const mbedtls_ssl_session *session );
+
+#if defined(MBEDTLS_HAVE_TIME)
+/**
+ * \brief          Set the cache timeout
+ *                 (Default: MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT (1 day))
+ *
+ *                 A timeout of 0 indicates no timeout.
+ *
+ * \param cache    SSL cache context
+ * \param timeout  cache entry timeout in seconds
+ */
+void mbedtls_ssl_cache_shm_set_timeout( mbedtls_ssl_cache_shm_context *cache,
+                                        int timeout );
+#endif /* MBEDTLS_HAVE_TIME */
+
+/**
+ * \brief          Unmap the table and free referenced resources.
+ *                 The creator of a named object also unlinks it.
+ *
+ * \param cache    SSL cache context
+ */
+void mbedtls_ssl_cache_shm_free( mbedtls_ssl_cache_shm_context *cache );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_cache_shm.h */
@@ -26,6 +26,14 @@
 
 #include "ssl.h"
 
+#if defined(MBEDTLS_SHA256_C)
+#include "sha256.h"
+#elif defined(MBEDTLS_SHA512_C)
+#include "sha512.h"
+#else
+#include "sha1.h"
+#endif
+
 #if defined(MBEDTLS_THREADING_C)
 #include "threading.h"
 #endif
@@ -41,24 +49,56 @@
 #define MBEDTLS_SSL_COOKIE_TIMEOUT     60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
 #endif
 
+#ifndef MBEDTLS_SSL_COOKIE_REPUTATION_TIMEOUT
+#define MBEDTLS_SSL_COOKIE_REPUTATION_TIMEOUT 300 /**< Default lifetime of a source's good reputation, same unit as the cookie timeout */
+#endif
+
 /* \} name SECTION: Module settings */
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * \brief          Entry of the source reputation table: a keyed tag of the
+ *                 client ID and when that client last passed a cookie check
+ */
+typedef struct
+{
+    unsigned long last_seen;            /*!< time of last verified cookie   */
+    unsigned char tag[16];              /*!< keyed tag of the client ID     */
+} mbedtls_ssl_cookie_rep_entry;
+
 /**
  * \brief          Context for the default cookie functions.
  */
 typedef struct
 {
-    mbedtls_md_context_t    hmac_ctx;   /*!< context for the HMAC portion   */
+    /* Digest states with the HMAC key pads already absorbed; they are only
+     * written by mbedtls_ssl_cookie_setup() and copied by value afterwards,
+     * so cookies can be written and checked without serializing threads */
+#if defined(MBEDTLS_SHA256_C)
+    mbedtls_sha256_context  ipad_ctx;   /*!< pre-keyed inner digest state   */
+    mbedtls_sha256_context  opad_ctx;   /*!< pre-keyed outer digest state   */
+#elif defined(MBEDTLS_SHA512_C)
+    mbedtls_sha512_context  ipad_ctx;   /*!< pre-keyed inner digest state   */
+    mbedtls_sha512_context  opad_ctx;   /*!< pre-keyed outer digest state   */
+#else
+    mbedtls_sha1_context    ipad_ctx;   /*!< pre-keyed inner digest state   */
+    mbedtls_sha1_context    opad_ctx;   /*!< pre-keyed outer digest state   */
+#endif
 #if !defined(MBEDTLS_HAVE_TIME)
     unsigned long   serial;     /*!< serial number for expiration   */
 #endif
     unsigned long   timeout;    /*!< timeout delay, in seconds if HAVE_TIME,
                                      or in number of tickets issued */
 
+    mbedtls_ssl_cookie_rep_entry *rep_table; /*!< source reputation table,
+                                     or NULL when the bypass is disabled */
+    size_t          rep_entries;/*!< number of slots in rep_table       */
+    unsigned long   rep_timeout;/*!< reputation lifetime, same unit as
+                                     the cookie timeout                 */
+
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_threading_mutex_t mutex;
 #endif
@@ -87,6 +127,40 @@ int mbedtls_ssl_cookie_setup( mbedtls_ssl_cookie_ctx *ctx,
  */
 void mbedtls_ssl_cookie_set_timeout( mbedtls_ssl_cookie_ctx *ctx, unsigned long delay );
 
+/**
+ * \brief          Enable the cookie bypass for recently-verified sources
+ *                 (Default: disabled)
+ *
+ *                 With a reputation table set, a client that passed a
+ *                 cookie check within \p timeout may open its next
+ *                 handshake without the HelloVerifyRequest round trip:
+ *                 an empty cookie from a remembered client ID passes the
+ *                 check directly. Unknown or stale sources still go
+ *                 through the full cookie exchange, so address spoofing
+ *                 protection is kept where it matters.
+ *
+ *                 The table is bounded: each source maps to one slot and
+ *                 a newly verified source evicts the previous holder, so
+ *                 under churn or flood the bypass degrades back to the
+ *                 normal exchange rather than growing memory.
+ *
+ * \note           Client IDs are stored as tags keyed with the cookie
+ *                 key, so table entries cannot be precomputed for
+ *                 chosen source addresses.
+ *
+ * \param ctx      Cookie context, already set up
+ * \param entries  Number of slots, or 0 to disable and free the table
+ * \param timeout  Reputation lifetime, in seconds if HAVE_TIME, or in
+ *                 number of cookies issued
+ *                 (see MBEDTLS_SSL_COOKIE_REPUTATION_TIMEOUT)
+ *
+ * \return         0 on success, MBEDTLS_ERR_SSL_ALLOC_FAILED on memory
+ *                 allocation failure
+ */
+int mbedtls_ssl_cookie_set_reputation( mbedtls_ssl_cookie_ctx *ctx,
+                                       size_t entries,
+                                       unsigned long timeout );
+
 /**
  * \brief          Free cookie context
  */
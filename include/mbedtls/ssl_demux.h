@@ -0,0 +1,198 @@
+/**
+ * \file ssl_demux.h
+ *
+ * \brief Peer-address demultiplexer for DTLS servers
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SSL_DEMUX_H
+#define MBEDTLS_SSL_DEMUX_H
+
+#include "ssl.h"
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_SSL_DEMUX_DEFAULT_BUCKETS
+#define MBEDTLS_SSL_DEMUX_DEFAULT_BUCKETS      256  /**< Hash buckets, should be a power of two */
+#endif
+
+#ifndef MBEDTLS_SSL_DEMUX_DEFAULT_MAX_ENTRIES
+#define MBEDTLS_SSL_DEMUX_DEFAULT_MAX_ENTRIES 1024  /**< Connections tracked before LRU eviction */
+#endif
+
+#ifndef MBEDTLS_SSL_DEMUX_MAX_ID_LEN
+#define MBEDTLS_SSL_DEMUX_MAX_ID_LEN            18  /**< Room for an IPv6 address plus a port */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   One tracked connection (opaque to the application)
+ *
+ *          The peer id is stored inline so that a lookup touches a single
+ *          allocation per visited entry.
+ */
+typedef struct mbedtls_ssl_demux_entry
+{
+    unsigned char cli_id[MBEDTLS_SSL_DEMUX_MAX_ID_LEN]; /*!< peer id      */
+    size_t cli_id_len;                  /*!< length of the peer id        */
+    mbedtls_ssl_context *ssl;           /*!< connection for this peer     */
+    struct mbedtls_ssl_demux_entry *chain;    /*!< next in hash bucket    */
+    struct mbedtls_ssl_demux_entry *lru_prev; /*!< more recently used     */
+    struct mbedtls_ssl_demux_entry *lru_next; /*!< less recently used     */
+}
+mbedtls_ssl_demux_entry;
+
+/**
+ * \brief   Context mapping peer transport addresses to connections
+ *
+ *          A DTLS server reading from a single unconnected socket has to
+ *          route each datagram to the mbedtls_ssl_context of its sender.
+ *          This table does that lookup in O(1) from the client id
+ *          returned by mbedtls_net_accept() (or any other transport-level
+ *          peer identifier, eg address plus port), and evicts the least
+ *          recently used connection when full so idle peers don't pin
+ *          server memory.
+ *
+ *          The table is meant to be driven from a single event loop and
+ *          performs no locking of its own.
+ */
+typedef struct
+{
+    mbedtls_ssl_demux_entry **buckets;  /*!< hash table                   */
+    size_t bucket_count;                /*!< number of buckets            */
+    size_t max_entries;                 /*!< entries before LRU eviction  */
+    size_t count;                       /*!< current number of entries    */
+    mbedtls_ssl_demux_entry *lru_head;  /*!< most recently used entry     */
+    mbedtls_ssl_demux_entry *lru_tail;  /*!< least recently used entry    */
+}
+mbedtls_ssl_demux_context;
+
+/**
+ * \brief          Initialize a demux context (just makes it ready for
+ *                 mbedtls_ssl_demux_setup() or mbedtls_ssl_demux_free())
+ *
+ * \param demux    Demux context
+ */
+void mbedtls_ssl_demux_init( mbedtls_ssl_demux_context *demux );
+
+/**
+ * \brief          Allocate the hash table
+ *
+ * \param demux    Demux context
+ * \param buckets  Number of hash buckets, or 0 for
+ *                 MBEDTLS_SSL_DEMUX_DEFAULT_BUCKETS. Sizing this close to
+ *                 the expected connection count keeps chains short.
+ * \param max_entries  Number of connections tracked before the least
+ *                 recently used one is evicted, or 0 for
+ *                 MBEDTLS_SSL_DEMUX_DEFAULT_MAX_ENTRIES
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_ALLOC_FAILED
+ */
+int mbedtls_ssl_demux_setup( mbedtls_ssl_demux_context *demux,
+                             size_t buckets, size_t max_entries );
+
+/**
+ * \brief          Track a new connection under the given peer id
+ *
+ * \param demux    Demux context
+ * \param cli_id   Transport-level id of the peer (at most
+ *                 MBEDTLS_SSL_DEMUX_MAX_ID_LEN bytes)
+ * \param cli_id_len  Length of the peer id
+ * \param ssl      Connection to associate with the peer
+ * \param evicted  On return, the connection that was evicted to make
+ *                 room, or NULL if none was. The caller keeps ownership
+ *                 of evicted connections and should close and free them.
+ *
+ * \return         0 if successful, MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the
+ *                 id is too long or already present, or
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED on memory failure
+ */
+int mbedtls_ssl_demux_add( mbedtls_ssl_demux_context *demux,
+                           const unsigned char *cli_id, size_t cli_id_len,
+                           mbedtls_ssl_context *ssl,
+                           mbedtls_ssl_context **evicted );
+
+/**
+ * \brief          Look up the connection for a peer id
+ *
+ *                 A successful lookup marks the connection as most
+ *                 recently used.
+ *
+ * \param demux    Demux context
+ * \param cli_id   Transport-level id of the peer
+ * \param cli_id_len  Length of the peer id
+ *
+ * \return         The connection for this peer, or NULL if unknown
+ */
+mbedtls_ssl_context *mbedtls_ssl_demux_find( mbedtls_ssl_demux_context *demux,
+                                             const unsigned char *cli_id,
+                                             size_t cli_id_len );
+
+/**
+ * \brief          Stop tracking a peer (eg after close_notify), if known
+ *
+ *                 The connection itself is not closed or freed: it
+ *                 belongs to the application.
+ *
+ * \param demux    Demux context
+ * \param cli_id   Transport-level id of the peer
+ * \param cli_id_len  Length of the peer id
+ *
+ * \return         0 if the peer was found,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA otherwise
+ */
+int mbedtls_ssl_demux_remove( mbedtls_ssl_demux_context *demux,
+                              const unsigned char *cli_id,
+                              size_t cli_id_len );
+
+/**
+ * \brief          Current number of tracked connections, for load metrics
+ *
+ * \param demux    Demux context
+ *
+ * \return         The number of entries in the table
+ */
+size_t mbedtls_ssl_demux_len( const mbedtls_ssl_demux_context *demux );
+
+/**
+ * \brief          Free the table and clear memory
+ *
+ *                 Tracked connections are not closed or freed: they
+ *                 belong to the application.
+ *
+ * \param demux    Demux context
+ */
+void mbedtls_ssl_demux_free( mbedtls_ssl_demux_context *demux );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_demux.h */
@@ -25,6 +25,7 @@
 #define MBEDTLS_SSL_INTERNAL_H
 
 #include "ssl.h"
+#include "constant_time.h"
 
 #if defined(MBEDTLS_MD5_C)
 #include "md5.h"
@@ -42,6 +43,10 @@
 #include "sha512.h"
 #endif
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS) && defined(MBEDTLS_TIMING_C)
+#include "timing.h"
+#endif
+
 #if ( defined(__ARMCC_VERSION) || defined(_MSC_VER) ) && !defined(inline)
 #define inline __inline
 #endif
@@ -102,6 +107,30 @@
 #define MBEDTLS_SSL_RETRANS_WAITING         2
 #define MBEDTLS_SSL_RETRANS_FINISHED        3
 
+/*
+ * Number of future DTLS handshake messages that can be held while waiting
+ * for the expected sequence number
+ */
+#define MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS    4
+
+/*
+ * Flags of the per-version ciphersuite gates resolved at configuration
+ * time (mbedtls_ssl_config.ciphersuite_gate): ACCEPT means the suite
+ * passes every configuration-static acceptance check at that version,
+ * USES_EC records the one predicate whose other half (the common-curve
+ * mask) is only known per handshake.
+ */
+#define MBEDTLS_SSL_SUITE_GATE_VALID        0x01
+#define MBEDTLS_SSL_SUITE_GATE_ACCEPT       0x02
+#define MBEDTLS_SSL_SUITE_GATE_USES_EC      0x04
+
+/*
+ * Outstanding asynchronous private key operation, if any
+ */
+#define MBEDTLS_SSL_ASYNC_OP_NONE           0
+#define MBEDTLS_SSL_ASYNC_OP_SIGN           1
+#define MBEDTLS_SSL_ASYNC_OP_DECRYPT        2
+
 /*
  * Allow extra bytes for record, authentication and encryption overhead:
  * counter (8) + header (5) + IV(16) + MAC (16-48) + padding (0-256)
@@ -141,6 +170,12 @@
                         + MBEDTLS_SSL_PADDING_ADD                   \
                         )
 
+/* Non-content bytes included in MBEDTLS_SSL_BUFFER_LEN, also needed on top
+ * of any run-time configured content length (see
+ * mbedtls_ssl_conf_buffer_sizes()) */
+#define MBEDTLS_SSL_BUFFER_OVERHEAD ( MBEDTLS_SSL_BUFFER_LEN        \
+                        - MBEDTLS_SSL_MAX_CONTENT_LEN )
+
 /*
  * TLS extension flags (for extensions with outgoing ServerHello content
  * that need it (e.g. for RENEGOTIATION_INFO the server already knows because
@@ -170,7 +205,11 @@ struct mbedtls_ssl_handshake_params
     mbedtls_ecdh_context ecdh_ctx;              /*!<  ECDH key exchange       */
 #endif
 #if defined(MBEDTLS_ECDH_C) || defined(MBEDTLS_ECDSA_C)
-    const mbedtls_ecp_curve_info **curves;      /*!<  Supported elliptic curves */
+    uint32_t curves_mask;               /*!< curves offered by the client and
+                                             acceptable for us, as a bitmask
+                                             of 1 << MBEDTLS_ECP_DP_XXX     */
+    unsigned char curves_parsed;        /*!< supported-curves extension
+                                             already seen?                  */
 #endif
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED)
     unsigned char *psk;                 /*!<  PSK from the callback         */
@@ -194,10 +233,28 @@ struct mbedtls_ssl_handshake_params
     unsigned char verify_cookie_len;    /*!<  Cli: cookie length
                                               Srv: flag for sending a cookie */
 
-    unsigned char *hs_msg;              /*!<  Reassembled handshake message  */
+    unsigned char *hs_msg;              /*!<  Reassembled handshake message,
+                                              aliases hs_arena while a
+                                              reassembly is in progress    */
+    unsigned char *hs_arena;            /*!<  Reusable reassembly buffer
+                                              (message plus fragment
+                                              bitmap), kept across the
+                                              messages of the handshake    */
+    size_t hs_arena_len;                /*!<  size of hs_arena             */
+
+    unsigned char *future_msg[MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS];
+                                        /*!<  Hold queue for complete handshake
+                                              messages received ahead of
+                                              sequence, indexed by
+                                              message_seq modulo the queue
+                                              size                          */
+    size_t future_msg_len[MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS];
+                                        /*!<  Lengths of the held messages   */
 
     uint32_t retransmit_timeout;        /*!<  Current value of timeout       */
     unsigned char retransmit_state;     /*!<  Retransmission state           */
+    unsigned char out_frag;             /*!<  Currently sending the fragments
+                                              of a handshake message         */
     mbedtls_ssl_flight_item *flight;            /*!<  Current outgoing flight        */
     mbedtls_ssl_flight_item *cur_msg;           /*!<  Current message in flight      */
     unsigned int in_flight_start_seq;   /*!<  Minimum message sequence in the
@@ -206,6 +263,18 @@ struct mbedtls_ssl_handshake_params
                                               resending messages             */
     unsigned char alt_out_ctr[8];       /*!<  Alternative record epoch/counter
                                               for resending messages         */
+#if defined(MBEDTLS_TIMING_C)
+    struct mbedtls_timing_hr_time flight_sent_time;
+                                        /*!<  Time the last outgoing flight
+                                              was completed                  */
+    uint32_t rtt_srtt;                  /*!<  Smoothed RTT estimate (ms),
+                                              0 if no sample taken yet       */
+    uint32_t rtt_var;                   /*!<  RTT variation (ms)             */
+    unsigned char rtt_sample_open;      /*!<  The current flight is timed and
+                                              was not retransmitted, so the
+                                              reply yields a valid RTT sample
+                                              (Karn's algorithm)             */
+#endif
 #endif
 
     /*
@@ -228,7 +297,8 @@ struct mbedtls_ssl_handshake_params
     void (*update_checksum)(mbedtls_ssl_context *, const unsigned char *, size_t);
     void (*calc_verify)(mbedtls_ssl_context *, unsigned char *);
     void (*calc_finished)(mbedtls_ssl_context *, unsigned char *, int);
-    int  (*tls_prf)(const unsigned char *, size_t, const char *,
+    int  (*tls_prf)(mbedtls_ssl_session *,
+                    const unsigned char *, size_t, const char *,
                     const unsigned char *, size_t,
                     unsigned char *, size_t);
 
@@ -249,6 +319,17 @@ struct mbedtls_ssl_handshake_params
 #if defined(MBEDTLS_SSL_EXTENDED_MASTER_SECRET)
     int extended_ms;                    /*!< use Extended Master Secret? */
 #endif
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+    unsigned char async_in_progress;    /*!< outstanding asynchronous
+                                             private key operation, one of
+                                             MBEDTLS_SSL_ASYNC_OP_XXX     */
+    void *user_async_ctx;               /*!< per-operation context, owned
+                                             by the async callbacks       */
+    size_t async_ske_prefix_len;        /*!< ServerKeyExchange bytes
+                                             written before the signature */
+    size_t async_pms_offset;            /*!< offset in premaster of the
+                                             secret being decrypted       */
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
 };
 
 /*
@@ -271,6 +352,12 @@ struct mbedtls_ssl_transform
     unsigned char iv_enc[16];           /*!<  IV (encryption)         */
     unsigned char iv_dec[16];           /*!<  IV (decryption)         */
 
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+    /* Raw traffic keys, kept for mbedtls_ssl_get_record_keys() */
+    unsigned char key_enc[32];          /*!<  raw key (encryption)    */
+    unsigned char key_dec[32];          /*!<  raw key (decryption)    */
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_SSL3)
     /* Needed only for SSL v3.0 secret */
     unsigned char mac_enc[20];          /*!<  SSL v3.0 secret (enc)   */
@@ -283,6 +370,13 @@ struct mbedtls_ssl_transform
     mbedtls_cipher_context_t cipher_ctx_enc;    /*!<  encryption context      */
     mbedtls_cipher_context_t cipher_ctx_dec;    /*!<  decryption context      */
 
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+    /* Record protection functions matching the ciphersuite family,
+     * bound once by mbedtls_ssl_derive_keys() */
+    int (*f_encrypt)( mbedtls_ssl_context *ssl );   /*!<  record protection   */
+    int (*f_decrypt)( mbedtls_ssl_context *ssl );   /*!<  record deprotection */
+#endif
+
     /*
      * Session specific compression layer
      */
@@ -300,10 +394,31 @@ struct mbedtls_ssl_key_cert
 {
     mbedtls_x509_crt *cert;                 /*!< cert                       */
     mbedtls_pk_context *key;                /*!< private key                */
+    unsigned char *cert_wire;               /*!< serialized Certificate
+                                                 message, or NULL           */
+    size_t cert_wire_len;                   /*!< length of cert_wire        */
     mbedtls_ssl_key_cert *next;             /*!< next key/cert pair         */
 };
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+/*
+ * Entry of the built-in SNI table: maps one DNS name taken from a
+ * certificate to that certificate/key pair. Names are stored lowercase;
+ * for wildcard names the leading "*." is stripped and the wildcard flag
+ * set, so that lookups hash the requested name minus its first label.
+ */
+struct mbedtls_ssl_sni_entry
+{
+    char *name;                             /*!< lowercase DNS name         */
+    size_t name_len;                        /*!< length of name             */
+    unsigned char wildcard;                 /*!< name was a "*." pattern    */
+    mbedtls_x509_crt *cert;                 /*!< cert                       */
+    mbedtls_pk_context *key;                /*!< private key                */
+    mbedtls_ssl_sni_entry *next;            /*!< next entry in this bucket  */
+};
+#endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 /*
  * List of handshake messages kept around for resending
@@ -334,6 +449,17 @@ void mbedtls_ssl_transform_free( mbedtls_ssl_transform *transform );
  */
 void mbedtls_ssl_handshake_free( mbedtls_ssl_handshake_params *handshake );
 
+/**
+ * \brief           Deep-copy an SSL session, freeing the destination first
+ *
+ * \param dst       Destination session (freed then overwritten)
+ * \param src       Source session
+ *
+ * \return          0 if successful, or MBEDTLS_ERR_SSL_ALLOC_FAILED
+ */
+int mbedtls_ssl_session_copy( mbedtls_ssl_session *dst,
+                              const mbedtls_ssl_session *src );
+
 int mbedtls_ssl_handshake_client_step( mbedtls_ssl_context *ssl );
 int mbedtls_ssl_handshake_server_step( mbedtls_ssl_context *ssl );
 void mbedtls_ssl_handshake_wrapup( mbedtls_ssl_context *ssl );
@@ -407,6 +533,15 @@ static inline mbedtls_x509_crt *mbedtls_ssl_own_cert( mbedtls_ssl_context *ssl )
     return( key_cert == NULL ? NULL : key_cert->cert );
 }
 
+static inline mbedtls_ssl_key_cert *mbedtls_ssl_own_key_cert(
+                                                mbedtls_ssl_context *ssl )
+{
+    if( ssl->handshake != NULL && ssl->handshake->key_cert != NULL )
+        return( ssl->handshake->key_cert );
+
+    return( ssl->conf->key_cert );
+}
+
 /*
  * Check usage of a certificate wrt extensions:
  * keyUsage, extendedKeyUsage (later), and nSCertType (later).
@@ -422,6 +557,18 @@ int mbedtls_ssl_check_cert_usage( const mbedtls_x509_crt *cert,
                           uint32_t *flags );
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+/*
+ * Look up the requested server name in the built-in SNI table and offer
+ * the matching certificates with mbedtls_ssl_set_hs_own_cert().
+ *
+ * Return 0 on success, whether or not a name matched (on a miss the main
+ * certificate list stays in effect), or MBEDTLS_ERR_SSL_ALLOC_FAILED.
+ */
+int mbedtls_ssl_sni_select_cert( mbedtls_ssl_context *ssl,
+                                 const unsigned char *name, size_t name_len );
+#endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
+
 void mbedtls_ssl_write_version( int major, int minor, int transport,
                         unsigned char ver[2] );
 void mbedtls_ssl_read_version( int *major, int *minor, int transport,
@@ -464,15 +611,7 @@ void mbedtls_ssl_dtls_replay_update( mbedtls_ssl_context *ssl );
 /* constant-time buffer comparison */
 static inline int mbedtls_ssl_safer_memcmp( const void *a, const void *b, size_t n )
 {
-    size_t i;
-    const unsigned char *A = (const unsigned char *) a;
-    const unsigned char *B = (const unsigned char *) b;
-    unsigned char diff = 0;
-
-    for( i = 0; i < n; i++ )
-        diff |= A[i] ^ B[i];
-
-    return( diff );
+    return( mbedtls_ct_memcmp( a, b, n ) );
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,178 @@
+/**
+ * \file ssl_psk_store.h
+ *
+ * \brief SSL PSK identity store
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SSL_PSK_STORE_H
+#define MBEDTLS_SSL_PSK_STORE_H
+
+#include "ssl.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "threading.h"
+#endif
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_SSL_PSK_STORE_DEFAULT_CAPACITY)
+#define MBEDTLS_SSL_PSK_STORE_DEFAULT_CAPACITY   1024   /*!< Identities the store can hold */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mbedtls_ssl_psk_store_context mbedtls_ssl_psk_store_context;
+typedef struct mbedtls_ssl_psk_store_entry mbedtls_ssl_psk_store_entry;
+
+/**
+ * \brief   One slot of the identity table. A free slot has a NULL
+ *          identity pointer; a writer fills in all the other fields
+ *          first and publishes the entry by storing the pointer last,
+ *          so that a reader seeing a non-NULL identity sees a complete
+ *          entry.
+ */
+struct mbedtls_ssl_psk_store_entry
+{
+    unsigned char *identity;    /*!< identity bytes, NULL if free */
+    size_t identity_len;        /*!< length of identity           */
+    unsigned char *psk;         /*!< pre-shared key               */
+    size_t psk_len;             /*!< length of psk                */
+    unsigned int hash;          /*!< hash of the identity         */
+};
+
+/**
+ * \brief PSK store context
+ *
+ *        An open-addressing hash table over identity bytes, kept at
+ *        most half full so that linear probing stays short. Slots are
+ *        never moved or reclaimed, which is what makes lock-free
+ *        lookups safe: the mutex only serializes writers.
+ */
+struct mbedtls_ssl_psk_store_context
+{
+    mbedtls_ssl_psk_store_entry *table; /*!< slot array             */
+    size_t num_slots;           /*!< size of table, power of two    */
+    size_t used;                /*!< occupied slots                 */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< writer lock            */
+#endif
+};
+
+/**
+ * \brief          Initialize a PSK store context
+ *
+ * \param store    PSK store context
+ */
+void mbedtls_ssl_psk_store_init( mbedtls_ssl_psk_store_context *store );
+
+/**
+ * \brief          Allocate the identity table
+ *
+ * \param store    PSK store context
+ * \param capacity Number of identities the store must be able to hold,
+ *                 or 0 for MBEDTLS_SSL_PSK_STORE_DEFAULT_CAPACITY.
+ *                 The table is sized to twice this, rounded up to a
+ *                 power of two, and cannot grow later.
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_ALLOC_FAILED
+ */
+int mbedtls_ssl_psk_store_setup( mbedtls_ssl_psk_store_context *store,
+                                 size_t capacity );
+
+/**
+ * \brief          Add an identity and its key to the store, or replace
+ *                 the key of an identity that is already present
+ *
+ *                 Insertions may run concurrently with handshakes.
+ *                 Replacing the key of an existing identity must not
+ *                 race a handshake that is using that same identity.
+ *
+ * \param store    PSK store context
+ * \param identity PSK identity (arbitrary bytes, copied)
+ * \param identity_len  length of identity, must be > 0
+ * \param psk      pre-shared key (copied)
+ * \param psk_len  length of psk, must be > 0
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_SSL_BAD_INPUT_DATA if an argument is
+ *                 empty or the store is full, or
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED
+ */
+int mbedtls_ssl_psk_store_set( mbedtls_ssl_psk_store_context *store,
+                               const unsigned char *identity,
+                               size_t identity_len,
+                               const unsigned char *psk, size_t psk_len );
+
+/**
+ * \brief          Look an identity up and set the handshake PSK on a
+ *                 hit (a mbedtls_ssl_conf_psk_cb() compatible callback;
+ *                 normally reached through mbedtls_ssl_conf_psk_store()
+ *                 rather than called directly)
+ *
+ *                 Takes no lock. The identity on the selected slot is
+ *                 compared in constant time so that the timing does not
+ *                 tell a probing client how close its guess was.
+ *
+ * \param data     PSK store context (opaque pointer)
+ * \param ssl      SSL context doing the handshake
+ * \param identity identity received from the client
+ * \param identity_len  length of identity
+ *
+ * \return         0 if the identity was found,
+ *                 MBEDTLS_ERR_SSL_UNKNOWN_IDENTITY otherwise
+ */
+int mbedtls_ssl_psk_store_get( void *data, mbedtls_ssl_context *ssl,
+                               const unsigned char *identity,
+                               size_t identity_len );
+
+/**
+ * \brief          Use a PSK store for looking up identities on a
+ *                 server context (sets the PSK callback of \p conf)
+ *
+ * \param conf     SSL configuration
+ * \param store    PSK store context
+ */
+void mbedtls_ssl_conf_psk_store( mbedtls_ssl_config *conf,
+                                 mbedtls_ssl_psk_store_context *store );
+
+/**
+ * \brief          Free referenced items in a PSK store context and
+ *                 clear memory. The keys are zeroized before the
+ *                 memory is released.
+ *
+ * \param store    PSK store context
+ */
+void mbedtls_ssl_psk_store_free( mbedtls_ssl_psk_store_context *store );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_psk_store.h */
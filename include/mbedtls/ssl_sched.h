@@ -0,0 +1,191 @@
+/**
+ * \file ssl_sched.h
+ *
+ * \brief Round-robin scheduler for concurrent SSL handshakes
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_SSL_SCHED_H
+#define MBEDTLS_SSL_SCHED_H
+
+#include "ssl.h"
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_SSL_SCHED_DEFAULT_BUDGET
+#define MBEDTLS_SSL_SCHED_DEFAULT_BUDGET    1   /**< Handshake steps a connection may run per slice */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   One queued handshake (opaque to the application)
+ */
+typedef struct mbedtls_ssl_sched_item
+{
+    mbedtls_ssl_context *ssl;           /*!< connection being handshaken    */
+    struct mbedtls_ssl_sched_item *next;
+}
+mbedtls_ssl_sched_item;
+
+/**
+ * \brief   Context for scheduling many in-flight handshakes
+ *
+ *          When a large number of clients (re)connect at once, running
+ *          each mbedtls_ssl_handshake() to completion inline serves the
+ *          connections in arrival order and starves the rest. This
+ *          scheduler instead round-robins the queued handshakes, giving
+ *          each a bounded budget of handshake steps per slice, so an
+ *          accept storm degrades everyone's latency gracefully.
+ *
+ *          The scheduler is meant to be driven from a single event loop
+ *          and performs no locking of its own.
+ */
+typedef struct
+{
+    mbedtls_ssl_sched_item *queue;      /*!< head of the handshake queue    */
+    mbedtls_ssl_sched_item *cur;        /*!< round-robin position           */
+    size_t queue_len;                   /*!< current queue depth            */
+    int budget;                         /*!< handshake steps per slice      */
+
+    /** Optional callback invoked when a handshake leaves the queue        */
+    void (*f_done)( void *, mbedtls_ssl_context *, int );
+    void *p_done;                       /*!< context for the done callback  */
+}
+mbedtls_ssl_sched_context;
+
+/**
+ * \brief          Initialize a scheduler context (just makes it ready for
+ *                 mbedtls_ssl_sched_add() or mbedtls_ssl_sched_free())
+ *
+ * \param sched    Scheduler context
+ */
+void mbedtls_ssl_sched_init( mbedtls_ssl_sched_context *sched );
+
+/**
+ * \brief          Set the number of handshake steps a connection may run
+ *                 each time the round-robin reaches it
+ *                 (default: MBEDTLS_SSL_SCHED_DEFAULT_BUDGET)
+ *
+ *                 With MBEDTLS_ECP_RESTARTABLE enabled, combine this with
+ *                 mbedtls_ecp_set_max_ops() to also bound the time spent
+ *                 inside a single step on ECC arithmetic.
+ *
+ * \param sched    Scheduler context
+ * \param budget   Maximum steps per slice, must be at least 1
+ */
+void mbedtls_ssl_sched_set_budget( mbedtls_ssl_sched_context *sched,
+                                   int budget );
+
+/**
+ * \brief          Set an optional callback invoked when a handshake is
+ *                 removed from the queue by mbedtls_ssl_sched_run()
+ *
+ * \param sched    Scheduler context
+ * \param f_done   Callback taking ( p_done, ssl, status ) where status is
+ *                 0 if the handshake completed or the fatal error code
+ *                 that ended it
+ * \param p_done   Context passed to the callback
+ */
+void mbedtls_ssl_sched_set_done_cb( mbedtls_ssl_sched_context *sched,
+        void (*f_done)( void *, mbedtls_ssl_context *, int ),
+        void *p_done );
+
+/**
+ * \brief          Append a connection to the handshake queue
+ *
+ *                 The underlying transport must be non-blocking, otherwise
+ *                 a slow peer stalls the whole queue inside a step.
+ *
+ * \param sched    Scheduler context
+ * \param ssl      Connection whose handshake should be driven
+ *
+ * \return         0 if successful, MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the
+ *                 connection is already queued, or
+ *                 MBEDTLS_ERR_SSL_ALLOC_FAILED on memory failure
+ */
+int mbedtls_ssl_sched_add( mbedtls_ssl_sched_context *sched,
+                           mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          Remove a connection from the handshake queue, if
+ *                 present (the done callback is not invoked)
+ *
+ * \param sched    Scheduler context
+ * \param ssl      Connection to remove
+ */
+void mbedtls_ssl_sched_remove( mbedtls_ssl_sched_context *sched,
+                               mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          Give every queued handshake (or the first \p max_conns
+ *                 of them, in round-robin order) one budgeted slice
+ *
+ *                 A connection yields its slice early when it needs I/O
+ *                 (WANT_READ / WANT_WRITE) or, with
+ *                 MBEDTLS_SSL_ASYNC_PRIVATE, while an asynchronous
+ *                 private key operation is pending; it stays queued and
+ *                 is revisited on the next call. Connections whose
+ *                 handshake completes or fails fatally are removed and
+ *                 reported through the done callback.
+ *
+ * \param sched    Scheduler context
+ * \param max_conns  Maximum number of connections to advance in this
+ *                   call, or 0 for the whole queue
+ *
+ * \return         The number of connections removed from the queue
+ *                 during this call (completed or failed)
+ */
+int mbedtls_ssl_sched_run( mbedtls_ssl_sched_context *sched,
+                           size_t max_conns );
+
+/**
+ * \brief          Current number of queued handshakes, for load metrics
+ *
+ * \param sched    Scheduler context
+ *
+ * \return         The queue depth
+ */
+size_t mbedtls_ssl_sched_queue_len( const mbedtls_ssl_sched_context *sched );
+
+/**
+ * \brief          Free referenced items and clear memory
+ *
+ *                 Queued connections are not closed or freed: they belong
+ *                 to the application.
+ *
+ * \param sched    Scheduler context
+ */
+void mbedtls_ssl_sched_free( mbedtls_ssl_sched_context *sched );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_sched.h */
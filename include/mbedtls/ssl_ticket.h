@@ -48,26 +48,37 @@ typedef struct
 {
     unsigned char name[4];          /*!< random key identifier              */
     uint32_t generation_time;       /*!< key generation timestamp (seconds) */
-    mbedtls_cipher_context_t ctx;   /*!< context for auth enc/decryption    */
+    unsigned char key[32];          /*!< raw protection key material        */
 }
 mbedtls_ssl_ticket_key;
 
 /**
  * \brief   Context for session ticket handling functions
+ *
+ * \note    The lock only protects rotation of the keys and taking a
+ *          copy of the selected key, and is held shared unless a
+ *          rotation is due; each write/parse operation then runs the
+ *          actual ticket protection on a transient cipher context of
+ *          its own, so that concurrent handshakes do not serialize on
+ *          the context.
  */
 typedef struct
 {
     mbedtls_ssl_ticket_key keys[2]; /*!< ticket protection keys             */
     unsigned char active;           /*!< index of the currently active key  */
 
+    const mbedtls_cipher_info_t *cipher_info;   /*!< AEAD cipher in use     */
+
     uint32_t ticket_lifetime;       /*!< lifetime of tickets in seconds     */
+    uint32_t ticket_jitter;         /*!< max random lifetime reduction      */
+    unsigned char refresh_ahead;    /*!< renewal window, percent of lifetime*/
 
     /** Callback for getting (pseudo-)random numbers                        */
     int  (*f_rng)(void *, unsigned char *, size_t);
     void *p_rng;                    /*!< context for the RNG function       */
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_threading_mutex_t mutex;
+    mbedtls_threading_rwlock_t rwlock;
 #endif
 }
 mbedtls_ssl_ticket_context;
@@ -108,6 +119,39 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
     mbedtls_cipher_type_t cipher,
     uint32_t lifetime );
 
+/**
+ * \brief           Configure lifetime jitter and refresh-ahead renewal
+ *                  (Default: both disabled.)
+ *
+ *                  With a fixed lifetime, tickets issued around the same
+ *                  time (eg after a deploy or a key rotation) all expire
+ *                  together and come back as a synchronized wave of full
+ *                  handshakes. Jitter spreads the advertised lifetimes,
+ *                  and refresh-ahead reissues a ticket when a client
+ *                  resumes during the tail of its lifetime, so renewals
+ *                  happen piecemeal on cheap abbreviated handshakes.
+ *
+ * \param ctx           Context to be configured
+ * \param jitter        Maximum number of seconds randomly subtracted from
+ *                      each ticket's advertised lifetime, 0 to disable.
+ *                      Must be less than the ticket lifetime.
+ * \param refresh_ahead Size of the renewal window as a percentage (0-100)
+ *                      of the ticket lifetime: a ticket presented during
+ *                      the last refresh_ahead percent of its lifetime is
+ *                      still accepted, but \c mbedtls_ssl_ticket_parse()
+ *                      then returns MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH
+ *                      so that a fresh ticket is sent with the abbreviated
+ *                      handshake. 0 to disable.
+ *
+ * \note            A refreshed ticket restarts the full lifetime, so with
+ *                  refresh-ahead a regularly-resuming client can keep a
+ *                  session alive indefinitely; use key rotation and cipher
+ *                  choice accordingly.
+ */
+void mbedtls_ssl_ticket_conf_refresh( mbedtls_ssl_ticket_context *ctx,
+                                      uint32_t jitter,
+                                      unsigned char refresh_ahead );
+
 /**
  * \brief           Implementation of the ticket write callback
  *
@@ -46,13 +46,43 @@ typedef struct
 {
     pthread_mutex_t mutex;
     char is_valid;
+#if defined(MBEDTLS_THREADING_SPIN)
+    int spin;       /*!< adaptive spin bound, maintained by the lock
+                         wrapper (see threading.c)                      */
+#endif
 } mbedtls_threading_mutex_t;
+
+typedef struct
+{
+    pthread_rwlock_t rwlock;
+    char is_valid;
+} mbedtls_threading_rwlock_t;
+
+typedef pthread_once_t mbedtls_threading_once_t;
+#define MBEDTLS_THREADING_ONCE_INIT PTHREAD_ONCE_INIT
 #endif
 
 #if defined(MBEDTLS_THREADING_ALT)
 /* You should define the mbedtls_threading_mutex_t type in your header */
 #include "threading_alt.h"
 
+/*
+ * With an alternate implementation only the mutex type is provided by the
+ * application; read-write locks degrade to the exclusive mutex callbacks
+ * and once-initialization is serialized on an internal mutex. This is
+ * correct, just without the reader concurrency of the pthread backend.
+ */
+typedef struct
+{
+    mbedtls_threading_mutex_t mutex;
+} mbedtls_threading_rwlock_t;
+
+typedef struct
+{
+    char done;
+} mbedtls_threading_once_t;
+#define MBEDTLS_THREADING_ONCE_INIT { 0 }
+
 /**
  * \brief           Set your alternate threading implementation function
  *                  pointers and initialize global mutexes. If used, this
@@ -92,11 +122,31 @@ extern void (*mbedtls_mutex_free)( mbedtls_threading_mutex_t *mutex );
 extern int (*mbedtls_mutex_lock)( mbedtls_threading_mutex_t *mutex );
 extern int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t *mutex );
 
+/*
+ * Read-write locks, for data that is read by many threads and only
+ * rarely written (session cache lookups, ticket key snapshots, ...).
+ * Writers use mbedtls_rwlock_wrlock(); both kinds of holder release
+ * with mbedtls_rwlock_unlock().
+ */
+void mbedtls_rwlock_init( mbedtls_threading_rwlock_t *rwlock );
+void mbedtls_rwlock_free( mbedtls_threading_rwlock_t *rwlock );
+int mbedtls_rwlock_rdlock( mbedtls_threading_rwlock_t *rwlock );
+int mbedtls_rwlock_wrlock( mbedtls_threading_rwlock_t *rwlock );
+int mbedtls_rwlock_unlock( mbedtls_threading_rwlock_t *rwlock );
+
+/*
+ * Run init_routine exactly once across all threads. The once object must
+ * be statically initialized with MBEDTLS_THREADING_ONCE_INIT.
+ */
+int mbedtls_once( mbedtls_threading_once_t *once,
+                  void (*init_routine)( void ) );
+
 /*
  * Global mutexes
  */
 extern mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex;
 extern mbedtls_threading_mutex_t mbedtls_threading_gmtime_mutex;
+extern mbedtls_threading_mutex_t mbedtls_threading_ecp_mutex;
 
 #ifdef __cplusplus
 }
@@ -114,6 +114,133 @@ void mbedtls_timing_set_delay( void *data, uint32_t int_ms, uint32_t fin_ms );
  */
 int mbedtls_timing_get_delay( void *data );
 
+/**
+ * \brief          A virtual clock, advanced explicitly by the application
+ *                 instead of following wall-clock time
+ *
+ * Several delay contexts may share one clock, so a simulation can drive
+ * many DTLS connections from a single notion of time.
+ */
+typedef struct
+{
+    uint64_t ms;        /*!< current virtual time in milliseconds */
+} mbedtls_timing_virt_clock;
+
+/**
+ * \brief          Context for mbedtls_timing_virt_set/get_delay()
+ */
+typedef struct
+{
+    mbedtls_timing_virt_clock *clock;   /*!< the clock delays are measured on */
+    uint64_t                   snapshot;/*!< clock value when the delay was set */
+    uint32_t                   int_ms;
+    uint32_t                   fin_ms;
+} mbedtls_timing_virt_delay_context;
+
+/**
+ * \brief          Initialize a virtual clock at time zero
+ *
+ * \param clock    Virtual clock to initialize
+ */
+void mbedtls_timing_virt_clock_init( mbedtls_timing_virt_clock *clock );
+
+/**
+ * \brief          Advance a virtual clock
+ *
+ * Tests replaying retransmission scenarios call this where real code
+ * would sleep; all delay contexts on the clock see the new time at
+ * their next mbedtls_timing_virt_get_delay() poll.
+ *
+ * \param clock    Virtual clock to advance
+ * \param ms       Amount of virtual time to add, in milliseconds
+ */
+void mbedtls_timing_virt_advance( mbedtls_timing_virt_clock *clock,
+                                  uint32_t ms );
+
+/**
+ * \brief          Bind a delay context to a virtual clock
+ *
+ * \param ctx      Delay context to initialize
+ * \param clock    Clock the context will measure delays on
+ */
+void mbedtls_timing_virt_delay_init( mbedtls_timing_virt_delay_context *ctx,
+                                     mbedtls_timing_virt_clock *clock );
+
+/**
+ * \brief          Set a pair of delays on virtual time
+ *
+ * Drop-in replacement for mbedtls_timing_set_delay() with a
+ * \c mbedtls_timing_virt_delay_context as the data pointer; suitable
+ * for \c mbedtls_ssl_set_timer_cb().
+ */
+void mbedtls_timing_virt_set_delay( void *data, uint32_t int_ms,
+                                    uint32_t fin_ms );
+
+/**
+ * \brief          Get the status of delays on virtual time
+ *                 (Same return values as mbedtls_timing_get_delay().)
+ */
+int mbedtls_timing_virt_get_delay( void *data );
+
+#if defined(MBEDTLS_TIMING_TRACE)
+
+#include <stddef.h>
+
+/*
+ * Operation identifiers for trace records
+ */
+#define MBEDTLS_TIMING_TRACE_RSA_PRIVATE    1 /**< mbedtls_rsa_private()  */
+#define MBEDTLS_TIMING_TRACE_ECP_MUL        2 /**< mbedtls_ecp_mul()      */
+#define MBEDTLS_TIMING_TRACE_SSL_ENCRYPT    3 /**< SSL record encryption  */
+#define MBEDTLS_TIMING_TRACE_MPI_EXP_MOD    4 /**< mbedtls_mpi_exp_mod()  */
+
+/**
+ * \brief          One trace record: an operation and how long it took
+ */
+typedef struct
+{
+    int op;                 /*!< one of the MBEDTLS_TIMING_TRACE_* ids    */
+    unsigned long cycles;   /*!< duration, in mbedtls_timing_hardclock()
+                                 units                                    */
+} mbedtls_timing_trace_record;
+
+/**
+ * \brief          Install the ring buffer trace records are written to
+ *
+ *                 Until a ring is installed, the trace points are no-ops.
+ *                 The ring is not cleared on overrun: once more than
+ *                 \p len records have been written, the oldest are
+ *                 overwritten. Compare mbedtls_timing_trace_count()
+ *                 between reads to detect lost records.
+ *
+ * \param ring     Buffer of \p len records, owned by the caller, or NULL
+ *                 to disable tracing again
+ * \param len      Number of records \p ring can hold
+ */
+void mbedtls_timing_trace_setup( mbedtls_timing_trace_record *ring,
+                                 size_t len );
+
+/**
+ * \brief          Return the number of records written since setup
+ *
+ *                 Record i (if not yet overwritten) lives at index
+ *                 i % len of the installed ring.
+ */
+size_t mbedtls_timing_trace_count( void );
+
+/**
+ * \brief          Append a record to the trace ring
+ *
+ *                 Called by the instrumented operations; applications
+ *                 normally only read the ring.
+ *
+ * \param op       Operation identifier, one of MBEDTLS_TIMING_TRACE_*
+ * \param cycles   Duration of the operation in hardclock units
+ */
+void mbedtls_timing_trace( int op, unsigned long cycles );
+
+#endif /* MBEDTLS_TIMING_TRACE */
+
 #ifdef __cplusplus
 }
 #endif
@@ -53,6 +53,8 @@
 
 #if defined(MBEDTLS_VERSION_C)
 
+#include "version_features.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
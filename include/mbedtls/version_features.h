@@ -0,0 +1,318 @@
+/**
+ * \file version_features.h
+ *
+ * \brief Numeric feature identifiers for run-time configuration checks
+ *
+ *  This file is generated by scripts/generate_features.pl, do not edit.
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_VERSION_FEATURES_H
+#define MBEDTLS_VERSION_FEATURES_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Numeric identifiers for the defines in the "System support", "mbed TLS
+ * modules" and "mbed TLS feature support" sections of config.h, in the
+ * order they appear there. Every known feature has an identifier whether
+ * it is enabled in the current configuration or not, so the numbering is
+ * the same for every build of the same version.
+ */
+typedef enum
+{
+    MBEDTLS_FEATURE_HAVE_ASM,                                /**< MBEDTLS_HAVE_ASM */
+    MBEDTLS_FEATURE_HAVE_SSE2,                               /**< MBEDTLS_HAVE_SSE2 */
+    MBEDTLS_FEATURE_HAVE_TIME,                               /**< MBEDTLS_HAVE_TIME */
+    MBEDTLS_FEATURE_HAVE_TIME_DATE,                          /**< MBEDTLS_HAVE_TIME_DATE */
+    MBEDTLS_FEATURE_PLATFORM_MEMORY,                         /**< MBEDTLS_PLATFORM_MEMORY */
+    MBEDTLS_FEATURE_PLATFORM_NO_STD_FUNCTIONS,               /**< MBEDTLS_PLATFORM_NO_STD_FUNCTIONS */
+    MBEDTLS_FEATURE_PLATFORM_EXIT_ALT,                       /**< MBEDTLS_PLATFORM_EXIT_ALT */
+    MBEDTLS_FEATURE_PLATFORM_FPRINTF_ALT,                    /**< MBEDTLS_PLATFORM_FPRINTF_ALT */
+    MBEDTLS_FEATURE_PLATFORM_PRINTF_ALT,                     /**< MBEDTLS_PLATFORM_PRINTF_ALT */
+    MBEDTLS_FEATURE_PLATFORM_SNPRINTF_ALT,                   /**< MBEDTLS_PLATFORM_SNPRINTF_ALT */
+    MBEDTLS_FEATURE_DEPRECATED_WARNING,                      /**< MBEDTLS_DEPRECATED_WARNING */
+    MBEDTLS_FEATURE_DEPRECATED_REMOVED,                      /**< MBEDTLS_DEPRECATED_REMOVED */
+    MBEDTLS_FEATURE_TIMING_ALT,                              /**< MBEDTLS_TIMING_ALT */
+    MBEDTLS_FEATURE_AES_ALT,                                 /**< MBEDTLS_AES_ALT */
+    MBEDTLS_FEATURE_ARC4_ALT,                                /**< MBEDTLS_ARC4_ALT */
+    MBEDTLS_FEATURE_BLOWFISH_ALT,                            /**< MBEDTLS_BLOWFISH_ALT */
+    MBEDTLS_FEATURE_CAMELLIA_ALT,                            /**< MBEDTLS_CAMELLIA_ALT */
+    MBEDTLS_FEATURE_DES_ALT,                                 /**< MBEDTLS_DES_ALT */
+    MBEDTLS_FEATURE_XTEA_ALT,                                /**< MBEDTLS_XTEA_ALT */
+    MBEDTLS_FEATURE_MD2_ALT,                                 /**< MBEDTLS_MD2_ALT */
+    MBEDTLS_FEATURE_MD4_ALT,                                 /**< MBEDTLS_MD4_ALT */
+    MBEDTLS_FEATURE_MD5_ALT,                                 /**< MBEDTLS_MD5_ALT */
+    MBEDTLS_FEATURE_RIPEMD160_ALT,                           /**< MBEDTLS_RIPEMD160_ALT */
+    MBEDTLS_FEATURE_SHA1_ALT,                                /**< MBEDTLS_SHA1_ALT */
+    MBEDTLS_FEATURE_SHA256_ALT,                              /**< MBEDTLS_SHA256_ALT */
+    MBEDTLS_FEATURE_SHA512_ALT,                              /**< MBEDTLS_SHA512_ALT */
+    MBEDTLS_FEATURE_MD2_PROCESS_ALT,                         /**< MBEDTLS_MD2_PROCESS_ALT */
+    MBEDTLS_FEATURE_MD4_PROCESS_ALT,                         /**< MBEDTLS_MD4_PROCESS_ALT */
+    MBEDTLS_FEATURE_MD5_PROCESS_ALT,                         /**< MBEDTLS_MD5_PROCESS_ALT */
+    MBEDTLS_FEATURE_RIPEMD160_PROCESS_ALT,                   /**< MBEDTLS_RIPEMD160_PROCESS_ALT */
+    MBEDTLS_FEATURE_SHA1_PROCESS_ALT,                        /**< MBEDTLS_SHA1_PROCESS_ALT */
+    MBEDTLS_FEATURE_SHA256_PROCESS_ALT,                      /**< MBEDTLS_SHA256_PROCESS_ALT */
+    MBEDTLS_FEATURE_SHA512_PROCESS_ALT,                      /**< MBEDTLS_SHA512_PROCESS_ALT */
+    MBEDTLS_FEATURE_DES_SETKEY_ALT,                          /**< MBEDTLS_DES_SETKEY_ALT */
+    MBEDTLS_FEATURE_DES_CRYPT_ECB_ALT,                       /**< MBEDTLS_DES_CRYPT_ECB_ALT */
+    MBEDTLS_FEATURE_DES3_CRYPT_ECB_ALT,                      /**< MBEDTLS_DES3_CRYPT_ECB_ALT */
+    MBEDTLS_FEATURE_AES_SETKEY_ENC_ALT,                      /**< MBEDTLS_AES_SETKEY_ENC_ALT */
+    MBEDTLS_FEATURE_AES_SETKEY_DEC_ALT,                      /**< MBEDTLS_AES_SETKEY_DEC_ALT */
+    MBEDTLS_FEATURE_AES_ENCRYPT_ALT,                         /**< MBEDTLS_AES_ENCRYPT_ALT */
+    MBEDTLS_FEATURE_AES_DECRYPT_ALT,                         /**< MBEDTLS_AES_DECRYPT_ALT */
+    MBEDTLS_FEATURE_ENTROPY_HARDWARE_ALT,                    /**< MBEDTLS_ENTROPY_HARDWARE_ALT */
+    MBEDTLS_FEATURE_ENTROPY_RDSEED,                          /**< MBEDTLS_ENTROPY_RDSEED */
+    MBEDTLS_FEATURE_AES_ROM_TABLES,                          /**< MBEDTLS_AES_ROM_TABLES */
+    MBEDTLS_FEATURE_CAMELLIA_SMALL_MEMORY,                   /**< MBEDTLS_CAMELLIA_SMALL_MEMORY */
+    MBEDTLS_FEATURE_CIPHER_MODE_CBC,                         /**< MBEDTLS_CIPHER_MODE_CBC */
+    MBEDTLS_FEATURE_CIPHER_MODE_CFB,                         /**< MBEDTLS_CIPHER_MODE_CFB */
+    MBEDTLS_FEATURE_CIPHER_MODE_CTR,                         /**< MBEDTLS_CIPHER_MODE_CTR */
+    MBEDTLS_FEATURE_CIPHER_MODE_XTS,                         /**< MBEDTLS_CIPHER_MODE_XTS */
+    MBEDTLS_FEATURE_CIPHER_NULL_CIPHER,                      /**< MBEDTLS_CIPHER_NULL_CIPHER */
+    MBEDTLS_FEATURE_SINGLE_BACKEND_DISPATCH,                 /**< MBEDTLS_SINGLE_BACKEND_DISPATCH */
+    MBEDTLS_FEATURE_CIPHER_PADDING_PKCS7,                    /**< MBEDTLS_CIPHER_PADDING_PKCS7 */
+    MBEDTLS_FEATURE_CIPHER_PADDING_ONE_AND_ZEROS,            /**< MBEDTLS_CIPHER_PADDING_ONE_AND_ZEROS */
+    MBEDTLS_FEATURE_CIPHER_PADDING_ZEROS_AND_LEN,            /**< MBEDTLS_CIPHER_PADDING_ZEROS_AND_LEN */
+    MBEDTLS_FEATURE_CIPHER_PADDING_ZEROS,                    /**< MBEDTLS_CIPHER_PADDING_ZEROS */
+    MBEDTLS_FEATURE_ENABLE_WEAK_CIPHERSUITES,                /**< MBEDTLS_ENABLE_WEAK_CIPHERSUITES */
+    MBEDTLS_FEATURE_REMOVE_ARC4_CIPHERSUITES,                /**< MBEDTLS_REMOVE_ARC4_CIPHERSUITES */
+    MBEDTLS_FEATURE_ECP_DP_SECP192R1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP192R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP224R1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP224R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP256R1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP256R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP384R1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP384R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP521R1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP521R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP192K1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP192K1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP224K1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP224K1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_SECP256K1_ENABLED,                /**< MBEDTLS_ECP_DP_SECP256K1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_BP256R1_ENABLED,                  /**< MBEDTLS_ECP_DP_BP256R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_BP384R1_ENABLED,                  /**< MBEDTLS_ECP_DP_BP384R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_BP512R1_ENABLED,                  /**< MBEDTLS_ECP_DP_BP512R1_ENABLED */
+    MBEDTLS_FEATURE_ECP_DP_CURVE25519_ENABLED,               /**< MBEDTLS_ECP_DP_CURVE25519_ENABLED */
+    MBEDTLS_FEATURE_ECP_NIST_OPTIM,                          /**< MBEDTLS_ECP_NIST_OPTIM */
+    MBEDTLS_FEATURE_ECP_COMB_TABLE_CACHE,                    /**< MBEDTLS_ECP_COMB_TABLE_CACHE */
+    MBEDTLS_FEATURE_ECP_RESTARTABLE,                         /**< MBEDTLS_ECP_RESTARTABLE */
+    MBEDTLS_FEATURE_ECDSA_DETERMINISTIC,                     /**< MBEDTLS_ECDSA_DETERMINISTIC */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_PSK_ENABLED,                /**< MBEDTLS_KEY_EXCHANGE_PSK_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_DHE_PSK_ENABLED,            /**< MBEDTLS_KEY_EXCHANGE_DHE_PSK_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_ECDHE_PSK_ENABLED,          /**< MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_RSA_PSK_ENABLED,            /**< MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_RSA_ENABLED,                /**< MBEDTLS_KEY_EXCHANGE_RSA_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_DHE_RSA_ENABLED,            /**< MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_ECDHE_RSA_ENABLED,          /**< MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED,        /**< MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_ECDH_ECDSA_ENABLED,         /**< MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED */
+    MBEDTLS_FEATURE_KEY_EXCHANGE_ECDH_RSA_ENABLED,           /**< MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED */
+    MBEDTLS_FEATURE_PK_PARSE_EC_EXTENDED,                    /**< MBEDTLS_PK_PARSE_EC_EXTENDED */
+    MBEDTLS_FEATURE_ERROR_STRERROR_DUMMY,                    /**< MBEDTLS_ERROR_STRERROR_DUMMY */
+    MBEDTLS_FEATURE_GENPRIME,                                /**< MBEDTLS_GENPRIME */
+    MBEDTLS_FEATURE_FS_IO,                                   /**< MBEDTLS_FS_IO */
+    MBEDTLS_FEATURE_CTR_DRBG_FORK_CHECK,                     /**< MBEDTLS_CTR_DRBG_FORK_CHECK */
+    MBEDTLS_FEATURE_GCM_LARGETABLE,                          /**< MBEDTLS_GCM_LARGETABLE */
+    MBEDTLS_FEATURE_NO_DEFAULT_ENTROPY_SOURCES,              /**< MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES */
+    MBEDTLS_FEATURE_NO_PLATFORM_ENTROPY,                     /**< MBEDTLS_NO_PLATFORM_ENTROPY */
+    MBEDTLS_FEATURE_ENTROPY_FORCE_SHA256,                    /**< MBEDTLS_ENTROPY_FORCE_SHA256 */
+    MBEDTLS_FEATURE_ENTROPY_PREFETCH,                        /**< MBEDTLS_ENTROPY_PREFETCH */
+    MBEDTLS_FEATURE_MD_HMAC_CACHE,                           /**< MBEDTLS_MD_HMAC_CACHE */
+    MBEDTLS_FEATURE_MEMORY_DEBUG,                            /**< MBEDTLS_MEMORY_DEBUG */
+    MBEDTLS_FEATURE_MEMORY_BACKTRACE,                        /**< MBEDTLS_MEMORY_BACKTRACE */
+    MBEDTLS_FEATURE_MEMORY_TAGGING,                          /**< MBEDTLS_MEMORY_TAGGING */
+    MBEDTLS_FEATURE_MEMORY_ARENAS,                           /**< MBEDTLS_MEMORY_ARENAS */
+    MBEDTLS_FEATURE_MPI_MUL_WIDE,                            /**< MBEDTLS_MPI_MUL_WIDE */
+    MBEDTLS_FEATURE_PK_RSA_ALT_SUPPORT,                      /**< MBEDTLS_PK_RSA_ALT_SUPPORT */
+    MBEDTLS_FEATURE_PKCS1_V15,                               /**< MBEDTLS_PKCS1_V15 */
+    MBEDTLS_FEATURE_PKCS1_V21,                               /**< MBEDTLS_PKCS1_V21 */
+    MBEDTLS_FEATURE_RSA_NO_CRT,                              /**< MBEDTLS_RSA_NO_CRT */
+    MBEDTLS_FEATURE_SELF_TEST,                               /**< MBEDTLS_SELF_TEST */
+    MBEDTLS_FEATURE_SHA256_SMALLER,                          /**< MBEDTLS_SHA256_SMALLER */
+    MBEDTLS_FEATURE_SSL_AEAD_RANDOM_IV,                      /**< MBEDTLS_SSL_AEAD_RANDOM_IV */
+    MBEDTLS_FEATURE_SSL_ALL_ALERT_MESSAGES,                  /**< MBEDTLS_SSL_ALL_ALERT_MESSAGES */
+    MBEDTLS_FEATURE_SSL_DEBUG_ALL,                           /**< MBEDTLS_SSL_DEBUG_ALL */
+    MBEDTLS_FEATURE_SSL_ECDH_REUSE,                          /**< MBEDTLS_SSL_ECDH_REUSE */
+    MBEDTLS_FEATURE_SSL_ENCRYPT_THEN_MAC,                    /**< MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+    MBEDTLS_FEATURE_SSL_EXTENDED_MASTER_SECRET,              /**< MBEDTLS_SSL_EXTENDED_MASTER_SECRET */
+    MBEDTLS_FEATURE_SSL_FALLBACK_SCSV,                       /**< MBEDTLS_SSL_FALLBACK_SCSV */
+    MBEDTLS_FEATURE_SSL_FALSE_START,                         /**< MBEDTLS_SSL_FALSE_START */
+    MBEDTLS_FEATURE_SSL_HS_TIMING,                           /**< MBEDTLS_SSL_HS_TIMING */
+    MBEDTLS_FEATURE_SSL_HW_RECORD_ACCEL,                     /**< MBEDTLS_SSL_HW_RECORD_ACCEL */
+    MBEDTLS_FEATURE_SSL_OUT_DOUBLE_BUFFER,                   /**< MBEDTLS_SSL_OUT_DOUBLE_BUFFER */
+    MBEDTLS_FEATURE_SSL_CBC_RECORD_SPLITTING,                /**< MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+    MBEDTLS_FEATURE_SSL_RECORD_PADDING,                      /**< MBEDTLS_SSL_RECORD_PADDING */
+    MBEDTLS_FEATURE_SSL_RECORD_KEY_EXPORT,                   /**< MBEDTLS_SSL_RECORD_KEY_EXPORT */
+    MBEDTLS_FEATURE_SSL_RECORD_SPECIALIZE,                   /**< MBEDTLS_SSL_RECORD_SPECIALIZE */
+    MBEDTLS_FEATURE_SSL_RENEGOTIATION,                       /**< MBEDTLS_SSL_RENEGOTIATION */
+    MBEDTLS_FEATURE_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO,      /**< MBEDTLS_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO */
+    MBEDTLS_FEATURE_SSL_SRV_RESPECT_CLIENT_PREFERENCE,       /**< MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE */
+    MBEDTLS_FEATURE_SSL_MAX_FRAGMENT_LENGTH,                 /**< MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+    MBEDTLS_FEATURE_SSL_PROTO_SSL3,                          /**< MBEDTLS_SSL_PROTO_SSL3 */
+    MBEDTLS_FEATURE_SSL_PROTO_TLS1,                          /**< MBEDTLS_SSL_PROTO_TLS1 */
+    MBEDTLS_FEATURE_SSL_PROTO_TLS1_1,                        /**< MBEDTLS_SSL_PROTO_TLS1_1 */
+    MBEDTLS_FEATURE_SSL_PROTO_TLS1_2,                        /**< MBEDTLS_SSL_PROTO_TLS1_2 */
+    MBEDTLS_FEATURE_SSL_PROTO_DTLS,                          /**< MBEDTLS_SSL_PROTO_DTLS */
+    MBEDTLS_FEATURE_SSL_ALPN,                                /**< MBEDTLS_SSL_ALPN */
+    MBEDTLS_FEATURE_SSL_ASYNC_PRIVATE,                       /**< MBEDTLS_SSL_ASYNC_PRIVATE */
+    MBEDTLS_FEATURE_SSL_DTLS_ANTI_REPLAY,                    /**< MBEDTLS_SSL_DTLS_ANTI_REPLAY */
+    MBEDTLS_FEATURE_SSL_DTLS_HELLO_VERIFY,                   /**< MBEDTLS_SSL_DTLS_HELLO_VERIFY */
+    MBEDTLS_FEATURE_SSL_DTLS_BADMAC_LIMIT,                   /**< MBEDTLS_SSL_DTLS_BADMAC_LIMIT */
+    MBEDTLS_FEATURE_SSL_SESSION_TICKETS,                     /**< MBEDTLS_SSL_SESSION_TICKETS */
+    MBEDTLS_FEATURE_SSL_SERVER_NAME_INDICATION,              /**< MBEDTLS_SSL_SERVER_NAME_INDICATION */
+    MBEDTLS_FEATURE_SSL_STATS,                               /**< MBEDTLS_SSL_STATS */
+    MBEDTLS_FEATURE_SSL_TRUNCATED_HMAC,                      /**< MBEDTLS_SSL_TRUNCATED_HMAC */
+    MBEDTLS_FEATURE_SSL_TRANSFORM_POOL,                      /**< MBEDTLS_SSL_TRANSFORM_POOL */
+    MBEDTLS_FEATURE_SSL_HANDSHAKE_POOL,                      /**< MBEDTLS_SSL_HANDSHAKE_POOL */
+    MBEDTLS_FEATURE_THREADING_ALT,                           /**< MBEDTLS_THREADING_ALT */
+    MBEDTLS_FEATURE_THREADING_PTHREAD,                       /**< MBEDTLS_THREADING_PTHREAD */
+    MBEDTLS_FEATURE_THREADING_SPIN,                          /**< MBEDTLS_THREADING_SPIN */
+    MBEDTLS_FEATURE_TIMING_COARSE,                           /**< MBEDTLS_TIMING_COARSE */
+    MBEDTLS_FEATURE_TIMING_TRACE,                            /**< MBEDTLS_TIMING_TRACE */
+    MBEDTLS_FEATURE_VERSION_FEATURES,                        /**< MBEDTLS_VERSION_FEATURES */
+    MBEDTLS_FEATURE_X509_ALLOW_EXTENSIONS_NON_V3,            /**< MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3 */
+    MBEDTLS_FEATURE_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION, /**< MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION */
+    MBEDTLS_FEATURE_X509_CRT_LAZY_EXTENSIONS,                /**< MBEDTLS_X509_CRT_LAZY_EXTENSIONS */
+    MBEDTLS_FEATURE_X509_CRT_ARENA,                          /**< MBEDTLS_X509_CRT_ARENA */
+    MBEDTLS_FEATURE_X509_CRT_HOST_TABLE,                     /**< MBEDTLS_X509_CRT_HOST_TABLE */
+    MBEDTLS_FEATURE_X509_DN_CACHE,                           /**< MBEDTLS_X509_DN_CACHE */
+    MBEDTLS_FEATURE_X509_CHECK_KEY_USAGE,                    /**< MBEDTLS_X509_CHECK_KEY_USAGE */
+    MBEDTLS_FEATURE_X509_CHECK_EXTENDED_KEY_USAGE,           /**< MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE */
+    MBEDTLS_FEATURE_X509_RSASSA_PSS_SUPPORT,                 /**< MBEDTLS_X509_RSASSA_PSS_SUPPORT */
+    MBEDTLS_FEATURE_ZLIB_SUPPORT,                            /**< MBEDTLS_ZLIB_SUPPORT */
+    MBEDTLS_FEATURE_AESNI_C,                                 /**< MBEDTLS_AESNI_C */
+    MBEDTLS_FEATURE_ARMCE_C,                                 /**< MBEDTLS_ARMCE_C */
+    MBEDTLS_FEATURE_AESCT_C,                                 /**< MBEDTLS_AESCT_C */
+    MBEDTLS_FEATURE_AES_C,                                   /**< MBEDTLS_AES_C */
+    MBEDTLS_FEATURE_ARC4_C,                                  /**< MBEDTLS_ARC4_C */
+    MBEDTLS_FEATURE_ASN1_PARSE_C,                            /**< MBEDTLS_ASN1_PARSE_C */
+    MBEDTLS_FEATURE_ASN1_WRITE_C,                            /**< MBEDTLS_ASN1_WRITE_C */
+    MBEDTLS_FEATURE_BASE64_C,                                /**< MBEDTLS_BASE64_C */
+    MBEDTLS_FEATURE_BIGNUM_C,                                /**< MBEDTLS_BIGNUM_C */
+    MBEDTLS_FEATURE_BLOWFISH_C,                              /**< MBEDTLS_BLOWFISH_C */
+    MBEDTLS_FEATURE_CAMELLIA_C,                              /**< MBEDTLS_CAMELLIA_C */
+    MBEDTLS_FEATURE_CCM_C,                                   /**< MBEDTLS_CCM_C */
+    MBEDTLS_FEATURE_CERTS_C,                                 /**< MBEDTLS_CERTS_C */
+    MBEDTLS_FEATURE_CHACHA20_C,                              /**< MBEDTLS_CHACHA20_C */
+    MBEDTLS_FEATURE_CHACHAPOLY_C,                            /**< MBEDTLS_CHACHAPOLY_C */
+    MBEDTLS_FEATURE_CIPHER_C,                                /**< MBEDTLS_CIPHER_C */
+    MBEDTLS_FEATURE_CTR_DRBG_C,                              /**< MBEDTLS_CTR_DRBG_C */
+    MBEDTLS_FEATURE_DEBUG_C,                                 /**< MBEDTLS_DEBUG_C */
+    MBEDTLS_FEATURE_DES_C,                                   /**< MBEDTLS_DES_C */
+    MBEDTLS_FEATURE_DHM_C,                                   /**< MBEDTLS_DHM_C */
+    MBEDTLS_FEATURE_ECDH_C,                                  /**< MBEDTLS_ECDH_C */
+    MBEDTLS_FEATURE_ECDSA_C,                                 /**< MBEDTLS_ECDSA_C */
+    MBEDTLS_FEATURE_ECP_C,                                   /**< MBEDTLS_ECP_C */
+    MBEDTLS_FEATURE_ENTROPY_C,                               /**< MBEDTLS_ENTROPY_C */
+    MBEDTLS_FEATURE_ERROR_C,                                 /**< MBEDTLS_ERROR_C */
+    MBEDTLS_FEATURE_GCM_C,                                   /**< MBEDTLS_GCM_C */
+    MBEDTLS_FEATURE_HAVEGE_C,                                /**< MBEDTLS_HAVEGE_C */
+    MBEDTLS_FEATURE_HMAC_DRBG_C,                             /**< MBEDTLS_HMAC_DRBG_C */
+    MBEDTLS_FEATURE_MD_C,                                    /**< MBEDTLS_MD_C */
+    MBEDTLS_FEATURE_MD2_C,                                   /**< MBEDTLS_MD2_C */
+    MBEDTLS_FEATURE_MD4_C,                                   /**< MBEDTLS_MD4_C */
+    MBEDTLS_FEATURE_MD5_C,                                   /**< MBEDTLS_MD5_C */
+    MBEDTLS_FEATURE_MEMORY_BUFFER_ALLOC_C,                   /**< MBEDTLS_MEMORY_BUFFER_ALLOC_C */
+    MBEDTLS_FEATURE_NET_C,                                   /**< MBEDTLS_NET_C */
+    MBEDTLS_FEATURE_OID_C,                                   /**< MBEDTLS_OID_C */
+    MBEDTLS_FEATURE_PADLOCK_C,                               /**< MBEDTLS_PADLOCK_C */
+    MBEDTLS_FEATURE_PEM_PARSE_C,                             /**< MBEDTLS_PEM_PARSE_C */
+    MBEDTLS_FEATURE_PEM_WRITE_C,                             /**< MBEDTLS_PEM_WRITE_C */
+    MBEDTLS_FEATURE_PK_C,                                    /**< MBEDTLS_PK_C */
+    MBEDTLS_FEATURE_PK_PARSE_C,                              /**< MBEDTLS_PK_PARSE_C */
+    MBEDTLS_FEATURE_PK_WRITE_C,                              /**< MBEDTLS_PK_WRITE_C */
+    MBEDTLS_FEATURE_PKCS5_C,                                 /**< MBEDTLS_PKCS5_C */
+    MBEDTLS_FEATURE_PKCS11_C,                                /**< MBEDTLS_PKCS11_C */
+    MBEDTLS_FEATURE_PKCS12_C,                                /**< MBEDTLS_PKCS12_C */
+    MBEDTLS_FEATURE_PLATFORM_C,                              /**< MBEDTLS_PLATFORM_C */
+    MBEDTLS_FEATURE_POLY1305_C,                              /**< MBEDTLS_POLY1305_C */
+    MBEDTLS_FEATURE_RIPEMD160_C,                             /**< MBEDTLS_RIPEMD160_C */
+    MBEDTLS_FEATURE_RSA_C,                                   /**< MBEDTLS_RSA_C */
+    MBEDTLS_FEATURE_SHA1_C,                                  /**< MBEDTLS_SHA1_C */
+    MBEDTLS_FEATURE_SHA256_C,                                /**< MBEDTLS_SHA256_C */
+    MBEDTLS_FEATURE_SHA256MB_C,                              /**< MBEDTLS_SHA256MB_C */
+    MBEDTLS_FEATURE_SHA512_C,                                /**< MBEDTLS_SHA512_C */
+    MBEDTLS_FEATURE_SHANI_C,                                 /**< MBEDTLS_SHANI_C */
+    MBEDTLS_FEATURE_SSL_BIO_PAIR_C,                          /**< MBEDTLS_SSL_BIO_PAIR_C */
+    MBEDTLS_FEATURE_SSL_CACHE_C,                             /**< MBEDTLS_SSL_CACHE_C */
+    MBEDTLS_FEATURE_SSL_CACHE_SHM_C,                         /**< MBEDTLS_SSL_CACHE_SHM_C */
+    MBEDTLS_FEATURE_SSL_COOKIE_C,                            /**< MBEDTLS_SSL_COOKIE_C */
+    MBEDTLS_FEATURE_SSL_DEMUX_C,                             /**< MBEDTLS_SSL_DEMUX_C */
+    MBEDTLS_FEATURE_SSL_PSK_STORE_C,                         /**< MBEDTLS_SSL_PSK_STORE_C */
+    MBEDTLS_FEATURE_SSL_SCHED_C,                             /**< MBEDTLS_SSL_SCHED_C */
+    MBEDTLS_FEATURE_SSL_TICKET_C,                            /**< MBEDTLS_SSL_TICKET_C */
+    MBEDTLS_FEATURE_SSL_CLI_C,                               /**< MBEDTLS_SSL_CLI_C */
+    MBEDTLS_FEATURE_SSL_SRV_C,                               /**< MBEDTLS_SSL_SRV_C */
+    MBEDTLS_FEATURE_SSL_TLS_C,                               /**< MBEDTLS_SSL_TLS_C */
+    MBEDTLS_FEATURE_THREADING_C,                             /**< MBEDTLS_THREADING_C */
+    MBEDTLS_FEATURE_TIMING_C,                                /**< MBEDTLS_TIMING_C */
+    MBEDTLS_FEATURE_VERSION_C,                               /**< MBEDTLS_VERSION_C */
+    MBEDTLS_FEATURE_WARMUP_C,                                /**< MBEDTLS_WARMUP_C */
+    MBEDTLS_FEATURE_X509_USE_C,                              /**< MBEDTLS_X509_USE_C */
+    MBEDTLS_FEATURE_X509_CRT_PARSE_C,                        /**< MBEDTLS_X509_CRT_PARSE_C */
+    MBEDTLS_FEATURE_X509_CRT_CACHE_C,                        /**< MBEDTLS_X509_CRT_CACHE_C */
+    MBEDTLS_FEATURE_X509_TRUST_C,                            /**< MBEDTLS_X509_TRUST_C */
+    MBEDTLS_FEATURE_X509_VERIFY_CACHE_C,                     /**< MBEDTLS_X509_VERIFY_CACHE_C */
+    MBEDTLS_FEATURE_X509_CRL_PARSE_C,                        /**< MBEDTLS_X509_CRL_PARSE_C */
+    MBEDTLS_FEATURE_X509_CRL_SET_C,                          /**< MBEDTLS_X509_CRL_SET_C */
+    MBEDTLS_FEATURE_X509_CSR_PARSE_C,                        /**< MBEDTLS_X509_CSR_PARSE_C */
+    MBEDTLS_FEATURE_X509_CREATE_C,                           /**< MBEDTLS_X509_CREATE_C */
+    MBEDTLS_FEATURE_X509_CRT_WRITE_C,                        /**< MBEDTLS_X509_CRT_WRITE_C */
+    MBEDTLS_FEATURE_X509_CSR_WRITE_C,                        /**< MBEDTLS_X509_CSR_WRITE_C */
+    MBEDTLS_FEATURE_XTEA_C,                                  /**< MBEDTLS_XTEA_C */
+    MBEDTLS_FEATURE_COUNT       /**< Number of feature identifiers */
+} mbedtls_feature_t;
+
+/**
+ * \brief           Check if support for a feature was compiled into this
+ *                  mbed TLS binary, by numeric identifier. Same semantics
+ *                  as mbedtls_version_check_feature() but a single bit
+ *                  test instead of a scan over the feature name table.
+ *
+ * \param feature   The identifier to check (e.g. MBEDTLS_FEATURE_AES_C)
+ *
+ * \return          0 if the feature is present,
+ *                  -1 if the feature is not present and
+ *                  -2 if support for feature checking as a whole was not
+ *                  compiled in.
+ */
+int mbedtls_version_check_feature_id( mbedtls_feature_t feature );
+
+/**
+ * \brief           Copy the packed bitmap of compiled-in features, with
+ *                  feature identifier i stored in bit i % 8 of byte i / 8.
+ *                  The bitmap identifies a configuration, so it can serve
+ *                  as a compact config fingerprint.
+ *
+ * \param bitmap    Buffer receiving the bitmap, may be NULL to query the
+ *                  size only
+ * \param len       Size of \p bitmap in bytes; copying stops there if the
+ *                  bitmap is larger
+ *
+ * \return          The full size of the bitmap in bytes,
+ *                  ( MBEDTLS_FEATURE_COUNT + 7 ) / 8, or 0 if support for
+ *                  feature checking was not compiled in.
+ */
+size_t mbedtls_version_feature_bitmap( unsigned char *bitmap, size_t len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* version_features.h */
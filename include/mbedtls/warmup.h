@@ -0,0 +1,68 @@
+/**
+ * \file warmup.h
+ *
+ * \brief Precompute lazily-built tables during process initialization
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_WARMUP_H
+#define MBEDTLS_WARMUP_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Precompute the tables the library builds lazily on
+ *                 first use, so the first request after process start
+ *                 does not pay for them.
+ *
+ *                 Currently covered:
+ *                 - the AES S-boxes and round tables generated when
+ *                   MBEDTLS_AES_ROM_TABLES is unset;
+ *                 - the GCM key schedule path (the GHASH tables
+ *                   themselves are per key and are built when a key is
+ *                   set, e.g. by mbedtls_ssl_ticket_setup());
+ *                 - the group constants of every enabled ECP curve and,
+ *                   with MBEDTLS_ECP_COMB_TABLE_CACHE, the shared comb
+ *                   table of each Weierstrass curve's base point.
+ *
+ *                 Tables that are compiled in (MBEDTLS_AES_ROM_TABLES,
+ *                 built-in comb tables) need no warm-up and are skipped.
+ *
+ *                 Call once from the main thread before the process
+ *                 starts serving requests. Safe to call again; repeated
+ *                 calls redo the probe operations but not the table
+ *                 generation.
+ *
+ * \return         0 if successful, or the first error encountered
+ */
+int mbedtls_warmup( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* warmup.h */
@@ -279,8 +279,41 @@ int mbedtls_x509_self_test( int verbose );
  * Internal module functions. You probably do not want to use these unless you
  * know you do.
  */
+
+#if defined(MBEDTLS_X509_CRT_ARENA)
+/**
+ * Nodes of inline storage embedded in the arena itself. Eight covers the
+ * typical certificate (a few RDNs per name, 1-4 SANs, a couple of EKU
+ * OIDs beyond the embedded list heads) without any heap allocation.
+ */
+#define MBEDTLS_X509_ARENA_FIXED_NODES  8
+#endif
+
+/**
+ * Backing store for the linked-list nodes of one parsed X.509 object:
+ * an inline block for the first few nodes, then a single contiguous
+ * spill block carved out sequentially and freed in one go, instead of
+ * one heap allocation per node. With a NULL arena the parsing helpers
+ * fall back to individual heap allocations.
+ */
+typedef struct mbedtls_x509_arena
+{
+    unsigned char *buf;         /**< the spill block, may be NULL       */
+    size_t len;                 /**< size of the spill block            */
+    size_t used;                /**< spill bytes carved out so far      */
+#if defined(MBEDTLS_X509_CRT_ARENA)
+    size_t fixed_used;          /**< bytes carved from \c fixed so far  */
+    /** Inline storage, used up before the spill block */
+    unsigned char fixed[MBEDTLS_X509_ARENA_FIXED_NODES *
+                        sizeof( mbedtls_x509_name )];
+#endif
+}
+mbedtls_x509_arena;
+
+void *mbedtls_x509_arena_alloc( mbedtls_x509_arena *arena, size_t size );
+
 int mbedtls_x509_get_name( unsigned char **p, const unsigned char *end,
-                   mbedtls_x509_name *cur );
+                   mbedtls_x509_name *cur, mbedtls_x509_arena *arena );
 int mbedtls_x509_get_alg_null( unsigned char **p, const unsigned char *end,
                        mbedtls_x509_buf *alg );
 int mbedtls_x509_get_alg( unsigned char **p, const unsigned char *end,
@@ -0,0 +1,196 @@
+/**
+ * \file x509_crl_set.h
+ *
+ * \brief Compact sorted-array representation of CRL revocation data
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_X509_CRL_SET_H
+#define MBEDTLS_X509_CRL_SET_H
+
+#include "x509_crl.h"
+#include "x509_crt.h"
+
+/**
+ * Size of one serial record: a length byte followed by the serial value,
+ * right-aligned in a 20-octet field (RFC 5280 caps serial numbers at 20
+ * octets). Records compare with memcmp(), shortest serials first.
+ */
+#define MBEDTLS_X509_CRL_SET_RECORD_SIZE    21
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   Revoked-serial set in compact sorted-array form
+ *
+ *          A parsed CRL holds one heap-allocated list node per revoked
+ *          certificate and revocation checks walk that list linearly,
+ *          which is prohibitive for CRLs with millions of entries. This
+ *          set stores only the canonicalized serial numbers, as fixed
+ *          size records in one sorted array: membership is a binary
+ *          search, the whole set is a single allocation, and the array
+ *          itself is the storage format, so a preprocessed file can be
+ *          attached in place (e.g. from a memory mapping) without
+ *          parsing or copying.
+ *
+ *          The set performs no signature or issuer checks; validating
+ *          the CRL it is built from, and pairing the set with the right
+ *          issuer, is the caller's responsibility. It is designed to be
+ *          consulted from the verification callback passed to
+ *          mbedtls_x509_crt_verify().
+ */
+typedef struct mbedtls_x509_crl_set
+{
+    unsigned char *records;     /*!< sorted array of serial records       */
+    size_t count;               /*!< number of records                    */
+    int owned;                  /*!< whether records is ours to free      */
+}
+mbedtls_x509_crl_set;
+
+/**
+ * \brief          Initialize a revoked-serial set (just makes it ready
+ *                 for use or for mbedtls_x509_crl_set_free())
+ *
+ * \param set      Revoked-serial set
+ */
+void mbedtls_x509_crl_set_init( mbedtls_x509_crl_set *set );
+
+/**
+ * \brief          Build the set from a parsed CRL chain
+ *
+ *                 Collects the serial numbers of every entry of every
+ *                 CRL in the chain into a fresh sorted array, with
+ *                 duplicates removed. Any previous contents of the set
+ *                 are replaced. The CRL can be freed afterwards.
+ *
+ * \param set      Revoked-serial set
+ * \param crl      Parsed CRL chain, as from mbedtls_x509_crl_parse()
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_X509_ALLOC_FAILED on memory failure, or
+ *                 MBEDTLS_ERR_X509_BAD_INPUT_DATA if an entry's serial
+ *                 number exceeds 20 octets
+ */
+int mbedtls_x509_crl_set_from_crl( mbedtls_x509_crl_set *set,
+                                   const mbedtls_x509_crl *crl );
+
+/**
+ * \brief          Apply a delta CRL to the set
+ *
+ *                 Merges the serial numbers revoked by \p delta into the
+ *                 set, keeping it sorted. Entry removal (the
+ *                 removeFromCRL reason code) is not supported, as entry
+ *                 reason codes are not parsed; rebuild the set from a
+ *                 full CRL to drop entries.
+ *
+ * \param set      Revoked-serial set
+ * \param delta    Parsed delta CRL chain
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_X509_ALLOC_FAILED on memory failure, or
+ *                 MBEDTLS_ERR_X509_BAD_INPUT_DATA if an entry's serial
+ *                 number exceeds 20 octets
+ */
+int mbedtls_x509_crl_set_apply( mbedtls_x509_crl_set *set,
+                                const mbedtls_x509_crl *delta );
+
+/**
+ * \brief          Attach a preprocessed record array to the set
+ *
+ *                 The buffer must hold records in the export format
+ *                 (see mbedtls_x509_crl_set_export()) and is used in
+ *                 place, without copying: it must remain valid and
+ *                 unchanged for the lifetime of the set, which makes it
+ *                 suitable for memory-mapped files. The set does not
+ *                 take ownership. Any previous contents are replaced.
+ *
+ * \param set      Revoked-serial set
+ * \param buf      Sorted record array
+ * \param buflen   Size of the buffer in bytes, a multiple of
+ *                 MBEDTLS_X509_CRL_SET_RECORD_SIZE
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_BAD_INPUT_DATA
+ *                 if the size is not a whole number of records or the
+ *                 records are not in strictly ascending order
+ */
+int mbedtls_x509_crl_set_setup_buf( mbedtls_x509_crl_set *set,
+                                    const unsigned char *buf, size_t buflen );
+
+/**
+ * \brief          Export the record array, for preprocessing to a file
+ *
+ * \param set      Revoked-serial set
+ * \param buf      Output buffer
+ * \param size     Size of the output buffer
+ * \param olen     On success, number of bytes written
+ *
+ * \return         0 if successful, or
+ *                 MBEDTLS_ERR_X509_BUFFER_TOO_SMALL
+ */
+int mbedtls_x509_crl_set_export( const mbedtls_x509_crl_set *set,
+                                 unsigned char *buf, size_t size,
+                                 size_t *olen );
+
+/**
+ * \brief          Look up a serial number
+ *
+ * \param set      Revoked-serial set
+ * \param serial   Serial number, raw big-endian as in
+ *                 mbedtls_x509_crt.serial
+ *
+ * \return         1 if the serial is in the set, 0 otherwise
+ */
+int mbedtls_x509_crl_set_is_revoked( const mbedtls_x509_crl_set *set,
+                                     const mbedtls_x509_buf *serial );
+
+/**
+ * \brief          Check a certificate against the set
+ *
+ * \param set      Revoked-serial set
+ * \param crt      Certificate to check
+ *
+ * \return         MBEDTLS_X509_BADCERT_REVOKED if the certificate's
+ *                 serial is in the set, 0 otherwise
+ */
+int mbedtls_x509_crl_set_check_crt( const mbedtls_x509_crl_set *set,
+                                    const mbedtls_x509_crt *crt );
+
+/**
+ * \brief          Number of serials in the set
+ *
+ * \param set      Revoked-serial set
+ *
+ * \return         The number of records
+ */
+size_t mbedtls_x509_crl_set_len( const mbedtls_x509_crl_set *set );
+
+/**
+ * \brief          Free the set (attached buffers are not freed)
+ *
+ * \param set      Revoked-serial set
+ */
+void mbedtls_x509_crl_set_free( mbedtls_x509_crl_set *set );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_crl_set.h */
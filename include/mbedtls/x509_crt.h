@@ -83,6 +83,24 @@ typedef struct mbedtls_x509_crt
 
     mbedtls_x509_sequence ext_key_usage; /**< Optional list of extended key usage OIDs. */
 
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+    mbedtls_x509_buf san_raw;   /**< Raw subjectAltName extension data, parsed on first use. */
+    mbedtls_x509_buf eku_raw;   /**< Raw extendedKeyUsage extension data, parsed on first use. */
+#endif
+
+#if defined(MBEDTLS_X509_CRT_ARENA)
+    mbedtls_x509_arena arena;   /**< Backing store for this certificate's name and sequence nodes, freed in one go. */
+#endif
+
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+    void *host_table;           /**< Normalized, sorted hostname table, built on first hostname check. */
+#endif
+
+#if defined(MBEDTLS_X509_DN_CACHE)
+    char *subject_dn;           /**< The subject in printable form, rendered once at parse. */
+    char *issuer_dn;            /**< The issuer in printable form, rendered once at parse. */
+#endif
+
     unsigned char ns_cert_type; /**< Optional Netscape certificate type extension value: See the values in x509.h */
 
     mbedtls_x509_buf sig;               /**< Signature: hash of the tbs part signed with the private key. */
@@ -91,6 +109,12 @@ typedef struct mbedtls_x509_crt
     void *sig_opts;             /**< Signature options to be passed to mbedtls_pk_verify_ext(), e.g. for RSASSA-PSS */
 
     struct mbedtls_x509_crt *next;     /**< Next certificate in the CA-chain. */
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    void *cache_entry;          /**< Set when this is a shared copy handed out
+                                     by a certificate cache: the parsed data
+                                     belongs to the cache (see x509_crt_cache.h). */
+#endif
 }
 mbedtls_x509_crt;
 
@@ -136,6 +160,10 @@ typedef struct mbedtls_x509write_cert
     char not_before[MBEDTLS_X509_RFC5280_UTC_TIME_LEN + 1];
     char not_after[MBEDTLS_X509_RFC5280_UTC_TIME_LEN + 1];
     mbedtls_asn1_named_data *extensions;
+    unsigned char *tbs_tail;    /**< cached encoding of the SubjectPublicKeyInfo
+                                     and extensions, reused across batch
+                                     issuance; reset by the related setters */
+    size_t tbs_tail_len;        /**< length of tbs_tail                       */
 }
 mbedtls_x509write_cert;
 
@@ -219,6 +247,43 @@ int mbedtls_x509_crt_parse_file( mbedtls_x509_crt *chain, const char *path );
 int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path );
 #endif /* MBEDTLS_FS_IO */
 
+/**
+ * \name Packed certificate bundle format
+ *
+ * A packed bundle is one flat image, built offline by programs/util/crt_pack
+ * from a directory of certificates: an 8-byte magic, a 32-bit big-endian
+ * certificate count, then one 12-byte index record per certificate (32-bit
+ * big-endian offset from the start of the image, DER length, and subject
+ * name hash as computed by mbedtls_x509_trust_name_hash()), followed by the
+ * raw DER bodies. Loading it needs no per-file I/O, PEM armor scanning or
+ * base64 work, and the image may come straight from a memory mapping.
+ * \{
+ */
+#define MBEDTLS_X509_PACKED_MAGIC       "CRTPACK1"
+#define MBEDTLS_X509_PACKED_MAGIC_LEN   8
+#define MBEDTLS_X509_PACKED_HEADER_LEN  12  /**< magic + certificate count  */
+#define MBEDTLS_X509_PACKED_ENTRY_LEN   12  /**< offset + length + hash     */
+/* \} name Packed certificate bundle format */
+
+/**
+ * \brief          Load every certificate from a packed bundle image and
+ *                 add them to the chained list. Parses permissively: if
+ *                 some certificates can be parsed, the result is the
+ *                 number of failed certificates. The image is copied
+ *                 from, not referenced, and may be released afterwards.
+ *
+ * \param chain    points to the start of the chain
+ * \param buf      packed bundle image
+ * \param buflen   size of the image in bytes
+ *
+ * \return         0 if all certificates parsed successfully, a positive
+ *                 number if partly successful,
+ *                 MBEDTLS_ERR_X509_BAD_INPUT_DATA if the image is
+ *                 malformed, or a specific X509 error code
+ */
+int mbedtls_x509_crt_parse_packed( mbedtls_x509_crt *chain,
+                                   const unsigned char *buf, size_t buflen );
+
 /**
  * \brief          Returns an informational string about the
  *                 certificate.
@@ -234,6 +299,32 @@ int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path );
 int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
                    const mbedtls_x509_crt *crt );
 
+#if defined(MBEDTLS_X509_DN_CACHE)
+/**
+ * \brief          Get the subject name in printable form, rendered once
+ *                 when the certificate was parsed
+ *
+ * \param crt      The X509 certificate
+ *
+ * \return         The cached string, valid until the certificate is
+ *                 freed, or NULL if it could not be rendered (truncation
+ *                 or allocation failure at parse time); fall back to
+ *                 mbedtls_x509_dn_gets() in that case
+ */
+const char *mbedtls_x509_crt_subject_dn( const mbedtls_x509_crt *crt );
+
+/**
+ * \brief          Get the issuer name in printable form, rendered once
+ *                 when the certificate was parsed
+ *
+ * \param crt      The X509 certificate
+ *
+ * \return         The cached string, or NULL as for
+ *                 mbedtls_x509_crt_subject_dn()
+ */
+const char *mbedtls_x509_crt_issuer_dn( const mbedtls_x509_crt *crt );
+#endif /* MBEDTLS_X509_DN_CACHE */
+
 /**
  * \brief          Returns an informational string about the
  *                 verification status of a certificate.
@@ -330,6 +421,113 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
                      int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
                      void *p_vrfy );
 
+#if defined(MBEDTLS_X509_TRUST_C)
+/* Defined in x509_trust.h */
+struct mbedtls_x509_trust;
+
+/**
+ * \brief          Verify the certificate signature, like
+ *                 \c mbedtls_x509_crt_verify_with_profile(), but looking
+ *                 up issuers in an indexed trust store instead of walking
+ *                 a linked list of CAs
+ *
+ * \param crt      a certificate to be verified
+ * \param trust    indexed trust store (see x509_trust.h)
+ * \param ca_crl   the CRL chain for trusted CA's
+ * \param profile  security profile for verification
+ * \param cn       expected Common Name (can be set to
+ *                 NULL if the CN must not be verified)
+ * \param flags    result of the verification
+ * \param f_vrfy   verification function
+ * \param p_vrfy   verification parameter
+ *
+ * \return         See \c mbedtls_x509_crt_verify_with_profile()
+ */
+int mbedtls_x509_crt_verify_trust( mbedtls_x509_crt *crt,
+                     const struct mbedtls_x509_trust *trust,
+                     mbedtls_x509_crl *ca_crl,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags,
+                     int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
+                     void *p_vrfy );
+#endif /* MBEDTLS_X509_TRUST_C */
+
+/**
+ * \brief          One deferred signature check of a chain verification.
+ *
+ *                 The executor's submit callback receives tasks of this
+ *                 type. It must arrange for \c task->f_run( task ) to be
+ *                 called exactly once, from any thread; all other fields
+ *                 are private to the library. Tasks are only valid until
+ *                 the verification call that created them returns.
+ */
+typedef struct mbedtls_x509_verify_task mbedtls_x509_verify_task;
+struct mbedtls_x509_verify_task
+{
+    void (*f_run)( mbedtls_x509_verify_task *task );    /*!< runs the check */
+
+    /* The remaining fields are private to the library */
+    mbedtls_pk_type_t sig_pk;           /*!< signature algorithm        */
+    void *sig_opts;                     /*!< signature options          */
+    mbedtls_pk_context *parent_pk;      /*!< key to check against       */
+    mbedtls_md_type_t sig_md;           /*!< hash algorithm             */
+    unsigned char hash[MBEDTLS_MD_MAX_SIZE];    /*!< hash of the signed data */
+    size_t hash_len;                    /*!< length of the hash         */
+    const unsigned char *sig;           /*!< signature to check         */
+    size_t sig_len;                     /*!< length of the signature    */
+    int result;                         /*!< outcome, written by f_run  */
+    mbedtls_x509_verify_task *next;     /*!< list of pending tasks      */
+};
+
+/**
+ * \brief          A caller-provided executor for deferred signature
+ *                 checks: a thread pool, some offload hardware, or
+ *                 anything else that can run independent tasks.
+ *
+ *                 f_submit() takes ownership of a task until it has run;
+ *                 f_wait() must not return before every submitted task's
+ *                 \c f_run has been called. Either may return a negative
+ *                 error to abort the verification.
+ */
+typedef struct
+{
+    int (*f_submit)( void *p_ctx, mbedtls_x509_verify_task *task );
+    int (*f_wait)( void *p_ctx );
+    void *p_ctx;                        /*!< passed to both callbacks   */
+}
+mbedtls_x509_verify_executor;
+
+/**
+ * \brief          Verify a certificate chain, like
+ *                 \c mbedtls_x509_crt_verify_with_profile(), but handing
+ *                 the signature checks between chain links to \p executor
+ *                 as independent tasks, so a deep chain verifies with as
+ *                 much parallelism as it has links.
+ *
+ *                 The check of the top of the chain against the trusted
+ *                 CAs stays inline, since its outcome decides which CA
+ *                 candidate is the issuer. No verification callback can
+ *                 be used: the final flags are only known once all
+ *                 deferred checks have completed.
+ *
+ * \param crt      a certificate to be verified
+ * \param trust_ca the trusted CA chain
+ * \param ca_crl   the CRL chain for trusted CA's
+ * \param profile  security profile for verification
+ * \param cn       expected Common Name (can be set to
+ *                 NULL if the CN must not be verified)
+ * \param flags    result of the verification
+ * \param executor executor the deferred checks are submitted to
+ *
+ * \return         See \c mbedtls_x509_crt_verify_with_profile()
+ */
+int mbedtls_x509_crt_verify_pipelined( mbedtls_x509_crt *crt,
+                     mbedtls_x509_crt *trust_ca,
+                     mbedtls_x509_crl *ca_crl,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags,
+                     const mbedtls_x509_verify_executor *executor );
+
 #if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
 /**
  * \brief          Check usage of certificate against keyUsage extension.
@@ -374,6 +572,45 @@ int mbedtls_x509_crt_check_extended_key_usage( const mbedtls_x509_crt *crt,
                                        size_t usage_len );
 #endif /* MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE) */
 
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+/**
+ * \brief          Parse the deferred extensions of a certificate
+ *
+ *                 With MBEDTLS_X509_CRT_LAZY_EXTENSIONS, parsing records
+ *                 the raw subjectAltName and extendedKeyUsage extension
+ *                 data without building the lists. The library calls this
+ *                 where it needs them; applications that walk
+ *                 crt->subject_alt_names or crt->ext_key_usage directly
+ *                 must call it first. Safe to call repeatedly.
+ *
+ * \param crt      The certificate to materialize
+ *
+ * \return         0 if successful, or a specific X509 error if an
+ *                 extension turns out to be malformed (which eager
+ *                 parsing would have reported at parse time)
+ */
+int mbedtls_x509_crt_materialize_exts( mbedtls_x509_crt *crt );
+#endif /* MBEDTLS_X509_CRT_LAZY_EXTENSIONS */
+
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+/**
+ * \brief          Build the certificate's normalized hostname table
+ *
+ *                 Collects the names the certificate is valid for
+ *                 (subjectAltName entries, or CN attributes when there
+ *                 is no SAN) into a lowercased, sorted table, so that
+ *                 hostname verification is a binary search instead of a
+ *                 case-folding list walk. Called automatically on the
+ *                 first hostname check; safe to call repeatedly.
+ *
+ * \param crt      The certificate to index
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ *                 (verification then falls back to the list walk)
+ */
+int mbedtls_x509_crt_build_host_table( mbedtls_x509_crt *crt );
+#endif /* MBEDTLS_X509_CRT_HOST_TABLE */
+
 #if defined(MBEDTLS_X509_CRL_PARSE_C)
 /**
  * \brief          Verify the certificate revocation status
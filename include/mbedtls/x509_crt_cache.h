@@ -0,0 +1,174 @@
+/**
+ * \file x509_crt_cache.h
+ *
+ * \brief Process-wide cache of parsed certificates, keyed by DER digest
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_X509_CRT_CACHE_H
+#define MBEDTLS_X509_CRT_CACHE_H
+
+#include "x509_crt.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "threading.h"
+#endif
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_X509_CRT_CACHE_DEFAULT_BUCKETS
+#define MBEDTLS_X509_CRT_CACHE_DEFAULT_BUCKETS      256 /**< Hash buckets, should be a power of two */
+#endif
+
+#ifndef MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES
+#define MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES 4096 /**< Distinct certificates kept */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   One cached certificate (opaque to the application)
+ */
+typedef struct mbedtls_x509_crt_cache_entry
+{
+    unsigned char digest[32];           /*!< SHA-256 of the raw DER       */
+    mbedtls_x509_crt crt;               /*!< the shared parsed form       */
+    uint32_t ref_count;                 /*!< live shared copies           */
+    struct mbedtls_x509_crt_cache_entry *chain; /*!< next in hash bucket  */
+    struct mbedtls_x509_crt_cache *cache;       /*!< owning cache         */
+}
+mbedtls_x509_crt_cache_entry;
+
+/**
+ * \brief   Cache mapping raw DER certificates to their parsed form
+ *
+ *          Peers present the same few intermediate CAs over and over;
+ *          parsing such a certificate allocates dozens of ASN.1 nodes
+ *          every time. This cache parses each distinct certificate once,
+ *          keyed by a SHA-256 digest of the raw DER, and hands out
+ *          reference-counted shared copies: a hit costs one digest, one
+ *          hash lookup and one struct copy. Shared copies are released
+ *          through the normal mbedtls_x509_crt_free() and must be
+ *          treated as read-only.
+ *
+ *          When the cache is full and every entry is in use, requests
+ *          fall back to a private parse, so certificate processing never
+ *          fails because of the cache.
+ */
+typedef struct mbedtls_x509_crt_cache
+{
+    mbedtls_x509_crt_cache_entry **buckets; /*!< hash table               */
+    size_t bucket_count;                /*!< number of buckets            */
+    size_t max_entries;                 /*!< entries kept before eviction */
+    size_t count;                       /*!< current number of entries    */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex                        */
+#endif
+}
+mbedtls_x509_crt_cache;
+
+/**
+ * \brief          Initialize a certificate cache (just makes it ready for
+ *                 mbedtls_x509_crt_cache_setup() or
+ *                 mbedtls_x509_crt_cache_free())
+ *
+ * \param cache    Certificate cache
+ */
+void mbedtls_x509_crt_cache_init( mbedtls_x509_crt_cache *cache );
+
+/**
+ * \brief          Allocate the hash table
+ *
+ * \param cache    Certificate cache
+ * \param buckets  Number of hash buckets, or 0 for
+ *                 MBEDTLS_X509_CRT_CACHE_DEFAULT_BUCKETS
+ * \param max_entries  Number of distinct certificates kept before
+ *                 unused ones are evicted, or 0 for
+ *                 MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ */
+int mbedtls_x509_crt_cache_setup( mbedtls_x509_crt_cache *cache,
+                                  size_t buckets, size_t max_entries );
+
+/**
+ * \brief          Append the parsed form of a DER certificate to a chain,
+ *                 sharing it through the cache
+ *
+ *                 Drop-in replacement for mbedtls_x509_crt_parse_der():
+ *                 on a cache hit the chain gets a shared copy of the
+ *                 already parsed certificate instead of a fresh parse.
+ *                 The copy is released by mbedtls_x509_crt_free() on the
+ *                 chain as usual, and must not be modified.
+ *
+ * \param cache    Certificate cache
+ * \param chain    Chain to append to (initialized by the caller)
+ * \param buf      Raw DER certificate
+ * \param buflen   Length of the DER data
+ *
+ * \return         0 if successful, or a X509 or PEM error code as
+ *                 mbedtls_x509_crt_parse_der() would return
+ */
+int mbedtls_x509_crt_cache_parse_der( mbedtls_x509_crt_cache *cache,
+                                      mbedtls_x509_crt *chain,
+                                      const unsigned char *buf,
+                                      size_t buflen );
+
+/**
+ * \brief          Release a shared copy (called by mbedtls_x509_crt_free(),
+ *                 not meant for direct use)
+ *
+ * \param cache_entry  The entry the copy was attached to
+ */
+void mbedtls_x509_crt_cache_release( void *cache_entry );
+
+/**
+ * \brief          Current number of cached certificates, for cache sizing
+ *
+ * \param cache    Certificate cache
+ *
+ * \return         The number of entries in the cache
+ */
+size_t mbedtls_x509_crt_cache_len( const mbedtls_x509_crt_cache *cache );
+
+/**
+ * \brief          Free the cache and every certificate it holds
+ *
+ *                 Must only be called once all shared copies handed out
+ *                 by this cache have been freed.
+ *
+ * \param cache    Certificate cache
+ */
+void mbedtls_x509_crt_cache_free( mbedtls_x509_crt_cache *cache );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_crt_cache.h */
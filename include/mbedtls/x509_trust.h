@@ -0,0 +1,211 @@
+/**
+ * \file x509_trust.h
+ *
+ * \brief Indexed trust store for fast issuer lookup in large CA bundles
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_X509_TRUST_H
+#define MBEDTLS_X509_TRUST_H
+
+#include "x509_crt.h"
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_X509_TRUST_DEFAULT_BUCKETS
+#define MBEDTLS_X509_TRUST_DEFAULT_BUCKETS  128 /**< Hash buckets, should be a power of two */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   One indexed CA certificate
+ */
+typedef struct mbedtls_x509_trust_entry
+{
+    mbedtls_x509_crt *ca;               /*!< the CA, parsed on demand and
+                                             NULL until then for entries
+                                             from a packed bundle         */
+    uint32_t hash;                      /*!< hash of the CA's subject DN  */
+    const unsigned char *der;           /*!< raw DER in the packed image,
+                                             NULL for indexed lists       */
+    size_t der_len;                     /*!< length of the raw DER        */
+    mbedtls_x509_crt *parsed;           /*!< lazily parsed form, owned    */
+    struct mbedtls_x509_trust_entry *chain; /*!< next in hash bucket      */
+}
+mbedtls_x509_trust_entry;
+
+/**
+ * \brief   Hash index over the subject names of a set of trusted CAs
+ *
+ *          Verifying against a large CA bundle (a few hundred roots) with
+ *          the plain linked list means comparing the issuer name of the
+ *          chain's top against every CA's subject in turn. This index
+ *          hashes each CA by its subject DN so that candidate issuers are
+ *          found in O(1); the verifier still runs the full parent checks
+ *          on each candidate, so hash collisions only cost time, never
+ *          correctness. The hash folds letter case and the
+ *          UTF8String/PrintableString distinction the same way the name
+ *          comparison does, so no valid issuer is missed.
+ *
+ *          The index only points at the caller's certificate list; the
+ *          list must outlive the trust store and not be modified while
+ *          indexed.
+ */
+typedef struct mbedtls_x509_trust
+{
+    mbedtls_x509_trust_entry **buckets; /*!< hash table                   */
+    size_t bucket_count;                /*!< number of buckets            */
+    size_t count;                       /*!< number of indexed CAs        */
+}
+mbedtls_x509_trust;
+
+/**
+ * \brief          Initialize a trust store (just makes it ready for
+ *                 mbedtls_x509_trust_setup() or mbedtls_x509_trust_free())
+ *
+ * \param trust    Trust store
+ */
+void mbedtls_x509_trust_init( mbedtls_x509_trust *trust );
+
+/**
+ * \brief          Allocate the hash table
+ *
+ * \param trust    Trust store
+ * \param buckets  Number of hash buckets, or 0 for
+ *                 MBEDTLS_X509_TRUST_DEFAULT_BUCKETS
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ */
+int mbedtls_x509_trust_setup( mbedtls_x509_trust *trust, size_t buckets );
+
+/**
+ * \brief          Index every certificate in a CA list
+ *
+ *                 May be called more than once to combine several lists.
+ *                 The certificates are referenced, not copied: the list
+ *                 must remain valid and unchanged for the lifetime of the
+ *                 trust store.
+ *
+ * \param trust    Trust store
+ * \param ca_list  Chain of trusted CAs, as passed to
+ *                 mbedtls_x509_crt_verify()
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ */
+int mbedtls_x509_trust_add( mbedtls_x509_trust *trust,
+                            mbedtls_x509_crt *ca_list );
+
+/**
+ * \brief          Index a packed certificate bundle, parsing lazily
+ *
+ *                 Adds one entry per certificate in the image, using the
+ *                 subject hashes prebuilt by the packing tool; a
+ *                 certificate's DER is only parsed the first time its
+ *                 hash is matched by mbedtls_x509_trust_find(), so CAs
+ *                 that never issue a presented chain are never parsed.
+ *                 The image is referenced, not copied (it may be a
+ *                 memory mapping): it must remain valid and unchanged
+ *                 for the lifetime of the trust store. Parsed forms are
+ *                 owned by the store and released by
+ *                 mbedtls_x509_trust_free().
+ *
+ * \note           Lazy parsing mutates the store: if packed entries are
+ *                 present, concurrent calls to mbedtls_x509_trust_find()
+ *                 must be serialized by the caller.
+ *
+ * \param trust    Trust store
+ * \param image    Packed bundle image (see x509_crt.h for the format)
+ * \param imglen   Size of the image in bytes
+ *
+ * \return         0 if successful,
+ *                 MBEDTLS_ERR_X509_BAD_INPUT_DATA if the image is
+ *                 malformed or the store is not set up, or
+ *                 MBEDTLS_ERR_X509_ALLOC_FAILED
+ */
+int mbedtls_x509_trust_attach_packed( mbedtls_x509_trust *trust,
+                                      const unsigned char *image,
+                                      size_t imglen );
+
+/**
+ * \brief          Hash an X.509 name the way the trust store indexes it
+ *
+ *                 Folds letter case and the UTF8String/PrintableString
+ *                 tag distinction, like the verifier's name comparison.
+ *                 Exposed for the bundle packing tool, which stores the
+ *                 hash of each certificate's subject in the image.
+ *
+ * \param name     Parsed X.509 name
+ *
+ * \return         The 32-bit subject name hash
+ */
+uint32_t mbedtls_x509_trust_name_hash( const mbedtls_x509_name *name );
+
+/**
+ * \brief          Find candidate issuers for a name
+ *
+ *                 Returns entries whose subject hash matches the given
+ *                 name; the caller is expected to confirm each candidate
+ *                 with a full comparison (as x509_crt_check_parent()
+ *                 does during verification).
+ *
+ * \param trust    Trust store
+ * \param issuer   Issuer name to look up (e.g. \c &crt->issuer)
+ * \param prev     NULL to get the first candidate, or the previous
+ *                 return value to get the next one
+ *
+ * \return         The next candidate entry, or NULL when there are no more
+ */
+const mbedtls_x509_trust_entry *mbedtls_x509_trust_find(
+                                    const mbedtls_x509_trust *trust,
+                                    const mbedtls_x509_name *issuer,
+                                    const mbedtls_x509_trust_entry *prev );
+
+/**
+ * \brief          Current number of indexed certificates
+ *
+ * \param trust    Trust store
+ *
+ * \return         The number of entries in the index
+ */
+size_t mbedtls_x509_trust_len( const mbedtls_x509_trust *trust );
+
+/**
+ * \brief          Free the index and any lazily parsed certificates it
+ *                 owns (never the caller's indexed lists)
+ *
+ * \param trust    Trust store
+ */
+void mbedtls_x509_trust_free( mbedtls_x509_trust *trust );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_trust.h */
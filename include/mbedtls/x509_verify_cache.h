@@ -0,0 +1,222 @@
+/**
+ * \file x509_verify_cache.h
+ *
+ * \brief Memoization of certificate chain verification results
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef MBEDTLS_X509_VERIFY_CACHE_H
+#define MBEDTLS_X509_VERIFY_CACHE_H
+
+#include "x509_crt.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "threading.h"
+#endif
+
+#if defined(MBEDTLS_HAVE_TIME)
+#include <time.h>
+#endif
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#ifndef MBEDTLS_X509_VERIFY_CACHE_DEFAULT_TIMEOUT
+#define MBEDTLS_X509_VERIFY_CACHE_DEFAULT_TIMEOUT      300 /**< 5 min  */
+#endif
+
+#ifndef MBEDTLS_X509_VERIFY_CACHE_DEFAULT_BUCKETS
+#define MBEDTLS_X509_VERIFY_CACHE_DEFAULT_BUCKETS      256 /**< Hash buckets, should be a power of two */
+#endif
+
+#ifndef MBEDTLS_X509_VERIFY_CACHE_DEFAULT_MAX_ENTRIES
+#define MBEDTLS_X509_VERIFY_CACHE_DEFAULT_MAX_ENTRIES 4096 /**< Results kept */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief   One memoized verification result (opaque to the application)
+ */
+typedef struct mbedtls_x509_verify_cache_entry
+{
+    unsigned char key[32];              /*!< SHA-256 of chain, CN and
+                                             verification parameters     */
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t timestamp;                   /*!< time the result was stored  */
+#endif
+    int vrfy_ret;                       /*!< return code of the check    */
+    uint32_t flags;                     /*!< verification result flags   */
+    struct mbedtls_x509_verify_cache_entry *chain; /*!< next in bucket   */
+}
+mbedtls_x509_verify_cache_entry;
+
+/**
+ * \brief   Cache of certificate chain verification results
+ *
+ *          A mutual-TLS server sees the same few client chains over and
+ *          over; each verification repeats the full signature checks, an
+ *          entire RSA operation per certificate in the chain. This cache
+ *          memoizes the outcome keyed by a digest of the raw chain, the
+ *          expected name and the verification parameters, so a repeat
+ *          verification is a digest plus table hit. Entries expire after
+ *          a timeout, which bounds how long a result can outlive a
+ *          certificate becoming expired or revoked; pick the timeout
+ *          accordingly (and flush the cache when the trusted CAs or CRLs
+ *          are reloaded).
+ *
+ *          Verifications that use a verification callback must not be
+ *          cached, since the callback may inspect each certificate.
+ */
+typedef struct mbedtls_x509_verify_cache
+{
+    mbedtls_x509_verify_cache_entry **buckets; /*!< hash table           */
+    size_t bucket_count;                /*!< number of buckets           */
+    size_t max_entries;                 /*!< results kept before reuse   */
+    size_t count;                       /*!< current number of entries   */
+#if defined(MBEDTLS_HAVE_TIME)
+    uint32_t timeout;                   /*!< entry lifetime in seconds   */
+#endif
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< mutex                       */
+#endif
+}
+mbedtls_x509_verify_cache;
+
+/**
+ * \brief          Initialize a verification cache (just makes it ready
+ *                 for mbedtls_x509_verify_cache_setup() or
+ *                 mbedtls_x509_verify_cache_free())
+ *
+ * \param cache    Verification cache
+ */
+void mbedtls_x509_verify_cache_init( mbedtls_x509_verify_cache *cache );
+
+/**
+ * \brief          Allocate the hash table
+ *
+ * \param cache    Verification cache
+ * \param buckets  Number of hash buckets, or 0 for
+ *                 MBEDTLS_X509_VERIFY_CACHE_DEFAULT_BUCKETS
+ * \param max_entries  Number of results kept before old ones are reused,
+ *                 or 0 for MBEDTLS_X509_VERIFY_CACHE_DEFAULT_MAX_ENTRIES
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ */
+int mbedtls_x509_verify_cache_setup( mbedtls_x509_verify_cache *cache,
+                                     size_t buckets, size_t max_entries );
+
+#if defined(MBEDTLS_HAVE_TIME)
+/**
+ * \brief          Set the entry lifetime
+ *                 (Default: MBEDTLS_X509_VERIFY_CACHE_DEFAULT_TIMEOUT)
+ *
+ * \param cache    Verification cache
+ * \param timeout  Lifetime in seconds, 0 for no expiry (not recommended:
+ *                 results then survive certificate expiry indefinitely)
+ */
+void mbedtls_x509_verify_cache_set_timeout( mbedtls_x509_verify_cache *cache,
+                                            uint32_t timeout );
+#endif /* MBEDTLS_HAVE_TIME */
+
+/**
+ * \brief          Look up a memoized verification result
+ *
+ * \param cache    Verification cache
+ * \param chain    The certificate chain about to be verified
+ * \param cn       Expected Common Name passed to verification, or NULL
+ * \param authority  Pointer identifying the trusted CAs the result is
+ *                 valid against (e.g. the CA list or trust store the
+ *                 verification uses); compared by address only
+ * \param profile  Security profile used for verification
+ * \param vrfy_ret On a hit, set to the memoized verification return code
+ * \param flags    On a hit, set to the memoized verification flags
+ *
+ * \return         0 if a fresh result was found,
+ *                 1 on a miss (or an expired entry)
+ */
+int mbedtls_x509_verify_cache_lookup( mbedtls_x509_verify_cache *cache,
+                                      const mbedtls_x509_crt *chain,
+                                      const char *cn,
+                                      const void *authority,
+                                      const mbedtls_x509_crt_profile *profile,
+                                      int *vrfy_ret, uint32_t *flags );
+
+/**
+ * \brief          Memoize a verification result
+ *
+ *                 Only results obtained without a verification callback
+ *                 may be stored, since a later hit skips the callback.
+ *
+ * \param cache    Verification cache
+ * \param chain    The certificate chain that was verified
+ * \param cn       Expected Common Name passed to verification, or NULL
+ * \param authority  Same pointer as passed to the lookup
+ * \param profile  Security profile used for verification
+ * \param vrfy_ret Verification return code to memoize
+ * \param flags    Verification flags to memoize
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_X509_ALLOC_FAILED
+ *                 (the verification result itself is unaffected)
+ */
+int mbedtls_x509_verify_cache_store( mbedtls_x509_verify_cache *cache,
+                                     const mbedtls_x509_crt *chain,
+                                     const char *cn,
+                                     const void *authority,
+                                     const mbedtls_x509_crt_profile *profile,
+                                     int vrfy_ret, uint32_t flags );
+
+/**
+ * \brief          Drop every memoized result (for use when the trusted
+ *                 CAs or CRLs change)
+ *
+ * \param cache    Verification cache
+ */
+void mbedtls_x509_verify_cache_flush( mbedtls_x509_verify_cache *cache );
+
+/**
+ * \brief          Current number of memoized results
+ *
+ * \param cache    Verification cache
+ *
+ * \return         The number of entries in the cache
+ */
+size_t mbedtls_x509_verify_cache_len( const mbedtls_x509_verify_cache *cache );
+
+/**
+ * \brief          Free the cache
+ *
+ * \param cache    Verification cache
+ */
+void mbedtls_x509_verify_cache_free( mbedtls_x509_verify_cache *cache );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_verify_cache.h */
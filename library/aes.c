@@ -43,6 +43,12 @@
 #if defined(MBEDTLS_AESNI_C)
 #include "mbedtls/aesni.h"
 #endif
+#if defined(MBEDTLS_ARMCE_C)
+#include "mbedtls/armce.h"
+#endif
+#if defined(MBEDTLS_AESCT_C)
+#include "mbedtls/aesct.h"
+#endif
 
 #if defined(MBEDTLS_SELF_TEST)
 #if defined(MBEDTLS_PLATFORM_C)
@@ -55,39 +61,61 @@
 
 #if !defined(MBEDTLS_AES_ALT)
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
-
-/*
- * 32-bit integer manipulation macros (little endian)
- */
-#ifndef GET_UINT32_LE
-#define GET_UINT32_LE(n,b,i)                            \
-{                                                       \
-    (n) = ( (uint32_t) (b)[(i)    ]       )             \
-        | ( (uint32_t) (b)[(i) + 1] <<  8 )             \
-        | ( (uint32_t) (b)[(i) + 2] << 16 )             \
-        | ( (uint32_t) (b)[(i) + 3] << 24 );            \
-}
-#endif
+#include "mbedtls/constant_time.h"
 
-#ifndef PUT_UINT32_LE
-#define PUT_UINT32_LE(n,b,i)                                    \
-{                                                               \
-    (b)[(i)    ] = (unsigned char) ( ( (n)       ) & 0xFF );    \
-    (b)[(i) + 1] = (unsigned char) ( ( (n) >>  8 ) & 0xFF );    \
-    (b)[(i) + 2] = (unsigned char) ( ( (n) >> 16 ) & 0xFF );    \
-    (b)[(i) + 3] = (unsigned char) ( ( (n) >> 24 ) & 0xFF );    \
-}
-#endif
+#include "mbedtls/byte_order.h"
 
 #if defined(MBEDTLS_PADLOCK_C) &&                      \
     ( defined(MBEDTLS_HAVE_X86) || defined(MBEDTLS_PADLOCK_ALIGN16) )
 static int aes_padlock_ace = -1;
 #endif
 
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+/* CPU support detected once during key setup, then read directly in the
+ * per-block functions instead of calling mbedtls_aesni_has_support() */
+static int aes_aesni = -1;
+#endif
+
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+/* Same caching scheme as aes_aesni above. The generic key schedules are
+ * kept: AESE/AESD consume the very same round keys (including the
+ * equivalent-inverse-cipher decryption schedule). */
+static int aes_armce = -1;
+#endif
+
+#if ( defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64) ) || \
+    defined(MBEDTLS_AESCT_C)
+#define MBEDTLS_AES_HAVE_ECB_X4
+
+#if defined(MBEDTLS_AESCT_C)
+#define aes_have_ecb_x4()   1
+#else
+#define aes_have_ecb_x4()   ( aes_aesni > 0 )
+#endif
+
+/*
+ * Four-block ECB helper for the parallel modes: AES-NI when available at
+ * runtime, otherwise the bitsliced implementation, which needs the
+ * parallelism just as much to amortize its fixed cost.
+ */
+static void aes_crypt_ecb_x4( mbedtls_aes_context *ctx,
+                              int mode,
+                              const unsigned char input[64],
+                              unsigned char output[64] )
+{
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( aes_aesni > 0 )
+    {
+        mbedtls_aesni_crypt_ecb_x4( ctx, mode, input, output );
+        return;
+    }
+#endif
+#if defined(MBEDTLS_AESCT_C)
+    mbedtls_aesct_crypt_ecb_x4( ctx, mode, input, output );
+#endif
+}
+#endif /* MBEDTLS_AES_HAVE_ECB_X4 */
+
 #if defined(MBEDTLS_AES_ROM_TABLES)
 /*
  * Forward S-box
@@ -516,10 +544,18 @@ int mbedtls_aes_setkey_enc( mbedtls_aes_context *ctx, const unsigned char *key,
     ctx->rk = RK = ctx->buf;
 
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
-    if( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) )
+    if( aes_aesni == -1 )
+        aes_aesni = mbedtls_aesni_has_support( MBEDTLS_AESNI_AES );
+
+    if( aes_aesni )
         return( mbedtls_aesni_setkey_enc( (unsigned char *) ctx->rk, key, keybits ) );
 #endif
 
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( aes_armce == -1 )
+        aes_armce = mbedtls_armce_has_support( MBEDTLS_ARMCE_AES );
+#endif
+
     for( i = 0; i < ( keybits >> 5 ); i++ )
     {
         GET_UINT32_LE( RK[i], key, i << 2 );
@@ -616,21 +652,38 @@ int mbedtls_aes_setkey_dec( mbedtls_aes_context *ctx, const unsigned char *key,
 #endif
     ctx->rk = RK = ctx->buf;
 
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( aes_aesni == -1 )
+        aes_aesni = mbedtls_aesni_has_support( MBEDTLS_AESNI_AES );
+
+    if( aes_aesni )
+    {
+        switch( keybits )
+        {
+            case 128: ctx->nr = 10; break;
+            case 192: ctx->nr = 12; break;
+            case 256: ctx->nr = 14; break;
+            default : return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
+        }
+
+        /* Build and invert the schedule without going through the
+         * table-based generic expansion */
+        return( mbedtls_aesni_setkey_dec( (unsigned char *) ctx->rk,
+                                          key, keybits ) );
+    }
+#endif
+
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( aes_armce == -1 )
+        aes_armce = mbedtls_armce_has_support( MBEDTLS_ARMCE_AES );
+#endif
+
     /* Also checks keybits */
     if( ( ret = mbedtls_aes_setkey_enc( &cty, key, keybits ) ) != 0 )
         goto exit;
 
     ctx->nr = cty.nr;
 
-#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
-    if( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) )
-    {
-        mbedtls_aesni_inverse_key( (unsigned char *) ctx->rk,
-                           (const unsigned char *) cty.rk, ctx->nr );
-        goto exit;
-    }
-#endif
-
     SK = cty.rk + cty.nr * 4;
 
     *RK++ = *SK++;
@@ -661,6 +714,80 @@ exit:
 }
 #endif /* !MBEDTLS_AES_SETKEY_DEC_ALT */
 
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+void mbedtls_aes_xts_init( mbedtls_aes_xts_context *ctx )
+{
+    mbedtls_aes_init( &ctx->crypt );
+    mbedtls_aes_init( &ctx->tweak );
+}
+
+void mbedtls_aes_xts_free( mbedtls_aes_xts_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_aes_free( &ctx->crypt );
+    mbedtls_aes_free( &ctx->tweak );
+}
+
+/*
+ * Split the double-length XTS key into the data and tweak halves
+ */
+static int aes_xts_decode_keys( const unsigned char *key, unsigned int keybits,
+                                const unsigned char **key1, const unsigned char **key2,
+                                unsigned int *key1bits )
+{
+    switch( keybits )
+    {
+        case 256: *key1bits = 128; break;
+        case 512: *key1bits = 256; break;
+        default : return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
+    }
+
+    *key1 = key;
+    *key2 = key + ( keybits >> 4 );
+
+    return( 0 );
+}
+
+int mbedtls_aes_xts_setkey_enc( mbedtls_aes_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits )
+{
+    int ret;
+    const unsigned char *key1, *key2;
+    unsigned int key1bits;
+
+    if( ( ret = aes_xts_decode_keys( key, keybits, &key1, &key2,
+                                     &key1bits ) ) != 0 )
+        return( ret );
+
+    if( ( ret = mbedtls_aes_setkey_enc( &ctx->tweak, key2, key1bits ) ) != 0 )
+        return( ret );
+
+    return( mbedtls_aes_setkey_enc( &ctx->crypt, key1, key1bits ) );
+}
+
+int mbedtls_aes_xts_setkey_dec( mbedtls_aes_xts_context *ctx,
+                                const unsigned char *key,
+                                unsigned int keybits )
+{
+    int ret;
+    const unsigned char *key1, *key2;
+    unsigned int key1bits;
+
+    if( ( ret = aes_xts_decode_keys( key, keybits, &key1, &key2,
+                                     &key1bits ) ) != 0 )
+        return( ret );
+
+    /* The tweak is always encrypted, even when decrypting the data */
+    if( ( ret = mbedtls_aes_setkey_enc( &ctx->tweak, key2, key1bits ) ) != 0 )
+        return( ret );
+
+    return( mbedtls_aes_setkey_dec( &ctx->crypt, key1, key1bits ) );
+}
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
 #define AES_FROUND(X0,X1,X2,X3,Y0,Y1,Y2,Y3)     \
 {                                               \
     X0 = *RK++ ^ FT0[ ( Y0       ) & 0xFF ] ^   \
@@ -830,10 +957,17 @@ int mbedtls_aes_crypt_ecb( mbedtls_aes_context *ctx,
                     unsigned char output[16] )
 {
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
-    if( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) )
+    /* aes_aesni was set when the key schedule was built */
+    if( aes_aesni > 0 )
         return( mbedtls_aesni_crypt_ecb( ctx, mode, input, output ) );
 #endif
 
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    /* aes_armce was set when the key schedule was built */
+    if( aes_armce > 0 )
+        return( mbedtls_armce_crypt_ecb( ctx, mode, input, output ) );
+#endif
+
 #if defined(MBEDTLS_PADLOCK_C) && defined(MBEDTLS_HAVE_X86)
     if( aes_padlock_ace )
     {
@@ -846,10 +980,16 @@ int mbedtls_aes_crypt_ecb( mbedtls_aes_context *ctx,
     }
 #endif
 
+#if defined(MBEDTLS_AESCT_C)
+    /* No hardware engine took the block: use the bitsliced implementation
+     * rather than the cache-timing-leaky tables */
+    return( mbedtls_aesct_crypt_ecb( ctx, mode, input, output ) );
+#else
     if( mode == MBEDTLS_AES_ENCRYPT )
         mbedtls_aes_encrypt( ctx, input, output );
     else
         mbedtls_aes_decrypt( ctx, input, output );
+#endif /* MBEDTLS_AESCT_C */
 
     return( 0 );
 }
@@ -885,6 +1025,33 @@ int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
 
     if( mode == MBEDTLS_AES_DECRYPT )
     {
+#if defined(MBEDTLS_AES_HAVE_ECB_X4)
+        /* In CBC decryption the blocks are independent, so four of them
+         * can be pushed through the four-block ECB path at once */
+        if( aes_have_ecb_x4() )
+        {
+            unsigned char temp4[64];
+
+            while( length >= 64 )
+            {
+                /* Save the ciphertext first to support in-place operation */
+                memcpy( temp4, input, 64 );
+                aes_crypt_ecb_x4( ctx, mode, input, output );
+
+                for( i = 0; i < 16; i++ )
+                    output[i] = (unsigned char)( output[i] ^ iv[i] );
+                for( i = 0; i < 48; i++ )
+                    output[16 + i] = (unsigned char)( output[16 + i] ^ temp4[i] );
+
+                memcpy( iv, temp4 + 48, 16 );
+
+                input  += 64;
+                output += 64;
+                length -= 64;
+            }
+        }
+#endif
+
         while( length > 0 )
         {
             memcpy( temp, input, 16 );
@@ -920,6 +1087,145 @@ int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
 }
 #endif /* MBEDTLS_CIPHER_MODE_CBC */
 
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+/*
+ * Multiplication by x in GF(2^128) on a little-endian tweak,
+ * as defined by IEEE P1619
+ */
+static void mbedtls_gf128mul_x_ble( unsigned char r[16],
+                                    const unsigned char x[16] )
+{
+    uint32_t x0, x1, x2, x3, carry;
+
+    GET_UINT32_LE( x0, x,  0 );
+    GET_UINT32_LE( x1, x,  4 );
+    GET_UINT32_LE( x2, x,  8 );
+    GET_UINT32_LE( x3, x, 12 );
+
+    carry = x3 >> 31;
+
+    PUT_UINT32_LE( ( x0 << 1 ) ^ ( 0x87 * carry ),     r,  0 );
+    PUT_UINT32_LE( ( x1 << 1 ) | ( x0 >> 31 ),         r,  4 );
+    PUT_UINT32_LE( ( x2 << 1 ) | ( x1 >> 31 ),         r,  8 );
+    PUT_UINT32_LE( ( x3 << 1 ) | ( x2 >> 31 ),         r, 12 );
+}
+
+/*
+ * AES-XTS buffer encryption/decryption
+ */
+int mbedtls_aes_crypt_xts( mbedtls_aes_xts_context *ctx,
+                           int mode,
+                           size_t length,
+                           const unsigned char data_unit[16],
+                           const unsigned char *input,
+                           unsigned char *output )
+{
+    size_t i;
+    size_t blocks = length / 16;
+    size_t leftover = length % 16;
+    unsigned char tweak[16];
+    unsigned char prev_tweak[16];
+    unsigned char tmp[16];
+
+    /* Data units must be at least one block long and, per NIST SP 800-38E,
+     * no longer than 2^20 blocks */
+    if( length < 16 )
+        return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
+
+    if( length > ( 1 << 20 ) * (size_t) 16 )
+        return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
+
+    /* Compute the tweak by encrypting the data unit number */
+    mbedtls_aes_crypt_ecb( &ctx->tweak, MBEDTLS_AES_ENCRYPT,
+                           data_unit, tweak );
+
+#if defined(MBEDTLS_AES_HAVE_ECB_X4)
+    /* The blocks of a data unit are independent, so four of them can be
+     * pushed through the four-block ECB path at once. When decrypting with
+     * a partial last block, leave the last full block to the scalar loop
+     * below since it needs the next-to-last tweak. */
+    if( aes_have_ecb_x4() )
+    {
+        size_t limit = ( leftover != 0 && mode == MBEDTLS_AES_DECRYPT ) ? 1 : 0;
+        unsigned char tw4[64];
+        unsigned char tmp4[64];
+
+        while( blocks >= 4 + limit )
+        {
+            memcpy( tw4, tweak, 16 );
+            mbedtls_gf128mul_x_ble( tw4 + 16, tw4      );
+            mbedtls_gf128mul_x_ble( tw4 + 32, tw4 + 16 );
+            mbedtls_gf128mul_x_ble( tw4 + 48, tw4 + 32 );
+
+            for( i = 0; i < 64; i++ )
+                tmp4[i] = (unsigned char)( input[i] ^ tw4[i] );
+
+            aes_crypt_ecb_x4( &ctx->crypt, mode, tmp4, tmp4 );
+
+            for( i = 0; i < 64; i++ )
+                output[i] = (unsigned char)( tmp4[i] ^ tw4[i] );
+
+            mbedtls_gf128mul_x_ble( tweak, tw4 + 48 );
+
+            input  += 64;
+            output += 64;
+            blocks -= 4;
+        }
+    }
+#endif
+
+    while( blocks-- )
+    {
+        if( leftover != 0 && mode == MBEDTLS_AES_DECRYPT && blocks == 0 )
+        {
+            /* We are on the last full block and a partial block follows:
+             * the last full block uses the next tweak and the partial
+             * block uses this one (ciphertext stealing) */
+            memcpy( prev_tweak, tweak, 16 );
+            mbedtls_gf128mul_x_ble( tweak, tweak );
+        }
+
+        for( i = 0; i < 16; i++ )
+            tmp[i] = (unsigned char)( input[i] ^ tweak[i] );
+
+        mbedtls_aes_crypt_ecb( &ctx->crypt, mode, tmp, tmp );
+
+        for( i = 0; i < 16; i++ )
+            output[i] = (unsigned char)( tmp[i] ^ tweak[i] );
+
+        mbedtls_gf128mul_x_ble( tweak, tweak );
+
+        input  += 16;
+        output += 16;
+    }
+
+    if( leftover != 0 )
+    {
+        /* Ciphertext stealing: the final partial block steals the tail of
+         * the previous block of output */
+        unsigned char *t = ( mode == MBEDTLS_AES_ENCRYPT ) ? tweak : prev_tweak;
+        unsigned char *prev_output = output - 16;
+
+        for( i = 0; i < leftover; i++ )
+        {
+            tmp[i] = (unsigned char)( input[i] ^ t[i] );
+            output[i] = prev_output[i];
+            prev_output[i] = tmp[i];
+        }
+
+        for( ; i < 16; i++ )
+            prev_output[i] = (unsigned char)( prev_output[i] ^ t[i] );
+
+        mbedtls_aes_crypt_ecb( &ctx->crypt, mode, prev_output, prev_output );
+
+        for( i = 0; i < 16; i++ )
+            prev_output[i] = (unsigned char)( prev_output[i] ^ t[i] );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
 #if defined(MBEDTLS_CIPHER_MODE_CFB)
 /*
  * AES-CFB128 buffer encryption/decryption
@@ -1015,6 +1321,37 @@ int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
     int c, i;
     size_t n = *nc_off;
 
+#if defined(MBEDTLS_AES_HAVE_ECB_X4)
+    /* The keystream blocks are independent: generate four at a time
+     * through the four-block ECB path while we are block-aligned */
+    if( aes_have_ecb_x4() && n == 0 )
+    {
+        unsigned char ctr4[64];
+        size_t j;
+
+        while( length >= 64 )
+        {
+            for( j = 0; j < 4; j++ )
+            {
+                memcpy( ctr4 + j * 16, nonce_counter, 16 );
+
+                for( i = 16; i > 0; i-- )
+                    if( ++nonce_counter[i - 1] != 0 )
+                        break;
+            }
+
+            aes_crypt_ecb_x4( ctx, MBEDTLS_AES_ENCRYPT, ctr4, ctr4 );
+
+            for( j = 0; j < 64; j++ )
+                output[j] = (unsigned char)( input[j] ^ ctr4[j] );
+
+            input  += 64;
+            output += 64;
+            length -= 64;
+        }
+    }
+#endif
+
     while( length-- )
     {
         if( n == 0 ) {
@@ -43,6 +43,8 @@
 
 #if defined(MBEDTLS_HAVE_X86_64)
 
+#include "mbedtls/constant_time.h"
+
 /*
  * AES-NI support detection routine
  */
@@ -89,6 +91,10 @@ int mbedtls_aesni_has_support( unsigned int what )
 #define xmm0_xmm4   "0xE0"
 #define xmm1_xmm0   "0xC1"
 #define xmm1_xmm2   "0xD1"
+#define xmm4_xmm0   "0xC4"
+#define xmm4_xmm1   "0xCC"
+#define xmm4_xmm2   "0xD4"
+#define xmm4_xmm3   "0xDC"
 
 /*
  * AES-NI AES-ECB block en(de)cryption
@@ -135,6 +141,76 @@ int mbedtls_aesni_crypt_ecb( mbedtls_aes_context *ctx,
     return( 0 );
 }
 
+/*
+ * AES-NI AES-ECB en(de)cryption of four independent blocks.
+ *
+ * The AESENC/AESDEC latency is several cycles but the units are pipelined,
+ * so interleaving independent blocks keeps them busy. Four blocks is enough
+ * to cover the latency on every micro-architecture we care about while
+ * leaving the register usage modest.
+ */
+int mbedtls_aesni_crypt_ecb_x4( mbedtls_aes_context *ctx,
+                     int mode,
+                     const unsigned char input[64],
+                     unsigned char output[64] )
+{
+    asm( "movdqu    (%3), %%xmm0    \n\t" // load the four input blocks
+         "movdqu  16(%3), %%xmm1    \n\t"
+         "movdqu  32(%3), %%xmm2    \n\t"
+         "movdqu  48(%3), %%xmm3    \n\t"
+         "movdqu    (%1), %%xmm4    \n\t" // load round key 0
+         "pxor      %%xmm4, %%xmm0  \n\t" // round 0
+         "pxor      %%xmm4, %%xmm1  \n\t"
+         "pxor      %%xmm4, %%xmm2  \n\t"
+         "pxor      %%xmm4, %%xmm3  \n\t"
+         "addq      $16, %1         \n\t" // point to next round key
+         "subl      $1, %0          \n\t" // normal rounds = nr - 1
+         "test      %2, %2          \n\t" // mode?
+         "jz        2f              \n\t" // 0 = decrypt
+
+         "1:                        \n\t" // encryption loop
+         "movdqu    (%1), %%xmm4    \n\t" // load round key
+         AESENC     xmm4_xmm0      "\n\t" // do round on each block
+         AESENC     xmm4_xmm1      "\n\t"
+         AESENC     xmm4_xmm2      "\n\t"
+         AESENC     xmm4_xmm3      "\n\t"
+         "addq      $16, %1         \n\t" // point to next round key
+         "subl      $1, %0          \n\t" // loop
+         "jnz       1b              \n\t"
+         "movdqu    (%1), %%xmm4    \n\t" // load round key
+         AESENCLAST xmm4_xmm0      "\n\t" // last round
+         AESENCLAST xmm4_xmm1      "\n\t"
+         AESENCLAST xmm4_xmm2      "\n\t"
+         AESENCLAST xmm4_xmm3      "\n\t"
+         "jmp       3f              \n\t"
+
+         "2:                        \n\t" // decryption loop
+         "movdqu    (%1), %%xmm4    \n\t"
+         AESDEC     xmm4_xmm0      "\n\t" // do round on each block
+         AESDEC     xmm4_xmm1      "\n\t"
+         AESDEC     xmm4_xmm2      "\n\t"
+         AESDEC     xmm4_xmm3      "\n\t"
+         "addq      $16, %1         \n\t"
+         "subl      $1, %0          \n\t"
+         "jnz       2b              \n\t"
+         "movdqu    (%1), %%xmm4    \n\t" // load round key
+         AESDECLAST xmm4_xmm0      "\n\t" // last round
+         AESDECLAST xmm4_xmm1      "\n\t"
+         AESDECLAST xmm4_xmm2      "\n\t"
+         AESDECLAST xmm4_xmm3      "\n\t"
+
+         "3:                        \n\t"
+         "movdqu    %%xmm0, (%4)    \n\t" // export the four output blocks
+         "movdqu    %%xmm1, 16(%4)  \n\t"
+         "movdqu    %%xmm2, 32(%4)  \n\t"
+         "movdqu    %%xmm3, 48(%4)  \n\t"
+         :
+         : "r" (ctx->nr), "r" (ctx->rk), "r" (mode), "r" (input), "r" (output)
+         : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4" );
+
+    return( 0 );
+}
+
 /*
  * GCM multiplication: c = a times b in GF(2^128)
  * Based on [CLMUL-WP] algorithms 1 (with equation 27) and 5.
@@ -247,6 +323,141 @@ void mbedtls_aesni_gcm_mult( unsigned char c[16],
     return;
 }
 
+/*
+ * One unreduced carry-less multiplication, XORed into the xmm7:xmm6
+ * accumulator: same multiply step as in mbedtls_aesni_gcm_mult() above,
+ * reading the operands at byte offset "off" of %0 and %1.
+ */
+#define GCM_MULT_ACC(off)                                                   \
+         "movdqu " off "(%0), %%xmm0        \n\t" /* a1:a0              */  \
+         "movdqu " off "(%1), %%xmm1        \n\t" /* b1:b0              */  \
+         "movdqa %%xmm1, %%xmm2             \n\t"                           \
+         "movdqa %%xmm1, %%xmm3             \n\t"                           \
+         "movdqa %%xmm1, %%xmm4             \n\t"                           \
+         PCLMULQDQ xmm0_xmm1 ",0x00         \n\t" /* a0*b0 = c1:c0      */  \
+         PCLMULQDQ xmm0_xmm2 ",0x11         \n\t" /* a1*b1 = d1:d0      */  \
+         PCLMULQDQ xmm0_xmm3 ",0x10         \n\t" /* a0*b1 = e1:e0      */  \
+         PCLMULQDQ xmm0_xmm4 ",0x01         \n\t" /* a1*b0 = f1:f0      */  \
+         "pxor %%xmm3, %%xmm4               \n\t" /* e1+f1:e0+f0        */  \
+         "movdqa %%xmm4, %%xmm3             \n\t"                           \
+         "psrldq $8, %%xmm4                 \n\t" /* 0:e1+f1            */  \
+         "pslldq $8, %%xmm3                 \n\t" /* e0+f0:0            */  \
+         "pxor %%xmm4, %%xmm2               \n\t" /* r3:r2              */  \
+         "pxor %%xmm3, %%xmm1               \n\t" /* r1:r0              */  \
+         "pxor %%xmm1, %%xmm6               \n\t" /* acc low            */  \
+         "pxor %%xmm2, %%xmm7               \n\t" /* acc high           */
+
+/*
+ * GCM multiplication with aggregated reduction:
+ *     x = ( x + c0 ) * h^4 + c1 * h^3 + c2 * h^2 + c3 * h
+ * where h holds the four powers of H, highest first and byte-reversed
+ * (as prepared by gcm_gen_table()), and c holds four input blocks.
+ *
+ * Shifting and reduction modulo the GCM polynomial are linear, so the
+ * four unreduced 256-bit products can be XORed together and the shift
+ * and reduction steps of [CLMUL-WP] run once on the sum, instead of
+ * once per block ([CLMUL-WP] section 4, aggregated reduction).
+ */
+void mbedtls_aesni_gcm_mult4( unsigned char x[16],
+                     const unsigned char h[64],
+                     const unsigned char c[64] )
+{
+    unsigned char aa[64], cc[16];
+    size_t i;
+
+    /*
+     * Byte-reverse each input block, folding the current state into the
+     * first one; h is already byte-reversed in storage.
+     */
+    for( i = 0; i < 16; i++ )
+        aa[i] = x[15 - i] ^ c[15 - i];
+    for( i = 16; i < 64; i++ )
+        aa[i] = c[( i & ~(size_t) 15 ) + 15 - ( i & 15 )];
+
+    asm( "pxor %%xmm6, %%xmm6               \n\t" // accumulator low
+         "pxor %%xmm7, %%xmm7               \n\t" // accumulator high
+
+         GCM_MULT_ACC( "0" )
+         GCM_MULT_ACC( "16" )
+         GCM_MULT_ACC( "32" )
+         GCM_MULT_ACC( "48" )
+
+         "movdqa %%xmm6, %%xmm1             \n\t" // r1:r0
+         "movdqa %%xmm7, %%xmm2             \n\t" // r3:r2
+
+         /*
+          * Now shift the result one bit to the left,
+          * taking advantage of [CLMUL-WP] eq 27 (p. 20)
+          */
+         "movdqa %%xmm1, %%xmm3             \n\t" // r1:r0
+         "movdqa %%xmm2, %%xmm4             \n\t" // r3:r2
+         "psllq $1, %%xmm1                  \n\t" // r1<<1:r0<<1
+         "psllq $1, %%xmm2                  \n\t" // r3<<1:r2<<1
+         "psrlq $63, %%xmm3                 \n\t" // r1>>63:r0>>63
+         "psrlq $63, %%xmm4                 \n\t" // r3>>63:r2>>63
+         "movdqa %%xmm3, %%xmm5             \n\t" // r1>>63:r0>>63
+         "pslldq $8, %%xmm3                 \n\t" // r0>>63:0
+         "pslldq $8, %%xmm4                 \n\t" // r2>>63:0
+         "psrldq $8, %%xmm5                 \n\t" // 0:r1>>63
+         "por %%xmm3, %%xmm1                \n\t" // r1<<1|r0>>63:r0<<1
+         "por %%xmm4, %%xmm2                \n\t" // r3<<1|r2>>62:r2<<1
+         "por %%xmm5, %%xmm2                \n\t" // r3<<1|r2>>62:r2<<1|r1>>63
+
+         /*
+          * Now reduce modulo the GCM polynomial x^128 + x^7 + x^2 + x + 1
+          * using [CLMUL-WP] algorithm 5 (p. 20).
+          * Currently xmm2:xmm1 holds x3:x2:x1:x0 (already shifted).
+          */
+         /* Step 2 (1) */
+         "movdqa %%xmm1, %%xmm3             \n\t" // x1:x0
+         "movdqa %%xmm1, %%xmm4             \n\t" // same
+         "movdqa %%xmm1, %%xmm5             \n\t" // same
+         "psllq $63, %%xmm3                 \n\t" // x1<<63:x0<<63 = stuff:a
+         "psllq $62, %%xmm4                 \n\t" // x1<<62:x0<<62 = stuff:b
+         "psllq $57, %%xmm5                 \n\t" // x1<<57:x0<<57 = stuff:c
+
+         /* Step 2 (2) */
+         "pxor %%xmm4, %%xmm3               \n\t" // stuff:a+b
+         "pxor %%xmm5, %%xmm3               \n\t" // stuff:a+b+c
+         "pslldq $8, %%xmm3                 \n\t" // a+b+c:0
+         "pxor %%xmm3, %%xmm1               \n\t" // x1+a+b+c:x0 = d:x0
+
+         /* Steps 3 and 4 */
+         "movdqa %%xmm1,%%xmm0              \n\t" // d:x0
+         "movdqa %%xmm1,%%xmm4              \n\t" // same
+         "movdqa %%xmm1,%%xmm5              \n\t" // same
+         "psrlq $1, %%xmm0                  \n\t" // e1:x0>>1 = e1:e0'
+         "psrlq $2, %%xmm4                  \n\t" // f1:x0>>2 = f1:f0'
+         "psrlq $7, %%xmm5                  \n\t" // g1:x0>>7 = g1:g0'
+         "pxor %%xmm4, %%xmm0               \n\t" // e1+f1:e0'+f0'
+         "pxor %%xmm5, %%xmm0               \n\t" // e1+f1+g1:e0'+f0'+g0'
+         // get the missing bits carried from d back in, as above
+         "movdqa %%xmm1,%%xmm3              \n\t" // d:x0
+         "movdqa %%xmm1,%%xmm4              \n\t" // same
+         "movdqa %%xmm1,%%xmm5              \n\t" // same
+         "psllq $63, %%xmm3                 \n\t" // d<<63:stuff
+         "psllq $62, %%xmm4                 \n\t" // d<<62:stuff
+         "psllq $57, %%xmm5                 \n\t" // d<<57:stuff
+         "pxor %%xmm4, %%xmm3               \n\t" // d<<63+d<<62:stuff
+         "pxor %%xmm5, %%xmm3               \n\t" // missing bits of d:stuff
+         "psrldq $8, %%xmm3                 \n\t" // 0:missing bits of d
+         "pxor %%xmm3, %%xmm0               \n\t" // e1+f1+g1:e0+f0+g0
+         "pxor %%xmm1, %%xmm0               \n\t" // h1:h0
+         "pxor %%xmm2, %%xmm0               \n\t" // x3+h1:x2+h0
+
+         "movdqu %%xmm0, (%2)               \n\t" // done
+         :
+         : "r" (aa), "r" (h), "r" (cc)
+         : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+           "xmm5", "xmm6", "xmm7" );
+
+    /* Now byte-reverse the output */
+    for( i = 0; i < 16; i++ )
+        x[i] = cc[15 - i];
+
+    return;
+}
+
 /*
  * Compute decryption round keys from encryption round keys
  */
@@ -275,48 +486,48 @@ void mbedtls_aesni_inverse_key( unsigned char *invkey,
 static void aesni_setkey_enc_128( unsigned char *rk,
                                   const unsigned char *key )
 {
-    asm( "movdqu (%1), %%xmm0               \n\t" // copy the original key
-         "movdqu %%xmm0, (%0)               \n\t" // as round key 0
-         "jmp 2f                            \n\t" // skip auxiliary routine
-
-         /*
-          * Finish generating the next round key.
-          *
-          * On entry xmm0 is r3:r2:r1:r0 and xmm1 is X:stuff:stuff:stuff
-          * with X = rot( sub( r3 ) ) ^ RCON.
-          *
-          * On exit, xmm0 is r7:r6:r5:r4
-          * with r4 = X + r0, r5 = r4 + r1, r6 = r5 + r2, r7 = r6 + r3
-          * and those are written to the round key buffer.
-          */
-         "1:                                \n\t"
-         "pshufd $0xff, %%xmm1, %%xmm1      \n\t" // X:X:X:X
-         "pxor %%xmm0, %%xmm1               \n\t" // X+r3:X+r2:X+r1:r4
-         "pslldq $4, %%xmm0                 \n\t" // r2:r1:r0:0
-         "pxor %%xmm0, %%xmm1               \n\t" // X+r3+r2:X+r2+r1:r5:r4
-         "pslldq $4, %%xmm0                 \n\t" // etc
-         "pxor %%xmm0, %%xmm1               \n\t"
-         "pslldq $4, %%xmm0                 \n\t"
-         "pxor %%xmm1, %%xmm0               \n\t" // update xmm0 for next time!
-         "add $16, %0                       \n\t" // point to next round key
-         "movdqu %%xmm0, (%0)               \n\t" // write it
-         "ret                               \n\t"
-
-         /* Main "loop" */
-         "2:                                \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x01        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x02        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x04        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x08        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x10        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x20        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x40        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x80        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x1B        \n\tcall 1b \n\t"
-         AESKEYGENA xmm0_xmm1 ",0x36        \n\tcall 1b \n\t"
-         :
-         : "r" (rk), "r" (key)
-         : "memory", "cc", "0" );
+    asm volatile( "movdqu (%1), %%xmm0               \n\t" // copy the original key
+                  "movdqu %%xmm0, (%0)               \n\t" // as round key 0
+                  "jmp 2f                            \n\t" // skip auxiliary routine
+
+                  /*
+                   * Finish generating the next round key.
+                   *
+                   * On entry xmm0 is r3:r2:r1:r0 and xmm1 is X:stuff:stuff:stuff
+                   * with X = rot( sub( r3 ) ) ^ RCON.
+                   *
+                   * On exit, xmm0 is r7:r6:r5:r4
+                   * with r4 = X + r0, r5 = r4 + r1, r6 = r5 + r2, r7 = r6 + r3
+                   * and those are written to the round key buffer.
+                   */
+                  "1:                                \n\t"
+                  "pshufd $0xff, %%xmm1, %%xmm1      \n\t" // X:X:X:X
+                  "pxor %%xmm0, %%xmm1               \n\t" // X+r3:X+r2:X+r1:r4
+                  "pslldq $4, %%xmm0                 \n\t" // r2:r1:r0:0
+                  "pxor %%xmm0, %%xmm1               \n\t" // X+r3+r2:X+r2+r1:r5:r4
+                  "pslldq $4, %%xmm0                 \n\t" // etc
+                  "pxor %%xmm0, %%xmm1               \n\t"
+                  "pslldq $4, %%xmm0                 \n\t"
+                  "pxor %%xmm1, %%xmm0               \n\t" // update xmm0 for next time!
+                  "add $16, %0                       \n\t" // point to next round key
+                  "movdqu %%xmm0, (%0)               \n\t" // write it
+                  "ret                               \n\t"
+
+                  /* Main "loop" */
+                  "2:                                \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x01        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x02        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x04        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x08        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x10        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x20        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x40        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x80        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x1B        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm0_xmm1 ",0x36        \n\tcall 1b \n\t"
+                  : "+r" (rk)
+                  : "r" (key)
+                  : "memory", "cc", "xmm0", "xmm1" );
 }
 
 /*
@@ -325,55 +536,55 @@ static void aesni_setkey_enc_128( unsigned char *rk,
 static void aesni_setkey_enc_192( unsigned char *rk,
                                   const unsigned char *key )
 {
-    asm( "movdqu (%1), %%xmm0   \n\t" // copy original round key
-         "movdqu %%xmm0, (%0)   \n\t"
-         "add $16, %0           \n\t"
-         "movq 16(%1), %%xmm1   \n\t"
-         "movq %%xmm1, (%0)     \n\t"
-         "add $8, %0            \n\t"
-         "jmp 2f                \n\t" // skip auxiliary routine
-
-         /*
-          * Finish generating the next 6 quarter-keys.
-          *
-          * On entry xmm0 is r3:r2:r1:r0, xmm1 is stuff:stuff:r5:r4
-          * and xmm2 is stuff:stuff:X:stuff with X = rot( sub( r3 ) ) ^ RCON.
-          *
-          * On exit, xmm0 is r9:r8:r7:r6 and xmm1 is stuff:stuff:r11:r10
-          * and those are written to the round key buffer.
-          */
-         "1:                            \n\t"
-         "pshufd $0x55, %%xmm2, %%xmm2  \n\t" // X:X:X:X
-         "pxor %%xmm0, %%xmm2           \n\t" // X+r3:X+r2:X+r1:r4
-         "pslldq $4, %%xmm0             \n\t" // etc
-         "pxor %%xmm0, %%xmm2           \n\t"
-         "pslldq $4, %%xmm0             \n\t"
-         "pxor %%xmm0, %%xmm2           \n\t"
-         "pslldq $4, %%xmm0             \n\t"
-         "pxor %%xmm2, %%xmm0           \n\t" // update xmm0 = r9:r8:r7:r6
-         "movdqu %%xmm0, (%0)           \n\t"
-         "add $16, %0                   \n\t"
-         "pshufd $0xff, %%xmm0, %%xmm2  \n\t" // r9:r9:r9:r9
-         "pxor %%xmm1, %%xmm2           \n\t" // stuff:stuff:r9+r5:r10
-         "pslldq $4, %%xmm1             \n\t" // r2:r1:r0:0
-         "pxor %%xmm2, %%xmm1           \n\t" // xmm1 = stuff:stuff:r11:r10
-         "movq %%xmm1, (%0)             \n\t"
-         "add $8, %0                    \n\t"
-         "ret                           \n\t"
-
-         "2:                            \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x01    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x02    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x04    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x08    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x10    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x20    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x40    \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x80    \n\tcall 1b \n\t"
-
-         :
-         : "r" (rk), "r" (key)
-         : "memory", "cc", "0" );
+    asm volatile( "movdqu (%1), %%xmm0   \n\t" // copy original round key
+                  "movdqu %%xmm0, (%0)   \n\t"
+                  "add $16, %0           \n\t"
+                  "movq 16(%1), %%xmm1   \n\t"
+                  "movq %%xmm1, (%0)     \n\t"
+                  "add $8, %0            \n\t"
+                  "jmp 2f                \n\t" // skip auxiliary routine
+
+                  /*
+                   * Finish generating the next 6 quarter-keys.
+                   *
+                   * On entry xmm0 is r3:r2:r1:r0, xmm1 is stuff:stuff:r5:r4
+                   * and xmm2 is stuff:stuff:X:stuff with X = rot( sub( r3 ) ) ^ RCON.
+                   *
+                   * On exit, xmm0 is r9:r8:r7:r6 and xmm1 is stuff:stuff:r11:r10
+                   * and those are written to the round key buffer.
+                   */
+                  "1:                            \n\t"
+                  "pshufd $0x55, %%xmm2, %%xmm2  \n\t" // X:X:X:X
+                  "pxor %%xmm0, %%xmm2           \n\t" // X+r3:X+r2:X+r1:r4
+                  "pslldq $4, %%xmm0             \n\t" // etc
+                  "pxor %%xmm0, %%xmm2           \n\t"
+                  "pslldq $4, %%xmm0             \n\t"
+                  "pxor %%xmm0, %%xmm2           \n\t"
+                  "pslldq $4, %%xmm0             \n\t"
+                  "pxor %%xmm2, %%xmm0           \n\t" // update xmm0 = r9:r8:r7:r6
+                  "movdqu %%xmm0, (%0)           \n\t"
+                  "add $16, %0                   \n\t"
+                  "pshufd $0xff, %%xmm0, %%xmm2  \n\t" // r9:r9:r9:r9
+                  "pxor %%xmm1, %%xmm2           \n\t" // stuff:stuff:r9+r5:r10
+                  "pslldq $4, %%xmm1             \n\t" // r2:r1:r0:0
+                  "pxor %%xmm2, %%xmm1           \n\t" // xmm1 = stuff:stuff:r11:r10
+                  "movq %%xmm1, (%0)             \n\t"
+                  "add $8, %0                    \n\t"
+                  "ret                           \n\t"
+
+                  "2:                            \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x01    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x02    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x04    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x08    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x10    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x20    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x40    \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x80    \n\tcall 1b \n\t"
+
+                  : "+r" (rk)
+                  : "r" (key)
+                  : "memory", "cc", "xmm0", "xmm1", "xmm2" );
 }
 
 /*
@@ -382,64 +593,64 @@ static void aesni_setkey_enc_192( unsigned char *rk,
 static void aesni_setkey_enc_256( unsigned char *rk,
                                   const unsigned char *key )
 {
-    asm( "movdqu (%1), %%xmm0           \n\t"
-         "movdqu %%xmm0, (%0)           \n\t"
-         "add $16, %0                   \n\t"
-         "movdqu 16(%1), %%xmm1         \n\t"
-         "movdqu %%xmm1, (%0)           \n\t"
-         "jmp 2f                        \n\t" // skip auxiliary routine
-
-         /*
-          * Finish generating the next two round keys.
-          *
-          * On entry xmm0 is r3:r2:r1:r0, xmm1 is r7:r6:r5:r4 and
-          * xmm2 is X:stuff:stuff:stuff with X = rot( sub( r7 )) ^ RCON
-          *
-          * On exit, xmm0 is r11:r10:r9:r8 and xmm1 is r15:r14:r13:r12
-          * and those have been written to the output buffer.
-          */
-         "1:                                \n\t"
-         "pshufd $0xff, %%xmm2, %%xmm2      \n\t"
-         "pxor %%xmm0, %%xmm2               \n\t"
-         "pslldq $4, %%xmm0                 \n\t"
-         "pxor %%xmm0, %%xmm2               \n\t"
-         "pslldq $4, %%xmm0                 \n\t"
-         "pxor %%xmm0, %%xmm2               \n\t"
-         "pslldq $4, %%xmm0                 \n\t"
-         "pxor %%xmm2, %%xmm0               \n\t"
-         "add $16, %0                       \n\t"
-         "movdqu %%xmm0, (%0)               \n\t"
-
-         /* Set xmm2 to stuff:Y:stuff:stuff with Y = subword( r11 )
-          * and proceed to generate next round key from there */
-         AESKEYGENA xmm0_xmm2 ",0x00        \n\t"
-         "pshufd $0xaa, %%xmm2, %%xmm2      \n\t"
-         "pxor %%xmm1, %%xmm2               \n\t"
-         "pslldq $4, %%xmm1                 \n\t"
-         "pxor %%xmm1, %%xmm2               \n\t"
-         "pslldq $4, %%xmm1                 \n\t"
-         "pxor %%xmm1, %%xmm2               \n\t"
-         "pslldq $4, %%xmm1                 \n\t"
-         "pxor %%xmm2, %%xmm1               \n\t"
-         "add $16, %0                       \n\t"
-         "movdqu %%xmm1, (%0)               \n\t"
-         "ret                               \n\t"
-
-         /*
-          * Main "loop" - Generating one more key than necessary,
-          * see definition of mbedtls_aes_context.buf
-          */
-         "2:                                \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x01        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x02        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x04        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x08        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x10        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x20        \n\tcall 1b \n\t"
-         AESKEYGENA xmm1_xmm2 ",0x40        \n\tcall 1b \n\t"
-         :
-         : "r" (rk), "r" (key)
-         : "memory", "cc", "0" );
+    asm volatile( "movdqu (%1), %%xmm0           \n\t"
+                  "movdqu %%xmm0, (%0)           \n\t"
+                  "add $16, %0                   \n\t"
+                  "movdqu 16(%1), %%xmm1         \n\t"
+                  "movdqu %%xmm1, (%0)           \n\t"
+                  "jmp 2f                        \n\t" // skip auxiliary routine
+
+                  /*
+                   * Finish generating the next two round keys.
+                   *
+                   * On entry xmm0 is r3:r2:r1:r0, xmm1 is r7:r6:r5:r4 and
+                   * xmm2 is X:stuff:stuff:stuff with X = rot( sub( r7 )) ^ RCON
+                   *
+                   * On exit, xmm0 is r11:r10:r9:r8 and xmm1 is r15:r14:r13:r12
+                   * and those have been written to the output buffer.
+                   */
+                  "1:                                \n\t"
+                  "pshufd $0xff, %%xmm2, %%xmm2      \n\t"
+                  "pxor %%xmm0, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm0                 \n\t"
+                  "pxor %%xmm0, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm0                 \n\t"
+                  "pxor %%xmm0, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm0                 \n\t"
+                  "pxor %%xmm2, %%xmm0               \n\t"
+                  "add $16, %0                       \n\t"
+                  "movdqu %%xmm0, (%0)               \n\t"
+
+                  /* Set xmm2 to stuff:Y:stuff:stuff with Y = subword( r11 )
+                   * and proceed to generate next round key from there */
+                  AESKEYGENA xmm0_xmm2 ",0x00        \n\t"
+                  "pshufd $0xaa, %%xmm2, %%xmm2      \n\t"
+                  "pxor %%xmm1, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm1                 \n\t"
+                  "pxor %%xmm1, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm1                 \n\t"
+                  "pxor %%xmm1, %%xmm2               \n\t"
+                  "pslldq $4, %%xmm1                 \n\t"
+                  "pxor %%xmm2, %%xmm1               \n\t"
+                  "add $16, %0                       \n\t"
+                  "movdqu %%xmm1, (%0)               \n\t"
+                  "ret                               \n\t"
+
+                  /*
+                   * Main "loop" - Generating one more key than necessary,
+                   * see definition of mbedtls_aes_context.buf
+                   */
+                  "2:                                \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x01        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x02        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x04        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x08        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x10        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x20        \n\tcall 1b \n\t"
+                  AESKEYGENA xmm1_xmm2 ",0x40        \n\tcall 1b \n\t"
+                  : "+r" (rk)
+                  : "r" (key)
+                  : "memory", "cc", "xmm0", "xmm1", "xmm2" );
 }
 
 /*
@@ -460,6 +671,35 @@ int mbedtls_aesni_setkey_enc( unsigned char *rk,
     return( 0 );
 }
 
+/*
+ * Key expansion for decryption: generate the encryption round keys with
+ * AESKEYGENASSIST into a stack buffer, then convert them with AESIMC.
+ * This avoids going through the table-based generic key schedule.
+ */
+int mbedtls_aesni_setkey_dec( unsigned char *rk,
+                      const unsigned char *key,
+                      size_t bits )
+{
+    int nr;
+    /* The 256-bit expansion writes one round key more than needed,
+     * see aesni_setkey_enc_256() and the definition of mbedtls_aes_context */
+    unsigned char fwd[ 16 * 16 ];
+
+    switch( bits )
+    {
+        case 128: nr = 10; aesni_setkey_enc_128( fwd, key ); break;
+        case 192: nr = 12; aesni_setkey_enc_192( fwd, key ); break;
+        case 256: nr = 14; aesni_setkey_enc_256( fwd, key ); break;
+        default : return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
+    }
+
+    mbedtls_aesni_inverse_key( rk, fwd, nr );
+
+    mbedtls_zeroize( fwd, sizeof( fwd ) );
+
+    return( 0 );
+}
+
 #endif /* MBEDTLS_HAVE_X86_64 */
 
 #endif /* MBEDTLS_AESNI_C */
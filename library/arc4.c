@@ -48,10 +48,7 @@
 
 #if !defined(MBEDTLS_ARC4_ALT)
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 void mbedtls_arc4_init( mbedtls_arc4_context *ctx )
 {
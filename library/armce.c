@@ -0,0 +1,269 @@
+/*
+ *  ARMv8-A Cryptography Extensions support functions
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * [ARMv8] Arm Architecture Reference Manual for A-profile architecture:
+ * AESE, AESD, AESMC, AESIMC, PMULL, PMULL2
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_ARMCE_C)
+
+#include "mbedtls/armce.h"
+
+#if defined(MBEDTLS_HAVE_ARM64)
+
+#if !defined(__ARM_FEATURE_CRYPTO)
+/*
+ * The intrinsics are gated behind +crypto; enable it locally so that the
+ * rest of the library can be built for plain armv8-a and still dispatch
+ * here at runtime when the CPU has the extensions.
+ */
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("crypto"))), \
+                              apply_to=function)
+#else
+#pragma GCC target ("arch=armv8-a+crypto")
+#endif
+#endif /* !__ARM_FEATURE_CRYPTO */
+
+#include <arm_neon.h>
+
+#if defined(__linux__)
+#include <sys/auxv.h>
+/* HWCAP_AES, HWCAP_PMULL and HWCAP_SHA2, from <asm/hwcap.h> */
+#define ARMCE_HWCAP_AES     ( 1UL << 3 )
+#define ARMCE_HWCAP_PMULL   ( 1UL << 4 )
+#define ARMCE_HWCAP_SHA2    ( 1UL << 6 )
+#endif
+
+/*
+ * ARMv8-CE features detection routine
+ */
+int mbedtls_armce_has_support( unsigned int what )
+{
+    static int done = 0;
+    static unsigned int c = 0;
+
+    if( ! done )
+    {
+#if defined(__linux__)
+        unsigned long hwcap = getauxval( AT_HWCAP );
+
+        if( hwcap & ARMCE_HWCAP_AES )
+            c |= MBEDTLS_ARMCE_AES;
+        if( hwcap & ARMCE_HWCAP_PMULL )
+            c |= MBEDTLS_ARMCE_PMULL;
+        if( hwcap & ARMCE_HWCAP_SHA2 )
+            c |= MBEDTLS_ARMCE_SHA2;
+#elif defined(__ARM_FEATURE_CRYPTO)
+        /* No runtime detection available: trust the compile target */
+        c = MBEDTLS_ARMCE_AES | MBEDTLS_ARMCE_PMULL | MBEDTLS_ARMCE_SHA2;
+#endif
+        done = 1;
+    }
+
+    return( ( c & what ) != 0 );
+}
+
+/*
+ * AES-ECB block en(de)cryption
+ */
+int mbedtls_armce_crypt_ecb( mbedtls_aes_context *ctx,
+                             int mode,
+                             const unsigned char input[16],
+                             unsigned char output[16] )
+{
+    int i;
+    const unsigned char *rk = (const unsigned char *) ctx->rk;
+    uint8x16_t block = vld1q_u8( input );
+
+    if( mode == MBEDTLS_AES_ENCRYPT )
+    {
+        for( i = 0; i < ctx->nr - 1; i++, rk += 16 )
+            block = vaesmcq_u8( vaeseq_u8( block, vld1q_u8( rk ) ) );
+
+        block = vaeseq_u8( block, vld1q_u8( rk ) );
+        block = veorq_u8( block, vld1q_u8( rk + 16 ) );
+    }
+    else
+    {
+        /*
+         * AESD computes InvShiftRows/InvSubBytes after adding the round
+         * key, so this flow wants the equivalent inverse cipher key
+         * schedule - which is exactly what mbedtls_aes_setkey_dec
+         * produces for the table-based path.
+         */
+        for( i = 0; i < ctx->nr - 1; i++, rk += 16 )
+            block = vaesimcq_u8( vaesdq_u8( block, vld1q_u8( rk ) ) );
+
+        block = vaesdq_u8( block, vld1q_u8( rk ) );
+        block = veorq_u8( block, vld1q_u8( rk + 16 ) );
+    }
+
+    vst1q_u8( output, block );
+
+    return( 0 );
+}
+
+/*
+ * Carry-less multiplication of the low, resp. high, 64-bit halves
+ */
+static inline uint64x2_t armce_pmull_lo( uint64x2_t a, uint64x2_t b )
+{
+    return( vreinterpretq_u64_p128(
+                vmull_p64( (poly64_t) vgetq_lane_u64( a, 0 ),
+                           (poly64_t) vgetq_lane_u64( b, 0 ) ) ) );
+}
+
+static inline uint64x2_t armce_pmull_hi( uint64x2_t a, uint64x2_t b )
+{
+    return( vreinterpretq_u64_p128(
+                vmull_high_p64( vreinterpretq_p64_u64( a ),
+                                vreinterpretq_p64_u64( b ) ) ) );
+}
+
+/*
+ * GCM multiplication: c = a * b in GF(2^128)
+ *
+ * GCM's bit order is the reverse of the polynomial representation PMULL
+ * expects, so both operands are bit-reflected on entry (VRBIT) and the
+ * result is reflected back on exit. In the reflected domain the modular
+ * reduction by x^128 + x^7 + x^2 + x + 1 becomes two multiplications of
+ * the high half by 0x87.
+ */
+void mbedtls_armce_gcm_mult( unsigned char c[16],
+                             const unsigned char a[16],
+                             const unsigned char b[16] )
+{
+    uint64x2_t A, B, Bs, l, m, h, u;
+    const uint64x2_t z = vdupq_n_u64( 0 );
+    const uint64x2_t R = vdupq_n_u64( 0x87 );
+
+    A = vreinterpretq_u64_u8( vrbitq_u8( vld1q_u8( a ) ) );
+    B = vreinterpretq_u64_u8( vrbitq_u8( vld1q_u8( b ) ) );
+
+    /* 128x128 -> 256 karatsuba-free schoolbook multiplication */
+    l = armce_pmull_lo( A, B );
+    h = armce_pmull_hi( A, B );
+    Bs = vextq_u64( B, B, 1 );
+    m = veorq_u64( armce_pmull_lo( A, Bs ), armce_pmull_hi( A, Bs ) );
+    l = veorq_u64( l, vextq_u64( z, m, 1 ) );
+    h = veorq_u64( h, vextq_u64( m, z, 1 ) );
+
+    /* Reduce the 256-bit product mod the (reflected) GCM polynomial */
+    l = veorq_u64( l, armce_pmull_lo( h, R ) );
+    u = armce_pmull_hi( h, R );
+    l = veorq_u64( l, vextq_u64( z, u, 1 ) );
+    l = veorq_u64( l, armce_pmull_hi( u, R ) );
+
+    vst1q_u8( c, vrbitq_u8( vreinterpretq_u8_u64( l ) ) );
+}
+
+static const uint32_t armce_sha256_k[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/*
+ * SHA-256 compression of one or more consecutive blocks
+ *
+ * SHA256H/SHA256H2 each perform four rounds on the {A,B,C,D} and
+ * {E,F,G,H} state halves; SHA256SU0/SHA256SU1 compute the message
+ * schedule four words at a time.
+ */
+void mbedtls_armce_sha256_process( uint32_t state[8],
+                                   const unsigned char *data,
+                                   size_t nblocks )
+{
+    uint32x4_t st0, st1, abcd, efgh, t, tmp;
+    uint32x4_t m[4];
+    int j;
+
+    st0 = vld1q_u32( state );
+    st1 = vld1q_u32( state + 4 );
+
+    while( nblocks-- > 0 )
+    {
+        abcd = st0;
+        efgh = st1;
+
+        m[0] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( data      ) ) );
+        m[1] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( data + 16 ) ) );
+        m[2] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( data + 32 ) ) );
+        m[3] = vreinterpretq_u32_u8( vrev32q_u8( vld1q_u8( data + 48 ) ) );
+
+        for( j = 0; j < 16; j++ )
+        {
+            t = vaddq_u32( m[j & 3], vld1q_u32( armce_sha256_k + 4 * j ) );
+
+            tmp = st0;
+            st0 = vsha256hq_u32( st0, st1, t );
+            st1 = vsha256h2q_u32( st1, tmp, t );
+
+            if( j < 12 )
+            {
+                /* W[t] for the step four rounds ahead:
+                 * sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16] */
+                m[j & 3] = vsha256su1q_u32(
+                    vsha256su0q_u32( m[j & 3], m[( j + 1 ) & 3] ),
+                    m[( j + 2 ) & 3], m[( j + 3 ) & 3] );
+            }
+        }
+
+        st0 = vaddq_u32( st0, abcd );
+        st1 = vaddq_u32( st1, efgh );
+
+        data += 64;
+    }
+
+    vst1q_u32( state,     st0 );
+    vst1q_u32( state + 4, st1 );
+}
+
+#if !defined(__ARM_FEATURE_CRYPTO) && defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif /* MBEDTLS_HAVE_ARM64 */
+
+#endif /* MBEDTLS_ARMCE_C */
@@ -44,10 +44,7 @@
 #define mbedtls_free       free
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * ASN.1 DER decoding routines
@@ -125,6 +122,113 @@ int mbedtls_asn1_get_tag( unsigned char **p,
     return( mbedtls_asn1_get_len( p, end, len ) );
 }
 
+/*
+ * Streamed parsing: the cursor walks DER delivered in chunks, buffering
+ * only a straddling tag-length header. Content bytes are served straight
+ * from the caller's chunks, so parsing a multi-MB document needs no
+ * contiguous copy of it.
+ */
+void mbedtls_asn1_stream_init( mbedtls_asn1_stream *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_asn1_stream ) );
+}
+
+void mbedtls_asn1_stream_feed( mbedtls_asn1_stream *ctx,
+                               const unsigned char *buf, size_t len )
+{
+    ctx->chunk = buf;
+    ctx->chunk_len = len;
+    ctx->chunk_off = 0;
+}
+
+int mbedtls_asn1_stream_get_tag( mbedtls_asn1_stream *ctx,
+                                 size_t *len, int tag )
+{
+    size_t i, need;
+
+    if( ctx->header_len < 1 )
+    {
+        if( ctx->chunk_off >= ctx->chunk_len )
+            return( MBEDTLS_ERR_ASN1_WANT_DATA );
+
+        ctx->header[0] = ctx->chunk[ctx->chunk_off++];
+        ctx->header_len = 1;
+    }
+
+    /* The buffered header survives a mismatch, so a different tag can be
+     * probed next - or the bytes reclaimed by mbedtls_asn1_stream_read() */
+    if( ctx->header[0] != tag )
+        return( MBEDTLS_ERR_ASN1_UNEXPECTED_TAG );
+
+    if( ctx->header_len < 2 )
+    {
+        if( ctx->chunk_off >= ctx->chunk_len )
+            return( MBEDTLS_ERR_ASN1_WANT_DATA );
+
+        ctx->header[1] = ctx->chunk[ctx->chunk_off++];
+        ctx->header_len = 2;
+    }
+
+    if( ( ctx->header[1] & 0x80 ) == 0 )
+    {
+        *len = ctx->header[1];
+        ctx->header_len = 0;
+
+        return( 0 );
+    }
+
+    /* Same length-of-length limits as mbedtls_asn1_get_len() */
+    need = ctx->header[1] & 0x7F;
+    if( need < 1 || need > 4 )
+        return( MBEDTLS_ERR_ASN1_INVALID_LENGTH );
+    need += 2;
+
+    while( ctx->header_len < need )
+    {
+        if( ctx->chunk_off >= ctx->chunk_len )
+            return( MBEDTLS_ERR_ASN1_WANT_DATA );
+
+        ctx->header[ctx->header_len++] = ctx->chunk[ctx->chunk_off++];
+    }
+
+    *len = 0;
+    for( i = 2; i < need; i++ )
+        *len = ( *len << 8 ) | ctx->header[i];
+
+    ctx->header_len = 0;
+
+    return( 0 );
+}
+
+size_t mbedtls_asn1_stream_read( mbedtls_asn1_stream *ctx,
+                                 unsigned char *buf, size_t buf_len )
+{
+    size_t n, total = 0;
+
+    /* Serve header bytes left behind by an unmatched get_tag first */
+    while( ctx->header_len > 0 && total < buf_len )
+    {
+        if( buf != NULL )
+            buf[total] = ctx->header[0];
+        total++;
+        ctx->header_len--;
+        memmove( ctx->header, ctx->header + 1, ctx->header_len );
+    }
+
+    n = ctx->chunk_len - ctx->chunk_off;
+    if( n > buf_len - total )
+        n = buf_len - total;
+
+    if( n > 0 )
+    {
+        if( buf != NULL )
+            memcpy( buf + total, ctx->chunk + ctx->chunk_off, n );
+        ctx->chunk_off += n;
+    }
+
+    return( total + n );
+}
+
 int mbedtls_asn1_get_bool( unsigned char **p,
                    const unsigned char *end,
                    int *val )
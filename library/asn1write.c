@@ -360,4 +360,82 @@ mbedtls_asn1_named_data *mbedtls_asn1_store_named_data( mbedtls_asn1_named_data
 
     return( cur );
 }
+
+/*
+ * Growable backwards writer
+ */
+#define ASN1_WRITER_DEFAULT_SIZE    1024
+
+#include "mbedtls/constant_time.h"
+
+void mbedtls_asn1_writer_init( mbedtls_asn1_writer *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_asn1_writer ) );
+}
+
+int mbedtls_asn1_writer_setup( mbedtls_asn1_writer *ctx, size_t size )
+{
+    if( size == 0 )
+        size = ASN1_WRITER_DEFAULT_SIZE;
+
+    if( ( ctx->buf = mbedtls_calloc( 1, size ) ) == NULL )
+        return( MBEDTLS_ERR_ASN1_ALLOC_FAILED );
+
+    ctx->size = size;
+    ctx->p = ctx->buf + size;
+
+    return( 0 );
+}
+
+int mbedtls_asn1_writer_grow( mbedtls_asn1_writer *ctx, size_t written )
+{
+    unsigned char *buf;
+    size_t size;
+
+    size = ctx->size != 0 ? ctx->size * 2 : ASN1_WRITER_DEFAULT_SIZE;
+    if( size < ctx->size )
+        return( MBEDTLS_ERR_ASN1_ALLOC_FAILED );
+
+    if( ( buf = mbedtls_calloc( 1, size ) ) == NULL )
+        return( MBEDTLS_ERR_ASN1_ALLOC_FAILED );
+
+    if( written > 0 )
+        memcpy( buf + size - written, ctx->buf + ctx->size - written, written );
+
+    if( ctx->buf != NULL )
+    {
+        mbedtls_zeroize( ctx->buf, ctx->size );
+        mbedtls_free( ctx->buf );
+    }
+
+    ctx->buf = buf;
+    ctx->size = size;
+    ctx->p = buf + size - written;
+
+    return( 0 );
+}
+
+void mbedtls_asn1_writer_reset( mbedtls_asn1_writer *ctx )
+{
+    if( ctx->buf != NULL )
+        mbedtls_zeroize( ctx->buf, ctx->size );
+
+    ctx->p = ctx->buf + ctx->size;
+}
+
+size_t mbedtls_asn1_writer_len( const mbedtls_asn1_writer *ctx )
+{
+    return( (size_t)( ctx->buf + ctx->size - ctx->p ) );
+}
+
+void mbedtls_asn1_writer_free( mbedtls_asn1_writer *ctx )
+{
+    if( ctx->buf != NULL )
+    {
+        mbedtls_zeroize( ctx->buf, ctx->size );
+        mbedtls_free( ctx->buf );
+    }
+
+    memset( ctx, 0, sizeof( mbedtls_asn1_writer ) );
+}
 #endif /* MBEDTLS_ASN1_WRITE_C */
@@ -143,18 +143,66 @@ int mbedtls_base64_decode( unsigned char *dst, size_t dlen, size_t *olen,
                    const unsigned char *src, size_t slen )
 {
     size_t i, n;
-    uint32_t j, x;
-    unsigned char *p;
-
-    /* First pass: check for validity and get output length */
-    for( i = n = j = 0; i < slen; i++ )
+    uint32_t j, x, g, gp, v0, v1, v2, v3;
+    unsigned char *p, *p_end;
+    int write_ok;
+
+    /*
+     * Single pass: validate, count and decode as we go. Sizing queries
+     * (dst == NULL, or dlen too small) still receive the exact output
+     * length, computed from the character count gathered by the same
+     * scan; decoded bytes already written by a failed call are partial
+     * output, as the caller asked for the data to be written there.
+     */
+    n = 0;          /* base64 characters seen, including padding     */
+    j = 0;          /* padding characters seen                       */
+    g = 0;          /* characters in the current group of four       */
+    gp = 0;         /* padding characters in the current group       */
+    x = 0;
+    p = dst;
+    p_end = ( dst != NULL ) ? dst + dlen : NULL;
+    write_ok = ( dst != NULL );
+
+    for( i = 0; i < slen; i++ )
     {
+        uint32_t spaces = 0;
+
+        /*
+         * Fast path: whole groups of plain base64 characters decode
+         * straight to three output bytes, a word at a time, without
+         * the per-character line structure checks
+         */
+        while( g == 0 && j == 0 && slen - i >= 4 &&
+               write_ok && p_end - p >= 3 )
+        {
+            if( ( src[i] | src[i + 1] | src[i + 2] | src[i + 3] ) > 127 )
+                break;
+
+            v0 = base64_dec_map[src[i]];
+            v1 = base64_dec_map[src[i + 1]];
+            v2 = base64_dec_map[src[i + 2]];
+            v3 = base64_dec_map[src[i + 3]];
+
+            if( ( v0 | v1 | v2 | v3 ) >= 64 )
+                break;
+
+            x = ( v0 << 18 ) | ( v1 << 12 ) | ( v2 << 6 ) | v3;
+            *p++ = (unsigned char)( x >> 16 );
+            *p++ = (unsigned char)( x >>  8 );
+            *p++ = (unsigned char)( x       );
+
+            n += 4;
+            i += 4;
+        }
+
+        if( i == slen )
+            break;
+
         /* Skip spaces before checking for EOL */
-        x = 0;
         while( i < slen && src[i] == ' ' )
         {
             ++i;
-            ++x;
+            ++spaces;
         }
 
         /* Spaces at end of buffer are OK */
@@ -169,7 +217,7 @@ int mbedtls_base64_decode( unsigned char *dst, size_t dlen, size_t *olen,
             continue;
 
         /* Space inside a line is an error */
-        if( x != 0 )
+        if( spaces != 0 )
             return( MBEDTLS_ERR_BASE64_INVALID_CHARACTER );
 
         if( src[i] == '=' && ++j > 2 )
@@ -182,6 +230,24 @@ int mbedtls_base64_decode( unsigned char *dst, size_t dlen, size_t *olen,
             return( MBEDTLS_ERR_BASE64_INVALID_CHARACTER );
 
         n++;
+
+        x   = ( x << 6 ) | ( base64_dec_map[src[i]] & 0x3F );
+        gp += ( base64_dec_map[src[i]] == 64 );
+
+        if( ++g == 4 )
+        {
+            g = 0;
+            if( write_ok && (size_t)( p_end - p ) >= (size_t)( 3 - gp ) )
+            {
+                if( gp < 3 ) *p++ = (unsigned char)( x >> 16 );
+                if( gp < 2 ) *p++ = (unsigned char)( x >>  8 );
+                if( gp < 1 ) *p++ = (unsigned char)( x       );
+            }
+            else
+                write_ok = 0;
+            gp = 0;
+            x = 0;
+        }
     }
 
     if( n == 0 )
@@ -196,23 +262,6 @@ int mbedtls_base64_decode( unsigned char *dst, size_t dlen, size_t *olen,
         return( MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL );
     }
 
-   for( j = 3, n = x = 0, p = dst; i > 0; i--, src++ )
-   {
-        if( *src == '\r' || *src == '\n' || *src == ' ' )
-            continue;
-
-        j -= ( base64_dec_map[*src] == 64 );
-        x  = ( x << 6 ) | ( base64_dec_map[*src] & 0x3F );
-
-        if( ++n == 4 )
-        {
-            n = 0;
-            if( j > 0 ) *p++ = (unsigned char)( x >> 16 );
-            if( j > 1 ) *p++ = (unsigned char)( x >>  8 );
-            if( j > 2 ) *p++ = (unsigned char)( x       );
-        }
-    }
-
     *olen = p - dst;
 
     return( 0 );
@@ -37,6 +37,11 @@
 
 #include "mbedtls/bignum.h"
 #include "mbedtls/bn_mul.h"
+#include "mbedtls/hints.h"
+
+#if defined(MBEDTLS_TIMING_TRACE)
+#include "mbedtls/timing.h"
+#endif
 
 #include <string.h>
 
@@ -50,10 +55,7 @@
 #define mbedtls_free       free
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 #define ciL    (sizeof(mbedtls_mpi_uint))         /* chars in limb  */
 #define biL    (ciL << 3)               /* bits  in limb  */
@@ -65,6 +67,27 @@ static void mbedtls_zeroize( void *v, size_t n ) {
 #define BITS_TO_LIMBS(i)  (((i) + biL - 1) / biL)
 #define CHARS_TO_LIMBS(i) (((i) + ciL - 1) / ciL)
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+#include "mbedtls/memory_buffer_alloc.h"
+
+/*
+ * Every allocation in this file is a limb buffer: route them through a
+ * helper that tags them as MPI for the buffer allocator statistics.
+ */
+static mbedtls_mpi_uint *mpi_alloc_limbs( size_t nblimbs )
+{
+    mbedtls_mpi_uint *p;
+    int prev_tag = mbedtls_memory_buffer_set_tag( MBEDTLS_MEMORY_TAG_MPI );
+
+    p = mbedtls_calloc( nblimbs, ciL );
+    (void) mbedtls_memory_buffer_set_tag( prev_tag );
+
+    return( p );
+}
+#else
+#define mpi_alloc_limbs( nblimbs )  mbedtls_calloc( (nblimbs), ciL )
+#endif
+
 /*
  * Initialize one MPI
  */
@@ -109,7 +132,7 @@ int mbedtls_mpi_grow( mbedtls_mpi *X, size_t nblimbs )
 
     if( X->n < nblimbs )
     {
-        if( ( p = mbedtls_calloc( nblimbs, ciL ) ) == NULL )
+        if( ( p = mpi_alloc_limbs( nblimbs ) ) == NULL )
             return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
 
         if( X->p != NULL )
@@ -147,7 +170,7 @@ int mbedtls_mpi_shrink( mbedtls_mpi *X, size_t nblimbs )
     if( i < nblimbs )
         i = nblimbs;
 
-    if( ( p = mbedtls_calloc( i, ciL ) ) == NULL )
+    if( ( p = mpi_alloc_limbs( i ) ) == NULL )
         return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
 
     if( X->p != NULL )
@@ -187,6 +210,19 @@ int mbedtls_mpi_copy( mbedtls_mpi *X, const mbedtls_mpi *Y )
 
     X->s = Y->s;
 
+    /*
+     * Fast path when the destination already has enough limbs: copy the
+     * significant part and zero only the tail, instead of growing and
+     * clearing the whole destination before overwriting it
+     */
+    if( X->p != NULL && X->n >= i )
+    {
+        memcpy( X->p, Y->p, i * ciL );
+        memset( X->p + i, 0, ( X->n - i ) * ciL );
+
+        return( 0 );
+    }
+
     MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, i ) );
 
     memset( X->p, 0, X->n * ciL );
@@ -302,6 +338,31 @@ int mbedtls_mpi_get_bit( const mbedtls_mpi *X, size_t pos )
     return( ( X->p[pos / biL] >> ( pos % biL ) ) & 0x01 );
 }
 
+/*
+ * Get up to biL bits starting at an arbitrary position, in O(1):
+ * at most two limbs are read, whatever the offset
+ */
+mbedtls_mpi_uint mbedtls_mpi_get_bits( const mbedtls_mpi *X, size_t pos,
+                                       size_t count )
+{
+    size_t off = pos / biL;
+    size_t idx = pos % biL;
+    mbedtls_mpi_uint r;
+
+    if( count == 0 || off >= X->n )
+        return( 0 );
+
+    r = X->p[off] >> idx;
+
+    if( idx + count > biL && off + 1 < X->n )
+        r |= X->p[off + 1] << ( biL - idx );
+
+    if( count < biL )
+        r &= ( (mbedtls_mpi_uint) 1 << count ) - 1;
+
+    return( r );
+}
+
 /*
  * Set a bit to a specific value of 0 or 1
  */
@@ -698,11 +759,8 @@ int mbedtls_mpi_shift_l( mbedtls_mpi *X, size_t count )
      */
     if( v0 > 0 )
     {
-        for( i = X->n; i > v0; i-- )
-            X->p[i - 1] = X->p[i - v0 - 1];
-
-        for( ; i > 0; i-- )
-            X->p[i - 1] = 0;
+        memmove( X->p + v0, X->p, ( X->n - v0 ) * ciL );
+        memset( X->p, 0, v0 * ciL );
     }
 
     /*
@@ -743,11 +801,8 @@ int mbedtls_mpi_shift_r( mbedtls_mpi *X, size_t count )
      */
     if( v0 > 0 )
     {
-        for( i = 0; i < X->n - v0; i++ )
-            X->p[i] = X->p[i + v0];
-
-        for( ; i < X->n; i++ )
-            X->p[i] = 0;
+        memmove( X->p, X->p + v0, ( X->n - v0 ) * ciL );
+        memset( X->p + X->n - v0, 0, v0 * ciL );
     }
 
     /*
@@ -1071,7 +1126,31 @@ void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mp
 {
     mbedtls_mpi_uint c = 0, t = 0;
 
-#if defined(MULADDC_HUIT)
+#if defined(MBEDTLS_MPI_MUL_WIDE) && defined(MBEDTLS_HAVE_UDBL)
+    mbedtls_t_udbl r;
+
+    for( ; i >= 4; i -= 4 )
+    {
+        /* Stay a stride ahead of the four limb pairs consumed below */
+        MBEDTLS_PREFETCH_R( s + 4 );
+        MBEDTLS_PREFETCH_W( d + 4 );
+
+        r = (mbedtls_t_udbl) *s++ * b + c + *d;
+        *d++ = (mbedtls_mpi_uint) r; c = (mbedtls_mpi_uint)( r >> biL );
+        r = (mbedtls_t_udbl) *s++ * b + c + *d;
+        *d++ = (mbedtls_mpi_uint) r; c = (mbedtls_mpi_uint)( r >> biL );
+        r = (mbedtls_t_udbl) *s++ * b + c + *d;
+        *d++ = (mbedtls_mpi_uint) r; c = (mbedtls_mpi_uint)( r >> biL );
+        r = (mbedtls_t_udbl) *s++ * b + c + *d;
+        *d++ = (mbedtls_mpi_uint) r; c = (mbedtls_mpi_uint)( r >> biL );
+    }
+
+    for( ; i > 0; i-- )
+    {
+        r = (mbedtls_t_udbl) *s++ * b + c + *d;
+        *d++ = (mbedtls_mpi_uint) r; c = (mbedtls_mpi_uint)( r >> biL );
+    }
+#elif defined(MULADDC_HUIT)
     for( ; i >= 8; i -= 8 )
     {
         MULADDC_INIT
@@ -1088,6 +1167,10 @@ void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mp
 #else /* MULADDC_HUIT */
     for( ; i >= 16; i -= 16 )
     {
+        /* Stay a stride ahead of the sixteen limb pairs consumed below */
+        MBEDTLS_PREFETCH_R( s + 16 );
+        MBEDTLS_PREFETCH_W( d + 16 );
+
         MULADDC_INIT
         MULADDC_CORE   MULADDC_CORE
         MULADDC_CORE   MULADDC_CORE
@@ -1128,14 +1211,120 @@ void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mp
     while( c != 0 );
 }
 
+/*
+ * Helpers for the Karatsuba layer: d += s over n limbs with carry
+ * propagation into the higher limbs of d
+ */
+static void mpi_add_acc( mbedtls_mpi_uint *d, const mbedtls_mpi_uint *s, size_t n )
+{
+    size_t i;
+    mbedtls_mpi_uint c = 0, t;
+
+    for( i = 0; i < n; i++ )
+    {
+        t = d[i] + c; c = ( t < c );
+        t += s[i]; c += ( t < s[i] );
+        d[i] = t;
+    }
+
+    for( ; c != 0; i++ )
+    {
+        d[i] += c; c = ( d[i] < c );
+    }
+}
+
+/*
+ * Recursive Karatsuba multiplication on limb vectors (HAC 14.13 variant):
+ * X = A * B with na >= nb, X zero-filled with na + nb limbs available.
+ * scratch provides working space, see mbedtls_mpi_mul_mpi() for its size.
+ */
+static void mpi_mul_karatsuba( mbedtls_mpi_uint *X,
+                               mbedtls_mpi_uint *A, size_t na,
+                               mbedtls_mpi_uint *B, size_t nb,
+                               mbedtls_mpi_uint *scratch )
+{
+    size_t k, ms1, ms2, zl;
+    mbedtls_mpi_uint *S1, *S2, *Z1;
+
+    if( nb < MBEDTLS_MPI_KARATSUBA_THRESHOLD )
+    {
+        for( ; nb > 0; nb-- )
+            mpi_mul_hlp( na, A, X + nb - 1, B[nb - 1] );
+        return;
+    }
+
+    k = na / 2;
+
+    if( nb <= k )
+    {
+        /*
+         * B is much shorter than A: X = A0 * B + ( A1 * B ) << k
+         */
+        mpi_mul_karatsuba( X, A, k, B, nb, scratch );
+
+        zl = na - k + nb;
+        memset( scratch, 0, zl * ciL );
+        mpi_mul_karatsuba( scratch, A + k, na - k, B, nb, scratch + zl );
+
+        while( zl > 0 && scratch[zl - 1] == 0 )
+            zl--;
+        mpi_add_acc( X + k, scratch, zl );
+        return;
+    }
+
+    /*
+     * X = A1 * B1 << 2k  +  ( (A0 + A1) * (B0 + B1) - A0 * B0 - A1 * B1 ) << k
+     *     + A0 * B0
+     */
+    mpi_mul_karatsuba( X, A, k, B, k, scratch );
+    mpi_mul_karatsuba( X + 2 * k, A + k, na - k, B + k, nb - k, scratch );
+
+    ms1 = na - k + 1;
+    ms2 = ( nb - k > k ? nb - k : k ) + 1;
+    S1 = scratch;
+    S2 = scratch + ms1;
+    Z1 = scratch + ms1 + ms2;
+
+    /* S1 = A0 + A1, S2 = B0 + B1 */
+    memcpy( S1, A + k, ( na - k ) * ciL );
+    S1[na - k] = 0;
+    mpi_add_acc( S1, A, k );
+
+    if( nb - k > k )
+    {
+        memcpy( S2, B + k, ( nb - k ) * ciL );
+        S2[nb - k] = 0;
+        mpi_add_acc( S2, B, k );
+    }
+    else
+    {
+        memcpy( S2, B, k * ciL );
+        S2[k] = 0;
+        mpi_add_acc( S2, B + k, nb - k );
+    }
+
+    zl = ms1 + ms2;
+    memset( Z1, 0, zl * ciL );
+    mpi_mul_karatsuba( Z1, S1, ms1, S2, ms2, Z1 + zl );
+
+    /* Z1 -= A0 * B0 + A1 * B1, already stored in X */
+    mpi_sub_hlp( 2 * k, X, Z1 );
+    mpi_sub_hlp( na + nb - 2 * k, X + 2 * k, Z1 );
+
+    while( zl > 0 && Z1[zl - 1] == 0 )
+        zl--;
+    mpi_add_acc( X + k, Z1, zl );
+}
+
 /*
  * Baseline multiplication: X = A * B  (HAC 14.12)
  */
 int mbedtls_mpi_mul_mpi( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi *B )
 {
     int ret;
-    size_t i, j;
+    size_t i, j, sl;
     mbedtls_mpi TA, TB;
+    mbedtls_mpi_uint *scratch;
 
     mbedtls_mpi_init( &TA ); mbedtls_mpi_init( &TB );
 
@@ -1153,8 +1342,33 @@ int mbedtls_mpi_mul_mpi( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
     MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, i + j ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_lset( X, 0 ) );
 
-    for( i++; j > 0; j-- )
-        mpi_mul_hlp( i - 1, A->p, X->p + j - 1, B->p[j - 1] );
+    if( i >= MBEDTLS_MPI_KARATSUBA_THRESHOLD &&
+        j >= MBEDTLS_MPI_KARATSUBA_THRESHOLD )
+    {
+        /*
+         * One scratch arena for the whole recursion, so the Karatsuba
+         * layer never touches the allocator in its inner calls
+         */
+        sl = 4 * ( i + j ) + 256;
+        if( ( scratch = mpi_alloc_limbs( sl ) ) == NULL )
+        {
+            ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        if( i >= j )
+            mpi_mul_karatsuba( X->p, A->p, i, B->p, j, scratch );
+        else
+            mpi_mul_karatsuba( X->p, B->p, j, A->p, i, scratch );
+
+        mbedtls_zeroize( scratch, sl * ciL );
+        mbedtls_free( scratch );
+    }
+    else
+    {
+        for( i++; j > 0; j-- )
+            mpi_mul_hlp( i - 1, A->p, X->p + j - 1, B->p[j - 1] );
+    }
 
     X->s = A->s * B->s;
 
@@ -1458,6 +1672,34 @@ static void mpi_montg_init( mbedtls_mpi_uint *mm, const mbedtls_mpi *N )
     *mm = ~x + 1;
 }
 
+/*
+ * Final correction step for Montgomery multiplication: subtract N from A
+ * (n + 1 limbs) when A >= N, as a single pass with no data-dependent
+ * branch. T provides n + 1 limbs of scratch.
+ */
+static void mpi_mont_cond_sub( size_t n, mbedtls_mpi_uint *A,
+                               const mbedtls_mpi_uint *N, mbedtls_mpi_uint *T )
+{
+    size_t i;
+    mbedtls_mpi_uint b = 0, mask, t, z;
+
+    for( i = 0; i < n; i++ )
+    {
+        z = ( A[i] < b );        t = A[i] - b;
+        b = ( t < N[i] ) + z;    T[i] = t - N[i];
+    }
+
+    T[n] = A[n] - b;
+    b = ( A[n] < b );
+
+    /*
+     * b == 1 means A < N: keep A. Otherwise take the subtracted copy.
+     */
+    mask = ~b + 1;
+    for( i = 0; i <= n; i++ )
+        A[i] = ( A[i] & mask ) | ( T[i] & ~mask );
+}
+
 /*
  * Montgomery multiplication: A = A * B * R^-1 mod N  (HAC 14.36)
  */
@@ -1489,11 +1731,60 @@ static void mpi_montmul( mbedtls_mpi *A, const mbedtls_mpi *B, const mbedtls_mpi
 
     memcpy( A->p, d, ( n + 1 ) * ciL );
 
-    if( mbedtls_mpi_cmp_abs( A, N ) >= 0 )
-        mpi_sub_hlp( n, N->p, A->p );
-    else
-        /* prevent timing attacks */
-        mpi_sub_hlp( n, A->p, T->p );
+    mpi_mont_cond_sub( n, A->p, N->p, T->p );
+}
+
+/*
+ * Montgomery squaring: A = A * A * R^-1 mod N
+ *
+ * Computes the square with roughly half the single-precision
+ * multiplications of mpi_montmul() by accumulating each off-diagonal
+ * partial product once and doubling the result, then performs a
+ * separate Montgomery reduction pass over the double-length product.
+ */
+static void mpi_montsqr( mbedtls_mpi *A, const mbedtls_mpi *N, mbedtls_mpi_uint mm,
+                         const mbedtls_mpi *T )
+{
+    size_t i, n;
+    mbedtls_mpi_uint u, c, t, *d;
+
+    memset( T->p, 0, T->n * ciL );
+
+    d = T->p;
+    n = N->n;
+
+    /*
+     * Off-diagonal products, each computed once
+     */
+    for( i = 0; i + 1 < n; i++ )
+        mpi_mul_hlp( n - i - 1, A->p + i + 1, d + 2 * i + 1, A->p[i] );
+
+    /*
+     * Double the off-diagonal part, then add the diagonal squares
+     */
+    c = 0;
+    for( i = 0; i < 2 * n; i++ )
+    {
+        t = d[i];
+        d[i] = ( t << 1 ) | c;
+        c = t >> ( biL - 1 );
+    }
+
+    for( i = 0; i < n; i++ )
+        mpi_mul_hlp( 1, A->p + i, d + 2 * i, A->p[i] );
+
+    /*
+     * Montgomery reduction: T = ( T + sum( u_i * N * 2^(i*biL) ) ) / R
+     */
+    for( i = 0; i < n; i++ )
+    {
+        u = d[i] * mm;
+        mpi_mul_hlp( n, N->p, d + i, u );
+    }
+
+    memcpy( A->p, d + n, ( n + 1 ) * ciL );
+
+    mpi_mont_cond_sub( n, A->p, N->p, T->p );
 }
 
 /*
@@ -1517,11 +1808,16 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 {
     int ret;
     size_t wbits, wsize, one = 1;
-    size_t i, j, nblimbs;
-    size_t bufsize, nbits;
-    mbedtls_mpi_uint ei, mm, state;
+    size_t i, j;
+    size_t nbits;
+    size_t w_start, w_table, pool_len;
+    mbedtls_mpi_uint mm;
+    mbedtls_mpi_uint *pool = NULL;
     mbedtls_mpi RR, T, W[ 2 << MBEDTLS_MPI_WINDOW_SIZE ], Apos;
     int neg;
+#if defined(MBEDTLS_TIMING_TRACE)
+    unsigned long trace_start = mbedtls_timing_hardclock();
+#endif
 
     if( mbedtls_mpi_cmp_int( N, 0 ) < 0 || ( N->p[0] & 1 ) == 0 )
         return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
@@ -1548,7 +1844,29 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
     j = N->n + 1;
     MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, j ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[1],  j ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &T, j * 2 ) );
+
+    /*
+     * Carve the montmul scratch and the precomputed window table out of a
+     * single allocation rather than growing each MPI individually
+     */
+    w_start = one << ( wsize - 1 );
+    w_table = ( wsize > 1 ) ? w_start : 0;
+    pool_len = 2 * j + w_table * j;
+
+    if( ( pool = mpi_alloc_limbs( pool_len ) ) == NULL )
+    {
+        ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    T.p = pool; T.n = 2 * j; T.s = 1;
+
+    for( i = 0; i < w_table; i++ )
+    {
+        W[w_start + i].p = pool + 2 * j + i * j;
+        W[w_start + i].n = j;
+        W[w_start + i].s = 1;
+    }
 
     /*
      * Compensate for negative A (and correct at the end)
@@ -1599,99 +1917,72 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
          */
         j =  one << ( wsize - 1 );
 
-        MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[j], N->n + 1 ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W[j], &W[1]    ) );
 
         for( i = 0; i < wsize - 1; i++ )
-            mpi_montmul( &W[j], &W[j], N, mm, &T );
+            mpi_montsqr( &W[j], N, mm, &T );
 
         /*
          * W[i] = W[i - 1] * W[1]
          */
         for( i = j + 1; i < ( one << wsize ); i++ )
         {
-            MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[i], N->n + 1 ) );
             MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W[i], &W[i - 1] ) );
 
             mpi_montmul( &W[i], &W[1], N, mm, &T );
         }
     }
 
-    nblimbs = E->n;
-    bufsize = 0;
-    nbits   = 0;
-    wbits   = 0;
-    state   = 0;
+    /*
+     * Scan E from the most significant bit down; a window always starts
+     * on a set bit, so its wsize bits can be sliced out of E with a
+     * single word-wide read instead of being collected bit by bit
+     */
+    nbits = mbedtls_mpi_bitlen( E );
 
-    while( 1 )
+    while( nbits > 0 )
     {
-        if( bufsize == 0 )
-        {
-            if( nblimbs == 0 )
-                break;
-
-            nblimbs--;
-
-            bufsize = sizeof( mbedtls_mpi_uint ) << 3;
-        }
-
-        bufsize--;
-
-        ei = (E->p[nblimbs] >> bufsize) & 1;
-
-        /*
-         * skip leading 0s
-         */
-        if( ei == 0 && state == 0 )
-            continue;
-
-        if( ei == 0 && state == 1 )
+        if( mbedtls_mpi_get_bit( E, nbits - 1 ) == 0 )
         {
             /*
              * out of window, square X
              */
-            mpi_montmul( X, X, N, mm, &T );
+            mpi_montsqr( X, N, mm, &T );
+            nbits--;
             continue;
         }
 
-        /*
-         * add ei to current window
-         */
-        state = 2;
-
-        nbits++;
-        wbits |= ( ei << ( wsize - nbits ) );
-
-        if( nbits == wsize )
+        if( nbits < wsize )
         {
             /*
-             * X = X^wsize R^-1 mod N
+             * not enough bits left for a full window, finish bit by bit
              */
-            for( i = 0; i < wsize; i++ )
-                mpi_montmul( X, X, N, mm, &T );
+            while( nbits > 0 )
+            {
+                mpi_montsqr( X, N, mm, &T );
 
-            /*
-             * X = X * W[wbits] R^-1 mod N
-             */
-            mpi_montmul( X, &W[wbits], N, mm, &T );
+                if( mbedtls_mpi_get_bit( E, nbits - 1 ) != 0 )
+                    mpi_montmul( X, &W[1], N, mm, &T );
 
-            state--;
-            nbits = 0;
-            wbits = 0;
+                nbits--;
+            }
+            break;
         }
-    }
 
-    /*
-     * process the remaining bits
-     */
-    for( i = 0; i < nbits; i++ )
-    {
-        mpi_montmul( X, X, N, mm, &T );
+        wbits = (size_t) mbedtls_mpi_get_bits( E, nbits - wsize, wsize );
 
-        wbits <<= 1;
+        /*
+         * X = X^wsize R^-1 mod N
+         */
+        for( i = 0; i < wsize; i++ )
+            mpi_montsqr( X, N, mm, &T );
+
+        /*
+         * X = X * W[wbits] R^-1 mod N
+         */
+        mpi_montmul( X, &W[wbits], N, mm, &T );
 
-        if( ( wbits & ( one << wsize ) ) != 0 )
-            mpi_montmul( X, &W[1], N, mm, &T );
+        nbits -= wsize;
     }
 
     /*
@@ -1707,10 +1998,119 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 
 cleanup:
 
-    for( i = ( one << ( wsize - 1 ) ); i < ( one << wsize ); i++ )
-        mbedtls_mpi_free( &W[i] );
+    /* The window table and T are carved from the pool, not owned */
+    if( wsize > 1 )
+        for( i = ( one << ( wsize - 1 ) ); i < ( one << wsize ); i++ )
+            W[i].p = NULL;
+    T.p = NULL;
+
+    if( pool != NULL )
+    {
+        mbedtls_zeroize( pool, pool_len * ciL );
+        mbedtls_free( pool );
+    }
 
-    mbedtls_mpi_free( &W[1] ); mbedtls_mpi_free( &T ); mbedtls_mpi_free( &Apos );
+    mbedtls_mpi_free( &W[1] ); mbedtls_mpi_free( &Apos );
+
+    if( _RR == NULL || _RR->p == NULL )
+        mbedtls_mpi_free( &RR );
+
+#if defined(MBEDTLS_TIMING_TRACE)
+    mbedtls_timing_trace( MBEDTLS_TIMING_TRACE_MPI_EXP_MOD,
+                          mbedtls_timing_hardclock() - trace_start );
+#endif
+
+    return( ret );
+}
+
+/*
+ * Interleaved double exponentiation: X = A1^E1 * A2^E2 mod N
+ * (Shamir's trick, variable-time: for public values only)
+ */
+int mbedtls_mpi_exp_mod2( mbedtls_mpi *X, const mbedtls_mpi *A1, const mbedtls_mpi *E1,
+                  const mbedtls_mpi *A2, const mbedtls_mpi *E2,
+                  const mbedtls_mpi *N, mbedtls_mpi *_RR )
+{
+    int ret;
+    size_t i, j, bits, b;
+    mbedtls_mpi_uint mm;
+    mbedtls_mpi RR, T, W[4];
+
+    if( mbedtls_mpi_cmp_int( N, 0 ) < 0 || ( N->p[0] & 1 ) == 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    if( mbedtls_mpi_cmp_int( E1, 0 ) < 0 || mbedtls_mpi_cmp_int( E2, 0 ) < 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    mpi_montg_init( &mm, N );
+    mbedtls_mpi_init( &RR ); mbedtls_mpi_init( &T );
+    mbedtls_mpi_init( &W[1] ); mbedtls_mpi_init( &W[2] ); mbedtls_mpi_init( &W[3] );
+
+    j = N->n + 1;
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, j ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &T, j * 2 ) );
+
+    /*
+     * Pre-compute R^2 mod N, or reuse the cached value as exp_mod does
+     */
+    if( _RR == NULL || _RR->p == NULL )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &RR, 1 ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &RR, N->n * 2 * biL ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &RR, &RR, N ) );
+
+        if( _RR != NULL )
+            memcpy( _RR, &RR, sizeof( mbedtls_mpi ) );
+    }
+    else
+        memcpy( &RR, _RR, sizeof( mbedtls_mpi ) );
+
+    /*
+     * W[2] = A1 * R mod N, W[1] = A2 * R mod N, W[3] = A1 * A2 * R mod N,
+     * so that W[b] matches the exponent bit pair b = 2*e1_i + e2_i
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &W[2], A1, N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[2], j ) );
+    mpi_montmul( &W[2], &RR, N, mm, &T );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &W[1], A2, N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[1], j ) );
+    mpi_montmul( &W[1], &RR, N, mm, &T );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W[3], &W[2] ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W[3], j ) );
+    mpi_montmul( &W[3], &W[1], N, mm, &T );
+
+    /*
+     * X = R mod N
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( X, &RR ) );
+    mpi_montred( X, N, mm, &T );
+
+    bits = mbedtls_mpi_bitlen( E1 );
+    i = mbedtls_mpi_bitlen( E2 );
+    if( i > bits )
+        bits = i;
+
+    for( i = bits; i > 0; i-- )
+    {
+        mpi_montsqr( X, N, mm, &T );
+
+        b = ( mbedtls_mpi_get_bit( E1, i - 1 ) << 1 ) |
+              mbedtls_mpi_get_bit( E2, i - 1 );
+
+        if( b != 0 )
+            mpi_montmul( X, &W[b], N, mm, &T );
+    }
+
+    /*
+     * X = A1^E1 * A2^E2 * R * R^-1 mod N
+     */
+    mpi_montred( X, N, mm, &T );
+
+cleanup:
+    mbedtls_mpi_free( &W[1] ); mbedtls_mpi_free( &W[2] ); mbedtls_mpi_free( &W[3] );
+    mbedtls_mpi_free( &T );
 
     if( _RR == NULL || _RR->p == NULL )
         mbedtls_mpi_free( &RR );
@@ -2053,6 +2453,47 @@ cleanup:
     return( ret );
 }
 
+#define SMALL_PRIME_COUNT ( sizeof( small_prime ) / sizeof( small_prime[0] ) - 1 )
+
+/*
+ * Incremental sieve for mbedtls_mpi_gen_prime(): keep the residues of the
+ * search base modulo each small prime, so that stepping the candidate only
+ * costs one single-precision modular check per table entry instead of a
+ * full multi-precision division restart.
+ *
+ * Only valid when the candidates are guaranteed larger than the biggest
+ * table entry (nbits > 10), otherwise a prime candidate would sieve
+ * itself out.
+ */
+static int mpi_sieve_init( mbedtls_mpi_uint *residues, const mbedtls_mpi *X )
+{
+    int ret = 0;
+    size_t i;
+
+    for( i = 0; i < SMALL_PRIME_COUNT; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_int( &residues[i], X,
+                                              small_prime[i] ) );
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Return 0 if base + offset has no factor in the small-prime table,
+ * 1 otherwise
+ */
+static int mpi_sieve_check( const mbedtls_mpi_uint *residues,
+                            mbedtls_mpi_uint offset )
+{
+    size_t i;
+
+    for( i = 0; i < SMALL_PRIME_COUNT; i++ )
+        if( ( residues[i] + offset ) % (mbedtls_mpi_uint) small_prime[i] == 0 )
+            return( 1 );
+
+    return( 0 );
+}
+
 /*
  * Pseudo-primality test: small factors, then Miller-Rabin
  */
@@ -2095,6 +2536,8 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int dh_flag,
     int ret;
     size_t k, n;
     mbedtls_mpi_uint r;
+    mbedtls_mpi_uint res_x[SMALL_PRIME_COUNT], res_y[SMALL_PRIME_COUNT];
+    mbedtls_mpi_uint off, applied;
     mbedtls_mpi Y;
 
     if( nbits < 3 || nbits > MBEDTLS_MPI_MAX_BITS )
@@ -2113,8 +2556,12 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int dh_flag,
 
     X->p[0] |= 1;
 
-    if( dh_flag == 0 )
+    if( dh_flag == 0 && nbits <= 10 )
     {
+        /*
+         * Candidates may be no larger than the sieve table entries:
+         * fall back to the direct test
+         */
         while( ( ret = mbedtls_mpi_is_prime( X, f_rng, p_rng ) ) != 0 )
         {
             if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
@@ -2123,6 +2570,37 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int dh_flag,
             MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( X, X, 2 ) );
         }
     }
+    else if( dh_flag == 0 )
+    {
+        /*
+         * Sieve incrementally: skip ahead over candidates with small
+         * factors using the cached residues, and only run Miller-Rabin
+         * on the survivors
+         */
+        MBEDTLS_MPI_CHK( mpi_sieve_init( res_x, X ) );
+
+        off = applied = 0;
+        while( 1 )
+        {
+            while( mpi_sieve_check( res_x, off ) != 0 )
+                off += 2;
+
+            if( off != applied )
+            {
+                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( X, X,
+                                        (mbedtls_mpi_sint)( off - applied ) ) );
+                applied = off;
+            }
+
+            if( ( ret = mpi_miller_rabin( X, f_rng, p_rng ) ) == 0 )
+                break;
+
+            if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                goto cleanup;
+
+            off += 2;
+        }
+    }
     else
     {
         /*
@@ -2143,30 +2621,72 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int dh_flag,
         MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &Y, X ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &Y, 1 ) );
 
-        while( 1 )
+        if( nbits <= 10 )
         {
-            /*
-             * First, check small factors for X and Y
-             * before doing Miller-Rabin on any of them
-             */
-            if( ( ret = mpi_check_small_factors(  X         ) ) == 0 &&
-                ( ret = mpi_check_small_factors( &Y         ) ) == 0 &&
-                ( ret = mpi_miller_rabin(  X, f_rng, p_rng  ) ) == 0 &&
-                ( ret = mpi_miller_rabin( &Y, f_rng, p_rng  ) ) == 0 )
+            while( 1 )
             {
-                break;
+                /*
+                 * First, check small factors for X and Y
+                 * before doing Miller-Rabin on any of them
+                 */
+                if( ( ret = mpi_check_small_factors(  X         ) ) == 0 &&
+                    ( ret = mpi_check_small_factors( &Y         ) ) == 0 &&
+                    ( ret = mpi_miller_rabin(  X, f_rng, p_rng  ) ) == 0 &&
+                    ( ret = mpi_miller_rabin( &Y, f_rng, p_rng  ) ) == 0 )
+                {
+                    break;
+                }
+
+                if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                    goto cleanup;
+
+                /*
+                 * Next candidates. We want to preserve Y = (X-1) / 2 and
+                 * Y = 1 mod 2 and Y = 2 mod 3 (eq X = 3 mod 4 and X = 2 mod 3)
+                 * so up Y by 6 and X by 12.
+                 */
+                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int(  X,  X, 12 ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &Y, &Y, 6  ) );
             }
-
-            if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
-                goto cleanup;
-
+        }
+        else
+        {
             /*
-             * Next candidates. We want to preserve Y = (X-1) / 2 and
-             * Y = 1 mod 2 and Y = 2 mod 3 (eq X = 3 mod 4 and X = 2 mod 3)
-             * so up Y by 6 and X by 12.
+             * Same search, but sieve X and Y together on the cached
+             * residues before running any Miller-Rabin round. The step
+             * pattern (X by 12, Y by 6) preserves the congruences set
+             * up above.
              */
-            MBEDTLS_MPI_CHK( mbedtls_mpi_add_int(  X,  X, 12 ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &Y, &Y, 6  ) );
+            MBEDTLS_MPI_CHK( mpi_sieve_init( res_x,  X ) );
+            MBEDTLS_MPI_CHK( mpi_sieve_init( res_y, &Y ) );
+
+            off = applied = 0;
+            while( 1 )
+            {
+                while( mpi_sieve_check( res_x, 12 * off ) != 0 ||
+                       mpi_sieve_check( res_y,  6 * off ) != 0 )
+                    off++;
+
+                if( off != applied )
+                {
+                    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( X, X,
+                                (mbedtls_mpi_sint)( 12 * ( off - applied ) ) ) );
+                    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &Y, &Y,
+                                (mbedtls_mpi_sint)(  6 * ( off - applied ) ) ) );
+                    applied = off;
+                }
+
+                if( ( ret = mpi_miller_rabin(  X, f_rng, p_rng ) ) == 0 &&
+                    ( ret = mpi_miller_rabin( &Y, f_rng, p_rng ) ) == 0 )
+                {
+                    break;
+                }
+
+                if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                    goto cleanup;
+
+                off++;
+            }
         }
     }
 
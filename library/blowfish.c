@@ -40,33 +40,9 @@
 
 #if !defined(MBEDTLS_BLOWFISH_ALT)
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
-/*
- * 32-bit integer manipulation macros (big endian)
- */
-#ifndef GET_UINT32_BE
-#define GET_UINT32_BE(n,b,i)                            \
-{                                                       \
-    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
-        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
-        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
-        | ( (uint32_t) (b)[(i) + 3]       );            \
-}
-#endif
-
-#ifndef PUT_UINT32_BE
-#define PUT_UINT32_BE(n,b,i)                            \
-{                                                       \
-    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
-    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
-    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
-    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
-}
-#endif
+#include "mbedtls/byte_order.h"
 
 static const uint32_t P[MBEDTLS_BLOWFISH_ROUNDS + 2] = {
         0x243F6A88L, 0x85A308D3L, 0x13198A2EL, 0x03707344L,
@@ -79,82 +55,86 @@ static const uint32_t P[MBEDTLS_BLOWFISH_ROUNDS + 2] = {
 /* declarations of data at the end of this file */
 static const uint32_t S[4][256];
 
-static uint32_t F( mbedtls_blowfish_context *ctx, uint32_t x )
-{
-   unsigned short a, b, c, d;
-   uint32_t  y;
-
-   d = (unsigned short)(x & 0xFF);
-   x >>= 8;
-   c = (unsigned short)(x & 0xFF);
-   x >>= 8;
-   b = (unsigned short)(x & 0xFF);
-   x >>= 8;
-   a = (unsigned short)(x & 0xFF);
-   y = ctx->S[0][a] + ctx->S[1][b];
-   y = y ^ ctx->S[2][c];
-   y = y + ctx->S[3][d];
-
-   return( y );
-}
+/*
+ * The round function. Working from a local S-box pointer keeps the
+ * compiler from reloading the context pointer between the four table
+ * lookups, which dominate the cost of a round.
+ */
+#define BF_F( s, x )                                                    \
+    ( ( ( (s)[0][ (x) >> 24         ] +                                 \
+          (s)[1][ ( (x) >> 16 ) & 0xFF ] ) ^                            \
+          (s)[2][ ( (x) >>  8 ) & 0xFF ] ) +                            \
+          (s)[3][ (x)         & 0xFF ] )
+
+/* One Feistel round; rounds are applied pairwise with the operand names
+ * exchanged, which removes the per-round swap of the reference code */
+#define BF_ROUND( s, a, b, p )                                          \
+    { (a) ^= (p); (b) ^= BF_F( s, a ); }
 
 static void blowfish_enc( mbedtls_blowfish_context *ctx, uint32_t *xl, uint32_t *xr )
 {
-    uint32_t  Xl, Xr, temp;
+    const uint32_t ( *sbox )[256] = (const uint32_t ( * )[256]) ctx->S;
+    const uint32_t *pbox = ctx->P;
+    uint32_t Xl = *xl, Xr = *xr;
     short i;
 
-    Xl = *xl;
-    Xr = *xr;
-
-    for( i = 0; i < MBEDTLS_BLOWFISH_ROUNDS; ++i )
+    for( i = 0; i < MBEDTLS_BLOWFISH_ROUNDS; i += 2 )
     {
-        Xl = Xl ^ ctx->P[i];
-        Xr = F( ctx, Xl ) ^ Xr;
-
-        temp = Xl;
-        Xl = Xr;
-        Xr = temp;
+        BF_ROUND( sbox, Xl, Xr, pbox[i] );
+        BF_ROUND( sbox, Xr, Xl, pbox[i + 1] );
     }
 
-    temp = Xl;
-    Xl = Xr;
-    Xr = temp;
-
-    Xr = Xr ^ ctx->P[MBEDTLS_BLOWFISH_ROUNDS];
-    Xl = Xl ^ ctx->P[MBEDTLS_BLOWFISH_ROUNDS + 1];
-
-    *xl = Xl;
-    *xr = Xr;
+    *xl = Xr ^ pbox[MBEDTLS_BLOWFISH_ROUNDS + 1];
+    *xr = Xl ^ pbox[MBEDTLS_BLOWFISH_ROUNDS];
 }
 
 static void blowfish_dec( mbedtls_blowfish_context *ctx, uint32_t *xl, uint32_t *xr )
 {
-    uint32_t  Xl, Xr, temp;
+    const uint32_t ( *sbox )[256] = (const uint32_t ( * )[256]) ctx->S;
+    const uint32_t *pbox = ctx->P;
+    uint32_t Xl = *xl, Xr = *xr;
     short i;
 
-    Xl = *xl;
-    Xr = *xr;
-
-    for( i = MBEDTLS_BLOWFISH_ROUNDS + 1; i > 1; --i )
+    for( i = MBEDTLS_BLOWFISH_ROUNDS + 1; i > 2; i -= 2 )
     {
-        Xl = Xl ^ ctx->P[i];
-        Xr = F( ctx, Xl ) ^ Xr;
-
-        temp = Xl;
-        Xl = Xr;
-        Xr = temp;
+        BF_ROUND( sbox, Xl, Xr, pbox[i] );
+        BF_ROUND( sbox, Xr, Xl, pbox[i - 1] );
     }
 
-    temp = Xl;
-    Xl = Xr;
-    Xr = temp;
+    *xl = Xr ^ pbox[0];
+    *xr = Xl ^ pbox[1];
+}
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+/*
+ * Decrypt two independent blocks with the rounds interleaved: the table
+ * lookups of one lane execute while the other lane waits on its loads,
+ * roughly doubling throughput where CBC decryption allows it.
+ */
+static void blowfish_dec2( mbedtls_blowfish_context *ctx,
+                           uint32_t *xl0, uint32_t *xr0,
+                           uint32_t *xl1, uint32_t *xr1 )
+{
+    const uint32_t ( *sbox )[256] = (const uint32_t ( * )[256]) ctx->S;
+    const uint32_t *pbox = ctx->P;
+    uint32_t Al = *xl0, Ar = *xr0;
+    uint32_t Bl = *xl1, Br = *xr1;
+    short i;
 
-    Xr = Xr ^ ctx->P[1];
-    Xl = Xl ^ ctx->P[0];
+    for( i = MBEDTLS_BLOWFISH_ROUNDS + 1; i > 2; i -= 2 )
+    {
+        BF_ROUND( sbox, Al, Ar, pbox[i] );
+        BF_ROUND( sbox, Bl, Br, pbox[i] );
+        BF_ROUND( sbox, Ar, Al, pbox[i - 1] );
+        BF_ROUND( sbox, Br, Bl, pbox[i - 1] );
+    }
 
-    *xl = Xl;
-    *xr = Xr;
+    *xl0 = Ar ^ pbox[0];
+    *xr0 = Al ^ pbox[1];
+    *xl1 = Br ^ pbox[0];
+    *xr1 = Bl ^ pbox[1];
 }
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
 
 void mbedtls_blowfish_init( mbedtls_blowfish_context *ctx )
 {
@@ -274,6 +254,43 @@ int mbedtls_blowfish_crypt_cbc( mbedtls_blowfish_context *ctx,
 
     if( mode == MBEDTLS_BLOWFISH_DECRYPT )
     {
+        unsigned char temp2[2 * MBEDTLS_BLOWFISH_BLOCKSIZE];
+
+        /* Ciphertext blocks are independent: run them through the
+         * two-lane kernel in pairs */
+        while( length >= 2 * MBEDTLS_BLOWFISH_BLOCKSIZE )
+        {
+            uint32_t X0, X1, Y0, Y1;
+
+            memcpy( temp2, input, 2 * MBEDTLS_BLOWFISH_BLOCKSIZE );
+
+            GET_UINT32_BE( X0, input,  0 );
+            GET_UINT32_BE( X1, input,  4 );
+            GET_UINT32_BE( Y0, input,  8 );
+            GET_UINT32_BE( Y1, input, 12 );
+
+            blowfish_dec2( ctx, &X0, &X1, &Y0, &Y1 );
+
+            PUT_UINT32_BE( X0, output,  0 );
+            PUT_UINT32_BE( X1, output,  4 );
+            PUT_UINT32_BE( Y0, output,  8 );
+            PUT_UINT32_BE( Y1, output, 12 );
+
+            for( i = 0; i < MBEDTLS_BLOWFISH_BLOCKSIZE; i++ )
+            {
+                output[i] = (unsigned char)( output[i] ^ iv[i] );
+                output[MBEDTLS_BLOWFISH_BLOCKSIZE + i] = (unsigned char)
+                    ( output[MBEDTLS_BLOWFISH_BLOCKSIZE + i] ^ temp2[i] );
+            }
+
+            memcpy( iv, temp2 + MBEDTLS_BLOWFISH_BLOCKSIZE,
+                    MBEDTLS_BLOWFISH_BLOCKSIZE );
+
+            input  += 2 * MBEDTLS_BLOWFISH_BLOCKSIZE;
+            output += 2 * MBEDTLS_BLOWFISH_BLOCKSIZE;
+            length -= 2 * MBEDTLS_BLOWFISH_BLOCKSIZE;
+        }
+
         while( length > 0 )
         {
             memcpy( temp, input, MBEDTLS_BLOWFISH_BLOCKSIZE );
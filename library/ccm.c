@@ -50,10 +50,7 @@
 #endif /* MBEDTLS_PLATFORM_C */
 #endif /* MBEDTLS_SELF_TEST && MBEDTLS_AES_C */
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 #define CCM_ENCRYPT 0
 #define CCM_DECRYPT 1
@@ -133,24 +130,36 @@ void mbedtls_ccm_free( mbedtls_ccm_context *ctx )
         dst[i] = src[i] ^ b[i];
 
 /*
- * Authenticated encryption or decryption
+ * Authenticated encryption or decryption; the input may be scattered over
+ * several segments, the output is contiguous.
  */
-static int ccm_auth_crypt( mbedtls_ccm_context *ctx, int mode, size_t length,
+static int ccm_auth_crypt( mbedtls_ccm_context *ctx, int mode,
+                           const mbedtls_iovec *iov, size_t iov_count,
                            const unsigned char *iv, size_t iv_len,
                            const unsigned char *add, size_t add_len,
-                           const unsigned char *input, unsigned char *output,
+                           unsigned char *output,
                            unsigned char *tag, size_t tag_len )
 {
     int ret;
     unsigned char i;
     unsigned char q;
-    size_t len_left, olen;
+    size_t length, len_left, olen;
+    size_t seg, seg_left;
     unsigned char b[16];
     unsigned char y[16];
     unsigned char ctr[16];
+    unsigned char gather[16];
     const unsigned char *src;
     unsigned char *dst;
 
+    for( length = 0, seg = 0; seg < iov_count; seg++ )
+    {
+        if( length + iov[seg].len < length )
+            return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+        length += iov[seg].len;
+    }
+
     /*
      * Check length requirements: SP800-38C A.1
      * Additional requirement: a < 2^16 - 2^8 to simplify the code.
@@ -254,21 +263,64 @@ static int ccm_auth_crypt( mbedtls_ccm_context *ctx, int mode, size_t length,
      * the respective order of authentication and {en,de}cryption.
      */
     len_left = length;
-    src = input;
+    seg = 0;
+    src = iov_count > 0 ? iov[0].base : NULL;
+    seg_left = iov_count > 0 ? iov[0].len : 0;
     dst = output;
 
     while( len_left > 0 )
     {
         size_t use_len = len_left > 16 ? 16 : len_left;
+        const unsigned char *blk;
+
+        while( seg_left == 0 )
+        {
+            seg++;
+            src = iov[seg].base;
+            seg_left = iov[seg].len;
+        }
+
+        if( seg_left >= use_len )
+        {
+            blk = src;
+            src += use_len;
+            seg_left -= use_len;
+        }
+        else
+        {
+            /* Block straddles a segment boundary: gather it first */
+            size_t got = 0;
+
+            while( got < use_len )
+            {
+                size_t n;
+
+                if( seg_left == 0 )
+                {
+                    seg++;
+                    src = iov[seg].base;
+                    seg_left = iov[seg].len;
+                    continue;
+                }
+
+                n = seg_left < use_len - got ? seg_left : use_len - got;
+                memcpy( gather + got, src, n );
+                got += n;
+                src += n;
+                seg_left -= n;
+            }
+
+            blk = gather;
+        }
 
         if( mode == CCM_ENCRYPT )
         {
             memset( b, 0, 16 );
-            memcpy( b, src, use_len );
+            memcpy( b, blk, use_len );
             UPDATE_CBC_MAC;
         }
 
-        CTR_CRYPT( dst, src, use_len );
+        CTR_CRYPT( dst, blk, use_len );
 
         if( mode == CCM_DECRYPT )
         {
@@ -278,7 +330,6 @@ static int ccm_auth_crypt( mbedtls_ccm_context *ctx, int mode, size_t length,
         }
 
         dst += use_len;
-        src += use_len;
         len_left -= use_len;
 
         /*
@@ -302,6 +353,46 @@ static int ccm_auth_crypt( mbedtls_ccm_context *ctx, int mode, size_t length,
     return( 0 );
 }
 
+/*
+ * Authenticated decryption core, shared by the contiguous and
+ * scatter-gather entry points
+ */
+static int ccm_auth_decrypt( mbedtls_ccm_context *ctx,
+                             const mbedtls_iovec *iov, size_t iov_count,
+                             const unsigned char *iv, size_t iv_len,
+                             const unsigned char *add, size_t add_len,
+                             unsigned char *output,
+                             const unsigned char *tag, size_t tag_len )
+{
+    int ret;
+    unsigned char check_tag[16];
+    unsigned char i;
+    size_t j, length;
+    int diff;
+
+    if( ( ret = ccm_auth_crypt( ctx, CCM_DECRYPT, iov, iov_count,
+                                iv, iv_len, add, add_len,
+                                output, check_tag, tag_len ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    /* Check tag in "constant-time" */
+    for( diff = 0, i = 0; i < tag_len; i++ )
+        diff |= tag[i] ^ check_tag[i];
+
+    if( diff != 0 )
+    {
+        for( length = 0, j = 0; j < iov_count; j++ )
+            length += iov[j].len;
+
+        mbedtls_zeroize( output, length );
+        return( MBEDTLS_ERR_CCM_AUTH_FAILED );
+    }
+
+    return( 0 );
+}
+
 /*
  * Authenticated encryption
  */
@@ -311,8 +402,27 @@ int mbedtls_ccm_encrypt_and_tag( mbedtls_ccm_context *ctx, size_t length,
                          const unsigned char *input, unsigned char *output,
                          unsigned char *tag, size_t tag_len )
 {
-    return( ccm_auth_crypt( ctx, CCM_ENCRYPT, length, iv, iv_len,
-                            add, add_len, input, output, tag, tag_len ) );
+    mbedtls_iovec iov;
+
+    iov.base = input;
+    iov.len = length;
+
+    return( ccm_auth_crypt( ctx, CCM_ENCRYPT, &iov, 1, iv, iv_len,
+                            add, add_len, output, tag, tag_len ) );
+}
+
+/*
+ * Authenticated encryption, scattered input
+ */
+int mbedtls_ccm_encrypt_and_tag_iov( mbedtls_ccm_context *ctx,
+                         const mbedtls_iovec *iov, size_t iov_count,
+                         const unsigned char *iv, size_t iv_len,
+                         const unsigned char *add, size_t add_len,
+                         unsigned char *output,
+                         unsigned char *tag, size_t tag_len )
+{
+    return( ccm_auth_crypt( ctx, CCM_ENCRYPT, iov, iov_count, iv, iv_len,
+                            add, add_len, output, tag, tag_len ) );
 }
 
 /*
@@ -323,32 +433,223 @@ int mbedtls_ccm_auth_decrypt( mbedtls_ccm_context *ctx, size_t length,
                       const unsigned char *add, size_t add_len,
                       const unsigned char *input, unsigned char *output,
                       const unsigned char *tag, size_t tag_len )
+{
+    mbedtls_iovec iov;
+
+    iov.base = input;
+    iov.len = length;
+
+    return( ccm_auth_decrypt( ctx, &iov, 1, iv, iv_len, add, add_len,
+                              output, tag, tag_len ) );
+}
+
+/*
+ * Authenticated decryption, scattered input
+ */
+int mbedtls_ccm_auth_decrypt_iov( mbedtls_ccm_context *ctx,
+                      const mbedtls_iovec *iov, size_t iov_count,
+                      const unsigned char *iv, size_t iv_len,
+                      const unsigned char *add, size_t add_len,
+                      unsigned char *output,
+                      const unsigned char *tag, size_t tag_len )
+{
+    return( ccm_auth_decrypt( ctx, iov, iov_count, iv, iv_len, add, add_len,
+                              output, tag, tag_len ) );
+}
+
+/*
+ * Bind nonce and tag lengths: validate them once and precompute the flag
+ * bytes of B_0 and of the counter blocks, shared by every packet of a
+ * session
+ */
+int mbedtls_ccm_bind( mbedtls_ccm_context *ctx,
+                      size_t iv_len, size_t tag_len )
+{
+    /* Same requirements as ccm_auth_crypt() */
+    if( tag_len < 4 || tag_len > 16 || tag_len % 2 != 0 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    if( iv_len < 7 || iv_len > 13 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    ctx->q = 16 - 1 - (unsigned char) iv_len;
+    ctx->iv_len = (unsigned char) iv_len;
+    ctx->tag_len = (unsigned char) tag_len;
+
+    /* The 'add present' bit is OR'ed in per packet */
+    ctx->b0_flags = (unsigned char)( ( ( tag_len - 2 ) / 2 ) << 3 |
+                                     ( ctx->q - 1 ) );
+    ctx->ctr_flags = (unsigned char)( ctx->q - 1 );
+    ctx->bound = 1;
+
+    return( 0 );
+}
+
+/*
+ * Process one packet with bound parameters: same algorithm as
+ * ccm_auth_crypt(), minus the parameter processing and with contiguous
+ * input, which is all the target workload (small datagrams) needs
+ */
+static int ccm_crypt_packet( mbedtls_ccm_context *ctx, int mode,
+                             const mbedtls_ccm_packet *pkt )
 {
     int ret;
-    unsigned char check_tag[16];
     unsigned char i;
-    int diff;
+    const unsigned char q = ctx->q;
+    size_t len_left, olen;
+    unsigned char b[16];
+    unsigned char y[16];
+    unsigned char ctr[16];
+    const unsigned char *src = pkt->input;
+    unsigned char *dst = pkt->output;
 
-    if( ( ret = ccm_auth_crypt( ctx, CCM_DECRYPT, length,
-                                iv, iv_len, add, add_len,
-                                input, output, check_tag, tag_len ) ) != 0 )
+    if( pkt->add_len > 0xFF00 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    b[0] = (unsigned char)( ctx->b0_flags | ( pkt->add_len > 0 ) << 6 );
+    memcpy( b + 1, pkt->iv, ctx->iv_len );
+
+    for( i = 0, len_left = pkt->length; i < q; i++, len_left >>= 8 )
+        b[15-i] = (unsigned char)( len_left & 0xFF );
+
+    if( len_left > 0 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    /* Start CBC-MAC with first block */
+    memset( y, 0, 16 );
+    UPDATE_CBC_MAC;
+
+    if( pkt->add_len > 0 )
     {
-        return( ret );
+        size_t use_len;
+        const unsigned char *add = pkt->add;
+
+        len_left = pkt->add_len;
+
+        memset( b, 0, 16 );
+        b[0] = (unsigned char)( ( pkt->add_len >> 8 ) & 0xFF );
+        b[1] = (unsigned char)( ( pkt->add_len      ) & 0xFF );
+
+        use_len = len_left < 16 - 2 ? len_left : 16 - 2;
+        memcpy( b + 2, add, use_len );
+        len_left -= use_len;
+        add += use_len;
+
+        UPDATE_CBC_MAC;
+
+        while( len_left > 0 )
+        {
+            use_len = len_left > 16 ? 16 : len_left;
+
+            memset( b, 0, 16 );
+            memcpy( b, add, use_len );
+            UPDATE_CBC_MAC;
+
+            len_left -= use_len;
+            add += use_len;
+        }
     }
 
-    /* Check tag in "constant-time" */
-    for( diff = 0, i = 0; i < tag_len; i++ )
-        diff |= tag[i] ^ check_tag[i];
+    ctr[0] = ctx->ctr_flags;
+    memcpy( ctr + 1, pkt->iv, ctx->iv_len );
+    memset( ctr + 1 + ctx->iv_len, 0, q );
+    ctr[15] = 1;
 
-    if( diff != 0 )
+    len_left = pkt->length;
+
+    while( len_left > 0 )
     {
-        mbedtls_zeroize( output, length );
-        return( MBEDTLS_ERR_CCM_AUTH_FAILED );
+        size_t use_len = len_left > 16 ? 16 : len_left;
+
+        if( mode == CCM_ENCRYPT )
+        {
+            memset( b, 0, 16 );
+            memcpy( b, src, use_len );
+            UPDATE_CBC_MAC;
+        }
+
+        CTR_CRYPT( dst, src, use_len );
+
+        if( mode == CCM_DECRYPT )
+        {
+            memset( b, 0, 16 );
+            memcpy( b, dst, use_len );
+            UPDATE_CBC_MAC;
+        }
+
+        src += use_len;
+        dst += use_len;
+        len_left -= use_len;
+
+        for( i = 0; i < q; i++ )
+            if( ++ctr[15-i] != 0 )
+                break;
+    }
+
+    /*
+     * Authentication: reset counter and crypt/mask internal tag
+     */
+    for( i = 0; i < q; i++ )
+        ctr[15-i] = 0;
+
+    CTR_CRYPT( y, y, 16 );
+
+    if( mode == CCM_ENCRYPT )
+        memcpy( pkt->tag, y, ctx->tag_len );
+    else
+    {
+        if( mbedtls_ct_memcmp( pkt->tag, y, ctx->tag_len ) != 0 )
+        {
+            mbedtls_zeroize( pkt->output, pkt->length );
+            return( MBEDTLS_ERR_CCM_AUTH_FAILED );
+        }
     }
 
     return( 0 );
 }
 
+/*
+ * Batch encryption with bound parameters
+ */
+int mbedtls_ccm_encrypt_batch( mbedtls_ccm_context *ctx,
+                               const mbedtls_ccm_packet *pkt, size_t count )
+{
+    int ret;
+    size_t i;
+
+    if( ctx->bound == 0 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    for( i = 0; i < count; i++ )
+        if( ( ret = ccm_crypt_packet( ctx, CCM_ENCRYPT, &pkt[i] ) ) != 0 )
+            return( ret );
+
+    return( 0 );
+}
+
+/*
+ * Batch decryption with bound parameters
+ */
+int mbedtls_ccm_decrypt_batch( mbedtls_ccm_context *ctx,
+                               const mbedtls_ccm_packet *pkt, size_t count,
+                               size_t *done )
+{
+    int ret = 0;
+    size_t i;
+
+    if( ctx->bound == 0 )
+        return( MBEDTLS_ERR_CCM_BAD_INPUT );
+
+    for( i = 0; i < count; i++ )
+        if( ( ret = ccm_crypt_packet( ctx, CCM_DECRYPT, &pkt[i] ) ) != 0 )
+            break;
+
+    if( done != NULL )
+        *done = i;
+
+    return( ret );
+}
+
 
 #if defined(MBEDTLS_SELF_TEST) && defined(MBEDTLS_AES_C)
 /*
@@ -452,6 +753,57 @@ int mbedtls_ccm_self_test( int verbose )
             mbedtls_printf( "passed\n" );
     }
 
+    /*
+     * Same vectors through the session-bound batch interface
+     */
+    for( i = 0; i < NB_TESTS; i++ )
+    {
+        mbedtls_ccm_packet pkt;
+
+        if( verbose != 0 )
+            mbedtls_printf( "  CCM-AES batch #%u: ", (unsigned int) i + 1 );
+
+        if( mbedtls_ccm_bind( &ctx, iv_len[i], tag_len[i] ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+
+            return( 1 );
+        }
+
+        pkt.iv = iv;
+        pkt.add = ad;
+        pkt.add_len = add_len[i];
+        pkt.input = msg;
+        pkt.length = msg_len[i];
+        pkt.output = out;
+        pkt.tag = out + msg_len[i];
+
+        if( mbedtls_ccm_encrypt_batch( &ctx, &pkt, 1 ) != 0 ||
+            memcmp( out, res[i], msg_len[i] + tag_len[i] ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+
+            return( 1 );
+        }
+
+        pkt.input = res[i];
+        pkt.tag = (unsigned char *) res[i] + msg_len[i];
+
+        if( mbedtls_ccm_decrypt_batch( &ctx, &pkt, 1, NULL ) != 0 ||
+            memcmp( out, msg, msg_len[i] ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+
+            return( 1 );
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
     mbedtls_ccm_free( &ctx );
 
     if( verbose != 0 )
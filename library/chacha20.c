@@ -0,0 +1,430 @@
+/*
+ *  ChaCha20 stream cipher
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *  The ChaCha20 cipher was designed by Daniel J. Bernstein; the version
+ *  with a 96-bit nonce and 32-bit counter implemented here is the one
+ *  specified for IETF protocols in RFC 7539.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_CHACHA20_C)
+
+#include "mbedtls/chacha20.h"
+#include "mbedtls/constant_time.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#include "mbedtls/byte_order.h"
+
+#define ROTL32( value, amount ) \
+    ( (uint32_t) ( (value) << (amount) ) | ( (value) >> ( 32 - (amount) ) ) )
+
+#define CHACHA20_CTR_INDEX ( 12U )
+
+#define CHACHA20_BLOCK_SIZE_BYTES ( 4U * 16U )
+
+/*
+ * One ChaCha20 quarter round on four state words
+ */
+#define QUARTER_ROUND( a, b, c, d )             \
+{                                               \
+    a += b; d ^= a; d = ROTL32( d, 16 );        \
+    c += d; b ^= c; b = ROTL32( b, 12 );        \
+    a += b; d ^= a; d = ROTL32( d,  8 );        \
+    c += d; b ^= c; b = ROTL32( b,  7 );        \
+}
+
+/*
+ * Generate one 64-byte keystream block from the current state and
+ * increment the block counter. The 16 state words are kept in locals so
+ * the compiler can hold the working state in registers (and vectorize
+ * the independent quarter-round columns) across the 20 rounds.
+ */
+static void chacha20_block( mbedtls_chacha20_context *ctx,
+                            unsigned char keystream[64] )
+{
+    uint32_t x0  = ctx->state[ 0], x1  = ctx->state[ 1];
+    uint32_t x2  = ctx->state[ 2], x3  = ctx->state[ 3];
+    uint32_t x4  = ctx->state[ 4], x5  = ctx->state[ 5];
+    uint32_t x6  = ctx->state[ 6], x7  = ctx->state[ 7];
+    uint32_t x8  = ctx->state[ 8], x9  = ctx->state[ 9];
+    uint32_t x10 = ctx->state[10], x11 = ctx->state[11];
+    uint32_t x12 = ctx->state[12], x13 = ctx->state[13];
+    uint32_t x14 = ctx->state[14], x15 = ctx->state[15];
+    size_t i;
+
+    for( i = 0; i < 10; i++ )
+    {
+        /* Column rounds */
+        QUARTER_ROUND( x0, x4, x8,  x12 );
+        QUARTER_ROUND( x1, x5, x9,  x13 );
+        QUARTER_ROUND( x2, x6, x10, x14 );
+        QUARTER_ROUND( x3, x7, x11, x15 );
+
+        /* Diagonal rounds */
+        QUARTER_ROUND( x0, x5, x10, x15 );
+        QUARTER_ROUND( x1, x6, x11, x12 );
+        QUARTER_ROUND( x2, x7, x8,  x13 );
+        QUARTER_ROUND( x3, x4, x9,  x14 );
+    }
+
+    x0  += ctx->state[ 0]; x1  += ctx->state[ 1];
+    x2  += ctx->state[ 2]; x3  += ctx->state[ 3];
+    x4  += ctx->state[ 4]; x5  += ctx->state[ 5];
+    x6  += ctx->state[ 6]; x7  += ctx->state[ 7];
+    x8  += ctx->state[ 8]; x9  += ctx->state[ 9];
+    x10 += ctx->state[10]; x11 += ctx->state[11];
+    x12 += ctx->state[12]; x13 += ctx->state[13];
+    x14 += ctx->state[14]; x15 += ctx->state[15];
+
+    PUT_UINT32_LE( x0,  keystream,  0 );
+    PUT_UINT32_LE( x1,  keystream,  4 );
+    PUT_UINT32_LE( x2,  keystream,  8 );
+    PUT_UINT32_LE( x3,  keystream, 12 );
+    PUT_UINT32_LE( x4,  keystream, 16 );
+    PUT_UINT32_LE( x5,  keystream, 20 );
+    PUT_UINT32_LE( x6,  keystream, 24 );
+    PUT_UINT32_LE( x7,  keystream, 28 );
+    PUT_UINT32_LE( x8,  keystream, 32 );
+    PUT_UINT32_LE( x9,  keystream, 36 );
+    PUT_UINT32_LE( x10, keystream, 40 );
+    PUT_UINT32_LE( x11, keystream, 44 );
+    PUT_UINT32_LE( x12, keystream, 48 );
+    PUT_UINT32_LE( x13, keystream, 52 );
+    PUT_UINT32_LE( x14, keystream, 56 );
+    PUT_UINT32_LE( x15, keystream, 60 );
+
+    ctx->state[CHACHA20_CTR_INDEX]++;
+}
+
+void mbedtls_chacha20_init( mbedtls_chacha20_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_chacha20_context ) );
+
+    /* Mark the keystream buffer as fully consumed */
+    ctx->keystream_used = CHACHA20_BLOCK_SIZE_BYTES;
+}
+
+void mbedtls_chacha20_free( mbedtls_chacha20_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_zeroize( ctx, sizeof( mbedtls_chacha20_context ) );
+}
+
+int mbedtls_chacha20_setkey( mbedtls_chacha20_context *ctx,
+                             const unsigned char key[32] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA );
+
+    /* Constant "expand 32-byte k" */
+    ctx->state[0] = 0x61707865;
+    ctx->state[1] = 0x3320646E;
+    ctx->state[2] = 0x79622D32;
+    ctx->state[3] = 0x6B206574;
+
+    GET_UINT32_LE( ctx->state[ 4], key,  0 );
+    GET_UINT32_LE( ctx->state[ 5], key,  4 );
+    GET_UINT32_LE( ctx->state[ 6], key,  8 );
+    GET_UINT32_LE( ctx->state[ 7], key, 12 );
+    GET_UINT32_LE( ctx->state[ 8], key, 16 );
+    GET_UINT32_LE( ctx->state[ 9], key, 20 );
+    GET_UINT32_LE( ctx->state[10], key, 24 );
+    GET_UINT32_LE( ctx->state[11], key, 28 );
+
+    return( 0 );
+}
+
+int mbedtls_chacha20_starts( mbedtls_chacha20_context *ctx,
+                             const unsigned char nonce[12],
+                             uint32_t counter )
+{
+    if( ctx == NULL || nonce == NULL )
+        return( MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA );
+
+    ctx->state[12] = counter;
+
+    GET_UINT32_LE( ctx->state[13], nonce, 0 );
+    GET_UINT32_LE( ctx->state[14], nonce, 4 );
+    GET_UINT32_LE( ctx->state[15], nonce, 8 );
+
+    mbedtls_zeroize( ctx->keystream, sizeof( ctx->keystream ) );
+    ctx->keystream_used = CHACHA20_BLOCK_SIZE_BYTES;
+
+    return( 0 );
+}
+
+int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
+                             size_t size,
+                             const unsigned char *input,
+                             unsigned char *output )
+{
+    size_t offset = 0;
+    size_t i;
+
+    if( ctx == NULL || ( size != 0 && ( input == NULL || output == NULL ) ) )
+        return( MBEDTLS_ERR_CHACHA20_BAD_INPUT_DATA );
+
+    /* Use leftover keystream bytes, if any */
+    while( size > 0 && ctx->keystream_used < CHACHA20_BLOCK_SIZE_BYTES )
+    {
+        output[offset] = input[offset]
+                       ^ ctx->keystream[ctx->keystream_used];
+
+        ctx->keystream_used++;
+        offset++;
+        size--;
+    }
+
+    /* Process full blocks */
+    while( size >= CHACHA20_BLOCK_SIZE_BYTES )
+    {
+        chacha20_block( ctx, ctx->keystream );
+
+        for( i = 0; i < 64U; i += 8U )
+        {
+            output[offset + i    ] = input[offset + i    ] ^ ctx->keystream[i    ];
+            output[offset + i + 1] = input[offset + i + 1] ^ ctx->keystream[i + 1];
+            output[offset + i + 2] = input[offset + i + 2] ^ ctx->keystream[i + 2];
+            output[offset + i + 3] = input[offset + i + 3] ^ ctx->keystream[i + 3];
+            output[offset + i + 4] = input[offset + i + 4] ^ ctx->keystream[i + 4];
+            output[offset + i + 5] = input[offset + i + 5] ^ ctx->keystream[i + 5];
+            output[offset + i + 6] = input[offset + i + 6] ^ ctx->keystream[i + 6];
+            output[offset + i + 7] = input[offset + i + 7] ^ ctx->keystream[i + 7];
+        }
+
+        offset += CHACHA20_BLOCK_SIZE_BYTES;
+        size   -= CHACHA20_BLOCK_SIZE_BYTES;
+    }
+
+    /* Last (partial) block */
+    if( size > 0 )
+    {
+        chacha20_block( ctx, ctx->keystream );
+        ctx->keystream_used = 0;
+
+        for( i = 0; i < size; i++ )
+        {
+            output[offset + i] = input[offset + i] ^ ctx->keystream[i];
+            ctx->keystream_used++;
+        }
+    }
+
+    return( 0 );
+}
+
+int mbedtls_chacha20_crypt( const unsigned char key[32],
+                            const unsigned char nonce[12],
+                            uint32_t counter,
+                            size_t size,
+                            const unsigned char *input,
+                            unsigned char *output )
+{
+    mbedtls_chacha20_context ctx;
+    int ret;
+
+    mbedtls_chacha20_init( &ctx );
+
+    if( ( ret = mbedtls_chacha20_setkey( &ctx, key ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_chacha20_starts( &ctx, nonce, counter ) ) != 0 )
+        goto cleanup;
+
+    ret = mbedtls_chacha20_update( &ctx, size, input, output );
+
+cleanup:
+    mbedtls_chacha20_free( &ctx );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * RFC 7539 test vectors: section 2.3.2 (key stream against a zero
+ * plaintext) and section 2.4.2 (sunscreen text)
+ */
+static const unsigned char test_keys[2][32] =
+{
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+        0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+    }
+};
+
+static const unsigned char test_nonces[2][12] =
+{
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4a,
+        0x00, 0x00, 0x00, 0x00
+    }
+};
+
+static const uint32_t test_counters[2] = { 0U, 1U };
+
+static const unsigned char test_input[2][114] =
+{
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00
+    },
+    {
+        0x4c, 0x61, 0x64, 0x69, 0x65, 0x73, 0x20, 0x61,
+        0x6e, 0x64, 0x20, 0x47, 0x65, 0x6e, 0x74, 0x6c,
+        0x65, 0x6d, 0x65, 0x6e, 0x20, 0x6f, 0x66, 0x20,
+        0x74, 0x68, 0x65, 0x20, 0x63, 0x6c, 0x61, 0x73,
+        0x73, 0x20, 0x6f, 0x66, 0x20, 0x27, 0x39, 0x39,
+        0x3a, 0x20, 0x49, 0x66, 0x20, 0x49, 0x20, 0x63,
+        0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6f, 0x66, 0x66,
+        0x65, 0x72, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x6f,
+        0x6e, 0x6c, 0x79, 0x20, 0x6f, 0x6e, 0x65, 0x20,
+        0x74, 0x69, 0x70, 0x20, 0x66, 0x6f, 0x72, 0x20,
+        0x74, 0x68, 0x65, 0x20, 0x66, 0x75, 0x74, 0x75,
+        0x72, 0x65, 0x2c, 0x20, 0x73, 0x75, 0x6e, 0x73,
+        0x63, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x77, 0x6f,
+        0x75, 0x6c, 0x64, 0x20, 0x62, 0x65, 0x20, 0x69,
+        0x74, 0x2e
+    }
+};
+
+static const unsigned char test_output[2][114] =
+{
+    {
+        0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90,
+        0x40, 0x5d, 0x6a, 0xe5, 0x53, 0x86, 0xbd, 0x28,
+        0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d, 0xed, 0x1a,
+        0xa8, 0x36, 0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7,
+        0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d,
+        0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37,
+        0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c,
+        0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00
+    },
+    {
+        0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80,
+        0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81,
+        0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2,
+        0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b,
+        0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab,
+        0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+        0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab,
+        0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8,
+        0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61,
+        0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e,
+        0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06,
+        0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+        0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6,
+        0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42,
+        0x87, 0x4d
+    }
+};
+
+static const size_t test_lengths[2] = { 64U, 114U };
+
+int mbedtls_chacha20_self_test( int verbose )
+{
+    unsigned char output[114];
+    size_t i;
+    int ret;
+
+    for( i = 0; i < 2U; i++ )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "  CHACHA20 test #%u: ", (unsigned) i + 1 );
+
+        ret = mbedtls_chacha20_crypt( test_keys[i], test_nonces[i],
+                                      test_counters[i], test_lengths[i],
+                                      test_input[i], output );
+
+        if( ret != 0 || memcmp( output, test_output[i],
+                                test_lengths[i] ) != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "failed\n" );
+
+            return( 1 );
+        }
+
+        if( verbose != 0 )
+            mbedtls_printf( "passed\n" );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "\n" );
+
+    return( 0 );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_CHACHA20_C */
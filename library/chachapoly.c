@@ -0,0 +1,388 @@
+/*
+ *  ChaCha20-Poly1305 AEAD construction
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *  Definition in RFC 7539, section 2.8: the Poly1305 one-time key is
+ *  taken from ChaCha20 block 0, the data is encrypted starting at block
+ *  1, and the tag covers padded AAD || padded ciphertext || lengths.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+
+#include "mbedtls/chachapoly.h"
+#include "mbedtls/constant_time.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#define CHACHAPOLY_ENCRYPT ( 0 )
+#define CHACHAPOLY_DECRYPT ( 1 )
+
+void mbedtls_chachapoly_init( mbedtls_chachapoly_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_chacha20_init( &ctx->chacha20_ctx );
+    mbedtls_poly1305_init( &ctx->poly1305_ctx );
+}
+
+void mbedtls_chachapoly_free( mbedtls_chachapoly_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_chacha20_free( &ctx->chacha20_ctx );
+    mbedtls_poly1305_free( &ctx->poly1305_ctx );
+}
+
+int mbedtls_chachapoly_setkey( mbedtls_chachapoly_context *ctx,
+                               const unsigned char key[32] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA );
+
+    return( mbedtls_chacha20_setkey( &ctx->chacha20_ctx, key ) );
+}
+
+/*
+ * Authenticate padded AAD and ciphertext and compute the tag; on
+ * encryption the ciphertext is produced along the way
+ */
+static int chachapoly_crypt_and_tag( mbedtls_chachapoly_context *ctx,
+                                     int mode,
+                                     size_t length,
+                                     const unsigned char nonce[12],
+                                     const unsigned char *aad,
+                                     size_t aad_len,
+                                     const unsigned char *input,
+                                     unsigned char *output,
+                                     unsigned char tag[16] )
+{
+    unsigned char poly1305_key[64];
+    unsigned char len_block[16];
+    static const unsigned char zeroes[15] = { 0 };
+    size_t partial;
+    int ret;
+
+    /*
+     * Derive the per-nonce Poly1305 key from ChaCha20 block 0; the
+     * second half of the block is discarded
+     */
+    if( ( ret = mbedtls_chacha20_starts( &ctx->chacha20_ctx,
+                                         nonce, 0U ) ) != 0 )
+        goto cleanup;
+
+    memset( poly1305_key, 0, sizeof( poly1305_key ) );
+    if( ( ret = mbedtls_chacha20_update( &ctx->chacha20_ctx,
+                                         sizeof( poly1305_key ),
+                                         poly1305_key,
+                                         poly1305_key ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_poly1305_starts( &ctx->poly1305_ctx,
+                                         poly1305_key ) ) != 0 )
+        goto cleanup;
+
+    /* AAD, zero-padded to a multiple of 16 bytes */
+    if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx,
+                                         aad, aad_len ) ) != 0 )
+        goto cleanup;
+
+    partial = aad_len % 16U;
+    if( partial != 0 )
+    {
+        if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, zeroes,
+                                             16U - partial ) ) != 0 )
+            goto cleanup;
+    }
+
+    /* Data starts at ChaCha20 block 1; the tag always covers the
+     * ciphertext, which is the input when decrypting and the output
+     * when encrypting. Authenticate before decrypting so that the
+     * common in-place case ( input == output ) still sees the
+     * ciphertext */
+    if( mode == CHACHAPOLY_DECRYPT )
+    {
+        if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx,
+                                             input, length ) ) != 0 )
+            goto cleanup;
+    }
+
+    if( ( ret = mbedtls_chacha20_update( &ctx->chacha20_ctx, length,
+                                         input, output ) ) != 0 )
+        goto cleanup;
+
+    if( mode == CHACHAPOLY_ENCRYPT )
+    {
+        if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx,
+                                             output, length ) ) != 0 )
+            goto cleanup;
+    }
+
+    partial = length % 16U;
+    if( partial != 0 )
+    {
+        if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, zeroes,
+                                             16U - partial ) ) != 0 )
+            goto cleanup;
+    }
+
+    /* The lengths of the AAD and of the ciphertext, as 64-bit
+     * little-endian integers */
+    len_block[ 0] = (unsigned char) ( aad_len       );
+    len_block[ 1] = (unsigned char) ( aad_len >>  8 );
+    len_block[ 2] = (unsigned char) ( aad_len >> 16 );
+    len_block[ 3] = (unsigned char) ( aad_len >> 24 );
+    len_block[ 4] = (unsigned char) ( (uint64_t) aad_len >> 32 );
+    len_block[ 5] = (unsigned char) ( (uint64_t) aad_len >> 40 );
+    len_block[ 6] = (unsigned char) ( (uint64_t) aad_len >> 48 );
+    len_block[ 7] = (unsigned char) ( (uint64_t) aad_len >> 56 );
+    len_block[ 8] = (unsigned char) ( length       );
+    len_block[ 9] = (unsigned char) ( length >>  8 );
+    len_block[10] = (unsigned char) ( length >> 16 );
+    len_block[11] = (unsigned char) ( length >> 24 );
+    len_block[12] = (unsigned char) ( (uint64_t) length >> 32 );
+    len_block[13] = (unsigned char) ( (uint64_t) length >> 40 );
+    len_block[14] = (unsigned char) ( (uint64_t) length >> 48 );
+    len_block[15] = (unsigned char) ( (uint64_t) length >> 56 );
+
+    if( ( ret = mbedtls_poly1305_update( &ctx->poly1305_ctx,
+                                         len_block, 16U ) ) != 0 )
+        goto cleanup;
+
+    ret = mbedtls_poly1305_finish( &ctx->poly1305_ctx, tag );
+
+cleanup:
+    mbedtls_zeroize( poly1305_key, sizeof( poly1305_key ) );
+
+    return( ret );
+}
+
+int mbedtls_chachapoly_encrypt_and_tag( mbedtls_chachapoly_context *ctx,
+                                        size_t length,
+                                        const unsigned char nonce[12],
+                                        const unsigned char *aad,
+                                        size_t aad_len,
+                                        const unsigned char *input,
+                                        unsigned char *output,
+                                        unsigned char tag[16] )
+{
+    if( ctx == NULL || nonce == NULL || tag == NULL ||
+        ( aad_len != 0 && aad == NULL ) ||
+        ( length != 0 && ( input == NULL || output == NULL ) ) )
+    {
+        return( MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA );
+    }
+
+    return( chachapoly_crypt_and_tag( ctx, CHACHAPOLY_ENCRYPT, length,
+                                      nonce, aad, aad_len,
+                                      input, output, tag ) );
+}
+
+int mbedtls_chachapoly_auth_decrypt( mbedtls_chachapoly_context *ctx,
+                                     size_t length,
+                                     const unsigned char nonce[12],
+                                     const unsigned char *aad,
+                                     size_t aad_len,
+                                     const unsigned char tag[16],
+                                     const unsigned char *input,
+                                     unsigned char *output )
+{
+    unsigned char check_tag[16];
+    int ret;
+
+    if( ctx == NULL || nonce == NULL || tag == NULL ||
+        ( aad_len != 0 && aad == NULL ) ||
+        ( length != 0 && ( input == NULL || output == NULL ) ) )
+    {
+        return( MBEDTLS_ERR_CHACHAPOLY_BAD_INPUT_DATA );
+    }
+
+    if( ( ret = chachapoly_crypt_and_tag( ctx, CHACHAPOLY_DECRYPT, length,
+                                          nonce, aad, aad_len,
+                                          input, output, check_tag ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    if( mbedtls_ct_memcmp( tag, check_tag, sizeof( check_tag ) ) != 0 )
+    {
+        mbedtls_zeroize( output, length );
+        return( MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED );
+    }
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * Test vector from RFC 7539, section 2.8.2
+ */
+static const unsigned char test_key[32] =
+{
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f
+};
+
+static const unsigned char test_nonce[12] =
+{
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43,
+    0x44, 0x45, 0x46, 0x47
+};
+
+static const unsigned char test_aad[12] =
+{
+    0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7
+};
+
+static const unsigned char test_input[114] =
+{
+    0x4c, 0x61, 0x64, 0x69, 0x65, 0x73, 0x20, 0x61,
+    0x6e, 0x64, 0x20, 0x47, 0x65, 0x6e, 0x74, 0x6c,
+    0x65, 0x6d, 0x65, 0x6e, 0x20, 0x6f, 0x66, 0x20,
+    0x74, 0x68, 0x65, 0x20, 0x63, 0x6c, 0x61, 0x73,
+    0x73, 0x20, 0x6f, 0x66, 0x20, 0x27, 0x39, 0x39,
+    0x3a, 0x20, 0x49, 0x66, 0x20, 0x49, 0x20, 0x63,
+    0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6f, 0x66, 0x66,
+    0x65, 0x72, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x6f,
+    0x6e, 0x6c, 0x79, 0x20, 0x6f, 0x6e, 0x65, 0x20,
+    0x74, 0x69, 0x70, 0x20, 0x66, 0x6f, 0x72, 0x20,
+    0x74, 0x68, 0x65, 0x20, 0x66, 0x75, 0x74, 0x75,
+    0x72, 0x65, 0x2c, 0x20, 0x73, 0x75, 0x6e, 0x73,
+    0x63, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x77, 0x6f,
+    0x75, 0x6c, 0x64, 0x20, 0x62, 0x65, 0x20, 0x69,
+    0x74, 0x2e
+};
+
+static const unsigned char test_output[114] =
+{
+    0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb,
+    0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+    0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+    0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+    0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12,
+    0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+    0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29,
+    0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+    0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+    0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+    0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94,
+    0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+    0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d,
+    0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+    0x61, 0x16
+};
+
+static const unsigned char test_tag[16] =
+{
+    0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a,
+    0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91
+};
+
+int mbedtls_chachapoly_self_test( int verbose )
+{
+    mbedtls_chachapoly_context ctx;
+    unsigned char output[114];
+    unsigned char tag[16];
+    int ret;
+
+    mbedtls_chachapoly_init( &ctx );
+
+    if( verbose != 0 )
+        mbedtls_printf( "  CHACHA20-POLY1305 test #1 (enc): " );
+
+    if( ( ret = mbedtls_chachapoly_setkey( &ctx, test_key ) ) != 0 )
+        goto fail;
+
+    ret = mbedtls_chachapoly_encrypt_and_tag( &ctx, sizeof( test_input ),
+                                              test_nonce,
+                                              test_aad, sizeof( test_aad ),
+                                              test_input, output, tag );
+
+    if( ret != 0 ||
+        memcmp( output, test_output, sizeof( test_output ) ) != 0 ||
+        memcmp( tag, test_tag, sizeof( test_tag ) ) != 0 )
+    {
+        goto fail;
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n  CHACHA20-POLY1305 test #2 (dec): " );
+
+    ret = mbedtls_chachapoly_auth_decrypt( &ctx, sizeof( test_output ),
+                                           test_nonce,
+                                           test_aad, sizeof( test_aad ),
+                                           test_tag, test_output, output );
+
+    if( ret != 0 ||
+        memcmp( output, test_input, sizeof( test_input ) ) != 0 )
+    {
+        goto fail;
+    }
+
+    /* A corrupted tag must be rejected */
+    tag[0] ^= 1;
+    ret = mbedtls_chachapoly_auth_decrypt( &ctx, sizeof( test_output ),
+                                           test_nonce,
+                                           test_aad, sizeof( test_aad ),
+                                           tag, test_output, output );
+
+    if( ret != MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED )
+        goto fail;
+
+    mbedtls_chachapoly_free( &ctx );
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n\n" );
+
+    return( 0 );
+
+fail:
+    mbedtls_chachapoly_free( &ctx );
+
+    if( verbose != 0 )
+        mbedtls_printf( "failed\n" );
+
+    return( 1 );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_CHACHAPOLY_C */
@@ -46,14 +46,77 @@
 #include "mbedtls/ccm.h"
 #endif
 
+#if defined(MBEDTLS_CHACHAPOLY_C)
+#include "mbedtls/chachapoly.h"
+#endif
+
 #if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
 #define MBEDTLS_CIPHER_MODE_STREAM
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
+
+#if defined(MBEDTLS_MEMORY_TAGGING)
+#include "mbedtls/memory_buffer_alloc.h"
+#endif
+
+/*
+ * Block-mode dispatch. With MBEDTLS_SINGLE_BACKEND_DISPATCH the only
+ * cipher module is AES (enforced in check_config.h), so the per-block
+ * ECB/CBC/CFB/CTR calls go to the AES primitives directly and can be
+ * inlined. Key setup, XTS and stream dispatch stay behind the base
+ * function pointers: they run once per key or use a different context
+ * type, so there is nothing to gain from specializing them.
+ */
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH)
+#include "mbedtls/aes.h"
+
+#define CIPHER_ECB( ctx, operation, input, output )                     \
+    mbedtls_aes_crypt_ecb( (mbedtls_aes_context *) (ctx)->cipher_ctx,   \
+                           (operation), (input), (output) )
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+#define CIPHER_CBC( ctx, operation, length, iv, input, output )         \
+    mbedtls_aes_crypt_cbc( (mbedtls_aes_context *) (ctx)->cipher_ctx,   \
+                           (operation), (length), (iv), (input), (output) )
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+#define CIPHER_CFB( ctx, operation, length, iv_off, iv, input, output ) \
+    mbedtls_aes_crypt_cfb128( (mbedtls_aes_context *) (ctx)->cipher_ctx, \
+                              (operation), (length), (iv_off), (iv),    \
+                              (input), (output) )
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+#define CIPHER_CTR( ctx, length, nc_off, nonce_counter, stream_block,   \
+                    input, output )                                     \
+    mbedtls_aes_crypt_ctr( (mbedtls_aes_context *) (ctx)->cipher_ctx,   \
+                           (length), (nc_off), (nonce_counter),         \
+                           (stream_block), (input), (output) )
+#endif
+#else /* MBEDTLS_SINGLE_BACKEND_DISPATCH */
+#define CIPHER_ECB( ctx, operation, input, output )                     \
+    (ctx)->cipher_info->base->ecb_func( (ctx)->cipher_ctx,              \
+                                        (operation), (input), (output) )
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+#define CIPHER_CBC( ctx, operation, length, iv, input, output )         \
+    (ctx)->cipher_info->base->cbc_func( (ctx)->cipher_ctx,              \
+                                        (operation), (length), (iv),    \
+                                        (input), (output) )
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+#define CIPHER_CFB( ctx, operation, length, iv_off, iv, input, output ) \
+    (ctx)->cipher_info->base->cfb_func( (ctx)->cipher_ctx,              \
+                                        (operation), (length), (iv_off), \
+                                        (iv), (input), (output) )
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+#define CIPHER_CTR( ctx, length, nc_off, nonce_counter, stream_block,   \
+                    input, output )                                     \
+    (ctx)->cipher_info->base->ctr_func( (ctx)->cipher_ctx,              \
+                                        (length), (nc_off),             \
+                                        (nonce_counter), (stream_block), \
+                                        (input), (output) )
+#endif
+#endif /* MBEDTLS_SINGLE_BACKEND_DISPATCH */
 
 static int supported_init = 0;
 
@@ -78,16 +141,8 @@ const int *mbedtls_cipher_list( void )
     return( mbedtls_cipher_supported );
 }
 
-const mbedtls_cipher_info_t *mbedtls_cipher_info_from_type( const mbedtls_cipher_type_t cipher_type )
-{
-    const mbedtls_cipher_definition_t *def;
-
-    for( def = mbedtls_cipher_definitions; def->info != NULL; def++ )
-        if( def->type == cipher_type )
-            return( def->info );
-
-    return( NULL );
-}
+/* mbedtls_cipher_info_from_type() lives in cipher_wrap.c: it is a direct
+ * switch over the static info structures defined there */
 
 const mbedtls_cipher_info_t *mbedtls_cipher_info_from_string( const char *cipher_name )
 {
@@ -136,14 +191,41 @@ void mbedtls_cipher_free( mbedtls_cipher_context_t *ctx )
 
 int mbedtls_cipher_setup( mbedtls_cipher_context_t *ctx, const mbedtls_cipher_info_t *cipher_info )
 {
+    void *cipher_ctx = NULL;
+
     if( NULL == cipher_info || NULL == ctx )
         return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
 
+    if( ctx->cipher_ctx != NULL && ctx->cipher_info != NULL )
+    {
+        if( ctx->cipher_info->base == cipher_info->base )
+        {
+            /* Same underlying cipher: keep the allocated context and let
+             * the next setkey overwrite the old schedule */
+            cipher_ctx = ctx->cipher_ctx;
+        }
+        else
+            ctx->cipher_info->base->ctx_free_func( ctx->cipher_ctx );
+    }
+
     memset( ctx, 0, sizeof( mbedtls_cipher_context_t ) );
 
-    if( NULL == ( ctx->cipher_ctx = cipher_info->base->ctx_alloc_func() ) )
-        return( MBEDTLS_ERR_CIPHER_ALLOC_FAILED );
+    if( cipher_ctx == NULL )
+    {
+#if defined(MBEDTLS_MEMORY_TAGGING)
+        int prev_tag =
+            mbedtls_memory_buffer_set_tag( MBEDTLS_MEMORY_TAG_CIPHER );
+#endif
+        cipher_ctx = cipher_info->base->ctx_alloc_func();
+#if defined(MBEDTLS_MEMORY_TAGGING)
+        (void) mbedtls_memory_buffer_set_tag( prev_tag );
+#endif
+
+        if( cipher_ctx == NULL )
+            return( MBEDTLS_ERR_CIPHER_ALLOC_FAILED );
+    }
 
+    ctx->cipher_ctx = cipher_ctx;
     ctx->cipher_info = cipher_info;
 
 #if defined(MBEDTLS_CIPHER_MODE_WITH_PADDING)
@@ -268,7 +350,7 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
 
         *olen = ilen;
 
-        if( 0 != ( ret = ctx->cipher_info->base->ecb_func( ctx->cipher_ctx,
+        if( 0 != ( ret = CIPHER_ECB( ctx,
                     ctx->operation, input, output ) ) )
         {
             return( ret );
@@ -286,6 +368,25 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
     }
 #endif
 
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    if( ctx->cipher_info->mode == MBEDTLS_MODE_XTS )
+    {
+        /* XTS processes one whole data unit per call: no streaming */
+        if( ctx->unprocessed_len > 0 )
+            return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+
+        if( 0 != ( ret = ctx->cipher_info->base->xts_func( ctx->cipher_ctx,
+                ctx->operation, ilen, ctx->iv, input, output ) ) )
+        {
+            return( ret );
+        }
+
+        *olen = ilen;
+
+        return( 0 );
+    }
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
     if( input == output &&
        ( ctx->unprocessed_len != 0 || ilen % mbedtls_cipher_get_block_size( ctx ) ) )
     {
@@ -322,7 +423,7 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
             memcpy( &( ctx->unprocessed_data[ctx->unprocessed_len] ), input,
                     copy_len );
 
-            if( 0 != ( ret = ctx->cipher_info->base->cbc_func( ctx->cipher_ctx,
+            if( 0 != ( ret = CIPHER_CBC( ctx,
                     ctx->operation, mbedtls_cipher_get_block_size( ctx ), ctx->iv,
                     ctx->unprocessed_data, output ) ) )
             {
@@ -358,7 +459,7 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
          */
         if( ilen )
         {
-            if( 0 != ( ret = ctx->cipher_info->base->cbc_func( ctx->cipher_ctx,
+            if( 0 != ( ret = CIPHER_CBC( ctx,
                     ctx->operation, ilen, ctx->iv, input, output ) ) )
             {
                 return( ret );
@@ -374,7 +475,7 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
 #if defined(MBEDTLS_CIPHER_MODE_CFB)
     if( ctx->cipher_info->mode == MBEDTLS_MODE_CFB )
     {
-        if( 0 != ( ret = ctx->cipher_info->base->cfb_func( ctx->cipher_ctx,
+        if( 0 != ( ret = CIPHER_CFB( ctx,
                 ctx->operation, ilen, &ctx->unprocessed_len, ctx->iv,
                 input, output ) ) )
         {
@@ -390,7 +491,7 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     if( ctx->cipher_info->mode == MBEDTLS_MODE_CTR )
     {
-        if( 0 != ( ret = ctx->cipher_info->base->ctr_func( ctx->cipher_ctx,
+        if( 0 != ( ret = CIPHER_CTR( ctx,
                 ilen, &ctx->unprocessed_len, ctx->iv,
                 ctx->unprocessed_data, input, output ) ) )
         {
@@ -421,6 +522,133 @@ int mbedtls_cipher_update( mbedtls_cipher_context_t *ctx, const unsigned char *i
     return( MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE );
 }
 
+int mbedtls_cipher_update_aligned( mbedtls_cipher_context_t *ctx,
+                   const unsigned char *input, size_t ilen,
+                   unsigned char *output, size_t *olen )
+{
+    int ret;
+
+    if( NULL == ctx || NULL == ctx->cipher_info || NULL == olen )
+    {
+        return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+    }
+
+    *olen = 0;
+
+    if( ctx->cipher_info->mode == MBEDTLS_MODE_ECB
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+        || ctx->cipher_info->mode == MBEDTLS_MODE_CBC
+#endif
+      )
+    {
+        if( ctx->unprocessed_len != 0 ||
+            ilen % mbedtls_cipher_get_block_size( ctx ) != 0 )
+        {
+            return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+        }
+    }
+
+    if( ctx->cipher_info->mode == MBEDTLS_MODE_ECB )
+    {
+        size_t block_size = mbedtls_cipher_get_block_size( ctx );
+
+        while( ilen > 0 )
+        {
+            if( 0 != ( ret = CIPHER_ECB( ctx,
+                        ctx->operation, input, output ) ) )
+            {
+                return( ret );
+            }
+
+            input += block_size;
+            output += block_size;
+            *olen += block_size;
+            ilen -= block_size;
+        }
+
+        return( 0 );
+    }
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+    if( ctx->cipher_info->mode == MBEDTLS_MODE_CBC )
+    {
+        if( ilen > 0 &&
+            0 != ( ret = CIPHER_CBC( ctx,
+                    ctx->operation, ilen, ctx->iv, input, output ) ) )
+        {
+            return( ret );
+        }
+
+        *olen = ilen;
+
+        return( 0 );
+    }
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+    /* The remaining modes keep no block-stitching state */
+    return( mbedtls_cipher_update( ctx, input, ilen, output, olen ) );
+}
+
+#if defined(MBEDTLS_MD_C)
+/*
+ * Chunk size for interleaving the cipher and the HMAC: small enough that
+ * a chunk of output is still in L1 when the digest reads it back, large
+ * enough to amortize the per-call overhead. Kept a multiple of every
+ * block size so GCM's alignment requirement is preserved.
+ */
+#define CIPHER_HMAC_CHUNK_SIZE  4096
+
+int mbedtls_cipher_update_hmac( mbedtls_cipher_context_t *ctx,
+                   mbedtls_md_context_t *md_ctx,
+                   const unsigned char *input, size_t ilen,
+                   unsigned char *output, size_t *olen,
+                   int mac_output )
+{
+    int ret;
+    size_t part, part_olen;
+
+    if( NULL == ctx || NULL == ctx->cipher_info || NULL == md_ctx ||
+        NULL == olen )
+    {
+        return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+    }
+
+    *olen = 0;
+
+    while( ilen > 0 )
+    {
+        part = ( ilen > CIPHER_HMAC_CHUNK_SIZE ) ?
+                   CIPHER_HMAC_CHUNK_SIZE : ilen;
+
+        if( mac_output == 0 &&
+            ( ret = mbedtls_md_hmac_update( md_ctx, input, part ) ) != 0 )
+        {
+            return( ret );
+        }
+
+        if( ( ret = mbedtls_cipher_update( ctx, input, part,
+                                           output + *olen,
+                                           &part_olen ) ) != 0 )
+        {
+            return( ret );
+        }
+
+        if( mac_output != 0 &&
+            ( ret = mbedtls_md_hmac_update( md_ctx, output + *olen,
+                                            part_olen ) ) != 0 )
+        {
+            return( ret );
+        }
+
+        input += part;
+        ilen -= part;
+        *olen += part_olen;
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_MD_C */
+
 #if defined(MBEDTLS_CIPHER_MODE_WITH_PADDING)
 #if defined(MBEDTLS_CIPHER_PADDING_PKCS7)
 /*
@@ -604,6 +832,7 @@ int mbedtls_cipher_finish( mbedtls_cipher_context_t *ctx,
     if( MBEDTLS_MODE_CFB == ctx->cipher_info->mode ||
         MBEDTLS_MODE_CTR == ctx->cipher_info->mode ||
         MBEDTLS_MODE_GCM == ctx->cipher_info->mode ||
+        MBEDTLS_MODE_XTS == ctx->cipher_info->mode ||
         MBEDTLS_MODE_STREAM == ctx->cipher_info->mode )
     {
         return( 0 );
@@ -649,7 +878,7 @@ int mbedtls_cipher_finish( mbedtls_cipher_context_t *ctx,
         }
 
         /* cipher block */
-        if( 0 != ( ret = ctx->cipher_info->base->cbc_func( ctx->cipher_ctx,
+        if( 0 != ( ret = CIPHER_CBC( ctx,
                 ctx->operation, mbedtls_cipher_get_block_size( ctx ), ctx->iv,
                 ctx->unprocessed_data, output ) ) )
         {
@@ -833,6 +1062,17 @@ int mbedtls_cipher_auth_encrypt( mbedtls_cipher_context_t *ctx,
                                      tag, tag_len ) );
     }
 #endif /* MBEDTLS_CCM_C */
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if( MBEDTLS_MODE_CHACHAPOLY == ctx->cipher_info->mode )
+    {
+        if( iv_len != 12 || tag_len != 16 )
+            return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+
+        *olen = ilen;
+        return( mbedtls_chachapoly_encrypt_and_tag( ctx->cipher_ctx,
+                                ilen, iv, ad, ad_len, input, output, tag ) );
+    }
+#endif /* MBEDTLS_CHACHAPOLY_C */
 
     return( MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE );
 }
@@ -879,6 +1119,24 @@ int mbedtls_cipher_auth_decrypt( mbedtls_cipher_context_t *ctx,
         return( ret );
     }
 #endif /* MBEDTLS_CCM_C */
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if( MBEDTLS_MODE_CHACHAPOLY == ctx->cipher_info->mode )
+    {
+        int ret;
+
+        if( iv_len != 12 || tag_len != 16 )
+            return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+
+        *olen = ilen;
+        ret = mbedtls_chachapoly_auth_decrypt( ctx->cipher_ctx, ilen,
+                                iv, ad, ad_len, tag, input, output );
+
+        if( ret == MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED )
+            ret = MBEDTLS_ERR_CIPHER_AUTH_FAILED;
+
+        return( ret );
+    }
+#endif /* MBEDTLS_CHACHAPOLY_C */
 
     return( MBEDTLS_ERR_CIPHER_FEATURE_UNAVAILABLE );
 }
@@ -62,6 +62,10 @@
 #include "mbedtls/ccm.h"
 #endif
 
+#if defined(MBEDTLS_CHACHAPOLY_C)
+#include "mbedtls/chachapoly.h"
+#endif
+
 #if defined(MBEDTLS_CIPHER_NULL_CIPHER)
 #include <string.h>
 #endif
@@ -191,6 +195,9 @@ static const mbedtls_cipher_base_t aes_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     aes_crypt_ctr_wrap,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -338,6 +345,94 @@ static const mbedtls_cipher_info_t aes_256_ctr_info = {
 };
 #endif /* MBEDTLS_CIPHER_MODE_CTR */
 
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+static int xts_aes_crypt_wrap( void *ctx, mbedtls_operation_t operation,
+        size_t length, const unsigned char data_unit[16],
+        const unsigned char *input, unsigned char *output )
+{
+    return mbedtls_aes_crypt_xts( (mbedtls_aes_xts_context *) ctx, operation,
+                                  length, data_unit, input, output );
+}
+
+static int xts_aes_setkey_enc_wrap( void *ctx, const unsigned char *key,
+                                    unsigned int key_bitlen )
+{
+    return mbedtls_aes_xts_setkey_enc( (mbedtls_aes_xts_context *) ctx,
+                                       key, key_bitlen );
+}
+
+static int xts_aes_setkey_dec_wrap( void *ctx, const unsigned char *key,
+                                    unsigned int key_bitlen )
+{
+    return mbedtls_aes_xts_setkey_dec( (mbedtls_aes_xts_context *) ctx,
+                                       key, key_bitlen );
+}
+
+static void *xts_aes_ctx_alloc( void )
+{
+    mbedtls_aes_xts_context *xts = mbedtls_calloc( 1, sizeof( *xts ) );
+
+    if( xts == NULL )
+        return( NULL );
+
+    mbedtls_aes_xts_init( xts );
+
+    return( xts );
+}
+
+static void xts_aes_ctx_free( void *ctx )
+{
+    mbedtls_aes_xts_free( (mbedtls_aes_xts_context *) ctx );
+    mbedtls_free( ctx );
+}
+
+static const mbedtls_cipher_base_t xts_aes_info = {
+    MBEDTLS_CIPHER_ID_AES,
+    NULL,
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    xts_aes_crypt_wrap,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_STREAM)
+    NULL,
+#endif
+    xts_aes_setkey_enc_wrap,
+    xts_aes_setkey_dec_wrap,
+    xts_aes_ctx_alloc,
+    xts_aes_ctx_free
+};
+
+static const mbedtls_cipher_info_t aes_128_xts_info = {
+    MBEDTLS_CIPHER_AES_128_XTS,
+    MBEDTLS_MODE_XTS,
+    256,
+    "AES-128-XTS",
+    16,
+    0,
+    16,
+    &xts_aes_info
+};
+
+static const mbedtls_cipher_info_t aes_256_xts_info = {
+    MBEDTLS_CIPHER_AES_256_XTS,
+    MBEDTLS_MODE_XTS,
+    512,
+    "AES-256-XTS",
+    16,
+    0,
+    16,
+    &xts_aes_info
+};
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
 #if defined(MBEDTLS_GCM_C)
 static int gcm_aes_setkey_wrap( void *ctx, const unsigned char *key,
                                 unsigned int key_bitlen )
@@ -358,6 +453,9 @@ static const mbedtls_cipher_base_t gcm_aes_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -421,6 +519,9 @@ static const mbedtls_cipher_base_t ccm_aes_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -548,6 +649,9 @@ static const mbedtls_cipher_base_t camellia_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     camellia_crypt_ctr_wrap,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -715,6 +819,9 @@ static const mbedtls_cipher_base_t gcm_camellia_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -778,6 +885,9 @@ static const mbedtls_cipher_base_t ccm_camellia_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -954,6 +1064,9 @@ static const mbedtls_cipher_base_t des_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -999,6 +1112,9 @@ static const mbedtls_cipher_base_t des_ede_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -1044,6 +1160,9 @@ static const mbedtls_cipher_base_t des_ede3_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -1153,6 +1272,9 @@ static const mbedtls_cipher_base_t blowfish_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     blowfish_crypt_ctr_wrap,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     NULL,
 #endif
@@ -1263,6 +1385,9 @@ static const mbedtls_cipher_base_t arc4_base_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     arc4_crypt_stream_wrap,
 #endif
@@ -1284,6 +1409,73 @@ static const mbedtls_cipher_info_t arc4_128_info = {
 };
 #endif /* MBEDTLS_ARC4_C */
 
+#if defined(MBEDTLS_CHACHAPOLY_C)
+static int chachapoly_setkey_wrap( void *ctx,
+                                   const unsigned char *key,
+                                   unsigned int key_bitlen )
+{
+    if( key_bitlen != 256U )
+        return( MBEDTLS_ERR_CIPHER_BAD_INPUT_DATA );
+
+    return mbedtls_chachapoly_setkey( (mbedtls_chachapoly_context *) ctx,
+                                      key );
+}
+
+static void * chachapoly_ctx_alloc( void )
+{
+    mbedtls_chachapoly_context *ctx;
+    ctx = mbedtls_calloc( 1, sizeof( mbedtls_chachapoly_context ) );
+
+    if( ctx == NULL )
+        return( NULL );
+
+    mbedtls_chachapoly_init( ctx );
+
+    return( ctx );
+}
+
+static void chachapoly_ctx_free( void *ctx )
+{
+    mbedtls_chachapoly_free( (mbedtls_chachapoly_context *) ctx );
+    mbedtls_free( ctx );
+}
+
+static const mbedtls_cipher_base_t chachapoly_base_info = {
+    MBEDTLS_CIPHER_ID_CHACHA20,
+    NULL,
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_STREAM)
+    NULL,
+#endif
+    chachapoly_setkey_wrap,
+    chachapoly_setkey_wrap,
+    chachapoly_ctx_alloc,
+    chachapoly_ctx_free
+};
+
+static const mbedtls_cipher_info_t chachapoly_info = {
+    MBEDTLS_CIPHER_CHACHA20_POLY1305,
+    MBEDTLS_MODE_CHACHAPOLY,
+    256,
+    "CHACHA20-POLY1305",
+    12,
+    0,
+    64,
+    &chachapoly_base_info
+};
+#endif /* MBEDTLS_CHACHAPOLY_C */
+
 #if defined(MBEDTLS_CIPHER_NULL_CIPHER)
 static int null_crypt_stream( void *ctx, size_t length,
                               const unsigned char *input,
@@ -1326,6 +1518,9 @@ static const mbedtls_cipher_base_t null_base_info = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     NULL,
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    NULL,
+#endif
 #if defined(MBEDTLS_CIPHER_MODE_STREAM)
     null_crypt_stream,
 #endif
@@ -1368,6 +1563,10 @@ const mbedtls_cipher_definition_t mbedtls_cipher_definitions[] =
     { MBEDTLS_CIPHER_AES_192_CTR,          &aes_192_ctr_info },
     { MBEDTLS_CIPHER_AES_256_CTR,          &aes_256_ctr_info },
 #endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    { MBEDTLS_CIPHER_AES_128_XTS,          &aes_128_xts_info },
+    { MBEDTLS_CIPHER_AES_256_XTS,          &aes_256_xts_info },
+#endif
 #if defined(MBEDTLS_GCM_C)
     { MBEDTLS_CIPHER_AES_128_GCM,          &aes_128_gcm_info },
     { MBEDTLS_CIPHER_AES_192_GCM,          &aes_192_gcm_info },
@@ -1439,6 +1638,10 @@ const mbedtls_cipher_definition_t mbedtls_cipher_definitions[] =
 #endif
 #endif /* MBEDTLS_DES_C */
 
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    { MBEDTLS_CIPHER_CHACHA20_POLY1305,    &chachapoly_info },
+#endif
+
 #if defined(MBEDTLS_CIPHER_NULL_CIPHER)
     { MBEDTLS_CIPHER_NULL,                 &null_cipher_info },
 #endif /* MBEDTLS_CIPHER_NULL_CIPHER */
@@ -1449,4 +1652,120 @@ const mbedtls_cipher_definition_t mbedtls_cipher_definitions[] =
 #define NUM_CIPHERS sizeof mbedtls_cipher_definitions / sizeof mbedtls_cipher_definitions[0]
 int mbedtls_cipher_supported[NUM_CIPHERS];
 
+/*
+ * Direct lookup instead of a walk over mbedtls_cipher_definitions: this is
+ * on the path of every mbedtls_cipher_setup() and handshake key derivation,
+ * and the switch compiles to a jump table (like mbedtls_md_info_from_type).
+ */
+const mbedtls_cipher_info_t *mbedtls_cipher_info_from_type( const mbedtls_cipher_type_t cipher_type )
+{
+    switch( cipher_type )
+    {
+#if defined(MBEDTLS_AES_C)
+        case MBEDTLS_CIPHER_AES_128_ECB:          return( &aes_128_ecb_info );
+        case MBEDTLS_CIPHER_AES_192_ECB:          return( &aes_192_ecb_info );
+        case MBEDTLS_CIPHER_AES_256_ECB:          return( &aes_256_ecb_info );
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+        case MBEDTLS_CIPHER_AES_128_CBC:          return( &aes_128_cbc_info );
+        case MBEDTLS_CIPHER_AES_192_CBC:          return( &aes_192_cbc_info );
+        case MBEDTLS_CIPHER_AES_256_CBC:          return( &aes_256_cbc_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+        case MBEDTLS_CIPHER_AES_128_CFB128:       return( &aes_128_cfb128_info );
+        case MBEDTLS_CIPHER_AES_192_CFB128:       return( &aes_192_cfb128_info );
+        case MBEDTLS_CIPHER_AES_256_CFB128:       return( &aes_256_cfb128_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+        case MBEDTLS_CIPHER_AES_128_CTR:          return( &aes_128_ctr_info );
+        case MBEDTLS_CIPHER_AES_192_CTR:          return( &aes_192_ctr_info );
+        case MBEDTLS_CIPHER_AES_256_CTR:          return( &aes_256_ctr_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+        case MBEDTLS_CIPHER_AES_128_XTS:          return( &aes_128_xts_info );
+        case MBEDTLS_CIPHER_AES_256_XTS:          return( &aes_256_xts_info );
+#endif
+#if defined(MBEDTLS_GCM_C)
+        case MBEDTLS_CIPHER_AES_128_GCM:          return( &aes_128_gcm_info );
+        case MBEDTLS_CIPHER_AES_192_GCM:          return( &aes_192_gcm_info );
+        case MBEDTLS_CIPHER_AES_256_GCM:          return( &aes_256_gcm_info );
+#endif
+#if defined(MBEDTLS_CCM_C)
+        case MBEDTLS_CIPHER_AES_128_CCM:          return( &aes_128_ccm_info );
+        case MBEDTLS_CIPHER_AES_192_CCM:          return( &aes_192_ccm_info );
+        case MBEDTLS_CIPHER_AES_256_CCM:          return( &aes_256_ccm_info );
+#endif
+#endif /* MBEDTLS_AES_C */
+
+#if defined(MBEDTLS_ARC4_C)
+        case MBEDTLS_CIPHER_ARC4_128:             return( &arc4_128_info );
+#endif
+
+#if defined(MBEDTLS_BLOWFISH_C)
+        case MBEDTLS_CIPHER_BLOWFISH_ECB:         return( &blowfish_ecb_info );
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+        case MBEDTLS_CIPHER_BLOWFISH_CBC:         return( &blowfish_cbc_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+        case MBEDTLS_CIPHER_BLOWFISH_CFB64:       return( &blowfish_cfb64_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+        case MBEDTLS_CIPHER_BLOWFISH_CTR:         return( &blowfish_ctr_info );
+#endif
+#endif /* MBEDTLS_BLOWFISH_C */
+
+#if defined(MBEDTLS_CAMELLIA_C)
+        case MBEDTLS_CIPHER_CAMELLIA_128_ECB:     return( &camellia_128_ecb_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_ECB:     return( &camellia_192_ecb_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_ECB:     return( &camellia_256_ecb_info );
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+        case MBEDTLS_CIPHER_CAMELLIA_128_CBC:     return( &camellia_128_cbc_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_CBC:     return( &camellia_192_cbc_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_CBC:     return( &camellia_256_cbc_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+        case MBEDTLS_CIPHER_CAMELLIA_128_CFB128:  return( &camellia_128_cfb128_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_CFB128:  return( &camellia_192_cfb128_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_CFB128:  return( &camellia_256_cfb128_info );
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+        case MBEDTLS_CIPHER_CAMELLIA_128_CTR:     return( &camellia_128_ctr_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_CTR:     return( &camellia_192_ctr_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_CTR:     return( &camellia_256_ctr_info );
+#endif
+#if defined(MBEDTLS_GCM_C)
+        case MBEDTLS_CIPHER_CAMELLIA_128_GCM:     return( &camellia_128_gcm_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_GCM:     return( &camellia_192_gcm_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_GCM:     return( &camellia_256_gcm_info );
+#endif
+#if defined(MBEDTLS_CCM_C)
+        case MBEDTLS_CIPHER_CAMELLIA_128_CCM:     return( &camellia_128_ccm_info );
+        case MBEDTLS_CIPHER_CAMELLIA_192_CCM:     return( &camellia_192_ccm_info );
+        case MBEDTLS_CIPHER_CAMELLIA_256_CCM:     return( &camellia_256_ccm_info );
+#endif
+#endif /* MBEDTLS_CAMELLIA_C */
+
+#if defined(MBEDTLS_DES_C)
+        case MBEDTLS_CIPHER_DES_ECB:              return( &des_ecb_info );
+        case MBEDTLS_CIPHER_DES_EDE_ECB:          return( &des_ede_ecb_info );
+        case MBEDTLS_CIPHER_DES_EDE3_ECB:         return( &des_ede3_ecb_info );
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+        case MBEDTLS_CIPHER_DES_CBC:              return( &des_cbc_info );
+        case MBEDTLS_CIPHER_DES_EDE_CBC:          return( &des_ede_cbc_info );
+        case MBEDTLS_CIPHER_DES_EDE3_CBC:         return( &des_ede3_cbc_info );
+#endif
+#endif /* MBEDTLS_DES_C */
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+        case MBEDTLS_CIPHER_CHACHA20_POLY1305:    return( &chachapoly_info );
+#endif
+
+#if defined(MBEDTLS_CIPHER_NULL_CIPHER)
+        case MBEDTLS_CIPHER_NULL:                 return( &null_cipher_info );
+#endif
+
+        default:
+            return( NULL );
+    }
+}
+
 #endif /* MBEDTLS_CIPHER_C */
@@ -0,0 +1,144 @@
+/*
+ *  Constant-time buffer utilities
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * These helpers gather the timing-sensitive buffer operations that used to
+ * be open-coded as byte loops throughout the library. Comparisons work a
+ * word at a time where possible; unaligned words are loaded with memcpy,
+ * which compilers turn into a single load on platforms that allow it.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/constant_time.h"
+
+#include <stdint.h>
+#include <string.h>
+
+int mbedtls_ct_memcmp( const void *a, const void *b, size_t n )
+{
+    size_t i = 0;
+    uint32_t wa, wb, diff32 = 0;
+    unsigned char diff = 0;
+    const unsigned char *A = (const unsigned char *) a;
+    const unsigned char *B = (const unsigned char *) b;
+
+    for( ; i + sizeof( uint32_t ) <= n; i += sizeof( uint32_t ) )
+    {
+        memcpy( &wa, A + i, sizeof( uint32_t ) );
+        memcpy( &wb, B + i, sizeof( uint32_t ) );
+        diff32 |= wa ^ wb;
+    }
+
+    for( ; i < n; i++ )
+        diff |= A[i] ^ B[i];
+
+    diff32 |= diff32 >> 16;
+    diff32 |= diff32 >> 8;
+
+    return( (int)( diff | ( diff32 & 0xFF ) ) );
+}
+
+void mbedtls_ct_memcpy_if( unsigned char condition,
+                           unsigned char *dest, const unsigned char *src,
+                           size_t len )
+{
+    size_t i;
+    /* mask = 0xFF if condition == 1, 0x00 if condition == 0 */
+    unsigned char mask = (unsigned char) -condition;
+
+    for( i = 0; i < len; i++ )
+        dest[i] = (unsigned char)( ( src[i] & mask ) | ( dest[i] & ~mask ) );
+}
+
+unsigned char mbedtls_ct_size_eq( size_t a, size_t b )
+{
+    size_t diff = a ^ b;
+    /* diff_msb has its most significant bit set iff diff is non-zero */
+    size_t diff_msb = diff | (size_t) -diff;
+
+    return( (unsigned char)( 1 ^ ( diff_msb >> ( sizeof( size_t ) * 8 - 1 ) ) ) );
+}
+
+unsigned char mbedtls_ct_size_gt( size_t a, size_t b )
+{
+    /* b - a underflows, setting the most significant bit, iff a > b
+     * (valid as long as neither value uses that bit, which sizes of
+     * buffers handled by the library never do) */
+    return( (unsigned char)( ( b - a ) >> ( sizeof( size_t ) * 8 - 1 ) ) );
+}
+
+size_t mbedtls_ct_size_if( unsigned char condition, size_t if1, size_t if0 )
+{
+    /* mask = all-ones if condition == 1, 0 if condition == 0 */
+    size_t mask = (size_t) -condition;
+
+    return( ( if1 & mask ) | ( if0 & ~mask ) );
+}
+
+void mbedtls_ct_mem_move_to_left( void *start, size_t total, size_t offset )
+{
+    volatile unsigned char *buf = start;
+    size_t i, n;
+
+    if( total == 0 )
+        return;
+
+    /* One pass per byte of the buffer: in the first offset passes the
+     * content is shifted left by one byte, in the remaining ones the
+     * same loads and stores put every byte back where it was */
+    for( i = 0; i < total; i++ )
+    {
+        unsigned char no_op = mbedtls_ct_size_gt( total - offset, i );
+
+        for( n = 0; n < total - 1; n++ )
+        {
+            unsigned char current = buf[n];
+            unsigned char next = buf[n + 1];
+
+            buf[n] = (unsigned char)
+                mbedtls_ct_size_if( no_op, current, next );
+        }
+        buf[total - 1] = (unsigned char)
+            mbedtls_ct_size_if( no_op, buf[total - 1], 0 );
+    }
+}
+
+void mbedtls_ct_memcpy_offset( unsigned char *dest, const unsigned char *src,
+                               size_t offset, size_t offset_min,
+                               size_t offset_max, size_t len )
+{
+    size_t o;
+
+    for( o = offset_min; o <= offset_max; o++ )
+        mbedtls_ct_memcpy_if( mbedtls_ct_size_eq( o, offset ),
+                              dest, src + o, len );
+}
+
+/* Implementation that should never be optimized out by the compiler */
+void mbedtls_zeroize( void *v, size_t n )
+{
+    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
+}
@@ -37,6 +37,10 @@
 
 #include <string.h>
 
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+#include <unistd.h>
+#endif
+
 #if defined(MBEDTLS_FS_IO)
 #include <stdio.h>
 #endif
@@ -50,10 +54,7 @@
 #endif /* MBEDTLS_PLATFORM_C */
 #endif /* MBEDTLS_SELF_TEST */
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * CTR_DRBG context initialization
@@ -85,6 +86,8 @@ int mbedtls_ctr_drbg_seed_entropy_len(
     memset( key, 0, MBEDTLS_CTR_DRBG_KEYSIZE );
 
     mbedtls_aes_init( &ctx->aes_ctx );
+    mbedtls_aes_init( &ctx->df_aes_ctx );
+    ctx->df_aes_set = 0;
 
     ctx->f_entropy = f_entropy;
     ctx->p_entropy = p_entropy;
@@ -122,6 +125,7 @@ void mbedtls_ctr_drbg_free( mbedtls_ctr_drbg_context *ctx )
     mbedtls_mutex_free( &ctx->mutex );
 #endif
     mbedtls_aes_free( &ctx->aes_ctx );
+    mbedtls_aes_free( &ctx->df_aes_ctx );
     mbedtls_zeroize( ctx, sizeof( mbedtls_ctr_drbg_context ) );
 }
 
@@ -140,7 +144,8 @@ void mbedtls_ctr_drbg_set_reseed_interval( mbedtls_ctr_drbg_context *ctx, int in
     ctx->reseed_interval = interval;
 }
 
-static int block_cipher_df( unsigned char *output,
+static int block_cipher_df( mbedtls_ctr_drbg_context *ctx,
+                            unsigned char *output,
                             const unsigned char *data, size_t data_len )
 {
     unsigned char buf[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT + MBEDTLS_CTR_DRBG_BLOCKSIZE + 16];
@@ -178,10 +183,18 @@ static int block_cipher_df( unsigned char *output,
 
     buf_len = MBEDTLS_CTR_DRBG_BLOCKSIZE + 8 + data_len + 1;
 
-    for( i = 0; i < MBEDTLS_CTR_DRBG_KEYSIZE; i++ )
-        key[i] = i;
+    /*
+     * The derivation function always reduces with the same constant key,
+     * so its round keys are expanded once and kept in the context
+     */
+    if( ctx->df_aes_set == 0 )
+    {
+        for( i = 0; i < MBEDTLS_CTR_DRBG_KEYSIZE; i++ )
+            key[i] = i;
 
-    mbedtls_aes_setkey_enc( &aes_ctx, key, MBEDTLS_CTR_DRBG_KEYBITS );
+        mbedtls_aes_setkey_enc( &ctx->df_aes_ctx, key, MBEDTLS_CTR_DRBG_KEYBITS );
+        ctx->df_aes_set = 1;
+    }
 
     /*
      * Reduce data to MBEDTLS_CTR_DRBG_SEEDLEN bytes of data
@@ -200,7 +213,8 @@ static int block_cipher_df( unsigned char *output,
             use_len -= ( use_len >= MBEDTLS_CTR_DRBG_BLOCKSIZE ) ?
                        MBEDTLS_CTR_DRBG_BLOCKSIZE : use_len;
 
-            mbedtls_aes_crypt_ecb( &aes_ctx, MBEDTLS_AES_ENCRYPT, chain, chain );
+            mbedtls_aes_crypt_ecb( &ctx->df_aes_ctx, MBEDTLS_AES_ENCRYPT,
+                                   chain, chain );
         }
 
         memcpy( tmp + j, chain, MBEDTLS_CTR_DRBG_BLOCKSIZE );
@@ -280,7 +294,7 @@ void mbedtls_ctr_drbg_update( mbedtls_ctr_drbg_context *ctx,
         if( add_len > MBEDTLS_CTR_DRBG_MAX_SEED_INPUT )
             add_len = MBEDTLS_CTR_DRBG_MAX_SEED_INPUT;
 
-        block_cipher_df( add_input, additional, add_len );
+        block_cipher_df( ctx, add_input, additional, add_len );
         ctr_drbg_update_internal( ctx, add_input );
     }
 }
@@ -291,6 +305,10 @@ int mbedtls_ctr_drbg_reseed( mbedtls_ctr_drbg_context *ctx,
     unsigned char seed[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT];
     size_t seedlen = 0;
 
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+    ctx->pid = getpid();
+#endif
+
     if( ctx->entropy_len + len > MBEDTLS_CTR_DRBG_MAX_SEED_INPUT )
         return( MBEDTLS_ERR_CTR_DRBG_INPUT_TOO_BIG );
 
@@ -319,7 +337,7 @@ int mbedtls_ctr_drbg_reseed( mbedtls_ctr_drbg_context *ctx,
     /*
      * Reduce to 384 bits
      */
-    block_cipher_df( seed, seed, seedlen );
+    block_cipher_df( ctx, seed, seed, seedlen );
 
     /*
      * Update state
@@ -350,6 +368,17 @@ int mbedtls_ctr_drbg_random_with_add( void *p_rng,
 
     memset( add_input, 0, MBEDTLS_CTR_DRBG_SEEDLEN );
 
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+    if( ctx->pid != getpid() )
+    {
+        /* Forked: the child inherited our state, reseed before output */
+        if( ( ret = mbedtls_ctr_drbg_reseed( ctx, additional, add_len ) ) != 0 )
+            return( ret );
+
+        add_len = 0;
+    }
+#endif
+
     if( ctx->reseed_counter > ctx->reseed_interval ||
         ctx->prediction_resistance )
     {
@@ -361,7 +390,7 @@ int mbedtls_ctr_drbg_random_with_add( void *p_rng,
 
     if( add_len > 0 )
     {
-        block_cipher_df( add_input, additional, add_len );
+        block_cipher_df( ctx, add_input, additional, add_len );
         ctr_drbg_update_internal( ctx, add_input );
     }
 
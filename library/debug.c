@@ -52,6 +52,40 @@ void mbedtls_debug_set_threshold( int threshold )
     debug_threshold = threshold;
 }
 
+/*
+ * Raw sink: when installed, payloads are handed over as single binary
+ * records and the textual rendering below (hex dumps, MPI digits) is
+ * skipped entirely.
+ */
+static void (*debug_raw_sink)( void *,
+                               const mbedtls_debug_raw_record * ) = NULL;
+static void *debug_raw_ctx = NULL;
+
+void mbedtls_debug_set_raw_sink( void (*f_raw)( void *,
+                                     const mbedtls_debug_raw_record * ),
+                                 void *p_raw )
+{
+    debug_raw_sink = f_raw;
+    debug_raw_ctx = p_raw;
+}
+
+static void debug_send_raw( int level, const char *file, int line, int type,
+                            const char *text, const unsigned char *data,
+                            size_t len )
+{
+    mbedtls_debug_raw_record rec;
+
+    rec.level = level;
+    rec.file  = file;
+    rec.line  = line;
+    rec.type  = type;
+    rec.text  = text;
+    rec.data  = data;
+    rec.len   = len;
+
+    debug_raw_sink( debug_raw_ctx, &rec );
+}
+
 void mbedtls_debug_print_msg( const mbedtls_ssl_context *ssl, int level,
                               const char *file, int line,
                               const char *format, ... )
@@ -60,7 +94,8 @@ void mbedtls_debug_print_msg( const mbedtls_ssl_context *ssl, int level,
     char str[DEBUG_BUF_SIZE];
     int ret;
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
         return;
 
     va_start( argp, format );
@@ -80,6 +115,13 @@ void mbedtls_debug_print_msg( const mbedtls_ssl_context *ssl, int level,
 #endif
     va_end( argp );
 
+    if( debug_raw_sink != NULL )
+    {
+        debug_send_raw( level, file, line, MBEDTLS_DEBUG_TYPE_MSG, str,
+                        NULL, 0 );
+        return;
+    }
+
     if( ret >= 0 && ret < DEBUG_BUF_SIZE - 1 )
     {
         str[ret]     = '\n';
@@ -95,7 +137,8 @@ void mbedtls_debug_print_ret( const mbedtls_ssl_context *ssl, int level,
 {
     char str[DEBUG_BUF_SIZE];
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
         return;
 
     /*
@@ -106,6 +149,13 @@ void mbedtls_debug_print_ret( const mbedtls_ssl_context *ssl, int level,
     if( ret == MBEDTLS_ERR_SSL_WANT_READ )
         return;
 
+    if( debug_raw_sink != NULL )
+    {
+        debug_send_raw( level, file, line, MBEDTLS_DEBUG_TYPE_RET, text,
+                        (const unsigned char *) &ret, sizeof( ret ) );
+        return;
+    }
+
     mbedtls_snprintf( str, sizeof( str ), "%s() returned %d (-0x%04x)\n",
               text, ret, -ret );
 
@@ -120,8 +170,16 @@ void mbedtls_debug_print_buf( const mbedtls_ssl_context *ssl, int level,
     char txt[17];
     size_t i, idx = 0;
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
+        return;
+
+    if( debug_raw_sink != NULL )
+    {
+        debug_send_raw( level, file, line, MBEDTLS_DEBUG_TYPE_BUF, text,
+                        buf, len );
         return;
+    }
 
     mbedtls_snprintf( str + idx, sizeof( str ) - idx, "dumping '%s' (%u bytes)\n",
               text, (unsigned int) len );
@@ -173,7 +231,8 @@ void mbedtls_debug_print_ecp( const mbedtls_ssl_context *ssl, int level,
 {
     char str[DEBUG_BUF_SIZE];
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
         return;
 
     mbedtls_snprintf( str, sizeof( str ), "%s(X)", text );
@@ -193,8 +252,17 @@ void mbedtls_debug_print_mpi( const mbedtls_ssl_context *ssl, int level,
     int j, k, zeros = 1;
     size_t i, n, idx = 0;
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || X == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || X == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
+        return;
+
+    if( debug_raw_sink != NULL )
+    {
+        debug_send_raw( level, file, line, MBEDTLS_DEBUG_TYPE_MPI, text,
+                        (const unsigned char *) X->p,
+                        X->n * sizeof( mbedtls_mpi_uint ) );
         return;
+    }
 
     for( n = X->n - 1; n > 0; n-- )
         if( X->p[n] != 0 )
@@ -319,8 +387,21 @@ void mbedtls_debug_print_crt( const mbedtls_ssl_context *ssl, int level,
     char str[DEBUG_BUF_SIZE];
     int i = 0;
 
-    if( ssl->conf == NULL || ssl->conf->f_dbg == NULL || crt == NULL || level > debug_threshold )
+    if( ssl->conf == NULL || crt == NULL || level > debug_threshold ||
+        ( ssl->conf->f_dbg == NULL && debug_raw_sink == NULL ) )
+        return;
+
+    if( debug_raw_sink != NULL )
+    {
+        /* one record per certificate in the chain, carrying the DER */
+        while( crt != NULL )
+        {
+            debug_send_raw( level, file, line, MBEDTLS_DEBUG_TYPE_CRT, text,
+                            crt->raw.p, crt->raw.len );
+            crt = crt->next;
+        }
         return;
+    }
 
     while( crt != NULL )
     {
@@ -55,10 +55,7 @@
 #define mbedtls_free       free
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * helper to validate the mbedtls_mpi size and import it
@@ -121,6 +118,521 @@ void mbedtls_dhm_init( mbedtls_dhm_context *ctx )
     memset( ctx, 0, sizeof( mbedtls_dhm_context ) );
 }
 
+/*
+ * Well-known groups in preparsed form. Alongside P and G each group
+ * carries RR = R^2 mod P, the constant mbedtls_mpi_exp_mod() would
+ * otherwise have to compute on first use of a fresh context: every
+ * modulus size here is a multiple of 64 bits, so the value is the
+ * same for 32- and 64-bit limbs.
+ */
+static const unsigned char dhm_rfc3526_2048_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xC9, 0x0F, 0xDA, 0xA2, 0x21, 0x68, 0xC2, 0x34,
+    0xC4, 0xC6, 0x62, 0x8B, 0x80, 0xDC, 0x1C, 0xD1,
+    0x29, 0x02, 0x4E, 0x08, 0x8A, 0x67, 0xCC, 0x74,
+    0x02, 0x0B, 0xBE, 0xA6, 0x3B, 0x13, 0x9B, 0x22,
+    0x51, 0x4A, 0x08, 0x79, 0x8E, 0x34, 0x04, 0xDD,
+    0xEF, 0x95, 0x19, 0xB3, 0xCD, 0x3A, 0x43, 0x1B,
+    0x30, 0x2B, 0x0A, 0x6D, 0xF2, 0x5F, 0x14, 0x37,
+    0x4F, 0xE1, 0x35, 0x6D, 0x6D, 0x51, 0xC2, 0x45,
+    0xE4, 0x85, 0xB5, 0x76, 0x62, 0x5E, 0x7E, 0xC6,
+    0xF4, 0x4C, 0x42, 0xE9, 0xA6, 0x37, 0xED, 0x6B,
+    0x0B, 0xFF, 0x5C, 0xB6, 0xF4, 0x06, 0xB7, 0xED,
+    0xEE, 0x38, 0x6B, 0xFB, 0x5A, 0x89, 0x9F, 0xA5,
+    0xAE, 0x9F, 0x24, 0x11, 0x7C, 0x4B, 0x1F, 0xE6,
+    0x49, 0x28, 0x66, 0x51, 0xEC, 0xE4, 0x5B, 0x3D,
+    0xC2, 0x00, 0x7C, 0xB8, 0xA1, 0x63, 0xBF, 0x05,
+    0x98, 0xDA, 0x48, 0x36, 0x1C, 0x55, 0xD3, 0x9A,
+    0x69, 0x16, 0x3F, 0xA8, 0xFD, 0x24, 0xCF, 0x5F,
+    0x83, 0x65, 0x5D, 0x23, 0xDC, 0xA3, 0xAD, 0x96,
+    0x1C, 0x62, 0xF3, 0x56, 0x20, 0x85, 0x52, 0xBB,
+    0x9E, 0xD5, 0x29, 0x07, 0x70, 0x96, 0x96, 0x6D,
+    0x67, 0x0C, 0x35, 0x4E, 0x4A, 0xBC, 0x98, 0x04,
+    0xF1, 0x74, 0x6C, 0x08, 0xCA, 0x18, 0x21, 0x7C,
+    0x32, 0x90, 0x5E, 0x46, 0x2E, 0x36, 0xCE, 0x3B,
+    0xE3, 0x9E, 0x77, 0x2C, 0x18, 0x0E, 0x86, 0x03,
+    0x9B, 0x27, 0x83, 0xA2, 0xEC, 0x07, 0xA2, 0x8F,
+    0xB5, 0xC5, 0x5D, 0xF0, 0x6F, 0x4C, 0x52, 0xC9,
+    0xDE, 0x2B, 0xCB, 0xF6, 0x95, 0x58, 0x17, 0x18,
+    0x39, 0x95, 0x49, 0x7C, 0xEA, 0x95, 0x6A, 0xE5,
+    0x15, 0xD2, 0x26, 0x18, 0x98, 0xFA, 0x05, 0x10,
+    0x15, 0x72, 0x8E, 0x5A, 0x8A, 0xAC, 0xAA, 0x68,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static const unsigned char dhm_rfc3526_2048_g[] = {
+    0x02,
+};
+
+static const unsigned char dhm_rfc3526_2048_rr[] = {
+    0x0C, 0xD3, 0x7A, 0x33, 0x62, 0x8B, 0x31, 0x97,
+    0x3E, 0xD8, 0x57, 0x03, 0x66, 0x61, 0x30, 0x00,
+    0x8A, 0x3A, 0x68, 0x6C, 0x92, 0x40, 0xC9, 0x74,
+    0x27, 0x23, 0x82, 0x97, 0x0A, 0x16, 0x98, 0xAB,
+    0x63, 0xBD, 0xD9, 0x6D, 0x19, 0xEA, 0x00, 0xBE,
+    0x2A, 0x49, 0x20, 0x90, 0xFA, 0x11, 0xE1, 0x05,
+    0xEB, 0x5B, 0x27, 0x6F, 0xBE, 0x06, 0xA1, 0xDF,
+    0xD8, 0x5D, 0x6E, 0x7E, 0xED, 0x68, 0x80, 0xDD,
+    0xF8, 0x3C, 0x92, 0xCB, 0x14, 0xE9, 0x92, 0xC5,
+    0x8C, 0x10, 0x6B, 0xBE, 0x38, 0x56, 0x9F, 0x92,
+    0xF2, 0x73, 0xB2, 0x93, 0x7E, 0x30, 0x08, 0x67,
+    0x5D, 0x99, 0x8F, 0xB3, 0x94, 0x91, 0x0C, 0x76,
+    0x94, 0x78, 0x95, 0x1B, 0x70, 0xC4, 0xB2, 0xCE,
+    0xDB, 0xD4, 0x42, 0xB3, 0x86, 0x6D, 0x29, 0x86,
+    0xBC, 0x82, 0x1C, 0x9D, 0xE8, 0xD7, 0x2B, 0xD5,
+    0xA2, 0xF8, 0x82, 0x57, 0x32, 0x5B, 0x54, 0xD0,
+    0xAC, 0x2B, 0x79, 0x25, 0x73, 0x9C, 0x79, 0x78,
+    0x55, 0x22, 0x72, 0xD2, 0x75, 0xF1, 0x0A, 0x7E,
+    0x5C, 0xA5, 0x2F, 0xF7, 0xD7, 0x45, 0x0B, 0xD9,
+    0x57, 0x0E, 0x43, 0x6F, 0x4E, 0x2E, 0x6F, 0x7F,
+    0xF2, 0x28, 0x10, 0x5F, 0x81, 0xF1, 0xCB, 0x61,
+    0x07, 0x4E, 0xD6, 0xAB, 0x78, 0x5A, 0x30, 0x71,
+    0x56, 0x20, 0x82, 0x0E, 0x25, 0x86, 0x33, 0xFF,
+    0x4B, 0xC1, 0xB1, 0x87, 0x8A, 0x0E, 0x30, 0xD9,
+    0xF8, 0x11, 0x54, 0x26, 0xED, 0x93, 0x9E, 0xEB,
+    0x27, 0xBA, 0x72, 0x5A, 0x6B, 0x02, 0x0C, 0xB1,
+    0x4B, 0xEC, 0x06, 0xE1, 0x36, 0xBD, 0x84, 0xE7,
+    0xBB, 0xC7, 0x16, 0x29, 0xFC, 0xB7, 0xF5, 0xF9,
+    0x2A, 0x09, 0x2B, 0x50, 0x87, 0x3F, 0x9B, 0xC6,
+    0x4C, 0x21, 0x53, 0xFF, 0x6F, 0xD4, 0x12, 0xC1,
+    0xB0, 0x35, 0x48, 0xFB, 0x9B, 0x38, 0xD3, 0x13,
+    0x47, 0x71, 0x22, 0xCE, 0x12, 0x5F, 0xB6, 0x64,
+};
+
+static const unsigned char dhm_rfc3526_3072_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xC9, 0x0F, 0xDA, 0xA2, 0x21, 0x68, 0xC2, 0x34,
+    0xC4, 0xC6, 0x62, 0x8B, 0x80, 0xDC, 0x1C, 0xD1,
+    0x29, 0x02, 0x4E, 0x08, 0x8A, 0x67, 0xCC, 0x74,
+    0x02, 0x0B, 0xBE, 0xA6, 0x3B, 0x13, 0x9B, 0x22,
+    0x51, 0x4A, 0x08, 0x79, 0x8E, 0x34, 0x04, 0xDD,
+    0xEF, 0x95, 0x19, 0xB3, 0xCD, 0x3A, 0x43, 0x1B,
+    0x30, 0x2B, 0x0A, 0x6D, 0xF2, 0x5F, 0x14, 0x37,
+    0x4F, 0xE1, 0x35, 0x6D, 0x6D, 0x51, 0xC2, 0x45,
+    0xE4, 0x85, 0xB5, 0x76, 0x62, 0x5E, 0x7E, 0xC6,
+    0xF4, 0x4C, 0x42, 0xE9, 0xA6, 0x37, 0xED, 0x6B,
+    0x0B, 0xFF, 0x5C, 0xB6, 0xF4, 0x06, 0xB7, 0xED,
+    0xEE, 0x38, 0x6B, 0xFB, 0x5A, 0x89, 0x9F, 0xA5,
+    0xAE, 0x9F, 0x24, 0x11, 0x7C, 0x4B, 0x1F, 0xE6,
+    0x49, 0x28, 0x66, 0x51, 0xEC, 0xE4, 0x5B, 0x3D,
+    0xC2, 0x00, 0x7C, 0xB8, 0xA1, 0x63, 0xBF, 0x05,
+    0x98, 0xDA, 0x48, 0x36, 0x1C, 0x55, 0xD3, 0x9A,
+    0x69, 0x16, 0x3F, 0xA8, 0xFD, 0x24, 0xCF, 0x5F,
+    0x83, 0x65, 0x5D, 0x23, 0xDC, 0xA3, 0xAD, 0x96,
+    0x1C, 0x62, 0xF3, 0x56, 0x20, 0x85, 0x52, 0xBB,
+    0x9E, 0xD5, 0x29, 0x07, 0x70, 0x96, 0x96, 0x6D,
+    0x67, 0x0C, 0x35, 0x4E, 0x4A, 0xBC, 0x98, 0x04,
+    0xF1, 0x74, 0x6C, 0x08, 0xCA, 0x18, 0x21, 0x7C,
+    0x32, 0x90, 0x5E, 0x46, 0x2E, 0x36, 0xCE, 0x3B,
+    0xE3, 0x9E, 0x77, 0x2C, 0x18, 0x0E, 0x86, 0x03,
+    0x9B, 0x27, 0x83, 0xA2, 0xEC, 0x07, 0xA2, 0x8F,
+    0xB5, 0xC5, 0x5D, 0xF0, 0x6F, 0x4C, 0x52, 0xC9,
+    0xDE, 0x2B, 0xCB, 0xF6, 0x95, 0x58, 0x17, 0x18,
+    0x39, 0x95, 0x49, 0x7C, 0xEA, 0x95, 0x6A, 0xE5,
+    0x15, 0xD2, 0x26, 0x18, 0x98, 0xFA, 0x05, 0x10,
+    0x15, 0x72, 0x8E, 0x5A, 0x8A, 0xAA, 0xC4, 0x2D,
+    0xAD, 0x33, 0x17, 0x0D, 0x04, 0x50, 0x7A, 0x33,
+    0xA8, 0x55, 0x21, 0xAB, 0xDF, 0x1C, 0xBA, 0x64,
+    0xEC, 0xFB, 0x85, 0x04, 0x58, 0xDB, 0xEF, 0x0A,
+    0x8A, 0xEA, 0x71, 0x57, 0x5D, 0x06, 0x0C, 0x7D,
+    0xB3, 0x97, 0x0F, 0x85, 0xA6, 0xE1, 0xE4, 0xC7,
+    0xAB, 0xF5, 0xAE, 0x8C, 0xDB, 0x09, 0x33, 0xD7,
+    0x1E, 0x8C, 0x94, 0xE0, 0x4A, 0x25, 0x61, 0x9D,
+    0xCE, 0xE3, 0xD2, 0x26, 0x1A, 0xD2, 0xEE, 0x6B,
+    0xF1, 0x2F, 0xFA, 0x06, 0xD9, 0x8A, 0x08, 0x64,
+    0xD8, 0x76, 0x02, 0x73, 0x3E, 0xC8, 0x6A, 0x64,
+    0x52, 0x1F, 0x2B, 0x18, 0x17, 0x7B, 0x20, 0x0C,
+    0xBB, 0xE1, 0x17, 0x57, 0x7A, 0x61, 0x5D, 0x6C,
+    0x77, 0x09, 0x88, 0xC0, 0xBA, 0xD9, 0x46, 0xE2,
+    0x08, 0xE2, 0x4F, 0xA0, 0x74, 0xE5, 0xAB, 0x31,
+    0x43, 0xDB, 0x5B, 0xFC, 0xE0, 0xFD, 0x10, 0x8E,
+    0x4B, 0x82, 0xD1, 0x20, 0xA9, 0x3A, 0xD2, 0xCA,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static const unsigned char dhm_rfc3526_3072_g[] = {
+    0x02,
+};
+
+static const unsigned char dhm_rfc3526_3072_rr[] = {
+    0x5A, 0xC8, 0xB4, 0xFB, 0x51, 0xDF, 0x35, 0xDA,
+    0x44, 0xC4, 0xE4, 0xE4, 0x31, 0xAD, 0x02, 0x95,
+    0xA3, 0x32, 0xE8, 0xE3, 0xE0, 0x66, 0x9E, 0x0F,
+    0x84, 0x89, 0x5A, 0x7C, 0x55, 0x42, 0xF9, 0x6C,
+    0x2A, 0xD4, 0x79, 0xFE, 0x69, 0x69, 0x5C, 0x75,
+    0xFA, 0xE1, 0xCD, 0x10, 0x64, 0x8B, 0xEE, 0x54,
+    0xFA, 0x02, 0x23, 0x36, 0xF2, 0x8D, 0xE7, 0x72,
+    0x5C, 0xAA, 0x69, 0x00, 0x9F, 0xBF, 0x54, 0x3F,
+    0x98, 0x75, 0xD4, 0xC1, 0x67, 0xDB, 0x7E, 0xDC,
+    0xAA, 0x05, 0xDA, 0x05, 0xC2, 0x7F, 0xDD, 0x33,
+    0xAF, 0x0E, 0xC4, 0x5C, 0xDC, 0x39, 0x60, 0x86,
+    0x22, 0x76, 0xCB, 0x40, 0x57, 0x1F, 0x2C, 0x1C,
+    0x49, 0xCD, 0x9D, 0x70, 0x5D, 0xA1, 0x84, 0xD5,
+    0x71, 0x39, 0xD0, 0xAB, 0x24, 0xB7, 0xE4, 0x95,
+    0xA5, 0xDA, 0xF7, 0x36, 0xBC, 0x8D, 0x5E, 0x9E,
+    0x10, 0x9D, 0x09, 0x9E, 0x16, 0xFD, 0x75, 0x68,
+    0x77, 0xA5, 0xC7, 0x47, 0xD8, 0x5B, 0x0A, 0x83,
+    0x8C, 0x6C, 0xBD, 0x34, 0xD5, 0x96, 0x51, 0x34,
+    0xA7, 0x3D, 0x01, 0x03, 0x2C, 0x4B, 0x8E, 0x90,
+    0x7D, 0xED, 0x48, 0x9E, 0x67, 0x0D, 0x9C, 0x6F,
+    0x19, 0xC2, 0x88, 0x3E, 0xEF, 0xC8, 0x02, 0xAF,
+    0x06, 0x72, 0xA3, 0x3D, 0x61, 0xE3, 0x7F, 0x74,
+    0x7C, 0xDA, 0x50, 0x2E, 0xC0, 0x43, 0xF9, 0x9C,
+    0x9A, 0x67, 0x8B, 0xF4, 0x43, 0x9F, 0x12, 0xEB,
+    0x5A, 0x77, 0x95, 0xD8, 0x6E, 0xCC, 0x49, 0x87,
+    0x19, 0xCC, 0x8D, 0x59, 0x56, 0x37, 0x06, 0xFB,
+    0xB4, 0x1A, 0x05, 0xF0, 0x78, 0x02, 0x42, 0x08,
+    0xBF, 0xD9, 0x61, 0xD5, 0x38, 0xD6, 0xFC, 0xDD,
+    0x4F, 0x12, 0x76, 0x82, 0x56, 0xE8, 0x8B, 0x53,
+    0x78, 0x54, 0x83, 0xC6, 0x08, 0x10, 0x8C, 0x0C,
+    0x3E, 0xFE, 0xF2, 0x9D, 0xC3, 0xC0, 0xB3, 0xF4,
+    0x1B, 0x9D, 0x01, 0x27, 0x1D, 0x18, 0xF0, 0xC8,
+    0x1C, 0xAE, 0xFC, 0x18, 0x8A, 0x59, 0xBC, 0x7F,
+    0xB1, 0x86, 0x42, 0x4B, 0x83, 0xDF, 0x28, 0x59,
+    0xAF, 0x80, 0xD4, 0xB5, 0x44, 0x35, 0x61, 0xC6,
+    0xFE, 0xA5, 0x18, 0x7F, 0xA7, 0x7D, 0xED, 0xDA,
+    0x1D, 0x93, 0x07, 0x5A, 0xA9, 0x93, 0xD1, 0x47,
+    0x1E, 0xF2, 0x25, 0x71, 0xE4, 0x1A, 0x52, 0xB2,
+    0x8A, 0xA6, 0x13, 0x91, 0xAB, 0xB0, 0xB7, 0x6A,
+    0xBC, 0x2B, 0x64, 0xCF, 0x26, 0xE3, 0x35, 0xD7,
+    0x68, 0x2A, 0xAB, 0x9A, 0x15, 0xB1, 0x7F, 0xFA,
+    0xFC, 0x11, 0x87, 0xA5, 0xFA, 0x84, 0x06, 0xAB,
+    0xAE, 0x12, 0x84, 0x02, 0x3C, 0x6E, 0xD6, 0xA3,
+    0x43, 0x35, 0xAA, 0xCB, 0x64, 0x89, 0x4D, 0x96,
+    0x95, 0x82, 0x32, 0x15, 0xB1, 0x5B, 0xA5, 0x77,
+    0x4F, 0x30, 0xB9, 0x20, 0xE5, 0xC1, 0xDB, 0x66,
+    0x35, 0x87, 0xF0, 0x69, 0x60, 0xE7, 0xF1, 0x38,
+    0x26, 0x97, 0xCA, 0x91, 0x38, 0xD2, 0x41, 0xCD,
+};
+
+static const unsigned char dhm_rfc3526_4096_p[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xC9, 0x0F, 0xDA, 0xA2, 0x21, 0x68, 0xC2, 0x34,
+    0xC4, 0xC6, 0x62, 0x8B, 0x80, 0xDC, 0x1C, 0xD1,
+    0x29, 0x02, 0x4E, 0x08, 0x8A, 0x67, 0xCC, 0x74,
+    0x02, 0x0B, 0xBE, 0xA6, 0x3B, 0x13, 0x9B, 0x22,
+    0x51, 0x4A, 0x08, 0x79, 0x8E, 0x34, 0x04, 0xDD,
+    0xEF, 0x95, 0x19, 0xB3, 0xCD, 0x3A, 0x43, 0x1B,
+    0x30, 0x2B, 0x0A, 0x6D, 0xF2, 0x5F, 0x14, 0x37,
+    0x4F, 0xE1, 0x35, 0x6D, 0x6D, 0x51, 0xC2, 0x45,
+    0xE4, 0x85, 0xB5, 0x76, 0x62, 0x5E, 0x7E, 0xC6,
+    0xF4, 0x4C, 0x42, 0xE9, 0xA6, 0x37, 0xED, 0x6B,
+    0x0B, 0xFF, 0x5C, 0xB6, 0xF4, 0x06, 0xB7, 0xED,
+    0xEE, 0x38, 0x6B, 0xFB, 0x5A, 0x89, 0x9F, 0xA5,
+    0xAE, 0x9F, 0x24, 0x11, 0x7C, 0x4B, 0x1F, 0xE6,
+    0x49, 0x28, 0x66, 0x51, 0xEC, 0xE4, 0x5B, 0x3D,
+    0xC2, 0x00, 0x7C, 0xB8, 0xA1, 0x63, 0xBF, 0x05,
+    0x98, 0xDA, 0x48, 0x36, 0x1C, 0x55, 0xD3, 0x9A,
+    0x69, 0x16, 0x3F, 0xA8, 0xFD, 0x24, 0xCF, 0x5F,
+    0x83, 0x65, 0x5D, 0x23, 0xDC, 0xA3, 0xAD, 0x96,
+    0x1C, 0x62, 0xF3, 0x56, 0x20, 0x85, 0x52, 0xBB,
+    0x9E, 0xD5, 0x29, 0x07, 0x70, 0x96, 0x96, 0x6D,
+    0x67, 0x0C, 0x35, 0x4E, 0x4A, 0xBC, 0x98, 0x04,
+    0xF1, 0x74, 0x6C, 0x08, 0xCA, 0x18, 0x21, 0x7C,
+    0x32, 0x90, 0x5E, 0x46, 0x2E, 0x36, 0xCE, 0x3B,
+    0xE3, 0x9E, 0x77, 0x2C, 0x18, 0x0E, 0x86, 0x03,
+    0x9B, 0x27, 0x83, 0xA2, 0xEC, 0x07, 0xA2, 0x8F,
+    0xB5, 0xC5, 0x5D, 0xF0, 0x6F, 0x4C, 0x52, 0xC9,
+    0xDE, 0x2B, 0xCB, 0xF6, 0x95, 0x58, 0x17, 0x18,
+    0x39, 0x95, 0x49, 0x7C, 0xEA, 0x95, 0x6A, 0xE5,
+    0x15, 0xD2, 0x26, 0x18, 0x98, 0xFA, 0x05, 0x10,
+    0x15, 0x72, 0x8E, 0x5A, 0x8A, 0xAA, 0xC4, 0x2D,
+    0xAD, 0x33, 0x17, 0x0D, 0x04, 0x50, 0x7A, 0x33,
+    0xA8, 0x55, 0x21, 0xAB, 0xDF, 0x1C, 0xBA, 0x64,
+    0xEC, 0xFB, 0x85, 0x04, 0x58, 0xDB, 0xEF, 0x0A,
+    0x8A, 0xEA, 0x71, 0x57, 0x5D, 0x06, 0x0C, 0x7D,
+    0xB3, 0x97, 0x0F, 0x85, 0xA6, 0xE1, 0xE4, 0xC7,
+    0xAB, 0xF5, 0xAE, 0x8C, 0xDB, 0x09, 0x33, 0xD7,
+    0x1E, 0x8C, 0x94, 0xE0, 0x4A, 0x25, 0x61, 0x9D,
+    0xCE, 0xE3, 0xD2, 0x26, 0x1A, 0xD2, 0xEE, 0x6B,
+    0xF1, 0x2F, 0xFA, 0x06, 0xD9, 0x8A, 0x08, 0x64,
+    0xD8, 0x76, 0x02, 0x73, 0x3E, 0xC8, 0x6A, 0x64,
+    0x52, 0x1F, 0x2B, 0x18, 0x17, 0x7B, 0x20, 0x0C,
+    0xBB, 0xE1, 0x17, 0x57, 0x7A, 0x61, 0x5D, 0x6C,
+    0x77, 0x09, 0x88, 0xC0, 0xBA, 0xD9, 0x46, 0xE2,
+    0x08, 0xE2, 0x4F, 0xA0, 0x74, 0xE5, 0xAB, 0x31,
+    0x43, 0xDB, 0x5B, 0xFC, 0xE0, 0xFD, 0x10, 0x8E,
+    0x4B, 0x82, 0xD1, 0x20, 0xA9, 0x21, 0x08, 0x01,
+    0x1A, 0x72, 0x3C, 0x12, 0xA7, 0x87, 0xE6, 0xD7,
+    0x88, 0x71, 0x9A, 0x10, 0xBD, 0xBA, 0x5B, 0x26,
+    0x99, 0xC3, 0x27, 0x18, 0x6A, 0xF4, 0xE2, 0x3C,
+    0x1A, 0x94, 0x68, 0x34, 0xB6, 0x15, 0x0B, 0xDA,
+    0x25, 0x83, 0xE9, 0xCA, 0x2A, 0xD4, 0x4C, 0xE8,
+    0xDB, 0xBB, 0xC2, 0xDB, 0x04, 0xDE, 0x8E, 0xF9,
+    0x2E, 0x8E, 0xFC, 0x14, 0x1F, 0xBE, 0xCA, 0xA6,
+    0x28, 0x7C, 0x59, 0x47, 0x4E, 0x6B, 0xC0, 0x5D,
+    0x99, 0xB2, 0x96, 0x4F, 0xA0, 0x90, 0xC3, 0xA2,
+    0x23, 0x3B, 0xA1, 0x86, 0x51, 0x5B, 0xE7, 0xED,
+    0x1F, 0x61, 0x29, 0x70, 0xCE, 0xE2, 0xD7, 0xAF,
+    0xB8, 0x1B, 0xDD, 0x76, 0x21, 0x70, 0x48, 0x1C,
+    0xD0, 0x06, 0x91, 0x27, 0xD5, 0xB0, 0x5A, 0xA9,
+    0x93, 0xB4, 0xEA, 0x98, 0x8D, 0x8F, 0xDD, 0xC1,
+    0x86, 0xFF, 0xB7, 0xDC, 0x90, 0xA6, 0xC0, 0x8F,
+    0x4D, 0xF4, 0x35, 0xC9, 0x34, 0x06, 0x31, 0x99,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static const unsigned char dhm_rfc3526_4096_g[] = {
+    0x02,
+};
+
+static const unsigned char dhm_rfc3526_4096_rr[] = {
+    0x3D, 0xA9, 0x76, 0x59, 0xE2, 0x80, 0xDB, 0x0B,
+    0xE6, 0x5B, 0xCC, 0x3A, 0xB7, 0x8F, 0xDA, 0xA9,
+    0xB7, 0xB7, 0x68, 0xC8, 0x99, 0x31, 0xD7, 0x8D,
+    0xF8, 0xB1, 0x17, 0x25, 0x33, 0x9E, 0xBC, 0x93,
+    0xAA, 0x7F, 0xBD, 0x95, 0x62, 0x05, 0x9F, 0x1F,
+    0x4C, 0x2D, 0xE6, 0x7D, 0xAD, 0x47, 0x52, 0x7E,
+    0x52, 0x6A, 0x65, 0x3A, 0x7A, 0x67, 0x4B, 0xD5,
+    0x54, 0x01, 0xEA, 0x4F, 0x3E, 0xD7, 0x3A, 0x2F,
+    0x70, 0xB5, 0x6F, 0x52, 0x7F, 0x6F, 0x60, 0x4F,
+    0xF3, 0xE5, 0x6C, 0xC2, 0xBD, 0x9F, 0x04, 0x8C,
+    0xFE, 0xA8, 0x0D, 0x9A, 0x6E, 0xC9, 0xFC, 0xD3,
+    0x3A, 0xD3, 0x6F, 0xD8, 0x22, 0xC3, 0x9F, 0x34,
+    0x91, 0xF3, 0x0C, 0x52, 0xF7, 0x98, 0xDA, 0x6A,
+    0x18, 0xC3, 0xDC, 0xE2, 0x01, 0x88, 0xD8, 0x4C,
+    0xCB, 0x22, 0x51, 0x76, 0x25, 0x9E, 0x08, 0x0F,
+    0xA8, 0x9D, 0x1D, 0xCD, 0x9D, 0x38, 0x1C, 0xC5,
+    0xBE, 0xAC, 0xD4, 0x6F, 0x3C, 0xDD, 0x11, 0x96,
+    0x91, 0xA4, 0xF5, 0x57, 0x29, 0x29, 0xB9, 0x0C,
+    0x67, 0xDE, 0x8F, 0xA0, 0x23, 0x86, 0x47, 0x14,
+    0xC2, 0x8A, 0x61, 0xD4, 0x74, 0x11, 0x40, 0x2D,
+    0x6C, 0x09, 0x06, 0x0D, 0x41, 0x05, 0x86, 0x39,
+    0xE4, 0xFC, 0xCF, 0x1D, 0x63, 0x8F, 0x45, 0x66,
+    0x9E, 0x10, 0xFD, 0xE2, 0x8E, 0x54, 0x80, 0x6B,
+    0xF1, 0xD2, 0x7D, 0x0B, 0x5C, 0x7D, 0xC9, 0xC2,
+    0xB6, 0x16, 0xD6, 0xFA, 0x8B, 0xE2, 0xC9, 0x1D,
+    0xE8, 0x10, 0x54, 0x64, 0xE9, 0xF8, 0x0A, 0x5F,
+    0x34, 0x72, 0x08, 0x69, 0x90, 0xDA, 0xCF, 0x1A,
+    0x7E, 0x2C, 0x75, 0xA5, 0x8E, 0x25, 0xF1, 0x42,
+    0x8F, 0xB4, 0x83, 0x2E, 0xF8, 0x27, 0xDE, 0x84,
+    0xCA, 0x06, 0xDA, 0x91, 0xC2, 0xB3, 0xE7, 0xE2,
+    0x4F, 0x02, 0x41, 0x93, 0x78, 0x7A, 0x82, 0x78,
+    0x8B, 0xD7, 0x05, 0x62, 0xDA, 0x60, 0xE3, 0x92,
+    0x46, 0xBD, 0xB7, 0x33, 0x6E, 0x84, 0x52, 0xD9,
+    0x1D, 0x7D, 0x37, 0xA2, 0x3F, 0xB8, 0xCF, 0x61,
+    0xB1, 0x8A, 0x9E, 0xF1, 0x50, 0xC8, 0x95, 0x3A,
+    0xC9, 0x39, 0x19, 0xD1, 0x2A, 0x4B, 0x1A, 0x67,
+    0xFD, 0xC6, 0x5A, 0x26, 0x9B, 0x51, 0xC1, 0xEF,
+    0x09, 0x95, 0x48, 0x43, 0x20, 0xE7, 0x39, 0xF4,
+    0x6C, 0x79, 0x51, 0xA5, 0x23, 0xCE, 0xF7, 0x85,
+    0xE6, 0x0C, 0x6E, 0xFD, 0xFF, 0xB7, 0xA9, 0xA9,
+    0x5F, 0x66, 0x61, 0x46, 0xCB, 0x44, 0x1F, 0x59,
+    0xAE, 0x01, 0xE0, 0xF3, 0x63, 0xA9, 0x31, 0x5D,
+    0x04, 0xBA, 0x04, 0x4A, 0xEB, 0x4E, 0xEF, 0xD4,
+    0x85, 0x63, 0x21, 0x5F, 0x72, 0xC8, 0xD9, 0x89,
+    0x62, 0xD2, 0x18, 0x77, 0x12, 0x96, 0xEF, 0x6A,
+    0x20, 0xBD, 0x72, 0xB9, 0xB2, 0x1E, 0x6B, 0x3D,
+    0x53, 0xC4, 0x4F, 0xAB, 0x73, 0x48, 0x10, 0xF7,
+    0xD2, 0x03, 0xA9, 0xE0, 0xD7, 0xCE, 0x25, 0xD0,
+    0x2E, 0x52, 0x98, 0x9E, 0xCC, 0xF8, 0x5F, 0x34,
+    0x91, 0x2A, 0x04, 0x91, 0x3E, 0x9E, 0xBD, 0x87,
+    0x82, 0x67, 0x53, 0x7D, 0x4A, 0x61, 0x2A, 0x18,
+    0x51, 0xE7, 0x5D, 0x99, 0x98, 0xF0, 0x01, 0xDB,
+    0xC9, 0xC7, 0x7F, 0x0C, 0x35, 0x2D, 0x40, 0x8C,
+    0xA7, 0x96, 0xD1, 0x82, 0x04, 0xA6, 0x36, 0xF7,
+    0xE4, 0x40, 0x40, 0x92, 0x1C, 0x1E, 0x46, 0x7C,
+    0x52, 0x4E, 0x7C, 0x7A, 0x7E, 0xD3, 0x6C, 0x41,
+    0x2A, 0x43, 0x4C, 0xEB, 0x23, 0x0B, 0x2D, 0xFE,
+    0x35, 0x49, 0xC5, 0x77, 0x7A, 0x17, 0xFB, 0x04,
+    0xB8, 0x50, 0xDE, 0x95, 0xD9, 0x7A, 0xC4, 0x0A,
+    0x55, 0xEA, 0x6F, 0x75, 0x41, 0xC4, 0xF8, 0x2B,
+    0x37, 0xBF, 0x90, 0xFE, 0x52, 0x07, 0x4F, 0x19,
+    0xFA, 0x8F, 0x75, 0xF0, 0x06, 0x7E, 0x82, 0xB1,
+    0x8A, 0x1A, 0xC0, 0x24, 0xB3, 0x0E, 0x9B, 0x12,
+    0xC1, 0x4A, 0xB0, 0xDD, 0xCC, 0x03, 0xAA, 0x20,
+};
+
+static const unsigned char dhm_rfc5114_2048_p[] = {
+    0xAD, 0x10, 0x7E, 0x1E, 0x91, 0x23, 0xA9, 0xD0,
+    0xD6, 0x60, 0xFA, 0xA7, 0x95, 0x59, 0xC5, 0x1F,
+    0xA2, 0x0D, 0x64, 0xE5, 0x68, 0x3B, 0x9F, 0xD1,
+    0xB5, 0x4B, 0x15, 0x97, 0xB6, 0x1D, 0x0A, 0x75,
+    0xE6, 0xFA, 0x14, 0x1D, 0xF9, 0x5A, 0x56, 0xDB,
+    0xAF, 0x9A, 0x3C, 0x40, 0x7B, 0xA1, 0xDF, 0x15,
+    0xEB, 0x3D, 0x68, 0x8A, 0x30, 0x9C, 0x18, 0x0E,
+    0x1D, 0xE6, 0xB8, 0x5A, 0x12, 0x74, 0xA0, 0xA6,
+    0x6D, 0x3F, 0x81, 0x52, 0xAD, 0x6A, 0xC2, 0x12,
+    0x90, 0x37, 0xC9, 0xED, 0xEF, 0xDA, 0x4D, 0xF8,
+    0xD9, 0x1E, 0x8F, 0xEF, 0x55, 0xB7, 0x39, 0x4B,
+    0x7A, 0xD5, 0xB7, 0xD0, 0xB6, 0xC1, 0x22, 0x07,
+    0xC9, 0xF9, 0x8D, 0x11, 0xED, 0x34, 0xDB, 0xF6,
+    0xC6, 0xBA, 0x0B, 0x2C, 0x8B, 0xBC, 0x27, 0xBE,
+    0x6A, 0x00, 0xE0, 0xA0, 0xB9, 0xC4, 0x97, 0x08,
+    0xB3, 0xBF, 0x8A, 0x31, 0x70, 0x91, 0x88, 0x36,
+    0x81, 0x28, 0x61, 0x30, 0xBC, 0x89, 0x85, 0xDB,
+    0x16, 0x02, 0xE7, 0x14, 0x41, 0x5D, 0x93, 0x30,
+    0x27, 0x82, 0x73, 0xC7, 0xDE, 0x31, 0xEF, 0xDC,
+    0x73, 0x10, 0xF7, 0x12, 0x1F, 0xD5, 0xA0, 0x74,
+    0x15, 0x98, 0x7D, 0x9A, 0xDC, 0x0A, 0x48, 0x6D,
+    0xCD, 0xF9, 0x3A, 0xCC, 0x44, 0x32, 0x83, 0x87,
+    0x31, 0x5D, 0x75, 0xE1, 0x98, 0xC6, 0x41, 0xA4,
+    0x80, 0xCD, 0x86, 0xA1, 0xB9, 0xE5, 0x87, 0xE8,
+    0xBE, 0x60, 0xE6, 0x9C, 0xC9, 0x28, 0xB2, 0xB9,
+    0xC5, 0x21, 0x72, 0xE4, 0x13, 0x04, 0x2E, 0x9B,
+    0x23, 0xF1, 0x0B, 0x0E, 0x16, 0xE7, 0x97, 0x63,
+    0xC9, 0xB5, 0x3D, 0xCF, 0x4B, 0xA8, 0x0A, 0x29,
+    0xE3, 0xFB, 0x73, 0xC1, 0x6B, 0x8E, 0x75, 0xB9,
+    0x7E, 0xF3, 0x63, 0xE2, 0xFF, 0xA3, 0x1F, 0x71,
+    0xCF, 0x9D, 0xE5, 0x38, 0x4E, 0x71, 0xB8, 0x1C,
+    0x0A, 0xC4, 0xDF, 0xFE, 0x0C, 0x10, 0xE6, 0x4F,
+};
+
+static const unsigned char dhm_rfc5114_2048_g[] = {
+    0xAC, 0x40, 0x32, 0xEF, 0x4F, 0x2D, 0x9A, 0xE3,
+    0x9D, 0xF3, 0x0B, 0x5C, 0x8F, 0xFD, 0xAC, 0x50,
+    0x6C, 0xDE, 0xBE, 0x7B, 0x89, 0x99, 0x8C, 0xAF,
+    0x74, 0x86, 0x6A, 0x08, 0xCF, 0xE4, 0xFF, 0xE3,
+    0xA6, 0x82, 0x4A, 0x4E, 0x10, 0xB9, 0xA6, 0xF0,
+    0xDD, 0x92, 0x1F, 0x01, 0xA7, 0x0C, 0x4A, 0xFA,
+    0xAB, 0x73, 0x9D, 0x77, 0x00, 0xC2, 0x9F, 0x52,
+    0xC5, 0x7D, 0xB1, 0x7C, 0x62, 0x0A, 0x86, 0x52,
+    0xBE, 0x5E, 0x90, 0x01, 0xA8, 0xD6, 0x6A, 0xD7,
+    0xC1, 0x76, 0x69, 0x10, 0x19, 0x99, 0x02, 0x4A,
+    0xF4, 0xD0, 0x27, 0x27, 0x5A, 0xC1, 0x34, 0x8B,
+    0xB8, 0xA7, 0x62, 0xD0, 0x52, 0x1B, 0xC9, 0x8A,
+    0xE2, 0x47, 0x15, 0x04, 0x22, 0xEA, 0x1E, 0xD4,
+    0x09, 0x93, 0x9D, 0x54, 0xDA, 0x74, 0x60, 0xCD,
+    0xB5, 0xF6, 0xC6, 0xB2, 0x50, 0x71, 0x7C, 0xBE,
+    0xF1, 0x80, 0xEB, 0x34, 0x11, 0x8E, 0x98, 0xD1,
+    0x19, 0x52, 0x9A, 0x45, 0xD6, 0xF8, 0x34, 0x56,
+    0x6E, 0x30, 0x25, 0xE3, 0x16, 0xA3, 0x30, 0xEF,
+    0xBB, 0x77, 0xA8, 0x6F, 0x0C, 0x1A, 0xB1, 0x5B,
+    0x05, 0x1A, 0xE3, 0xD4, 0x28, 0xC8, 0xF8, 0xAC,
+    0xB7, 0x0A, 0x81, 0x37, 0x15, 0x0B, 0x8E, 0xEB,
+    0x10, 0xE1, 0x83, 0xED, 0xD1, 0x99, 0x63, 0xDD,
+    0xD9, 0xE2, 0x63, 0xE4, 0x77, 0x05, 0x89, 0xEF,
+    0x6A, 0xA2, 0x1E, 0x7F, 0x5F, 0x2F, 0xF3, 0x81,
+    0xB5, 0x39, 0xCC, 0xE3, 0x40, 0x9D, 0x13, 0xCD,
+    0x56, 0x6A, 0xFB, 0xB4, 0x8D, 0x6C, 0x01, 0x91,
+    0x81, 0xE1, 0xBC, 0xFE, 0x94, 0xB3, 0x02, 0x69,
+    0xED, 0xFE, 0x72, 0xFE, 0x9B, 0x6A, 0xA4, 0xBD,
+    0x7B, 0x5A, 0x0F, 0x1C, 0x71, 0xCF, 0xFF, 0x4C,
+    0x19, 0xC4, 0x18, 0xE1, 0xF6, 0xEC, 0x01, 0x79,
+    0x81, 0xBC, 0x08, 0x7F, 0x2A, 0x70, 0x65, 0xB3,
+    0x84, 0xB8, 0x90, 0xD3, 0x19, 0x1F, 0x2B, 0xFA,
+};
+
+static const unsigned char dhm_rfc5114_2048_rr[] = {
+    0x9C, 0xD7, 0xF3, 0x20, 0xDE, 0x5C, 0x80, 0x27,
+    0x0C, 0xBA, 0xF2, 0xCD, 0xC1, 0x49, 0xDE, 0xAD,
+    0xF9, 0x4D, 0xCF, 0x8D, 0x59, 0xE8, 0x48, 0x17,
+    0xD5, 0x52, 0xF3, 0x6A, 0x16, 0x00, 0x80, 0x64,
+    0x32, 0xA3, 0xD5, 0xF2, 0x92, 0x7B, 0xA6, 0x30,
+    0x7D, 0x04, 0xE4, 0xC9, 0x6D, 0x86, 0xB7, 0xA2,
+    0x3B, 0xF4, 0x32, 0x96, 0xCD, 0x27, 0x8A, 0x9D,
+    0x66, 0xB2, 0x55, 0x57, 0x03, 0xAE, 0xAB, 0x8D,
+    0x8C, 0x87, 0x3D, 0x52, 0xEB, 0x59, 0xE6, 0x16,
+    0x35, 0xE4, 0x7D, 0x0C, 0x58, 0xEC, 0xB8, 0xD4,
+    0x3F, 0x46, 0x2A, 0xF2, 0x64, 0x7C, 0x04, 0x52,
+    0x36, 0x85, 0x8F, 0xC9, 0xED, 0xC7, 0x6B, 0x42,
+    0x8A, 0x9B, 0x8C, 0x76, 0xD8, 0x4E, 0x86, 0xC1,
+    0x43, 0x29, 0x76, 0x4C, 0xD3, 0xB6, 0x69, 0x4A,
+    0x4D, 0x0B, 0x5E, 0xBC, 0x60, 0x54, 0x02, 0x4F,
+    0x61, 0x3C, 0x18, 0x87, 0x70, 0x3F, 0x2F, 0x11,
+    0x34, 0x2E, 0xA7, 0xD4, 0x60, 0xC9, 0xE8, 0xA5,
+    0xF3, 0x26, 0x17, 0x6D, 0xF6, 0xC2, 0x23, 0xC3,
+    0x1F, 0x0D, 0xD8, 0x7C, 0x4F, 0x1F, 0x69, 0xD4,
+    0x09, 0x6F, 0x63, 0x67, 0x25, 0xAF, 0xAE, 0x57,
+    0xED, 0xA9, 0x13, 0xB2, 0x36, 0xBB, 0x3C, 0xFA,
+    0x0E, 0x59, 0xDF, 0x3E, 0xA9, 0x86, 0x61, 0x1D,
+    0xFC, 0xD6, 0x5F, 0x0E, 0xE0, 0xB8, 0xF7, 0x80,
+    0x98, 0x3D, 0x71, 0xA4, 0xBF, 0x74, 0x62, 0x99,
+    0x78, 0x2B, 0x7D, 0x91, 0xF0, 0x0E, 0xDC, 0x9A,
+    0x2F, 0xE7, 0x4E, 0xBD, 0xE7, 0x6D, 0xCC, 0x8F,
+    0x3A, 0xDB, 0x12, 0x5B, 0x7F, 0x8C, 0x85, 0x9C,
+    0xF3, 0x55, 0x42, 0xD9, 0xCF, 0x4C, 0xE6, 0x40,
+    0x1B, 0x1C, 0x6B, 0xBC, 0xFE, 0x7D, 0x0A, 0x78,
+    0x2B, 0x52, 0x25, 0x29, 0xD8, 0xC6, 0x71, 0xAA,
+    0x44, 0xC7, 0x34, 0xB8, 0x43, 0x83, 0x65, 0x29,
+    0x3B, 0xB4, 0x8B, 0x69, 0x2E, 0xC2, 0xBD, 0x6B,
+};
+
+typedef struct
+{
+    int id;
+    const unsigned char *p;  size_t p_len;
+    const unsigned char *g;  size_t g_len;
+    const unsigned char *rr; size_t rr_len;
+}
+dhm_group_data;
+
+#define DHM_GROUP( id, name )                       \
+    { id, dhm_##name##_p,  sizeof( dhm_##name##_p ),    \
+          dhm_##name##_g,  sizeof( dhm_##name##_g ),    \
+          dhm_##name##_rr, sizeof( dhm_##name##_rr ) }
+
+static const dhm_group_data dhm_groups[] =
+{
+    DHM_GROUP( MBEDTLS_DHM_GROUP_RFC3526_2048, rfc3526_2048 ),
+    DHM_GROUP( MBEDTLS_DHM_GROUP_RFC3526_3072, rfc3526_3072 ),
+    DHM_GROUP( MBEDTLS_DHM_GROUP_RFC3526_4096, rfc3526_4096 ),
+    DHM_GROUP( MBEDTLS_DHM_GROUP_RFC5114_2048, rfc5114_2048 ),
+};
+
+#undef DHM_GROUP
+
+int mbedtls_dhm_set_group( mbedtls_dhm_context *ctx,
+                           mbedtls_dhm_group_id group_id )
+{
+    int ret;
+    size_t i;
+    const dhm_group_data *grp = NULL;
+
+    for( i = 0; i < sizeof( dhm_groups ) / sizeof( dhm_groups[0] ); i++ )
+        if( dhm_groups[i].id == (int) group_id )
+            grp = &dhm_groups[i];
+
+    if( grp == NULL )
+        return( MBEDTLS_ERR_DHM_BAD_INPUT_DATA );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &ctx->P,  grp->p,  grp->p_len  ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &ctx->G,  grp->g,  grp->g_len  ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &ctx->RP, grp->rr, grp->rr_len ) );
+
+    ctx->len = grp->p_len;
+    ctx->group_id = (int) group_id;
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Tell whether parameters received from the peer are one of the
+ * well-known groups, so that the cached Montgomery constant can be
+ * used on the client side too
+ */
+static const dhm_group_data *dhm_group_match( const mbedtls_mpi *P,
+                                              const mbedtls_mpi *G )
+{
+    unsigned char buf[512];
+    size_t i, p_len, g_len;
+
+    p_len = mbedtls_mpi_size( P );
+    g_len = mbedtls_mpi_size( G );
+
+    if( p_len > sizeof( buf ) )
+        return( NULL );
+
+    for( i = 0; i < sizeof( dhm_groups ) / sizeof( dhm_groups[0] ); i++ )
+    {
+        if( dhm_groups[i].p_len != p_len || dhm_groups[i].g_len != g_len )
+            continue;
+
+        if( mbedtls_mpi_write_binary( P, buf, p_len ) != 0 ||
+            memcmp( buf, dhm_groups[i].p, p_len ) != 0 )
+            continue;
+
+        if( mbedtls_mpi_write_binary( G, buf, g_len ) != 0 ||
+            memcmp( buf, dhm_groups[i].g, g_len ) != 0 )
+            continue;
+
+        return( &dhm_groups[i] );
+    }
+
+    return( NULL );
+}
+
 /*
  * Parse the ServerKeyExchange parameters
  */
@@ -129,6 +641,7 @@ int mbedtls_dhm_read_params( mbedtls_dhm_context *ctx,
                      const unsigned char *end )
 {
     int ret;
+    const dhm_group_data *grp;
 
     if( ( ret = dhm_read_bignum( &ctx->P,  p, end ) ) != 0 ||
         ( ret = dhm_read_bignum( &ctx->G,  p, end ) ) != 0 ||
@@ -138,6 +651,17 @@ int mbedtls_dhm_read_params( mbedtls_dhm_context *ctx,
     if( ( ret = dhm_check_range( &ctx->GY, &ctx->P ) ) != 0 )
         return( ret );
 
+    /* If the server picked a well-known group, reuse the cached
+     * Montgomery constant instead of recomputing it */
+    if( ( grp = dhm_group_match( &ctx->P, &ctx->G ) ) != NULL )
+    {
+        if( ( ret = mbedtls_mpi_read_binary( &ctx->RP, grp->rr,
+                                             grp->rr_len ) ) != 0 )
+            return( ret );
+
+        ctx->group_id = grp->id;
+    }
+
     ctx->len = mbedtls_mpi_size( &ctx->P );
 
     return( 0 );
@@ -179,7 +703,10 @@ int mbedtls_dhm_make_params( mbedtls_dhm_context *ctx, int x_size,
     MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
                           &ctx->P , &ctx->RP ) );
 
-    if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
+    /* No range re-validation of our own public value for library-provided
+     * groups: G generates a large subgroup, so GX cannot be degenerate */
+    if( ctx->group_id == MBEDTLS_DHM_GROUP_NONE &&
+        ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
 
     /*
@@ -262,7 +789,8 @@ int mbedtls_dhm_make_public( mbedtls_dhm_context *ctx, int x_size,
     MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
                           &ctx->P , &ctx->RP ) );
 
-    if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
+    if( ctx->group_id == MBEDTLS_DHM_GROUP_NONE &&
+        ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &ctx->GX, output, olen ) );
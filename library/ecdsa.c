@@ -66,6 +66,30 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Modular inverse of A modulo the group order: our ECDSA groups all have
+ * prime order, so A^-1 = A^(N-2) mod N by Fermat's little theorem. This
+ * avoids the slower binary extended euclidean loop of mbedtls_mpi_inv_mod()
+ * and reuses the Montgomery constant cached in the group, so repeated
+ * signatures skip the exp_mod warm-up too.
+ */
+static int ecdsa_inv_mod_n( mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                            const mbedtls_mpi *A )
+{
+    int ret;
+    mbedtls_mpi Nm2;
+
+    mbedtls_mpi_init( &Nm2 );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &Nm2, &grp->N, 2 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( X, A, &Nm2, &grp->N, &grp->RR_N ) );
+
+cleanup:
+    mbedtls_mpi_free( &Nm2 );
+
+    return( ret );
+}
+
 /*
  * Compute ECDSA signature of a hashed message (SEC1 4.1.3)
  * Obviously, compared to SEC1 4.1.3, we skip step 4 (hash message)
@@ -136,7 +160,7 @@ int mbedtls_ecdsa_sign( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
         MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, s ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &e, &e, &t ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &k, &k, &t ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( s, &k, &grp->N ) );
+        MBEDTLS_MPI_CHK( ecdsa_inv_mod_n( grp, s, &k ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, s, &e ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
 
@@ -155,16 +179,249 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Initialize a nonce cache
+ */
+void mbedtls_ecdsa_nonce_cache_init( mbedtls_ecdsa_nonce_cache *cache )
+{
+    size_t i;
+
+    cache->grp_id = MBEDTLS_ECP_DP_NONE;
+    cache->count = 0;
+
+    for( i = 0; i < MBEDTLS_ECDSA_NONCE_CACHE_SIZE; i++ )
+    {
+        mbedtls_mpi_init( &cache->r[i] );
+        mbedtls_mpi_init( &cache->k_inv[i] );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &cache->mutex );
+#endif
+}
+
+/*
+ * Free a nonce cache
+ */
+void mbedtls_ecdsa_nonce_cache_free( mbedtls_ecdsa_nonce_cache *cache )
+{
+    size_t i;
+
+    for( i = 0; i < MBEDTLS_ECDSA_NONCE_CACHE_SIZE; i++ )
+    {
+        mbedtls_mpi_free( &cache->r[i] );
+        mbedtls_mpi_free( &cache->k_inv[i] );
+    }
+
+    cache->grp_id = MBEDTLS_ECP_DP_NONE;
+    cache->count = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &cache->mutex );
+#endif
+}
+
+/*
+ * Top up a nonce cache: precompute ( r = xR mod n, k^-1 mod n ) pairs
+ */
+int mbedtls_ecdsa_nonce_cache_fill( mbedtls_ecdsa_nonce_cache *cache,
+                mbedtls_ecp_group *grp,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
+{
+    int ret = 0;
+    int key_tries, blind_tries, full;
+    mbedtls_ecp_point R;
+    mbedtls_mpi k, t, rc, ki;
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &k ); mbedtls_mpi_init( &t );
+    mbedtls_mpi_init( &rc ); mbedtls_mpi_init( &ki );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    /* A cache holds nonces for one curve at a time */
+    if( cache->grp_id != grp->id )
+    {
+        cache->grp_id = grp->id;
+        cache->count = 0;
+    }
+    full = cache->count >= MBEDTLS_ECDSA_NONCE_CACHE_SIZE;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_unlock( &cache->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    /*
+     * The expensive work is done outside the lock, so signing threads are
+     * not blocked while we precompute.
+     */
+    while( ! full )
+    {
+        /*
+         * Steps 1-3 of SEC1 4.1.3: generate a suitable ephemeral keypair
+         * and set r = xR mod n, as in mbedtls_ecdsa_sign()
+         */
+        key_tries = 0;
+        do
+        {
+            MBEDTLS_MPI_CHK( mbedtls_ecp_gen_keypair( grp, &k, &R, f_rng, p_rng ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &rc, &R.X, &grp->N ) );
+
+            if( key_tries++ > 10 )
+            {
+                ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+                goto cleanup;
+            }
+        }
+        while( mbedtls_mpi_cmp_int( &rc, 0 ) == 0 );
+
+        /*
+         * Blind the inversion with a random t: k^-1 = t * (kt)^-1 mod n,
+         * as in mbedtls_ecdsa_sign()
+         */
+        blind_tries = 0;
+        do
+        {
+            size_t n_size = ( grp->nbits + 7 ) / 8;
+            MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &t, n_size, f_rng, p_rng ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &t, 8 * n_size - grp->nbits ) );
+
+            if( ++blind_tries > 30 )
+            {
+                ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+                goto cleanup;
+            }
+        }
+        while( mbedtls_mpi_cmp_int( &t, 1 ) < 0 ||
+               mbedtls_mpi_cmp_mpi( &t, &grp->N ) >= 0 );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &k, &k, &t ) );
+        MBEDTLS_MPI_CHK( ecdsa_inv_mod_n( grp, &ki, &k ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ki, &ki, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &ki, &ki, &grp->N ) );
+
+        /* Publish, unless a concurrent fill or group switch got there first */
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+
+        if( cache->grp_id == grp->id &&
+            cache->count < MBEDTLS_ECDSA_NONCE_CACHE_SIZE )
+        {
+            mbedtls_mpi_swap( &cache->r[cache->count], &rc );
+            mbedtls_mpi_swap( &cache->k_inv[cache->count], &ki );
+            cache->count++;
+        }
+        full = cache->grp_id != grp->id ||
+               cache->count >= MBEDTLS_ECDSA_NONCE_CACHE_SIZE;
+
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_unlock( &cache->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+    }
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &k ); mbedtls_mpi_free( &t );
+    mbedtls_mpi_free( &rc ); mbedtls_mpi_free( &ki );
+
+    return( ret );
+}
+
+/*
+ * Compute an ECDSA signature from a precomputed nonce:
+ * s = k^-1 (e + r d) mod n (SEC1 4.1.3 step 6)
+ */
+int mbedtls_ecdsa_sign_cached( mbedtls_ecp_group *grp,
+                mbedtls_ecdsa_nonce_cache *cache,
+                mbedtls_mpi *r, mbedtls_mpi *s,
+                const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
+{
+    int ret = 0;
+    int have_nonce = 0;
+    mbedtls_mpi e, rc, ki;
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &rc ); mbedtls_mpi_init( &ki );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    if( cache->grp_id == grp->id && cache->count > 0 )
+    {
+        cache->count--;
+        mbedtls_mpi_swap( &rc, &cache->r[cache->count] );
+        mbedtls_mpi_swap( &ki, &cache->k_inv[cache->count] );
+        have_nonce = 1;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_unlock( &cache->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    if( have_nonce == 0 )
+    {
+        ret = mbedtls_ecdsa_sign( grp, r, s, d, buf, blen, f_rng, p_rng );
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, &rc, d ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, s ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, &ki, &e ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
+
+    /*
+     * The nonce is consumed either way; in the (negligible probability)
+     * case s = 0, fall back to the one-shot path rather than outputting an
+     * invalid signature.
+     */
+    if( mbedtls_mpi_cmp_int( s, 0 ) == 0 )
+    {
+        ret = mbedtls_ecdsa_sign( grp, r, s, d, buf, blen, f_rng, p_rng );
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( r, &rc ) );
+
+cleanup:
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &rc ); mbedtls_mpi_free( &ki );
+
+    return( ret );
+}
+
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
 /*
- * Deterministic signature wrapper
+ * Deterministic signature core: seed the caller's HMAC_DRBG for this
+ * message and sign. A persistent rng_ctx (as cached in an
+ * mbedtls_ecdsa_context) is re-seeded in place, so it keeps its md setup
+ * from the previous signature.
  */
-int mbedtls_ecdsa_sign_det( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+static int ecdsa_sign_det_seeded( mbedtls_ecp_group *grp,
+                    mbedtls_mpi *r, mbedtls_mpi *s,
                     const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
-                    mbedtls_md_type_t md_alg )
+                    mbedtls_md_type_t md_alg,
+                    mbedtls_hmac_drbg_context *rng_ctx )
 {
     int ret;
-    mbedtls_hmac_drbg_context rng_ctx;
     unsigned char data[2 * MBEDTLS_ECP_MAX_BYTES];
     size_t grp_len = ( grp->nbits + 7 ) / 8;
     const mbedtls_md_info_t *md_info;
@@ -174,23 +431,41 @@ int mbedtls_ecdsa_sign_det( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi
         return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
 
     mbedtls_mpi_init( &h );
-    mbedtls_hmac_drbg_init( &rng_ctx );
 
     /* Use private key and message hash (reduced) to initialize HMAC_DRBG */
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( d, data, grp_len ) );
     MBEDTLS_MPI_CHK( derive_mpi( grp, &h, buf, blen ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &h, data + grp_len, grp_len ) );
-    mbedtls_hmac_drbg_seed_buf( &rng_ctx, md_info, data, 2 * grp_len );
+    MBEDTLS_MPI_CHK( mbedtls_hmac_drbg_seed_buf( rng_ctx, md_info,
+                                                 data, 2 * grp_len ) );
 
     ret = mbedtls_ecdsa_sign( grp, r, s, d, buf, blen,
-                      mbedtls_hmac_drbg_random, &rng_ctx );
+                      mbedtls_hmac_drbg_random, rng_ctx );
 
 cleanup:
-    mbedtls_hmac_drbg_free( &rng_ctx );
     mbedtls_mpi_free( &h );
 
     return( ret );
 }
+
+/*
+ * Deterministic signature wrapper
+ */
+int mbedtls_ecdsa_sign_det( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+                    const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                    mbedtls_md_type_t md_alg )
+{
+    int ret;
+    mbedtls_hmac_drbg_context rng_ctx;
+
+    mbedtls_hmac_drbg_init( &rng_ctx );
+
+    ret = ecdsa_sign_det_seeded( grp, r, s, d, buf, blen, md_alg, &rng_ctx );
+
+    mbedtls_hmac_drbg_free( &rng_ctx );
+
+    return( ret );
+}
 #endif /* MBEDTLS_ECDSA_DETERMINISTIC */
 
 /*
@@ -246,10 +521,11 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
     /*
      * Step 5: R = u1 G + u2 Q
      *
-     * Since we're not using any secret data, no need to pass a RNG to
-     * mbedtls_ecp_mul() for countermesures.
+     * All the data here is public, so use the variable-time interleaved
+     * wNAF combination, which shares the doublings between both scalars.
      */
-    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd( grp, &R, &u1, &grp->G, &u2, Q ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_vartime( grp, &R, &u1, &grp->G,
+                                                 &u2, Q ) );
 
     if( mbedtls_ecp_is_zero( &R ) )
     {
@@ -279,6 +555,244 @@ cleanup:
     return( ret );
 }
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/*
+ * Initialize a restart context
+ */
+void mbedtls_ecdsa_restart_init( mbedtls_ecdsa_restart_ctx *ctx )
+{
+    mbedtls_mpi_init( &ctx->k );
+    mbedtls_mpi_init( &ctx->u1 );
+    mbedtls_mpi_init( &ctx->u2 );
+    ctx->cheap_done = 0;
+    mbedtls_ecp_restart_init( &ctx->rs );
+}
+
+/*
+ * Free a restart context
+ */
+void mbedtls_ecdsa_restart_free( mbedtls_ecdsa_restart_ctx *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_mpi_free( &ctx->k );
+    mbedtls_mpi_free( &ctx->u1 );
+    mbedtls_mpi_free( &ctx->u2 );
+    ctx->cheap_done = 0;
+    mbedtls_ecp_restart_free( &ctx->rs );
+}
+
+/*
+ * Restartable version of mbedtls_ecdsa_sign(): only the computation of
+ * R = k G is sliced, everything else is cheap and runs in the final call.
+ * The ephemeral secret lives in the restart context so that resumed calls
+ * keep multiplying the same scalar.
+ */
+int mbedtls_ecdsa_sign_restartable( mbedtls_ecp_group *grp,
+                mbedtls_mpi *r, mbedtls_mpi *s,
+                const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+                mbedtls_ecdsa_restart_ctx *rs )
+{
+    int ret, key_tries, sign_tries, blind_tries;
+    mbedtls_ecp_point R;
+    mbedtls_mpi e, t;
+
+    if( rs == NULL )
+        return( mbedtls_ecdsa_sign( grp, r, s, d, buf, blen, f_rng, p_rng ) );
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &t );
+
+    sign_tries = 0;
+    do
+    {
+        /*
+         * Steps 1-3: generate a suitable ephemeral keypair
+         * and set r = xR mod n
+         *
+         * The keypair generation resumes an interrupted multiplication
+         * instead of drawing a fresh scalar, so an MBEDTLS_ERR_ECP_IN_PROGRESS
+         * return here simply propagates to the caller.
+         */
+        key_tries = 0;
+        do
+        {
+            MBEDTLS_MPI_CHK( mbedtls_ecp_gen_keypair_restartable( grp, &rs->k,
+                                                &R, f_rng, p_rng, &rs->rs ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( r, &R.X, &grp->N ) );
+
+            if( key_tries++ > 10 )
+            {
+                ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+                goto cleanup;
+            }
+        }
+        while( mbedtls_mpi_cmp_int( r, 0 ) == 0 );
+
+        /*
+         * Step 5: derive MPI from hashed message
+         */
+        MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
+
+        /*
+         * Generate a random value to blind inv_mod in next step,
+         * avoiding a potential timing leak.
+         */
+        blind_tries = 0;
+        do
+        {
+            size_t n_size = ( grp->nbits + 7 ) / 8;
+            MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &t, n_size, f_rng, p_rng ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &t, 8 * n_size - grp->nbits ) );
+
+            if( ++blind_tries > 30 )
+            {
+                ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+                goto cleanup;
+            }
+        }
+        while( mbedtls_mpi_cmp_int( &t, 1 ) < 0 ||
+               mbedtls_mpi_cmp_mpi( &t, &grp->N ) >= 0 );
+
+        /*
+         * Step 6: compute s = (e + r * d) / k = t (e + rd) / (kt) mod n
+         */
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, r, d ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, s ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &e, &e, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &rs->k, &rs->k, &t ) );
+        MBEDTLS_MPI_CHK( ecdsa_inv_mod_n( grp, s, &rs->k ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, s, &e ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
+
+        if( sign_tries++ > 10 )
+        {
+            ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+            goto cleanup;
+        }
+    }
+    while( mbedtls_mpi_cmp_int( s, 0 ) == 0 );
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &t );
+
+    /* The ephemeral secret is only needed while in progress */
+    if( ret != MBEDTLS_ERR_ECP_IN_PROGRESS )
+        mbedtls_mpi_free( &rs->k );
+
+    return( ret );
+}
+
+/*
+ * Restartable version of mbedtls_ecdsa_verify(): the scalars u1 and u2 are
+ * computed once (they involve a modular inversion), then the linear
+ * combination is sliced.
+ */
+int mbedtls_ecdsa_verify_restartable( mbedtls_ecp_group *grp,
+                  const unsigned char *buf, size_t blen,
+                  const mbedtls_ecp_point *Q,
+                  const mbedtls_mpi *r, const mbedtls_mpi *s,
+                  mbedtls_ecdsa_restart_ctx *rs )
+{
+    int ret;
+    mbedtls_mpi e, s_inv;
+    mbedtls_ecp_point R;
+
+    if( rs == NULL )
+        return( mbedtls_ecdsa_verify( grp, buf, blen, Q, r, s ) );
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &s_inv );
+
+    if( rs->cheap_done == 0 )
+    {
+        /*
+         * Step 1: make sure r and s are in range 1..n-1
+         */
+        if( mbedtls_mpi_cmp_int( r, 1 ) < 0 || mbedtls_mpi_cmp_mpi( r, &grp->N ) >= 0 ||
+            mbedtls_mpi_cmp_int( s, 1 ) < 0 || mbedtls_mpi_cmp_mpi( s, &grp->N ) >= 0 )
+        {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+            goto cleanup;
+        }
+
+        /*
+         * Additional precaution: make sure Q is valid
+         */
+        MBEDTLS_MPI_CHK( mbedtls_ecp_check_pubkey( grp, Q ) );
+
+        /*
+         * Step 3: derive MPI from hashed message
+         */
+        MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
+
+        /*
+         * Step 4: u1 = e / s mod n, u2 = r / s mod n
+         */
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &s_inv, s, &grp->N ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &rs->u1, &e, &s_inv ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &rs->u1, &rs->u1, &grp->N ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &rs->u2, r, &s_inv ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &rs->u2, &rs->u2, &grp->N ) );
+
+        rs->cheap_done = 1;
+    }
+
+    /*
+     * Step 5: R = u1 G + u2 Q, sliced
+     */
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_restartable( grp, &R, &rs->u1, &grp->G,
+                                                     &rs->u2, Q, &rs->rs ) );
+
+    if( mbedtls_ecp_is_zero( &R ) )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    /*
+     * Step 6: convert xR to an integer (no-op)
+     * Step 7: reduce xR mod n (gives v)
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &R.X, &R.X, &grp->N ) );
+
+    /*
+     * Step 8: check if v (that is, R.X) is equal to r
+     */
+    if( mbedtls_mpi_cmp_mpi( &R.X, r ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &s_inv );
+
+    if( ret != MBEDTLS_ERR_ECP_IN_PROGRESS )
+    {
+        rs->cheap_done = 0;
+        mbedtls_mpi_free( &rs->u1 );
+        mbedtls_mpi_free( &rs->u2 );
+    }
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /*
  * Convert a signature (given by context) to ASN.1
  */
@@ -322,8 +836,8 @@ int mbedtls_ecdsa_write_signature( mbedtls_ecdsa_context *ctx, mbedtls_md_type_t
     (void) f_rng;
     (void) p_rng;
 
-    MBEDTLS_MPI_CHK( mbedtls_ecdsa_sign_det( &ctx->grp, &r, &s, &ctx->d,
-                             hash, hlen, md_alg ) );
+    MBEDTLS_MPI_CHK( ecdsa_sign_det_seeded( &ctx->grp, &r, &s, &ctx->d,
+                             hash, hlen, md_alg, &ctx->det_rng ) );
 #else
     (void) md_alg;
 
@@ -435,7 +949,14 @@ int mbedtls_ecdsa_from_keypair( mbedtls_ecdsa_context *ctx, const mbedtls_ecp_ke
  */
 void mbedtls_ecdsa_init( mbedtls_ecdsa_context *ctx )
 {
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+    mbedtls_ecp_group_init( &ctx->grp );
+    mbedtls_mpi_init( &ctx->d );
+    mbedtls_ecp_point_init( &ctx->Q );
+    mbedtls_hmac_drbg_init( &ctx->det_rng );
+#else
     mbedtls_ecp_keypair_init( ctx );
+#endif
 }
 
 /*
@@ -443,7 +964,14 @@ void mbedtls_ecdsa_init( mbedtls_ecdsa_context *ctx )
  */
 void mbedtls_ecdsa_free( mbedtls_ecdsa_context *ctx )
 {
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+    mbedtls_ecp_group_free( &ctx->grp );
+    mbedtls_mpi_free( &ctx->d );
+    mbedtls_ecp_point_free( &ctx->Q );
+    mbedtls_hmac_drbg_free( &ctx->det_rng );
+#else
     mbedtls_ecp_keypair_free( ctx );
+#endif
 }
 
 #endif /* MBEDTLS_ECDSA_C */
@@ -51,6 +51,14 @@
 
 #include "mbedtls/ecp.h"
 
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
+#if defined(MBEDTLS_TIMING_TRACE)
+#include "mbedtls/timing.h"
+#endif
+
 #include <string.h>
 
 #if defined(MBEDTLS_PLATFORM_C)
@@ -67,10 +75,8 @@
 #define inline __inline
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
+#include "mbedtls/hints.h"
 
 #if defined(MBEDTLS_SELF_TEST)
 /*
@@ -341,6 +347,8 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_free( grp->T );
     }
 
+    mbedtls_mpi_free( &grp->RR_N );
+
     mbedtls_zeroize( grp, sizeof( mbedtls_ecp_group ) );
 }
 
@@ -711,6 +719,42 @@ cleanup:
     while( mbedtls_mpi_cmp_mpi( &N, &grp->P ) >= 0 )        \
         MBEDTLS_MPI_CHK( mbedtls_mpi_sub_abs( &N, &N, &grp->P ) )
 
+/*
+ * Size (in limbs) of the stack buffers backing temporary field elements.
+ *
+ * Values handled by the point arithmetic below are kept in [0, P) by the
+ * MOD_xxx macros, so the largest intermediate is a product of two reduced
+ * elements, which takes twice the limbs of P; the fast mod-p routines may
+ * also grow their argument to that size. One extra limb covers the
+ * mbedtls_mpi_shift_l() and mbedtls_mpi_mul_int() calls.
+ */
+#define ECP_FE_LIMBS                                                        \
+    ( 2 * ( ( MBEDTLS_ECP_MAX_BYTES + sizeof( mbedtls_mpi_uint ) - 1 ) /    \
+            sizeof( mbedtls_mpi_uint ) ) + 2 )
+
+/*
+ * Initialize an MPI backed by a stack buffer of ECP_FE_LIMBS limbs,
+ * avoiding one calloc/free pair per temporary in the hot path.
+ *
+ * The buffer is large enough for any value handled below, so the mpi
+ * functions never need to grow (hence realloc) it. Such an MPI must not
+ * be passed to mbedtls_mpi_free(); use ecp_fe_release() instead.
+ */
+static void ecp_fe_init( mbedtls_mpi *X, mbedtls_mpi_uint *buf )
+{
+    memset( buf, 0, ECP_FE_LIMBS * sizeof( mbedtls_mpi_uint ) );
+
+    X->s = 1;
+    X->n = ECP_FE_LIMBS;
+    X->p = buf;
+}
+
+static void ecp_fe_release( mbedtls_mpi *X )
+{
+    mbedtls_zeroize( X->p, X->n * sizeof( mbedtls_mpi_uint ) );
+    X->p = NULL;
+}
+
 #if defined(ECP_SHORTWEIERSTRASS)
 /*
  * For curves in short Weierstrass form, we do all the internal operations in
@@ -720,6 +764,75 @@ cleanup:
  * SPA, hence timing attacks.
  */
 
+/*
+ * Field operations mod P, dispatching to the specialized implementations
+ * installed on the group when there are any (see the field_xxx members of
+ * mbedtls_ecp_group), with fall-back to the generic bignum path.
+ */
+static int ecp_field_mul( const mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                          const mbedtls_mpi *A, const mbedtls_mpi *B )
+{
+    int ret;
+
+    if( grp->field_mul != NULL )
+        return( grp->field_mul( grp, X, A, B ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( X, A, B ) );
+    MBEDTLS_MPI_CHK( ecp_modp( X, grp ) );
+
+cleanup:
+    return( ret );
+}
+
+static int ecp_field_sqr( const mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                          const mbedtls_mpi *A )
+{
+    int ret;
+
+    if( grp->field_sqr != NULL )
+        return( grp->field_sqr( grp, X, A ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( X, A, A ) );
+    MBEDTLS_MPI_CHK( ecp_modp( X, grp ) );
+
+cleanup:
+    return( ret );
+}
+
+static int ecp_field_add( const mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                          const mbedtls_mpi *A, const mbedtls_mpi *B )
+{
+    int ret;
+
+    if( grp->field_add != NULL )
+        return( grp->field_add( grp, X, A, B ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( X, A, B ) );
+    while( mbedtls_mpi_cmp_mpi( X, &grp->P ) >= 0 )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_abs( X, X, &grp->P ) );
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Shortcuts for the point formulas below
+ */
+#define MPI_MUL( X, A, B )                                                  \
+    do {                                                                    \
+        MBEDTLS_MPI_CHK( ecp_field_mul( grp, &( X ), &( A ), &( B ) ) );    \
+        INC_MUL_COUNT                                                       \
+    } while( 0 )
+
+#define MPI_SQR( X, A )                                                     \
+    do {                                                                    \
+        MBEDTLS_MPI_CHK( ecp_field_sqr( grp, &( X ), &( A ) ) );            \
+        INC_MUL_COUNT                                                       \
+    } while( 0 )
+
+#define MPI_ADD( X, A, B )                                                  \
+    MBEDTLS_MPI_CHK( ecp_field_add( grp, &( X ), &( A ), &( B ) ) )
+
 /*
  * Normalize jacobian coordinates so that Z == 0 || Z == 1  (GECC 3.2.1)
  * Cost: 1N := 1I + 3M + 1S
@@ -738,14 +851,14 @@ static int ecp_normalize_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *p
      * X = X / Z^2  mod p
      */
     MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &Zi,      &pt->Z,     &grp->P ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ZZi,     &Zi,        &Zi     ) ); MOD_MUL( ZZi );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->X,   &pt->X,     &ZZi    ) ); MOD_MUL( pt->X );
+    MPI_SQR( ZZi,   Zi          );
+    MPI_MUL( pt->X, pt->X, ZZi  );
 
     /*
      * Y = Y / Z^3  mod p
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->Y,   &pt->Y,     &ZZi    ) ); MOD_MUL( pt->Y );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->Y,   &pt->Y,     &Zi     ) ); MOD_MUL( pt->Y );
+    MPI_MUL( pt->Y, pt->Y, ZZi  );
+    MPI_MUL( pt->Y, pt->Y, Zi   );
 
     /*
      * Z = 1
@@ -790,10 +903,7 @@ static int ecp_normalize_jac_many( const mbedtls_ecp_group *grp,
      */
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &c[0], &T[0]->Z ) );
     for( i = 1; i < t_len; i++ )
-    {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c[i], &c[i-1], &T[i]->Z ) );
-        MOD_MUL( c[i] );
-    }
+        MPI_MUL( c[i], c[i-1], T[i]->Z );
 
     /*
      * u = 1 / (Z_0 * ... * Z_n) mod P
@@ -807,21 +917,22 @@ static int ecp_normalize_jac_many( const mbedtls_ecp_group *grp,
          * u = 1 / (Z_0 * ... * Z_i) mod P
          */
         if( i == 0 ) {
-            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &Zi, &u ) );
+            /* u is not needed anymore: move it instead of copying */
+            mbedtls_mpi_swap( &Zi, &u );
         }
         else
         {
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &Zi, &u, &c[i-1]  ) ); MOD_MUL( Zi );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u,  &u, &T[i]->Z ) ); MOD_MUL( u );
+            MPI_MUL( Zi, u, c[i-1]  );
+            MPI_MUL( u,  u, T[i]->Z );
         }
 
         /*
          * proceed as in normalize()
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ZZi,     &Zi,      &Zi  ) ); MOD_MUL( ZZi );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T[i]->X, &T[i]->X, &ZZi ) ); MOD_MUL( T[i]->X );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T[i]->Y, &T[i]->Y, &ZZi ) ); MOD_MUL( T[i]->Y );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T[i]->Y, &T[i]->Y, &Zi  ) ); MOD_MUL( T[i]->Y );
+        MPI_SQR( ZZi,     Zi            );
+        MPI_MUL( T[i]->X, T[i]->X, ZZi  );
+        MPI_MUL( T[i]->Y, T[i]->Y, ZZi  );
+        MPI_MUL( T[i]->Y, T[i]->Y, Zi   );
 
         /*
          * Post-precessing: reclaim some memory by shrinking coordinates
@@ -891,62 +1002,65 @@ static int ecp_double_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 {
     int ret;
     mbedtls_mpi M, S, T, U;
+    mbedtls_mpi_uint Mb[ECP_FE_LIMBS], Sb[ECP_FE_LIMBS];
+    mbedtls_mpi_uint Tb[ECP_FE_LIMBS], Ub[ECP_FE_LIMBS];
 
 #if defined(MBEDTLS_SELF_TEST)
     dbl_count++;
 #endif
 
-    mbedtls_mpi_init( &M ); mbedtls_mpi_init( &S ); mbedtls_mpi_init( &T ); mbedtls_mpi_init( &U );
+    ecp_fe_init( &M, Mb ); ecp_fe_init( &S, Sb );
+    ecp_fe_init( &T, Tb ); ecp_fe_init( &U, Ub );
 
     /* Special case for A = -3 */
     if( grp->A.p == NULL )
     {
         /* M = 3(X + Z^2)(X - Z^2) */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &P->Z,  &P->Z   ) ); MOD_MUL( S );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &T,  &P->X,  &S      ) ); MOD_ADD( T );
+        MPI_SQR( S, P->Z );
+        MPI_ADD( T, P->X, S );
         MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &U,  &P->X,  &S      ) ); MOD_SUB( U );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &T,     &U      ) ); MOD_MUL( S );
+        MPI_MUL( S, T, U );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( &M,  &S,     3       ) ); MOD_ADD( M );
     }
     else
     {
         /* M = 3.X^2 */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &P->X,  &P->X   ) ); MOD_MUL( S );
+        MPI_SQR( S, P->X );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( &M,  &S,     3       ) ); MOD_ADD( M );
 
         /* Optimize away for "koblitz" curves with A = 0 */
         if( mbedtls_mpi_cmp_int( &grp->A, 0 ) != 0 )
         {
             /* M += A.Z^4 */
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &P->Z,  &P->Z   ) ); MOD_MUL( S );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T,  &S,     &S      ) ); MOD_MUL( T );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &T,     &grp->A ) ); MOD_MUL( S );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &M,  &M,     &S      ) ); MOD_ADD( M );
+            MPI_SQR( S, P->Z );
+            MPI_SQR( T, S );
+            MPI_MUL( S, T, grp->A );
+            MPI_ADD( M, M, S );
         }
     }
 
     /* S = 4.X.Y^2 */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T,  &P->Y,  &P->Y   ) ); MOD_MUL( T );
+    MPI_SQR( T, P->Y );
     MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &T,  1               ) ); MOD_ADD( T );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &P->X,  &T      ) ); MOD_MUL( S );
+    MPI_MUL( S, P->X, T );
     MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &S,  1               ) ); MOD_ADD( S );
 
     /* U = 8.Y^4 */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &U,  &T,     &T      ) ); MOD_MUL( U );
+    MPI_SQR( U, T );
     MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &U,  1               ) ); MOD_ADD( U );
 
     /* T = M^2 - 2.S */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T,  &M,     &M      ) ); MOD_MUL( T );
+    MPI_SQR( T, M );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T,  &T,     &S      ) ); MOD_SUB( T );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T,  &T,     &S      ) ); MOD_SUB( T );
 
     /* S = M(S - T) - U */
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &S,  &S,     &T      ) ); MOD_SUB( S );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &S,  &S,     &M      ) ); MOD_MUL( S );
+    MPI_MUL( S, S, M );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &S,  &S,     &U      ) ); MOD_SUB( S );
 
     /* U = 2.Y.Z */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &U,  &P->Y,  &P->Z   ) ); MOD_MUL( U );
+    MPI_MUL( U, P->Y, P->Z );
     MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &U,  1               ) ); MOD_ADD( U );
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &T ) );
@@ -954,7 +1068,8 @@ static int ecp_double_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Z, &U ) );
 
 cleanup:
-    mbedtls_mpi_free( &M ); mbedtls_mpi_free( &S ); mbedtls_mpi_free( &T ); mbedtls_mpi_free( &U );
+    ecp_fe_release( &M ); ecp_fe_release( &S );
+    ecp_fe_release( &T ); ecp_fe_release( &U );
 
     return( ret );
 }
@@ -982,6 +1097,9 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 {
     int ret;
     mbedtls_mpi T1, T2, T3, T4, X, Y, Z;
+    mbedtls_mpi_uint T1b[ECP_FE_LIMBS], T2b[ECP_FE_LIMBS];
+    mbedtls_mpi_uint T3b[ECP_FE_LIMBS], T4b[ECP_FE_LIMBS];
+    mbedtls_mpi_uint Xb[ECP_FE_LIMBS], Yb[ECP_FE_LIMBS], Zb[ECP_FE_LIMBS];
 
 #if defined(MBEDTLS_SELF_TEST)
     add_count++;
@@ -1002,13 +1120,14 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     if( Q->Z.p != NULL && mbedtls_mpi_cmp_int( &Q->Z, 1 ) != 0 )
         return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
 
-    mbedtls_mpi_init( &T1 ); mbedtls_mpi_init( &T2 ); mbedtls_mpi_init( &T3 ); mbedtls_mpi_init( &T4 );
-    mbedtls_mpi_init( &X ); mbedtls_mpi_init( &Y ); mbedtls_mpi_init( &Z );
+    ecp_fe_init( &T1, T1b ); ecp_fe_init( &T2, T2b );
+    ecp_fe_init( &T3, T3b ); ecp_fe_init( &T4, T4b );
+    ecp_fe_init( &X, Xb ); ecp_fe_init( &Y, Yb ); ecp_fe_init( &Z, Zb );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T1,  &P->Z,  &P->Z ) );  MOD_MUL( T1 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T2,  &T1,    &P->Z ) );  MOD_MUL( T2 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T1,  &T1,    &Q->X ) );  MOD_MUL( T1 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T2,  &T2,    &Q->Y ) );  MOD_MUL( T2 );
+    MPI_SQR( T1, P->Z        );
+    MPI_MUL( T2, T1,   P->Z  );
+    MPI_MUL( T1, T1,   Q->X  );
+    MPI_MUL( T2, T2,   Q->Y  );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T1,  &T1,    &P->X ) );  MOD_SUB( T1 );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T2,  &T2,    &P->Y ) );  MOD_SUB( T2 );
 
@@ -1027,17 +1146,17 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
         }
     }
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &Z,   &P->Z,  &T1   ) );  MOD_MUL( Z  );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T3,  &T1,    &T1   ) );  MOD_MUL( T3 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T4,  &T3,    &T1   ) );  MOD_MUL( T4 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T3,  &T3,    &P->X ) );  MOD_MUL( T3 );
+    MPI_MUL( Z,  P->Z, T1    );
+    MPI_SQR( T3, T1          );
+    MPI_MUL( T4, T3,   T1    );
+    MPI_MUL( T3, T3,   P->X  );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( &T1,  &T3,    2     ) );  MOD_ADD( T1 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &X,   &T2,    &T2   ) );  MOD_MUL( X  );
+    MPI_SQR( X,  T2          );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &X,   &X,     &T1   ) );  MOD_SUB( X  );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &X,   &X,     &T4   ) );  MOD_SUB( X  );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T3,  &T3,    &X    ) );  MOD_SUB( T3 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T3,  &T3,    &T2   ) );  MOD_MUL( T3 );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T4,  &T4,    &P->Y ) );  MOD_MUL( T4 );
+    MPI_MUL( T3, T3,   T2    );
+    MPI_MUL( T4, T4,   P->Y  );
     MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &Y,   &T3,    &T4   ) );  MOD_SUB( Y  );
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &X ) );
@@ -1046,8 +1165,9 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 
 cleanup:
 
-    mbedtls_mpi_free( &T1 ); mbedtls_mpi_free( &T2 ); mbedtls_mpi_free( &T3 ); mbedtls_mpi_free( &T4 );
-    mbedtls_mpi_free( &X ); mbedtls_mpi_free( &Y ); mbedtls_mpi_free( &Z );
+    ecp_fe_release( &T1 ); ecp_fe_release( &T2 );
+    ecp_fe_release( &T3 ); ecp_fe_release( &T4 );
+    ecp_fe_release( &X ); ecp_fe_release( &Y ); ecp_fe_release( &Z );
 
     return( ret );
 }
@@ -1083,15 +1203,15 @@ static int ecp_randomize_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *p
     while( mbedtls_mpi_cmp_int( &l, 1 ) <= 0 );
 
     /* Z = l * Z */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->Z,   &pt->Z,     &l  ) ); MOD_MUL( pt->Z );
+    MPI_MUL( pt->Z, pt->Z, l  );
 
     /* X = l^2 * X */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ll,      &l,         &l  ) ); MOD_MUL( ll );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->X,   &pt->X,     &ll ) ); MOD_MUL( pt->X );
+    MPI_SQR( ll,    l         );
+    MPI_MUL( pt->X, pt->X, ll );
 
     /* Y = l^3 * Y */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ll,      &ll,        &l  ) ); MOD_MUL( ll );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &pt->Y,   &pt->Y,     &ll ) ); MOD_MUL( pt->Y );
+    MPI_MUL( ll,    ll,    l  );
+    MPI_MUL( pt->Y, pt->Y, ll );
 
 cleanup:
     mbedtls_mpi_free( &l ); mbedtls_mpi_free( &ll );
@@ -1135,15 +1255,30 @@ cleanup:
 static void ecp_comb_fixed( unsigned char x[], size_t d,
                             unsigned char w, const mbedtls_mpi *m )
 {
-    size_t i, j;
+    size_t i, j, k, take;
+    size_t limb_bits = 8 * sizeof( mbedtls_mpi_uint );
+    mbedtls_mpi_uint bits;
     unsigned char c, cc, adjust;
 
     memset( x, 0, d+1 );
 
-    /* First get the classical comb values (except for x_d = 0) */
-    for( i = 0; i < d; i++ )
-        for( j = 0; j < w; j++ )
-            x[i] |= mbedtls_mpi_get_bit( m, i + d * j ) << j;
+    /*
+     * First get the classical comb values (except for x_d = 0).
+     * The bits of tooth j are the contiguous range [d*j, d*j + d) of m,
+     * so slice them out limb-wide instead of one mbedtls_mpi_get_bit()
+     * call (with its divisions) per bit.
+     */
+    for( j = 0; j < w; j++ )
+    {
+        for( i = 0; i < d; i += take )
+        {
+            take = d - i > limb_bits ? limb_bits : d - i;
+            bits = mbedtls_mpi_get_bits( m, d * j + i, take );
+
+            for( k = 0; k < take; k++ )
+                x[i + k] |= (unsigned char)( ( bits >> k ) & 1 ) << j;
+        }
+    }
 
     /* Now make sure x_1 .. x_d are odd */
     c = 0;
@@ -1221,6 +1356,101 @@ cleanup:
     return( ret );
 }
 
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+/*
+ * Process-wide cache of comb tables for the base points of well-known
+ * groups, keyed by group id, so that short-lived groups for the same curve
+ * share one table instead of each computing and carrying its own.
+ *
+ * Entries are computed once under mbedtls_threading_ecp_mutex and then
+ * treated as read-only; they live until mbedtls_ecp_comb_cache_free().
+ */
+static struct
+{
+    mbedtls_ecp_point *T;
+    size_t T_size;
+}
+ecp_comb_cache[MBEDTLS_ECP_DP_MAX + 1];
+
+/*
+ * Get the shared comb table for grp's base point, computing and publishing
+ * it on first use. *Tc is left untouched if no table can be shared (unknown
+ * group, or a cached table built for a different window size).
+ */
+static int ecp_comb_cache_get( const mbedtls_ecp_group *grp,
+                               unsigned char w, size_t pre_len, size_t d,
+                               const mbedtls_ecp_point **Tc )
+{
+    int ret = 0;
+    mbedtls_ecp_point *T;
+    size_t i;
+
+    if( grp->id == MBEDTLS_ECP_DP_NONE || grp->id > MBEDTLS_ECP_DP_MAX )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &mbedtls_threading_ecp_mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    T = ecp_comb_cache[grp->id].T;
+    if( T != NULL )
+    {
+        /* A table built for another window size can't be used */
+        if( ecp_comb_cache[grp->id].T_size == pre_len )
+            *Tc = T;
+        goto cleanup;
+    }
+
+    if( ( T = mbedtls_calloc( pre_len, sizeof( mbedtls_ecp_point ) ) ) == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    if( ( ret = ecp_precompute_comb( grp, T, &grp->G, w, d ) ) != 0 )
+    {
+        for( i = 0; i < pre_len; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+        goto cleanup;
+    }
+
+    ecp_comb_cache[grp->id].T = T;
+    ecp_comb_cache[grp->id].T_size = pre_len;
+    *Tc = T;
+
+cleanup:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_ecp_mutex ) != 0 && ret == 0 )
+        ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+#endif
+
+    return( ret );
+}
+
+/*
+ * Free the shared comb table cache
+ */
+void mbedtls_ecp_comb_cache_free( void )
+{
+    size_t i, j;
+
+    for( i = 0; i <= MBEDTLS_ECP_DP_MAX; i++ )
+    {
+        if( ecp_comb_cache[i].T != NULL )
+        {
+            for( j = 0; j < ecp_comb_cache[i].T_size; j++ )
+                mbedtls_ecp_point_free( &ecp_comb_cache[i].T[j] );
+            mbedtls_free( ecp_comb_cache[i].T );
+        }
+
+        ecp_comb_cache[i].T = NULL;
+        ecp_comb_cache[i].T_size = 0;
+    }
+}
+#endif /* MBEDTLS_ECP_COMB_TABLE_CACHE */
+
 /*
  * Select precomputed point: R = sign(i) * T[ abs(i) / 2 ]
  */
@@ -1262,9 +1492,24 @@ static int ecp_mul_comb_core( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R
 {
     int ret;
     mbedtls_ecp_point Txi;
+    mbedtls_mpi_uint TxiXb[ECP_FE_LIMBS], TxiYb[ECP_FE_LIMBS];
     size_t i;
 
+    /*
+     * Only X and Y are ever set: Z is left unallocated, which
+     * ecp_add_mixed() interprets as Z == 1.
+     */
     mbedtls_ecp_point_init( &Txi );
+    ecp_fe_init( &Txi.X, TxiXb );
+    ecp_fe_init( &Txi.Y, TxiYb );
+
+    /* Warm the comb table: the constant-time select below reads every
+     * entry, and for a cached table the coordinate limbs are cold */
+    for( i = 0; i < t_len; i++ )
+    {
+        MBEDTLS_PREFETCH_R( T[i].X.p );
+        MBEDTLS_PREFETCH_R( T[i].Y.p );
+    }
 
     /* Start with a non-zero point and randomize its coordinates */
     i = d;
@@ -1281,7 +1526,8 @@ static int ecp_mul_comb_core( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R
     }
 
 cleanup:
-    mbedtls_ecp_point_free( &Txi );
+    ecp_fe_release( &Txi.X );
+    ecp_fe_release( &Txi.Y );
 
     return( ret );
 }
@@ -1300,6 +1546,7 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     size_t d;
     unsigned char k[COMB_MAX_D + 1];
     mbedtls_ecp_point *T;
+    const mbedtls_ecp_point *Tc;
     mbedtls_mpi M, mm;
 
     mbedtls_mpi_init( &M );
@@ -1344,12 +1591,24 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     d = ( grp->nbits + w - 1 ) / w;
 
     /*
-     * Prepare precomputed points: if P == G we want to
-     * use grp->T if already initialized, or initialize it.
+     * Prepare precomputed points: if P == G we want to use a compiled-in
+     * table if there is one, then grp->T if already initialized, and only
+     * initialize it as a last resort.
      */
     T = p_eq_g ? grp->T : NULL;
+    Tc = T;
+
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+    if( Tc == NULL && p_eq_g )
+        Tc = mbedtls_ecp_comb_table_lookup( grp->id, w );
+#endif
 
-    if( T == NULL )
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+    if( Tc == NULL && p_eq_g )
+        MBEDTLS_MPI_CHK( ecp_comb_cache_get( grp, w, pre_len, d, &Tc ) );
+#endif
+
+    if( Tc == NULL )
     {
         T = mbedtls_calloc( pre_len, sizeof( mbedtls_ecp_point ) );
         if( T == NULL )
@@ -1365,6 +1624,8 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
             grp->T = T;
             grp->T_size = pre_len;
         }
+
+        Tc = T;
     }
 
     /*
@@ -1380,7 +1641,7 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
      * Go for comb multiplication, R = M * P
      */
     ecp_comb_fixed( k, d, w, &M );
-    MBEDTLS_MPI_CHK( ecp_mul_comb_core( grp, R, T, pre_len, k, d, f_rng, p_rng ) );
+    MBEDTLS_MPI_CHK( ecp_mul_comb_core( grp, R, Tc, pre_len, k, d, f_rng, p_rng ) );
 
     /*
      * Now get m * P from M * P and normalize it
@@ -1495,10 +1756,13 @@ static int ecp_double_add_mxz( const mbedtls_ecp_group *grp,
 {
     int ret;
     mbedtls_mpi A, AA, B, BB, E, C, D, DA, CB;
+    mbedtls_mpi_uint Ab[ECP_FE_LIMBS], AAb[ECP_FE_LIMBS], Bb[ECP_FE_LIMBS];
+    mbedtls_mpi_uint BBb[ECP_FE_LIMBS], Eb[ECP_FE_LIMBS], Cb[ECP_FE_LIMBS];
+    mbedtls_mpi_uint Db[ECP_FE_LIMBS], DAb[ECP_FE_LIMBS], CBb[ECP_FE_LIMBS];
 
-    mbedtls_mpi_init( &A ); mbedtls_mpi_init( &AA ); mbedtls_mpi_init( &B );
-    mbedtls_mpi_init( &BB ); mbedtls_mpi_init( &E ); mbedtls_mpi_init( &C );
-    mbedtls_mpi_init( &D ); mbedtls_mpi_init( &DA ); mbedtls_mpi_init( &CB );
+    ecp_fe_init( &A, Ab ); ecp_fe_init( &AA, AAb ); ecp_fe_init( &B, Bb );
+    ecp_fe_init( &BB, BBb ); ecp_fe_init( &E, Eb ); ecp_fe_init( &C, Cb );
+    ecp_fe_init( &D, Db ); ecp_fe_init( &DA, DAb ); ecp_fe_init( &CB, CBb );
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &A,    &P->X,   &P->Z ) ); MOD_ADD( A    );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &AA,   &A,      &A    ) ); MOD_MUL( AA   );
@@ -1520,9 +1784,9 @@ static int ecp_double_add_mxz( const mbedtls_ecp_group *grp,
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &R->Z, &E,      &R->Z ) ); MOD_MUL( R->Z );
 
 cleanup:
-    mbedtls_mpi_free( &A ); mbedtls_mpi_free( &AA ); mbedtls_mpi_free( &B );
-    mbedtls_mpi_free( &BB ); mbedtls_mpi_free( &E ); mbedtls_mpi_free( &C );
-    mbedtls_mpi_free( &D ); mbedtls_mpi_free( &DA ); mbedtls_mpi_free( &CB );
+    ecp_fe_release( &A ); ecp_fe_release( &AA ); ecp_fe_release( &B );
+    ecp_fe_release( &BB ); ecp_fe_release( &E ); ecp_fe_release( &C );
+    ecp_fe_release( &D ); ecp_fe_release( &DA ); ecp_fe_release( &CB );
 
     return( ret );
 }
@@ -1541,12 +1805,22 @@ static int ecp_mul_mxz( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     unsigned char b;
     mbedtls_ecp_point RP;
     mbedtls_mpi PX;
+    mbedtls_mpi_uint RPXb[ECP_FE_LIMBS], RPZb[ECP_FE_LIMBS];
+    mbedtls_mpi_uint PXb[ECP_FE_LIMBS];
 
-    mbedtls_ecp_point_init( &RP ); mbedtls_mpi_init( &PX );
+    /*
+     * The ladder state is kept in stack-backed field elements so the
+     * per-step arithmetic below never touches the allocator (RP.Y is
+     * unused in x/z coordinates and stays unset).
+     */
+    mbedtls_ecp_point_init( &RP );
+    ecp_fe_init( &RP.X, RPXb ); ecp_fe_init( &RP.Z, RPZb );
+    ecp_fe_init( &PX, PXb );
 
     /* Save PX and read from P before writing to R, in case P == R */
     MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &PX, &P->X ) );
-    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &RP, P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &RP.X, &P->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &RP.Z, 1 ) ); /* P->Z == 1, checked by caller */
 
     /* Set R to zero in modified x/z coordinates */
     MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &R->X, 1 ) );
@@ -1582,7 +1856,9 @@ static int ecp_mul_mxz( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     MBEDTLS_MPI_CHK( ecp_normalize_mxz( grp, R ) );
 
 cleanup:
-    mbedtls_ecp_point_free( &RP ); mbedtls_mpi_free( &PX );
+    ecp_fe_release( &RP.X ); ecp_fe_release( &RP.Z );
+    ecp_fe_release( &PX );
+    mbedtls_ecp_point_free( &RP );
 
     return( ret );
 }
@@ -1597,6 +1873,9 @@ int mbedtls_ecp_mul( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
              int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
 {
     int ret;
+#if defined(MBEDTLS_TIMING_TRACE)
+    unsigned long trace_start = mbedtls_timing_hardclock();
+#endif
 
     /* Common sanity checks */
     if( mbedtls_mpi_cmp_int( &P->Z, 1 ) != 0 )
@@ -1608,15 +1887,417 @@ int mbedtls_ecp_mul( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 
 #if defined(ECP_MONTGOMERY)
     if( ecp_get_type( grp ) == ECP_TYPE_MONTGOMERY )
-        return( ecp_mul_mxz( grp, R, m, P, f_rng, p_rng ) );
+        ret = ecp_mul_mxz( grp, R, m, P, f_rng, p_rng );
+    else
 #endif
 #if defined(ECP_SHORTWEIERSTRASS)
     if( ecp_get_type( grp ) == ECP_TYPE_SHORT_WEIERSTRASS )
-        return( ecp_mul_comb( grp, R, m, P, f_rng, p_rng ) );
+        ret = ecp_mul_comb( grp, R, m, P, f_rng, p_rng );
+    else
 #endif
-    return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+        ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+
+#if defined(MBEDTLS_TIMING_TRACE)
+    mbedtls_timing_trace( MBEDTLS_TIMING_TRACE_ECP_MUL,
+                          mbedtls_timing_hardclock() - trace_start );
+#endif
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/*
+ * Maximum number of basic operations (in field multiplications) performed
+ * per call to a _restartable function, 0 = no limit
+ */
+static unsigned ecp_max_ops = 0;
+
+void mbedtls_ecp_set_max_ops( unsigned max_ops )
+{
+    ecp_max_ops = max_ops;
+}
+
+/* Approximate costs in field multiplications, see the comments on
+ * ecp_double_jac(), ecp_add_mixed() and ecp_normalize_jac() */
+#define ECP_OPS_DBL     8
+#define ECP_OPS_ADD     11
+#define ECP_OPS_INV     120
+
+/* Progress states for a sliced comb multiplication */
+enum
+{
+    ecp_rs_init = 0,    /* fresh context                                */
+    ecp_rs_pre_dbl,     /* computing 2^{id} P by repeated doubling      */
+    ecp_rs_pre_add,     /* computing the remaining table points         */
+    ecp_rs_core,        /* main comb loop                               */
+    ecp_rs_final        /* final inversion and normalization            */
+};
+
+/*
+ * Check the budget: past the limit, save everything (already in rs) and
+ * interrupt the current call. The first budgeted step of a call is always
+ * allowed, even if it alone exceeds the limit, so that progress is
+ * guaranteed and a small limit can't make the operation spin forever.
+ */
+#define ECP_BUDGET( cost )                          \
+    do {                                            \
+        if( ecp_max_ops != 0 && ops != 0 &&         \
+            ops + (unsigned)( cost ) > ecp_max_ops )\
+        {                                           \
+            ret = MBEDTLS_ERR_ECP_IN_PROGRESS;      \
+            goto cleanup;                           \
+        }                                           \
+        ops += (unsigned)( cost );                  \
+    } while( 0 )
+
+void mbedtls_ecp_restart_init( mbedtls_ecp_restart_ctx *rs )
+{
+    memset( rs, 0, sizeof( mbedtls_ecp_restart_ctx ) );
+
+    mbedtls_ecp_point_init( &rs->R );
+    mbedtls_ecp_point_init( &rs->mP );
+}
+
+/* Abort the multiplication in progress, keeping the muladd bookkeeping */
+static void ecp_restart_reset( mbedtls_ecp_restart_ctx *rs )
+{
+    unsigned char i;
+
+    if( rs->T != NULL )
+    {
+        for( i = 0; i < rs->pre_len; i++ )
+            mbedtls_ecp_point_free( &rs->T[i] );
+        mbedtls_free( rs->T );
+        rs->T = NULL;
+    }
+    rs->Tc = NULL;
+
+    mbedtls_ecp_point_free( &rs->R );
+    mbedtls_zeroize( rs->k, sizeof( rs->k ) );
+
+    rs->state = ecp_rs_init;
+}
+
+void mbedtls_ecp_restart_free( mbedtls_ecp_restart_ctx *rs )
+{
+    ecp_restart_reset( rs );
+    mbedtls_ecp_point_free( &rs->mP );
+    rs->phase = 0;
 }
 
+#if defined(ECP_SHORTWEIERSTRASS)
+/*
+ * Sliced version of ecp_mul_comb(): same algorithm, but progress is saved
+ * in rs and the function returns MBEDTLS_ERR_ECP_IN_PROGRESS whenever the
+ * operation budget for this call is exhausted.
+ *
+ * Unlike ecp_mul_comb(), a freshly computed table is never published in
+ * grp->T: the table is owned by the restart context.
+ */
+static int ecp_mul_comb_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                         const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                         int (*f_rng)(void *, unsigned char *, size_t),
+                         void *p_rng,
+                         mbedtls_ecp_restart_ctx *rs )
+{
+    int ret;
+    unsigned ops = 0;
+    unsigned char i, k;
+    size_t j;
+    mbedtls_ecp_point Txi;
+    mbedtls_ecp_point *TT[COMB_MAX_PRE - 1];
+    mbedtls_mpi_uint TxiXb[ECP_FE_LIMBS], TxiYb[ECP_FE_LIMBS];
+
+    mbedtls_ecp_point_init( &Txi );
+    ecp_fe_init( &Txi.X, TxiXb );
+    ecp_fe_init( &Txi.Y, TxiYb );
+
+    if( rs->state == ecp_rs_init )
+    {
+        unsigned char w, p_eq_g;
+        mbedtls_mpi M, mm;
+
+        mbedtls_mpi_init( &M );
+        mbedtls_mpi_init( &mm );
+
+        /* we need N to be odd to transform m into an odd number */
+        if( mbedtls_mpi_get_bit( &grp->N, 0 ) != 1 )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+            goto cleanup;
+        }
+
+        /* Window selection, as in ecp_mul_comb() */
+        w = grp->nbits >= 384 ? 5 : 4;
+
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+        p_eq_g = ( mbedtls_mpi_cmp_mpi( &P->Y, &grp->G.Y ) == 0 &&
+                   mbedtls_mpi_cmp_mpi( &P->X, &grp->G.X ) == 0 );
+        if( p_eq_g )
+            w++;
+#else
+        p_eq_g = 0;
+#endif
+        if( w > MBEDTLS_ECP_WINDOW_SIZE )
+            w = MBEDTLS_ECP_WINDOW_SIZE;
+        if( w >= grp->nbits )
+            w = 2;
+
+        rs->w = w;
+        rs->pre_len = 1U << ( w - 1 );
+        rs->d = ( grp->nbits + w - 1 ) / w;
+
+        /* Recode the scalar, using the parity trick to make it odd */
+        rs->m_is_odd = ( mbedtls_mpi_get_bit( m, 0 ) == 1 );
+        ret = mbedtls_mpi_copy( &M, m );
+        if( ret == 0 )
+            ret = mbedtls_mpi_sub_mpi( &mm, &grp->N, m );
+        if( ret == 0 )
+            ret = mbedtls_mpi_safe_cond_assign( &M, &mm, ! rs->m_is_odd );
+        if( ret == 0 )
+            ecp_comb_fixed( rs->k, rs->d, w, &M );
+
+        mbedtls_mpi_free( &M );
+        mbedtls_mpi_free( &mm );
+        if( ret != 0 )
+            goto cleanup;
+
+        /* Use a shared table for the base point if one is available */
+        rs->Tc = p_eq_g ? grp->T : NULL;
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+        if( rs->Tc == NULL && p_eq_g )
+            rs->Tc = mbedtls_ecp_comb_table_lookup( grp->id, w );
+#endif
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+        if( rs->Tc == NULL && p_eq_g )
+            MBEDTLS_MPI_CHK( ecp_comb_cache_get( grp, w, rs->pre_len, rs->d,
+                                                 &rs->Tc ) );
+#endif
+
+        if( rs->Tc != NULL )
+        {
+            rs->state = ecp_rs_core;
+            rs->i = rs->d + 1;
+        }
+        else
+        {
+            rs->T = mbedtls_calloc( rs->pre_len, sizeof( mbedtls_ecp_point ) );
+            if( rs->T == NULL )
+            {
+                ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+                goto cleanup;
+            }
+
+            MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &rs->T[0], P ) );
+
+            rs->state = ecp_rs_pre_dbl;
+            rs->i = 1;
+            rs->j = 0;
+        }
+    }
+
+    /*
+     * Precomputation, first phase:
+     * T[2^{l-1}] = 2^{dl} P for l = 1 .. w-1, as in ecp_precompute_comb()
+     */
+    if( rs->state == ecp_rs_pre_dbl )
+    {
+        while( rs->i < (size_t)( 1U << ( rs->w - 1 ) ) )
+        {
+            if( rs->j == 0 )
+                MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &rs->T[rs->i],
+                                                   &rs->T[rs->i >> 1] ) );
+
+            while( rs->j < rs->d )
+            {
+                ECP_BUDGET( ECP_OPS_DBL );
+                MBEDTLS_MPI_CHK( ecp_double_jac( grp, &rs->T[rs->i],
+                                                 &rs->T[rs->i] ) );
+                rs->j++;
+            }
+
+            rs->i <<= 1;
+            rs->j = 0;
+        }
+
+        ECP_BUDGET( ECP_OPS_INV + 6 * ( rs->w - 1 ) );
+        k = 0;
+        for( i = 1; i < rs->pre_len; i <<= 1 )
+            TT[k++] = &rs->T[i];
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, k ) );
+
+        rs->state = ecp_rs_pre_add;
+        rs->i = 1;
+        rs->j = 1;
+    }
+
+    /*
+     * Precomputation, second phase: the remaining points by addition.
+     * As in ecp_precompute_comb(), T[2^l] must be updated last (j = 0).
+     */
+    if( rs->state == ecp_rs_pre_add )
+    {
+        while( rs->i < (size_t)( 1U << ( rs->w - 1 ) ) )
+        {
+            while( rs->j > 0 )
+            {
+                ECP_BUDGET( ECP_OPS_ADD );
+                rs->j--;
+                MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &rs->T[rs->i + rs->j],
+                                                &rs->T[rs->j], &rs->T[rs->i] ) );
+            }
+
+            rs->i <<= 1;
+            rs->j = rs->i;
+        }
+
+        ECP_BUDGET( ECP_OPS_INV + 6 * rs->pre_len );
+        k = 0;
+        for( i = 1; i < rs->pre_len; i <<= 1 )
+            for( j = i; j < 2U * i && j < rs->pre_len; j++ )
+                TT[k++] = &rs->T[j];
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, k ) );
+
+        rs->Tc = rs->T;
+        rs->state = ecp_rs_core;
+        rs->i = rs->d + 1;
+    }
+
+    /*
+     * Main comb loop, as in ecp_mul_comb_core()
+     */
+    if( rs->state == ecp_rs_core )
+    {
+        if( rs->i == rs->d + 1 )
+        {
+            ECP_BUDGET( ECP_OPS_DBL );
+            MBEDTLS_MPI_CHK( ecp_select_comb( grp, &rs->R, rs->Tc, rs->pre_len,
+                                              rs->k[rs->d] ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &rs->R.Z, 1 ) );
+            if( f_rng != 0 )
+                MBEDTLS_MPI_CHK( ecp_randomize_jac( grp, &rs->R, f_rng, p_rng ) );
+            rs->i = rs->d;
+        }
+
+        while( rs->i > 0 )
+        {
+            ECP_BUDGET( ECP_OPS_DBL + ECP_OPS_ADD );
+            rs->i--;
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, &rs->R, &rs->R ) );
+            MBEDTLS_MPI_CHK( ecp_select_comb( grp, &Txi, rs->Tc, rs->pre_len,
+                                              rs->k[rs->i] ) );
+            MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &rs->R, &rs->R, &Txi ) );
+        }
+
+        rs->state = ecp_rs_final;
+    }
+
+    /*
+     * Undo the parity trick and normalize
+     */
+    ECP_BUDGET( ECP_OPS_INV + 4 );
+    MBEDTLS_MPI_CHK( ecp_safe_invert_jac( grp, &rs->R, ! rs->m_is_odd ) );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, &rs->R ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( R, &rs->R ) );
+
+cleanup:
+    ecp_fe_release( &Txi.X );
+    ecp_fe_release( &Txi.Y );
+
+    /* Keep the saved state only while in progress */
+    if( ret != MBEDTLS_ERR_ECP_IN_PROGRESS )
+        ecp_restart_reset( rs );
+
+    return( ret );
+}
+#endif /* ECP_SHORTWEIERSTRASS */
+
+/*
+ * Restartable multiplication R = m * P
+ */
+int mbedtls_ecp_mul_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+             mbedtls_ecp_restart_ctx *rs )
+{
+#if defined(ECP_SHORTWEIERSTRASS)
+    if( rs != NULL && ecp_max_ops != 0 &&
+        ecp_get_type( grp ) == ECP_TYPE_SHORT_WEIERSTRASS )
+    {
+        int ret;
+
+        /* Input checks only on the first call: once a multiplication is in
+         * progress the inputs have been checked (and must not change) */
+        if( rs->state == ecp_rs_init )
+        {
+            if( mbedtls_mpi_cmp_int( &P->Z, 1 ) != 0 )
+                return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+            if( ( ret = mbedtls_ecp_check_privkey( grp, m ) ) != 0 ||
+                ( ret = mbedtls_ecp_check_pubkey( grp, P ) ) != 0 )
+                return( ret );
+        }
+
+        return( ecp_mul_comb_restartable( grp, R, m, P, f_rng, p_rng, rs ) );
+    }
+#else
+    ((void) rs);
+#endif
+
+    /* No slicing possible or requested: one-shot */
+    return( mbedtls_ecp_mul( grp, R, m, P, f_rng, p_rng ) );
+}
+
+/*
+ * Restartable linear combination R = m * P + n * Q: the two multiplications
+ * are sliced one after the other, rs->mP holding the first result
+ */
+int mbedtls_ecp_muladd_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
+             mbedtls_ecp_restart_ctx *rs )
+{
+#if defined(ECP_SHORTWEIERSTRASS)
+    if( rs != NULL && ecp_max_ops != 0 &&
+        ecp_get_type( grp ) == ECP_TYPE_SHORT_WEIERSTRASS )
+    {
+        int ret;
+
+        if( rs->phase == 0 )
+        {
+            ret = mbedtls_ecp_mul_restartable( grp, &rs->mP, m, P,
+                                               NULL, NULL, rs );
+            if( ret != 0 )
+                return( ret );
+
+            rs->phase = 1;
+        }
+
+        ret = mbedtls_ecp_mul_restartable( grp, R, n, Q, NULL, NULL, rs );
+        if( ret == MBEDTLS_ERR_ECP_IN_PROGRESS )
+            return( ret );
+        if( ret != 0 )
+            goto cleanup;
+
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, &rs->mP, R ) );
+        MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, R ) );
+
+cleanup:
+        rs->phase = 0;
+        mbedtls_ecp_point_free( &rs->mP );
+
+        return( ret );
+    }
+#else
+    ((void) rs);
+#endif
+
+    return( mbedtls_ecp_muladd( grp, R, m, P, n, Q ) );
+}
+
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 #if defined(ECP_SHORTWEIERSTRASS)
 /*
  * Check that an affine point is valid as a public key,
@@ -1693,6 +2374,345 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Normalize a batch of points at once, sharing one inversion
+ */
+int mbedtls_ecp_normalize_many( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point *T[], size_t t_len )
+{
+    int ret = 0;
+    size_t i, nz_len;
+    mbedtls_ecp_point **nz;
+
+    if( ecp_get_type( grp ) != ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( t_len == 0 )
+        return( 0 );
+
+    if( ( nz = mbedtls_calloc( t_len, sizeof( mbedtls_ecp_point * ) ) ) == NULL )
+        return( MBEDTLS_ERR_ECP_ALLOC_FAILED );
+
+    /* Points at infinity (Z == 0) are left untouched, as with
+     * ecp_normalize_jac() */
+    nz_len = 0;
+    for( i = 0; i < t_len; i++ )
+        if( mbedtls_mpi_cmp_int( &T[i]->Z, 0 ) != 0 )
+            nz[nz_len++] = T[i];
+
+    if( nz_len > 0 )
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, nz, nz_len ) );
+
+    /*
+     * The helper strips Z to save RAM in the comb tables; restore Z = 1 so
+     * the points remain valid on their own.
+     */
+    for( i = 0; i < nz_len; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &nz[i]->Z, 1 ) );
+
+cleanup:
+    mbedtls_free( nz );
+
+    return( ret );
+}
+
+/*
+ * Batch of linear combinations, with a shared final inversion
+ */
+int mbedtls_ecp_muladd_many( mbedtls_ecp_group *grp, mbedtls_ecp_point *R[],
+             const mbedtls_mpi *m[], const mbedtls_ecp_point *P[],
+             const mbedtls_mpi *n[], const mbedtls_ecp_point *Q[],
+             size_t len )
+{
+    int ret;
+    size_t i;
+    mbedtls_ecp_point mP;
+
+    if( ecp_get_type( grp ) != ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( len == 0 )
+        return( 0 );
+
+    mbedtls_ecp_point_init( &mP );
+
+    for( i = 0; i < len; i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_mul( grp, &mP,  m[i], P[i], NULL, NULL ) );
+        MBEDTLS_MPI_CHK( mbedtls_ecp_mul( grp, R[i], n[i], Q[i], NULL, NULL ) );
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R[i], &mP, R[i] ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_normalize_many( grp, R, len ) );
+
+cleanup:
+    mbedtls_ecp_point_free( &mP );
+
+    return( ret );
+}
+
+/*
+ * Window size for the variable-time wNAF multiplication, and the resulting
+ * number of precomputed odd multiples 1 P, 3 P, ..., (2^{w-1} - 1) P
+ */
+#define ECP_WNAF_WIDTH( grp )   ( (grp)->nbits >= 384 ? 5 : 4 )
+#define ECP_WNAF_TABLE_MAX      ( 1U << ( 5 - 2 ) )
+
+/* A wNAF recoding has at most nbits + 1 digits */
+#define ECP_WNAF_MAX_LEN        ( MBEDTLS_ECP_MAX_BITS + 1 )
+
+/*
+ * Recode a scalar in width-w non-adjacent form: naf[i] is odd with
+ * |naf[i]| < 2^{w-1}, or 0, and m = sum naf[i] 2^i. Variable time!
+ */
+static int ecp_wnaf_recode( signed char naf[], size_t *naf_len,
+                            const mbedtls_mpi *m, unsigned char w )
+{
+    int ret = 0;
+    int u;
+    size_t i = 0, j;
+    mbedtls_mpi k;
+
+    mbedtls_mpi_init( &k );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &k, m ) );
+
+    while( mbedtls_mpi_cmp_int( &k, 0 ) > 0 )
+    {
+        if( i >= ECP_WNAF_MAX_LEN )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+            goto cleanup;
+        }
+
+        if( mbedtls_mpi_get_bit( &k, 0 ) == 1 )
+        {
+            u = 0;
+            for( j = 0; j < w; j++ )
+                u |= mbedtls_mpi_get_bit( &k, j ) << j;
+
+            if( u >= 1 << ( w - 1 ) )
+                u -= 1 << w;
+
+            if( u > 0 )
+                MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &k, &k, u ) );
+            else
+                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &k, &k, -u ) );
+        }
+        else
+            u = 0;
+
+        naf[i++] = (signed char) u;
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &k, 1 ) );
+    }
+
+    *naf_len = i;
+
+cleanup:
+    mbedtls_mpi_free( &k );
+
+    return( ret );
+}
+
+/*
+ * Precompute the odd multiples T[i] = (2 i + 1) P used by the wNAF loop.
+ * As in the comb tables, Z may be left unset, meaning 1.
+ */
+static int ecp_precompute_wnaf( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point T[], size_t t_len,
+                                const mbedtls_ecp_point *P )
+{
+    int ret;
+    size_t i;
+    mbedtls_ecp_point D;
+    mbedtls_ecp_point *TT[ECP_WNAF_TABLE_MAX];
+
+    mbedtls_ecp_point_init( &D );
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[0], P ) );
+
+    MBEDTLS_MPI_CHK( ecp_double_jac( grp, &D, P ) );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, &D ) );
+
+    for( i = 1; i < t_len; i++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &T[i], &T[i - 1], &D ) );
+        TT[i - 1] = &T[i];
+    }
+
+    if( t_len > 1 )
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, t_len - 1 ) );
+
+cleanup:
+    mbedtls_ecp_point_free( &D );
+
+    return( ret );
+}
+
+/*
+ * Interleaved double-and-add over one or two wNAF recodings, sharing the
+ * doublings. The second stream (naf2, T2) may be NULL. Variable time!
+ */
+static int ecp_mul_wnaf_core( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                              const signed char naf1[], size_t len1,
+                              const mbedtls_ecp_point T1[],
+                              const signed char naf2[], size_t len2,
+                              const mbedtls_ecp_point T2[] )
+{
+    int ret;
+    int started = 0, d;
+    size_t i, s;
+    mbedtls_ecp_point mQ;
+    const mbedtls_ecp_point *Qp;
+    mbedtls_mpi_uint mQXb[ECP_FE_LIMBS], mQYb[ECP_FE_LIMBS];
+
+    mbedtls_ecp_point_init( &mQ );
+    ecp_fe_init( &mQ.X, mQXb );
+    ecp_fe_init( &mQ.Y, mQYb );
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_set_zero( R ) );
+
+    i = len1 > len2 ? len1 : len2;
+    while( i-- > 0 )
+    {
+        if( started )
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R ) );
+
+        for( s = 0; s < 2; s++ )
+        {
+            const signed char *naf = s == 0 ? naf1 : naf2;
+            const mbedtls_ecp_point *T = s == 0 ? T1 : T2;
+            size_t len = s == 0 ? len1 : len2;
+
+            if( T == NULL || i >= len || ( d = naf[i] ) == 0 )
+                continue;
+
+            if( d > 0 )
+                Qp = &T[d >> 1];
+            else
+            {
+                /* -Q = (X, P - Y) for affine Q */
+                MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &mQ.X, &T[-d >> 1].X ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &mQ.Y, &grp->P,
+                                                      &T[-d >> 1].Y ) );
+                Qp = &mQ;
+            }
+
+            if( ! started )
+            {
+                MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &Qp->X ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, &Qp->Y ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &R->Z, 1 ) );
+                started = 1;
+            }
+            else
+                MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R, Qp ) );
+        }
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, R ) );
+
+cleanup:
+    ecp_fe_release( &mQ.X );
+    ecp_fe_release( &mQ.Y );
+    mbedtls_ecp_point_free( &mQ );
+
+    return( ret );
+}
+
+/*
+ * Variable-time multiplication R = m P, for public inputs only
+ */
+int mbedtls_ecp_mul_vartime( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P )
+{
+    int ret;
+    unsigned char w;
+    size_t i, t_len, naf_len;
+    signed char naf[ECP_WNAF_MAX_LEN];
+    mbedtls_ecp_point T[ECP_WNAF_TABLE_MAX];
+
+    if( ecp_get_type( grp ) != ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( ( ret = mbedtls_ecp_check_pubkey( grp, P ) ) != 0 )
+        return( ret );
+
+    if( mbedtls_mpi_cmp_int( m, 0 ) < 0 ||
+        mbedtls_mpi_cmp_mpi( m, &grp->N ) >= 0 )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    for( i = 0; i < ECP_WNAF_TABLE_MAX; i++ )
+        mbedtls_ecp_point_init( &T[i] );
+
+    w = ECP_WNAF_WIDTH( grp );
+    t_len = 1U << ( w - 2 );
+
+    MBEDTLS_MPI_CHK( ecp_wnaf_recode( naf, &naf_len, m, w ) );
+    MBEDTLS_MPI_CHK( ecp_precompute_wnaf( grp, T, t_len, P ) );
+    MBEDTLS_MPI_CHK( ecp_mul_wnaf_core( grp, R, naf, naf_len, T,
+                                        NULL, 0, NULL ) );
+
+cleanup:
+    for( i = 0; i < ECP_WNAF_TABLE_MAX; i++ )
+        mbedtls_ecp_point_free( &T[i] );
+
+    return( ret );
+}
+
+/*
+ * Variable-time linear combination R = m P + n Q with interleaved wNAF,
+ * sharing the doublings between the two scalars. For public inputs only.
+ */
+int mbedtls_ecp_muladd_vartime( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+             const mbedtls_mpi *n, const mbedtls_ecp_point *Q )
+{
+    int ret;
+    unsigned char w;
+    size_t i, t_len, naf_len1, naf_len2;
+    signed char naf1[ECP_WNAF_MAX_LEN], naf2[ECP_WNAF_MAX_LEN];
+    mbedtls_ecp_point T1[ECP_WNAF_TABLE_MAX], T2[ECP_WNAF_TABLE_MAX];
+
+    if( ecp_get_type( grp ) != ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    if( ( ret = mbedtls_ecp_check_pubkey( grp, P ) ) != 0 ||
+        ( ret = mbedtls_ecp_check_pubkey( grp, Q ) ) != 0 )
+        return( ret );
+
+    if( mbedtls_mpi_cmp_int( m, 0 ) < 0 ||
+        mbedtls_mpi_cmp_mpi( m, &grp->N ) >= 0 ||
+        mbedtls_mpi_cmp_int( n, 0 ) < 0 ||
+        mbedtls_mpi_cmp_mpi( n, &grp->N ) >= 0 )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    for( i = 0; i < ECP_WNAF_TABLE_MAX; i++ )
+    {
+        mbedtls_ecp_point_init( &T1[i] );
+        mbedtls_ecp_point_init( &T2[i] );
+    }
+
+    w = ECP_WNAF_WIDTH( grp );
+    t_len = 1U << ( w - 2 );
+
+    MBEDTLS_MPI_CHK( ecp_wnaf_recode( naf1, &naf_len1, m, w ) );
+    MBEDTLS_MPI_CHK( ecp_wnaf_recode( naf2, &naf_len2, n, w ) );
+    MBEDTLS_MPI_CHK( ecp_precompute_wnaf( grp, T1, t_len, P ) );
+    MBEDTLS_MPI_CHK( ecp_precompute_wnaf( grp, T2, t_len, Q ) );
+    MBEDTLS_MPI_CHK( ecp_mul_wnaf_core( grp, R, naf1, naf_len1, T1,
+                                        naf2, naf_len2, T2 ) );
+
+cleanup:
+    for( i = 0; i < ECP_WNAF_TABLE_MAX; i++ )
+    {
+        mbedtls_ecp_point_free( &T1[i] );
+        mbedtls_ecp_point_free( &T2[i] );
+    }
+
+    return( ret );
+}
+
 
 #if defined(ECP_MONTGOMERY)
 /*
@@ -1839,6 +2859,57 @@ cleanup:
     return( mbedtls_ecp_mul( grp, Q, d, &grp->G, f_rng, p_rng ) );
 }
 
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+/*
+ * Restartable version of mbedtls_ecp_gen_keypair(): the secret scalar is
+ * generated on the first call only (cheap), the public key computation is
+ * then sliced like any other multiplication.
+ */
+int mbedtls_ecp_gen_keypair_restartable( mbedtls_ecp_group *grp,
+                     mbedtls_mpi *d, mbedtls_ecp_point *Q,
+                     int (*f_rng)(void *, unsigned char *, size_t),
+                     void *p_rng,
+                     mbedtls_ecp_restart_ctx *rs )
+{
+    if( rs == NULL || ecp_max_ops == 0 )
+        return( mbedtls_ecp_gen_keypair( grp, d, Q, f_rng, p_rng ) );
+
+#if defined(ECP_SHORTWEIERSTRASS)
+    if( ecp_get_type( grp ) == ECP_TYPE_SHORT_WEIERSTRASS )
+    {
+        int ret;
+        int count = 0;
+        size_t n_size = ( grp->nbits + 7 ) / 8;
+        unsigned char rnd[MBEDTLS_ECP_MAX_BYTES];
+
+        /* d was already generated if a multiplication is in progress */
+        if( rs->state == ecp_rs_init )
+        {
+            /* Same procedure as in mbedtls_ecp_gen_keypair() */
+            do
+            {
+                MBEDTLS_MPI_CHK( f_rng( p_rng, rnd, n_size ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( d, rnd, n_size ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( d, 8 * n_size - grp->nbits ) );
+
+                if( ++count > 30 )
+                    return( MBEDTLS_ERR_ECP_RANDOM_FAILED );
+            }
+            while( mbedtls_mpi_cmp_int( d, 1 ) < 0 ||
+                   mbedtls_mpi_cmp_mpi( d, &grp->N ) >= 0 );
+        }
+
+        return( mbedtls_ecp_mul_restartable( grp, Q, d, &grp->G,
+                                             f_rng, p_rng, rs ) );
+cleanup:
+        return( ret );
+    }
+#endif /* ECP_SHORTWEIERSTRASS */
+
+    return( mbedtls_ecp_gen_keypair( grp, d, Q, f_rng, p_rng ) );
+}
+#endif /* MBEDTLS_ECP_RESTARTABLE */
+
 /*
  * Generate a keypair, prettier wrapper
  */
@@ -50,10 +50,7 @@
 #include "mbedtls/havege.h"
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 #define ENTROPY_MAX_LOOP    256     /**< Maximum amount to loop before error */
 
@@ -90,6 +87,14 @@ void mbedtls_entropy_init( mbedtls_entropy_context *ctx )
                                 MBEDTLS_ENTROPY_MIN_HAVEGE,
                                 MBEDTLS_ENTROPY_SOURCE_STRONG );
 #endif
+#if defined(MBEDTLS_ENTROPY_RDSEED)
+    /* Only register when the CPU has the instructions, or the source
+     * could never meet its threshold and gathering would fail */
+    if( mbedtls_rdseed_has_support() )
+        mbedtls_entropy_add_source( ctx, mbedtls_rdseed_poll, NULL,
+                                    MBEDTLS_ENTROPY_MIN_RDSEED,
+                                    MBEDTLS_ENTROPY_SOURCE_STRONG );
+#endif
 #if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
     mbedtls_entropy_add_source( ctx, mbedtls_hardware_poll, NULL,
                                 MBEDTLS_ENTROPY_MIN_HARDWARE,
@@ -144,12 +149,13 @@ exit:
 }
 
 /*
- * Entropy accumulator update
+ * Encode a source input for the accumulator: 2-byte header followed by
+ * the data itself, reduced to one hash block if longer. Returns the
+ * number of bytes written to dst (at most 2 + MBEDTLS_ENTROPY_BLOCK_SIZE).
  */
-static int entropy_update( mbedtls_entropy_context *ctx, unsigned char source_id,
-                           const unsigned char *data, size_t len )
+static size_t entropy_stage( unsigned char *dst, unsigned char source_id,
+                             const unsigned char *data, size_t len )
 {
-    unsigned char header[2];
     unsigned char tmp[MBEDTLS_ENTROPY_BLOCK_SIZE];
     size_t use_len = len;
     const unsigned char *p = data;
@@ -165,15 +171,28 @@ static int entropy_update( mbedtls_entropy_context *ctx, unsigned char source_id
         use_len = MBEDTLS_ENTROPY_BLOCK_SIZE;
     }
 
-    header[0] = source_id;
-    header[1] = use_len & 0xFF;
+    dst[0] = source_id;
+    dst[1] = use_len & 0xFF;
+    memcpy( dst + 2, p, use_len );
+
+    return( 2 + use_len );
+}
+
+/*
+ * Entropy accumulator update
+ */
+static int entropy_update( mbedtls_entropy_context *ctx, unsigned char source_id,
+                           const unsigned char *data, size_t len )
+{
+    unsigned char block[2 + MBEDTLS_ENTROPY_BLOCK_SIZE];
+    size_t block_len;
+
+    block_len = entropy_stage( block, source_id, data, len );
 
 #if defined(MBEDTLS_ENTROPY_SHA512_ACCUMULATOR)
-    mbedtls_sha512_update( &ctx->accumulator, header, 2 );
-    mbedtls_sha512_update( &ctx->accumulator, p, use_len );
+    mbedtls_sha512_update( &ctx->accumulator, block, block_len );
 #else
-    mbedtls_sha256_update( &ctx->accumulator, header, 2 );
-    mbedtls_sha256_update( &ctx->accumulator, p, use_len );
+    mbedtls_sha256_update( &ctx->accumulator, block, block_len );
 #endif
 
     return( 0 );
@@ -204,15 +223,18 @@ int mbedtls_entropy_update_manual( mbedtls_entropy_context *ctx,
  */
 static int entropy_gather_internal( mbedtls_entropy_context *ctx )
 {
-    int ret, i, have_one_strong = 0;
+    int ret = 0, i, have_one_strong = 0;
     unsigned char buf[MBEDTLS_ENTROPY_MAX_GATHER];
-    size_t olen;
+    unsigned char acc[MBEDTLS_ENTROPY_MAX_SOURCES *
+                      ( 2 + MBEDTLS_ENTROPY_BLOCK_SIZE )];
+    size_t olen, acc_len = 0;
 
     if( ctx->source_count == 0 )
         return( MBEDTLS_ERR_ENTROPY_NO_SOURCES_DEFINED );
 
     /*
-     * Run through our entropy sources
+     * Run through our entropy sources, staging everything gathered so the
+     * accumulator is updated once per pass instead of once per source
      */
     for( i = 0; i < ctx->source_count; i++ )
     {
@@ -223,7 +245,7 @@ static int entropy_gather_internal( mbedtls_entropy_context *ctx )
         if( ( ret = ctx->source[i].f_source( ctx->source[i].p_source,
                         buf, MBEDTLS_ENTROPY_MAX_GATHER, &olen ) ) != 0 )
         {
-            return( ret );
+            break;
         }
 
         /*
@@ -231,11 +253,25 @@ static int entropy_gather_internal( mbedtls_entropy_context *ctx )
          */
         if( olen > 0 )
         {
-            entropy_update( ctx, (unsigned char) i, buf, olen );
+            acc_len += entropy_stage( acc + acc_len, (unsigned char) i,
+                                      buf, olen );
             ctx->source[i].size += olen;
         }
     }
 
+    if( acc_len > 0 )
+    {
+#if defined(MBEDTLS_ENTROPY_SHA512_ACCUMULATOR)
+        mbedtls_sha512_update( &ctx->accumulator, acc, acc_len );
+#else
+        mbedtls_sha256_update( &ctx->accumulator, acc, acc_len );
+#endif
+        mbedtls_zeroize( acc, acc_len );
+    }
+
+    if( ret != 0 )
+        return( ret );
+
     if( have_one_strong == 0 )
         return( MBEDTLS_ERR_ENTROPY_NO_STRONG_SOURCE );
 
@@ -264,19 +300,13 @@ int mbedtls_entropy_gather( mbedtls_entropy_context *ctx )
     return( ret );
 }
 
-int mbedtls_entropy_func( void *data, unsigned char *output, size_t len )
+/*
+ * Gather until all thresholds are met and extract one block from the
+ * accumulator; the caller must hold ctx->mutex
+ */
+static int entropy_extract( mbedtls_entropy_context *ctx, unsigned char *buf )
 {
     int ret, count = 0, i, done;
-    mbedtls_entropy_context *ctx = (mbedtls_entropy_context *) data;
-    unsigned char buf[MBEDTLS_ENTROPY_BLOCK_SIZE];
-
-    if( len > MBEDTLS_ENTROPY_BLOCK_SIZE )
-        return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
-
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
-        return( ret );
-#endif
 
     /*
      * Always gather extra entropy before a call
@@ -284,13 +314,10 @@ int mbedtls_entropy_func( void *data, unsigned char *output, size_t len )
     do
     {
         if( count++ > ENTROPY_MAX_LOOP )
-        {
-            ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
-            goto exit;
-        }
+            return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
 
         if( ( ret = entropy_gather_internal( ctx ) ) != 0 )
-            goto exit;
+            return( ret );
 
         done = 1;
         for( i = 0; i < ctx->source_count; i++ )
@@ -334,11 +361,67 @@ int mbedtls_entropy_func( void *data, unsigned char *output, size_t len )
     for( i = 0; i < ctx->source_count; i++ )
         ctx->source[i].size = 0;
 
-    memcpy( output, buf, len );
+    return( 0 );
+}
+
+int mbedtls_entropy_func( void *data, unsigned char *output, size_t len )
+{
+    int ret;
+    mbedtls_entropy_context *ctx = (mbedtls_entropy_context *) data;
+    unsigned char buf[MBEDTLS_ENTROPY_BLOCK_SIZE];
 
-    ret = 0;
+    if( len > MBEDTLS_ENTROPY_BLOCK_SIZE )
+        return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+    /*
+     * Serve the request from the pre-gathered pool when possible, so that
+     * callers (typically DRBG reseeds) do not stall on a full source poll
+     */
+    if( ctx->pool_count > 0 )
+    {
+        ctx->pool_count--;
+        memcpy( buf, ctx->pool[ctx->pool_count], MBEDTLS_ENTROPY_BLOCK_SIZE );
+        mbedtls_zeroize( ctx->pool[ctx->pool_count],
+                         MBEDTLS_ENTROPY_BLOCK_SIZE );
+        ret = 0;
+    }
+    else
+#endif
+    ret = entropy_extract( ctx, buf );
+
+    if( ret == 0 )
+        memcpy( output, buf, len );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+int mbedtls_entropy_prefetch( mbedtls_entropy_context *ctx )
+{
+    int ret = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( ctx->pool_count < MBEDTLS_ENTROPY_PREFETCH_BLOCKS )
+    {
+        if( ( ret = entropy_extract( ctx, ctx->pool[ctx->pool_count] ) ) == 0 )
+            ctx->pool_count++;
+    }
 
-exit:
 #if defined(MBEDTLS_THREADING_C)
     if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
         return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
@@ -346,6 +429,7 @@ exit:
 
     return( ret );
 }
+#endif /* MBEDTLS_ENTROPY_PREFETCH */
 
 #if defined(MBEDTLS_FS_IO)
 int mbedtls_entropy_write_seed_file( mbedtls_entropy_context *ctx, const char *path )
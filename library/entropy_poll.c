@@ -198,6 +198,173 @@ int mbedtls_hardclock_poll( void *data,
 }
 #endif /* MBEDTLS_TIMING_C */
 
+#if defined(MBEDTLS_ENTROPY_RDSEED)
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <string.h>
+
+#ifndef asm
+#define asm __asm
+#endif
+
+#define RDSEED_SUPPORT_RDSEED   1
+#define RDSEED_SUPPORT_RDRAND   2
+
+/* Retries per 64-bit word before giving up on the instruction, with a
+ * pause between attempts, as the Intel DRNG guide suggests. RDSEED can
+ * legitimately run dry under load; RDRAND practically cannot. */
+#define RDSEED_RETRIES          10
+
+/*
+ * Like the AES-NI code, emit the opcodes directly so that old assemblers
+ * do not need to know the mnemonics: RDSEED/RDRAND with a 64-bit register
+ * destination (%rax here).
+ */
+#define RDSEED_RAX  ".byte 0x48,0x0F,0xC7,0xF8"
+#define RDRAND_RAX  ".byte 0x48,0x0F,0xC7,0xF0"
+
+static int rdseed_support( void )
+{
+    static int done = 0;
+    static int support = 0;
+
+    if( ! done )
+    {
+        unsigned int max_leaf, ebx7 = 0, ecx1 = 0;
+
+        asm( "movl  $0, %%eax   \n\t"
+             "cpuid             \n\t"
+             : "=a" (max_leaf)
+             :
+             : "ebx", "ecx", "edx" );
+
+        if( max_leaf >= 7 )
+        {
+            asm( "movl  $7, %%eax   \n\t"
+                 "movl  $0, %%ecx   \n\t"
+                 "cpuid             \n\t"
+                 : "=b" (ebx7)
+                 :
+                 : "eax", "ecx", "edx" );
+        }
+
+        asm( "movl  $1, %%eax   \n\t"
+             "cpuid             \n\t"
+             : "=c" (ecx1)
+             :
+             : "eax", "ebx", "edx" );
+
+        if( ebx7 & ( 1u << 18 ) )
+            support |= RDSEED_SUPPORT_RDSEED;
+        if( ecx1 & ( 1u << 30 ) )
+            support |= RDSEED_SUPPORT_RDRAND;
+
+        done = 1;
+    }
+
+    return( support );
+}
+
+int mbedtls_rdseed_has_support( void )
+{
+    return( rdseed_support() != 0 );
+}
+
+/* Fetch one 64-bit word; the carry flag signals whether the DRNG had
+ * fresh output available */
+static int rdseed_word( uint64_t *v, int instruction )
+{
+    unsigned char ok;
+    int i;
+
+    for( i = 0; i < RDSEED_RETRIES; i++ )
+    {
+        if( instruction == RDSEED_SUPPORT_RDSEED )
+            asm volatile( RDSEED_RAX "\n\t"
+                          "setc  %1"
+                          : "=a" (*v), "=q" (ok) );
+        else
+            asm volatile( RDRAND_RAX "\n\t"
+                          "setc  %1"
+                          : "=a" (*v), "=q" (ok) );
+
+        if( ok )
+            return( 0 );
+
+        asm volatile( "pause" );
+    }
+
+    return( -1 );
+}
+
+int mbedtls_rdseed_poll( void *data,
+                         unsigned char *output, size_t len, size_t *olen )
+{
+    uint64_t v;
+    size_t use_len;
+    int support = rdseed_support();
+    int instruction;
+    ((void) data);
+
+    *olen = 0;
+
+    if( support == 0 )
+        return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
+
+    instruction = ( support & RDSEED_SUPPORT_RDSEED ) ?
+                  RDSEED_SUPPORT_RDSEED : RDSEED_SUPPORT_RDRAND;
+
+    while( *olen < len )
+    {
+        if( rdseed_word( &v, instruction ) != 0 )
+        {
+            /* RDSEED ran dry: fall back to RDRAND for the rest of this
+             * batch rather than returning short */
+            if( instruction == RDSEED_SUPPORT_RDSEED &&
+                ( support & RDSEED_SUPPORT_RDRAND ) != 0 )
+            {
+                instruction = RDSEED_SUPPORT_RDRAND;
+                continue;
+            }
+
+            break;
+        }
+
+        use_len = ( len - *olen < 8 ) ? len - *olen : 8;
+        memcpy( output + *olen, &v, use_len );
+        *olen += use_len;
+    }
+
+    if( *olen == 0 && len != 0 )
+        return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
+
+    return( 0 );
+}
+
+#else /* __GNUC__ && __x86_64__ */
+
+int mbedtls_rdseed_has_support( void )
+{
+    return( 0 );
+}
+
+int mbedtls_rdseed_poll( void *data,
+                         unsigned char *output, size_t len, size_t *olen )
+{
+    ((void) data);
+    ((void) output);
+    ((void) len);
+
+    *olen = 0;
+
+    return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
+}
+
+#endif /* __GNUC__ && __x86_64__ */
+
+#endif /* MBEDTLS_ENTROPY_RDSEED */
+
 #if defined(MBEDTLS_HAVEGE_C)
 int mbedtls_havege_poll( void *data,
                  unsigned char *output, size_t len, size_t *olen )
@@ -39,6 +39,7 @@
 #if defined(MBEDTLS_GCM_C)
 
 #include "mbedtls/gcm.h"
+#include "mbedtls/hints.h"
 
 #include <string.h>
 
@@ -46,6 +47,10 @@
 #include "mbedtls/aesni.h"
 #endif
 
+#if defined(MBEDTLS_ARMCE_C)
+#include "mbedtls/armce.h"
+#endif
+
 #if defined(MBEDTLS_SELF_TEST) && defined(MBEDTLS_AES_C)
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
@@ -55,33 +60,9 @@
 #endif /* MBEDTLS_PLATFORM_C */
 #endif /* MBEDTLS_SELF_TEST && MBEDTLS_AES_C */
 
-/*
- * 32-bit integer manipulation macros (big endian)
- */
-#ifndef GET_UINT32_BE
-#define GET_UINT32_BE(n,b,i)                            \
-{                                                       \
-    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
-        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
-        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
-        | ( (uint32_t) (b)[(i) + 3]       );            \
-}
-#endif
+#include "mbedtls/byte_order.h"
 
-#ifndef PUT_UINT32_BE
-#define PUT_UINT32_BE(n,b,i)                            \
-{                                                       \
-    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
-    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
-    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
-    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
-}
-#endif
-
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * Initialize a context
@@ -98,6 +79,9 @@ void mbedtls_gcm_init( mbedtls_gcm_context *ctx )
  * correspond to low powers of P. The result is stored in the same way, that
  * is the high-order bit of HH corresponds to P^0 and the low-order bit of HL
  * corresponds to P^127.
+ *
+ * With MBEDTLS_GCM_LARGETABLE, i covers a full byte (256 entries, 4K) in
+ * HL8/HH8 instead of a nibble, halving the lookups per block in gcm_mult().
  */
 static int gcm_gen_table( mbedtls_gcm_context *ctx )
 {
@@ -125,11 +109,66 @@ static int gcm_gen_table( mbedtls_gcm_context *ctx )
     ctx->HH[8] = vh;
 
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
-    /* With CLMUL support, we need only h, not the rest of the table */
+    /*
+     * With CLMUL support, we need only h, not the rest of the table;
+     * precompute H^2..H^4 instead, for the aggregated GHASH path.
+     * They are stored byte-reversed, highest power first, which is the
+     * layout mbedtls_aesni_gcm_mult4() consumes directly.
+     */
     if( mbedtls_aesni_has_support( MBEDTLS_AESNI_CLMUL ) )
+    {
+        unsigned char hp[16];
+
+        memcpy( hp, h, 16 );
+        for( i = 3; i >= 0; i-- )
+        {
+            for( j = 0; j < 16; j++ )
+                ctx->HP[i * 16 + j] = hp[15 - j];
+
+            mbedtls_aesni_gcm_mult( hp, hp, h );
+        }
+
+        return( 0 );
+    }
+#endif
+
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    /* With PMULL support, we need only h, which HL[8]/HH[8] hold already */
+    if( mbedtls_armce_has_support( MBEDTLS_ARMCE_PMULL ) )
         return( 0 );
 #endif
 
+#if defined(MBEDTLS_GCM_LARGETABLE)
+    /* 0x80 = 1000 0000 corresponds to 1 in GF(2^128) */
+    ctx->HL8[0x80] = vl;
+    ctx->HH8[0x80] = vh;
+
+    /* 0 corresponds to 0 in GF(2^128) */
+    ctx->HH8[0] = 0;
+    ctx->HL8[0] = 0;
+
+    for( i = 0x40; i > 0; i >>= 1 )
+    {
+        uint32_t T = ( vl & 1 ) * 0xe1000000U;
+        vl  = ( vh << 63 ) | ( vl >> 1 );
+        vh  = ( vh >> 1 ) ^ ( (uint64_t) T << 32);
+
+        ctx->HL8[i] = vl;
+        ctx->HH8[i] = vh;
+    }
+
+    for( i = 2; i <= 0x80; i *= 2 )
+    {
+        uint64_t *HiL = ctx->HL8 + i, *HiH = ctx->HH8 + i;
+        vh = *HiH;
+        vl = *HiL;
+        for( j = 1; j < i; j++ )
+        {
+            HiH[j] = vh ^ ctx->HH8[j];
+            HiL[j] = vl ^ ctx->HL8[j];
+        }
+    }
+#else /* MBEDTLS_GCM_LARGETABLE */
     /* 0 corresponds to 0 in GF(2^128) */
     ctx->HH[0] = 0;
     ctx->HL[0] = 0;
@@ -155,6 +194,7 @@ static int gcm_gen_table( mbedtls_gcm_context *ctx )
             HiL[j] = vl ^ ctx->HL[j];
         }
     }
+#endif /* MBEDTLS_GCM_LARGETABLE */
 
     return( 0 );
 }
@@ -191,6 +231,48 @@ int mbedtls_gcm_setkey( mbedtls_gcm_context *ctx,
     return( 0 );
 }
 
+#if defined(MBEDTLS_GCM_LARGETABLE)
+/*
+ * Shoup's method for multiplication use this table with
+ *      last8[x] = x times P^128
+ * where x and last8[x] are seen as elements of GF(2^128) as in [MGV]
+ */
+static const uint16_t last8[256] =
+{
+    0x0000, 0x01c2, 0x0384, 0x0246, 0x0708, 0x06ca, 0x048c, 0x054e,
+    0x0e10, 0x0fd2, 0x0d94, 0x0c56, 0x0918, 0x08da, 0x0a9c, 0x0b5e,
+    0x1c20, 0x1de2, 0x1fa4, 0x1e66, 0x1b28, 0x1aea, 0x18ac, 0x196e,
+    0x1230, 0x13f2, 0x11b4, 0x1076, 0x1538, 0x14fa, 0x16bc, 0x177e,
+    0x3840, 0x3982, 0x3bc4, 0x3a06, 0x3f48, 0x3e8a, 0x3ccc, 0x3d0e,
+    0x3650, 0x3792, 0x35d4, 0x3416, 0x3158, 0x309a, 0x32dc, 0x331e,
+    0x2460, 0x25a2, 0x27e4, 0x2626, 0x2368, 0x22aa, 0x20ec, 0x212e,
+    0x2a70, 0x2bb2, 0x29f4, 0x2836, 0x2d78, 0x2cba, 0x2efc, 0x2f3e,
+    0x7080, 0x7142, 0x7304, 0x72c6, 0x7788, 0x764a, 0x740c, 0x75ce,
+    0x7e90, 0x7f52, 0x7d14, 0x7cd6, 0x7998, 0x785a, 0x7a1c, 0x7bde,
+    0x6ca0, 0x6d62, 0x6f24, 0x6ee6, 0x6ba8, 0x6a6a, 0x682c, 0x69ee,
+    0x62b0, 0x6372, 0x6134, 0x60f6, 0x65b8, 0x647a, 0x663c, 0x67fe,
+    0x48c0, 0x4902, 0x4b44, 0x4a86, 0x4fc8, 0x4e0a, 0x4c4c, 0x4d8e,
+    0x46d0, 0x4712, 0x4554, 0x4496, 0x41d8, 0x401a, 0x425c, 0x439e,
+    0x54e0, 0x5522, 0x5764, 0x56a6, 0x53e8, 0x522a, 0x506c, 0x51ae,
+    0x5af0, 0x5b32, 0x5974, 0x58b6, 0x5df8, 0x5c3a, 0x5e7c, 0x5fbe,
+    0xe100, 0xe0c2, 0xe284, 0xe346, 0xe608, 0xe7ca, 0xe58c, 0xe44e,
+    0xef10, 0xeed2, 0xec94, 0xed56, 0xe818, 0xe9da, 0xeb9c, 0xea5e,
+    0xfd20, 0xfce2, 0xfea4, 0xff66, 0xfa28, 0xfbea, 0xf9ac, 0xf86e,
+    0xf330, 0xf2f2, 0xf0b4, 0xf176, 0xf438, 0xf5fa, 0xf7bc, 0xf67e,
+    0xd940, 0xd882, 0xdac4, 0xdb06, 0xde48, 0xdf8a, 0xddcc, 0xdc0e,
+    0xd750, 0xd692, 0xd4d4, 0xd516, 0xd058, 0xd19a, 0xd3dc, 0xd21e,
+    0xc560, 0xc4a2, 0xc6e4, 0xc726, 0xc268, 0xc3aa, 0xc1ec, 0xc02e,
+    0xcb70, 0xcab2, 0xc8f4, 0xc936, 0xcc78, 0xcdba, 0xcffc, 0xce3e,
+    0x9180, 0x9042, 0x9204, 0x93c6, 0x9688, 0x974a, 0x950c, 0x94ce,
+    0x9f90, 0x9e52, 0x9c14, 0x9dd6, 0x9898, 0x995a, 0x9b1c, 0x9ade,
+    0x8da0, 0x8c62, 0x8e24, 0x8fe6, 0x8aa8, 0x8b6a, 0x892c, 0x88ee,
+    0x83b0, 0x8272, 0x8034, 0x81f6, 0x84b8, 0x857a, 0x873c, 0x86fe,
+    0xa9c0, 0xa802, 0xaa44, 0xab86, 0xaec8, 0xaf0a, 0xad4c, 0xac8e,
+    0xa7d0, 0xa612, 0xa454, 0xa596, 0xa0d8, 0xa11a, 0xa35c, 0xa29e,
+    0xb5e0, 0xb422, 0xb664, 0xb7a6, 0xb2e8, 0xb32a, 0xb16c, 0xb0ae,
+    0xbbf0, 0xba32, 0xb874, 0xb9b6, 0xbcf8, 0xbd3a, 0xbf7c, 0xbebe
+};
+#else /* MBEDTLS_GCM_LARGETABLE */
 /*
  * Shoup's method for multiplication use this table with
  *      last4[x] = x times P^128
@@ -203,6 +285,42 @@ static const uint64_t last4[16] =
     0xe100, 0xfd20, 0xd940, 0xc560,
     0x9180, 0x8da0, 0xa9c0, 0xb5e0
 };
+#endif /* MBEDTLS_GCM_LARGETABLE */
+
+/*
+ * Warm the multiplication tables at the start of a record, so the lines
+ * are resident by the time gcm_mult() walks them (PMU data shows demand
+ * misses there otherwise). The carry-less multiply paths never touch
+ * the tables, so skip the prefetch when one of them will run.
+ */
+static void gcm_prefetch_table( const mbedtls_gcm_context *ctx )
+{
+    size_t i;
+#if defined(MBEDTLS_GCM_LARGETABLE)
+    const unsigned char *lo = (const unsigned char *) ctx->HL8;
+    const unsigned char *hi = (const unsigned char *) ctx->HH8;
+    const size_t len = sizeof( ctx->HL8 );
+#else
+    const unsigned char *lo = (const unsigned char *) ctx->HL;
+    const unsigned char *hi = (const unsigned char *) ctx->HH;
+    const size_t len = sizeof( ctx->HL );
+#endif
+
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( mbedtls_aesni_has_support( MBEDTLS_AESNI_CLMUL ) )
+        return;
+#endif
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( mbedtls_armce_has_support( MBEDTLS_ARMCE_PMULL ) )
+        return;
+#endif
+
+    for( i = 0; i < len; i += 64 )
+    {
+        MBEDTLS_PREFETCH_R( lo + i );
+        MBEDTLS_PREFETCH_R( hi + i );
+    }
+}
 
 /*
  * Sets output to x times H using the precomputed tables.
@@ -212,7 +330,10 @@ static void gcm_mult( mbedtls_gcm_context *ctx, const unsigned char x[16],
                       unsigned char output[16] )
 {
     int i = 0;
-    unsigned char lo, hi, rem;
+#if !defined(MBEDTLS_GCM_LARGETABLE)
+    unsigned char lo, hi;
+#endif
+    unsigned char rem;
     uint64_t zh, zl;
 
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
@@ -229,6 +350,34 @@ static void gcm_mult( mbedtls_gcm_context *ctx, const unsigned char x[16],
     }
 #endif /* MBEDTLS_AESNI_C && MBEDTLS_HAVE_X86_64 */
 
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( mbedtls_armce_has_support( MBEDTLS_ARMCE_PMULL ) ) {
+        unsigned char h[16];
+
+        PUT_UINT32_BE( ctx->HH[8] >> 32, h,  0 );
+        PUT_UINT32_BE( ctx->HH[8],       h,  4 );
+        PUT_UINT32_BE( ctx->HL[8] >> 32, h,  8 );
+        PUT_UINT32_BE( ctx->HL[8],       h, 12 );
+
+        mbedtls_armce_gcm_mult( output, x, h );
+        return;
+    }
+#endif /* MBEDTLS_ARMCE_C && MBEDTLS_HAVE_ARM64 */
+
+#if defined(MBEDTLS_GCM_LARGETABLE)
+    zh = ctx->HH8[x[15]];
+    zl = ctx->HL8[x[15]];
+
+    for( i = 14; i >= 0; i-- )
+    {
+        rem = (unsigned char) zl & 0xff;
+        zl = ( zh << 56 ) | ( zl >> 8 );
+        zh = ( zh >> 8 );
+        zh ^= (uint64_t) last8[rem] << 48;
+        zh ^= ctx->HH8[x[i]];
+        zl ^= ctx->HL8[x[i]];
+    }
+#else /* MBEDTLS_GCM_LARGETABLE */
     lo = x[15] & 0xf;
 
     zh = ctx->HH[lo];
@@ -257,6 +406,7 @@ static void gcm_mult( mbedtls_gcm_context *ctx, const unsigned char x[16],
         zh ^= ctx->HH[hi];
         zl ^= ctx->HL[hi];
     }
+#endif /* MBEDTLS_GCM_LARGETABLE */
 
     PUT_UINT32_BE( zh >> 32, output, 0 );
     PUT_UINT32_BE( zh, output, 4 );
@@ -284,6 +434,8 @@ int mbedtls_gcm_starts( mbedtls_gcm_context *ctx,
         return( MBEDTLS_ERR_GCM_BAD_INPUT );
     }
 
+    gcm_prefetch_table( ctx );
+
     memset( ctx->y, 0x00, sizeof(ctx->y) );
     memset( ctx->buf, 0x00, sizeof(ctx->buf) );
 
@@ -355,7 +507,7 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
     size_t i;
     const unsigned char *p;
     unsigned char *out_p = output;
-    size_t use_len, olen = 0;
+    size_t use_len, offset, olen = 0;
 
     if( output > input && (size_t) ( output - input ) < length )
         return( MBEDTLS_ERR_GCM_BAD_INPUT );
@@ -368,13 +520,117 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
         return( MBEDTLS_ERR_GCM_BAD_INPUT );
     }
 
+    offset = (size_t)( ctx->len % 16 );
     ctx->len += length;
 
     p = input;
-    while( length > 0 )
+
+    /*
+     * Continue the partial block carried over from the previous call: the
+     * rest of its keystream is in ctx->ectr and its GHASH accumulation sits
+     * in ctx->buf, not multiplied yet.
+     */
+    if( offset != 0 )
+    {
+        use_len = 16 - offset;
+        if( use_len > length )
+            use_len = length;
+
+        for( i = 0; i < use_len; i++ )
+        {
+            if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+                ctx->buf[offset + i] ^= p[i];
+            out_p[i] = ctx->ectr[offset + i] ^ p[i];
+            if( ctx->mode == MBEDTLS_GCM_ENCRYPT )
+                ctx->buf[offset + i] ^= out_p[i];
+        }
+
+        if( offset + use_len == 16 )
+            gcm_mult( ctx, ctx->buf, ctx->buf );
+
+        length -= use_len;
+        p += use_len;
+        out_p += use_len;
+    }
+
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64) && defined(MBEDTLS_AES_C)
+    /*
+     * The CTR keystream blocks are independent: when the underlying cipher
+     * is AES and the CPU has AES-NI, generate four of them at a time with
+     * the interleaved kernel. With CLMUL the GHASH part is fused too: the
+     * four blocks go through one aggregated multiplication using the
+     * precomputed powers of H, so the modular reduction runs once per
+     * four blocks. Otherwise GHASH stays per-block.
+     */
+    if( length >= 64 &&
+        mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) &&
+        ( ctx->cipher_ctx.cipher_info->type == MBEDTLS_CIPHER_AES_128_ECB ||
+          ctx->cipher_ctx.cipher_info->type == MBEDTLS_CIPHER_AES_192_ECB ||
+          ctx->cipher_ctx.cipher_info->type == MBEDTLS_CIPHER_AES_256_ECB ) )
     {
-        use_len = ( length < 16 ) ? length : 16;
+        unsigned char ectr4[64];
+        size_t b;
+        int clmul = mbedtls_aesni_has_support( MBEDTLS_AESNI_CLMUL );
+
+        while( length >= 64 )
+        {
+            unsigned char *e = ectr4;
+
+            for( b = 0; b < 4; b++ )
+            {
+                for( i = 16; i > 12; i-- )
+                    if( ++ctx->y[i - 1] != 0 )
+                        break;
+
+                memcpy( ectr4 + b * 16, ctx->y, 16 );
+            }
+
+            mbedtls_aesni_crypt_ecb_x4(
+                (mbedtls_aes_context *) ctx->cipher_ctx.cipher_ctx,
+                MBEDTLS_AES_ENCRYPT, ectr4, ectr4 );
+
+            if( clmul )
+            {
+                unsigned char cbuf[64];
+
+                /* GHASH eats the ciphertext; save it first on decryption,
+                 * as the output may overlap the input */
+                if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+                    memcpy( cbuf, p, 64 );
+
+                for( i = 0; i < 64; i++ )
+                    out_p[i] = ectr4[i] ^ p[i];
+
+                mbedtls_aesni_gcm_mult4( ctx->buf, ctx->HP,
+                        ctx->mode == MBEDTLS_GCM_DECRYPT ? cbuf : out_p );
 
+                p += 64;
+                out_p += 64;
+            }
+            else
+            {
+                for( b = 0; b < 4; b++, e += 16, p += 16, out_p += 16 )
+                {
+                    for( i = 0; i < 16; i++ )
+                    {
+                        if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+                            ctx->buf[i] ^= p[i];
+                        out_p[i] = e[i] ^ p[i];
+                        if( ctx->mode == MBEDTLS_GCM_ENCRYPT )
+                            ctx->buf[i] ^= out_p[i];
+                    }
+
+                    gcm_mult( ctx, ctx->buf, ctx->buf );
+                }
+            }
+
+            length -= 64;
+        }
+    }
+#endif /* MBEDTLS_AESNI_C && MBEDTLS_HAVE_X86_64 && MBEDTLS_AES_C */
+
+    while( length >= 16 )
+    {
         for( i = 16; i > 12; i-- )
             if( ++ctx->y[i - 1] != 0 )
                 break;
@@ -385,7 +641,7 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
             return( ret );
         }
 
-        for( i = 0; i < use_len; i++ )
+        for( i = 0; i < 16; i++ )
         {
             if( ctx->mode == MBEDTLS_GCM_DECRYPT )
                 ctx->buf[i] ^= p[i];
@@ -396,9 +652,36 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
 
         gcm_mult( ctx, ctx->buf, ctx->buf );
 
-        length -= use_len;
-        p += use_len;
-        out_p += use_len;
+        length -= 16;
+        p += 16;
+        out_p += 16;
+    }
+
+    /*
+     * Start a new partial block: keep its keystream around for the next
+     * call and leave the GHASH multiplication to whoever completes it,
+     * either a later update or mbedtls_gcm_finish().
+     */
+    if( length > 0 )
+    {
+        for( i = 16; i > 12; i-- )
+            if( ++ctx->y[i - 1] != 0 )
+                break;
+
+        if( ( ret = mbedtls_cipher_update( &ctx->cipher_ctx, ctx->y, 16,
+                                   ctx->ectr, &olen ) ) != 0 )
+        {
+            return( ret );
+        }
+
+        for( i = 0; i < length; i++ )
+        {
+            if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+                ctx->buf[i] ^= p[i];
+            out_p[i] = ctx->ectr[i] ^ p[i];
+            if( ctx->mode == MBEDTLS_GCM_ENCRYPT )
+                ctx->buf[i] ^= out_p[i];
+        }
     }
 
     return( 0 );
@@ -421,6 +704,12 @@ int mbedtls_gcm_finish( mbedtls_gcm_context *ctx,
 
     if( orig_len || orig_add_len )
     {
+        /* A trailing partial block is still pending in ctx->buf: its
+         * multiplication was deferred by mbedtls_gcm_update(), fold it
+         * in here just before the length block */
+        if( ctx->len % 16 != 0 )
+            gcm_mult( ctx, ctx->buf, ctx->buf );
+
         memset( work_buf, 0x00, 16 );
 
         PUT_UINT32_BE( ( orig_add_len >> 32 ), work_buf, 0  );
@@ -466,6 +755,44 @@ int mbedtls_gcm_crypt_and_tag( mbedtls_gcm_context *ctx,
     return( 0 );
 }
 
+int mbedtls_gcm_crypt_and_tag_iov( mbedtls_gcm_context *ctx,
+                       int mode,
+                       const mbedtls_iovec *iov,
+                       size_t iov_count,
+                       const unsigned char *iv,
+                       size_t iv_len,
+                       const unsigned char *add,
+                       size_t add_len,
+                       unsigned char *output,
+                       size_t tag_len,
+                       unsigned char *tag )
+{
+    int ret;
+    size_t s;
+    unsigned char *out_p = output;
+
+    if( ( ret = mbedtls_gcm_starts( ctx, mode, iv, iv_len, add, add_len ) ) != 0 )
+        return( ret );
+
+    /*
+     * mbedtls_gcm_update() carries partial blocks across calls, so each
+     * segment can be fed directly, whatever its length.
+     */
+    for( s = 0; s < iov_count; s++ )
+    {
+        if( ( ret = mbedtls_gcm_update( ctx, iov[s].len, iov[s].base,
+                                        out_p ) ) != 0 )
+            return( ret );
+
+        out_p += iov[s].len;
+    }
+
+    if( ( ret = mbedtls_gcm_finish( ctx, tag, tag_len ) ) != 0 )
+        return( ret );
+
+    return( 0 );
+}
+
 int mbedtls_gcm_auth_decrypt( mbedtls_gcm_context *ctx,
                       size_t length,
                       const unsigned char *iv,
@@ -502,6 +829,45 @@ int mbedtls_gcm_auth_decrypt( mbedtls_gcm_context *ctx,
     return( 0 );
 }
 
+int mbedtls_gcm_auth_decrypt_iov( mbedtls_gcm_context *ctx,
+                      const mbedtls_iovec *iov,
+                      size_t iov_count,
+                      const unsigned char *iv,
+                      size_t iv_len,
+                      const unsigned char *add,
+                      size_t add_len,
+                      const unsigned char *tag,
+                      size_t tag_len,
+                      unsigned char *output )
+{
+    int ret;
+    unsigned char check_tag[16];
+    size_t i, length = 0;
+    int diff;
+
+    if( ( ret = mbedtls_gcm_crypt_and_tag_iov( ctx, MBEDTLS_GCM_DECRYPT,
+                                   iov, iov_count, iv, iv_len, add, add_len,
+                                   output, tag_len, check_tag ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    /* Check tag in "constant-time" */
+    for( diff = 0, i = 0; i < tag_len; i++ )
+        diff |= tag[i] ^ check_tag[i];
+
+    if( diff != 0 )
+    {
+        for( i = 0; i < iov_count; i++ )
+            length += iov[i].len;
+
+        mbedtls_zeroize( output, length );
+        return( MBEDTLS_ERR_GCM_AUTH_FAILED );
+    }
+
+    return( 0 );
+}
+
 void mbedtls_gcm_free( mbedtls_gcm_context *ctx )
 {
     mbedtls_cipher_free( &ctx->cipher_ctx );
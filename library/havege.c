@@ -40,10 +40,7 @@
 
 #include <string.h>
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /* ------------------------------------------------------------------------
  * On average, one iteration accesses two 8-word blocks in the havege WALK
@@ -177,7 +174,7 @@ static void havege_fill( mbedtls_havege_state *hs )
 
     memset( RES, 0, sizeof( RES ) );
 
-    while( n < MBEDTLS_HAVEGE_COLLECT_SIZE * 4 )
+    while( n < hs->rounds )
     {
         ONE_ITERATION
         ONE_ITERATION
@@ -192,6 +189,46 @@ static void havege_fill( mbedtls_havege_state *hs )
     hs->offset[1] = MBEDTLS_HAVEGE_COLLECT_SIZE / 2;
 }
 
+/*
+ * The historical fill ran MBEDTLS_HAVEGE_COLLECT_SIZE * 4 iterations,
+ * tuned for the CPUs of the original design: every pool word ends up
+ * mixed from 64 iterations. On a core whose cycle counter shows strong
+ * jitter each iteration already injects two fresh clock reads, so far
+ * fewer are needed and init stops costing a triple-digit-millisecond
+ * pause on embedded boots. A coarse or emulated timer (back-to-back
+ * reads mostly yielding the same delta) keeps the legacy amount.
+ */
+#define HAVEGE_ROUNDS_MAX   ( MBEDTLS_HAVEGE_COLLECT_SIZE * 4 )
+#define HAVEGE_ROUNDS_MIN   ( MBEDTLS_HAVEGE_COLLECT_SIZE     )
+
+#define HAVEGE_CAL_SAMPLES  64
+
+static int havege_calibrate( void )
+{
+    unsigned long prev, cur, delta, last_delta = 0;
+    int i, changes = 0;
+
+    prev = mbedtls_timing_hardclock();
+    for( i = 0; i < HAVEGE_CAL_SAMPLES; i++ )
+    {
+        cur = mbedtls_timing_hardclock();
+        delta = cur - prev;
+        prev = cur;
+
+        if( i != 0 && delta != last_delta )
+            changes++;
+        last_delta = delta;
+    }
+
+    if( changes >= HAVEGE_CAL_SAMPLES / 2 )
+        return( HAVEGE_ROUNDS_MIN );
+
+    if( changes >= HAVEGE_CAL_SAMPLES / 8 )
+        return( HAVEGE_ROUNDS_MAX / 2 );
+
+    return( HAVEGE_ROUNDS_MAX );
+}
+
 /*
  * HAVEGE initialization
  */
@@ -199,6 +236,8 @@ void mbedtls_havege_init( mbedtls_havege_state *hs )
 {
     memset( hs, 0, sizeof( mbedtls_havege_state ) );
 
+    hs->rounds = havege_calibrate();
+
     havege_fill( hs );
 }
 
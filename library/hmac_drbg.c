@@ -42,19 +42,19 @@
 #include <stdio.h>
 #endif
 
-#if defined(MBEDTLS_SELF_TEST)
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
 #else
+#include <stdlib.h>
+#define mbedtls_calloc     calloc
+#define mbedtls_free       free
+#if defined(MBEDTLS_SELF_TEST)
 #include <stdio.h>
 #define mbedtls_printf printf
 #endif /* MBEDTLS_SELF_TEST */
 #endif /* MBEDTLS_PLATFORM_C */
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * HMAC_DRBG context initialization
@@ -105,17 +105,28 @@ int mbedtls_hmac_drbg_seed_buf( mbedtls_hmac_drbg_context *ctx,
 {
     int ret;
 
-    if( ( ret = mbedtls_md_setup( &ctx->md_ctx, md_info, 1 ) ) != 0 )
-        return( ret );
+    /* A context that is already set up for this digest (as when re-seeding
+     * per message for deterministic ECDSA) keeps its md context, skipping
+     * the two allocations mbedtls_md_setup() would redo. */
+    if( ctx->md_ctx.md_info != md_info )
+    {
+        mbedtls_md_free( &ctx->md_ctx );
+
+        if( ( ret = mbedtls_md_setup( &ctx->md_ctx, md_info, 1 ) ) != 0 )
+            return( ret );
+    }
 
     /*
      * Set initial working state.
-     * Use the V memory location, which is currently all 0, to initialize the
-     * MD context with an all-zero key. Then set V to its initial value.
+     * Zero V and use its memory location to initialize the MD context with
+     * an all-zero key. Then set V to its initial value.
      */
+    memset( ctx->V, 0, sizeof( ctx->V ) );
     mbedtls_md_hmac_starts( &ctx->md_ctx, ctx->V, mbedtls_md_get_size( md_info ) );
     memset( ctx->V, 0x01, mbedtls_md_get_size( md_info ) );
 
+    ctx->batch_left = 0;
+
     mbedtls_hmac_drbg_update( ctx, data, data_len );
 
     return( 0 );
@@ -158,6 +169,9 @@ int mbedtls_hmac_drbg_reseed( mbedtls_hmac_drbg_context *ctx,
     /* 3. Reset reseed_counter */
     ctx->reseed_counter = 1;
 
+    /* Buffered output predates the reseed: drop it */
+    ctx->batch_left = 0;
+
     /* 4. Done */
     return( 0 );
 }
@@ -243,6 +257,56 @@ void mbedtls_hmac_drbg_set_reseed_interval( mbedtls_hmac_drbg_context *ctx, int
     ctx->reseed_interval = interval;
 }
 
+/*
+ * Set batched generation size (0 disables)
+ */
+int mbedtls_hmac_drbg_set_batch( mbedtls_hmac_drbg_context *ctx, size_t len )
+{
+    if( len > MBEDTLS_HMAC_DRBG_MAX_REQUEST )
+        return( MBEDTLS_ERR_HMAC_DRBG_REQUEST_TOO_BIG );
+
+    if( ctx->batch != NULL )
+    {
+        mbedtls_zeroize( ctx->batch, ctx->batch_len );
+        mbedtls_free( ctx->batch );
+        ctx->batch = NULL;
+    }
+    ctx->batch_len = 0;
+    ctx->batch_left = 0;
+
+    if( len != 0 )
+    {
+        if( ( ctx->batch = mbedtls_calloc( 1, len ) ) == NULL )
+            return( MBEDTLS_ERR_MD_ALLOC_FAILED );
+
+        ctx->batch_len = len;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Generate len bytes of raw HMAC_DRBG stream into out (10.1.2.5 step 4)
+ */
+static void hmac_drbg_generate( mbedtls_hmac_drbg_context *ctx,
+                                unsigned char *out, size_t len )
+{
+    size_t md_len = mbedtls_md_get_size( ctx->md_ctx.md_info );
+
+    while( len != 0 )
+    {
+        size_t use_len = len > md_len ? md_len : len;
+
+        mbedtls_md_hmac_reset( &ctx->md_ctx );
+        mbedtls_md_hmac_update( &ctx->md_ctx, ctx->V, md_len );
+        mbedtls_md_hmac_finish( &ctx->md_ctx, ctx->V );
+
+        memcpy( out, ctx->V, use_len );
+        out += use_len;
+        len -= use_len;
+    }
+}
+
 /*
  * HMAC_DRBG random function with optional additional data:
  * 10.1.2.5 (arabic) + 9.3 (Roman)
@@ -253,9 +317,6 @@ int mbedtls_hmac_drbg_random_with_add( void *p_rng,
 {
     int ret;
     mbedtls_hmac_drbg_context *ctx = (mbedtls_hmac_drbg_context *) p_rng;
-    size_t md_len = mbedtls_md_get_size( ctx->md_ctx.md_info );
-    size_t left = out_len;
-    unsigned char *out = output;
 
     /* II. Check request length */
     if( out_len > MBEDTLS_HMAC_DRBG_MAX_REQUEST )
@@ -276,24 +337,41 @@ int mbedtls_hmac_drbg_random_with_add( void *p_rng,
         add_len = 0; /* VII.4 */
     }
 
+    /* Requests without additional data that fit the batch buffer are
+     * served from it; one refill runs a whole generate cycle, so the
+     * re-key in step 6 is paid once per batch instead of per draw */
+    if( ctx->batch != NULL && add_len == 0 && out_len <= ctx->batch_len )
+    {
+        unsigned char *served;
+
+        if( ctx->batch_left < out_len )
+        {
+            hmac_drbg_generate( ctx, ctx->batch, ctx->batch_len );
+            mbedtls_hmac_drbg_update( ctx, NULL, 0 );
+            ctx->reseed_counter++;
+            ctx->batch_left = ctx->batch_len;
+        }
+
+        served = ctx->batch + ctx->batch_len - ctx->batch_left;
+        memcpy( output, served, out_len );
+        mbedtls_zeroize( served, out_len );
+        ctx->batch_left -= out_len;
+
+        return( 0 );
+    }
+
     /* 2. Use additional data if any */
     if( additional != NULL && add_len != 0 )
-        mbedtls_hmac_drbg_update( ctx, additional, add_len );
-
-    /* 3, 4, 5. Generate bytes */
-    while( left != 0 )
     {
-        size_t use_len = left > md_len ? md_len : left;
-
-        mbedtls_md_hmac_reset( &ctx->md_ctx );
-        mbedtls_md_hmac_update( &ctx->md_ctx, ctx->V, md_len );
-        mbedtls_md_hmac_finish( &ctx->md_ctx, ctx->V );
+        mbedtls_hmac_drbg_update( ctx, additional, add_len );
 
-        memcpy( out, ctx->V, use_len );
-        out += use_len;
-        left -= use_len;
+        /* Buffered output predates the state change: drop it */
+        ctx->batch_left = 0;
     }
 
+    /* 3, 4, 5. Generate bytes */
+    hmac_drbg_generate( ctx, output, out_len );
+
     /* 6. Update */
     mbedtls_hmac_drbg_update( ctx, additional, add_len );
 
@@ -339,6 +417,11 @@ void mbedtls_hmac_drbg_free( mbedtls_hmac_drbg_context *ctx )
     mbedtls_mutex_free( &ctx->mutex );
 #endif
     mbedtls_md_free( &ctx->md_ctx );
+    if( ctx->batch != NULL )
+    {
+        mbedtls_zeroize( ctx->batch, ctx->batch_len );
+        mbedtls_free( ctx->batch );
+    }
     mbedtls_zeroize( ctx, sizeof( mbedtls_hmac_drbg_context ) );
 }
 
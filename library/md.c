@@ -35,6 +35,42 @@
 #include "mbedtls/md.h"
 #include "mbedtls/md_internal.h"
 
+#if defined(MBEDTLS_MD2_C)
+#include "mbedtls/md2.h"
+#endif
+
+#if defined(MBEDTLS_MD4_C)
+#include "mbedtls/md4.h"
+#endif
+
+#if defined(MBEDTLS_MD5_C)
+#include "mbedtls/md5.h"
+#endif
+
+#if defined(MBEDTLS_RIPEMD160_C)
+#include "mbedtls/ripemd160.h"
+#endif
+
+#if defined(MBEDTLS_SHA1_C)
+#include "mbedtls/sha1.h"
+#endif
+
+#if defined(MBEDTLS_SHA256_C)
+#include "mbedtls/sha256.h"
+#endif
+
+#if defined(MBEDTLS_SHA512_C)
+#include "mbedtls/sha512.h"
+#endif
+
+#if defined(MBEDTLS_SHA256MB_C)
+#include "mbedtls/sha256mb.h"
+#endif
+
+#if defined(MBEDTLS_SHANI_C)
+#include "mbedtls/shani.h"
+#endif
+
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
 #else
@@ -43,16 +79,70 @@
 #define mbedtls_free       free
 #endif
 
+/*
+ * Hash dispatch. With MBEDTLS_SINGLE_BACKEND_DISPATCH exactly one hash
+ * module is compiled in (enforced in check_config.h), so update, finish
+ * and clone go to it directly and can be inlined; starts and the
+ * one-shot digest stay behind md_info as they carry the SHA-224/SHA-384
+ * flavour flag. Otherwise everything dispatches through the md_info
+ * function pointers as usual.
+ */
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH)
+#if defined(MBEDTLS_MD2_C)
+#define MD_SINGLE_CTX           mbedtls_md2_context
+#define MD_SINGLE_UPDATE        mbedtls_md2_update
+#define MD_SINGLE_FINISH        mbedtls_md2_finish
+#elif defined(MBEDTLS_MD4_C)
+#define MD_SINGLE_CTX           mbedtls_md4_context
+#define MD_SINGLE_UPDATE        mbedtls_md4_update
+#define MD_SINGLE_FINISH        mbedtls_md4_finish
+#elif defined(MBEDTLS_MD5_C)
+#define MD_SINGLE_CTX           mbedtls_md5_context
+#define MD_SINGLE_UPDATE        mbedtls_md5_update
+#define MD_SINGLE_FINISH        mbedtls_md5_finish
+#elif defined(MBEDTLS_RIPEMD160_C)
+#define MD_SINGLE_CTX           mbedtls_ripemd160_context
+#define MD_SINGLE_UPDATE        mbedtls_ripemd160_update
+#define MD_SINGLE_FINISH        mbedtls_ripemd160_finish
+#elif defined(MBEDTLS_SHA1_C)
+#define MD_SINGLE_CTX           mbedtls_sha1_context
+#define MD_SINGLE_UPDATE        mbedtls_sha1_update
+#define MD_SINGLE_FINISH        mbedtls_sha1_finish
+#elif defined(MBEDTLS_SHA256_C)
+#define MD_SINGLE_CTX           mbedtls_sha256_context
+#define MD_SINGLE_UPDATE        mbedtls_sha256_update
+#define MD_SINGLE_FINISH        mbedtls_sha256_finish
+#elif defined(MBEDTLS_SHA512_C)
+#define MD_SINGLE_CTX           mbedtls_sha512_context
+#define MD_SINGLE_UPDATE        mbedtls_sha512_update
+#define MD_SINGLE_FINISH        mbedtls_sha512_finish
+#endif
+
+#define MD_UPDATE( info, vctx, input, ilen )                        \
+    MD_SINGLE_UPDATE( (MD_SINGLE_CTX *) (vctx), (input), (ilen) )
+#define MD_FINISH( info, vctx, output )                             \
+    MD_SINGLE_FINISH( (MD_SINGLE_CTX *) (vctx), (output) )
+#define MD_CLONE( info, dst_vctx, src_vctx )                        \
+    ( *(MD_SINGLE_CTX *) (dst_vctx) = *(const MD_SINGLE_CTX *) (src_vctx) )
+#else /* MBEDTLS_SINGLE_BACKEND_DISPATCH */
+#define MD_UPDATE( info, vctx, input, ilen )                        \
+    (info)->update_func( (vctx), (input), (ilen) )
+#define MD_FINISH( info, vctx, output )                             \
+    (info)->finish_func( (vctx), (output) )
+#define MD_CLONE( info, dst_vctx, src_vctx )                        \
+    (info)->clone_func( (dst_vctx), (src_vctx) )
+#endif /* MBEDTLS_SINGLE_BACKEND_DISPATCH */
+
 #include <string.h>
 
 #if defined(MBEDTLS_FS_IO)
 #include <stdio.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * Reminder: update profiles in x509_crt.c when adding a new hash!
@@ -198,6 +288,14 @@ void mbedtls_md_free( mbedtls_md_context_t *ctx )
         mbedtls_free( ctx->hmac_ctx );
     }
 
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    if( ctx->hmac_ipad_ctx != NULL )
+        ctx->md_info->ctx_free_func( ctx->hmac_ipad_ctx );
+
+    if( ctx->hmac_opad_ctx != NULL )
+        ctx->md_info->ctx_free_func( ctx->hmac_opad_ctx );
+#endif
+
     mbedtls_zeroize( ctx, sizeof( mbedtls_md_context_t ) );
 }
 
@@ -206,12 +304,23 @@ int mbedtls_md_clone( mbedtls_md_context_t *dst,
 {
     if( dst == NULL || dst->md_info == NULL ||
         src == NULL || src->md_info == NULL ||
-        dst->md_info != src->md_info )
+        dst->md_info != src->md_info ||
+        ( dst->hmac_ctx == NULL ) != ( src->hmac_ctx == NULL ) )
     {
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
     }
 
-    dst->md_info->clone_func( dst->md_ctx, src->md_ctx );
+    MD_CLONE( dst->md_info, dst->md_ctx, src->md_ctx );
+
+    if( src->hmac_ctx != NULL )
+    {
+        memcpy( dst->hmac_ctx, src->hmac_ctx,
+                2 * src->md_info->block_size );
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+        MD_CLONE( dst->md_info, dst->hmac_ipad_ctx, src->hmac_ipad_ctx );
+        MD_CLONE( dst->md_info, dst->hmac_opad_ctx, src->hmac_opad_ctx );
+#endif
+    }
 
     return( 0 );
 }
@@ -239,6 +348,21 @@ int mbedtls_md_setup( mbedtls_md_context_t *ctx, const mbedtls_md_info_t *md_inf
             md_info->ctx_free_func( ctx->md_ctx );
             return( MBEDTLS_ERR_MD_ALLOC_FAILED );
         }
+
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+        ctx->hmac_ipad_ctx = md_info->ctx_alloc_func();
+        ctx->hmac_opad_ctx = md_info->ctx_alloc_func();
+        if( ctx->hmac_ipad_ctx == NULL || ctx->hmac_opad_ctx == NULL )
+        {
+            if( ctx->hmac_ipad_ctx != NULL )
+                md_info->ctx_free_func( ctx->hmac_ipad_ctx );
+            if( ctx->hmac_opad_ctx != NULL )
+                md_info->ctx_free_func( ctx->hmac_opad_ctx );
+            mbedtls_free( ctx->hmac_ctx );
+            md_info->ctx_free_func( ctx->md_ctx );
+            return( MBEDTLS_ERR_MD_ALLOC_FAILED );
+        }
+#endif
     }
 
     ctx->md_info = md_info;
@@ -261,7 +385,7 @@ int mbedtls_md_update( mbedtls_md_context_t *ctx, const unsigned char *input, si
     if( ctx == NULL || ctx->md_info == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
-    ctx->md_info->update_func( ctx->md_ctx, input, ilen );
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, input, ilen );
 
     return( 0 );
 }
@@ -271,7 +395,7 @@ int mbedtls_md_finish( mbedtls_md_context_t *ctx, unsigned char *output )
     if( ctx == NULL || ctx->md_info == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
-    ctx->md_info->finish_func( ctx->md_ctx, output );
+    MD_FINISH( ctx->md_info, ctx->md_ctx, output );
 
     return( 0 );
 }
@@ -287,14 +411,54 @@ int mbedtls_md( const mbedtls_md_info_t *md_info, const unsigned char *input, si
     return( 0 );
 }
 
+int mbedtls_md_multi( const mbedtls_md_info_t *md_info, size_t count,
+        const unsigned char *const *inputs, const size_t *ilens,
+        unsigned char *const *outputs )
+{
+    size_t i;
+    int ret;
+
+    if( md_info == NULL )
+        return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
+
+#if defined(MBEDTLS_SHA256MB_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( ( md_info->type == MBEDTLS_MD_SHA256 ||
+          md_info->type == MBEDTLS_MD_SHA224 ) &&
+        count >= 8 && mbedtls_sha256mb_has_support()
+#if defined(MBEDTLS_SHANI_C)
+        /* Dedicated SHA instructions beat the lane-parallel kernel even
+         * on a single stream, so let the serial path use them instead */
+        && ! mbedtls_shani_has_support()
+#endif
+      )
+    {
+        mbedtls_sha256mb_hash( md_info->type == MBEDTLS_MD_SHA224,
+                               count, inputs, ilens, outputs );
+        return( 0 );
+    }
+#endif
+
+    for( i = 0; i < count; i++ )
+    {
+        if( ( ret = mbedtls_md( md_info, inputs[i], ilens[i],
+                                outputs[i] ) ) != 0 )
+        {
+            return( ret );
+        }
+    }
+
+    return( 0 );
+}
+
 #if defined(MBEDTLS_FS_IO)
 int mbedtls_md_file( const mbedtls_md_info_t *md_info, const char *path, unsigned char *output )
 {
     int ret;
     FILE *f;
-    size_t n;
+    size_t n, buf_len;
     mbedtls_md_context_t ctx;
-    unsigned char buf[1024];
+    unsigned char stack_buf[1024];
+    unsigned char *buf;
 
     if( md_info == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
@@ -302,6 +466,22 @@ int mbedtls_md_file( const mbedtls_md_info_t *md_info, const char *path, unsigne
     if( ( f = fopen( path, "rb" ) ) == NULL )
         return( MBEDTLS_ERR_MD_FILE_IO_ERROR );
 
+#if defined(__linux__)
+    /* Sequential single pass: let the kernel read ahead aggressively */
+    posix_fadvise( fileno( f ), 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+
+    /* Read in large chunks so hashing, not syscalls, dominates; fall
+     * back to a stack buffer if the allocation fails */
+    buf = mbedtls_calloc( 1, MBEDTLS_MD_FILE_CHUNK_SIZE );
+    if( buf != NULL )
+        buf_len = MBEDTLS_MD_FILE_CHUNK_SIZE;
+    else
+    {
+        buf = stack_buf;
+        buf_len = sizeof( stack_buf );
+    }
+
     mbedtls_md_init( &ctx );
 
     if( ( ret = mbedtls_md_setup( &ctx, md_info, 0 ) ) != 0 )
@@ -309,8 +489,8 @@ int mbedtls_md_file( const mbedtls_md_info_t *md_info, const char *path, unsigne
 
     md_info->starts_func( ctx.md_ctx );
 
-    while( ( n = fread( buf, 1, sizeof( buf ), f ) ) > 0 )
-        md_info->update_func( ctx.md_ctx, buf, n );
+    while( ( n = fread( buf, 1, buf_len, f ) ) > 0 )
+        MD_UPDATE( md_info, ctx.md_ctx, buf, n );
 
     if( ferror( f ) != 0 )
     {
@@ -318,10 +498,12 @@ int mbedtls_md_file( const mbedtls_md_info_t *md_info, const char *path, unsigne
         goto cleanup;
     }
 
-    md_info->finish_func( ctx.md_ctx, output );
+    MD_FINISH( md_info, ctx.md_ctx, output );
 
 cleanup:
     fclose( f );
+    if( buf != stack_buf )
+        mbedtls_free( buf );
     mbedtls_md_free( &ctx );
 
     return( ret );
@@ -340,8 +522,8 @@ int mbedtls_md_hmac_starts( mbedtls_md_context_t *ctx, const unsigned char *key,
     if( keylen > (size_t) ctx->md_info->block_size )
     {
         ctx->md_info->starts_func( ctx->md_ctx );
-        ctx->md_info->update_func( ctx->md_ctx, key, keylen );
-        ctx->md_info->finish_func( ctx->md_ctx, sum );
+        MD_UPDATE( ctx->md_info, ctx->md_ctx, key, keylen );
+        MD_FINISH( ctx->md_info, ctx->md_ctx, sum );
 
         keylen = ctx->md_info->size;
         key = sum;
@@ -362,7 +544,17 @@ int mbedtls_md_hmac_starts( mbedtls_md_context_t *ctx, const unsigned char *key,
     mbedtls_zeroize( sum, sizeof( sum ) );
 
     ctx->md_info->starts_func( ctx->md_ctx );
-    ctx->md_info->update_func( ctx->md_ctx, ipad, ctx->md_info->block_size );
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, ipad, ctx->md_info->block_size );
+
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    /* Cache the states after the key pads, so that neither reset nor
+     * finish has to compress a pad block again for this key */
+    MD_CLONE( ctx->md_info, ctx->hmac_ipad_ctx, ctx->md_ctx );
+
+    ctx->md_info->starts_func( ctx->hmac_opad_ctx );
+    MD_UPDATE( ctx->md_info, ctx->hmac_opad_ctx, opad,
+                               ctx->md_info->block_size );
+#endif
 
     return( 0 );
 }
@@ -372,7 +564,7 @@ int mbedtls_md_hmac_update( mbedtls_md_context_t *ctx, const unsigned char *inpu
     if( ctx == NULL || ctx->md_info == NULL || ctx->hmac_ctx == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
-    ctx->md_info->update_func( ctx->md_ctx, input, ilen );
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, input, ilen );
 
     return( 0 );
 }
@@ -380,57 +572,126 @@ int mbedtls_md_hmac_update( mbedtls_md_context_t *ctx, const unsigned char *inpu
 int mbedtls_md_hmac_finish( mbedtls_md_context_t *ctx, unsigned char *output )
 {
     unsigned char tmp[MBEDTLS_MD_MAX_SIZE];
+#if !defined(MBEDTLS_MD_HMAC_CACHE)
     unsigned char *opad;
+#endif
 
     if( ctx == NULL || ctx->md_info == NULL || ctx->hmac_ctx == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
+    MD_FINISH( ctx->md_info, ctx->md_ctx, tmp );
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    MD_CLONE( ctx->md_info, ctx->md_ctx, ctx->hmac_opad_ctx );
+#else
     opad = (unsigned char *) ctx->hmac_ctx + ctx->md_info->block_size;
 
-    ctx->md_info->finish_func( ctx->md_ctx, tmp );
     ctx->md_info->starts_func( ctx->md_ctx );
-    ctx->md_info->update_func( ctx->md_ctx, opad, ctx->md_info->block_size );
-    ctx->md_info->update_func( ctx->md_ctx, tmp, ctx->md_info->size );
-    ctx->md_info->finish_func( ctx->md_ctx, output );
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, opad, ctx->md_info->block_size );
+#endif
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, tmp, ctx->md_info->size );
+    MD_FINISH( ctx->md_info, ctx->md_ctx, output );
 
     return( 0 );
 }
 
 int mbedtls_md_hmac_reset( mbedtls_md_context_t *ctx )
 {
+#if !defined(MBEDTLS_MD_HMAC_CACHE)
     unsigned char *ipad;
+#endif
 
     if( ctx == NULL || ctx->md_info == NULL || ctx->hmac_ctx == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    MD_CLONE( ctx->md_info, ctx->md_ctx, ctx->hmac_ipad_ctx );
+#else
     ipad = (unsigned char *) ctx->hmac_ctx;
 
     ctx->md_info->starts_func( ctx->md_ctx );
-    ctx->md_info->update_func( ctx->md_ctx, ipad, ctx->md_info->block_size );
+    MD_UPDATE( ctx->md_info, ctx->md_ctx, ipad, ctx->md_info->block_size );
+#endif
 
     return( 0 );
 }
 
+/*
+ * Stack space for the context of any enabled digest, so that the one-shot
+ * HMAC below can run without going through the heap-based setup path.
+ */
+typedef union
+{
+    unsigned char opaque;   /* keep the union non-empty with no digests */
+#if defined(MBEDTLS_MD2_C)
+    mbedtls_md2_context md2;
+#endif
+#if defined(MBEDTLS_MD4_C)
+    mbedtls_md4_context md4;
+#endif
+#if defined(MBEDTLS_MD5_C)
+    mbedtls_md5_context md5;
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+    mbedtls_ripemd160_context ripemd160;
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    mbedtls_sha1_context sha1;
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    mbedtls_sha256_context sha256;
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    mbedtls_sha512_context sha512;
+#endif
+} md_any_context;
+
 int mbedtls_md_hmac( const mbedtls_md_info_t *md_info, const unsigned char *key, size_t keylen,
                 const unsigned char *input, size_t ilen,
                 unsigned char *output )
 {
-    mbedtls_md_context_t ctx;
-    int ret;
+    md_any_context md_ctx;
+    unsigned char sum[MBEDTLS_MD_MAX_SIZE];
+    unsigned char tmp[MBEDTLS_MD_MAX_SIZE];
+    unsigned char pad[MBEDTLS_MD_MAX_BLOCK_SIZE];
+    size_t i;
 
     if( md_info == NULL )
         return( MBEDTLS_ERR_MD_BAD_INPUT_DATA );
 
-    mbedtls_md_init( &ctx );
+    memset( &md_ctx, 0, sizeof( md_ctx ) );
 
-    if( ( ret = mbedtls_md_setup( &ctx, md_info, 1 ) ) != 0 )
-        return( ret );
+    if( keylen > (size_t) md_info->block_size )
+    {
+        md_info->starts_func( &md_ctx );
+        MD_UPDATE( md_info, &md_ctx, key, keylen );
+        MD_FINISH( md_info, &md_ctx, sum );
 
-    mbedtls_md_hmac_starts( &ctx, key, keylen );
-    mbedtls_md_hmac_update( &ctx, input, ilen );
-    mbedtls_md_hmac_finish( &ctx, output );
+        keylen = md_info->size;
+        key = sum;
+    }
 
-    mbedtls_md_free( &ctx );
+    memset( pad, 0x36, md_info->block_size );
+    for( i = 0; i < keylen; i++ )
+        pad[i] = (unsigned char)( pad[i] ^ key[i] );
+
+    md_info->starts_func( &md_ctx );
+    MD_UPDATE( md_info, &md_ctx, pad, md_info->block_size );
+    MD_UPDATE( md_info, &md_ctx, input, ilen );
+    MD_FINISH( md_info, &md_ctx, tmp );
+
+    memset( pad, 0x5C, md_info->block_size );
+    for( i = 0; i < keylen; i++ )
+        pad[i] = (unsigned char)( pad[i] ^ key[i] );
+
+    md_info->starts_func( &md_ctx );
+    MD_UPDATE( md_info, &md_ctx, pad, md_info->block_size );
+    MD_UPDATE( md_info, &md_ctx, tmp, md_info->size );
+    MD_FINISH( md_info, &md_ctx, output );
+
+    mbedtls_zeroize( &md_ctx, sizeof( md_ctx ) );
+    mbedtls_zeroize( sum, sizeof( sum ) );
+    mbedtls_zeroize( tmp, sizeof( tmp ) );
+    mbedtls_zeroize( pad, sizeof( pad ) );
 
     return( 0 );
 }
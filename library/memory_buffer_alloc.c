@@ -43,15 +43,26 @@
 #include "mbedtls/threading.h"
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#if defined(MBEDTLS_MEMORY_ARENAS)
+#include <pthread.h>
+#endif
+
+#include "mbedtls/constant_time.h"
 
 #define MAGIC1       0xFF00AA55
 #define MAGIC2       0xEE119966
 #define MAX_BT 20
 
+/*
+ * Free blocks are kept in segregated lists: bin i holds blocks whose size
+ * is in [2^i, 2^(i+1)). An allocation scans at most its own size class
+ * and otherwise pops the head of the next non-empty higher class, so the
+ * cost no longer grows with fragmentation the way the old first-fit walk
+ * of a single list did. 32 classes cover any 32-bit size; larger blocks
+ * land in the last bin.
+ */
+#define MBA_BIN_COUNT   32
+
 typedef struct _memory_header memory_header;
 struct _memory_header
 {
@@ -65,6 +76,9 @@ struct _memory_header
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     char            **trace;
     size_t          trace_count;
+#endif
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    int             tag;
 #endif
     size_t          magic2;
 };
@@ -74,7 +88,8 @@ typedef struct
     unsigned char   *buf;
     size_t          len;
     memory_header   *first;
-    memory_header   *first_free;
+    memory_header   *free_bins[MBA_BIN_COUNT];
+    unsigned long   bin_map;
     int             verify;
 #if defined(MBEDTLS_MEMORY_DEBUG)
     size_t          alloc_count;
@@ -92,6 +107,135 @@ buffer_alloc_ctx;
 
 static buffer_alloc_ctx heap;
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+/*
+ * Tag attribution state; file-scope so that blocks from every heap
+ * (master and arenas) are accounted in one place.
+ */
+static int tagging_cur_tag;
+static size_t tag_used[MBEDTLS_MEMORY_TAG_COUNT];
+static size_t tag_max_used[MBEDTLS_MEMORY_TAG_COUNT];
+static size_t tag_blocks[MBEDTLS_MEMORY_TAG_COUNT];
+static size_t tag_max_blocks[MBEDTLS_MEMORY_TAG_COUNT];
+#endif
+
+#if defined(MBEDTLS_MEMORY_ARENAS)
+/*
+ * A per-thread arena is a self-contained allocator context whose buffer is
+ * carved out of the master heap at first use. The owning thread allocates
+ * and frees in its arena without taking any lock; blocks freed by another
+ * thread are pushed onto the owner's remote queue (linked through the
+ * next_free field, unused while a block is allocated) and folded back in
+ * the next time the owner allocates.
+ */
+typedef struct
+{
+    buffer_alloc_ctx            ctx;
+    memory_header               *remote_head;
+    mbedtls_threading_mutex_t   remote_mutex;
+    int                         orphaned;
+}
+memory_arena;
+
+static memory_arena arenas[MBEDTLS_MEMORY_ARENA_MAX];
+static volatile size_t arena_count;
+static pthread_key_t arena_key;
+static int arena_key_valid;
+#endif /* MBEDTLS_MEMORY_ARENAS */
+
+static size_t bin_index( size_t size )
+{
+    size_t i = 0;
+
+    while( i < MBA_BIN_COUNT - 1 && ( size >> ( i + 1 ) ) != 0 )
+        i++;
+
+    return( i );
+}
+
+static void free_list_insert( buffer_alloc_ctx *hp, memory_header *hdr )
+{
+    size_t bin = bin_index( hdr->size );
+
+    hdr->prev_free = NULL;
+    hdr->next_free = hp->free_bins[bin];
+    if( hp->free_bins[bin] != NULL )
+        hp->free_bins[bin]->prev_free = hdr;
+    hp->free_bins[bin] = hdr;
+
+    hp->bin_map |= (unsigned long) 1 << bin;
+}
+
+static void free_list_remove( buffer_alloc_ctx *hp, memory_header *hdr )
+{
+    size_t bin = bin_index( hdr->size );
+
+    if( hdr->prev_free != NULL )
+        hdr->prev_free->next_free = hdr->next_free;
+    else
+        hp->free_bins[bin] = hdr->next_free;
+
+    if( hdr->next_free != NULL )
+        hdr->next_free->prev_free = hdr->prev_free;
+
+    if( hp->free_bins[bin] == NULL )
+        hp->bin_map &= ~( (unsigned long) 1 << bin );
+
+    hdr->prev_free = NULL;
+    hdr->next_free = NULL;
+}
+
+static memory_header *free_list_find( buffer_alloc_ctx *hp, size_t len )
+{
+    size_t bin = bin_index( len );
+    unsigned long map;
+    memory_header *cur;
+
+    /* Blocks in len's own class may still be smaller than len; the scan
+     * is bounded to this single class */
+    for( cur = hp->free_bins[bin]; cur != NULL; cur = cur->next_free )
+        if( cur->size >= len )
+            return( cur );
+
+    /* Any block in a higher class is guaranteed large enough */
+    map = bin < MBA_BIN_COUNT - 1 ? hp->bin_map >> ( bin + 1 ) : 0;
+    while( map != 0 )
+    {
+        bin++;
+        if( map & 1 )
+            return( hp->free_bins[bin] );
+        map >>= 1;
+    }
+
+    return( NULL );
+}
+
+#if defined(MBEDTLS_MEMORY_TAGGING)
+/*
+ * Attribute an allocated block to the current tag; called with the heap
+ * mutex held (when there is one), from the allocation paths.
+ */
+static void tag_alloc( memory_header *hdr )
+{
+    int tag = tagging_cur_tag;
+
+    hdr->tag = tag;
+    tag_used[tag] += hdr->size;
+    tag_blocks[tag]++;
+
+    if( tag_used[tag] > tag_max_used[tag] )
+        tag_max_used[tag] = tag_used[tag];
+    if( tag_blocks[tag] > tag_max_blocks[tag] )
+        tag_max_blocks[tag] = tag_blocks[tag];
+}
+
+static void tag_free( memory_header *hdr )
+{
+    tag_used[hdr->tag] -= hdr->size;
+    tag_blocks[hdr->tag]--;
+}
+#endif /* MBEDTLS_MEMORY_TAGGING */
+
 #if defined(MBEDTLS_MEMORY_DEBUG)
 static void debug_header( memory_header *hdr )
 {
@@ -114,9 +258,10 @@ static void debug_header( memory_header *hdr )
 #endif
 }
 
-static void debug_chain()
+static void debug_chain( buffer_alloc_ctx *hp )
 {
-    memory_header *cur = heap.first;
+    memory_header *cur = hp->first;
+    size_t i;
 
     mbedtls_fprintf( stderr, "\nBlock list\n" );
     while( cur != NULL )
@@ -125,13 +270,16 @@ static void debug_chain()
         cur = cur->next;
     }
 
-    mbedtls_fprintf( stderr, "Free list\n" );
-    cur = heap.first_free;
-
-    while( cur != NULL )
+    mbedtls_fprintf( stderr, "Free lists\n" );
+    for( i = 0; i < MBA_BIN_COUNT; i++ )
     {
-        debug_header( cur );
-        cur = cur->next_free;
+        cur = hp->free_bins[i];
+
+        while( cur != NULL )
+        {
+            debug_header( cur );
+            cur = cur->next_free;
+        }
     }
 }
 #endif /* MBEDTLS_MEMORY_DEBUG */
@@ -181,11 +329,11 @@ static int verify_header( memory_header *hdr )
     return( 0 );
 }
 
-static int verify_chain()
+static int verify_chain( buffer_alloc_ctx *hp )
 {
-    memory_header *prv = heap.first, *cur = heap.first->next;
+    memory_header *prv = hp->first, *cur = hp->first->next;
 
-    if( verify_header( heap.first ) != 0 )
+    if( verify_header( hp->first ) != 0 )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
         mbedtls_fprintf( stderr, "FATAL: verification of first header "
@@ -194,7 +342,7 @@ static int verify_chain()
         return( 1 );
     }
 
-    if( heap.first->prev != NULL )
+    if( hp->first->prev != NULL )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
         mbedtls_fprintf( stderr, "FATAL: verification failed: "
@@ -230,9 +378,9 @@ static int verify_chain()
     return( 0 );
 }
 
-static void *buffer_alloc_calloc( size_t n, size_t size )
+static void *buffer_alloc_calloc( buffer_alloc_ctx *hp, size_t n, size_t size )
 {
-    memory_header *new, *cur = heap.first_free;
+    memory_header *new, *cur;
     unsigned char *p;
     void *ret;
     size_t original_len, len;
@@ -241,7 +389,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     size_t trace_cnt;
 #endif
 
-    if( heap.buf == NULL || heap.first == NULL )
+    if( hp->buf == NULL || hp->first == NULL )
         return( NULL );
 
     original_len = len = n * size;
@@ -257,13 +405,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
     // Find block that fits
     //
-    while( cur != NULL )
-    {
-        if( cur->size >= len )
-            break;
-
-        cur = cur->next_free;
-    }
+    cur = free_list_find( hp, len );
 
     if( cur == NULL )
         return( NULL );
@@ -278,7 +420,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     }
 
 #if defined(MBEDTLS_MEMORY_DEBUG)
-    heap.alloc_count++;
+    hp->alloc_count++;
 #endif
 
     // Found location, split block if > memory_header + 4 room left
@@ -286,25 +428,16 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     if( cur->size - len < sizeof(memory_header) +
                           MBEDTLS_MEMORY_ALIGN_MULTIPLE )
     {
+        free_list_remove( hp, cur );
         cur->alloc = 1;
 
-        // Remove from free_list
-        //
-        if( cur->prev_free != NULL )
-            cur->prev_free->next_free = cur->next_free;
-        else
-            heap.first_free = cur->next_free;
-
-        if( cur->next_free != NULL )
-            cur->next_free->prev_free = cur->prev_free;
-
-        cur->prev_free = NULL;
-        cur->next_free = NULL;
-
 #if defined(MBEDTLS_MEMORY_DEBUG)
-        heap.total_used += cur->size;
-        if( heap.total_used > heap.maximum_used )
-            heap.maximum_used = heap.total_used;
+        hp->total_used += cur->size;
+        if( hp->total_used > hp->maximum_used )
+            hp->maximum_used = hp->total_used;
+#endif
+#if defined(MBEDTLS_MEMORY_TAGGING)
+        tag_alloc( cur );
 #endif
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
         trace_cnt = backtrace( trace_buffer, MAX_BT );
@@ -312,7 +445,8 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
         cur->trace_count = trace_cnt;
 #endif
 
-        if( ( heap.verify & MBEDTLS_MEMORY_VERIFY_ALLOC ) && verify_chain() != 0 )
+        if( ( hp->verify & MBEDTLS_MEMORY_VERIFY_ALLOC ) &&
+            verify_chain( hp ) != 0 )
             mbedtls_exit( 1 );
 
         ret = (unsigned char *) cur + sizeof( memory_header );
@@ -321,6 +455,8 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
         return( ret );
     }
 
+    free_list_remove( hp, cur );
+
     p = ( (unsigned char *) cur ) + sizeof(memory_header) + len;
     new = (memory_header *) p;
 
@@ -338,31 +474,24 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     if( new->next != NULL )
         new->next->prev = new;
 
-    // Replace cur with new in free_list
+    // The remainder goes back to its size class
     //
-    new->prev_free = cur->prev_free;
-    new->next_free = cur->next_free;
-    if( new->prev_free != NULL )
-        new->prev_free->next_free = new;
-    else
-        heap.first_free = new;
-
-    if( new->next_free != NULL )
-        new->next_free->prev_free = new;
+    free_list_insert( hp, new );
 
     cur->alloc = 1;
     cur->size = len;
     cur->next = new;
-    cur->prev_free = NULL;
-    cur->next_free = NULL;
 
 #if defined(MBEDTLS_MEMORY_DEBUG)
-    heap.header_count++;
-    if( heap.header_count > heap.maximum_header_count )
-        heap.maximum_header_count = heap.header_count;
-    heap.total_used += cur->size;
-    if( heap.total_used > heap.maximum_used )
-        heap.maximum_used = heap.total_used;
+    hp->header_count++;
+    if( hp->header_count > hp->maximum_header_count )
+        hp->maximum_header_count = hp->header_count;
+    hp->total_used += cur->size;
+    if( hp->total_used > hp->maximum_used )
+        hp->maximum_used = hp->total_used;
+#endif
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    tag_alloc( cur );
 #endif
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     trace_cnt = backtrace( trace_buffer, MAX_BT );
@@ -370,7 +499,8 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     cur->trace_count = trace_cnt;
 #endif
 
-    if( ( heap.verify & MBEDTLS_MEMORY_VERIFY_ALLOC ) && verify_chain() != 0 )
+    if( ( hp->verify & MBEDTLS_MEMORY_VERIFY_ALLOC ) &&
+        verify_chain( hp ) != 0 )
         mbedtls_exit( 1 );
 
     ret = (unsigned char *) cur + sizeof( memory_header );
@@ -379,15 +509,15 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     return( ret );
 }
 
-static void buffer_alloc_free( void *ptr )
+static void buffer_alloc_free( buffer_alloc_ctx *hp, void *ptr )
 {
     memory_header *hdr, *old = NULL;
     unsigned char *p = (unsigned char *) ptr;
 
-    if( ptr == NULL || heap.buf == NULL || heap.first == NULL )
+    if( ptr == NULL || hp->buf == NULL || hp->first == NULL )
         return;
 
-    if( p < heap.buf || p > heap.buf + heap.len )
+    if( p < hp->buf || p > hp->buf + hp->len )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
         mbedtls_fprintf( stderr, "FATAL: mbedtls_free() outside of managed "
@@ -414,8 +544,11 @@ static void buffer_alloc_free( void *ptr )
     hdr->alloc = 0;
 
 #if defined(MBEDTLS_MEMORY_DEBUG)
-    heap.free_count++;
-    heap.total_used -= hdr->size;
+    hp->free_count++;
+    hp->total_used -= hdr->size;
+#endif
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    tag_free( hdr );
 #endif
 
     // Regroup with block before
@@ -423,8 +556,10 @@ static void buffer_alloc_free( void *ptr )
     if( hdr->prev != NULL && hdr->prev->alloc == 0 )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
-        heap.header_count--;
+        hp->header_count--;
 #endif
+        free_list_remove( hp, hdr->prev );
+
         hdr->prev->size += sizeof(memory_header) + hdr->size;
         hdr->prev->next = hdr->next;
         old = hdr;
@@ -444,34 +579,14 @@ static void buffer_alloc_free( void *ptr )
     if( hdr->next != NULL && hdr->next->alloc == 0 )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
-        heap.header_count--;
+        hp->header_count--;
 #endif
+        free_list_remove( hp, hdr->next );
+
         hdr->size += sizeof(memory_header) + hdr->next->size;
         old = hdr->next;
         hdr->next = hdr->next->next;
 
-        if( hdr->prev_free != NULL || hdr->next_free != NULL )
-        {
-            if( hdr->prev_free != NULL )
-                hdr->prev_free->next_free = hdr->next_free;
-            else
-                heap.first_free = hdr->next_free;
-
-            if( hdr->next_free != NULL )
-                hdr->next_free->prev_free = hdr->prev_free;
-        }
-
-        hdr->prev_free = old->prev_free;
-        hdr->next_free = old->next_free;
-
-        if( hdr->prev_free != NULL )
-            hdr->prev_free->next_free = hdr;
-        else
-            heap.first_free = hdr;
-
-        if( hdr->next_free != NULL )
-            hdr->next_free->prev_free = hdr;
-
         if( hdr->next != NULL )
             hdr->next->prev = hdr;
 
@@ -481,34 +596,34 @@ static void buffer_alloc_free( void *ptr )
         memset( old, 0, sizeof(memory_header) );
     }
 
-    // Prepend to free_list if we have not merged
-    // (Does not have to stay in same order as prev / next list)
+    // File the (possibly coalesced) block under its size class
     //
-    if( old == NULL )
-    {
-        hdr->next_free = heap.first_free;
-        if( heap.first_free != NULL )
-            heap.first_free->prev_free = hdr;
-        heap.first_free = hdr;
-    }
+    free_list_insert( hp, hdr );
 
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     hdr->trace = NULL;
     hdr->trace_count = 0;
 #endif
 
-    if( ( heap.verify & MBEDTLS_MEMORY_VERIFY_FREE ) && verify_chain() != 0 )
+    if( ( hp->verify & MBEDTLS_MEMORY_VERIFY_FREE ) &&
+        verify_chain( hp ) != 0 )
         mbedtls_exit( 1 );
 }
 
 void mbedtls_memory_buffer_set_verify( int verify )
 {
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    size_t i;
+
+    for( i = 0; i < arena_count; i++ )
+        arenas[i].ctx.verify = verify;
+#endif
     heap.verify = verify;
 }
 
 int mbedtls_memory_buffer_alloc_verify()
 {
-    return verify_chain();
+    return verify_chain( &heap );
 }
 
 #if defined(MBEDTLS_MEMORY_DEBUG)
@@ -528,7 +643,7 @@ void mbedtls_memory_buffer_alloc_status()
     else
     {
         mbedtls_fprintf( stderr, "Memory currently allocated:\n" );
-        debug_chain();
+        debug_chain( &heap );
     }
 }
 
@@ -551,13 +666,208 @@ void mbedtls_memory_buffer_alloc_cur_get( size_t *cur_used, size_t *cur_blocks )
 }
 #endif /* MBEDTLS_MEMORY_DEBUG */
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+int mbedtls_memory_buffer_set_tag( int tag )
+{
+    int prev = tagging_cur_tag;
+
+    if( tag >= 0 && tag < MBEDTLS_MEMORY_TAG_COUNT )
+        tagging_cur_tag = tag;
+
+    return( prev );
+}
+
+void mbedtls_memory_buffer_alloc_tag_max_get( int tag, size_t *max_used,
+                                              size_t *max_blocks )
+{
+    if( tag < 0 || tag >= MBEDTLS_MEMORY_TAG_COUNT )
+    {
+        *max_used = *max_blocks = 0;
+        return;
+    }
+
+    *max_used   = tag_max_used[tag];
+    *max_blocks = tag_max_blocks[tag];
+}
+
+void mbedtls_memory_buffer_alloc_tag_cur_get( int tag, size_t *cur_used,
+                                              size_t *cur_blocks )
+{
+    if( tag < 0 || tag >= MBEDTLS_MEMORY_TAG_COUNT )
+    {
+        *cur_used = *cur_blocks = 0;
+        return;
+    }
+
+    *cur_used   = tag_used[tag];
+    *cur_blocks = tag_blocks[tag];
+}
+
+void mbedtls_memory_buffer_alloc_tag_max_reset( void )
+{
+    memset( tag_max_used, 0, sizeof( tag_max_used ) );
+    memset( tag_max_blocks, 0, sizeof( tag_max_blocks ) );
+}
+#endif /* MBEDTLS_MEMORY_TAGGING */
+
+/*
+ * Set up an allocator context over [buf, buf+len); buf must already be
+ * aligned. Everything but the (optional) mutex is reset.
+ */
+static void heap_setup( buffer_alloc_ctx *hp, unsigned char *buf, size_t len )
+{
+    hp->buf = buf;
+    hp->len = len;
+
+    memset( hp->free_bins, 0, sizeof( hp->free_bins ) );
+    hp->bin_map = 0;
+
+    hp->first = (memory_header *) buf;
+    memset( hp->first, 0, sizeof(memory_header) );
+    hp->first->size = len - sizeof(memory_header);
+    hp->first->magic1 = MAGIC1;
+    hp->first->magic2 = MAGIC2;
+    free_list_insert( hp, hp->first );
+}
+
+#if defined(MBEDTLS_MEMORY_ARENAS)
+static void arena_key_destructor( void *val )
+{
+    memory_arena *ar = (memory_arena *) val;
+
+    /* The arena keeps its live blocks (other threads may still free them
+     * remotely); the next thread that needs an arena adopts it. */
+    if( mbedtls_mutex_lock( &heap.mutex ) != 0 )
+        return;
+    ar->orphaned = 1;
+    (void) mbedtls_mutex_unlock( &heap.mutex );
+}
+
+/*
+ * Fold remotely freed blocks back into the arena. Only the critical
+ * section taking ownership of the queue is locked; the frees themselves
+ * run lock-free on the owner's context.
+ */
+static void arena_drain( memory_arena *ar )
+{
+    memory_header *hdr, *next;
+
+    if( ar->remote_head == NULL )
+        return;
+
+    if( mbedtls_mutex_lock( &ar->remote_mutex ) != 0 )
+        return;
+    hdr = ar->remote_head;
+    ar->remote_head = NULL;
+    (void) mbedtls_mutex_unlock( &ar->remote_mutex );
+
+    while( hdr != NULL )
+    {
+        next = hdr->next_free;
+        hdr->next_free = NULL;
+        buffer_alloc_free( &ar->ctx,
+                           (unsigned char *) hdr + sizeof(memory_header) );
+        hdr = next;
+    }
+}
+
+/*
+ * Return the calling thread's arena, carving a new one from the master
+ * heap on first use. Returns NULL (allocations then fall back to the
+ * mutexed master heap) if the key, slots or master memory ran out.
+ */
+static memory_arena *arena_get( void )
+{
+    memory_arena *ar;
+    unsigned char *region;
+    size_t i;
+
+    if( arena_key_valid == 0 )
+        return( NULL );
+
+    ar = (memory_arena *) pthread_getspecific( arena_key );
+    if( ar != NULL )
+        return( ar );
+
+    if( mbedtls_mutex_lock( &heap.mutex ) != 0 )
+        return( NULL );
+
+    /* Prefer adopting an arena whose owner has exited */
+    for( i = 0; i < arena_count; i++ )
+    {
+        if( arenas[i].orphaned != 0 )
+        {
+            arenas[i].orphaned = 0;
+            ar = &arenas[i];
+            break;
+        }
+    }
+
+    if( ar == NULL && arena_count < MBEDTLS_MEMORY_ARENA_MAX )
+    {
+        region = buffer_alloc_calloc( &heap, 1, MBEDTLS_MEMORY_ARENA_SIZE );
+        if( region != NULL )
+        {
+            ar = &arenas[arena_count];
+            heap_setup( &ar->ctx, region, MBEDTLS_MEMORY_ARENA_SIZE );
+            ar->ctx.verify = heap.verify;
+            ar->remote_head = NULL;
+            ar->orphaned = 0;
+            mbedtls_mutex_init( &ar->remote_mutex );
+
+            /* Publish the slot only once it is fully set up, so that
+             * lookups walking [0, arena_count) never see a half-built
+             * arena */
+            arena_count++;
+        }
+    }
+
+    (void) mbedtls_mutex_unlock( &heap.mutex );
+
+    if( ar != NULL && pthread_setspecific( arena_key, ar ) != 0 )
+        ar = NULL;
+
+    return( ar );
+}
+
+static memory_arena *arena_find_owner( unsigned char *p )
+{
+    size_t i;
+
+    for( i = 0; i < arena_count; i++ )
+    {
+        if( p >= arenas[i].ctx.buf &&
+            p <  arenas[i].ctx.buf + arenas[i].ctx.len )
+        {
+            return( &arenas[i] );
+        }
+    }
+
+    return( NULL );
+}
+#endif /* MBEDTLS_MEMORY_ARENAS */
+
 #if defined(MBEDTLS_THREADING_C)
 static void *buffer_alloc_calloc_mutexed( size_t n, size_t size )
 {
     void *buf;
+
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    memory_arena *ar = arena_get();
+
+    if( ar != NULL )
+    {
+        arena_drain( ar );
+        buf = buffer_alloc_calloc( &ar->ctx, n, size );
+        if( buf != NULL )
+            return( buf );
+        /* Arena exhausted or request too large; use the master heap */
+    }
+#endif
+
     if( mbedtls_mutex_lock( &heap.mutex ) != 0 )
         return( NULL );
-    buf = buffer_alloc_calloc( n, size );
+    buf = buffer_alloc_calloc( &heap, n, size );
     if( mbedtls_mutex_unlock( &heap.mutex ) )
         return( NULL );
     return( buf );
@@ -565,13 +875,51 @@ static void *buffer_alloc_calloc_mutexed( size_t n, size_t size )
 
 static void buffer_alloc_free_mutexed( void *ptr )
 {
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    memory_arena *owner;
+
+    if( ptr != NULL && ( owner = arena_find_owner( (unsigned char *) ptr ) )
+                       != NULL )
+    {
+        if( arena_key_valid != 0 &&
+            pthread_getspecific( arena_key ) == owner )
+        {
+            buffer_alloc_free( &owner->ctx, ptr );
+        }
+        else
+        {
+            /* Not our arena: queue the block for its owner */
+            memory_header *hdr = (memory_header *)
+                                 ( (unsigned char *) ptr
+                                   - sizeof(memory_header) );
+
+            if( mbedtls_mutex_lock( &owner->remote_mutex ) != 0 )
+                return;
+            hdr->next_free = owner->remote_head;
+            owner->remote_head = hdr;
+            (void) mbedtls_mutex_unlock( &owner->remote_mutex );
+        }
+        return;
+    }
+#endif
+
     /* We have to good option here, but corrupting the heap seems
      * worse than loosing memory. */
     if( mbedtls_mutex_lock( &heap.mutex ) )
         return;
-    buffer_alloc_free( ptr );
+    buffer_alloc_free( &heap, ptr );
     (void) mbedtls_mutex_unlock( &heap.mutex );
 }
+#else /* MBEDTLS_THREADING_C */
+static void *buffer_alloc_calloc_master( size_t n, size_t size )
+{
+    return( buffer_alloc_calloc( &heap, n, size ) );
+}
+
+static void buffer_alloc_free_master( void *ptr )
+{
+    buffer_alloc_free( &heap, ptr );
+}
 #endif /* MBEDTLS_THREADING_C */
 
 void mbedtls_memory_buffer_alloc_init( unsigned char *buf, size_t len )
@@ -584,7 +932,15 @@ void mbedtls_memory_buffer_alloc_init( unsigned char *buf, size_t len )
     mbedtls_platform_set_calloc_free( buffer_alloc_calloc_mutexed,
                               buffer_alloc_free_mutexed );
 #else
-    mbedtls_platform_set_calloc_free( buffer_alloc_calloc, buffer_alloc_free );
+    mbedtls_platform_set_calloc_free( buffer_alloc_calloc_master,
+                              buffer_alloc_free_master );
+#endif
+
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    arena_count = 0;
+    memset( arenas, 0, sizeof( arenas ) );
+    arena_key_valid = ( pthread_key_create( &arena_key,
+                                            arena_key_destructor ) == 0 );
 #endif
 
     if( (size_t) buf % MBEDTLS_MEMORY_ALIGN_MULTIPLE )
@@ -596,18 +952,24 @@ void mbedtls_memory_buffer_alloc_init( unsigned char *buf, size_t len )
              - (size_t) buf % MBEDTLS_MEMORY_ALIGN_MULTIPLE;
     }
 
-    heap.buf = buf;
-    heap.len = len;
-
-    heap.first = (memory_header *) buf;
-    heap.first->size = len - sizeof(memory_header);
-    heap.first->magic1 = MAGIC1;
-    heap.first->magic2 = MAGIC2;
-    heap.first_free = heap.first;
+    heap_setup( &heap, buf, len );
 }
 
 void mbedtls_memory_buffer_alloc_free()
 {
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    size_t i;
+
+    if( arena_key_valid != 0 )
+    {
+        (void) pthread_key_delete( arena_key );
+        arena_key_valid = 0;
+    }
+    for( i = 0; i < arena_count; i++ )
+        mbedtls_mutex_free( &arenas[i].remote_mutex );
+    arena_count = 0;
+    mbedtls_zeroize( arenas, sizeof( arenas ) );
+#endif
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_free( &heap.mutex );
 #endif
@@ -632,7 +994,9 @@ static int check_all_free( )
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.total_used != 0 ||
 #endif
-        heap.first != heap.first_free ||
+        heap.first->alloc != 0 ||
+        heap.first->next != NULL ||
+        heap.first != heap.free_bins[ bin_index( heap.first->size ) ] ||
         (void *) heap.first != (void *) heap.buf )
     {
         return( -1 );
@@ -20,6 +20,11 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+/* for recvmmsg() / sendmmsg() */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #if !defined(MBEDTLS_CONFIG_FILE)
 #include "mbedtls/config.h"
 #else
@@ -64,6 +69,7 @@ static int wsa_init_done = 0;
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -168,6 +174,113 @@ int mbedtls_net_connect( mbedtls_net_context *ctx, const char *host, const char
     return( ret );
 }
 
+/*
+ * Initiate a TCP connection with host:port without waiting for it to
+ * complete, leaving the socket non-blocking
+ */
+int mbedtls_net_connect_start( mbedtls_net_context *ctx, const char *host,
+                               const char *port, int proto )
+{
+    int ret;
+    struct addrinfo hints, *addr_list, *cur;
+
+    if( ( ret = net_prepare() ) != 0 )
+        return( ret );
+
+    /* Do name resolution with both IPv6 and IPv4 */
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = proto == MBEDTLS_NET_PROTO_UDP ? SOCK_DGRAM : SOCK_STREAM;
+    hints.ai_protocol = proto == MBEDTLS_NET_PROTO_UDP ? IPPROTO_UDP : IPPROTO_TCP;
+
+    if( getaddrinfo( host, port, &hints, &addr_list ) != 0 )
+        return( MBEDTLS_ERR_NET_UNKNOWN_HOST );
+
+    /* Try the sockaddrs until a connection succeeds or is in progress */
+    ret = MBEDTLS_ERR_NET_UNKNOWN_HOST;
+    for( cur = addr_list; cur != NULL; cur = cur->ai_next )
+    {
+        ctx->fd = (int) socket( cur->ai_family, cur->ai_socktype,
+                            cur->ai_protocol );
+        if( ctx->fd < 0 )
+        {
+            ret = MBEDTLS_ERR_NET_SOCKET_FAILED;
+            continue;
+        }
+
+        if( mbedtls_net_set_nonblock( ctx ) != 0 )
+        {
+            close( ctx->fd );
+            ctx->fd = -1;
+            ret = MBEDTLS_ERR_NET_SOCKET_FAILED;
+            continue;
+        }
+
+        if( connect( ctx->fd, cur->ai_addr, MSVC_INT_CAST cur->ai_addrlen ) == 0 )
+        {
+            ret = 0;
+            break;
+        }
+
+#if ( defined(_WIN32) || defined(_WIN32_WCE) ) && !defined(EFIX64) && \
+    !defined(EFI32)
+        if( WSAGetLastError() == WSAEWOULDBLOCK )
+#else
+        if( errno == EINPROGRESS )
+#endif
+        {
+            /* Poll the socket for writability, then call
+             * mbedtls_net_connect_finish() */
+            ret = MBEDTLS_ERR_SSL_WANT_WRITE;
+            break;
+        }
+
+        close( ctx->fd );
+        ctx->fd = -1;
+        ret = MBEDTLS_ERR_NET_CONNECT_FAILED;
+    }
+
+    freeaddrinfo( addr_list );
+
+    return( ret );
+}
+
+/*
+ * Check whether a connection started with mbedtls_net_connect_start()
+ * has completed
+ */
+int mbedtls_net_connect_finish( mbedtls_net_context *ctx )
+{
+    int err;
+    struct sockaddr_storage peer_addr;
+
+#if defined(__socklen_t_defined) || defined(_SOCKLEN_T) ||  \
+    defined(_SOCKLEN_T_DECLARED)
+    socklen_t n = (socklen_t) sizeof( peer_addr );
+    socklen_t err_len = (socklen_t) sizeof( err );
+#else
+    int n = (int) sizeof( peer_addr );
+    int err_len = (int) sizeof( err );
+#endif
+
+    if( ctx->fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    /* Connected sockets have a peer */
+    if( getpeername( ctx->fd, (struct sockaddr *) &peer_addr, &n ) == 0 )
+        return( 0 );
+
+    /* SO_ERROR is zero while the connection is still in progress */
+    if( getsockopt( ctx->fd, SOL_SOCKET, SO_ERROR,
+                    (void *) &err, &err_len ) != 0 )
+        return( MBEDTLS_ERR_NET_CONNECT_FAILED );
+
+    if( err == 0 )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+    return( MBEDTLS_ERR_NET_CONNECT_FAILED );
+}
+
 /*
  * Create a listening socket on bind_ip:port
  */
@@ -423,6 +536,108 @@ int mbedtls_net_set_nonblock( mbedtls_net_context *ctx )
 #endif
 }
 
+/*
+ * Get the underlying file descriptor
+ */
+int mbedtls_net_fd( const mbedtls_net_context *ctx )
+{
+    return( ctx->fd );
+}
+
+/*
+ * Check if data is available on the socket, or wait for it
+ */
+int mbedtls_net_poll( mbedtls_net_context *ctx, uint32_t rw, uint32_t timeout )
+{
+    int ret;
+    struct timeval tv;
+
+    fd_set read_fds;
+    fd_set write_fds;
+
+    int fd = ctx->fd;
+
+    if( fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    FD_ZERO( &read_fds );
+    if( rw & MBEDTLS_NET_POLL_READ )
+    {
+        rw &= ~MBEDTLS_NET_POLL_READ;
+        FD_SET( fd, &read_fds );
+    }
+
+    FD_ZERO( &write_fds );
+    if( rw & MBEDTLS_NET_POLL_WRITE )
+    {
+        rw &= ~MBEDTLS_NET_POLL_WRITE;
+        FD_SET( fd, &write_fds );
+    }
+
+    if( rw != 0 )
+        return( MBEDTLS_ERR_NET_BAD_INPUT_DATA );
+
+    tv.tv_sec  = timeout / 1000;
+    tv.tv_usec = ( timeout % 1000 ) * 1000;
+
+    ret = select( fd + 1, &read_fds, &write_fds, NULL,
+                  timeout == (uint32_t) -1 ? NULL : &tv );
+    if( ret < 0 )
+        return( MBEDTLS_ERR_NET_POLL_FAILED );
+
+    ret = 0;
+    if( FD_ISSET( fd, &read_fds ) )
+        ret |= MBEDTLS_NET_POLL_READ;
+    if( FD_ISSET( fd, &write_fds ) )
+        ret |= MBEDTLS_NET_POLL_WRITE;
+
+    return( ret );
+}
+
+/*
+ * Enable or disable Nagle's algorithm on a TCP socket
+ */
+int mbedtls_net_set_nodelay( mbedtls_net_context *ctx, int nodelay )
+{
+    int flag = nodelay != 0;
+
+    if( ctx->fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    if( setsockopt( ctx->fd, IPPROTO_TCP, TCP_NODELAY,
+                    (const char *) &flag, sizeof( flag ) ) != 0 )
+    {
+        return( MBEDTLS_ERR_NET_SOCKET_FAILED );
+    }
+
+    return( 0 );
+}
+
+/*
+ * Hold back (cork) or release partial TCP segments (Linux only)
+ */
+int mbedtls_net_set_cork( mbedtls_net_context *ctx, int cork )
+{
+#if defined(__linux__)
+    int flag = cork != 0;
+
+    if( ctx->fd < 0 )
+        return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+    if( setsockopt( ctx->fd, IPPROTO_TCP, TCP_CORK,
+                    (const char *) &flag, sizeof( flag ) ) != 0 )
+    {
+        return( MBEDTLS_ERR_NET_SOCKET_FAILED );
+    }
+
+    return( 0 );
+#else
+    ((void) ctx);
+    ((void) cork);
+    return( MBEDTLS_ERR_NET_SOCKET_FAILED );
+#endif
+}
+
 /*
  * Portable usleep helper
  */
@@ -559,6 +774,140 @@ int mbedtls_net_send( void *ctx, const unsigned char *buf, size_t len )
     return( ret );
 }
 
+/* Stack usage per batched datagram is one mmsghdr + one iovec,
+ * so keep a reasonable cap on the batch size */
+#define NET_MMSG_MAX    32
+
+/*
+ * Read up to 'count' datagrams in one call if the platform supports it
+ */
+int mbedtls_net_recvmmsg( void *ctx, unsigned char **bufs, size_t *lens,
+                          size_t count )
+{
+    if( count == 0 )
+        return( 0 );
+
+#if defined(__linux__)
+    {
+        int ret;
+        size_t i;
+        struct mmsghdr msgs[NET_MMSG_MAX];
+        struct iovec iovs[NET_MMSG_MAX];
+        int fd = ((mbedtls_net_context *) ctx)->fd;
+
+        if( fd < 0 )
+            return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+        if( count > NET_MMSG_MAX )
+            count = NET_MMSG_MAX;
+
+        memset( msgs, 0, count * sizeof( struct mmsghdr ) );
+        for( i = 0; i < count; i++ )
+        {
+            iovs[i].iov_base = bufs[i];
+            iovs[i].iov_len  = lens[i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        ret = recvmmsg( fd, msgs, count, 0, NULL );
+
+        if( ret < 0 )
+        {
+            if( net_would_block( ctx ) != 0 )
+                return( MBEDTLS_ERR_SSL_WANT_READ );
+
+            if( errno == EPIPE || errno == ECONNRESET )
+                return( MBEDTLS_ERR_NET_CONN_RESET );
+
+            if( errno == EINTR )
+                return( MBEDTLS_ERR_SSL_WANT_READ );
+
+            return( MBEDTLS_ERR_NET_RECV_FAILED );
+        }
+
+        for( i = 0; i < (size_t) ret; i++ )
+            lens[i] = msgs[i].msg_len;
+
+        return( ret );
+    }
+#else
+    /* No batching support: read a single datagram */
+    {
+        int ret = mbedtls_net_recv( ctx, bufs[0], lens[0] );
+
+        if( ret < 0 )
+            return( ret );
+
+        lens[0] = (size_t) ret;
+        return( 1 );
+    }
+#endif /* __linux__ */
+}
+
+/*
+ * Send up to 'count' datagrams in one call if the platform supports it
+ */
+int mbedtls_net_sendmmsg( void *ctx, const unsigned char **bufs,
+                          const size_t *lens, size_t count )
+{
+    if( count == 0 )
+        return( 0 );
+
+#if defined(__linux__)
+    {
+        int ret;
+        size_t i;
+        struct mmsghdr msgs[NET_MMSG_MAX];
+        struct iovec iovs[NET_MMSG_MAX];
+        int fd = ((mbedtls_net_context *) ctx)->fd;
+
+        if( fd < 0 )
+            return( MBEDTLS_ERR_NET_INVALID_CONTEXT );
+
+        if( count > NET_MMSG_MAX )
+            count = NET_MMSG_MAX;
+
+        memset( msgs, 0, count * sizeof( struct mmsghdr ) );
+        for( i = 0; i < count; i++ )
+        {
+            iovs[i].iov_base = (void *) bufs[i];
+            iovs[i].iov_len  = lens[i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        ret = sendmmsg( fd, msgs, count, 0 );
+
+        if( ret < 0 )
+        {
+            if( net_would_block( ctx ) != 0 )
+                return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+            if( errno == EPIPE || errno == ECONNRESET )
+                return( MBEDTLS_ERR_NET_CONN_RESET );
+
+            if( errno == EINTR )
+                return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+            return( MBEDTLS_ERR_NET_SEND_FAILED );
+        }
+
+        return( ret );
+    }
+#else
+    /* No batching support: send a single datagram */
+    {
+        int ret = mbedtls_net_send( ctx, bufs[0], lens[0] );
+
+        if( ret < 0 )
+            return( ret );
+
+        return( 1 );
+    }
+#endif /* __linux__ */
+}
+
 /*
  * Gracefully close the connection
  */
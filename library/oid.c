@@ -54,16 +54,33 @@
 /*
  * Macro to generate an internal function for oid_XXX_from_asn1() (used by
  * the other functions)
+ *
+ * Each generated function keeps a one-element cache of its last successful
+ * lookup: certificate parsing asks for the same handful of OIDs over and
+ * over. The cached pointer is read into a local and fully re-validated
+ * against the queried OID before use, so a concurrent update can at worst
+ * cause one extra table scan, never a wrong answer. During the scan, OIDs
+ * within one table mostly differ only in their last byte (shared prefixes),
+ * so that byte is compared before the full memcmp().
  */
 #define FN_OID_TYPED_FROM_ASN1( TYPE_T, NAME, LIST )                        \
 static const TYPE_T * oid_ ## NAME ## _from_asn1( const mbedtls_asn1_buf *oid )     \
 {                                                                           \
+    static const TYPE_T *mru = NULL;                                        \
     const TYPE_T *p = LIST;                                                 \
-    const mbedtls_oid_descriptor_t *cur = (const mbedtls_oid_descriptor_t *) p;             \
-    if( p == NULL || oid == NULL ) return( NULL );                          \
+    const TYPE_T *hit = mru;                                                \
+    const mbedtls_oid_descriptor_t *cur = (const mbedtls_oid_descriptor_t *) hit;           \
+    if( p == NULL || oid == NULL || oid->len == 0 ) return( NULL );         \
+    if( hit != NULL && cur->asn1_len == oid->len &&                         \
+        memcmp( cur->asn1, oid->p, oid->len ) == 0 ) {                      \
+        return( hit );                                                      \
+    }                                                                       \
+    cur = (const mbedtls_oid_descriptor_t *) p;                             \
     while( cur->asn1 != NULL ) {                                            \
         if( cur->asn1_len == oid->len &&                                    \
+            (unsigned char) cur->asn1[oid->len - 1] == oid->p[oid->len - 1] && \
             memcmp( cur->asn1, oid->p, oid->len ) == 0 ) {                  \
+            mru = p;                                                        \
             return( p );                                                    \
         }                                                                   \
         p++;                                                                \
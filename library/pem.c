@@ -45,10 +45,7 @@
 #define mbedtls_free       free
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 #if defined(MBEDTLS_PEM_PARSE_C)
 void mbedtls_pem_init( mbedtls_pem_context *ctx )
@@ -209,7 +206,7 @@ int mbedtls_pem_read_buffer( mbedtls_pem_context *ctx, const char *header, const
                      size_t pwdlen, size_t *use_len )
 {
     int ret, enc;
-    size_t len;
+    size_t len, buf_size;
     unsigned char *buf;
     const unsigned char *s1, *s2, *end;
 #if defined(MBEDTLS_MD5_C) && defined(MBEDTLS_CIPHER_MODE_CBC) &&         \
@@ -317,15 +314,18 @@ int mbedtls_pem_read_buffer( mbedtls_pem_context *ctx, const char *header, const
           ( MBEDTLS_AES_C || MBEDTLS_DES_C ) */
     }
 
-    ret = mbedtls_base64_decode( NULL, 0, &len, s1, s2 - s1 );
-
-    if( ret == MBEDTLS_ERR_BASE64_INVALID_CHARACTER )
-        return( MBEDTLS_ERR_PEM_INVALID_DATA + ret );
+    /*
+     * Single decoding pass into a buffer sized from the base64 length:
+     * at most three output bytes per four input characters (newlines
+     * only make this bound more generous)
+     */
+    buf_size = ( ( s2 - s1 ) / 4 + 1 ) * 3;
 
-    if( ( buf = mbedtls_calloc( 1, len ) ) == NULL )
+    if( ( buf = mbedtls_calloc( 1, buf_size ) ) == NULL )
         return( MBEDTLS_ERR_PEM_ALLOC_FAILED );
 
-    if( ( ret = mbedtls_base64_decode( buf, len, &len, s1, s2 - s1 ) ) != 0 )
+    len = 0;
+    if( ( ret = mbedtls_base64_decode( buf, buf_size, &len, s1, s2 - s1 ) ) != 0 )
     {
         mbedtls_free( buf );
         return( MBEDTLS_ERR_PEM_INVALID_DATA + ret );
@@ -396,8 +396,8 @@ int mbedtls_pem_write_buffer( const char *header, const char *footer,
                       unsigned char *buf, size_t buf_len, size_t *olen )
 {
     int ret;
-    unsigned char *encode_buf, *c, *p = buf;
-    size_t len = 0, use_len, add_len = 0;
+    unsigned char *p = buf;
+    size_t use_len, add_len = 0, line_in, line_out;
 
     mbedtls_base64_encode( NULL, 0, &use_len, der_data, der_len );
     add_len = strlen( header ) + strlen( footer ) + ( use_len / 64 ) + 1;
@@ -408,27 +408,27 @@ int mbedtls_pem_write_buffer( const char *header, const char *footer,
         return( MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL );
     }
 
-    if( ( encode_buf = mbedtls_calloc( 1, use_len ) ) == NULL )
-        return( MBEDTLS_ERR_PEM_ALLOC_FAILED );
-
-    if( ( ret = mbedtls_base64_encode( encode_buf, use_len, &use_len, der_data,
-                               der_len ) ) != 0 )
-    {
-        mbedtls_free( encode_buf );
-        return( ret );
-    }
-
     memcpy( p, header, strlen( header ) );
     p += strlen( header );
-    c = encode_buf;
 
-    while( use_len )
+    /*
+     * Encode 48 input bytes per 64-character line straight into the
+     * output buffer: single pass over the DER, no intermediate copy.
+     * The terminating nul each call writes is overwritten by the line
+     * break (or by the footer for the last line).
+     */
+    while( der_len > 0 )
     {
-        len = ( use_len > 64 ) ? 64 : use_len;
-        memcpy( p, c, len );
-        use_len -= len;
-        p += len;
-        c += len;
+        line_in = ( der_len > 48 ) ? 48 : der_len;
+
+        if( ( ret = mbedtls_base64_encode( p, buf_len - (size_t)( p - buf ),
+                                           &line_out, der_data,
+                                           line_in ) ) != 0 )
+            return( ret );
+
+        der_data += line_in;
+        der_len -= line_in;
+        p += line_out;
         *p++ = '\n';
     }
 
@@ -438,7 +438,6 @@ int mbedtls_pem_write_buffer( const char *header, const char *footer,
     *p++ = '\0';
     *olen = p - buf;
 
-    mbedtls_free( encode_buf );
     return( 0 );
 }
 #endif /* MBEDTLS_PEM_WRITE_C */
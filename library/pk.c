@@ -40,10 +40,7 @@
 #include "mbedtls/ecdsa.h"
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * Initialise a mbedtls_pk_context
@@ -262,6 +259,103 @@ int mbedtls_pk_sign( mbedtls_pk_context *ctx, mbedtls_md_type_t md_alg,
                                      sig, sig_len, f_rng, p_rng ) );
 }
 
+/*
+ * Initialize an asynchronous signature context
+ */
+void mbedtls_pk_async_init( mbedtls_pk_async *ctx )
+{
+    mbedtls_zeroize( ctx, sizeof( mbedtls_pk_async ) );
+}
+
+/*
+ * Start making a signature
+ */
+int mbedtls_pk_sign_start( mbedtls_pk_async *ctx, mbedtls_pk_context *pk,
+                           mbedtls_md_type_t md_alg,
+                           const unsigned char *hash, size_t hash_len,
+                           int (*f_rng)(void *, unsigned char *, size_t),
+                           void *p_rng )
+{
+    int ret;
+
+    if( ctx == NULL || ctx->pk != NULL ||
+        pk == NULL || pk->pk_info == NULL ||
+        pk_hashlen_helper( md_alg, &hash_len ) != 0 )
+        return( MBEDTLS_ERR_PK_BAD_INPUT_DATA );
+
+    if( pk->pk_info->sign_start_func != NULL )
+    {
+        if( pk->pk_info->sign_poll_func == NULL )
+            return( MBEDTLS_ERR_PK_TYPE_MISMATCH );
+
+        if( ( ret = pk->pk_info->sign_start_func( pk->pk_ctx, md_alg,
+                        hash, hash_len, f_rng, p_rng, &ctx->op_ctx ) ) != 0 )
+            return( ret );
+    }
+    else
+    {
+        if( pk->pk_info->sign_func == NULL )
+            return( MBEDTLS_ERR_PK_TYPE_MISMATCH );
+
+        /* No engine support: keep the parameters for the first poll */
+        ctx->md_alg = md_alg;
+        ctx->hash = hash;
+        ctx->hash_len = hash_len;
+        ctx->f_rng = f_rng;
+        ctx->p_rng = p_rng;
+    }
+
+    ctx->pk = pk;
+
+    return( 0 );
+}
+
+/*
+ * Collect the result of a started signature
+ */
+int mbedtls_pk_sign_poll( mbedtls_pk_async *ctx,
+                          unsigned char *sig, size_t *sig_len )
+{
+    int ret;
+
+    if( ctx == NULL || ctx->pk == NULL )
+        return( MBEDTLS_ERR_PK_BAD_INPUT_DATA );
+
+    if( ctx->pk->pk_info->sign_start_func != NULL )
+    {
+        ret = ctx->pk->pk_info->sign_poll_func( ctx->pk->pk_ctx, ctx->op_ctx,
+                                                sig, sig_len );
+        if( ret == MBEDTLS_ERR_PK_IN_PROGRESS )
+            return( ret );
+    }
+    else
+    {
+        ret = ctx->pk->pk_info->sign_func( ctx->pk->pk_ctx, ctx->md_alg,
+                                           ctx->hash, ctx->hash_len,
+                                           sig, sig_len,
+                                           ctx->f_rng, ctx->p_rng );
+    }
+
+    /* Finished, successfully or not: the context is idle again */
+    mbedtls_zeroize( ctx, sizeof( mbedtls_pk_async ) );
+
+    return( ret );
+}
+
+/*
+ * Cancel a pending signature operation
+ */
+void mbedtls_pk_sign_cancel( mbedtls_pk_async *ctx )
+{
+    if( ctx == NULL || ctx->pk == NULL )
+        return;
+
+    if( ctx->pk->pk_info->sign_cancel_func != NULL )
+        ctx->pk->pk_info->sign_cancel_func( ctx->pk->pk_ctx, ctx->op_ctx );
+
+    mbedtls_zeroize( ctx, sizeof( mbedtls_pk_async ) );
+}
+
 /*
  * Decrypt message
  */
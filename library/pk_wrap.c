@@ -51,10 +51,7 @@
 #endif
 
 #if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 #endif
 
 #if defined(MBEDTLS_RSA_C)
@@ -174,6 +171,9 @@ const mbedtls_pk_info_t mbedtls_rsa_info = {
     rsa_alloc_wrap,
     rsa_free_wrap,
     rsa_debug,
+    NULL,               /* sign_start_func */
+    NULL,               /* sign_poll_func */
+    NULL,               /* sign_cancel_func */
 };
 #endif /* MBEDTLS_RSA_C */
 
@@ -289,6 +289,9 @@ const mbedtls_pk_info_t mbedtls_eckey_info = {
     eckey_alloc_wrap,
     eckey_free_wrap,
     eckey_debug,
+    NULL,               /* sign_start_func */
+    NULL,               /* sign_poll_func */
+    NULL,               /* sign_cancel_func */
 };
 
 /*
@@ -313,6 +316,9 @@ const mbedtls_pk_info_t mbedtls_eckeydh_info = {
     eckey_alloc_wrap,       /* Same underlying key structure */
     eckey_free_wrap,        /* Same underlying key structure */
     eckey_debug,            /* Same underlying key structure */
+    NULL,               /* sign_start_func */
+    NULL,               /* sign_poll_func */
+    NULL,               /* sign_cancel_func */
 };
 #endif /* MBEDTLS_ECP_C */
 
@@ -376,6 +382,9 @@ const mbedtls_pk_info_t mbedtls_ecdsa_info = {
     ecdsa_alloc_wrap,
     ecdsa_free_wrap,
     eckey_debug,        /* Compatible key structures */
+    NULL,               /* sign_start_func */
+    NULL,               /* sign_poll_func */
+    NULL,               /* sign_cancel_func */
 };
 #endif /* MBEDTLS_ECDSA_C */
 
@@ -489,6 +498,9 @@ const mbedtls_pk_info_t mbedtls_rsa_alt_info = {
     rsa_alt_alloc_wrap,
     rsa_alt_free_wrap,
     NULL,
+    NULL,               /* sign_start_func */
+    NULL,               /* sign_poll_func */
+    NULL,               /* sign_cancel_func */
 };
 
 #endif /* MBEDTLS_PK_RSA_ALT_SUPPORT */
@@ -0,0 +1,419 @@
+/*
+ *  Poly1305 one-time message authenticator
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *  Poly1305 was designed by Daniel J. Bernstein; the variant keyed per
+ *  message from a cipher keystream implemented here is the one specified
+ *  in RFC 7539. The accumulator is kept in 32-bit limbs with 64-bit
+ *  products, with only a partial reduction inside the block loop.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_POLY1305_C)
+
+#include "mbedtls/poly1305.h"
+#include "mbedtls/constant_time.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_SELF_TEST)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf printf
+#endif /* MBEDTLS_PLATFORM_C */
+#endif /* MBEDTLS_SELF_TEST */
+
+#include "mbedtls/byte_order.h"
+
+#define POLY1305_BLOCK_SIZE_BYTES ( 16U )
+
+/*
+ * Process whole 16-byte blocks: acc = ( acc + block ) * r mod 2^130 - 5,
+ * leaving the accumulator only partially reduced (acc4 may exceed 3;
+ * the full reduction happens in poly1305_compute_mac).
+ *
+ * needs_padding is 1 for complete message blocks (the implied 2^128 pad
+ * bit) and 0 for the final zero-padded partial block, whose pad byte is
+ * already part of the data.
+ */
+static void poly1305_process( mbedtls_poly1305_context *ctx,
+                              size_t nblocks,
+                              const unsigned char *input,
+                              uint32_t needs_padding )
+{
+    uint64_t d0, d1, d2, d3;
+    uint32_t acc0, acc1, acc2, acc3, acc4;
+    uint32_t r0, r1, r2, r3;
+    uint32_t rs1, rs2, rs3;
+    size_t offset = 0;
+    size_t i;
+
+    r0 = ctx->r[0];
+    r1 = ctx->r[1];
+    r2 = ctx->r[2];
+    r3 = ctx->r[3];
+
+    /* r1..r3 have their low 2 bits cleared, so ( r >> 2 ) * 5 is r + r >> 2 */
+    rs1 = r1 + ( r1 >> 2U );
+    rs2 = r2 + ( r2 >> 2U );
+    rs3 = r3 + ( r3 >> 2U );
+
+    acc0 = ctx->acc[0];
+    acc1 = ctx->acc[1];
+    acc2 = ctx->acc[2];
+    acc3 = ctx->acc[3];
+    acc4 = ctx->acc[4];
+
+    for( i = 0; i < nblocks; i++ )
+    {
+        uint32_t b0, b1, b2, b3;
+
+        GET_UINT32_LE( b0, input, offset +  0 );
+        GET_UINT32_LE( b1, input, offset +  4 );
+        GET_UINT32_LE( b2, input, offset +  8 );
+        GET_UINT32_LE( b3, input, offset + 12 );
+
+        /* acc += block (treated as a 130-bit little-endian integer) */
+        d0 = (uint64_t) acc0 + b0;
+        d1 = (uint64_t) acc1 + b1 + ( d0 >> 32U );
+        d2 = (uint64_t) acc2 + b2 + ( d1 >> 32U );
+        d3 = (uint64_t) acc3 + b3 + ( d2 >> 32U );
+        acc0 = (uint32_t) d0;
+        acc1 = (uint32_t) d1;
+        acc2 = (uint32_t) d2;
+        acc3 = (uint32_t) d3;
+        acc4 += (uint32_t) ( d3 >> 32U ) + needs_padding;
+
+        /* acc *= r, folding the limbs above 2^130 back in times 5 */
+        d0 = ( (uint64_t) acc0 * r0  ) +
+             ( (uint64_t) acc1 * rs3 ) +
+             ( (uint64_t) acc2 * rs2 ) +
+             ( (uint64_t) acc3 * rs1 );
+        d1 = ( (uint64_t) acc0 * r1  ) +
+             ( (uint64_t) acc1 * r0  ) +
+             ( (uint64_t) acc2 * rs3 ) +
+             ( (uint64_t) acc3 * rs2 ) +
+             ( (uint64_t) acc4 * rs1 );
+        d2 = ( (uint64_t) acc0 * r2  ) +
+             ( (uint64_t) acc1 * r1  ) +
+             ( (uint64_t) acc2 * r0  ) +
+             ( (uint64_t) acc3 * rs3 ) +
+             ( (uint64_t) acc4 * rs2 );
+        d3 = ( (uint64_t) acc0 * r3  ) +
+             ( (uint64_t) acc1 * r2  ) +
+             ( (uint64_t) acc2 * r1  ) +
+             ( (uint64_t) acc3 * r0  ) +
+             ( (uint64_t) acc4 * rs3 );
+        acc4 *= r0;
+
+        /* Propagate carries */
+        d1 += ( d0 >> 32U );
+        d2 += ( d1 >> 32U );
+        d3 += ( d2 >> 32U );
+        acc0 = (uint32_t) d0;
+        acc1 = (uint32_t) d1;
+        acc2 = (uint32_t) d2;
+        acc3 = (uint32_t) d3;
+        acc4 = (uint32_t) ( d3 >> 32U ) + acc4;
+
+        /* Partial reduction mod 2^130 - 5 */
+        d0 = (uint64_t) acc0 + ( acc4 >> 2U ) + ( acc4 & 0xFFFFFFFCU );
+        acc4 &= 3U;
+        acc0 = (uint32_t) d0;
+        d0 = (uint64_t) acc1 + ( d0 >> 32U );
+        acc1 = (uint32_t) d0;
+        d0 = (uint64_t) acc2 + ( d0 >> 32U );
+        acc2 = (uint32_t) d0;
+        d0 = (uint64_t) acc3 + ( d0 >> 32U );
+        acc3 = (uint32_t) d0;
+        acc4 += (uint32_t) ( d0 >> 32U );
+
+        offset += POLY1305_BLOCK_SIZE_BYTES;
+    }
+
+    ctx->acc[0] = acc0;
+    ctx->acc[1] = acc1;
+    ctx->acc[2] = acc2;
+    ctx->acc[3] = acc3;
+    ctx->acc[4] = acc4;
+}
+
+/*
+ * Fully reduce the accumulator, add s and write out the authenticator
+ */
+static void poly1305_compute_mac( mbedtls_poly1305_context *ctx,
+                                  unsigned char mac[16] )
+{
+    uint64_t d;
+    uint32_t g0, g1, g2, g3, g4;
+    uint32_t acc0, acc1, acc2, acc3;
+    uint32_t mask, mask_inv;
+
+    acc0 = ctx->acc[0];
+    acc1 = ctx->acc[1];
+    acc2 = ctx->acc[2];
+    acc3 = ctx->acc[3];
+
+    /*
+     * Compute g = acc - ( 2^130 - 5 ) by adding 5 and checking whether
+     * bit 130 carries out; select acc or g in constant time
+     */
+    d  = (uint64_t) acc0 + 5U;
+    g0 = (uint32_t) d;
+    d  = (uint64_t) acc1 + ( d >> 32U );
+    g1 = (uint32_t) d;
+    d  = (uint64_t) acc2 + ( d >> 32U );
+    g2 = (uint32_t) d;
+    d  = (uint64_t) acc3 + ( d >> 32U );
+    g3 = (uint32_t) d;
+    g4 = ctx->acc[4] + (uint32_t) ( d >> 32U );
+
+    mask = (uint32_t) 0U - ( g4 >> 2U );
+    mask_inv = ~mask;
+
+    acc0 = ( acc0 & mask_inv ) | ( g0 & mask );
+    acc1 = ( acc1 & mask_inv ) | ( g1 & mask );
+    acc2 = ( acc2 & mask_inv ) | ( g2 & mask );
+    acc3 = ( acc3 & mask_inv ) | ( g3 & mask );
+
+    /* acc += s, dropping the final carry (mod 2^128) */
+    d = (uint64_t) acc0 + ctx->s[0];
+    acc0 = (uint32_t) d;
+    d = (uint64_t) acc1 + ctx->s[1] + ( d >> 32U );
+    acc1 = (uint32_t) d;
+    d = (uint64_t) acc2 + ctx->s[2] + ( d >> 32U );
+    acc2 = (uint32_t) d;
+    acc3 += ctx->s[3] + (uint32_t) ( d >> 32U );
+
+    PUT_UINT32_LE( acc0, mac,  0 );
+    PUT_UINT32_LE( acc1, mac,  4 );
+    PUT_UINT32_LE( acc2, mac,  8 );
+    PUT_UINT32_LE( acc3, mac, 12 );
+}
+
+void mbedtls_poly1305_init( mbedtls_poly1305_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    memset( ctx, 0, sizeof( mbedtls_poly1305_context ) );
+}
+
+void mbedtls_poly1305_free( mbedtls_poly1305_context *ctx )
+{
+    if( ctx == NULL )
+        return;
+
+    mbedtls_zeroize( ctx, sizeof( mbedtls_poly1305_context ) );
+}
+
+int mbedtls_poly1305_starts( mbedtls_poly1305_context *ctx,
+                             const unsigned char key[32] )
+{
+    if( ctx == NULL || key == NULL )
+        return( MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA );
+
+    /* r is clamped as mandated by the RFC */
+    GET_UINT32_LE( ctx->r[0], key,  0 );
+    GET_UINT32_LE( ctx->r[1], key,  4 );
+    GET_UINT32_LE( ctx->r[2], key,  8 );
+    GET_UINT32_LE( ctx->r[3], key, 12 );
+    ctx->r[0] &= 0x0FFFFFFF;
+    ctx->r[1] &= 0x0FFFFFFC;
+    ctx->r[2] &= 0x0FFFFFFC;
+    ctx->r[3] &= 0x0FFFFFFC;
+
+    GET_UINT32_LE( ctx->s[0], key, 16 );
+    GET_UINT32_LE( ctx->s[1], key, 20 );
+    GET_UINT32_LE( ctx->s[2], key, 24 );
+    GET_UINT32_LE( ctx->s[3], key, 28 );
+
+    ctx->acc[0] = 0;
+    ctx->acc[1] = 0;
+    ctx->acc[2] = 0;
+    ctx->acc[3] = 0;
+    ctx->acc[4] = 0;
+    ctx->queue_len = 0;
+
+    return( 0 );
+}
+
+int mbedtls_poly1305_update( mbedtls_poly1305_context *ctx,
+                             const unsigned char *input,
+                             size_t ilen )
+{
+    size_t offset = 0;
+    size_t remaining = ilen;
+    size_t queue_free_len;
+    size_t nblocks;
+
+    if( ctx == NULL || ( ilen != 0 && input == NULL ) )
+        return( MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA );
+
+    if( ctx->queue_len > 0 )
+    {
+        queue_free_len = POLY1305_BLOCK_SIZE_BYTES - ctx->queue_len;
+
+        if( ilen < queue_free_len )
+        {
+            /* Not enough for a full block, just queue the data */
+            memcpy( &ctx->queue[ctx->queue_len], input, ilen );
+            ctx->queue_len += ilen;
+
+            return( 0 );
+        }
+
+        memcpy( &ctx->queue[ctx->queue_len], input, queue_free_len );
+        ctx->queue_len = 0;
+
+        poly1305_process( ctx, 1, ctx->queue, 1 );
+
+        offset += queue_free_len;
+        remaining -= queue_free_len;
+    }
+
+    nblocks = remaining / POLY1305_BLOCK_SIZE_BYTES;
+    if( nblocks > 0 )
+    {
+        poly1305_process( ctx, nblocks, &input[offset], 1 );
+
+        offset += nblocks * POLY1305_BLOCK_SIZE_BYTES;
+        remaining %= POLY1305_BLOCK_SIZE_BYTES;
+    }
+
+    if( remaining > 0 )
+    {
+        memcpy( ctx->queue, &input[offset], remaining );
+        ctx->queue_len = remaining;
+    }
+
+    return( 0 );
+}
+
+int mbedtls_poly1305_finish( mbedtls_poly1305_context *ctx,
+                             unsigned char mac[16] )
+{
+    if( ctx == NULL || mac == NULL )
+        return( MBEDTLS_ERR_POLY1305_BAD_INPUT_DATA );
+
+    /* The last partial block is padded with 0x01 then zeros */
+    if( ctx->queue_len > 0 )
+    {
+        ctx->queue[ctx->queue_len] = 1;
+        memset( &ctx->queue[ctx->queue_len + 1], 0,
+                POLY1305_BLOCK_SIZE_BYTES - ctx->queue_len - 1 );
+
+        poly1305_process( ctx, 1, ctx->queue, 0 );
+        ctx->queue_len = 0;
+    }
+
+    poly1305_compute_mac( ctx, mac );
+
+    return( 0 );
+}
+
+int mbedtls_poly1305_mac( const unsigned char key[32],
+                          const unsigned char *input,
+                          size_t ilen,
+                          unsigned char mac[16] )
+{
+    mbedtls_poly1305_context ctx;
+    int ret;
+
+    mbedtls_poly1305_init( &ctx );
+
+    if( ( ret = mbedtls_poly1305_starts( &ctx, key ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_poly1305_update( &ctx, input, ilen ) ) != 0 )
+        goto cleanup;
+
+    ret = mbedtls_poly1305_finish( &ctx, mac );
+
+cleanup:
+    mbedtls_poly1305_free( &ctx );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_SELF_TEST)
+
+/*
+ * Test vector from RFC 7539, section 2.5.2
+ */
+static const unsigned char test_key[32] =
+{
+    0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33,
+    0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+    0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+    0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+};
+
+static const unsigned char test_data[34] =
+{
+    0x43, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x67, 0x72,
+    0x61, 0x70, 0x68, 0x69, 0x63, 0x20, 0x46, 0x6f,
+    0x72, 0x75, 0x6d, 0x20, 0x52, 0x65, 0x73, 0x65,
+    0x61, 0x72, 0x63, 0x68, 0x20, 0x47, 0x72, 0x6f,
+    0x75, 0x70
+};
+
+static const unsigned char test_mac[16] =
+{
+    0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6,
+    0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9
+};
+
+int mbedtls_poly1305_self_test( int verbose )
+{
+    unsigned char mac[16];
+    int ret;
+
+    if( verbose != 0 )
+        mbedtls_printf( "  POLY1305 test #1: " );
+
+    ret = mbedtls_poly1305_mac( test_key, test_data,
+                                sizeof( test_data ), mac );
+
+    if( ret != 0 || memcmp( mac, test_mac, sizeof( test_mac ) ) != 0 )
+    {
+        if( verbose != 0 )
+            mbedtls_printf( "failed\n" );
+
+        return( 1 );
+    }
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n\n" );
+
+    return( 0 );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
+
+#endif /* MBEDTLS_POLY1305_C */
@@ -36,6 +36,11 @@
 
 #include "mbedtls/rsa.h"
 #include "mbedtls/oid.h"
+#include "mbedtls/constant_time.h"
+
+#if defined(MBEDTLS_TIMING_TRACE)
+#include "mbedtls/timing.h"
+#endif
 
 #include <string.h>
 
@@ -361,6 +366,61 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Compute RR = R^2 mod N, with R = 2^(biL * N->n), matching the value
+ * that mbedtls_mpi_exp_mod() computes and caches on first use
+ */
+static int rsa_precompute_rr( mbedtls_mpi *RR, const mbedtls_mpi *N )
+{
+    int ret;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( RR, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( RR, N->n * 2 * ( sizeof( mbedtls_mpi_uint ) << 3 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( RR, RR, N ) );
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Precompute the helper values otherwise filled in lazily by the first
+ * public or private operation on the context
+ */
+int mbedtls_rsa_precompute( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng )
+{
+    int ret;
+
+    if( mbedtls_mpi_cmp_int( &ctx->N, 0 ) == 0 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    if( ctx->len == 0 )
+        ctx->len = mbedtls_mpi_size( &ctx->N );
+
+    MBEDTLS_MPI_CHK( rsa_precompute_rr( &ctx->RN, &ctx->N ) );
+
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    if( mbedtls_mpi_cmp_int( &ctx->P, 0 ) != 0 &&
+        mbedtls_mpi_cmp_int( &ctx->Q, 0 ) != 0 )
+    {
+        MBEDTLS_MPI_CHK( rsa_precompute_rr( &ctx->RP, &ctx->P ) );
+        MBEDTLS_MPI_CHK( rsa_precompute_rr( &ctx->RQ, &ctx->Q ) );
+    }
+#endif
+
+    /*
+     * Seed the blinding values too if we can: rsa_prepare_blinding() will
+     * then only have to do the cheap squaring update per operation
+     */
+    if( f_rng != NULL && mbedtls_mpi_cmp_int( &ctx->D, 0 ) != 0 )
+        MBEDTLS_MPI_CHK( rsa_prepare_blinding( ctx, &ctx->Vi, &ctx->Vf,
+                                               f_rng, p_rng ) );
+
+cleanup:
+    return( ret );
+}
+
 /*
  * Do an RSA private key operation
  */
@@ -374,6 +434,9 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
     size_t olen;
     mbedtls_mpi T, T1, T2;
     mbedtls_mpi *Vi, *Vf;
+#if defined(MBEDTLS_TIMING_TRACE)
+    unsigned long trace_start = mbedtls_timing_hardclock();
+#endif
 
     /*
      * When using the Chinese Remainder Theorem, we use blinding values.
@@ -463,12 +526,142 @@ cleanup:
 #endif
     mbedtls_mpi_free( &T ); mbedtls_mpi_free( &T1 ); mbedtls_mpi_free( &T2 );
 
+#if defined(MBEDTLS_TIMING_TRACE)
+    mbedtls_timing_trace( MBEDTLS_TIMING_TRACE_RSA_PRIVATE,
+                          mbedtls_timing_hardclock() - trace_start );
+#endif
+
     if( ret != 0 )
         return( MBEDTLS_ERR_RSA_PRIVATE_FAILED + ret );
 
     return( 0 );
 }
 
+/*
+ * Do a batch of RSA private key operations on contiguous blocks
+ */
+int mbedtls_rsa_private_batch( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng,
+                 size_t n_ops,
+                 const unsigned char *input,
+                 unsigned char *output )
+{
+    int ret = 0;
+    size_t i, olen;
+    mbedtls_mpi T, T1, T2;
+    mbedtls_mpi *Vi, *Vf;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mpi Vi_copy, Vf_copy;
+
+    mbedtls_mpi_init( &Vi_copy ); mbedtls_mpi_init( &Vf_copy );
+    Vi = &Vi_copy;
+    Vf = &Vf_copy;
+#else
+    Vi = &ctx->Vi;
+    Vf = &ctx->Vf;
+#endif
+
+    mbedtls_mpi_init( &T ); mbedtls_mpi_init( &T1 ); mbedtls_mpi_init( &T2 );
+
+    if( n_ops == 0 )
+        goto cleanup;
+
+    /*
+     * One blinding update for the whole batch; the values are then
+     * refreshed locally by squaring between operations
+     */
+    if( f_rng != NULL )
+        MBEDTLS_MPI_CHK( rsa_prepare_blinding( ctx, Vi, Vf, f_rng, p_rng ) );
+
+    /*
+     * Fill the Montgomery caches under the mutex once, so that the
+     * exponentiations below only read them and can run unlocked
+     */
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    if( ctx->RN.p == NULL )
+        ret = rsa_precompute_rr( &ctx->RN, &ctx->N );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    if( ret == 0 && ctx->RP.p == NULL )
+        ret = rsa_precompute_rr( &ctx->RP, &ctx->P );
+    if( ret == 0 && ctx->RQ.p == NULL )
+        ret = rsa_precompute_rr( &ctx->RQ, &ctx->Q );
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_unlock( &ctx->mutex ) ) != 0 )
+        goto cleanup;
+#endif
+
+    if( ret != 0 )
+        goto cleanup;
+
+    olen = ctx->len;
+
+    for( i = 0; i < n_ops; i++, input += olen, output += olen )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &T, input, olen ) );
+        if( mbedtls_mpi_cmp_mpi( &T, &ctx->N ) >= 0 )
+        {
+            ret = MBEDTLS_ERR_RSA_BAD_INPUT_DATA;
+            goto cleanup;
+        }
+
+        if( f_rng != NULL )
+        {
+            if( i != 0 )
+            {
+                /* Refresh the local blinding pair by squaring */
+                MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( Vi, Vi, Vi ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( Vi, Vi, &ctx->N ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( Vf, Vf, Vf ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( Vf, Vf, &ctx->N ) );
+            }
+
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, Vi ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T, &ctx->N ) );
+        }
+
+#if defined(MBEDTLS_RSA_NO_CRT)
+        MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &T, &T, &ctx->D, &ctx->N, &ctx->RN ) );
+#else
+        MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &T1, &T, &ctx->DP, &ctx->P, &ctx->RP ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &T2, &T, &ctx->DQ, &ctx->Q, &ctx->RQ ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &T, &T1, &T2 ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T1, &T, &ctx->QP ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T1, &ctx->P ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T1, &T, &ctx->Q ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &T, &T2, &T1 ) );
+#endif /* MBEDTLS_RSA_NO_CRT */
+
+        if( f_rng != NULL )
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, Vf ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T, &ctx->N ) );
+        }
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &T, output, olen ) );
+    }
+
+cleanup:
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mpi_free( &Vi_copy ); mbedtls_mpi_free( &Vf_copy );
+#endif
+    mbedtls_mpi_free( &T ); mbedtls_mpi_free( &T1 ); mbedtls_mpi_free( &T2 );
+
+    if( ret != 0 && ret != MBEDTLS_ERR_RSA_BAD_INPUT_DATA )
+        return( MBEDTLS_ERR_RSA_PRIVATE_FAILED + ret );
+
+    return( ret );
+}
+
 #if defined(MBEDTLS_PKCS1_V21)
 /**
  * Generate and apply the MGF1 operation (from PKCS#1 v2.1) to a buffer.
@@ -516,6 +709,82 @@ static void mgf_mask( unsigned char *dst, size_t dlen, unsigned char *src,
         dlen -= use_len;
     }
 }
+
+/*
+ * Get a digest context for MGF1 and PSS/OAEP hashing. Without threading
+ * the context is cached inside the RSA context, so repeated operations
+ * skip the per-call setup; with threading enabled a shared cache would
+ * race between concurrent operations on the same key, so a per-call
+ * context is used instead.
+ */
+static int rsa_md_ctx_acquire( mbedtls_rsa_context *ctx,
+                               const mbedtls_md_info_t *md_info,
+                               mbedtls_md_context_t *local,
+                               mbedtls_md_context_t **md_ctx )
+{
+    int ret;
+
+#if defined(MBEDTLS_THREADING_C)
+    ((void) ctx);
+
+    mbedtls_md_init( local );
+    if( ( ret = mbedtls_md_setup( local, md_info, 0 ) ) != 0 )
+        return( ret );
+
+    *md_ctx = local;
+#else
+    ((void) local);
+
+    if( ctx->mgf_ctx.md_info != md_info )
+    {
+        mbedtls_md_free( &ctx->mgf_ctx );
+        mbedtls_md_init( &ctx->mgf_ctx );
+        if( ( ret = mbedtls_md_setup( &ctx->mgf_ctx, md_info, 0 ) ) != 0 )
+            return( ret );
+
+        ctx->lhash_set = 0;
+    }
+
+    *md_ctx = &ctx->mgf_ctx;
+#endif
+
+    return( 0 );
+}
+
+static void rsa_md_ctx_release( mbedtls_md_context_t *local,
+                                mbedtls_md_context_t *md_ctx )
+{
+    if( md_ctx == local )
+        mbedtls_md_free( local );
+}
+
+/*
+ * Hash the OAEP label; the hash of the (common) empty label is cached
+ * in the RSA context alongside the cached digest context
+ */
+static void rsa_oaep_lhash( mbedtls_rsa_context *ctx,
+                            const mbedtls_md_info_t *md_info,
+                            const unsigned char *label, size_t label_len,
+                            unsigned char *out )
+{
+#if !defined(MBEDTLS_THREADING_C)
+    if( label_len == 0 && ctx->mgf_ctx.md_info == md_info )
+    {
+        if( ctx->lhash_set == 0 )
+        {
+            mbedtls_md( md_info, label, 0, ctx->lhash );
+            ctx->lhash_set = 1;
+        }
+
+        memcpy( out, ctx->lhash, mbedtls_md_get_size( md_info ) );
+        return;
+    }
+#else
+    ((void) ctx);
+#endif
+
+    mbedtls_md( md_info, label, label_len, out );
+}
 #endif /* MBEDTLS_PKCS1_V21 */
 
 #if defined(MBEDTLS_PKCS1_V21)
@@ -536,7 +805,7 @@ int mbedtls_rsa_rsaes_oaep_encrypt( mbedtls_rsa_context *ctx,
     unsigned char *p = output;
     unsigned int hlen;
     const mbedtls_md_info_t *md_info;
-    mbedtls_md_context_t md_ctx;
+    mbedtls_md_context_t md_ctx_local, *md_ctx;
 
     if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V21 )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
@@ -567,26 +836,26 @@ int mbedtls_rsa_rsaes_oaep_encrypt( mbedtls_rsa_context *ctx,
 
     // Construct DB
     //
-    mbedtls_md( md_info, label, label_len, p );
+    rsa_oaep_lhash( ctx, md_info, label, label_len, p );
     p += hlen;
     p += olen - 2 * hlen - 2 - ilen;
     *p++ = 1;
     memcpy( p, input, ilen );
 
-    mbedtls_md_init( &md_ctx );
-    mbedtls_md_setup( &md_ctx, md_info, 0 );
+    if( ( ret = rsa_md_ctx_acquire( ctx, md_info, &md_ctx_local, &md_ctx ) ) != 0 )
+        return( ret );
 
     // maskedDB: Apply dbMask to DB
     //
     mgf_mask( output + hlen + 1, olen - hlen - 1, output + 1, hlen,
-               &md_ctx );
+               md_ctx );
 
     // maskedSeed: Apply seedMask to seed
     //
     mgf_mask( output + 1, hlen, output + hlen + 1, olen - hlen - 1,
-               &md_ctx );
+               md_ctx );
 
-    mbedtls_md_free( &md_ctx );
+    rsa_md_ctx_release( &md_ctx_local, md_ctx );
 
     return( ( mode == MBEDTLS_RSA_PUBLIC )
             ? mbedtls_rsa_public(  ctx, output, output )
@@ -710,7 +979,7 @@ int mbedtls_rsa_rsaes_oaep_decrypt( mbedtls_rsa_context *ctx,
     unsigned char lhash[MBEDTLS_MD_MAX_SIZE];
     unsigned int hlen;
     const mbedtls_md_info_t *md_info;
-    mbedtls_md_context_t md_ctx;
+    mbedtls_md_context_t md_ctx_local, *md_ctx;
 
     /*
      * Parameters sanity checks
@@ -742,21 +1011,21 @@ int mbedtls_rsa_rsaes_oaep_decrypt( mbedtls_rsa_context *ctx,
      */
     hlen = mbedtls_md_get_size( md_info );
 
-    mbedtls_md_init( &md_ctx );
-    mbedtls_md_setup( &md_ctx, md_info, 0 );
+    if( ( ret = rsa_md_ctx_acquire( ctx, md_info, &md_ctx_local, &md_ctx ) ) != 0 )
+        return( ret );
 
     /* Generate lHash */
-    mbedtls_md( md_info, label, label_len, lhash );
+    rsa_oaep_lhash( ctx, md_info, label, label_len, lhash );
 
     /* seed: Apply seedMask to maskedSeed */
     mgf_mask( buf + 1, hlen, buf + hlen + 1, ilen - hlen - 1,
-               &md_ctx );
+               md_ctx );
 
     /* DB: Apply dbMask to maskedDB */
     mgf_mask( buf + hlen + 1, ilen - hlen - 1, buf + 1, hlen,
-               &md_ctx );
+               md_ctx );
 
-    mbedtls_md_free( &md_ctx );
+    rsa_md_ctx_release( &md_ctx_local, md_ctx );
 
     /*
      * Check contents, in "constant-time"
@@ -817,9 +1086,13 @@ int mbedtls_rsa_rsaes_pkcs1_v15_decrypt( mbedtls_rsa_context *ctx,
                                  size_t output_max_len)
 {
     int ret;
-    size_t ilen, pad_count = 0, i;
-    unsigned char *p, bad, pad_done = 0;
+    size_t ilen, i, plaintext_max_size;
     unsigned char buf[MBEDTLS_MPI_MAX_SIZE];
+    /* The following variables take sensible values but their values
+     * must not leak into branches or memory access patterns */
+    size_t pad_count = 0, plaintext_size;
+    unsigned char bad = 0, pad_done = 0, not_done;
+    unsigned char bad_mask, output_too_large;
 
     if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V15 )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
@@ -829,63 +1102,106 @@ int mbedtls_rsa_rsaes_pkcs1_v15_decrypt( mbedtls_rsa_context *ctx,
     if( ilen < 16 || ilen > sizeof( buf ) )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
 
+    /* At most ilen - 11 message bytes fit in a valid encoding, and we
+     * never copy more than the caller's buffer can take */
+    plaintext_max_size = ( output_max_len > ilen - 11 ) ? ilen - 11
+                                                        : output_max_len;
+
     ret = ( mode == MBEDTLS_RSA_PUBLIC )
           ? mbedtls_rsa_public(  ctx, input, buf )
           : mbedtls_rsa_private( ctx, f_rng, p_rng, input, buf );
 
     if( ret != 0 )
-        return( ret );
-
-    p = buf;
-    bad = 0;
+        goto cleanup;
 
     /*
-     * Check and get padding len in "constant-time"
+     * Check and get the padding length in constant time and with a
+     * constant memory trace: until the decision is final, no byte of
+     * buf may influence a branch or the address of a memory access.
      */
-    bad |= *p++; /* First byte must be 0 */
+    bad |= buf[0]; /* First byte must be 0 */
 
     /* This test does not depend on secret data */
     if( mode == MBEDTLS_RSA_PRIVATE )
     {
-        bad |= *p++ ^ MBEDTLS_RSA_CRYPT;
+        bad |= buf[1] ^ MBEDTLS_RSA_CRYPT;
 
-        /* Get padding len, but always read till end of buffer
-         * (minus one, for the 00 byte) */
-        for( i = 0; i < ilen - 3; i++ )
+        /* Read the whole buffer: raise pad_done at the 00 separator
+         * and count the padding bytes before it */
+        for( i = 2; i < ilen; i++ )
         {
-            pad_done  |= ((p[i] | (unsigned char)-p[i]) >> 7) ^ 1;
-            pad_count += ((pad_done | (unsigned char)-pad_done) >> 7) ^ 1;
+            pad_done  |= ( ( buf[i] | (unsigned char) -buf[i] ) >> 7 ) ^ 1;
+            pad_count += ( pad_done ^ 1 );
         }
-
-        p += pad_count;
-        bad |= *p++; /* Must be zero */
     }
     else
     {
-        bad |= *p++ ^ MBEDTLS_RSA_SIGN;
+        bad |= buf[1] ^ MBEDTLS_RSA_SIGN;
 
-        /* Get padding len, but always read till end of buffer
-         * (minus one, for the 00 byte) */
-        for( i = 0; i < ilen - 3; i++ )
+        /* As above, and every padding byte before the separator must
+         * have the value 0xFF */
+        for( i = 2; i < ilen; i++ )
         {
-            pad_done |= ( p[i] != 0xFF );
-            pad_count += ( pad_done == 0 );
+            pad_done  |= ( ( buf[i] | (unsigned char) -buf[i] ) >> 7 ) ^ 1;
+            pad_count += ( pad_done ^ 1 );
+            not_done   = (unsigned char)( pad_done - 1 ); /* 0xFF before the separator */
+            bad       |= ( buf[i] ^ 0xFF ) & not_done;
         }
-
-        p += pad_count;
-        bad |= *p++; /* Must be zero */
     }
 
-    if( bad )
-        return( MBEDTLS_ERR_RSA_INVALID_PADDING );
-
-    if( ilen - ( p - buf ) > output_max_len )
-        return( MBEDTLS_ERR_RSA_OUTPUT_TOO_LARGE );
+    bad = ( ( bad | (unsigned char) -bad ) >> 7 );
+    bad |= pad_done ^ 1;                      /* No separator found  */
+    bad |= mbedtls_ct_size_gt( 8, pad_count );/* Padding too short   */
+
+    /* If the padding is invalid, pretend the message has the largest
+     * size that would have been accepted, so that neither the length
+     * of the copy below nor its source location reveal validity */
+    plaintext_size = mbedtls_ct_size_if( bad,
+                                         plaintext_max_size,
+                                         ilen - pad_count - 3 );
+
+    output_too_large = mbedtls_ct_size_gt( plaintext_size,
+                                           plaintext_max_size );
+
+    ret = - (int) mbedtls_ct_size_if( bad,
+                    (size_t) -MBEDTLS_ERR_RSA_INVALID_PADDING, 0 );
+    ret = - (int) mbedtls_ct_size_if( output_too_large,
+                    (size_t) -MBEDTLS_ERR_RSA_OUTPUT_TOO_LARGE,
+                    (size_t) -ret );
+
+    /* Blank the data about to be copied out if it won't be released
+     * anyway, with the same stores in either case */
+    bad_mask = (unsigned char) -( bad | output_too_large );
+    for( i = 11; i < ilen; i++ )
+        buf[i] &= (unsigned char) ~bad_mask;
+
+    /* A plaintext that does not fit is truncated for the copy, which
+     * must still happen: its length must not depend on the message */
+    plaintext_size = mbedtls_ct_size_if( output_too_large,
+                                         plaintext_max_size,
+                                         plaintext_size );
+
+    /* Move the message to the front of the region it can start in, so
+     * that afterwards its location is no longer secret, visiting the
+     * same bytes whatever the actual padding length was */
+    mbedtls_ct_mem_move_to_left( buf + ilen - plaintext_max_size,
+                                 plaintext_max_size,
+                                 plaintext_max_size - plaintext_size );
+
+    /* Exact-size copy: only the bytes that can be part of a message
+     * for this key and output buffer, never the full working buffer */
+    if( output_max_len != 0 )
+        memcpy( output, buf + ilen - plaintext_max_size,
+                plaintext_max_size );
+
+    /* In the error cases the value of *olen is unspecified; writing
+     * the same value as in the good case leaks the least */
+    *olen = plaintext_size;
 
-    *olen = ilen - (p - buf);
-    memcpy( output, p, *olen );
+cleanup:
+    mbedtls_zeroize( buf, ilen );
 
-    return( 0 );
+    return( ret );
 }
 #endif /* MBEDTLS_PKCS1_V15 */
 
@@ -940,7 +1256,7 @@ int mbedtls_rsa_rsassa_pss_sign( mbedtls_rsa_context *ctx,
     int ret;
     size_t msb;
     const mbedtls_md_info_t *md_info;
-    mbedtls_md_context_t md_ctx;
+    mbedtls_md_context_t md_ctx_local, *md_ctx;
 
     if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V21 )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
@@ -986,16 +1302,16 @@ int mbedtls_rsa_rsassa_pss_sign( mbedtls_rsa_context *ctx,
     memcpy( p, salt, slen );
     p += slen;
 
-    mbedtls_md_init( &md_ctx );
-    mbedtls_md_setup( &md_ctx, md_info, 0 );
+    if( ( ret = rsa_md_ctx_acquire( ctx, md_info, &md_ctx_local, &md_ctx ) ) != 0 )
+        return( ret );
 
     // Generate H = Hash( M' )
     //
-    mbedtls_md_starts( &md_ctx );
-    mbedtls_md_update( &md_ctx, p, 8 );
-    mbedtls_md_update( &md_ctx, hash, hashlen );
-    mbedtls_md_update( &md_ctx, salt, slen );
-    mbedtls_md_finish( &md_ctx, p );
+    mbedtls_md_starts( md_ctx );
+    mbedtls_md_update( md_ctx, p, 8 );
+    mbedtls_md_update( md_ctx, hash, hashlen );
+    mbedtls_md_update( md_ctx, salt, slen );
+    mbedtls_md_finish( md_ctx, p );
 
     // Compensate for boundary condition when applying mask
     //
@@ -1004,9 +1320,9 @@ int mbedtls_rsa_rsassa_pss_sign( mbedtls_rsa_context *ctx,
 
     // maskedDB: Apply dbMask to DB
     //
-    mgf_mask( sig + offset, olen - hlen - 1 - offset, p, hlen, &md_ctx );
+    mgf_mask( sig + offset, olen - hlen - 1 - offset, p, hlen, md_ctx );
 
-    mbedtls_md_free( &md_ctx );
+    rsa_md_ctx_release( &md_ctx_local, md_ctx );
 
     msb = mbedtls_mpi_bitlen( &ctx->N ) - 1;
     sig[0] &= 0xFF >> ( olen * 8 - msb );
@@ -1162,7 +1478,7 @@ int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
     unsigned int hlen;
     size_t slen, msb;
     const mbedtls_md_info_t *md_info;
-    mbedtls_md_context_t md_ctx;
+    mbedtls_md_context_t md_ctx_local, *md_ctx;
 
     if( mode == MBEDTLS_RSA_PRIVATE && ctx->padding != MBEDTLS_RSA_PKCS_V21 )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
@@ -1218,10 +1534,10 @@ int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
     if( buf[0] >> ( 8 - siglen * 8 + msb ) )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
 
-    mbedtls_md_init( &md_ctx );
-    mbedtls_md_setup( &md_ctx, md_info, 0 );
+    if( ( ret = rsa_md_ctx_acquire( ctx, md_info, &md_ctx_local, &md_ctx ) ) != 0 )
+        return( ret );
 
-    mgf_mask( p, siglen - hlen - 1, p + siglen - hlen - 1, hlen, &md_ctx );
+    mgf_mask( p, siglen - hlen - 1, p + siglen - hlen - 1, hlen, md_ctx );
 
     buf[0] &= 0xFF >> ( siglen * 8 - msb );
 
@@ -1231,7 +1547,7 @@ int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
     if( p == buf + siglen ||
         *p++ != 0x01 )
     {
-        mbedtls_md_free( &md_ctx );
+        rsa_md_ctx_release( &md_ctx_local, md_ctx );
         return( MBEDTLS_ERR_RSA_INVALID_PADDING );
     }
 
@@ -1241,19 +1557,19 @@ int mbedtls_rsa_rsassa_pss_verify_ext( mbedtls_rsa_context *ctx,
     if( expected_salt_len != MBEDTLS_RSA_SALT_LEN_ANY &&
         slen != (size_t) expected_salt_len )
     {
-        mbedtls_md_free( &md_ctx );
+        rsa_md_ctx_release( &md_ctx_local, md_ctx );
         return( MBEDTLS_ERR_RSA_INVALID_PADDING );
     }
 
     // Generate H = Hash( M' )
     //
-    mbedtls_md_starts( &md_ctx );
-    mbedtls_md_update( &md_ctx, zeros, 8 );
-    mbedtls_md_update( &md_ctx, hash, hashlen );
-    mbedtls_md_update( &md_ctx, p, slen );
-    mbedtls_md_finish( &md_ctx, result );
+    mbedtls_md_starts( md_ctx );
+    mbedtls_md_update( md_ctx, zeros, 8 );
+    mbedtls_md_update( md_ctx, hash, hashlen );
+    mbedtls_md_update( md_ctx, p, slen );
+    mbedtls_md_finish( md_ctx, result );
 
-    mbedtls_md_free( &md_ctx );
+    rsa_md_ctx_release( &md_ctx_local, md_ctx );
 
     if( memcmp( p + slen, result, hlen ) == 0 )
         return( 0 );
@@ -1482,6 +1798,10 @@ void mbedtls_rsa_free( mbedtls_rsa_context *ctx )
     mbedtls_mpi_free( &ctx->Q  ); mbedtls_mpi_free( &ctx->P  ); mbedtls_mpi_free( &ctx->D );
     mbedtls_mpi_free( &ctx->E  ); mbedtls_mpi_free( &ctx->N  );
 
+#if defined(MBEDTLS_PKCS1_V21)
+    mbedtls_md_free( &ctx->mgf_ctx );
+#endif
+
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_free( &ctx->mutex );
 #endif
@@ -0,0 +1,330 @@
+/*
+ *  Parallel and lazy execution of the compiled-in self-tests
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SELF_TEST)
+
+#include "mbedtls/selftest.h"
+
+#include "mbedtls/md2.h"
+#include "mbedtls/md4.h"
+#include "mbedtls/md5.h"
+#include "mbedtls/ripemd160.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/arc4.h"
+#include "mbedtls/des.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/ccm.h"
+#include "mbedtls/chacha20.h"
+#include "mbedtls/poly1305.h"
+#include "mbedtls/chachapoly.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/bignum.h"
+#include "mbedtls/rsa.h"
+#include "mbedtls/xtea.h"
+#include "mbedtls/camellia.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/hmac_drbg.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/dhm.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/pkcs5.h"
+#include "mbedtls/timing.h"
+
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
+typedef struct
+{
+    uint32_t flag;
+    int (*f_self_test)( int );
+}
+selftest_entry;
+
+/*
+ * Every compiled-in self-test of the crypto layer; the X.509 and
+ * allocator tests are not listed as the former lives in a higher layer
+ * and the latter replaces the active allocator while it runs.
+ */
+static const selftest_entry selftest_table[] =
+{
+#if defined(MBEDTLS_MD2_C)
+    { MBEDTLS_SELF_TEST_MD2,        mbedtls_md2_self_test       },
+#endif
+#if defined(MBEDTLS_MD4_C)
+    { MBEDTLS_SELF_TEST_MD4,        mbedtls_md4_self_test       },
+#endif
+#if defined(MBEDTLS_MD5_C)
+    { MBEDTLS_SELF_TEST_MD5,        mbedtls_md5_self_test       },
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+    { MBEDTLS_SELF_TEST_RIPEMD160,  mbedtls_ripemd160_self_test },
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    { MBEDTLS_SELF_TEST_SHA1,       mbedtls_sha1_self_test      },
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    { MBEDTLS_SELF_TEST_SHA256,     mbedtls_sha256_self_test    },
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    { MBEDTLS_SELF_TEST_SHA512,     mbedtls_sha512_self_test    },
+#endif
+#if defined(MBEDTLS_ARC4_C)
+    { MBEDTLS_SELF_TEST_ARC4,       mbedtls_arc4_self_test      },
+#endif
+#if defined(MBEDTLS_DES_C)
+    { MBEDTLS_SELF_TEST_DES,        mbedtls_des_self_test       },
+#endif
+#if defined(MBEDTLS_AES_C)
+    { MBEDTLS_SELF_TEST_AES,        mbedtls_aes_self_test       },
+#endif
+#if defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+    { MBEDTLS_SELF_TEST_GCM,        mbedtls_gcm_self_test       },
+#endif
+#if defined(MBEDTLS_CCM_C) && defined(MBEDTLS_AES_C)
+    { MBEDTLS_SELF_TEST_CCM,        mbedtls_ccm_self_test       },
+#endif
+#if defined(MBEDTLS_BASE64_C)
+    { MBEDTLS_SELF_TEST_BASE64,     mbedtls_base64_self_test    },
+#endif
+#if defined(MBEDTLS_BIGNUM_C)
+    { MBEDTLS_SELF_TEST_MPI,        mbedtls_mpi_self_test       },
+#endif
+#if defined(MBEDTLS_RSA_C)
+    { MBEDTLS_SELF_TEST_RSA,        mbedtls_rsa_self_test       },
+#endif
+#if defined(MBEDTLS_XTEA_C)
+    { MBEDTLS_SELF_TEST_XTEA,       mbedtls_xtea_self_test      },
+#endif
+#if defined(MBEDTLS_CAMELLIA_C)
+    { MBEDTLS_SELF_TEST_CAMELLIA,   mbedtls_camellia_self_test  },
+#endif
+#if defined(MBEDTLS_CTR_DRBG_C)
+    { MBEDTLS_SELF_TEST_CTR_DRBG,   mbedtls_ctr_drbg_self_test  },
+#endif
+#if defined(MBEDTLS_HMAC_DRBG_C)
+    { MBEDTLS_SELF_TEST_HMAC_DRBG,  mbedtls_hmac_drbg_self_test },
+#endif
+#if defined(MBEDTLS_ECP_C)
+    { MBEDTLS_SELF_TEST_ECP,        mbedtls_ecp_self_test       },
+#endif
+#if defined(MBEDTLS_DHM_C)
+    { MBEDTLS_SELF_TEST_DHM,        mbedtls_dhm_self_test       },
+#endif
+#if defined(MBEDTLS_ENTROPY_C)
+    { MBEDTLS_SELF_TEST_ENTROPY,    mbedtls_entropy_self_test   },
+#endif
+#if defined(MBEDTLS_PKCS5_C)
+    { MBEDTLS_SELF_TEST_PKCS5,      mbedtls_pkcs5_self_test     },
+#endif
+#if defined(MBEDTLS_TIMING_C)
+    { MBEDTLS_SELF_TEST_TIMING,     mbedtls_timing_self_test    },
+#endif
+#if defined(MBEDTLS_CHACHA20_C)
+    { MBEDTLS_SELF_TEST_CHACHA20,   mbedtls_chacha20_self_test  },
+#endif
+#if defined(MBEDTLS_POLY1305_C)
+    { MBEDTLS_SELF_TEST_POLY1305,   mbedtls_poly1305_self_test  },
+#endif
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    { MBEDTLS_SELF_TEST_CHACHAPOLY, mbedtls_chachapoly_self_test },
+#endif
+};
+
+#define SELFTEST_COUNT ( sizeof( selftest_table ) /     \
+                         sizeof( selftest_table[0] ) )
+
+/*
+ * Components deferred by mbedtls_self_test_all() and the outcome of the
+ * deferred runs; guarded by lazy_mutex when threading is enabled.
+ */
+static uint32_t lazy_pending;
+static uint32_t lazy_failed;
+#if defined(MBEDTLS_THREADING_C)
+static mbedtls_threading_mutex_t lazy_mutex;
+static int lazy_mutex_valid;
+#endif
+
+/*
+ * Run the table entries start, start + stride, ... that are not masked
+ * out; returns 0 if all of them passed.
+ */
+static int selftest_run_slice( size_t start, size_t stride,
+                               uint32_t lazy_mask, int verbose )
+{
+    int ret = 0;
+    size_t i;
+
+    for( i = start; i < SELFTEST_COUNT; i += stride )
+    {
+        if( ( selftest_table[i].flag & lazy_mask ) != 0 )
+            continue;
+
+        if( selftest_table[i].f_self_test( verbose ) != 0 )
+            ret = 1;
+    }
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+
+#define SELFTEST_MAX_THREADS    16
+
+typedef struct
+{
+    size_t start;
+    size_t stride;
+    uint32_t lazy_mask;
+    int verbose;
+    int ret;
+}
+selftest_thread_ctx;
+
+static void *selftest_thread_main( void *arg )
+{
+    selftest_thread_ctx *ctx = (selftest_thread_ctx *) arg;
+
+    ctx->ret = selftest_run_slice( ctx->start, ctx->stride,
+                                   ctx->lazy_mask, ctx->verbose );
+    return( NULL );
+}
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
+int mbedtls_self_test_all( int parallel_threads, uint32_t lazy_mask,
+                           int verbose )
+{
+    int ret = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( lazy_mutex_valid == 0 )
+    {
+        mbedtls_mutex_init( &lazy_mutex );
+        lazy_mutex_valid = 1;
+    }
+#endif
+
+    lazy_pending = lazy_mask & MBEDTLS_SELF_TEST_ALL;
+    lazy_failed = 0;
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    if( parallel_threads > 1 )
+    {
+        pthread_t threads[SELFTEST_MAX_THREADS];
+        selftest_thread_ctx ctx[SELFTEST_MAX_THREADS];
+        size_t i, n = (size_t) parallel_threads;
+
+        if( n > SELFTEST_MAX_THREADS )
+            n = SELFTEST_MAX_THREADS;
+        if( n > SELFTEST_COUNT )
+            n = SELFTEST_COUNT;
+
+        for( i = 0; i < n; i++ )
+        {
+            ctx[i].start = i;
+            ctx[i].stride = n;
+            ctx[i].lazy_mask = lazy_mask;
+            ctx[i].verbose = verbose;
+            ctx[i].ret = 0;
+
+            if( pthread_create( &threads[i], NULL,
+                                selftest_thread_main, &ctx[i] ) != 0 )
+            {
+                /* Could not spawn: run this slice ourselves */
+                selftest_thread_main( &ctx[i] );
+                threads[i] = pthread_self();
+            }
+        }
+
+        for( i = 0; i < n; i++ )
+        {
+            if( ! pthread_equal( threads[i], pthread_self() ) )
+                pthread_join( threads[i], NULL );
+            if( ctx[i].ret != 0 )
+                ret = 1;
+        }
+
+        return( ret );
+    }
+#else
+    ((void) parallel_threads);
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
+    ret = selftest_run_slice( 0, 1, lazy_mask, verbose );
+
+    return( ret );
+}
+
+int mbedtls_self_test_check( uint32_t component, int verbose )
+{
+    int ret = 0;
+    size_t i;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( lazy_mutex_valid != 0 &&
+        mbedtls_mutex_lock( &lazy_mutex ) != 0 )
+    {
+        return( 1 );
+    }
+#endif
+
+    if( ( lazy_failed & component ) != 0 )
+        ret = 1;
+    else if( ( lazy_pending & component ) != 0 )
+    {
+        for( i = 0; i < SELFTEST_COUNT; i++ )
+        {
+            if( selftest_table[i].flag != component )
+                continue;
+
+            if( selftest_table[i].f_self_test( verbose ) != 0 )
+            {
+                lazy_failed |= component;
+                ret = 1;
+            }
+            break;
+        }
+
+        lazy_pending &= ~component;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( lazy_mutex_valid != 0 &&
+        mbedtls_mutex_unlock( &lazy_mutex ) != 0 )
+    {
+        return( 1 );
+    }
+#endif
+
+    return( ret );
+}
+
+#endif /* MBEDTLS_SELF_TEST */
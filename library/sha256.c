@@ -37,6 +37,13 @@
 
 #include <string.h>
 
+#if defined(MBEDTLS_SHANI_C)
+#include "mbedtls/shani.h"
+#endif
+#if defined(MBEDTLS_ARMCE_C)
+#include "mbedtls/armce.h"
+#endif
+
 #if defined(MBEDTLS_SELF_TEST)
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
@@ -46,35 +53,11 @@
 #endif /* MBEDTLS_PLATFORM_C */
 #endif /* MBEDTLS_SELF_TEST */
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 #if !defined(MBEDTLS_SHA256_ALT)
 
-/*
- * 32-bit integer manipulation macros (big endian)
- */
-#ifndef GET_UINT32_BE
-#define GET_UINT32_BE(n,b,i)                            \
-do {                                                    \
-    (n) = ( (uint32_t) (b)[(i)    ] << 24 )             \
-        | ( (uint32_t) (b)[(i) + 1] << 16 )             \
-        | ( (uint32_t) (b)[(i) + 2] <<  8 )             \
-        | ( (uint32_t) (b)[(i) + 3]       );            \
-} while( 0 )
-#endif
-
-#ifndef PUT_UINT32_BE
-#define PUT_UINT32_BE(n,b,i)                            \
-do {                                                    \
-    (b)[(i)    ] = (unsigned char) ( (n) >> 24 );       \
-    (b)[(i) + 1] = (unsigned char) ( (n) >> 16 );       \
-    (b)[(i) + 2] = (unsigned char) ( (n) >>  8 );       \
-    (b)[(i) + 3] = (unsigned char) ( (n)       );       \
-} while( 0 )
-#endif
+#include "mbedtls/byte_order.h"
 
 void mbedtls_sha256_init( mbedtls_sha256_context *ctx )
 {
@@ -183,6 +166,22 @@ void mbedtls_sha256_process( mbedtls_sha256_context *ctx, const unsigned char da
     uint32_t A[8];
     unsigned int i;
 
+#if defined(MBEDTLS_SHANI_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( mbedtls_shani_has_support() )
+    {
+        mbedtls_shani_sha256_process( ctx->state, data, 1 );
+        return;
+    }
+#endif
+
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( mbedtls_armce_has_support( MBEDTLS_ARMCE_SHA2 ) )
+    {
+        mbedtls_armce_sha256_process( ctx->state, data, 1 );
+        return;
+    }
+#endif
+
     for( i = 0; i < 8; i++ )
         A[i] = ctx->state[i];
 
@@ -263,6 +262,27 @@ void mbedtls_sha256_update( mbedtls_sha256_context *ctx, const unsigned char *in
         left = 0;
     }
 
+#if !defined(MBEDTLS_SHA256_PROCESS_ALT)
+    /* Hand all the whole blocks to the hardware engine in one call
+     * instead of compressing them one at a time */
+#if defined(MBEDTLS_SHANI_C) && defined(MBEDTLS_HAVE_X86_64)
+    if( ilen >= 64 && mbedtls_shani_has_support() )
+    {
+        mbedtls_shani_sha256_process( ctx->state, input, ilen / 64 );
+        input += ilen & ~(size_t) 0x3F;
+        ilen  &= 0x3F;
+    }
+#endif
+#if defined(MBEDTLS_ARMCE_C) && defined(MBEDTLS_HAVE_ARM64)
+    if( ilen >= 64 && mbedtls_armce_has_support( MBEDTLS_ARMCE_SHA2 ) )
+    {
+        mbedtls_armce_sha256_process( ctx->state, input, ilen / 64 );
+        input += ilen & ~(size_t) 0x3F;
+        ilen  &= 0x3F;
+    }
+#endif
+#endif /* !MBEDTLS_SHA256_PROCESS_ALT */
+
     while( ilen >= 64 )
     {
         mbedtls_sha256_process( ctx, input );
@@ -0,0 +1,345 @@
+/*
+ *  Multi-buffer SHA-256 with AVX2
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The compression function below is the plain FIPS-180-2 round function,
+ * computed on eight independent message streams at once: each 32-bit lane
+ * of an AVX2 vector carries the state of one stream. No instruction-level
+ * tricks are needed; the parallelism comes entirely from the lanes.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SHA256MB_C)
+
+#include "mbedtls/sha256mb.h"
+
+#if defined(MBEDTLS_HAVE_X86_64)
+
+#include "mbedtls/sha256.h"
+
+#include <string.h>
+
+#if !defined(__AVX2__)
+/*
+ * The intrinsics are gated behind -mavx2; enable the extension locally so
+ * that the rest of the library can be built for a generic x86-64 target
+ * and still dispatch here at runtime when the CPU has it.
+ */
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), \
+                              apply_to=function)
+#else
+#pragma GCC target ("avx2")
+#endif
+#endif /* !__AVX2__ */
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#ifndef asm
+#define asm __asm
+#endif
+
+/*
+ * AVX2 support detection routine
+ */
+int mbedtls_sha256mb_has_support( void )
+{
+    static int done = 0;
+    static int supported = 0;
+    unsigned int b, c, xcr0;
+
+    if( ! done )
+    {
+        asm( "movl  $1, %%eax   \n\t"
+             "cpuid             \n\t"
+             : "=c" (c)
+             :
+             : "eax", "ebx", "edx" );
+
+        /* AVX2 needs the OS to save the ymm registers: check OSXSAVE and
+         * then XCR0 for SSE and AVX state before trusting the AVX2 bit */
+        supported = 0;
+        if( ( c & 0x08000000u ) != 0 )
+        {
+            asm( "xorl  %%ecx, %%ecx\n\t"
+                 "xgetbv            \n\t"
+                 : "=a" (xcr0)
+                 :
+                 : "ecx", "edx" );
+
+            if( ( xcr0 & 0x6 ) == 0x6 )
+            {
+                asm( "movl  $7, %%eax   \n\t"
+                     "xorl  %%ecx, %%ecx\n\t"
+                     "cpuid             \n\t"
+                     : "=b" (b)
+                     :
+                     : "eax", "ecx", "edx" );
+
+                supported = ( b & 0x20u ) != 0;
+            }
+        }
+
+        done = 1;
+    }
+
+    return( supported );
+}
+
+static const uint32_t sha256mb_k[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+static const uint32_t sha256mb_iv256[8] =
+{
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+static const uint32_t sha256mb_iv224[8] =
+{
+    0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
+    0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4,
+};
+
+#define ROTR(x,n)   _mm256_or_si256( _mm256_srli_epi32( x, n ),        \
+                                     _mm256_slli_epi32( x, 32 - (n) ) )
+
+#define ADD(a,b)    _mm256_add_epi32( a, b )
+
+/*
+ * Load words off/4 .. off/4 + 7 of the current block of all eight streams:
+ * read 32 bytes from each stream, byte-swap to host order and transpose
+ * the resulting 8x8 matrix of 32-bit words so that w[i] holds word i of
+ * every stream.
+ */
+static void sha256mb_load8( __m256i w[8], const unsigned char *p[8],
+                            size_t off )
+{
+    const __m256i bswap = _mm256_set_epi64x( 0x0C0D0E0F08090A0B,
+                                             0x0405060700010203,
+                                             0x0C0D0E0F08090A0B,
+                                             0x0405060700010203 );
+    __m256i r[8], t[8], u[8];
+    size_t i;
+
+    for( i = 0; i < 8; i++ )
+        r[i] = _mm256_shuffle_epi8(
+                   _mm256_loadu_si256( (const __m256i *) ( p[i] + off ) ),
+                   bswap );
+
+    for( i = 0; i < 4; i++ )
+    {
+        t[2 * i    ] = _mm256_unpacklo_epi32( r[2 * i], r[2 * i + 1] );
+        t[2 * i + 1] = _mm256_unpackhi_epi32( r[2 * i], r[2 * i + 1] );
+    }
+
+    for( i = 0; i < 2; i++ )
+    {
+        u[2 * i    ] = _mm256_unpacklo_epi64( t[i], t[i + 2] );
+        u[2 * i + 1] = _mm256_unpackhi_epi64( t[i], t[i + 2] );
+        u[2 * i + 4] = _mm256_unpacklo_epi64( t[i + 4], t[i + 6] );
+        u[2 * i + 5] = _mm256_unpackhi_epi64( t[i + 4], t[i + 6] );
+    }
+
+    for( i = 0; i < 4; i++ )
+    {
+        w[i    ] = _mm256_permute2x128_si256( u[i], u[i + 4], 0x20 );
+        w[i + 4] = _mm256_permute2x128_si256( u[i], u[i + 4], 0x31 );
+    }
+}
+
+/*
+ * Process nblocks 64-byte blocks from each of the eight streams p[],
+ * advancing the pointers. state[i] holds word i of all eight states.
+ */
+static void sha256mb_process_x8( __m256i state[8], const unsigned char *p[8],
+                                 size_t nblocks )
+{
+    __m256i a, b, c, d, e, f, g, h;
+    __m256i w[16];
+    __m256i t1, t2, s0, s1, ch, maj;
+    size_t t;
+
+    while( nblocks-- > 0 )
+    {
+        sha256mb_load8( w, p, 0 );
+        sha256mb_load8( w + 8, p, 32 );
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for( t = 0; t < 64; t++ )
+        {
+            if( t >= 16 )
+            {
+                s0 = _mm256_xor_si256(
+                         _mm256_xor_si256( ROTR( w[(t - 15) & 15],  7 ),
+                                           ROTR( w[(t - 15) & 15], 18 ) ),
+                         _mm256_srli_epi32( w[(t - 15) & 15], 3 ) );
+                s1 = _mm256_xor_si256(
+                         _mm256_xor_si256( ROTR( w[(t -  2) & 15], 17 ),
+                                           ROTR( w[(t -  2) & 15], 19 ) ),
+                         _mm256_srli_epi32( w[(t -  2) & 15], 10 ) );
+                w[t & 15] = ADD( ADD( w[t & 15], s0 ),
+                                 ADD( w[(t - 7) & 15], s1 ) );
+            }
+
+            s1 = _mm256_xor_si256( _mm256_xor_si256( ROTR( e,  6 ),
+                                                     ROTR( e, 11 ) ),
+                                   ROTR( e, 25 ) );
+            ch = _mm256_xor_si256( g,
+                     _mm256_and_si256( e, _mm256_xor_si256( f, g ) ) );
+            t1 = ADD( ADD( h, s1 ),
+                      ADD( ch, ADD( _mm256_set1_epi32( (int) sha256mb_k[t] ),
+                                    w[t & 15] ) ) );
+
+            s0 = _mm256_xor_si256( _mm256_xor_si256( ROTR( a,  2 ),
+                                                     ROTR( a, 13 ) ),
+                                   ROTR( a, 22 ) );
+            maj = _mm256_or_si256( _mm256_and_si256( a, b ),
+                     _mm256_and_si256( c, _mm256_or_si256( a, b ) ) );
+            t2 = ADD( s0, maj );
+
+            h = g; g = f; f = e; e = ADD( d, t1 );
+            d = c; c = b; b = a; a = ADD( t1, t2 );
+        }
+
+        state[0] = ADD( state[0], a ); state[1] = ADD( state[1], b );
+        state[2] = ADD( state[2], c ); state[3] = ADD( state[3], d );
+        state[4] = ADD( state[4], e ); state[5] = ADD( state[5], f );
+        state[6] = ADD( state[6], g ); state[7] = ADD( state[7], h );
+
+        for( t = 0; t < 8; t++ )
+            p[t] += 64;
+    }
+}
+
+/*
+ * Hash the remaining blocks and padding of one stream serially, resuming
+ * from the lane-parallel part when it processed anything.
+ */
+static void sha256mb_finish_lane( int is224,
+                                  const uint32_t state[8], size_t processed,
+                                  const unsigned char *input, size_t ilen,
+                                  unsigned char *output )
+{
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init( &ctx );
+    mbedtls_sha256_starts( &ctx, is224 );
+
+    if( processed > 0 )
+    {
+        memcpy( ctx.state, state, sizeof( ctx.state ) );
+        ctx.total[0] = (uint32_t) processed;
+        ctx.total[1] = (uint32_t) ( (uint64_t) processed >> 32 );
+    }
+
+    mbedtls_sha256_update( &ctx, input + processed, ilen - processed );
+    mbedtls_sha256_finish( &ctx, output );
+    mbedtls_sha256_free( &ctx );
+}
+
+/*
+ * Hash count independent buffers, eight at a time
+ */
+void mbedtls_sha256mb_hash( int is224, size_t count,
+                            const unsigned char *const *inputs,
+                            const size_t *ilens,
+                            unsigned char *const *outputs )
+{
+    const uint32_t *iv = is224 ? sha256mb_iv224 : sha256mb_iv256;
+    size_t done, i, t, nblocks;
+
+    for( done = 0; count - done >= 8; done += 8 )
+    {
+        const unsigned char *p[8];
+        __m256i state[8];
+        uint32_t words[8][8];   /* [state word][stream] */
+        uint32_t st[8];
+
+        memset( words, 0, sizeof( words ) );
+
+        nblocks = ilens[done] / 64;
+        for( i = 0; i < 8; i++ )
+        {
+            p[i] = inputs[done + i];
+            if( ilens[done + i] / 64 < nblocks )
+                nblocks = ilens[done + i] / 64;
+        }
+
+        if( nblocks > 0 )
+        {
+            for( t = 0; t < 8; t++ )
+                state[t] = _mm256_set1_epi32( (int) iv[t] );
+
+            sha256mb_process_x8( state, p, nblocks );
+
+            for( t = 0; t < 8; t++ )
+                _mm256_storeu_si256( (__m256i *) words[t], state[t] );
+        }
+
+        for( i = 0; i < 8; i++ )
+        {
+            for( t = 0; t < 8; t++ )
+                st[t] = words[t][i];
+
+            sha256mb_finish_lane( is224, st, nblocks * 64,
+                                  inputs[done + i], ilens[done + i],
+                                  outputs[done + i] );
+        }
+    }
+
+    for( ; done < count; done++ )
+        mbedtls_sha256( inputs[done], ilens[done], outputs[done], is224 );
+}
+
+#if defined(__clang__) && !defined(__AVX2__)
+#pragma clang attribute pop
+#endif
+
+#endif /* MBEDTLS_HAVE_X86_64 */
+
+#endif /* MBEDTLS_SHA256MB_C */
@@ -0,0 +1,187 @@
+/*
+ *  SHA-NI support functions
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * [SHA-EXT] Intel SHA Extensions: New Instructions Supporting the Secure
+ *           Hash Algorithm on Intel Architecture Processors, July 2013.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SHANI_C)
+
+#include "mbedtls/shani.h"
+
+#if defined(MBEDTLS_HAVE_X86_64)
+
+#if !defined(__SHA__)
+/*
+ * The intrinsics are gated behind -msha; enable the extensions locally so
+ * that the rest of the library can be built for a generic x86-64 target
+ * and still dispatch here at runtime when the CPU has them.
+ */
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sha,ssse3,sse4.1"))), \
+                              apply_to=function)
+#else
+#pragma GCC target ("sha,ssse3,sse4.1")
+#endif
+#endif /* !__SHA__ */
+
+#include <immintrin.h>
+
+#ifndef asm
+#define asm __asm
+#endif
+
+/*
+ * SHA-NI support detection routine
+ */
+int mbedtls_shani_has_support( void )
+{
+    static int done = 0;
+    static unsigned int b = 0;
+
+    if( ! done )
+    {
+        asm( "movl  $7, %%eax   \n\t"
+             "xorl  %%ecx, %%ecx\n\t"
+             "cpuid             \n\t"
+             : "=b" (b)
+             :
+             : "eax", "ecx", "edx" );
+        done = 1;
+    }
+
+    return( ( b & 0x20000000u ) != 0 );
+}
+
+static const uint32_t shani_sha256_k[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/*
+ * SHA-256 compression of one or more consecutive blocks
+ *
+ * SHA256RNDS2 performs two rounds on a state split into the {A,B,E,F} and
+ * {C,D,G,H} halves, with the round key sums in the implicit XMM0 operand;
+ * SHA256MSG1/SHA256MSG2 compute the message schedule four words at a time.
+ */
+void mbedtls_shani_sha256_process( uint32_t state[8],
+                                   const unsigned char *data,
+                                   size_t nblocks )
+{
+    __m128i state0, state1, abef, cdgh, msg, tmp;
+    __m128i m[4];
+    int j;
+    const __m128i byterev = _mm_set_epi64x( 0x0C0D0E0F08090A0BLL,
+                                            0x0405060700010203LL );
+
+    /* state[] is {A,B,C,D,E,F,G,H}: rearrange into ABEF / CDGH with the
+     * alphabetically first word in the highest lane */
+    tmp    = _mm_loadu_si128( (const __m128i *) &state[0] );   /* DCBA */
+    state1 = _mm_loadu_si128( (const __m128i *) &state[4] );   /* HGFE */
+    tmp    = _mm_shuffle_epi32( tmp, 0xB1 );                   /* CDAB */
+    state1 = _mm_shuffle_epi32( state1, 0x1B );                /* EFGH */
+    state0 = _mm_alignr_epi8( tmp, state1, 8 );                /* ABEF */
+    state1 = _mm_blend_epi16( state1, tmp, 0xF0 );             /* CDGH */
+
+    while( nblocks-- > 0 )
+    {
+        abef = state0;
+        cdgh = state1;
+
+        m[0] = _mm_shuffle_epi8(
+            _mm_loadu_si128( (const __m128i *) ( data      ) ), byterev );
+        m[1] = _mm_shuffle_epi8(
+            _mm_loadu_si128( (const __m128i *) ( data + 16 ) ), byterev );
+        m[2] = _mm_shuffle_epi8(
+            _mm_loadu_si128( (const __m128i *) ( data + 32 ) ), byterev );
+        m[3] = _mm_shuffle_epi8(
+            _mm_loadu_si128( (const __m128i *) ( data + 48 ) ), byterev );
+
+        for( j = 0; j < 16; j++ )
+        {
+            msg = _mm_add_epi32( m[j & 3],
+                _mm_loadu_si128( (const __m128i *) &shani_sha256_k[4 * j] ) );
+
+            state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+            msg = _mm_shuffle_epi32( msg, 0x0E );
+            state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+            if( j < 12 )
+            {
+                /* W[t] for the step four rounds ahead:
+                 * sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16] */
+                tmp = _mm_alignr_epi8( m[( j + 3 ) & 3],
+                                       m[( j + 2 ) & 3], 4 );
+                m[j & 3] = _mm_sha256msg2_epu32(
+                    _mm_add_epi32(
+                        _mm_sha256msg1_epu32( m[j & 3], m[( j + 1 ) & 3] ),
+                        tmp ),
+                    m[( j + 3 ) & 3] );
+            }
+        }
+
+        state0 = _mm_add_epi32( state0, abef );
+        state1 = _mm_add_epi32( state1, cdgh );
+
+        data += 64;
+    }
+
+    /* Back to the linear {A..H} layout */
+    tmp    = _mm_shuffle_epi32( state0, 0x1B );                /* FEBA */
+    state1 = _mm_shuffle_epi32( state1, 0xB1 );                /* DCHG */
+    state0 = _mm_blend_epi16( tmp, state1, 0xF0 );             /* DCBA */
+    state1 = _mm_alignr_epi8( state1, tmp, 8 );                /* HGFE */
+
+    _mm_storeu_si128( (__m128i *) &state[0], state0 );
+    _mm_storeu_si128( (__m128i *) &state[4], state1 );
+}
+
+#if !defined(__SHA__) && defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif /* MBEDTLS_HAVE_X86_64 */
+
+#endif /* MBEDTLS_SHANI_C */
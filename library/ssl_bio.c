@@ -0,0 +1,212 @@
+/*
+ *  In-memory BIO pair for connecting two SSL contexts
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Each direction is a single-producer single-consumer ring. The byte
+ * counters wr and rd are free-running: the producer only ever increases
+ * wr and the consumer only ever increases rd, and each side reads the
+ * other's counter at most once per call, so a stale value can only make
+ * the ring look more full (to the producer) or more empty (to the
+ * consumer) than it is — never corrupt it. Counter updates happen after
+ * the matching memcpy, so published bytes are always complete.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_BIO_PAIR_C)
+
+#include "mbedtls/ssl_bio.h"
+#include "mbedtls/constant_time.h"
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#include <string.h>
+
+void mbedtls_ssl_bio_pair_init( mbedtls_ssl_bio_pair_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_ssl_bio_pair_context ) );
+}
+
+int mbedtls_ssl_bio_pair_setup( mbedtls_ssl_bio_pair_context *ctx,
+                                size_t bufsize )
+{
+    int i;
+
+    if( bufsize == 0 )
+        bufsize = MBEDTLS_SSL_BIO_BUFFER_SIZE;
+
+    for( i = 0; i < 2; i++ )
+    {
+        ctx->ring[i].buf = mbedtls_calloc( 1, bufsize );
+        if( ctx->ring[i].buf == NULL )
+        {
+            mbedtls_ssl_bio_pair_free( ctx );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+        ctx->ring[i].size = bufsize;
+        ctx->ring[i].data_lwm = 1;
+        ctx->ring[i].space_lwm = 1;
+    }
+
+    /* ring[0] carries A to B, ring[1] carries B to A */
+    ctx->ep[MBEDTLS_SSL_BIO_ENDPOINT_A].out = &ctx->ring[0];
+    ctx->ep[MBEDTLS_SSL_BIO_ENDPOINT_A].in  = &ctx->ring[1];
+    ctx->ep[MBEDTLS_SSL_BIO_ENDPOINT_B].out = &ctx->ring[1];
+    ctx->ep[MBEDTLS_SSL_BIO_ENDPOINT_B].in  = &ctx->ring[0];
+
+    return( 0 );
+}
+
+mbedtls_ssl_bio_endpoint *mbedtls_ssl_bio_pair_endpoint(
+                                mbedtls_ssl_bio_pair_context *ctx, int end )
+{
+    if( end < 0 || end > 1 || ctx->ring[0].buf == NULL )
+        return( NULL );
+
+    return( &ctx->ep[end] );
+}
+
+void mbedtls_ssl_bio_set_watermarks( mbedtls_ssl_bio_endpoint *ep,
+                                     size_t data_lwm, size_t space_lwm,
+                                     void (*f_data)( void *, size_t ),
+                                     void (*f_space)( void *, size_t ),
+                                     void *p_notify )
+{
+    ep->in->f_data = f_data;
+    ep->in->data_lwm = data_lwm != 0 ? data_lwm : 1;
+    ep->in->p_notify = p_notify;
+
+    ep->out->f_space = f_space;
+    ep->out->space_lwm = space_lwm != 0 ? space_lwm : 1;
+    ep->out->p_notify = p_notify;
+}
+
+size_t mbedtls_ssl_bio_pending( const mbedtls_ssl_bio_endpoint *ep )
+{
+    return( ep->in->wr - ep->in->rd );
+}
+
+size_t mbedtls_ssl_bio_space( const mbedtls_ssl_bio_endpoint *ep )
+{
+    return( ep->out->size - ( ep->out->wr - ep->out->rd ) );
+}
+
+int mbedtls_ssl_bio_send( void *p_ep, const unsigned char *buf, size_t len )
+{
+    mbedtls_ssl_bio_ring *ring = ( (mbedtls_ssl_bio_endpoint *) p_ep )->out;
+    size_t used, space, pos, chunk;
+
+    if( ring == NULL || ring->buf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    used = ring->wr - ring->rd;
+    space = ring->size - used;
+
+    if( space == 0 )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+    if( len > space )
+        len = space;
+
+    pos = ring->wr % ring->size;
+    chunk = ring->size - pos;
+    if( chunk > len )
+        chunk = len;
+
+    memcpy( ring->buf + pos, buf, chunk );
+    if( chunk < len )
+        memcpy( ring->buf, buf + chunk, len - chunk );
+
+    ring->wr += len;
+
+    if( ring->f_data != NULL &&
+        used < ring->data_lwm && used + len >= ring->data_lwm )
+    {
+        ring->f_data( ring->p_notify, used + len );
+    }
+
+    return( (int) len );
+}
+
+int mbedtls_ssl_bio_recv( void *p_ep, unsigned char *buf, size_t len )
+{
+    mbedtls_ssl_bio_ring *ring = ( (mbedtls_ssl_bio_endpoint *) p_ep )->in;
+    size_t used, space, pos, chunk;
+
+    if( ring == NULL || ring->buf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    used = ring->wr - ring->rd;
+
+    if( used == 0 )
+        return( MBEDTLS_ERR_SSL_WANT_READ );
+
+    if( len > used )
+        len = used;
+
+    pos = ring->rd % ring->size;
+    chunk = ring->size - pos;
+    if( chunk > len )
+        chunk = len;
+
+    memcpy( buf, ring->buf + pos, chunk );
+    if( chunk < len )
+        memcpy( buf + chunk, ring->buf, len - chunk );
+
+    ring->rd += len;
+
+    space = ring->size - used;
+    if( ring->f_space != NULL &&
+        space < ring->space_lwm && space + len >= ring->space_lwm )
+    {
+        ring->f_space( ring->p_notify, space + len );
+    }
+
+    return( (int) len );
+}
+
+void mbedtls_ssl_bio_pair_free( mbedtls_ssl_bio_pair_context *ctx )
+{
+    int i;
+
+    for( i = 0; i < 2; i++ )
+    {
+        if( ctx->ring[i].buf != NULL )
+        {
+            mbedtls_zeroize( ctx->ring[i].buf, ctx->ring[i].size );
+            mbedtls_free( ctx->ring[i].buf );
+        }
+    }
+
+    mbedtls_zeroize( ctx, sizeof( mbedtls_ssl_bio_pair_context ) );
+}
+
+#endif /* MBEDTLS_SSL_BIO_PAIR_C */
@@ -20,8 +20,9 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 /*
- * These session callbacks use a simple chained list
- * to store and retrieve the session information.
+ * These session callbacks use a hash table over session IDs, split into
+ * independently locked shards, to store and retrieve the session
+ * information without a global lock.
  */
 
 #if !defined(MBEDTLS_CONFIG_FILE)
@@ -46,16 +47,172 @@
 
 void mbedtls_ssl_cache_init( mbedtls_ssl_cache_context *cache )
 {
+#if defined(MBEDTLS_THREADING_C)
+    int i;
+#endif
+
     memset( cache, 0, sizeof( mbedtls_ssl_cache_context ) );
 
     cache->timeout = MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT;
     cache->max_entries = MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES;
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_init( &cache->mutex );
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
+        mbedtls_rwlock_init( &cache->shards[i].rwlock );
 #endif
 }
 
+/*
+ * Session IDs are generated by a CSPRNG, so a simple mix of all the bytes
+ * spreads entries evenly over shards and buckets.
+ */
+static unsigned int ssl_cache_id_hash( const unsigned char *id, size_t id_len )
+{
+    unsigned int hash = 0;
+    size_t i;
+
+    for( i = 0; i < id_len; i++ )
+        hash = hash * 257 + id[i];
+
+    return( hash );
+}
+
+/*
+ * The shard and bucket indices use independent parts of the hash
+ */
+static mbedtls_ssl_cache_shard *ssl_cache_shard_of( mbedtls_ssl_cache_context *cache,
+                                                    unsigned int hash )
+{
+    return( &cache->shards[hash % MBEDTLS_SSL_CACHE_SHARDS] );
+}
+
+static mbedtls_ssl_cache_entry **ssl_cache_bucket_of( mbedtls_ssl_cache_shard *shard,
+                                                      unsigned int hash )
+{
+    return( &shard->buckets[( hash / MBEDTLS_SSL_CACHE_SHARDS )
+                            % shard->num_buckets] );
+}
+
+/*
+ * Allocate the buckets of a shard on first use, aiming for about one
+ * entry per bucket at the configured maximum number of entries
+ */
+static int ssl_cache_shard_setup( mbedtls_ssl_cache_context *cache,
+                                  mbedtls_ssl_cache_shard *shard )
+{
+    int num_buckets = 16;
+
+    if( shard->buckets != NULL )
+        return( 0 );
+
+    while( num_buckets < cache->max_entries / MBEDTLS_SSL_CACHE_SHARDS )
+        num_buckets <<= 1;
+
+    shard->buckets = mbedtls_calloc( num_buckets,
+                                     sizeof( mbedtls_ssl_cache_entry * ) );
+    if( shard->buckets == NULL )
+        return( 1 );
+
+    shard->num_buckets = num_buckets;
+
+    return( 0 );
+}
+
+/*
+ * Eviction list handling: entries are linked from oldest to newest, so
+ * expiry and eviction work on the head instead of scanning the shard
+ */
+static void ssl_cache_lru_remove( mbedtls_ssl_cache_shard *shard,
+                                  mbedtls_ssl_cache_entry *entry )
+{
+    if( entry->lru_prev != NULL )
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        shard->lru_head = entry->lru_next;
+
+    if( entry->lru_next != NULL )
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        shard->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void ssl_cache_lru_append( mbedtls_ssl_cache_shard *shard,
+                                  mbedtls_ssl_cache_entry *entry )
+{
+    entry->lru_prev = shard->lru_tail;
+    entry->lru_next = NULL;
+
+    if( shard->lru_tail != NULL )
+        shard->lru_tail->lru_next = entry;
+    else
+        shard->lru_head = entry;
+
+    shard->lru_tail = entry;
+}
+
+/*
+ * Unlink an entry from its hash bucket
+ */
+static void ssl_cache_bucket_remove( mbedtls_ssl_cache_shard *shard,
+                                     mbedtls_ssl_cache_entry *entry )
+{
+    unsigned int hash = ssl_cache_id_hash( entry->session.id,
+                                           entry->session.id_len );
+    mbedtls_ssl_cache_entry **prv;
+
+    for( prv = ssl_cache_bucket_of( shard, hash );
+         *prv != NULL; prv = &(*prv)->next )
+    {
+        if( *prv == entry )
+        {
+            *prv = entry->next;
+            entry->next = NULL;
+            return;
+        }
+    }
+}
+
+/*
+ * Memory used by an entry, as counted against the byte budget
+ */
+static size_t ssl_cache_entry_size( const mbedtls_ssl_cache_entry *entry )
+{
+    size_t n = sizeof( mbedtls_ssl_cache_entry );
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    n += entry->peer_cert.len;
+#endif
+
+    return( n );
+}
+
+/*
+ * Remove and free the oldest entry of a shard
+ */
+static void ssl_cache_evict_oldest( mbedtls_ssl_cache_shard *shard )
+{
+    mbedtls_ssl_cache_entry *entry = shard->lru_head;
+
+    if( entry == NULL )
+        return;
+
+    ssl_cache_lru_remove( shard, entry );
+    ssl_cache_bucket_remove( shard, entry );
+
+    shard->bytes -= ssl_cache_entry_size( entry );
+    shard->count--;
+
+    mbedtls_ssl_session_free( &entry->session );
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    mbedtls_free( entry->peer_cert.p );
+#endif
+
+    mbedtls_free( entry );
+}
+
 int mbedtls_ssl_cache_get( void *data, mbedtls_ssl_session *session )
 {
     int ret = 1;
@@ -63,21 +220,26 @@ int mbedtls_ssl_cache_get( void *data, mbedtls_ssl_session *session )
     time_t t = time( NULL );
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *entry;
+    mbedtls_ssl_cache_shard *shard;
+    mbedtls_ssl_cache_entry *entry;
+    unsigned int hash;
+
+    hash = ssl_cache_id_hash( session->id, session->id_len );
+    shard = ssl_cache_shard_of( cache, hash );
 
 #if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+    /* Lookups never modify the shard, so concurrent resumptions can
+     * share it */
+    if( mbedtls_rwlock_rdlock( &shard->rwlock ) != 0 )
         return( 1 );
 #endif
 
-    cur = cache->chain;
-    entry = NULL;
+    if( shard->buckets == NULL )
+        goto exit;
 
-    while( cur != NULL )
+    for( entry = *ssl_cache_bucket_of( shard, hash );
+         entry != NULL; entry = entry->next )
     {
-        entry = cur;
-        cur = cur->next;
-
 #if defined(MBEDTLS_HAVE_TIME)
         if( cache->timeout != 0 &&
             (int) ( t - entry->timestamp ) > cache->timeout )
@@ -128,7 +290,7 @@ int mbedtls_ssl_cache_get( void *data, mbedtls_ssl_session *session )
 
 exit:
 #if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
+    if( mbedtls_rwlock_unlock( &shard->rwlock ) != 0 )
         ret = 1;
 #endif
 
@@ -139,84 +301,83 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
 {
     int ret = 1;
 #if defined(MBEDTLS_HAVE_TIME)
-    time_t t = time( NULL ), oldest = 0;
-    mbedtls_ssl_cache_entry *old = NULL;
+    time_t t = time( NULL );
 #endif
     mbedtls_ssl_cache_context *cache = (mbedtls_ssl_cache_context *) data;
-    mbedtls_ssl_cache_entry *cur, *prv;
-    int count = 0;
+    mbedtls_ssl_cache_shard *shard;
+    mbedtls_ssl_cache_entry **head, *cur;
+    unsigned int hash;
+    int max_per_shard;
+
+    hash = ssl_cache_id_hash( session->id, session->id_len );
+    shard = ssl_cache_shard_of( cache, hash );
 
 #if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+    if( ( ret = mbedtls_rwlock_wrlock( &shard->rwlock ) ) != 0 )
         return( ret );
 #endif
 
-    cur = cache->chain;
-    prv = NULL;
-
-    while( cur != NULL )
+    if( ssl_cache_shard_setup( cache, shard ) != 0 )
     {
-        count++;
+        ret = 1;
+        goto exit;
+    }
 
+    head = ssl_cache_bucket_of( shard, hash );
+
+    for( cur = *head; cur != NULL; cur = cur->next )
+    {
 #if defined(MBEDTLS_HAVE_TIME)
         if( cache->timeout != 0 &&
             (int) ( t - cur->timestamp ) > cache->timeout )
         {
+            /* expired, reuse this slot, update timestamp */
             cur->timestamp = t;
-            break; /* expired, reuse this slot, update timestamp */
+            ssl_cache_lru_remove( shard, cur );
+            ssl_cache_lru_append( shard, cur );
+            break;
         }
 #endif
 
         if( memcmp( session->id, cur->session.id, cur->session.id_len ) == 0 )
             break; /* client reconnected, keep timestamp for session id */
-
-#if defined(MBEDTLS_HAVE_TIME)
-        if( oldest == 0 || cur->timestamp < oldest )
-        {
-            oldest = cur->timestamp;
-            old = cur;
-        }
-#endif
-
-        prv = cur;
-        cur = cur->next;
     }
 
     if( cur == NULL )
     {
 #if defined(MBEDTLS_HAVE_TIME)
         /*
-         * Reuse oldest entry if max_entries reached
+         * Incrementally drop expired entries, oldest first
          */
-        if( count >= cache->max_entries )
+        while( cache->timeout != 0 && shard->lru_head != NULL &&
+               (int) ( t - shard->lru_head->timestamp ) > cache->timeout )
         {
-            if( old == NULL )
-            {
-                ret = 1;
-                goto exit;
-            }
-
-            cur = old;
+            ssl_cache_evict_oldest( shard );
         }
-#else /* MBEDTLS_HAVE_TIME */
-        /*
-         * Reuse first entry in chain if max_entries reached,
-         * but move to last place
-         */
-        if( count >= cache->max_entries )
+#endif
+
+        max_per_shard = cache->max_entries / MBEDTLS_SSL_CACHE_SHARDS;
+        if( max_per_shard < 1 )
+            max_per_shard = 1;
+
+        if( shard->count >= max_per_shard )
         {
-            if( cache->chain == NULL )
+            /*
+             * Reuse the oldest entry of the shard,
+             * moving it to this session's bucket
+             */
+            cur = shard->lru_head;
+            if( cur == NULL )
             {
                 ret = 1;
                 goto exit;
             }
 
-            cur = cache->chain;
-            cache->chain = cur->next;
-            cur->next = NULL;
-            prv->next = cur;
+            ssl_cache_lru_remove( shard, cur );
+            ssl_cache_bucket_remove( shard, cur );
+            cur->next = *head;
+            *head = cur;
         }
-#endif /* MBEDTLS_HAVE_TIME */
         else
         {
             /*
@@ -229,12 +390,14 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
                 goto exit;
             }
 
-            if( prv == NULL )
-                cache->chain = cur;
-            else
-                prv->next = cur;
+            cur->next = *head;
+            *head = cur;
+            shard->count++;
+            shard->bytes += sizeof( mbedtls_ssl_cache_entry );
         }
 
+        ssl_cache_lru_append( shard, cur );
+
 #if defined(MBEDTLS_HAVE_TIME)
         cur->timestamp = t;
 #endif
@@ -248,6 +411,7 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
      */
     if( cur->peer_cert.p != NULL )
     {
+        shard->bytes -= cur->peer_cert.len;
         mbedtls_free( cur->peer_cert.p );
         memset( &cur->peer_cert, 0, sizeof(mbedtls_x509_buf) );
     }
@@ -267,16 +431,28 @@ int mbedtls_ssl_cache_set( void *data, const mbedtls_ssl_session *session )
         memcpy( cur->peer_cert.p, session->peer_cert->raw.p,
                 session->peer_cert->raw.len );
         cur->peer_cert.len = session->peer_cert->raw.len;
+        shard->bytes += cur->peer_cert.len;
 
         cur->session.peer_cert = NULL;
     }
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
+    /*
+     * Enforce the byte budget, never evicting the entry just stored
+     */
+    if( cache->max_bytes != 0 )
+    {
+        size_t max_shard_bytes = cache->max_bytes / MBEDTLS_SSL_CACHE_SHARDS;
+
+        while( shard->bytes > max_shard_bytes && shard->lru_head != cur )
+            ssl_cache_evict_oldest( shard );
+    }
+
     ret = 0;
 
 exit:
 #if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
+    if( mbedtls_rwlock_unlock( &shard->rwlock ) != 0 )
         ret = 1;
 #endif
 
@@ -299,29 +475,52 @@ void mbedtls_ssl_cache_set_max_entries( mbedtls_ssl_cache_context *cache, int ma
     cache->max_entries = max;
 }
 
+void mbedtls_ssl_cache_set_max_bytes( mbedtls_ssl_cache_context *cache, size_t max )
+{
+    cache->max_bytes = max;
+}
+
 void mbedtls_ssl_cache_free( mbedtls_ssl_cache_context *cache )
 {
+    mbedtls_ssl_cache_shard *shard;
     mbedtls_ssl_cache_entry *cur, *prv;
+    int i, j;
 
-    cur = cache->chain;
-
-    while( cur != NULL )
+    for( i = 0; i < MBEDTLS_SSL_CACHE_SHARDS; i++ )
     {
-        prv = cur;
-        cur = cur->next;
+        shard = &cache->shards[i];
 
-        mbedtls_ssl_session_free( &prv->session );
+        for( j = 0; j < shard->num_buckets; j++ )
+        {
+            cur = shard->buckets[j];
+
+            while( cur != NULL )
+            {
+                prv = cur;
+                cur = cur->next;
+
+                mbedtls_ssl_session_free( &prv->session );
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
-        mbedtls_free( prv->peer_cert.p );
+                mbedtls_free( prv->peer_cert.p );
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
-        mbedtls_free( prv );
-    }
+                mbedtls_free( prv );
+            }
+        }
+
+        mbedtls_free( shard->buckets );
+        shard->buckets = NULL;
+        shard->lru_head = NULL;
+        shard->lru_tail = NULL;
+        shard->num_buckets = 0;
+        shard->count = 0;
+        shard->bytes = 0;
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_free( &cache->mutex );
+        mbedtls_rwlock_free( &shard->rwlock );
 #endif
+    }
 }
 
 #endif /* MBEDTLS_SSL_CACHE_C */
@@ -0,0 +1,407 @@
+/*
+ *  SSL session cache over POSIX shared memory
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * These session callbacks store the table in shared memory, so the
+ * workers of a pre-forking server all resume each other's sessions.
+ * The table is direct-mapped and readers are lock-free: each slot has a
+ * seqlock plus a checksum, and anything inconsistent - a concurrent
+ * writer, a torn slot - is treated as a cache miss.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+
+#include "mbedtls/ssl_cache_shm.h"
+#include "mbedtls/constant_time.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#if !defined(unix) && !defined(__unix__) && !defined(__unix) && \
+    !defined(__APPLE__) && !defined(__QNXNTO__)
+#error "This module only works on Unix"
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SSL_CACHE_SHM_MAGIC     0x53435348      /* "SCSH" */
+
+/* The seqlock and the checksum themselves are not part of the sum */
+#define SSL_CACHE_SHM_SUM_START                                 \
+    ( offsetof( mbedtls_ssl_cache_shm_entry, checksum ) +       \
+      sizeof( uint32_t ) )
+
+void mbedtls_ssl_cache_shm_init( mbedtls_ssl_cache_shm_context *cache )
+{
+    memset( cache, 0, sizeof( mbedtls_ssl_cache_shm_context ) );
+
+    cache->timeout = MBEDTLS_SSL_CACHE_SHM_DEFAULT_TIMEOUT;
+    cache->fd = -1;
+}
+
+static size_t ssl_cache_shm_map_len( uint32_t num_entries )
+{
+    return( sizeof( mbedtls_ssl_cache_shm_table ) +
+            ( (size_t) num_entries - 1 ) *
+            sizeof( mbedtls_ssl_cache_shm_entry ) );
+}
+
+/*
+ * FNV-1a, folded over the slot content below the seqlock and checksum.
+ * Not cryptographic: it only has to make an interleaving of two honest
+ * writers come out invalid, attackers don't get to write to the table.
+ */
+static uint32_t ssl_cache_shm_sum( const mbedtls_ssl_cache_shm_entry *entry )
+{
+    const unsigned char *p = (const unsigned char *) entry;
+    uint32_t hash = 0x811C9DC5;
+    size_t i;
+
+    for( i = SSL_CACHE_SHM_SUM_START;
+         i < sizeof( mbedtls_ssl_cache_shm_entry ); i++ )
+    {
+        hash = ( hash ^ p[i] ) * 0x01000193;
+    }
+
+    return( hash );
+}
+
+/*
+ * Session IDs are generated by a CSPRNG, so a simple mix of all the
+ * bytes spreads sessions evenly over the slots
+ */
+static mbedtls_ssl_cache_shm_entry *ssl_cache_shm_slot_of(
+                                        mbedtls_ssl_cache_shm_table *table,
+                                        const unsigned char *id,
+                                        size_t id_len )
+{
+    unsigned int hash = 0;
+    size_t i;
+
+    for( i = 0; i < id_len; i++ )
+        hash = hash * 257 + id[i];
+
+    return( &table->entries[hash % table->num_entries] );
+}
+
+int mbedtls_ssl_cache_shm_setup( mbedtls_ssl_cache_shm_context *cache,
+                                 const char *name,
+                                 uint32_t num_entries )
+{
+    void *map;
+    size_t map_len;
+
+    if( num_entries == 0 )
+        num_entries = MBEDTLS_SSL_CACHE_SHM_DEFAULT_ENTRIES;
+
+    map_len = ssl_cache_shm_map_len( num_entries );
+
+    if( name == NULL )
+    {
+        /*
+         * Anonymous mapping, shared with every process forked later
+         */
+        map = mmap( NULL, map_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+        if( map == MAP_FAILED )
+            return( 1 );
+
+        cache->table = (mbedtls_ssl_cache_shm_table *) map;
+        cache->map_len = map_len;
+        cache->table->num_entries = num_entries;
+        cache->table->magic = SSL_CACHE_SHM_MAGIC;
+
+        return( 0 );
+    }
+
+    /*
+     * Named POSIX shared memory object; whoever creates it sizes and
+     * initializes the table, later callers adopt its slot count
+     */
+    cache->fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+    if( cache->fd >= 0 )
+    {
+        cache->created = 1;
+
+        if( ftruncate( cache->fd, (off_t) map_len ) != 0 )
+            goto fail;
+    }
+    else
+    {
+        struct stat st;
+
+        if( ( cache->fd = shm_open( name, O_RDWR, 0600 ) ) < 0 )
+            return( 1 );
+
+        if( fstat( cache->fd, &st ) != 0 ||
+            (size_t) st.st_size < ssl_cache_shm_map_len( 1 ) )
+            goto fail;
+
+        map_len = (size_t) st.st_size;
+    }
+
+    map = mmap( NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                cache->fd, 0 );
+    if( map == MAP_FAILED )
+        goto fail;
+
+    cache->table = (mbedtls_ssl_cache_shm_table *) map;
+    cache->map_len = map_len;
+
+    if( ( cache->name = mbedtls_calloc( 1, strlen( name ) + 1 ) ) == NULL )
+        goto fail;
+    memcpy( cache->name, name, strlen( name ) + 1 );
+
+    if( cache->created )
+    {
+        /* The fresh object reads as zeroes; publish the slot count
+         * before the magic, which attachers wait for */
+        cache->table->num_entries = num_entries;
+        cache->table->magic = SSL_CACHE_SHM_MAGIC;
+    }
+    else
+    {
+        while( cache->table->magic != SSL_CACHE_SHM_MAGIC )
+            ;
+
+        if( cache->table->num_entries == 0 ||
+            ssl_cache_shm_map_len( cache->table->num_entries ) > map_len )
+        {
+            mbedtls_ssl_cache_shm_free( cache );
+            return( 1 );
+        }
+    }
+
+    return( 0 );
+
+fail:
+    mbedtls_ssl_cache_shm_free( cache );
+    return( 1 );
+}
+
+int mbedtls_ssl_cache_shm_get( void *data, mbedtls_ssl_session *session )
+{
+    int ret = 1;
+    int tries;
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t t = time( NULL );
+#endif
+    mbedtls_ssl_cache_shm_context *cache = (mbedtls_ssl_cache_shm_context *) data;
+    mbedtls_ssl_cache_shm_entry *slot;
+    mbedtls_ssl_cache_shm_entry *copy;
+    uint32_t seq;
+
+    if( cache->table == NULL )
+        return( 1 );
+
+    slot = ssl_cache_shm_slot_of( cache->table, session->id,
+                                  session->id_len );
+
+    if( ( copy = mbedtls_calloc( 1,
+                    sizeof( mbedtls_ssl_cache_shm_entry ) ) ) == NULL )
+        return( 1 );
+
+    /*
+     * Lock-free read: retry while a writer holds the seqlock odd or
+     * changed it under us, then give up - the slot will be consistent
+     * again by the next resumption attempt
+     */
+    for( tries = 0; tries < 3; tries++ )
+    {
+        seq = slot->seq;
+        if( ( seq & 1 ) != 0 )
+            continue;
+
+        memcpy( copy, (const void *) slot,
+                sizeof( mbedtls_ssl_cache_shm_entry ) );
+
+        if( slot->seq == seq )
+            break;
+    }
+
+    if( tries == 3 ||
+        copy->checksum != ssl_cache_shm_sum( copy ) )
+        goto exit;
+
+#if defined(MBEDTLS_HAVE_TIME)
+    if( cache->timeout != 0 &&
+        (int) ( t - copy->timestamp ) > cache->timeout )
+        goto exit;
+#endif
+
+    if( session->ciphersuite != copy->session.ciphersuite ||
+        session->compression != copy->session.compression ||
+        session->id_len != copy->session.id_len )
+        goto exit;
+
+    if( memcmp( session->id, copy->session.id,
+                copy->session.id_len ) != 0 )
+        goto exit;
+
+    memcpy( session->master, copy->session.master, 48 );
+
+    session->verify_result = copy->session.verify_result;
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    /*
+     * Restore peer certificate (without rest of the original chain)
+     */
+    if( copy->cert_len != 0 )
+    {
+        if( ( session->peer_cert = mbedtls_calloc( 1,
+                             sizeof(mbedtls_x509_crt) ) ) == NULL )
+        {
+            goto exit;
+        }
+
+        mbedtls_x509_crt_init( session->peer_cert );
+        if( mbedtls_x509_crt_parse( session->peer_cert, copy->cert,
+                                    copy->cert_len ) != 0 )
+        {
+            mbedtls_free( session->peer_cert );
+            session->peer_cert = NULL;
+            goto exit;
+        }
+    }
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+    ret = 0;
+
+exit:
+    mbedtls_zeroize( copy, sizeof( mbedtls_ssl_cache_shm_entry ) );
+    mbedtls_free( copy );
+
+    return( ret );
+}
+
+int mbedtls_ssl_cache_shm_set( void *data, const mbedtls_ssl_session *session )
+{
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t t = time( NULL );
+#endif
+    mbedtls_ssl_cache_shm_context *cache = (mbedtls_ssl_cache_shm_context *) data;
+    mbedtls_ssl_cache_shm_entry *slot;
+
+    if( cache->table == NULL )
+        return( 1 );
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    /*
+     * The slots are fixed size; a chain-retaining handshake with an
+     * oversized peer certificate is simply not cached
+     */
+    if( session->peer_cert != NULL &&
+        session->peer_cert->raw.len > MBEDTLS_SSL_CACHE_SHM_CERT_LEN )
+    {
+        return( 1 );
+    }
+#endif
+
+    slot = ssl_cache_shm_slot_of( cache->table, session->id,
+                                  session->id_len );
+
+    /*
+     * Open the seqlock. Writers from different workers are not mutually
+     * excluded: if two of them interleave on this slot the checksum
+     * comes out wrong and readers miss, which is the same outcome as
+     * the slot having been overwritten - never a corrupt session.
+     */
+    slot->seq |= 1;
+
+    memset( (void *) ( (unsigned char *) slot + SSL_CACHE_SHM_SUM_START ),
+            0, sizeof( mbedtls_ssl_cache_shm_entry ) -
+               SSL_CACHE_SHM_SUM_START );
+
+#if defined(MBEDTLS_HAVE_TIME)
+    slot->timestamp = t;
+#endif
+
+    memcpy( &slot->session, session, sizeof( mbedtls_ssl_session ) );
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    slot->session.peer_cert = NULL;
+
+    if( session->peer_cert != NULL )
+    {
+        memcpy( slot->cert, session->peer_cert->raw.p,
+                session->peer_cert->raw.len );
+        slot->cert_len = session->peer_cert->raw.len;
+    }
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    slot->session.ticket = NULL;
+    slot->session.ticket_len = 0;
+#endif
+
+    slot->checksum = ssl_cache_shm_sum( slot );
+
+    /* Close the seqlock: readers accept the slot again */
+    slot->seq = ( slot->seq + 1 ) & ~(uint32_t) 1;
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_HAVE_TIME)
+void mbedtls_ssl_cache_shm_set_timeout( mbedtls_ssl_cache_shm_context *cache,
+                                        int timeout )
+{
+    if( timeout < 0 ) timeout = 0;
+
+    cache->timeout = timeout;
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+void mbedtls_ssl_cache_shm_free( mbedtls_ssl_cache_shm_context *cache )
+{
+    if( cache->table != NULL )
+        munmap( (void *) cache->table, cache->map_len );
+
+    if( cache->fd >= 0 )
+        close( cache->fd );
+
+    if( cache->created && cache->name != NULL )
+        shm_unlink( cache->name );
+
+    mbedtls_free( cache->name );
+
+    memset( cache, 0, sizeof( mbedtls_ssl_cache_shm_context ) );
+    cache->fd = -1;
+}
+
+#endif /* MBEDTLS_SSL_CACHE_SHM_C */
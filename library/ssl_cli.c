@@ -49,10 +49,7 @@
 #endif
 
 #if defined(MBEDTLS_SSL_SESSION_TICKETS)
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 #endif
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
@@ -518,6 +515,7 @@ static int ssl_write_client_hello( mbedtls_ssl_context *ssl )
     unsigned char *p, *q;
     unsigned char offer_compress;
     const int *ciphersuites;
+    const mbedtls_ssl_ciphersuite_t **ciphersuite_ptrs;
     const mbedtls_ssl_ciphersuite_t *ciphersuite_info;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write client hello" ) );
@@ -586,7 +584,8 @@ static int ssl_write_client_hello( mbedtls_ssl_context *ssl )
 
     if( n < 16 || n > 32 ||
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
-        ssl->renego_status != MBEDTLS_SSL_INITIAL_HANDSHAKE ||
+        ( ssl->renego_status != MBEDTLS_SSL_INITIAL_HANDSHAKE &&
+          ssl->rekey == 0 ) ||
 #endif
         ssl->handshake->resume == 0 )
     {
@@ -652,6 +651,7 @@ static int ssl_write_client_hello( mbedtls_ssl_context *ssl )
      * Ciphersuite list
      */
     ciphersuites = ssl->conf->ciphersuite_list[ssl->minor_ver];
+    ciphersuite_ptrs = ssl->conf->ciphersuite_info_list[ssl->minor_ver];
 
     /* Skip writing ciphersuite length for now */
     n = 0;
@@ -660,7 +660,10 @@ static int ssl_write_client_hello( mbedtls_ssl_context *ssl )
 
     for( i = 0; ciphersuites[i] != 0; i++ )
     {
-        ciphersuite_info = mbedtls_ssl_ciphersuite_from_id( ciphersuites[i] );
+        if( ciphersuite_ptrs != NULL )
+            ciphersuite_info = ciphersuite_ptrs[i];
+        else
+            ciphersuite_info = mbedtls_ssl_ciphersuite_from_id( ciphersuites[i] );
 
         if( ciphersuite_info == NULL )
             continue;
@@ -1339,7 +1342,8 @@ static int ssl_parse_server_hello( mbedtls_ssl_context *ssl )
      */
     if( ssl->handshake->resume == 0 || n == 0 ||
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
-        ssl->renego_status != MBEDTLS_SSL_INITIAL_HANDSHAKE ||
+        ( ssl->renego_status != MBEDTLS_SSL_INITIAL_HANDSHAKE &&
+          ssl->rekey == 0 ) ||
 #endif
         ssl->session_negotiate->ciphersuite != i ||
         ssl->session_negotiate->compression != comp ||
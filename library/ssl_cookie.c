@@ -44,27 +44,44 @@
 
 #include <string.h>
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * If DTLS is in use, then at least one of SHA-1, SHA-256, SHA-512 is
  * available. Try SHA-256 first, 512 wastes resources since we need to stay
  * with max 32 bytes of cookie for DTLS 1.0
+ *
+ * The HMAC is computed directly on the chosen hash: the key pads are
+ * absorbed once at setup time and the resulting digest states copied into
+ * a stack context per cookie, so the hot path performs no locking, no
+ * allocation and no per-call key schedule.
  */
 #if defined(MBEDTLS_SHA256_C)
-#define COOKIE_MD           MBEDTLS_MD_SHA224
+typedef mbedtls_sha256_context cookie_md_context;
+#define cookie_md_starts( c )       mbedtls_sha256_starts( ( c ), 1 )
+#define cookie_md_update            mbedtls_sha256_update
+#define cookie_md_finish            mbedtls_sha256_finish
 #define COOKIE_MD_OUTLEN    32
+#define COOKIE_MD_DIGEST_LEN 28
+#define COOKIE_MD_BLOCK_LEN 64
 #define COOKIE_HMAC_LEN     28
 #elif defined(MBEDTLS_SHA512_C)
-#define COOKIE_MD           MBEDTLS_MD_SHA384
+typedef mbedtls_sha512_context cookie_md_context;
+#define cookie_md_starts( c )       mbedtls_sha512_starts( ( c ), 1 )
+#define cookie_md_update            mbedtls_sha512_update
+#define cookie_md_finish            mbedtls_sha512_finish
 #define COOKIE_MD_OUTLEN    48
+#define COOKIE_MD_DIGEST_LEN 48
+#define COOKIE_MD_BLOCK_LEN 128
 #define COOKIE_HMAC_LEN     28
 #elif defined(MBEDTLS_SHA1_C)
-#define COOKIE_MD           MBEDTLS_MD_SHA1
+typedef mbedtls_sha1_context cookie_md_context;
+#define cookie_md_starts( c )       mbedtls_sha1_starts( c )
+#define cookie_md_update            mbedtls_sha1_update
+#define cookie_md_finish            mbedtls_sha1_finish
 #define COOKIE_MD_OUTLEN    20
+#define COOKIE_MD_DIGEST_LEN 20
+#define COOKIE_MD_BLOCK_LEN 64
 #define COOKIE_HMAC_LEN     20
 #else
 #error "DTLS hello verify needs SHA-1 or SHA-2"
@@ -78,11 +95,15 @@ static void mbedtls_zeroize( void *v, size_t n ) {
 
 void mbedtls_ssl_cookie_init( mbedtls_ssl_cookie_ctx *ctx )
 {
-    mbedtls_md_init( &ctx->hmac_ctx );
+    memset( &ctx->ipad_ctx, 0, sizeof( ctx->ipad_ctx ) );
+    memset( &ctx->opad_ctx, 0, sizeof( ctx->opad_ctx ) );
 #if !defined(MBEDTLS_HAVE_TIME)
     ctx->serial = 0;
 #endif
     ctx->timeout = MBEDTLS_SSL_COOKIE_TIMEOUT;
+    ctx->rep_table = NULL;
+    ctx->rep_entries = 0;
+    ctx->rep_timeout = MBEDTLS_SSL_COOKIE_REPUTATION_TIMEOUT;
 
 #if defined(MBEDTLS_THREADING_C)
     mbedtls_mutex_init( &ctx->mutex );
@@ -94,14 +115,36 @@ void mbedtls_ssl_cookie_set_timeout( mbedtls_ssl_cookie_ctx *ctx, unsigned long
     ctx->timeout = delay;
 }
 
-void mbedtls_ssl_cookie_free( mbedtls_ssl_cookie_ctx *ctx )
+int mbedtls_ssl_cookie_set_reputation( mbedtls_ssl_cookie_ctx *ctx,
+                                       size_t entries,
+                                       unsigned long timeout )
 {
-    mbedtls_md_free( &ctx->hmac_ctx );
+    mbedtls_free( ctx->rep_table );
+    ctx->rep_table = NULL;
+    ctx->rep_entries = 0;
+
+    if( entries == 0 )
+        return( 0 );
 
+    ctx->rep_table = mbedtls_calloc( entries,
+                                     sizeof( mbedtls_ssl_cookie_rep_entry ) );
+    if( ctx->rep_table == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    ctx->rep_entries = entries;
+    ctx->rep_timeout = timeout;
+
+    return( 0 );
+}
+
+void mbedtls_ssl_cookie_free( mbedtls_ssl_cookie_ctx *ctx )
+{
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_init( &ctx->mutex );
+    mbedtls_mutex_free( &ctx->mutex );
 #endif
 
+    mbedtls_free( ctx->rep_table );
+
     mbedtls_zeroize( ctx, sizeof( mbedtls_ssl_cookie_ctx ) );
 }
 
@@ -110,44 +153,58 @@ int mbedtls_ssl_cookie_setup( mbedtls_ssl_cookie_ctx *ctx,
                       void *p_rng )
 {
     int ret;
+    size_t i;
     unsigned char key[COOKIE_MD_OUTLEN];
+    unsigned char pad[COOKIE_MD_BLOCK_LEN];
 
     if( ( ret = f_rng( p_rng, key, sizeof( key ) ) ) != 0 )
         return( ret );
 
-    ret = mbedtls_md_setup( &ctx->hmac_ctx, mbedtls_md_info_from_type( COOKIE_MD ), 1 );
-    if( ret != 0 )
-        return( ret );
+    for( i = 0; i < sizeof( pad ); i++ )
+        pad[i] = 0x36 ^ ( i < sizeof( key ) ? key[i] : 0 );
 
-    ret = mbedtls_md_hmac_starts( &ctx->hmac_ctx, key, sizeof( key ) );
-    if( ret != 0 )
-        return( ret );
+    cookie_md_starts( &ctx->ipad_ctx );
+    cookie_md_update( &ctx->ipad_ctx, pad, sizeof( pad ) );
+
+    for( i = 0; i < sizeof( pad ); i++ )
+        pad[i] = 0x5C ^ ( i < sizeof( key ) ? key[i] : 0 );
+
+    cookie_md_starts( &ctx->opad_ctx );
+    cookie_md_update( &ctx->opad_ctx, pad, sizeof( pad ) );
 
     mbedtls_zeroize( key, sizeof( key ) );
+    mbedtls_zeroize( pad, sizeof( pad ) );
 
     return( 0 );
 }
 
 /*
  * Generate the HMAC part of a cookie
+ *
+ * Works on stack copies of the pre-keyed digest states, so concurrent
+ * callers only ever read the shared context.
  */
-static int ssl_cookie_hmac( mbedtls_md_context_t *hmac_ctx,
+static int ssl_cookie_hmac( const mbedtls_ssl_cookie_ctx *ctx,
                             const unsigned char time[4],
                             unsigned char **p, unsigned char *end,
                             const unsigned char *cli_id, size_t cli_id_len )
 {
+    cookie_md_context md;
     unsigned char hmac_out[COOKIE_MD_OUTLEN];
 
     if( (size_t)( end - *p ) < COOKIE_HMAC_LEN )
         return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
 
-    if( mbedtls_md_hmac_reset(  hmac_ctx ) != 0 ||
-        mbedtls_md_hmac_update( hmac_ctx, time, 4 ) != 0 ||
-        mbedtls_md_hmac_update( hmac_ctx, cli_id, cli_id_len ) != 0 ||
-        mbedtls_md_hmac_finish( hmac_ctx, hmac_out ) != 0 )
-    {
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-    }
+    md = ctx->ipad_ctx;
+    cookie_md_update( &md, time, 4 );
+    cookie_md_update( &md, cli_id, cli_id_len );
+    cookie_md_finish( &md, hmac_out );
+
+    md = ctx->opad_ctx;
+    cookie_md_update( &md, hmac_out, COOKIE_MD_DIGEST_LEN );
+    cookie_md_finish( &md, hmac_out );
+
+    mbedtls_zeroize( &md, sizeof( md ) );
 
     memcpy( *p, hmac_out, COOKIE_HMAC_LEN );
     *p += COOKIE_HMAC_LEN;
@@ -162,7 +219,9 @@ int mbedtls_ssl_cookie_write( void *p_ctx,
                       unsigned char **p, unsigned char *end,
                       const unsigned char *cli_id, size_t cli_id_len )
 {
+#if !defined(MBEDTLS_HAVE_TIME) && defined(MBEDTLS_THREADING_C)
     int ret;
+#endif
     mbedtls_ssl_cookie_ctx *ctx = (mbedtls_ssl_cookie_ctx *) p_ctx;
     unsigned long t;
 
@@ -175,8 +234,19 @@ int mbedtls_ssl_cookie_write( void *p_ctx,
 #if defined(MBEDTLS_HAVE_TIME)
     t = (unsigned long) time( NULL );
 #else
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR + ret );
+#endif
+
     t = ctx->serial++;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR +
+                MBEDTLS_ERR_THREADING_MUTEX_ERROR );
 #endif
+#endif /* MBEDTLS_HAVE_TIME */
 
     (*p)[0] = (unsigned char)( t >> 24 );
     (*p)[1] = (unsigned char)( t >> 16 );
@@ -184,21 +254,110 @@ int mbedtls_ssl_cookie_write( void *p_ctx,
     (*p)[3] = (unsigned char)( t       );
     *p += 4;
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR + ret );
+    return( ssl_cookie_hmac( ctx, *p - 4, p, end, cli_id, cli_id_len ) );
+}
+
+/*
+ * Keyed tag identifying a source in the reputation table. Plain hashes
+ * would let an attacker precompute source addresses colliding with a
+ * well-reputed client; with the cookie key folded in, slots cannot be
+ * targeted. The tag input carries no timestamp, which keeps it from
+ * ever matching a cookie HMAC input (those start with one).
+ */
+static void ssl_cookie_rep_tag( const mbedtls_ssl_cookie_ctx *ctx,
+                                const unsigned char *cli_id,
+                                size_t cli_id_len,
+                                unsigned char tag[16] )
+{
+    cookie_md_context md;
+    unsigned char out[COOKIE_MD_OUTLEN];
+
+    md = ctx->ipad_ctx;
+    cookie_md_update( &md, cli_id, cli_id_len );
+    cookie_md_finish( &md, out );
+
+    md = ctx->opad_ctx;
+    cookie_md_update( &md, out, COOKIE_MD_DIGEST_LEN );
+    cookie_md_finish( &md, out );
+
+    mbedtls_zeroize( &md, sizeof( md ) );
+
+    memcpy( tag, out, 16 );
+}
+
+static unsigned long ssl_cookie_rep_time( const mbedtls_ssl_cookie_ctx *ctx )
+{
+#if defined(MBEDTLS_HAVE_TIME)
+    ( (void) ctx );
+    return( (unsigned long) time( NULL ) );
+#else
+    return( ctx->serial );
 #endif
+}
+
+static mbedtls_ssl_cookie_rep_entry *ssl_cookie_rep_slot(
+                                        mbedtls_ssl_cookie_ctx *ctx,
+                                        const unsigned char tag[16] )
+{
+    unsigned long h;
+
+    h = ( (unsigned long) tag[0] << 24 ) | ( (unsigned long) tag[1] << 16 ) |
+        ( (unsigned long) tag[2] <<  8 ) | ( (unsigned long) tag[3]       );
+
+    return( &ctx->rep_table[h % ctx->rep_entries] );
+}
+
+/*
+ * Tell whether this source passed a cookie check recently. Read without
+ * the mutex: a slot overwritten concurrently yields a mismatched tag,
+ * which fails towards the normal cookie exchange.
+ */
+static int ssl_cookie_rep_check( mbedtls_ssl_cookie_ctx *ctx,
+                                 const unsigned char *cli_id,
+                                 size_t cli_id_len )
+{
+    unsigned char tag[16];
+    const mbedtls_ssl_cookie_rep_entry *entry;
+
+    ssl_cookie_rep_tag( ctx, cli_id, cli_id_len, tag );
+    entry = ssl_cookie_rep_slot( ctx, tag );
+
+    if( mbedtls_ssl_safer_memcmp( entry->tag, tag, sizeof( tag ) ) != 0 )
+        return( -1 );
+
+    if( ctx->rep_timeout != 0 &&
+        ssl_cookie_rep_time( ctx ) - entry->last_seen > ctx->rep_timeout )
+    {
+        return( -1 );
+    }
+
+    return( 0 );
+}
+
+/*
+ * Record a verified source, evicting whoever held its slot
+ */
+static void ssl_cookie_rep_update( mbedtls_ssl_cookie_ctx *ctx,
+                                   const unsigned char *cli_id,
+                                   size_t cli_id_len )
+{
+    unsigned char tag[16];
+    mbedtls_ssl_cookie_rep_entry *entry;
 
-    ret = ssl_cookie_hmac( &ctx->hmac_ctx, *p - 4,
-                           p, end, cli_id, cli_id_len );
+    ssl_cookie_rep_tag( ctx, cli_id, cli_id_len, tag );
+    entry = ssl_cookie_rep_slot( ctx, tag );
 
 #if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR +
-                MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+    if( mbedtls_mutex_lock( &ctx->mutex ) != 0 )
+        return;
 #endif
 
-    return( ret );
+    entry->last_seen = ssl_cookie_rep_time( ctx );
+    memcpy( entry->tag, tag, sizeof( tag ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &ctx->mutex );
+#endif
 }
 
 /*
@@ -218,24 +377,20 @@ int mbedtls_ssl_cookie_check( void *p_ctx,
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
     if( cookie_len != COOKIE_LEN )
-        return( -1 );
+    {
+        /* A remembered source may open with an empty cookie and skip
+         * the HelloVerifyRequest round trip */
+        if( cookie_len == 0 && ctx->rep_table != NULL )
+            return( ssl_cookie_rep_check( ctx, cli_id, cli_id_len ) );
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR + ret );
-#endif
+        return( -1 );
+    }
 
-    if( ssl_cookie_hmac( &ctx->hmac_ctx, cookie,
+    if( ssl_cookie_hmac( ctx, cookie,
                          &p, p + sizeof( ref_hmac ),
                          cli_id, cli_id_len ) != 0 )
         ret = -1;
 
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR +
-                MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
-
     if( ret != 0 )
         return( ret );
 
@@ -256,6 +411,9 @@ int mbedtls_ssl_cookie_check( void *p_ctx,
     if( ctx->timeout != 0 && cur_time - cookie_time > ctx->timeout )
         return( -1 );
 
+    if( ctx->rep_table != NULL )
+        ssl_cookie_rep_update( ctx, cli_id, cli_id_len );
+
     return( 0 );
 }
 #endif /* MBEDTLS_SSL_COOKIE_C */
@@ -0,0 +1,273 @@
+/*
+ *  Peer-address demultiplexer for DTLS servers
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Separate-chaining hash table over the peer id, with every entry also on
+ * a doubly linked LRU list so that eviction of the coldest connection and
+ * the "touch" on lookup are both O(1).
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_DEMUX_C)
+
+#include "mbedtls/ssl_demux.h"
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#include <string.h>
+
+void mbedtls_ssl_demux_init( mbedtls_ssl_demux_context *demux )
+{
+    memset( demux, 0, sizeof( mbedtls_ssl_demux_context ) );
+}
+
+int mbedtls_ssl_demux_setup( mbedtls_ssl_demux_context *demux,
+                             size_t buckets, size_t max_entries )
+{
+    if( buckets == 0 )
+        buckets = MBEDTLS_SSL_DEMUX_DEFAULT_BUCKETS;
+    if( max_entries == 0 )
+        max_entries = MBEDTLS_SSL_DEMUX_DEFAULT_MAX_ENTRIES;
+
+    demux->buckets = mbedtls_calloc( buckets,
+                                     sizeof( mbedtls_ssl_demux_entry * ) );
+    if( demux->buckets == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    demux->bucket_count = buckets;
+    demux->max_entries = max_entries;
+
+    return( 0 );
+}
+
+/*
+ * FNV-1a over the peer id; good enough distribution for addresses and
+ * only a few bytes long, so it stays cheap in the receive path.
+ */
+static size_t ssl_demux_hash( const mbedtls_ssl_demux_context *demux,
+                              const unsigned char *cli_id, size_t cli_id_len )
+{
+    uint32_t h = 0x811C9DC5;
+    size_t i;
+
+    for( i = 0; i < cli_id_len; i++ )
+        h = ( h ^ cli_id[i] ) * 0x01000193;
+
+    return( (size_t) h % demux->bucket_count );
+}
+
+/*
+ * Move an entry to the head of the LRU list
+ */
+static void ssl_demux_touch( mbedtls_ssl_demux_context *demux,
+                             mbedtls_ssl_demux_entry *entry )
+{
+    if( demux->lru_head == entry )
+        return;
+
+    if( entry->lru_prev != NULL )
+        entry->lru_prev->lru_next = entry->lru_next;
+    if( entry->lru_next != NULL )
+        entry->lru_next->lru_prev = entry->lru_prev;
+    if( demux->lru_tail == entry )
+        demux->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = demux->lru_head;
+    if( demux->lru_head != NULL )
+        demux->lru_head->lru_prev = entry;
+    demux->lru_head = entry;
+    if( demux->lru_tail == NULL )
+        demux->lru_tail = entry;
+}
+
+/*
+ * Unlink an entry from its hash chain and the LRU list
+ */
+static void ssl_demux_unlink( mbedtls_ssl_demux_context *demux,
+                              mbedtls_ssl_demux_entry *entry )
+{
+    size_t slot = ssl_demux_hash( demux, entry->cli_id, entry->cli_id_len );
+    mbedtls_ssl_demux_entry **cur = &demux->buckets[slot];
+
+    while( *cur != NULL && *cur != entry )
+        cur = &(*cur)->chain;
+    if( *cur == entry )
+        *cur = entry->chain;
+
+    if( entry->lru_prev != NULL )
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        demux->lru_head = entry->lru_next;
+    if( entry->lru_next != NULL )
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        demux->lru_tail = entry->lru_prev;
+
+    demux->count--;
+}
+
+static mbedtls_ssl_demux_entry *ssl_demux_lookup(
+                                        mbedtls_ssl_demux_context *demux,
+                                        const unsigned char *cli_id,
+                                        size_t cli_id_len )
+{
+    mbedtls_ssl_demux_entry *entry;
+    size_t slot = ssl_demux_hash( demux, cli_id, cli_id_len );
+
+    for( entry = demux->buckets[slot]; entry != NULL; entry = entry->chain )
+    {
+        if( entry->cli_id_len == cli_id_len &&
+            memcmp( entry->cli_id, cli_id, cli_id_len ) == 0 )
+        {
+            return( entry );
+        }
+    }
+
+    return( NULL );
+}
+
+int mbedtls_ssl_demux_add( mbedtls_ssl_demux_context *demux,
+                           const unsigned char *cli_id, size_t cli_id_len,
+                           mbedtls_ssl_context *ssl,
+                           mbedtls_ssl_context **evicted )
+{
+    mbedtls_ssl_demux_entry *entry;
+    size_t slot;
+
+    if( evicted != NULL )
+        *evicted = NULL;
+
+    if( demux->buckets == NULL ||
+        cli_id_len == 0 || cli_id_len > MBEDTLS_SSL_DEMUX_MAX_ID_LEN ||
+        ssl_demux_lookup( demux, cli_id, cli_id_len ) != NULL )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    /* Evict the least recently used connection when full, reusing its
+     * entry for the newcomer */
+    if( demux->count >= demux->max_entries && demux->lru_tail != NULL )
+    {
+        entry = demux->lru_tail;
+
+        if( evicted != NULL )
+            *evicted = entry->ssl;
+
+        ssl_demux_unlink( demux, entry );
+        memset( entry, 0, sizeof( mbedtls_ssl_demux_entry ) );
+    }
+    else
+    {
+        entry = mbedtls_calloc( 1, sizeof( mbedtls_ssl_demux_entry ) );
+        if( entry == NULL )
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    memcpy( entry->cli_id, cli_id, cli_id_len );
+    entry->cli_id_len = cli_id_len;
+    entry->ssl = ssl;
+
+    slot = ssl_demux_hash( demux, cli_id, cli_id_len );
+    entry->chain = demux->buckets[slot];
+    demux->buckets[slot] = entry;
+
+    entry->lru_next = demux->lru_head;
+    if( demux->lru_head != NULL )
+        demux->lru_head->lru_prev = entry;
+    demux->lru_head = entry;
+    if( demux->lru_tail == NULL )
+        demux->lru_tail = entry;
+
+    demux->count++;
+
+    return( 0 );
+}
+
+mbedtls_ssl_context *mbedtls_ssl_demux_find( mbedtls_ssl_demux_context *demux,
+                                             const unsigned char *cli_id,
+                                             size_t cli_id_len )
+{
+    mbedtls_ssl_demux_entry *entry;
+
+    if( demux->buckets == NULL )
+        return( NULL );
+
+    entry = ssl_demux_lookup( demux, cli_id, cli_id_len );
+    if( entry == NULL )
+        return( NULL );
+
+    ssl_demux_touch( demux, entry );
+
+    return( entry->ssl );
+}
+
+int mbedtls_ssl_demux_remove( mbedtls_ssl_demux_context *demux,
+                              const unsigned char *cli_id,
+                              size_t cli_id_len )
+{
+    mbedtls_ssl_demux_entry *entry;
+
+    if( demux->buckets == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    entry = ssl_demux_lookup( demux, cli_id, cli_id_len );
+    if( entry == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ssl_demux_unlink( demux, entry );
+    mbedtls_free( entry );
+
+    return( 0 );
+}
+
+size_t mbedtls_ssl_demux_len( const mbedtls_ssl_demux_context *demux )
+{
+    return( demux->count );
+}
+
+void mbedtls_ssl_demux_free( mbedtls_ssl_demux_context *demux )
+{
+    mbedtls_ssl_demux_entry *entry, *next;
+
+    for( entry = demux->lru_head; entry != NULL; entry = next )
+    {
+        next = entry->lru_next;
+        mbedtls_free( entry );
+    }
+
+    mbedtls_free( demux->buckets );
+
+    memset( demux, 0, sizeof( mbedtls_ssl_demux_context ) );
+}
+
+#endif /* MBEDTLS_SSL_DEMUX_C */
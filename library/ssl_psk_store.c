@@ -0,0 +1,259 @@
+/*
+ *  SSL PSK identity store implementation
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * An open-addressing hash table over identity bytes, built for servers
+ * with a large, read-mostly identity population. Lookups from the PSK
+ * callback take no lock: slots are never moved or reclaimed, and a
+ * writer publishes a new entry by storing its identity pointer last,
+ * so concurrent handshakes never contend on a store mutex.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+/* MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED is derived here */
+#include "mbedtls/ssl.h"
+
+#if defined(MBEDTLS_SSL_PSK_STORE_C) && \
+    defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED)
+
+#include "mbedtls/ssl_psk_store.h"
+#include "mbedtls/constant_time.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+void mbedtls_ssl_psk_store_init( mbedtls_ssl_psk_store_context *store )
+{
+    memset( store, 0, sizeof( mbedtls_ssl_psk_store_context ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &store->mutex );
+#endif
+}
+
+/*
+ * FNV-1a: identities are often structured (serial numbers, MAC
+ * addresses), so unlike session IDs they need real mixing.
+ */
+static unsigned int ssl_psk_store_hash( const unsigned char *identity,
+                                        size_t identity_len )
+{
+    unsigned int hash = 0x811C9DC5;
+    size_t i;
+
+    for( i = 0; i < identity_len; i++ )
+        hash = ( hash ^ identity[i] ) * 0x01000193;
+
+    return( hash );
+}
+
+int mbedtls_ssl_psk_store_setup( mbedtls_ssl_psk_store_context *store,
+                                 size_t capacity )
+{
+    size_t num_slots = 16;
+
+    if( capacity == 0 )
+        capacity = MBEDTLS_SSL_PSK_STORE_DEFAULT_CAPACITY;
+
+    /* Keep the table at most half full so that probe chains stay short */
+    while( num_slots < capacity * 2 )
+        num_slots <<= 1;
+
+    store->table = mbedtls_calloc( num_slots,
+                                   sizeof( mbedtls_ssl_psk_store_entry ) );
+    if( store->table == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    store->num_slots = num_slots;
+    store->used = 0;
+
+    return( 0 );
+}
+
+int mbedtls_ssl_psk_store_set( mbedtls_ssl_psk_store_context *store,
+                               const unsigned char *identity,
+                               size_t identity_len,
+                               const unsigned char *psk, size_t psk_len )
+{
+    int ret = 0;
+    unsigned int hash;
+    size_t i, old_psk_len;
+    unsigned char *new_psk, *old_psk;
+    mbedtls_ssl_psk_store_entry *entry;
+
+    if( identity_len == 0 || psk_len == 0 || store->table == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    hash = ssl_psk_store_hash( identity, identity_len );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &store->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    i = hash & ( store->num_slots - 1 );
+    while( ( entry = &store->table[i] )->identity != NULL )
+    {
+        if( entry->hash == hash &&
+            entry->identity_len == identity_len &&
+            memcmp( entry->identity, identity, identity_len ) == 0 )
+        {
+            break;
+        }
+
+        i = ( i + 1 ) & ( store->num_slots - 1 );
+    }
+
+    if( entry->identity == NULL && store->used >= store->num_slots / 2 )
+    {
+        ret = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+        goto exit;
+    }
+
+    new_psk = mbedtls_calloc( 1, psk_len );
+    if( new_psk == NULL )
+    {
+        ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+        goto exit;
+    }
+    memcpy( new_psk, psk, psk_len );
+
+    if( entry->identity != NULL )
+    {
+        /* Existing identity: swap the key in. See the header for why
+         * this must not race a handshake using this identity. */
+        old_psk = entry->psk;
+        old_psk_len = entry->psk_len;
+        entry->psk = new_psk;
+        entry->psk_len = psk_len;
+        mbedtls_zeroize( old_psk, old_psk_len );
+        mbedtls_free( old_psk );
+        goto exit;
+    }
+
+    entry->identity = mbedtls_calloc( 1, identity_len );
+    if( entry->identity == NULL )
+    {
+        mbedtls_zeroize( new_psk, psk_len );
+        mbedtls_free( new_psk );
+        ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+        goto exit;
+    }
+
+    /* Fill the slot completely before publishing it: lock-free readers
+     * probe past slots whose identity pointer is still NULL */
+    entry->psk = new_psk;
+    entry->psk_len = psk_len;
+    entry->hash = hash;
+    entry->identity_len = identity_len;
+    memcpy( entry->identity, identity, identity_len );
+
+    store->used++;
+
+exit:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &store->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( ret );
+}
+
+int mbedtls_ssl_psk_store_get( void *data, mbedtls_ssl_context *ssl,
+                               const unsigned char *identity,
+                               size_t identity_len )
+{
+    mbedtls_ssl_psk_store_context *store = (mbedtls_ssl_psk_store_context *) data;
+    unsigned int hash;
+    size_t i;
+    mbedtls_ssl_psk_store_entry *entry;
+
+    if( identity_len == 0 || store->table == NULL )
+        return( MBEDTLS_ERR_SSL_UNKNOWN_IDENTITY );
+
+    hash = ssl_psk_store_hash( identity, identity_len );
+
+    i = hash & ( store->num_slots - 1 );
+    while( ( entry = &store->table[i] )->identity != NULL )
+    {
+        if( entry->hash == hash &&
+            entry->identity_len == identity_len &&
+            mbedtls_ct_memcmp( entry->identity, identity,
+                               identity_len ) == 0 )
+        {
+            if( mbedtls_ssl_set_hs_psk( ssl, entry->psk,
+                                        entry->psk_len ) != 0 )
+                return( MBEDTLS_ERR_SSL_UNKNOWN_IDENTITY );
+
+            return( 0 );
+        }
+
+        i = ( i + 1 ) & ( store->num_slots - 1 );
+    }
+
+    return( MBEDTLS_ERR_SSL_UNKNOWN_IDENTITY );
+}
+
+void mbedtls_ssl_conf_psk_store( mbedtls_ssl_config *conf,
+                                 mbedtls_ssl_psk_store_context *store )
+{
+    mbedtls_ssl_conf_psk_cb( conf, mbedtls_ssl_psk_store_get, store );
+}
+
+void mbedtls_ssl_psk_store_free( mbedtls_ssl_psk_store_context *store )
+{
+    size_t i;
+    mbedtls_ssl_psk_store_entry *entry;
+
+    for( i = 0; i < store->num_slots; i++ )
+    {
+        entry = &store->table[i];
+
+        if( entry->identity == NULL )
+            continue;
+
+        mbedtls_zeroize( entry->psk, entry->psk_len );
+        mbedtls_free( entry->psk );
+        mbedtls_free( entry->identity );
+    }
+
+    mbedtls_free( store->table );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &store->mutex );
+#endif
+
+    memset( store, 0, sizeof( mbedtls_ssl_psk_store_context ) );
+}
+
+#endif /* MBEDTLS_SSL_PSK_STORE_C && MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED */
@@ -0,0 +1,229 @@
+/*
+ *  Round-robin scheduler for concurrent SSL handshakes
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * The queue is a singly linked list walked with a persistent cursor, so
+ * that successive calls to mbedtls_ssl_sched_run() resume the round-robin
+ * where the previous one stopped instead of favouring the queue head.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_SCHED_C)
+
+#include "mbedtls/ssl_sched.h"
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#include <string.h>
+
+void mbedtls_ssl_sched_init( mbedtls_ssl_sched_context *sched )
+{
+    memset( sched, 0, sizeof( mbedtls_ssl_sched_context ) );
+
+    sched->budget = MBEDTLS_SSL_SCHED_DEFAULT_BUDGET;
+}
+
+void mbedtls_ssl_sched_set_budget( mbedtls_ssl_sched_context *sched,
+                                   int budget )
+{
+    if( budget < 1 )
+        budget = 1;
+
+    sched->budget = budget;
+}
+
+void mbedtls_ssl_sched_set_done_cb( mbedtls_ssl_sched_context *sched,
+        void (*f_done)( void *, mbedtls_ssl_context *, int ),
+        void *p_done )
+{
+    sched->f_done = f_done;
+    sched->p_done = p_done;
+}
+
+int mbedtls_ssl_sched_add( mbedtls_ssl_sched_context *sched,
+                           mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_sched_item *item, **tail;
+
+    for( tail = &sched->queue; *tail != NULL; tail = &(*tail)->next )
+        if( (*tail)->ssl == ssl )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ( item = mbedtls_calloc( 1, sizeof( mbedtls_ssl_sched_item ) ) ) == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    item->ssl = ssl;
+    *tail = item;
+    sched->queue_len++;
+
+    return( 0 );
+}
+
+/*
+ * Unlink an item, keeping the cursor valid: if it pointed at the removed
+ * item, move it to the successor (possibly wrapping to the head).
+ */
+static void ssl_sched_unlink( mbedtls_ssl_sched_context *sched,
+                              mbedtls_ssl_sched_item *item )
+{
+    mbedtls_ssl_sched_item **cur;
+
+    for( cur = &sched->queue; *cur != NULL; cur = &(*cur)->next )
+    {
+        if( *cur != item )
+            continue;
+
+        *cur = item->next;
+
+        if( sched->cur == item )
+            sched->cur = item->next != NULL ? item->next : sched->queue;
+
+        mbedtls_free( item );
+        sched->queue_len--;
+        return;
+    }
+}
+
+void mbedtls_ssl_sched_remove( mbedtls_ssl_sched_context *sched,
+                               mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_sched_item *item;
+
+    for( item = sched->queue; item != NULL; item = item->next )
+    {
+        if( item->ssl == ssl )
+        {
+            ssl_sched_unlink( sched, item );
+            return;
+        }
+    }
+}
+
+/*
+ * Run one budgeted slice for a single connection.
+ *
+ * Returns 0 if the connection keeps its place in the queue (slice used up
+ * or waiting on I/O or an asynchronous operation), 1 if it is done and
+ * should be removed, with the final status in *status.
+ */
+static int ssl_sched_slice( mbedtls_ssl_sched_context *sched,
+                            mbedtls_ssl_context *ssl, int *status )
+{
+    int ret = 0, steps;
+
+    for( steps = 0; steps < sched->budget; steps++ )
+    {
+        if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
+            break;
+
+        ret = mbedtls_ssl_handshake_step( ssl );
+
+        if( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+            ret == MBEDTLS_ERR_SSL_WANT_WRITE )
+            return( 0 );
+
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+        if( ret == MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS )
+            return( 0 );
+#endif
+
+        if( ret != 0 )
+        {
+            *status = ret;
+            return( 1 );
+        }
+    }
+
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        *status = 0;
+        return( 1 );
+    }
+
+    return( 0 );
+}
+
+int mbedtls_ssl_sched_run( mbedtls_ssl_sched_context *sched,
+                           size_t max_conns )
+{
+    mbedtls_ssl_sched_item *item;
+    size_t visited;
+    int done = 0, status;
+
+    if( max_conns == 0 || max_conns > sched->queue_len )
+        max_conns = sched->queue_len;
+
+    for( visited = 0; visited < max_conns && sched->queue != NULL; visited++ )
+    {
+        if( sched->cur == NULL )
+            sched->cur = sched->queue;
+
+        item = sched->cur;
+
+        if( ssl_sched_slice( sched, item->ssl, &status ) != 0 )
+        {
+            mbedtls_ssl_context *ssl = item->ssl;
+
+            ssl_sched_unlink( sched, item );
+            done++;
+
+            if( sched->f_done != NULL )
+                sched->f_done( sched->p_done, ssl, status );
+        }
+        else
+        {
+            sched->cur = item->next != NULL ? item->next : sched->queue;
+        }
+    }
+
+    return( done );
+}
+
+size_t mbedtls_ssl_sched_queue_len( const mbedtls_ssl_sched_context *sched )
+{
+    return( sched->queue_len );
+}
+
+void mbedtls_ssl_sched_free( mbedtls_ssl_sched_context *sched )
+{
+    mbedtls_ssl_sched_item *item, *next;
+
+    for( item = sched->queue; item != NULL; item = next )
+    {
+        next = item->next;
+        mbedtls_free( item );
+    }
+
+    memset( sched, 0, sizeof( mbedtls_ssl_sched_context ) );
+}
+
+#endif /* MBEDTLS_SSL_SCHED_C */
@@ -51,10 +51,7 @@
 #endif
 
 #if defined(MBEDTLS_SSL_SESSION_TICKETS)
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 #endif
 
 #if defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY)
@@ -117,14 +114,27 @@ static int ssl_parse_servername_ext( mbedtls_ssl_context *ssl,
 
         if( p[0] == MBEDTLS_TLS_EXT_SERVERNAME_HOSTNAME )
         {
-            ret = ssl->conf->f_sni( ssl->conf->p_sni,
-                                    ssl, p + 3, hostname_len );
-            if( ret != 0 )
+            if( ssl->conf->f_sni != NULL )
             {
-                MBEDTLS_SSL_DEBUG_RET( 1, "ssl_sni_wrapper", ret );
-                mbedtls_ssl_send_alert_message( ssl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
-                        MBEDTLS_SSL_ALERT_MSG_UNRECOGNIZED_NAME );
-                return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_HELLO );
+                ret = ssl->conf->f_sni( ssl->conf->p_sni,
+                                        ssl, p + 3, hostname_len );
+                if( ret != 0 )
+                {
+                    MBEDTLS_SSL_DEBUG_RET( 1, "ssl_sni_wrapper", ret );
+                    mbedtls_ssl_send_alert_message( ssl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
+                            MBEDTLS_SSL_ALERT_MSG_UNRECOGNIZED_NAME );
+                    return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_HELLO );
+                }
+            }
+            else
+            {
+                ret = mbedtls_ssl_sni_select_cert( ssl, p + 3, hostname_len );
+                if( ret != 0 )
+                {
+                    MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_sni_select_cert",
+                                           ret );
+                    return( ret );
+                }
             }
             return( 0 );
         }
@@ -194,7 +204,8 @@ static int ssl_parse_signature_algorithms_ext( mbedtls_ssl_context *ssl,
     size_t sig_alg_list_size;
     const unsigned char *p;
     const unsigned char *end = buf + len;
-    const int *md_cur;
+    uint32_t offered = 0;
+    unsigned char rank;
 
 
     sig_alg_list_size = ( ( buf[0] << 8 ) | ( buf[1] ) );
@@ -209,22 +220,35 @@ static int ssl_parse_signature_algorithms_ext( mbedtls_ssl_context *ssl,
      * For now, ignore the SignatureAlgorithm part and rely on offered
      * ciphersuites only for that part. To be fixed later.
      *
-     * So, just look at the HashAlgorithm part.
+     * So, just look at the HashAlgorithm part: collect the offered hashes
+     * as a bitset of their rank in our preference list, then the preferred
+     * one in common is the lowest set bit.
      */
-    for( md_cur = ssl->conf->sig_hashes; *md_cur != MBEDTLS_MD_NONE; md_cur++ ) {
-        for( p = buf + 2; p < end; p += 2 ) {
-            if( *md_cur == (int) mbedtls_ssl_md_alg_from_hash( p[0] ) ) {
-                ssl->handshake->sig_alg = p[0];
-                goto have_sig_alg;
-            }
+    for( p = buf + 2; p < end; p += 2 )
+    {
+        if( p[0] <= MBEDTLS_SSL_HASH_SHA512 &&
+            ssl->conf->sig_hash_rank[p[0]] != 0 )
+        {
+            offered |= (uint32_t) 1 << ( ssl->conf->sig_hash_rank[p[0]] - 1 );
         }
     }
 
-    /* Some key echanges do not need signatures at all */
-    MBEDTLS_SSL_DEBUG_MSG( 3, ( "no signature_algorithm in common" ) );
-    return( 0 );
+    if( offered == 0 )
+    {
+        /* Some key echanges do not need signatures at all */
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "no signature_algorithm in common" ) );
+        return( 0 );
+    }
+
+    rank = 0;
+    while( ( offered & 1 ) == 0 )
+    {
+        offered >>= 1;
+        rank++;
+    }
+
+    ssl->handshake->sig_alg = ssl->conf->sig_hash_by_rank[rank];
 
-have_sig_alg:
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "client hello v3, signature_algorithm ext: %d",
                    ssl->handshake->sig_alg ) );
 
@@ -238,9 +262,10 @@ static int ssl_parse_supported_elliptic_curves( mbedtls_ssl_context *ssl,
                                                 const unsigned char *buf,
                                                 size_t len )
 {
-    size_t list_size, our_size;
+    size_t list_size;
     const unsigned char *p;
-    const mbedtls_ecp_curve_info *curve_info, **curves;
+    const mbedtls_ecp_curve_info *curve_info;
+    uint32_t mask = 0;
 
     list_size = ( ( buf[0] << 8 ) | ( buf[1] ) );
     if( list_size + 2 != len ||
@@ -251,38 +276,30 @@ static int ssl_parse_supported_elliptic_curves( mbedtls_ssl_context *ssl,
     }
 
     /* Should never happen unless client duplicates the extension */
-    if( ssl->handshake->curves != NULL )
+    if( ssl->handshake->curves_parsed != 0 )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad client hello message" ) );
         return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_HELLO );
     }
 
-    /* Don't allow our peer to make us allocate too much memory,
-     * and leave room for a final 0 */
-    our_size = list_size / 2 + 1;
-    if( our_size > MBEDTLS_ECP_DP_MAX )
-        our_size = MBEDTLS_ECP_DP_MAX;
-
-    if( ( curves = mbedtls_calloc( our_size, sizeof( *curves ) ) ) == NULL )
-        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
-
-    ssl->handshake->curves = curves;
+    ssl->handshake->curves_parsed = 1;
 
     p = buf + 2;
-    while( list_size > 0 && our_size > 1 )
+    while( list_size > 0 )
     {
         curve_info = mbedtls_ecp_curve_info_from_tls_id( ( p[0] << 8 ) | p[1] );
 
         if( curve_info != NULL )
-        {
-            *curves++ = curve_info;
-            our_size--;
-        }
+            mask |= (uint32_t) 1 << curve_info->grp_id;
 
         list_size -= 2;
         p += 2;
     }
 
+    /* Keep only the curves we are willing to use, so that later checks
+     * are a single bit test */
+    ssl->handshake->curves_mask = mask & ssl->conf->curve_mask;
+
     return( 0 );
 }
 
@@ -437,8 +454,9 @@ static int ssl_parse_session_ticket_ext( mbedtls_ssl_context *ssl,
     /*
      * Failures are ok: just ignore the ticket and proceed.
      */
-    if( ( ret = ssl->conf->f_ticket_parse( ssl->conf->p_ticket, &session,
-                                           buf, len ) ) != 0 )
+    ret = ssl->conf->f_ticket_parse( ssl->conf->p_ticket, &session,
+                                     buf, len );
+    if( ret != 0 && ret != MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH )
     {
         mbedtls_ssl_session_free( &session );
 
@@ -469,8 +487,12 @@ static int ssl_parse_session_ticket_ext( mbedtls_ssl_context *ssl,
 
     ssl->handshake->resume = 1;
 
-    /* Don't send a new ticket after all, this one is OK */
-    ssl->handshake->new_session_ticket = 0;
+    /* Don't send a new ticket after all, this one is OK - unless the
+     * callback asked for the ticket to be renewed */
+    if( ret == MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH )
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "ticket is in its renewal window" ) );
+    else
+        ssl->handshake->new_session_ticket = 0;
 
     return( 0 );
 }
@@ -550,17 +572,12 @@ static int ssl_parse_alpn_ext( mbedtls_ssl_context *ssl,
  */
 #if defined(MBEDTLS_ECDSA_C)
 static int ssl_check_key_curve( mbedtls_pk_context *pk,
-                                const mbedtls_ecp_curve_info **curves )
+                                uint32_t curves_mask )
 {
-    const mbedtls_ecp_curve_info **crv = curves;
     mbedtls_ecp_group_id grp_id = mbedtls_pk_ec( *pk )->grp.id;
 
-    while( *crv != NULL )
-    {
-        if( (*crv)->grp_id == grp_id )
-            return( 0 );
-        crv++;
-    }
+    if( curves_mask & ( (uint32_t) 1 << grp_id ) )
+        return( 0 );
 
     return( -1 );
 }
@@ -624,7 +641,7 @@ static int ssl_pick_cert( mbedtls_ssl_context *ssl,
 
 #if defined(MBEDTLS_ECDSA_C)
         if( pk_alg == MBEDTLS_PK_ECDSA &&
-            ssl_check_key_curve( cur->key, ssl->handshake->curves ) != 0 )
+            ssl_check_key_curve( cur->key, ssl->handshake->curves_mask ) != 0 )
         {
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "certificate mismatch: elliptic curve" ) );
             continue;
@@ -668,16 +685,48 @@ static int ssl_pick_cert( mbedtls_ssl_context *ssl,
 }
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
+#if !defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
+/*
+ * Presence filter over the ciphersuites offered by the client: a bitmap
+ * of the high ID bytes seen and a bitmap of the low ID bytes seen. It is
+ * filled during the pass over the offered list that looks for the SCSVs,
+ * and lets the selection loop reject most suites the client did not offer
+ * without walking the offered list again. A positive answer is only a
+ * "maybe" (the two bytes may come from different offers), so it must be
+ * confirmed by the exact comparison in the selection loop.
+ */
+static void ssl_suite_filter_add( unsigned char filter[2][32],
+                                  const unsigned char suite[2] )
+{
+    filter[0][suite[0] >> 3] |= 1 << ( suite[0] & 7 );
+    filter[1][suite[1] >> 3] |= 1 << ( suite[1] & 7 );
+}
+
+static int ssl_suite_filter_may_contain( const unsigned char filter[2][32],
+                                         int suite_id )
+{
+    unsigned char hi = ( suite_id >> 8 ) & 0xFF;
+    unsigned char lo = ( suite_id      ) & 0xFF;
+
+    return( ( filter[0][hi >> 3] & ( 1 << ( hi & 7 ) ) ) != 0 &&
+            ( filter[1][lo >> 3] & ( 1 << ( lo & 7 ) ) ) != 0 );
+}
+#endif /* !MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE */
+
 /*
  * Check if a given ciphersuite is suitable for use with our config/keys/etc
  * Sets ciphersuite_info only if the suite matches.
+ *
+ * When the configuration-time gate for the suite is available it
+ * replaces the configuration-static predicates below with one flag
+ * test; only the common-curve check and the certificate selection
+ * still run per handshake.
  */
-static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl, int suite_id,
+static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl,
+                                  const mbedtls_ssl_ciphersuite_t *suite_info,
+                                  unsigned char gate,
                                   const mbedtls_ssl_ciphersuite_t **ciphersuite_info )
 {
-    const mbedtls_ssl_ciphersuite_t *suite_info;
-
-    suite_info = mbedtls_ssl_ciphersuite_from_id( suite_id );
     if( suite_info == NULL )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
@@ -686,6 +735,28 @@ static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl, int suite_id,
 
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "trying ciphersuite: %s", suite_info->name ) );
 
+    if( ( gate & MBEDTLS_SSL_SUITE_GATE_VALID ) != 0 )
+    {
+        if( ( gate & MBEDTLS_SSL_SUITE_GATE_ACCEPT ) == 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "ciphersuite mismatch: "
+                                "gated at configuration time" ) );
+            return( 0 );
+        }
+
+#if defined(MBEDTLS_ECDH_C) || defined(MBEDTLS_ECDSA_C)
+        if( ( gate & MBEDTLS_SSL_SUITE_GATE_USES_EC ) != 0 &&
+            ssl->handshake->curves_mask == 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "ciphersuite mismatch: "
+                                "no common elliptic curve" ) );
+            return( 0 );
+        }
+#endif
+
+        goto static_checks_done;
+    }
+
     if( suite_info->min_minor_ver > ssl->minor_ver ||
         suite_info->max_minor_ver < ssl->minor_ver )
     {
@@ -710,8 +781,7 @@ static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl, int suite_id,
 
 #if defined(MBEDTLS_ECDH_C) || defined(MBEDTLS_ECDSA_C)
     if( mbedtls_ssl_ciphersuite_uses_ec( suite_info ) &&
-        ( ssl->handshake->curves == NULL ||
-          ssl->handshake->curves[0] == NULL ) )
+        ssl->handshake->curves_mask == 0 )
     {
         MBEDTLS_SSL_DEBUG_MSG( 3, ( "ciphersuite mismatch: "
                             "no common elliptic curve" ) );
@@ -732,6 +802,8 @@ static int ssl_ciphersuite_match( mbedtls_ssl_context *ssl, int suite_id,
     }
 #endif
 
+static_checks_done:
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     /*
      * Final check: if ciphersuite requires us to have a
@@ -761,6 +833,9 @@ static int ssl_parse_client_hello_v2( mbedtls_ssl_context *ssl )
     unsigned int ciph_len, sess_len, chal_len;
     unsigned char *buf, *p;
     const int *ciphersuites;
+    const mbedtls_ssl_ciphersuite_t **ciphersuite_ptrs;
+    const unsigned char *ciphersuite_gates;
+    const mbedtls_ssl_ciphersuite_t *suite_info;
     const mbedtls_ssl_ciphersuite_t *ciphersuite_info;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> parse client hello v2" ) );
@@ -955,6 +1030,8 @@ static int ssl_parse_client_hello_v2( mbedtls_ssl_context *ssl )
 
     got_common_suite = 0;
     ciphersuites = ssl->conf->ciphersuite_list[ssl->minor_ver];
+    ciphersuite_ptrs = ssl->conf->ciphersuite_info_list[ssl->minor_ver];
+    ciphersuite_gates = ssl->conf->ciphersuite_gate[ssl->minor_ver];
     ciphersuite_info = NULL;
 #if defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
     for( j = 0, p = buf + 6; j < ciph_len; j += 3, p += 3 )
@@ -973,7 +1050,14 @@ static int ssl_parse_client_hello_v2( mbedtls_ssl_context *ssl )
 
             got_common_suite = 1;
 
-            if( ( ret = ssl_ciphersuite_match( ssl, ciphersuites[i],
+            if( ciphersuite_ptrs != NULL )
+                suite_info = ciphersuite_ptrs[i];
+            else
+                suite_info = mbedtls_ssl_ciphersuite_from_id( ciphersuites[i] );
+
+            if( ( ret = ssl_ciphersuite_match( ssl, suite_info,
+                                               ciphersuite_gates != NULL ?
+                                               ciphersuite_gates[i] : 0,
                                                &ciphersuite_info ) ) != 0 )
                 return( ret );
 
@@ -1039,7 +1123,13 @@ static int ssl_parse_client_hello( mbedtls_ssl_context *ssl )
 #endif
     int handshake_failure = 0;
     const int *ciphersuites;
+    const mbedtls_ssl_ciphersuite_t **ciphersuite_ptrs;
+    const unsigned char *ciphersuite_gates;
+    const mbedtls_ssl_ciphersuite_t *suite_info;
     const mbedtls_ssl_ciphersuite_t *ciphersuite_info;
+#if !defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
+    unsigned char suite_filter[2][32];
+#endif
     int major, minor;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> parse client hello" ) );
@@ -1173,6 +1263,9 @@ read_record_header:
             ssl->next_record_offset = msg_len + mbedtls_ssl_hdr_len( ssl );
         else
 #endif
+        if( ssl->conf->read_ahead )
+            ssl->next_record_offset = msg_len + mbedtls_ssl_hdr_len( ssl );
+        else
             ssl->in_left = 0;
     }
 
@@ -1506,7 +1599,7 @@ read_record_header:
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
         case MBEDTLS_TLS_EXT_SERVERNAME:
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "found ServerName extension" ) );
-            if( ssl->conf->f_sni == NULL )
+            if( ssl->conf->f_sni == NULL && ssl->conf->sni_table == NULL )
                 break;
 
             ret = ssl_parse_servername_ext( ssl, ext + 4, ext_size );
@@ -1636,9 +1729,21 @@ read_record_header:
         }
     }
 
-#if defined(MBEDTLS_SSL_FALLBACK_SCSV)
-    for( i = 0, p = buf + 41 + sess_len; i < ciph_len; i += 2, p += 2 )
+    /*
+     * Walk the offered ciphersuite list once: check for the SCSVs, and
+     * build the presence filter used by the selection loop below.
+     */
+#if !defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
+    memset( suite_filter, 0, sizeof( suite_filter ) );
+#endif
+
+    for( i = 0, p = buf + ciph_offset + 2; i < ciph_len; i += 2, p += 2 )
     {
+#if !defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
+        ssl_suite_filter_add( suite_filter, p );
+#endif
+
+#if defined(MBEDTLS_SSL_FALLBACK_SCSV)
         if( p[0] == (unsigned char)( ( MBEDTLS_SSL_FALLBACK_SCSV_VALUE >> 8 ) & 0xff ) &&
             p[1] == (unsigned char)( ( MBEDTLS_SSL_FALLBACK_SCSV_VALUE      ) & 0xff ) )
         {
@@ -1653,17 +1758,12 @@ read_record_header:
 
                 return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_HELLO );
             }
-
-            break;
         }
-    }
 #endif /* MBEDTLS_SSL_FALLBACK_SCSV */
 
-    /*
-     * Check for TLS_EMPTY_RENEGOTIATION_INFO_SCSV
-     */
-    for( i = 0, p = buf + ciph_offset + 2; i < ciph_len; i += 2, p += 2 )
-    {
+        /*
+         * Check for TLS_EMPTY_RENEGOTIATION_INFO_SCSV
+         */
         if( p[0] == 0 && p[1] == MBEDTLS_SSL_EMPTY_RENEGOTIATION_INFO )
         {
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "received TLS_EMPTY_RENEGOTIATION_INFO " ) );
@@ -1679,7 +1779,6 @@ read_record_header:
             }
 #endif
             ssl->secure_renegotiation = MBEDTLS_SSL_SECURE_RENEGOTIATION;
-            break;
         }
     }
 
@@ -1731,6 +1830,8 @@ read_record_header:
      */
     got_common_suite = 0;
     ciphersuites = ssl->conf->ciphersuite_list[ssl->minor_ver];
+    ciphersuite_ptrs = ssl->conf->ciphersuite_info_list[ssl->minor_ver];
+    ciphersuite_gates = ssl->conf->ciphersuite_gate[ssl->minor_ver];
     ciphersuite_info = NULL;
 #if defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
     for( j = 0, p = buf + ciph_offset + 2; j < ciph_len; j += 2, p += 2 )
@@ -1739,6 +1840,9 @@ read_record_header:
 #else
     for( i = 0; ciphersuites[i] != 0; i++ )
     {
+        if( ssl_suite_filter_may_contain( suite_filter, ciphersuites[i] ) == 0 )
+            continue;
+
         for( j = 0, p = buf + ciph_offset + 2; j < ciph_len; j += 2, p += 2 )
 #endif
         {
@@ -1748,7 +1852,14 @@ read_record_header:
 
             got_common_suite = 1;
 
-            if( ( ret = ssl_ciphersuite_match( ssl, ciphersuites[i],
+            if( ciphersuite_ptrs != NULL )
+                suite_info = ciphersuite_ptrs[i];
+            else
+                suite_info = mbedtls_ssl_ciphersuite_from_id( ciphersuites[i] );
+
+            if( ( ret = ssl_ciphersuite_match( ssl, suite_info,
+                                               ciphersuite_gates != NULL ?
+                                               ciphersuite_gates[i] : 0,
                                                &ciphersuite_info ) ) != 0 )
                 return( ret );
 
@@ -2175,6 +2286,34 @@ static int ssl_write_server_hello( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_BUF( 3, "server hello, random bytes", buf + 6, 32 );
 
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    /*
+     * Abbreviated rekey: the client asked to resume the session currently
+     * in use while renegotiating. Keep the authenticated peer identity and
+     * derive a fresh key block from the existing master secret and the new
+     * randoms, skipping the certificate exchange and asymmetric crypto.
+     */
+    if( ssl->handshake->resume == 0 &&
+        ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_IN_PROGRESS &&
+        ssl->conf->rekey == MBEDTLS_SSL_REKEY_ENABLED &&
+        ssl->session != NULL &&
+        ssl->session_negotiate->id_len != 0 &&
+        ssl->session_negotiate->id_len == ssl->session->id_len &&
+        memcmp( ssl->session_negotiate->id, ssl->session->id,
+                ssl->session->id_len ) == 0 &&
+        ssl->session_negotiate->ciphersuite == ssl->session->ciphersuite &&
+        ssl->session_negotiate->compression == ssl->session->compression )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "abbreviated rekey of current session" ) );
+
+        if( ( ret = mbedtls_ssl_session_copy( ssl->session_negotiate,
+                                              ssl->session ) ) != 0 )
+            return( ret );
+
+        ssl->handshake->resume = 1;
+    }
+#endif /* MBEDTLS_SSL_RENEGOTIATION */
+
     /*
      * Resume is 0  by default, see ssl_handshake_init().
      * It may be already set to 1 by ssl_parse_session_ticket_ext().
@@ -2529,6 +2668,90 @@ static int ssl_get_ecdh_params_from_cert( mbedtls_ssl_context *ssl )
 #endif /* MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED) ||
           MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED */
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE) && \
+    defined(MBEDTLS_KEY_EXCHANGE__SOME__ECDHE_ENABLED)
+/*
+ * Write ServerECDHParams using the shared keypair from the configured reuse
+ * context, regenerating the keypair when the use or age limit is exceeded
+ * or when the negotiated curve changed. Replaces mbedtls_ecdh_make_params().
+ */
+static int ssl_ecdh_reuse_make_params( mbedtls_ssl_context *ssl, size_t *olen,
+                                       unsigned char *buf, size_t blen )
+{
+    int ret;
+    size_t grp_len, pt_len;
+    int fresh_needed;
+    mbedtls_ecdh_context *ctx = &ssl->handshake->ecdh_ctx;
+    mbedtls_ssl_ecdh_reuse_context *reuse = ssl->conf->ecdh_reuse;
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t now = time( NULL );
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &reuse->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    fresh_needed = reuse->grp_id != ctx->grp.id ||
+                   reuse->uses >= reuse->max_uses;
+#if defined(MBEDTLS_HAVE_TIME)
+    if( reuse->max_age != 0 &&
+        ( now < reuse->created ||
+          (uint32_t)( now - reuse->created ) >= reuse->max_age ) )
+        fresh_needed = 1;
+#endif
+
+    if( fresh_needed )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "generating new shared ECDHE key" ) );
+
+        if( ( ret = mbedtls_ecdh_gen_public( &ctx->grp, &reuse->d, &reuse->Q,
+                                ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
+        {
+            /* Never serve a stale keypair after a failed regeneration */
+            reuse->grp_id = MBEDTLS_ECP_DP_NONE;
+            goto exit;
+        }
+
+        reuse->grp_id = ctx->grp.id;
+        reuse->uses = 0;
+#if defined(MBEDTLS_HAVE_TIME)
+        reuse->created = now;
+#endif
+    }
+
+    reuse->uses++;
+
+    if( ( ret = mbedtls_mpi_copy( &ctx->d, &reuse->d ) ) != 0 )
+        goto exit;
+    ret = mbedtls_ecp_copy( &ctx->Q, &reuse->Q );
+
+exit:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &reuse->mutex ) != 0 && ret == 0 )
+        ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+#endif
+    if( ret != 0 )
+        return( ret );
+
+    /* Same wire format as mbedtls_ecdh_make_params() */
+    if( ( ret = mbedtls_ecp_tls_write_group( &ctx->grp, &grp_len,
+                                             buf, blen ) ) != 0 )
+        return( ret );
+
+    buf += grp_len;
+    blen -= grp_len;
+
+    if( ( ret = mbedtls_ecp_tls_write_point( &ctx->grp, &ctx->Q,
+                                             ctx->point_format, &pt_len,
+                                             buf, blen ) ) != 0 )
+        return( ret );
+
+    *olen = grp_len + pt_len;
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_ECDH_REUSE && MBEDTLS_KEY_EXCHANGE__SOME__ECDHE_ENABLED */
+
 static int ssl_write_server_key_exchange( mbedtls_ssl_context *ssl )
 {
     int ret;
@@ -2550,6 +2773,41 @@ static int ssl_write_server_key_exchange( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write server key exchange" ) );
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE) &&                                  \
+    ( defined(MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED) ||                     \
+      defined(MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED) ||                   \
+      defined(MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED) )
+    if( ssl->handshake->async_in_progress == MBEDTLS_SSL_ASYNC_OP_SIGN )
+    {
+        /* The key exchange parameters are already in the output buffer:
+         * we were only waiting for the signature */
+        unsigned char *sig = ssl->out_msg + 4 +
+                             ssl->handshake->async_ske_prefix_len;
+        size_t sig_len;
+
+        ret = ssl->conf->f_async_resume( ssl, sig + 2, &sig_len,
+                    MBEDTLS_SSL_MAX_CONTENT_LEN - ( sig + 2 - ssl->out_msg ) );
+        if( ret == MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS )
+            return( ret );
+
+        ssl->handshake->async_in_progress = MBEDTLS_SSL_ASYNC_OP_NONE;
+
+        if( ret != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "f_async_resume", ret );
+            return( ret );
+        }
+
+        sig[0] = (unsigned char)( sig_len >> 8 );
+        sig[1] = (unsigned char)( sig_len      );
+
+        MBEDTLS_SSL_DEBUG_BUF( 3, "my signature", sig + 2, sig_len );
+
+        n = ssl->handshake->async_ske_prefix_len + 2 + sig_len;
+        goto msg_ready;
+    }
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE && server-signature key exchanges */
+
 #if defined(MBEDTLS_KEY_EXCHANGE_RSA_ENABLED) ||                           \
     defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) ||                           \
     defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED)
@@ -2595,12 +2853,6 @@ static int ssl_write_server_key_exchange( mbedtls_ssl_context *ssl )
     if( ciphersuite_info->key_exchange == MBEDTLS_KEY_EXCHANGE_DHE_RSA ||
         ciphersuite_info->key_exchange == MBEDTLS_KEY_EXCHANGE_DHE_PSK )
     {
-        if( ssl->conf->dhm_P.p == NULL || ssl->conf->dhm_G.p == NULL )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "no DH parameters set" ) );
-            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-        }
-
         /*
          * Ephemeral DH parameters:
          *
@@ -2610,11 +2862,29 @@ static int ssl_write_server_key_exchange( mbedtls_ssl_context *ssl )
          *     opaque dh_Ys<1..2^16-1>;
          * } ServerDHParams;
          */
-        if( ( ret = mbedtls_mpi_copy( &ssl->handshake->dhm_ctx.P, &ssl->conf->dhm_P ) ) != 0 ||
-            ( ret = mbedtls_mpi_copy( &ssl->handshake->dhm_ctx.G, &ssl->conf->dhm_G ) ) != 0 )
+        if( ssl->conf->dhm_group != MBEDTLS_DHM_GROUP_NONE )
         {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_mpi_copy", ret );
-            return( ret );
+            if( ( ret = mbedtls_dhm_set_group( &ssl->handshake->dhm_ctx,
+                            ssl->conf->dhm_group ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_dhm_set_group", ret );
+                return( ret );
+            }
+        }
+        else
+        {
+            if( ssl->conf->dhm_P.p == NULL || ssl->conf->dhm_G.p == NULL )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "no DH parameters set" ) );
+                return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+            }
+
+            if( ( ret = mbedtls_mpi_copy( &ssl->handshake->dhm_ctx.P, &ssl->conf->dhm_P ) ) != 0 ||
+                ( ret = mbedtls_mpi_copy( &ssl->handshake->dhm_ctx.G, &ssl->conf->dhm_G ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_mpi_copy", ret );
+                return( ret );
+            }
         }
 
         if( ( ret = mbedtls_dhm_make_params( &ssl->handshake->dhm_ctx,
@@ -2652,31 +2922,47 @@ static int ssl_write_server_key_exchange( mbedtls_ssl_context *ssl )
          *     ECPoint      public;
          * } ServerECDHParams;
          */
-        const mbedtls_ecp_curve_info **curve = NULL;
+        mbedtls_ecp_group_id curve_id = MBEDTLS_ECP_DP_NONE;
         const mbedtls_ecp_group_id *gid;
 
         /* Match our preference list against the offered curves */
         for( gid = ssl->conf->curve_list; *gid != MBEDTLS_ECP_DP_NONE; gid++ )
-            for( curve = ssl->handshake->curves; *curve != NULL; curve++ )
-                if( (*curve)->grp_id == *gid )
-                    goto curve_matching_done;
+        {
+            if( ssl->handshake->curves_mask & ( (uint32_t) 1 << *gid ) )
+            {
+                curve_id = *gid;
+                break;
+            }
+        }
 
-curve_matching_done:
-        if( curve == NULL || *curve == NULL )
+        if( curve_id == MBEDTLS_ECP_DP_NONE )
         {
             MBEDTLS_SSL_DEBUG_MSG( 1, ( "no matching curve for ECDHE" ) );
             return( MBEDTLS_ERR_SSL_NO_CIPHER_CHOSEN );
         }
 
-        MBEDTLS_SSL_DEBUG_MSG( 2, ( "ECDHE curve: %s", (*curve)->name ) );
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "ECDHE curve: %s",
+                mbedtls_ecp_curve_info_from_grp_id( curve_id )->name ) );
 
         if( ( ret = mbedtls_ecp_group_load( &ssl->handshake->ecdh_ctx.grp,
-                                       (*curve)->grp_id ) ) != 0 )
+                                            curve_id ) ) != 0 )
         {
             MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ecp_group_load", ret );
             return( ret );
         }
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+        if( ssl->conf->ecdh_reuse != NULL )
+        {
+            if( ( ret = ssl_ecdh_reuse_make_params( ssl, &len,
+                                      p, MBEDTLS_SSL_MAX_CONTENT_LEN - n ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "ssl_ecdh_reuse_make_params", ret );
+                return( ret );
+            }
+        }
+        else
+#endif /* MBEDTLS_SSL_ECDH_REUSE */
         if( ( ret = mbedtls_ecdh_make_params( &ssl->handshake->ecdh_ctx, &len,
                                       p, MBEDTLS_SSL_MAX_CONTENT_LEN - n,
                                       ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
@@ -2841,6 +3127,28 @@ curve_matching_done:
         }
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+        if( ssl->conf->f_async_sign != NULL )
+        {
+            ret = ssl->conf->f_async_sign( ssl, mbedtls_ssl_own_cert( ssl ),
+                                           md_alg, hash, hashlen );
+            if( ret == 0 )
+            {
+                /* Remember how much of the message precedes the signature,
+                 * so that the resume path above can complete it */
+                ssl->handshake->async_in_progress = MBEDTLS_SSL_ASYNC_OP_SIGN;
+                ssl->handshake->async_ske_prefix_len = p - ( ssl->out_msg + 4 );
+                return( MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS );
+            }
+            if( ret != MBEDTLS_ERR_SSL_HW_ACCEL_FALLTHROUGH )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "f_async_sign", ret );
+                return( ret );
+            }
+            /* The callback declined this operation: sign in software */
+        }
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
         if( ( ret = mbedtls_pk_sign( mbedtls_ssl_own_key( ssl ), md_alg, hash, hashlen,
                         p + 2 , &signature_len,
                         ssl->conf->f_rng, ssl->conf->p_rng ) ) != 0 )
@@ -2861,6 +3169,12 @@ curve_matching_done:
           MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED ||
           MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED */
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE) &&                                  \
+    ( defined(MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED) ||                     \
+      defined(MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED) ||                   \
+      defined(MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED) )
+msg_ready:
+#endif
     ssl->out_msglen  = 4 + n;
     ssl->out_msgtype = MBEDTLS_SSL_MSG_HANDSHAKE;
     ssl->out_msg[0]  = MBEDTLS_SSL_HS_SERVER_KEY_EXCHANGE;
@@ -2949,48 +3263,27 @@ static int ssl_parse_client_dh_public( mbedtls_ssl_context *ssl, unsigned char *
 
 #if defined(MBEDTLS_KEY_EXCHANGE_RSA_ENABLED) ||                           \
     defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED)
-static int ssl_parse_encrypted_pms( mbedtls_ssl_context *ssl,
-                                    const unsigned char *p,
-                                    const unsigned char *end,
-                                    size_t pms_offset )
+/*
+ * Fold the result of a premaster secret decryption into the handshake,
+ * shared between the synchronous path and the asynchronous resume path.
+ * decrypt_ret is folded into the Bleichenbacher countermeasure rather than
+ * returned, so that a failed decryption cannot be told apart from bad
+ * padding.
+ */
+static int ssl_finish_decrypt_pms( mbedtls_ssl_context *ssl,
+                                   int decrypt_ret,
+                                   const unsigned char *peer_pms,
+                                   size_t peer_pmslen,
+                                   size_t pms_offset )
 {
     int ret;
-    size_t len = mbedtls_pk_get_len( mbedtls_ssl_own_key( ssl ) );
     unsigned char *pms = ssl->handshake->premaster + pms_offset;
     unsigned char ver[2];
-    unsigned char fake_pms[48], peer_pms[48];
+    unsigned char fake_pms[48];
     unsigned char mask;
-    size_t i, peer_pmslen;
+    size_t i;
     unsigned int diff;
 
-    if( ! mbedtls_pk_can_do( mbedtls_ssl_own_key( ssl ), MBEDTLS_PK_RSA ) )
-    {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "got no RSA private key" ) );
-        return( MBEDTLS_ERR_SSL_PRIVATE_KEY_REQUIRED );
-    }
-
-    /*
-     * Decrypt the premaster using own private RSA key
-     */
-#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
-    defined(MBEDTLS_SSL_PROTO_TLS1_2)
-    if( ssl->minor_ver != MBEDTLS_SSL_MINOR_VERSION_0 )
-    {
-        if( *p++ != ( ( len >> 8 ) & 0xFF ) ||
-            *p++ != ( ( len      ) & 0xFF ) )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad client key exchange message" ) );
-            return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_KEY_EXCHANGE );
-        }
-    }
-#endif
-
-    if( p + len != end )
-    {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad client key exchange message" ) );
-        return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_KEY_EXCHANGE );
-    }
-
     mbedtls_ssl_write_version( ssl->handshake->max_major_ver,
                        ssl->handshake->max_minor_ver,
                        ssl->conf->transport, ver );
@@ -3006,12 +3299,7 @@ static int ssl_parse_encrypted_pms( mbedtls_ssl_context *ssl,
     if( ret != 0 )
         return( ret );
 
-    ret = mbedtls_pk_decrypt( mbedtls_ssl_own_key( ssl ), p, len,
-                      peer_pms, &peer_pmslen,
-                      sizeof( peer_pms ),
-                      ssl->conf->f_rng, ssl->conf->p_rng );
-
-    diff  = (unsigned int) ret;
+    diff  = (unsigned int) decrypt_ret;
     diff |= peer_pmslen ^ 48;
     diff |= peer_pms[0] ^ ver[0];
     diff |= peer_pms[1] ^ ver[1];
@@ -3046,6 +3334,94 @@ static int ssl_parse_encrypted_pms( mbedtls_ssl_context *ssl,
 
     return( 0 );
 }
+
+static int ssl_parse_encrypted_pms( mbedtls_ssl_context *ssl,
+                                    const unsigned char *p,
+                                    const unsigned char *end,
+                                    size_t pms_offset )
+{
+    int ret;
+    size_t len = mbedtls_pk_get_len( mbedtls_ssl_own_key( ssl ) );
+    unsigned char peer_pms[48];
+    size_t peer_pmslen = 0;
+
+    if( ! mbedtls_pk_can_do( mbedtls_ssl_own_key( ssl ), MBEDTLS_PK_RSA ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "got no RSA private key" ) );
+        return( MBEDTLS_ERR_SSL_PRIVATE_KEY_REQUIRED );
+    }
+
+    /*
+     * Decrypt the premaster using own private RSA key
+     */
+#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
+    defined(MBEDTLS_SSL_PROTO_TLS1_2)
+    if( ssl->minor_ver != MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        if( *p++ != ( ( len >> 8 ) & 0xFF ) ||
+            *p++ != ( ( len      ) & 0xFF ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad client key exchange message" ) );
+            return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_KEY_EXCHANGE );
+        }
+    }
+#endif
+
+    if( p + len != end )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad client key exchange message" ) );
+        return( MBEDTLS_ERR_SSL_BAD_HS_CLIENT_KEY_EXCHANGE );
+    }
+
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+    if( ssl->conf->f_async_decrypt != NULL )
+    {
+        ret = ssl->conf->f_async_decrypt( ssl, mbedtls_ssl_own_cert( ssl ),
+                                          p, len );
+        if( ret == 0 )
+        {
+            ssl->handshake->async_in_progress = MBEDTLS_SSL_ASYNC_OP_DECRYPT;
+            ssl->handshake->async_pms_offset = pms_offset;
+            return( MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS );
+        }
+        if( ret != MBEDTLS_ERR_SSL_HW_ACCEL_FALLTHROUGH )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "f_async_decrypt", ret );
+            return( ret );
+        }
+        /* The callback declined this operation: decrypt in software */
+    }
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
+    ret = mbedtls_pk_decrypt( mbedtls_ssl_own_key( ssl ), p, len,
+                      peer_pms, &peer_pmslen,
+                      sizeof( peer_pms ),
+                      ssl->conf->f_rng, ssl->conf->p_rng );
+
+    return( ssl_finish_decrypt_pms( ssl, ret,
+                                    peer_pms, peer_pmslen, pms_offset ) );
+}
+
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+static int ssl_resume_decrypt_pms( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    unsigned char peer_pms[48];
+    size_t peer_pmslen = 0;
+
+    memset( peer_pms, 0, sizeof( peer_pms ) );
+
+    ret = ssl->conf->f_async_resume( ssl, peer_pms, &peer_pmslen,
+                                     sizeof( peer_pms ) );
+    if( ret == MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS )
+        return( ret );
+
+    ssl->handshake->async_in_progress = MBEDTLS_SSL_ASYNC_OP_NONE;
+
+    return( ssl_finish_decrypt_pms( ssl, ret, peer_pms, peer_pmslen,
+                                    ssl->handshake->async_pms_offset ) );
+}
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
 #endif /* MBEDTLS_KEY_EXCHANGE_RSA_ENABLED ||
           MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED */
 
@@ -3127,6 +3503,34 @@ static int ssl_parse_client_key_exchange( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> parse client key exchange" ) );
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE) &&           \
+    ( defined(MBEDTLS_KEY_EXCHANGE_RSA_ENABLED) ||  \
+      defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED) )
+    if( ssl->handshake->async_in_progress == MBEDTLS_SSL_ASYNC_OP_DECRYPT )
+    {
+        /* The ClientKeyExchange has already been read and checked: we were
+         * only waiting for the premaster secret to be decrypted */
+        if( ( ret = ssl_resume_decrypt_pms( ssl ) ) != 0 )
+        {
+            if( ret != MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS )
+                MBEDTLS_SSL_DEBUG_RET( 1, "ssl_resume_decrypt_pms", ret );
+            return( ret );
+        }
+
+#if defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED)
+        if( ciphersuite_info->key_exchange == MBEDTLS_KEY_EXCHANGE_RSA_PSK &&
+            ( ret = mbedtls_ssl_psk_derive_premaster( ssl,
+                        ciphersuite_info->key_exchange ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_psk_derive_premaster", ret );
+            return( ret );
+        }
+#endif
+
+        goto pms_done;
+    }
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE && RSA-based key exchanges */
+
     if( ( ret = mbedtls_ssl_read_record( ssl ) ) != 0 )
     {
         MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_read_record", ret );
@@ -3332,6 +3736,11 @@ static int ssl_parse_client_key_exchange( mbedtls_ssl_context *ssl )
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE) &&           \
+    ( defined(MBEDTLS_KEY_EXCHANGE_RSA_ENABLED) ||  \
+      defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED) )
+pms_done:
+#endif
     if( ( ret = mbedtls_ssl_derive_keys( ssl ) ) != 0 )
     {
         MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_derive_keys", ret );
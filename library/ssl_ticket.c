@@ -40,10 +40,7 @@
 
 #include <string.h>
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  * Initialze context
@@ -53,7 +50,7 @@ void mbedtls_ssl_ticket_init( mbedtls_ssl_ticket_context *ctx )
     memset( ctx, 0, sizeof( mbedtls_ssl_ticket_context ) );
 
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_init( &ctx->mutex );
+    mbedtls_rwlock_init( &ctx->rwlock );
 #endif
 }
 
@@ -66,7 +63,6 @@ static int ssl_ticket_gen_key( mbedtls_ssl_ticket_context *ctx,
                                unsigned char index )
 {
     int ret;
-    unsigned char buf[MAX_KEY_BYTES];
     mbedtls_ssl_ticket_key *key = ctx->keys + index;
 
 #if defined(MBEDTLS_HAVE_TIME)
@@ -76,18 +72,57 @@ static int ssl_ticket_gen_key( mbedtls_ssl_ticket_context *ctx,
     if( ( ret = ctx->f_rng( ctx->p_rng, key->name, sizeof( key->name ) ) ) != 0 )
         return( ret );
 
-    if( ( ret = ctx->f_rng( ctx->p_rng, buf, sizeof( buf ) ) ) != 0 )
+    return( ctx->f_rng( ctx->p_rng, key->key, sizeof( key->key ) ) );
+}
+
+/*
+ * Set up a transient cipher context from a copy of a key's material.
+ *
+ * A long-lived per-key cipher context can't be shared between concurrent
+ * handshakes: GCM and CCM keep the state of the operation in progress
+ * inside the context. So each write/parse protects the ticket with a
+ * private context made from a snapshot of the raw key, and the context
+ * mutex only needs to be held while rotating keys and taking the snapshot.
+ */
+static int ssl_ticket_cipher_setup( mbedtls_ssl_ticket_context *ctx,
+                                    mbedtls_cipher_context_t *cipher,
+                                    const unsigned char key[MAX_KEY_BYTES] )
+{
+    int ret;
+
+    if( ( ret = mbedtls_cipher_setup( cipher, ctx->cipher_info ) ) != 0 )
         return( ret );
 
     /* With GCM and CCM, same context can encrypt & decrypt */
-    ret = mbedtls_cipher_setkey( &key->ctx, buf,
-                                 mbedtls_cipher_get_key_bitlen( &key->ctx ),
-                                 MBEDTLS_ENCRYPT );
+    return( mbedtls_cipher_setkey( cipher, key,
+                                   mbedtls_cipher_get_key_bitlen( cipher ),
+                                   MBEDTLS_ENCRYPT ) );
+}
 
-    mbedtls_zeroize( buf, sizeof( buf ) );
+#if defined(MBEDTLS_THREADING_C)
+/*
+ * Tell whether the active key is still within its lifetime, without
+ * modifying anything; mirrors the rotation condition in
+ * ssl_ticket_update_keys() and may be called under a shared lock.
+ */
+static int ssl_ticket_keys_fresh( mbedtls_ssl_ticket_context *ctx )
+{
+#if !defined(MBEDTLS_HAVE_TIME)
+    ((void) ctx);
+#else
+    if( ctx->ticket_lifetime != 0 )
+    {
+        uint32_t current_time = (uint32_t) time( NULL );
+        uint32_t key_time = ctx->keys[ctx->active].generation_time;
 
-    return( ret );
+        return( current_time > key_time &&
+                current_time - key_time < ctx->ticket_lifetime );
+    }
+#endif /* MBEDTLS_HAVE_TIME */
+
+    return( 1 );
 }
+#endif /* MBEDTLS_THREADING_C */
 
 /*
  * Rotate/generate keys if necessary
@@ -146,11 +181,7 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
     if( cipher_info->key_bitlen > 8 * MAX_KEY_BYTES )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-    if( ( ret = mbedtls_cipher_setup( &ctx->keys[0].ctx, cipher_info ) ) != 0 ||
-        ( ret = mbedtls_cipher_setup( &ctx->keys[1].ctx, cipher_info ) ) != 0 )
-    {
-        return( ret );
-    }
+    ctx->cipher_info = cipher_info;
 
     if( ( ret = ssl_ticket_gen_key( ctx, 0 ) ) != 0 ||
         ( ret = ssl_ticket_gen_key( ctx, 1 ) ) != 0 )
@@ -162,112 +193,19 @@ int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
 }
 
 /*
- * Serialize a session in the following format:
- *  0   .   n-1     session structure, n = sizeof(mbedtls_ssl_session)
- *  n   .   n+2     peer_cert length = m (0 if no certificate)
- *  n+3 .   n+2+m   peer cert ASN.1
- */
-static int ssl_save_session( const mbedtls_ssl_session *session,
-                             unsigned char *buf, size_t buf_len,
-                             size_t *olen )
-{
-    unsigned char *p = buf;
-    size_t left = buf_len;
-#if defined(MBEDTLS_X509_CRT_PARSE_C)
-    size_t cert_len;
-#endif /* MBEDTLS_X509_CRT_PARSE_C */
-
-    if( left < sizeof( mbedtls_ssl_session ) )
-        return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
-
-    memcpy( p, session, sizeof( mbedtls_ssl_session ) );
-    p += sizeof( mbedtls_ssl_session );
-    left -= sizeof( mbedtls_ssl_session );
-
-#if defined(MBEDTLS_X509_CRT_PARSE_C)
-    if( session->peer_cert == NULL )
-        cert_len = 0;
-    else
-        cert_len = session->peer_cert->raw.len;
-
-    if( left < 3 + cert_len )
-        return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
-
-    *p++ = (unsigned char)( cert_len >> 16 & 0xFF );
-    *p++ = (unsigned char)( cert_len >>  8 & 0xFF );
-    *p++ = (unsigned char)( cert_len       & 0xFF );
-
-    if( session->peer_cert != NULL )
-        memcpy( p, session->peer_cert->raw.p, cert_len );
-
-    p += cert_len;
-#endif /* MBEDTLS_X509_CRT_PARSE_C */
-
-    *olen = p - buf;
-
-    return( 0 );
-}
-
-/*
- * Unserialise session, see ssl_save_session()
+ * Configure lifetime jitter and refresh-ahead renewal
  */
-static int ssl_load_session( mbedtls_ssl_session *session,
-                             const unsigned char *buf, size_t len )
+void mbedtls_ssl_ticket_conf_refresh( mbedtls_ssl_ticket_context *ctx,
+                                      uint32_t jitter,
+                                      unsigned char refresh_ahead )
 {
-    const unsigned char *p = buf;
-    const unsigned char * const end = buf + len;
-#if defined(MBEDTLS_X509_CRT_PARSE_C)
-    size_t cert_len;
-#endif /* MBEDTLS_X509_CRT_PARSE_C */
+    if( jitter >= ctx->ticket_lifetime )
+        jitter = 0;
+    if( refresh_ahead > 100 )
+        refresh_ahead = 100;
 
-    if( p + sizeof( mbedtls_ssl_session ) > end )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-
-    memcpy( session, p, sizeof( mbedtls_ssl_session ) );
-    p += sizeof( mbedtls_ssl_session );
-
-#if defined(MBEDTLS_X509_CRT_PARSE_C)
-    if( p + 3 > end )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-
-    cert_len = ( p[0] << 16 ) | ( p[1] << 8 ) | p[2];
-    p += 3;
-
-    if( cert_len == 0 )
-    {
-        session->peer_cert = NULL;
-    }
-    else
-    {
-        int ret;
-
-        if( p + cert_len > end )
-            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-
-        session->peer_cert = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt ) );
-
-        if( session->peer_cert == NULL )
-            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
-
-        mbedtls_x509_crt_init( session->peer_cert );
-
-        if( ( ret = mbedtls_x509_crt_parse_der( session->peer_cert,
-                                        p, cert_len ) ) != 0 )
-        {
-            mbedtls_x509_crt_free( session->peer_cert );
-            mbedtls_free( session->peer_cert );
-            session->peer_cert = NULL;
-            return( ret );
-        }
-
-        p += cert_len;
-    }
-#endif /* MBEDTLS_X509_CRT_PARSE_C */
-
-    if( p != end )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-
-    return( 0 );
+    ctx->ticket_jitter = jitter;
+    ctx->refresh_ahead = refresh_ahead;
 }
 
 /*
@@ -293,12 +231,20 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
     int ret;
     mbedtls_ssl_ticket_context *ctx = p_ticket;
     mbedtls_ssl_ticket_key *key;
+    unsigned char key_copy[MAX_KEY_BYTES];
+    mbedtls_cipher_context_t cipher;
     unsigned char *key_name = start;
     unsigned char *iv = start + 4;
     unsigned char *state_len_bytes = iv + 12;
     unsigned char *state = state_len_bytes + 2;
     unsigned char *tag;
     size_t clear_len, ciph_len;
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_ssl_session session_stamped;
+#endif
+#if defined(MBEDTLS_THREADING_C)
+    int rotate = 0;
+#endif
 
     *tlen = 0;
 
@@ -310,25 +256,87 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
     if( end - start < 4 + 12 + 2 + 16 )
         return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
 
+    /* Rotate keys if needed and take a copy of the active key, then
+     * release the lock: the protection itself runs on a private cipher
+     * context so that concurrent handshakes don't serialize here.
+     * Key material only changes under the exclusive lock, so when no
+     * rotation is due the snapshot shares the lock with other
+     * handshakes. */
 #if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
+    if( ( ret = mbedtls_rwlock_rdlock( &ctx->rwlock ) ) != 0 )
         return( ret );
+
+    if( ssl_ticket_keys_fresh( ctx ) == 0 )
+    {
+        if( ( ret = mbedtls_rwlock_unlock( &ctx->rwlock ) ) != 0 )
+            return( ret );
+        if( ( ret = mbedtls_rwlock_wrlock( &ctx->rwlock ) ) != 0 )
+            return( ret );
+        rotate = 1;
+    }
+
+    if( rotate != 0 )
+        ret = ssl_ticket_update_keys( ctx );
+    else
+        ret = 0;
+#else
+    ret = ssl_ticket_update_keys( ctx );
 #endif
 
-    if( ( ret = ssl_ticket_update_keys( ctx ) ) != 0 )
-        goto cleanup;
+    if( ret == 0 )
+    {
+        key = &ctx->keys[ctx->active];
 
-    key = &ctx->keys[ctx->active];
+        memcpy( key_name, key->name, 4 );
+        memcpy( key_copy, key->key, sizeof( key_copy ) );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_rwlock_unlock( &ctx->rwlock ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    if( ret != 0 )
+        return( ret );
+
+    mbedtls_cipher_init( &cipher );
 
     *ticket_lifetime = ctx->ticket_lifetime;
 
-    memcpy( key_name, key->name, 4 );
+    /* Jitter the advertised lifetime so that tickets issued in a burst
+     * don't all come back for a full handshake at the same moment */
+    if( ctx->ticket_jitter != 0 )
+    {
+        unsigned char rnd[4];
+        uint32_t jitter;
+
+        if( ( ret = ctx->f_rng( ctx->p_rng, rnd, sizeof( rnd ) ) ) != 0 )
+            goto cleanup;
+
+        jitter = ( (uint32_t) rnd[0] << 24 | (uint32_t) rnd[1] << 16 |
+                   (uint32_t) rnd[2] <<  8 | (uint32_t) rnd[3] )
+                 % ( ctx->ticket_jitter + 1 );
+
+        *ticket_lifetime = ctx->ticket_lifetime - jitter;
+    }
+
+#if defined(MBEDTLS_HAVE_TIME)
+    /* Stamp the ticket with its issue time, so that a ticket reissued
+     * through the refresh-ahead policy starts a fresh lifetime instead
+     * of inheriting the expiration date of the one it replaces */
+    session_stamped = *session;
+    session_stamped.start = time( NULL );
+    session = &session_stamped;
+#endif
+
+    if( ( ret = ssl_ticket_cipher_setup( ctx, &cipher, key_copy ) ) != 0 )
+        goto cleanup;
 
     if( ( ret = ctx->f_rng( ctx->p_rng, iv, 12 ) ) != 0 )
         goto cleanup;
 
     /* Dump session state */
-    if( ( ret = ssl_save_session( session,
+    if( ( ret = mbedtls_ssl_session_save( session,
                                   state, end - state, &clear_len ) ) != 0 ||
         (unsigned long) clear_len > 65535 )
     {
@@ -339,7 +347,7 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
 
     /* Encrypt and authenticate */
     tag = state + clear_len;
-    if( ( ret = mbedtls_cipher_auth_encrypt( &key->ctx,
+    if( ( ret = mbedtls_cipher_auth_encrypt( &cipher,
                     iv, 12, key_name, 4 + 12 + 2,
                     state, clear_len, state, &ciph_len, tag, 16 ) ) != 0 )
     {
@@ -354,9 +362,11 @@ int mbedtls_ssl_ticket_write( void *p_ticket,
     *tlen = 4 + 12 + 2 + 16 + ciph_len;
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+    mbedtls_cipher_free( &cipher );
+    mbedtls_zeroize( key_copy, sizeof( key_copy ) );
+#if defined(MBEDTLS_HAVE_TIME)
+    /* The shallow copy holds the master secret */
+    mbedtls_zeroize( &session_stamped, sizeof( session_stamped ) );
 #endif
 
     return( ret );
@@ -389,12 +399,17 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     int ret;
     mbedtls_ssl_ticket_context *ctx = p_ticket;
     mbedtls_ssl_ticket_key *key;
+    unsigned char key_copy[MAX_KEY_BYTES];
+    mbedtls_cipher_context_t cipher;
     unsigned char *key_name = buf;
     unsigned char *iv = buf + 4;
     unsigned char *enc_len_p = iv + 12;
     unsigned char *ticket = enc_len_p + 2;
     unsigned char *tag;
     size_t enc_len, clear_len;
+#if defined(MBEDTLS_THREADING_C)
+    int rotate = 0;
+#endif
 
     if( ctx == NULL || ctx->f_rng == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
@@ -403,34 +418,62 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     if( len < 4 + 12 + 2 + 16 )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
-#if defined(MBEDTLS_THREADING_C)
-    if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
-        return( ret );
-#endif
-
-    if( ( ret = ssl_ticket_update_keys( ctx ) ) != 0 )
-        goto cleanup;
-
     enc_len = ( enc_len_p[0] << 8 ) | enc_len_p[1];
     tag = ticket + enc_len;
 
     if( len != 4 + 12 + 2 + enc_len + 16 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Rotate keys if needed and take a copy of the named key, then
+     * release the lock, as in mbedtls_ssl_ticket_write() */
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_rwlock_rdlock( &ctx->rwlock ) ) != 0 )
+        return( ret );
+
+    if( ssl_ticket_keys_fresh( ctx ) == 0 )
     {
-        ret = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
-        goto cleanup;
+        if( ( ret = mbedtls_rwlock_unlock( &ctx->rwlock ) ) != 0 )
+            return( ret );
+        if( ( ret = mbedtls_rwlock_wrlock( &ctx->rwlock ) ) != 0 )
+            return( ret );
+        rotate = 1;
     }
 
-    /* Select key */
-    if( ( key = ssl_ticket_select_key( ctx, key_name ) ) == NULL )
+    if( rotate != 0 )
+        ret = ssl_ticket_update_keys( ctx );
+    else
+        ret = 0;
+#else
+    ret = ssl_ticket_update_keys( ctx );
+#endif
+
+    if( ret == 0 )
     {
-        /* We can't know for sure but this is a likely option unless we're
-         * under attack - this is only informative anyway */
-        ret = MBEDTLS_ERR_SSL_SESSION_TICKET_EXPIRED;
-        goto cleanup;
+        if( ( key = ssl_ticket_select_key( ctx, key_name ) ) != NULL )
+            memcpy( key_copy, key->key, sizeof( key_copy ) );
+        else
+        {
+            /* We can't know for sure but this is a likely option unless we're
+             * under attack - this is only informative anyway */
+            ret = MBEDTLS_ERR_SSL_SESSION_TICKET_EXPIRED;
+        }
     }
 
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_rwlock_unlock( &ctx->rwlock ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    if( ret != 0 )
+        return( ret );
+
+    mbedtls_cipher_init( &cipher );
+
+    if( ( ret = ssl_ticket_cipher_setup( ctx, &cipher, key_copy ) ) != 0 )
+        goto cleanup;
+
     /* Decrypt and authenticate */
-    if( ( ret = mbedtls_cipher_auth_decrypt( &key->ctx, iv, 12,
+    if( ( ret = mbedtls_cipher_auth_decrypt( &cipher, iv, 12,
                     key_name, 4 + 12 + 2, ticket, enc_len,
                     ticket, &clear_len, tag, 16 ) ) != 0 )
     {
@@ -446,28 +489,38 @@ int mbedtls_ssl_ticket_parse( void *p_ticket,
     }
 
     /* Actually load session */
-    if( ( ret = ssl_load_session( session, ticket, clear_len ) ) != 0 )
+    if( ( ret = mbedtls_ssl_session_load( session, ticket, clear_len ) ) != 0 )
         goto cleanup;
 
 #if defined(MBEDTLS_HAVE_TIME)
     {
         /* Check for expiration */
         time_t current_time = time( NULL );
+        uint32_t age;
 
         if( current_time < session->start ||
-            (uint32_t)( current_time - session->start ) > ctx->ticket_lifetime )
+            ( age = (uint32_t)( current_time - session->start ) )
+                > ctx->ticket_lifetime )
         {
             ret = MBEDTLS_ERR_SSL_SESSION_TICKET_EXPIRED;
             goto cleanup;
         }
+
+        /* Still good, but in the renewal window: ask for the ticket to be
+         * reissued, so the client doesn't come back with an expired ticket
+         * and a full handshake once it does lapse */
+        if( ctx->refresh_ahead != 0 &&
+            age > ctx->ticket_lifetime / 100 * ( 100 - ctx->refresh_ahead ) )
+        {
+            ret = MBEDTLS_ERR_SSL_SESSION_TICKET_REFRESH;
+            goto cleanup;
+        }
     }
 #endif
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
+    mbedtls_cipher_free( &cipher );
+    mbedtls_zeroize( key_copy, sizeof( key_copy ) );
 
     return( ret );
 }
@@ -477,11 +530,8 @@ cleanup:
  */
 void mbedtls_ssl_ticket_free( mbedtls_ssl_ticket_context *ctx )
 {
-    mbedtls_cipher_free( &ctx->keys[0].ctx );
-    mbedtls_cipher_free( &ctx->keys[1].ctx );
-
 #if defined(MBEDTLS_THREADING_C)
-    mbedtls_mutex_free( &ctx->mutex );
+    mbedtls_rwlock_free( &ctx->rwlock );
 #endif
 
     mbedtls_zeroize( ctx, sizeof( mbedtls_ssl_ticket_context ) );
@@ -55,10 +55,16 @@
 #define mbedtls_free       free
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
+#include "mbedtls/hints.h"
+
+#if defined(MBEDTLS_SSL_HS_TIMING)
+#include "mbedtls/timing.h"
+#endif
+
+#if defined(MBEDTLS_MEMORY_TAGGING)
+#include "mbedtls/memory_buffer_alloc.h"
+#endif
 
 /* Length of the "epoch" field in the record header */
 static inline size_t ssl_ep_len( const mbedtls_ssl_context *ssl )
@@ -130,9 +136,70 @@ static int ssl_double_retransmit_timeout( mbedtls_ssl_context *ssl )
     return( 0 );
 }
 
+#if defined(MBEDTLS_TIMING_C)
+/* Never let the RTT-based retransmission timeout drop below this (ms):
+ * the estimate does not account for the peer's processing time, which can
+ * dominate the RTT on constrained devices */
+#define SSL_DTLS_TIMEOUT_FLOOR  250
+
+/*
+ * Update the smoothed RTT estimate with a new sample, as in RFC 6298 2.2/2.3
+ * (integer arithmetic, alpha = 1/8, beta = 1/4).
+ */
+static void ssl_update_rtt_estimate( mbedtls_ssl_context *ssl )
+{
+    uint32_t rtt = (uint32_t) mbedtls_timing_get_timer(
+                                &ssl->handshake->flight_sent_time, 0 );
+
+    ssl->handshake->rtt_sample_open = 0;
+
+    if( rtt == 0 )
+        rtt = 1;
+
+    if( ssl->handshake->rtt_srtt == 0 )
+    {
+        ssl->handshake->rtt_srtt = rtt;
+        ssl->handshake->rtt_var  = rtt / 2;
+    }
+    else
+    {
+        uint32_t delta = ssl->handshake->rtt_srtt > rtt
+                       ? ssl->handshake->rtt_srtt - rtt
+                       : rtt - ssl->handshake->rtt_srtt;
+
+        ssl->handshake->rtt_var  = ( 3 * ssl->handshake->rtt_var + delta ) / 4;
+        ssl->handshake->rtt_srtt = ( 7 * ssl->handshake->rtt_srtt + rtt ) / 8;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "RTT sample %u ms, srtt = %u, var = %u",
+                                (unsigned) rtt,
+                                (unsigned) ssl->handshake->rtt_srtt,
+                                (unsigned) ssl->handshake->rtt_var ) );
+}
+#endif /* MBEDTLS_TIMING_C */
+
 static void ssl_reset_retransmit_timeout( mbedtls_ssl_context *ssl )
 {
-    ssl->handshake->retransmit_timeout = ssl->conf->hs_timeout_min;
+    uint32_t timeout = ssl->conf->hs_timeout_min;
+
+#if defined(MBEDTLS_TIMING_C)
+    /* If we have an RTT estimate, start from RTO = SRTT + 4 * RTTVAR
+     * (RFC 6298 2.3) instead of the configured minimum. The estimate may
+     * only lower the initial timeout: losses are handled by the usual
+     * doubling, and hs_timeout_min keeps its role as an upper bound on
+     * the starting value. */
+    if( ssl->handshake->rtt_srtt != 0 )
+    {
+        timeout = ssl->handshake->rtt_srtt + 4 * ssl->handshake->rtt_var;
+
+        if( timeout < SSL_DTLS_TIMEOUT_FLOOR )
+            timeout = SSL_DTLS_TIMEOUT_FLOOR;
+        if( timeout > ssl->conf->hs_timeout_min )
+            timeout = ssl->conf->hs_timeout_min;
+    }
+#endif
+
+    ssl->handshake->retransmit_timeout = timeout;
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "update timeout value to %d millisecs",
                         ssl->handshake->retransmit_timeout ) );
 }
@@ -157,8 +224,8 @@ static unsigned int mfl_code_to_length[MBEDTLS_SSL_MAX_FRAG_LEN_INVALID] =
 };
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
-#if defined(MBEDTLS_SSL_CLI_C)
-static int ssl_session_copy( mbedtls_ssl_session *dst, const mbedtls_ssl_session *src )
+int mbedtls_ssl_session_copy( mbedtls_ssl_session *dst,
+                              const mbedtls_ssl_session *src )
 {
     mbedtls_ssl_session_free( dst );
     memcpy( dst, src, sizeof( mbedtls_ssl_session ) );
@@ -197,7 +264,6 @@ static int ssl_session_copy( mbedtls_ssl_session *dst, const mbedtls_ssl_session
 
     return( 0 );
 }
-#endif /* MBEDTLS_SSL_CLI_C */
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
 int (*mbedtls_ssl_hw_record_init)( mbedtls_ssl_context *ssl,
@@ -218,7 +284,8 @@ int (*mbedtls_ssl_hw_record_finish)( mbedtls_ssl_context *ssl ) = NULL;
  * Key material generation
  */
 #if defined(MBEDTLS_SSL_PROTO_SSL3)
-static int ssl3_prf( const unsigned char *secret, size_t slen,
+static int ssl3_prf( mbedtls_ssl_session *session,
+                     const unsigned char *secret, size_t slen,
                      const char *label,
                      const unsigned char *random, size_t rlen,
                      unsigned char *dstbuf, size_t dlen )
@@ -228,6 +295,7 @@ static int ssl3_prf( const unsigned char *secret, size_t slen,
     mbedtls_sha1_context sha1;
     unsigned char padding[16];
     unsigned char sha1sum[20];
+    ((void)session);
     ((void)label);
 
     mbedtls_md5_init(  &md5  );
@@ -268,7 +336,8 @@ static int ssl3_prf( const unsigned char *secret, size_t slen,
 #endif /* MBEDTLS_SSL_PROTO_SSL3 */
 
 #if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1)
-static int tls1_prf( const unsigned char *secret, size_t slen,
+static int tls1_prf( mbedtls_ssl_session *session,
+                     const unsigned char *secret, size_t slen,
                      const char *label,
                      const unsigned char *random, size_t rlen,
                      unsigned char *dstbuf, size_t dlen )
@@ -281,6 +350,7 @@ static int tls1_prf( const unsigned char *secret, size_t slen,
     const mbedtls_md_info_t *md_info;
     mbedtls_md_context_t md_ctx;
     int ret;
+    ((void)session);
 
     mbedtls_md_init( &md_ctx );
 
@@ -366,20 +436,53 @@ static int tls1_prf( const unsigned char *secret, size_t slen,
 #endif /* MBEDTLS_SSL_PROTO_TLS1) || MBEDTLS_SSL_PROTO_TLS1_1 */
 
 #if defined(MBEDTLS_SSL_PROTO_TLS1_2)
+/*
+ * One HMAC invocation from pre-keyed pad states: clone the state of the
+ * hash over the inner (resp. outer) key pad instead of re-hashing the pad
+ * block, saving two compression function runs per invocation.
+ */
+static int tls_prf_hmac( mbedtls_md_context_t *md_ctx,
+                         const mbedtls_md_context_t *ipad_ctx,
+                         const mbedtls_md_context_t *opad_ctx,
+                         const unsigned char *input, size_t ilen,
+                         unsigned char *output, size_t md_len )
+{
+    int ret;
+    unsigned char inner[MBEDTLS_MD_MAX_SIZE];
+
+    if( ( ret = mbedtls_md_clone( md_ctx, ipad_ctx ) ) != 0 ||
+        ( ret = mbedtls_md_update( md_ctx, input, ilen ) ) != 0 ||
+        ( ret = mbedtls_md_finish( md_ctx, inner ) ) != 0 )
+        return( ret );
+
+    if( ( ret = mbedtls_md_clone( md_ctx, opad_ctx ) ) != 0 ||
+        ( ret = mbedtls_md_update( md_ctx, inner, md_len ) ) != 0 ||
+        ( ret = mbedtls_md_finish( md_ctx, output ) ) != 0 )
+        return( ret );
+
+    mbedtls_zeroize( inner, sizeof( inner ) );
+
+    return( 0 );
+}
+
 static int tls_prf_generic( mbedtls_md_type_t md_type,
+                            mbedtls_ssl_session *session,
                             const unsigned char *secret, size_t slen,
                             const char *label,
                             const unsigned char *random, size_t rlen,
                             unsigned char *dstbuf, size_t dlen )
 {
     size_t nb;
-    size_t i, j, k, md_len;
+    size_t i, j, k, md_len, block_size;
     unsigned char tmp[128];
     unsigned char h_i[MBEDTLS_MD_MAX_SIZE];
+    unsigned char pad[128];
     const mbedtls_md_info_t *md_info;
-    mbedtls_md_context_t md_ctx;
+    mbedtls_md_context_t ipad_ctx, opad_ctx, md_ctx;
     int ret;
 
+    mbedtls_md_init( &ipad_ctx );
+    mbedtls_md_init( &opad_ctx );
     mbedtls_md_init( &md_ctx );
 
     if( ( md_info = mbedtls_md_info_from_type( md_type ) ) == NULL )
@@ -387,6 +490,9 @@ static int tls_prf_generic( mbedtls_md_type_t md_type,
 
     md_len = mbedtls_md_get_size( md_info );
 
+    /* The TLS 1.2 PRF is only defined for SHA-256 and SHA-384 */
+    block_size = ( md_type == MBEDTLS_MD_SHA384 ) ? 128 : 64;
+
     if( sizeof( tmp ) < md_len + strlen( label ) + rlen )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
@@ -396,24 +502,101 @@ static int tls_prf_generic( mbedtls_md_type_t md_type,
     nb += rlen;
 
     /*
-     * Compute P_<hash>(secret, label + random)[0..dlen]
+     * Key the HMAC once per secret: hash the two key pad blocks now, and
+     * let each invocation resume from a clone of these states. A PRF run
+     * makes up to 2 * dlen / md_len + 1 HMAC invocations over the same
+     * secret, so this trims two compressions from each of them.
      */
-    if ( ( ret = mbedtls_md_setup( &md_ctx, md_info, 1 ) ) != 0 )
-        return( ret );
+    if( ( ret = mbedtls_md_setup( &ipad_ctx, md_info, 0 ) ) != 0 ||
+        ( ret = mbedtls_md_setup( &opad_ctx, md_info, 0 ) ) != 0 ||
+        ( ret = mbedtls_md_setup( &md_ctx, md_info, 0 ) ) != 0 )
+    {
+        goto exit;
+    }
 
-    mbedtls_md_hmac_starts( &md_ctx, secret, slen );
-    mbedtls_md_hmac_update( &md_ctx, tmp + md_len, nb );
-    mbedtls_md_hmac_finish( &md_ctx, tmp );
+    /*
+     * When the caller passes the session the secret belongs to, the keyed
+     * pad states survive there across PRF runs: Finished computations and
+     * resumed handshakes then skip the re-keying below entirely.
+     */
+    if( session != NULL && session->prf_keyed == (int) md_type )
+    {
+#if defined(MBEDTLS_SHA512_C)
+        if( md_type == MBEDTLS_MD_SHA384 )
+        {
+            *(mbedtls_sha512_context *) ipad_ctx.md_ctx = session->prf_ipad384;
+            *(mbedtls_sha512_context *) opad_ctx.md_ctx = session->prf_opad384;
+        }
+        else
+#endif
+        {
+#if defined(MBEDTLS_SHA256_C)
+            *(mbedtls_sha256_context *) ipad_ctx.md_ctx = session->prf_ipad256;
+            *(mbedtls_sha256_context *) opad_ctx.md_ctx = session->prf_opad256;
+#endif
+        }
+    }
+    else
+    {
+        memset( pad, 0x36, block_size );
+        if( slen > block_size )
+        {
+            if( ( ret = mbedtls_md( md_info, secret, slen, h_i ) ) != 0 )
+                goto exit;
+            for( i = 0; i < md_len; i++ )
+                pad[i] ^= h_i[i];
+        }
+        else
+        {
+            for( i = 0; i < slen; i++ )
+                pad[i] ^= secret[i];
+        }
+
+        if( ( ret = mbedtls_md_starts( &ipad_ctx ) ) != 0 ||
+            ( ret = mbedtls_md_update( &ipad_ctx, pad, block_size ) ) != 0 )
+            goto exit;
+
+        for( i = 0; i < block_size; i++ )
+            pad[i] ^= 0x36 ^ 0x5C;
+
+        if( ( ret = mbedtls_md_starts( &opad_ctx ) ) != 0 ||
+            ( ret = mbedtls_md_update( &opad_ctx, pad, block_size ) ) != 0 )
+            goto exit;
+
+        if( session != NULL )
+        {
+#if defined(MBEDTLS_SHA512_C)
+            if( md_type == MBEDTLS_MD_SHA384 )
+            {
+                session->prf_ipad384 = *(mbedtls_sha512_context *) ipad_ctx.md_ctx;
+                session->prf_opad384 = *(mbedtls_sha512_context *) opad_ctx.md_ctx;
+            }
+            else
+#endif
+            {
+#if defined(MBEDTLS_SHA256_C)
+                session->prf_ipad256 = *(mbedtls_sha256_context *) ipad_ctx.md_ctx;
+                session->prf_opad256 = *(mbedtls_sha256_context *) opad_ctx.md_ctx;
+#endif
+            }
+            session->prf_keyed = (int) md_type;
+        }
+    }
+
+    /*
+     * Compute P_<hash>(secret, label + random)[0..dlen]
+     */
+    if( ( ret = tls_prf_hmac( &md_ctx, &ipad_ctx, &opad_ctx,
+                              tmp + md_len, nb, tmp, md_len ) ) != 0 )
+        goto exit;
 
     for( i = 0; i < dlen; i += md_len )
     {
-        mbedtls_md_hmac_reset ( &md_ctx );
-        mbedtls_md_hmac_update( &md_ctx, tmp, md_len + nb );
-        mbedtls_md_hmac_finish( &md_ctx, h_i );
-
-        mbedtls_md_hmac_reset ( &md_ctx );
-        mbedtls_md_hmac_update( &md_ctx, tmp, md_len );
-        mbedtls_md_hmac_finish( &md_ctx, tmp );
+        if( ( ret = tls_prf_hmac( &md_ctx, &ipad_ctx, &opad_ctx,
+                                  tmp, md_len + nb, h_i, md_len ) ) != 0 ||
+            ( ret = tls_prf_hmac( &md_ctx, &ipad_ctx, &opad_ctx,
+                                  tmp, md_len, tmp, md_len ) ) != 0 )
+            goto exit;
 
         k = ( i + md_len > dlen ) ? dlen % md_len : md_len;
 
@@ -421,38 +604,45 @@ static int tls_prf_generic( mbedtls_md_type_t md_type,
             dstbuf[i + j]  = h_i[j];
     }
 
+exit:
+    mbedtls_md_free( &ipad_ctx );
+    mbedtls_md_free( &opad_ctx );
     mbedtls_md_free( &md_ctx );
 
     mbedtls_zeroize( tmp, sizeof( tmp ) );
     mbedtls_zeroize( h_i, sizeof( h_i ) );
+    mbedtls_zeroize( pad, sizeof( pad ) );
 
-    return( 0 );
+    return( ret );
 }
 
 #if defined(MBEDTLS_SHA256_C)
-static int tls_prf_sha256( const unsigned char *secret, size_t slen,
+static int tls_prf_sha256( mbedtls_ssl_session *session,
+                           const unsigned char *secret, size_t slen,
                            const char *label,
                            const unsigned char *random, size_t rlen,
                            unsigned char *dstbuf, size_t dlen )
 {
-    return( tls_prf_generic( MBEDTLS_MD_SHA256, secret, slen,
+    return( tls_prf_generic( MBEDTLS_MD_SHA256, session, secret, slen,
                              label, random, rlen, dstbuf, dlen ) );
 }
 #endif /* MBEDTLS_SHA256_C */
 
 #if defined(MBEDTLS_SHA512_C)
-static int tls_prf_sha384( const unsigned char *secret, size_t slen,
+static int tls_prf_sha384( mbedtls_ssl_session *session,
+                           const unsigned char *secret, size_t slen,
                            const char *label,
                            const unsigned char *random, size_t rlen,
                            unsigned char *dstbuf, size_t dlen )
 {
-    return( tls_prf_generic( MBEDTLS_MD_SHA384, secret, slen,
+    return( tls_prf_generic( MBEDTLS_MD_SHA384, session, secret, slen,
                              label, random, rlen, dstbuf, dlen ) );
 }
 #endif /* MBEDTLS_SHA512_C */
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
 
 static void ssl_update_checksum_start( mbedtls_ssl_context *, const unsigned char *, size_t );
+static void ssl_conf_update_suite_gates( mbedtls_ssl_config * );
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3) || defined(MBEDTLS_SSL_PROTO_TLS1) || \
     defined(MBEDTLS_SSL_PROTO_TLS1_1)
@@ -483,6 +673,11 @@ static void ssl_calc_finished_tls_sha384( mbedtls_ssl_context *, unsigned char *
 #endif
 #endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
 
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+static int ssl_transform_set_record_funcs( mbedtls_ssl_context *,
+                                           mbedtls_ssl_transform * );
+#endif
+
 int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
 {
     int ret = 0;
@@ -580,6 +775,13 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
         MBEDTLS_SSL_DEBUG_BUF( 3, "premaster secret", handshake->premaster,
                        handshake->pmslen );
 
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2)
+        /* The master secret is about to change: cached PRF pad states
+         * keyed by the old one (possibly inherited through a session
+         * copy) must not be reused */
+        session->prf_keyed = 0;
+#endif
+
 #if defined(MBEDTLS_SSL_EXTENDED_MASTER_SECRET)
         if( ssl->handshake->extended_ms == MBEDTLS_SSL_EXTENDED_MS_ENABLED )
         {
@@ -609,7 +811,8 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
 
             MBEDTLS_SSL_DEBUG_BUF( 3, "session hash", session_hash, hash_len );
 
-            ret = handshake->tls_prf( handshake->premaster, handshake->pmslen,
+            ret = handshake->tls_prf( NULL,
+                                      handshake->premaster, handshake->pmslen,
                                       "extended master secret",
                                       session_hash, hash_len,
                                       session->master, 48 );
@@ -622,7 +825,8 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
         }
         else
 #endif
-        ret = handshake->tls_prf( handshake->premaster, handshake->pmslen,
+        ret = handshake->tls_prf( NULL,
+                                  handshake->premaster, handshake->pmslen,
                                   "master secret",
                                   handshake->randbytes, 64,
                                   session->master, 48 );
@@ -657,7 +861,7 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
      *  TLSv1:
      *    key block = PRF( master, "key expansion", randbytes )
      */
-    ret = handshake->tls_prf( session->master, 48, "key expansion",
+    ret = handshake->tls_prf( session, session->master, 48, "key expansion",
                               handshake->randbytes, 64, keyblk, 256 );
     if( ret != 0 )
     {
@@ -680,12 +884,19 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
     transform->keylen = cipher_info->key_bitlen / 8;
 
     if( cipher_info->mode == MBEDTLS_MODE_GCM ||
-        cipher_info->mode == MBEDTLS_MODE_CCM )
+        cipher_info->mode == MBEDTLS_MODE_CCM ||
+        cipher_info->mode == MBEDTLS_MODE_CHACHAPOLY )
     {
         transform->maclen = 0;
 
         transform->ivlen = 12;
-        transform->fixed_ivlen = 4;
+
+        /* ChaCha20-Poly1305 sends no explicit nonce on the wire: the
+         * whole IV is implicit and the sequence number is XORed in */
+        if( cipher_info->mode == MBEDTLS_MODE_CHACHAPOLY )
+            transform->fixed_ivlen = 12;
+        else
+            transform->fixed_ivlen = 4;
 
         /* Minimum length is expicit IV + tag */
         transform->minlen = transform->ivlen - transform->fixed_ivlen
@@ -879,6 +1090,13 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
         return( ret );
     }
 
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+    /* Keep the raw keys around for mbedtls_ssl_get_record_keys();
+     * the key block is wiped before this function returns */
+    memcpy( transform->key_enc, key1, transform->keylen );
+    memcpy( transform->key_dec, key2, transform->keylen );
+#endif
+
     if( ( ret = mbedtls_cipher_setkey( &transform->cipher_ctx_enc, key1,
                                cipher_info->key_bitlen,
                                MBEDTLS_ENCRYPT ) ) != 0 )
@@ -914,6 +1132,11 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
     }
 #endif /* MBEDTLS_CIPHER_MODE_CBC */
 
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+    if( ( ret = ssl_transform_set_record_funcs( ssl, transform ) ) != 0 )
+        return( ret );
+#endif
+
     mbedtls_zeroize( keyblk, sizeof( keyblk ) );
 
 #if defined(MBEDTLS_ZLIB_SUPPORT)
@@ -1234,130 +1457,139 @@ static void ssl_mac( mbedtls_md_context_t *md_ctx, unsigned char *secret,
 
 /*
  * Encryption/decryption functions
+ *
+ * One function per record protection family: stream ciphers and CBC in
+ * MAC-then-encrypt or encrypt-then-MAC arrangement, and AEAD. With
+ * MBEDTLS_SSL_RECORD_SPECIALIZE the matching function is bound to the
+ * transform by mbedtls_ssl_derive_keys() and records dispatch through
+ * it directly; otherwise the cipher mode is examined per record.
  */
-static int ssl_encrypt_buf( mbedtls_ssl_context *ssl )
-{
-    mbedtls_cipher_mode_t mode;
-    int auth_done = 0;
-
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> encrypt buf" ) );
 
-    if( ssl->session_out == NULL || ssl->transform_out == NULL )
+#if defined(SSL_SOME_MODES_USE_MAC)
+/*
+ * Append the MAC over the plaintext (stream and MAC-then-encrypt CBC)
+ */
+static int ssl_mac_append( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_SSL3)
+    if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        ssl_mac( &ssl->transform_out->md_ctx_enc,
+                  ssl->transform_out->mac_enc,
+                  ssl->out_msg, ssl->out_msglen,
+                  ssl->out_ctr, ssl->out_msgtype );
+    }
+    else
+#endif
+#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
+    defined(MBEDTLS_SSL_PROTO_TLS1_2)
+    if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_1 )
+    {
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_ctr, 8 );
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_hdr, 3 );
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_len, 2 );
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc,
+                         ssl->out_msg, ssl->out_msglen );
+        mbedtls_md_hmac_finish( &ssl->transform_out->md_ctx_enc,
+                         ssl->out_msg + ssl->out_msglen );
+        mbedtls_md_hmac_reset( &ssl->transform_out->md_ctx_enc );
+    }
+    else
+#endif
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
-    mode = mbedtls_cipher_get_cipher_mode( &ssl->transform_out->cipher_ctx_enc );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac",
+                   ssl->out_msg + ssl->out_msglen,
+                   ssl->transform_out->maclen );
 
-    MBEDTLS_SSL_DEBUG_BUF( 4, "before encrypt: output payload",
-                      ssl->out_msg, ssl->out_msglen );
+    ssl->out_msglen += ssl->transform_out->maclen;
 
-    /*
-     * Add MAC before if needed
-     */
-#if defined(SSL_SOME_MODES_USE_MAC)
-    if( mode == MBEDTLS_MODE_STREAM ||
-        ( mode == MBEDTLS_MODE_CBC
-#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
-          && ssl->session_out->encrypt_then_mac == MBEDTLS_SSL_ETM_DISABLED
-#endif
-        ) )
-    {
-#if defined(MBEDTLS_SSL_PROTO_SSL3)
-        if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
-        {
-            ssl_mac( &ssl->transform_out->md_ctx_enc,
-                      ssl->transform_out->mac_enc,
-                      ssl->out_msg, ssl->out_msglen,
-                      ssl->out_ctr, ssl->out_msgtype );
-        }
-        else
-#endif
-#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
-        defined(MBEDTLS_SSL_PROTO_TLS1_2)
-        if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_1 )
-        {
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_ctr, 8 );
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_hdr, 3 );
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, ssl->out_len, 2 );
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc,
-                             ssl->out_msg, ssl->out_msglen );
-            mbedtls_md_hmac_finish( &ssl->transform_out->md_ctx_enc,
-                             ssl->out_msg + ssl->out_msglen );
-            mbedtls_md_hmac_reset( &ssl->transform_out->md_ctx_enc );
-        }
-        else
-#endif
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+    return( 0 );
+}
+#endif /* SSL_SOME_MODES_USE_MAC */
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac",
-                       ssl->out_msg + ssl->out_msglen,
-                       ssl->transform_out->maclen );
+#if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
+static int ssl_encrypt_stream( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    size_t olen = 0;
 
-        ssl->out_msglen += ssl->transform_out->maclen;
-        auth_done++;
+    if( ( ret = ssl_mac_append( ssl ) ) != 0 )
+        return( ret );
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
+                        "including %d bytes of padding",
+                   ssl->out_msglen, 0 ) );
+
+    if( ( ret = mbedtls_cipher_crypt( &ssl->transform_out->cipher_ctx_enc,
+                               ssl->transform_out->iv_enc,
+                               ssl->transform_out->ivlen,
+                               ssl->out_msg, ssl->out_msglen,
+                               ssl->out_msg, &olen ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
+        return( ret );
+    }
+
+    if( ssl->out_msglen != olen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
-#endif /* AEAD not the only option */
+
+    return( 0 );
+}
+#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
+
+#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C) || \
+    defined(MBEDTLS_CHACHAPOLY_C)
+static int ssl_encrypt_aead( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    size_t enc_msglen, olen;
+    unsigned char *enc_msg;
+    unsigned char add_data[13];
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    unsigned char iv[12];
+    mbedtls_cipher_mode_t mode =
+        mbedtls_cipher_get_cipher_mode( &ssl->transform_out->cipher_ctx_enc );
+#endif
+    const unsigned char *aead_iv = ssl->transform_out->iv_enc;
+    unsigned char taglen = ssl->transform_out->ciphersuite_info->flags &
+                           MBEDTLS_CIPHERSUITE_SHORT_TAG ? 8 : 16;
+
+    memcpy( add_data, ssl->out_ctr, 8 );
+    add_data[8]  = ssl->out_msgtype;
+    mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
+                       ssl->conf->transport, add_data + 9 );
+    add_data[11] = ( ssl->out_msglen >> 8 ) & 0xFF;
+    add_data[12] = ssl->out_msglen & 0xFF;
+
+    MBEDTLS_SSL_DEBUG_BUF( 4, "additional data used for AEAD",
+                   add_data, 13 );
 
     /*
-     * Encrypt
+     * Generate IV
      */
-#if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
-    if( mode == MBEDTLS_MODE_STREAM )
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if( mode == MBEDTLS_MODE_CHACHAPOLY )
     {
-        int ret;
-        size_t olen = 0;
-
-        MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
-                            "including %d bytes of padding",
-                       ssl->out_msglen, 0 ) );
+        size_t i;
 
-        if( ( ret = mbedtls_cipher_crypt( &ssl->transform_out->cipher_ctx_enc,
-                                   ssl->transform_out->iv_enc,
-                                   ssl->transform_out->ivlen,
-                                   ssl->out_msg, ssl->out_msglen,
-                                   ssl->out_msg, &olen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
-            return( ret );
-        }
+        /* No explicit part on the wire: XOR the 64-bit sequence
+         * number into the static IV (RFC 7905) */
+        memcpy( iv, ssl->transform_out->iv_enc, 12 );
+        for( i = 0; i < 8; i++ )
+            iv[i + 4] ^= ssl->out_ctr[i];
 
-        if( ssl->out_msglen != olen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+        aead_iv = iv;
     }
     else
-#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
-#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C)
-    if( mode == MBEDTLS_MODE_GCM ||
-        mode == MBEDTLS_MODE_CCM )
+#endif /* MBEDTLS_CHACHAPOLY_C */
     {
-        int ret;
-        size_t enc_msglen, olen;
-        unsigned char *enc_msg;
-        unsigned char add_data[13];
-        unsigned char taglen = ssl->transform_out->ciphersuite_info->flags &
-                               MBEDTLS_CIPHERSUITE_SHORT_TAG ? 8 : 16;
-
-        memcpy( add_data, ssl->out_ctr, 8 );
-        add_data[8]  = ssl->out_msgtype;
-        mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
-                           ssl->conf->transport, add_data + 9 );
-        add_data[11] = ( ssl->out_msglen >> 8 ) & 0xFF;
-        add_data[12] = ssl->out_msglen & 0xFF;
-
-        MBEDTLS_SSL_DEBUG_BUF( 4, "additional data used for AEAD",
-                       add_data, 13 );
-
-        /*
-         * Generate IV
-         */
 #if defined(MBEDTLS_SSL_AEAD_RANDOM_IV)
         ret = ssl->conf->f_rng( ssl->conf->p_rng,
                 ssl->transform_out->iv_enc + ssl->transform_out->fixed_ivlen,
@@ -1380,180 +1612,284 @@ static int ssl_encrypt_buf( mbedtls_ssl_context *ssl )
                              ssl->out_ctr, 8 );
         memcpy( ssl->out_iv, ssl->out_ctr, 8 );
 #endif
+    }
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "IV used", ssl->out_iv,
-                ssl->transform_out->ivlen - ssl->transform_out->fixed_ivlen );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "IV used", ssl->out_iv,
+            ssl->transform_out->ivlen - ssl->transform_out->fixed_ivlen );
 
-        /*
-         * Fix pointer positions and message length with added IV
-         */
-        enc_msg = ssl->out_msg;
-        enc_msglen = ssl->out_msglen;
-        ssl->out_msglen += ssl->transform_out->ivlen -
-                           ssl->transform_out->fixed_ivlen;
+    /*
+     * Fix pointer positions and message length with added IV
+     */
+    enc_msg = ssl->out_msg;
+    enc_msglen = ssl->out_msglen;
+    ssl->out_msglen += ssl->transform_out->ivlen -
+                       ssl->transform_out->fixed_ivlen;
 
-        MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
-                            "including %d bytes of padding",
-                       ssl->out_msglen, 0 ) );
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
+                        "including %d bytes of padding",
+                   ssl->out_msglen, 0 ) );
 
-        /*
-         * Encrypt and authenticate
-         */
-        if( ( ret = mbedtls_cipher_auth_encrypt( &ssl->transform_out->cipher_ctx_enc,
-                                         ssl->transform_out->iv_enc,
-                                         ssl->transform_out->ivlen,
-                                         add_data, 13,
-                                         enc_msg, enc_msglen,
-                                         enc_msg, &olen,
-                                         enc_msg + enc_msglen, taglen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_auth_encrypt", ret );
-            return( ret );
-        }
+    /*
+     * Encrypt and authenticate
+     */
+    if( ( ret = mbedtls_cipher_auth_encrypt( &ssl->transform_out->cipher_ctx_enc,
+                                     aead_iv,
+                                     ssl->transform_out->ivlen,
+                                     add_data, 13,
+                                     enc_msg, enc_msglen,
+                                     enc_msg, &olen,
+                                     enc_msg + enc_msglen, taglen ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_auth_encrypt", ret );
+        return( ret );
+    }
 
-        if( olen != enc_msglen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+    if( olen != enc_msglen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
 
-        ssl->out_msglen += taglen;
-        auth_done++;
+    ssl->out_msglen += taglen;
+
+    MBEDTLS_SSL_DEBUG_BUF( 4, "after encrypt: tag", enc_msg + enc_msglen, taglen );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C || MBEDTLS_CHACHAPOLY_C */
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "after encrypt: tag", enc_msg + enc_msglen, taglen );
-    }
-    else
-#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C */
 #if defined(MBEDTLS_CIPHER_MODE_CBC) &&                                    \
     ( defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) )
-    if( mode == MBEDTLS_MODE_CBC )
+static int ssl_encrypt_cbc( mbedtls_ssl_context *ssl, int etm )
+{
+    int ret;
+    unsigned char *enc_msg;
+    size_t enc_msglen, padlen, olen = 0, i;
+
+    if( etm == 0 )
     {
-        int ret;
-        unsigned char *enc_msg;
-        size_t enc_msglen, padlen, olen = 0, i;
+        if( ( ret = ssl_mac_append( ssl ) ) != 0 )
+            return( ret );
+    }
+
+    padlen = ssl->transform_out->ivlen - ( ssl->out_msglen + 1 ) %
+             ssl->transform_out->ivlen;
+    if( padlen == ssl->transform_out->ivlen )
+        padlen = 0;
+
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+    /*
+     * Length hiding: grow the padding in whole blocks until the
+     * protected length is a multiple of the configured boundary. The
+     * record buffer always reserves MBEDTLS_SSL_PADDING_ADD bytes, so
+     * even a maximal pad fits; the one-byte pad length caps the total
+     * at 256 when the record is close to full already.
+     */
+    if( ssl->conf->record_pad != 0 &&
+        ( ssl->out_msglen + 1 + padlen ) % ssl->conf->record_pad != 0 )
+    {
+        size_t extra = ssl->conf->record_pad -
+                       ( ssl->out_msglen + 1 + padlen ) %
+                       ssl->conf->record_pad;
 
-        padlen = ssl->transform_out->ivlen - ( ssl->out_msglen + 1 ) %
+        extra += ( ssl->transform_out->ivlen -
+                   extra % ssl->transform_out->ivlen ) %
                  ssl->transform_out->ivlen;
-        if( padlen == ssl->transform_out->ivlen )
-            padlen = 0;
 
-        for( i = 0; i <= padlen; i++ )
-            ssl->out_msg[ssl->out_msglen + i] = (unsigned char) padlen;
+        if( padlen + extra > 255 )
+            extra = ( ( 255 - padlen ) / ssl->transform_out->ivlen ) *
+                    ssl->transform_out->ivlen;
 
-        ssl->out_msglen += padlen + 1;
+        padlen += extra;
+    }
+#endif /* MBEDTLS_SSL_RECORD_PADDING */
 
-        enc_msglen = ssl->out_msglen;
-        enc_msg = ssl->out_msg;
+    for( i = 0; i <= padlen; i++ )
+        ssl->out_msg[ssl->out_msglen + i] = (unsigned char) padlen;
+
+    ssl->out_msglen += padlen + 1;
+
+    enc_msglen = ssl->out_msglen;
+    enc_msg = ssl->out_msg;
 
 #if defined(MBEDTLS_SSL_PROTO_TLS1_1) || defined(MBEDTLS_SSL_PROTO_TLS1_2)
+    /*
+     * Prepend per-record IV for block cipher in TLS v1.1 and up as per
+     * Method 1 (6.2.3.2. in RFC4346 and RFC5246)
+     */
+    if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
         /*
-         * Prepend per-record IV for block cipher in TLS v1.1 and up as per
-         * Method 1 (6.2.3.2. in RFC4346 and RFC5246)
+         * Generate IV
          */
-        if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
-        {
-            /*
-             * Generate IV
-             */
-            int ret = ssl->conf->f_rng( ssl->conf->p_rng, ssl->transform_out->iv_enc,
-                                  ssl->transform_out->ivlen );
-            if( ret != 0 )
-                return( ret );
+        ret = ssl->conf->f_rng( ssl->conf->p_rng, ssl->transform_out->iv_enc,
+                              ssl->transform_out->ivlen );
+        if( ret != 0 )
+            return( ret );
 
-            memcpy( ssl->out_iv, ssl->transform_out->iv_enc,
-                    ssl->transform_out->ivlen );
+        memcpy( ssl->out_iv, ssl->transform_out->iv_enc,
+                ssl->transform_out->ivlen );
 
-            /*
-             * Fix pointer positions and message length with added IV
-             */
-            enc_msg = ssl->out_msg;
-            enc_msglen = ssl->out_msglen;
-            ssl->out_msglen += ssl->transform_out->ivlen;
-        }
+        /*
+         * Fix pointer positions and message length with added IV
+         */
+        enc_msg = ssl->out_msg;
+        enc_msglen = ssl->out_msglen;
+        ssl->out_msglen += ssl->transform_out->ivlen;
+    }
 #endif /* MBEDTLS_SSL_PROTO_TLS1_1 || MBEDTLS_SSL_PROTO_TLS1_2 */
 
-        MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
-                            "including %d bytes of IV and %d bytes of padding",
-                            ssl->out_msglen, ssl->transform_out->ivlen,
-                            padlen + 1 ) );
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "before encrypt: msglen = %d, "
+                        "including %d bytes of IV and %d bytes of padding",
+                        ssl->out_msglen, ssl->transform_out->ivlen,
+                        padlen + 1 ) );
 
-        if( ( ret = mbedtls_cipher_crypt( &ssl->transform_out->cipher_ctx_enc,
-                                   ssl->transform_out->iv_enc,
-                                   ssl->transform_out->ivlen,
-                                   enc_msg, enc_msglen,
-                                   enc_msg, &olen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
-            return( ret );
-        }
+    if( ( ret = mbedtls_cipher_crypt( &ssl->transform_out->cipher_ctx_enc,
+                               ssl->transform_out->iv_enc,
+                               ssl->transform_out->ivlen,
+                               enc_msg, enc_msglen,
+                               enc_msg, &olen ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
+        return( ret );
+    }
 
-        if( enc_msglen != olen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+    if( enc_msglen != olen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3) || defined(MBEDTLS_SSL_PROTO_TLS1)
-        if( ssl->minor_ver < MBEDTLS_SSL_MINOR_VERSION_2 )
-        {
-            /*
-             * Save IV in SSL3 and TLS1
-             */
-            memcpy( ssl->transform_out->iv_enc,
-                    ssl->transform_out->cipher_ctx_enc.iv,
-                    ssl->transform_out->ivlen );
-        }
+    if( ssl->minor_ver < MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        /*
+         * Save IV in SSL3 and TLS1
+         */
+        memcpy( ssl->transform_out->iv_enc,
+                ssl->transform_out->cipher_ctx_enc.iv,
+                ssl->transform_out->ivlen );
+    }
 #endif
 
 #if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
-        if( auth_done == 0 )
-        {
-            /*
-             * MAC(MAC_write_key, seq_num +
-             *     TLSCipherText.type +
-             *     TLSCipherText.version +
-             *     length_of( (IV +) ENC(...) ) +
-             *     IV + // except for TLS 1.0
-             *     ENC(content + padding + padding_length));
-             */
-            unsigned char pseudo_hdr[13];
+    if( etm != 0 )
+    {
+        /*
+         * MAC(MAC_write_key, seq_num +
+         *     TLSCipherText.type +
+         *     TLSCipherText.version +
+         *     length_of( (IV +) ENC(...) ) +
+         *     IV + // except for TLS 1.0
+         *     ENC(content + padding + padding_length));
+         */
+        unsigned char pseudo_hdr[13];
 
-            MBEDTLS_SSL_DEBUG_MSG( 3, ( "using encrypt then mac" ) );
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "using encrypt then mac" ) );
 
-            memcpy( pseudo_hdr +  0, ssl->out_ctr, 8 );
-            memcpy( pseudo_hdr +  8, ssl->out_hdr, 3 );
-            pseudo_hdr[11] = (unsigned char)( ( ssl->out_msglen >> 8 ) & 0xFF );
-            pseudo_hdr[12] = (unsigned char)( ( ssl->out_msglen      ) & 0xFF );
+        memcpy( pseudo_hdr +  0, ssl->out_ctr, 8 );
+        memcpy( pseudo_hdr +  8, ssl->out_hdr, 3 );
+        pseudo_hdr[11] = (unsigned char)( ( ssl->out_msglen >> 8 ) & 0xFF );
+        pseudo_hdr[12] = (unsigned char)( ( ssl->out_msglen      ) & 0xFF );
 
-            MBEDTLS_SSL_DEBUG_BUF( 4, "MAC'd meta-data", pseudo_hdr, 13 );
+        MBEDTLS_SSL_DEBUG_BUF( 4, "MAC'd meta-data", pseudo_hdr, 13 );
 
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, pseudo_hdr, 13 );
-            mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc,
-                             ssl->out_iv, ssl->out_msglen );
-            mbedtls_md_hmac_finish( &ssl->transform_out->md_ctx_enc,
-                             ssl->out_iv + ssl->out_msglen );
-            mbedtls_md_hmac_reset( &ssl->transform_out->md_ctx_enc );
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc, pseudo_hdr, 13 );
+        mbedtls_md_hmac_update( &ssl->transform_out->md_ctx_enc,
+                         ssl->out_iv, ssl->out_msglen );
+        mbedtls_md_hmac_finish( &ssl->transform_out->md_ctx_enc,
+                         ssl->out_iv + ssl->out_msglen );
+        mbedtls_md_hmac_reset( &ssl->transform_out->md_ctx_enc );
 
-            ssl->out_msglen += ssl->transform_out->maclen;
-            auth_done++;
-        }
-#endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+        ssl->out_msglen += ssl->transform_out->maclen;
     }
-    else
+#endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+static int ssl_encrypt_cbc_mte( mbedtls_ssl_context *ssl )
+{
+    return( ssl_encrypt_cbc( ssl, 0 ) );
+}
+
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+static int ssl_encrypt_cbc_etm( mbedtls_ssl_context *ssl )
+{
+    return( ssl_encrypt_cbc( ssl, 1 ) );
+}
+#endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
 #endif /* MBEDTLS_CIPHER_MODE_CBC &&
           ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
+
+static int ssl_encrypt_buf( mbedtls_ssl_context *ssl )
+{
+    int ret;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> encrypt buf" ) );
+
+    if( ssl->session_out == NULL || ssl->transform_out == NULL )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
-    /* Make extra sure authentication was performed, exactly once */
-    if( auth_done != 1 )
+    MBEDTLS_SSL_DEBUG_BUF( 4, "before encrypt: output payload",
+                      ssl->out_msg, ssl->out_msglen );
+
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+    if( ssl->transform_out->f_encrypt == NULL )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
+    if( ( ret = ssl->transform_out->f_encrypt( ssl ) ) != 0 )
+        return( ret );
+#else /* MBEDTLS_SSL_RECORD_SPECIALIZE */
+    {
+        mbedtls_cipher_mode_t mode = mbedtls_cipher_get_cipher_mode(
+                                        &ssl->transform_out->cipher_ctx_enc );
+
+#if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
+        if( mode == MBEDTLS_MODE_STREAM )
+            ret = ssl_encrypt_stream( ssl );
+        else
+#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
+#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C) || \
+    defined(MBEDTLS_CHACHAPOLY_C)
+        if( mode == MBEDTLS_MODE_GCM ||
+            mode == MBEDTLS_MODE_CCM ||
+            mode == MBEDTLS_MODE_CHACHAPOLY )
+            ret = ssl_encrypt_aead( ssl );
+        else
+#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C || MBEDTLS_CHACHAPOLY_C */
+#if defined(MBEDTLS_CIPHER_MODE_CBC) &&                                    \
+    ( defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) )
+        if( mode == MBEDTLS_MODE_CBC )
+        {
+            int etm = 0;
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+            etm = ( ssl->session_out->encrypt_then_mac ==
+                    MBEDTLS_SSL_ETM_ENABLED );
+#endif
+            ret = ssl_encrypt_cbc( ssl, etm );
+        }
+        else
+#endif /* MBEDTLS_CIPHER_MODE_CBC &&
+          ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        }
+
+        if( ret != 0 )
+            return( ret );
+    }
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= encrypt buf" ) );
 
     return( 0 );
@@ -1561,451 +1897,639 @@ static int ssl_encrypt_buf( mbedtls_ssl_context *ssl )
 
 #define SSL_MAX_MAC_SIZE   48
 
-static int ssl_decrypt_buf( mbedtls_ssl_context *ssl )
+#if defined(SSL_SOME_MODES_USE_MAC) && \
+    ( defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
+      defined(MBEDTLS_SSL_PROTO_TLS1_2) )
+/*
+ * Compute HMAC( add_data || data[0..data_len) ) where data_len is secret,
+ * but known to lie in [min_data_len, max_data_len], without leaking
+ * data_len through timing or memory access patterns (Lucky Thirteen).
+ *
+ * The HMAC abstraction is broken up: the context has already absorbed the
+ * inner key pad, so the inner hash is advanced to min_data_len, then for
+ * every candidate length the hash is finished on a cloned context and the
+ * digest for the real length is kept with a constant-time select. The
+ * outer hash then runs over the key pad stored in the context. This
+ * replaces the former scheme of compressing extra dummy blocks, whose
+ * cost was paid on every record.
+ *
+ * The context must have been started with mbedtls_md_hmac_starts() or
+ * mbedtls_md_hmac_reset(), and is ready for the next record on return.
+ */
+static int ssl_ct_hmac( mbedtls_md_context_t *ctx,
+                        const unsigned char *add_data, size_t add_data_len,
+                        const unsigned char *data, size_t data_len,
+                        size_t min_data_len, size_t max_data_len,
+                        unsigned char *output )
 {
-    size_t i;
-    mbedtls_cipher_mode_t mode;
-    int auth_done = 0;
+    int ret;
+    /* TLS 1.0-1.2 only use hashes with a block size of 64 or 128 bytes */
+    const size_t block_size =
+        mbedtls_md_get_type( ctx->md_info ) == MBEDTLS_MD_SHA384 ? 128 : 64;
+    const unsigned char * const okey =
+        (const unsigned char *) ctx->hmac_ctx + block_size;
+    const size_t hash_size = mbedtls_md_get_size( ctx->md_info );
+    unsigned char aux_out[MBEDTLS_MD_MAX_SIZE];
+    mbedtls_md_context_t aux;
+    size_t offset;
+
+    mbedtls_md_init( &aux );
+
+    if( ( ret = mbedtls_md_setup( &aux, ctx->md_info, 1 ) ) != 0 )
+        goto cleanup;
+
+    if( ( ret = mbedtls_md_update( ctx, add_data, add_data_len ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_md_update( ctx, data, min_data_len ) ) != 0 )
+        goto cleanup;
+
+    /* Make sure the potential output is not a valid MAC, in case the
+     * caller uses it without checking the return code */
+    memset( output, '!', hash_size );
+
+    /* Finish the inner hash once per candidate length, keeping only the
+     * digest that corresponds to the real one */
+    for( offset = min_data_len; offset <= max_data_len; offset++ )
+    {
+        if( ( ret = mbedtls_md_clone( &aux, ctx ) ) != 0 )
+            goto cleanup;
+        if( ( ret = mbedtls_md_finish( &aux, aux_out ) ) != 0 )
+            goto cleanup;
+
+        mbedtls_ct_memcpy_if( mbedtls_ct_size_eq( offset, data_len ),
+                              output, aux_out, hash_size );
+
+        if( offset < max_data_len &&
+            ( ret = mbedtls_md_update( ctx, data + offset, 1 ) ) != 0 )
+            goto cleanup;
+    }
+
+    /* The context needs a finish() before it can start() again */
+    if( ( ret = mbedtls_md_finish( ctx, aux_out ) ) != 0 )
+        goto cleanup;
+
+    /* Now compute HASH( okey || inner_hash ) */
+    if( ( ret = mbedtls_md_starts( ctx ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_md_update( ctx, okey, block_size ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_md_update( ctx, output, hash_size ) ) != 0 )
+        goto cleanup;
+    if( ( ret = mbedtls_md_finish( ctx, output ) ) != 0 )
+        goto cleanup;
+
+    /* Done, get ready for the next record */
+    ret = mbedtls_md_hmac_reset( ctx );
+
+cleanup:
+    mbedtls_md_free( &aux );
+    mbedtls_zeroize( aux_out, sizeof( aux_out ) );
+
+    return( ret );
+}
+#endif /* SSL_SOME_MODES_USE_MAC && TLS 1.0-1.2 */
+
 #if defined(SSL_SOME_MODES_USE_MAC)
-    size_t padlen = 0, correct = 1;
-#endif
+/*
+ * Check the MAC that follows the plaintext (stream and MAC-then-encrypt
+ * CBC). For CBC, padlen and correct carry the result of the padding
+ * check; the MAC is computed and compared regardless of it (RFC4346,
+ * CBCTIME).
+ */
+static int ssl_decrypt_mac_check( mbedtls_ssl_context *ssl,
+                                  size_t padlen, size_t correct )
+{
+    unsigned char mac_peer[SSL_MAX_MAC_SIZE];
+    unsigned char mac_expect[SSL_MAX_MAC_SIZE];
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> decrypt buf" ) );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "raw buffer after decryption",
+                   ssl->in_msg, ssl->in_msglen );
+
+    ssl->in_msglen -= ssl->transform_in->maclen;
+
+    ssl->in_len[0] = (unsigned char)( ssl->in_msglen >> 8 );
+    ssl->in_len[1] = (unsigned char)( ssl->in_msglen      );
+
+#if defined(MBEDTLS_SSL_PROTO_SSL3)
+    if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        memcpy( mac_peer, ssl->in_msg + ssl->in_msglen,
+                ssl->transform_in->maclen );
+
+        ssl_mac( &ssl->transform_in->md_ctx_dec,
+                  ssl->transform_in->mac_dec,
+                  ssl->in_msg, ssl->in_msglen,
+                  ssl->in_ctr, ssl->in_msgtype );
+
+        memcpy( mac_expect, ssl->in_msg + ssl->in_msglen,
+                ssl->transform_in->maclen );
+    }
+    else
+#endif /* MBEDTLS_SSL_PROTO_SSL3 */
+#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
+    defined(MBEDTLS_SSL_PROTO_TLS1_2)
+    if( ssl->minor_ver > MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        /*
+         * The padding (and hence the plaintext length) is secret, so
+         * both the expected MAC and the received MAC that follows the
+         * plaintext must be handled without branching on it.
+         *
+         * Known timing attacks:
+         *  - Lucky Thirteen (http://www.isg.rhul.ac.uk/tls/TLStiming.pdf)
+         *
+         * The length can only range over the possible padding values,
+         * and padlen has been zeroed if the padding was found invalid.
+         */
+        int ret;
+        const size_t max_len = ssl->in_msglen + padlen;
+        const size_t min_len = ( max_len > 256 ) ? max_len - 256 : 0;
+        unsigned char add_data[13];
+
+        memcpy( add_data, ssl->in_ctr, 8 );
+        memcpy( add_data + 8, ssl->in_hdr, 3 );
+        memcpy( add_data + 11, ssl->in_len, 2 );
+
+        mbedtls_ct_memcpy_offset( mac_peer, ssl->in_msg,
+                                  ssl->in_msglen, min_len, max_len,
+                                  ssl->transform_in->maclen );
 
-    if( ssl->session_in == NULL || ssl->transform_in == NULL )
+        if( ( ret = ssl_ct_hmac( &ssl->transform_in->md_ctx_dec,
+                                 add_data, sizeof( add_data ),
+                                 ssl->in_msg, ssl->in_msglen,
+                                 min_len, max_len,
+                                 mac_expect ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "ssl_ct_hmac", ret );
+            return( ret );
+        }
+    }
+    else
+#endif /* MBEDTLS_SSL_PROTO_TLS1 || MBEDTLS_SSL_PROTO_TLS1_1 || \
+          MBEDTLS_SSL_PROTO_TLS1_2 */
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
-    mode = mbedtls_cipher_get_cipher_mode( &ssl->transform_in->cipher_ctx_dec );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "message  mac", mac_peer,
+                   ssl->transform_in->maclen );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac", mac_expect,
+                   ssl->transform_in->maclen );
 
-    if( ssl->in_msglen < ssl->transform_in->minlen )
+    if( mbedtls_ssl_safer_memcmp( mac_peer, mac_expect,
+                     ssl->transform_in->maclen ) != 0 )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "in_msglen (%d) < minlen (%d)",
-                       ssl->in_msglen, ssl->transform_in->minlen ) );
-        return( MBEDTLS_ERR_SSL_INVALID_MAC );
+#if defined(MBEDTLS_SSL_DEBUG_ALL)
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "message mac does not match" ) );
+#endif
+        correct = 0;
     }
 
+    /*
+     * Finally check the correct flag
+     */
+    if( correct == 0 )
+        return( MBEDTLS_ERR_SSL_INVALID_MAC );
+
+    return( 0 );
+}
+#endif /* SSL_SOME_MODES_USE_MAC */
+
 #if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
-    if( mode == MBEDTLS_MODE_STREAM )
+static int ssl_decrypt_stream( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    size_t olen = 0;
+
+    if( ( ret = mbedtls_cipher_crypt( &ssl->transform_in->cipher_ctx_dec,
+                               ssl->transform_in->iv_dec,
+                               ssl->transform_in->ivlen,
+                               ssl->in_msg, ssl->in_msglen,
+                               ssl->in_msg, &olen ) ) != 0 )
     {
-        int ret;
-        size_t olen = 0;
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
+        return( ret );
+    }
 
-        padlen = 0;
+    if( ssl->in_msglen != olen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
 
-        if( ( ret = mbedtls_cipher_crypt( &ssl->transform_in->cipher_ctx_dec,
-                                   ssl->transform_in->iv_dec,
-                                   ssl->transform_in->ivlen,
-                                   ssl->in_msg, ssl->in_msglen,
-                                   ssl->in_msg, &olen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
-            return( ret );
-        }
+    return( ssl_decrypt_mac_check( ssl, 0, 1 ) );
+}
+#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
 
-        if( ssl->in_msglen != olen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C) || \
+    defined(MBEDTLS_CHACHAPOLY_C)
+static int ssl_decrypt_aead( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    size_t dec_msglen, olen;
+    unsigned char *dec_msg;
+    unsigned char *dec_msg_result;
+    unsigned char add_data[13];
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    unsigned char iv[12];
+    mbedtls_cipher_mode_t mode =
+        mbedtls_cipher_get_cipher_mode( &ssl->transform_in->cipher_ctx_dec );
+#endif
+    const unsigned char *aead_iv = ssl->transform_in->iv_dec;
+    unsigned char taglen = ssl->transform_in->ciphersuite_info->flags &
+                           MBEDTLS_CIPHERSUITE_SHORT_TAG ? 8 : 16;
+    size_t explicit_iv_len = ssl->transform_in->ivlen -
+                             ssl->transform_in->fixed_ivlen;
+
+    if( ssl->in_msglen < explicit_iv_len + taglen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < explicit_iv_len (%d) "
+                            "+ taglen (%d)", ssl->in_msglen,
+                            explicit_iv_len, taglen ) );
+        return( MBEDTLS_ERR_SSL_INVALID_MAC );
     }
-    else
-#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
-#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C)
-    if( mode == MBEDTLS_MODE_GCM ||
-        mode == MBEDTLS_MODE_CCM )
-    {
-        int ret;
-        size_t dec_msglen, olen;
-        unsigned char *dec_msg;
-        unsigned char *dec_msg_result;
-        unsigned char add_data[13];
-        unsigned char taglen = ssl->transform_in->ciphersuite_info->flags &
-                               MBEDTLS_CIPHERSUITE_SHORT_TAG ? 8 : 16;
-        size_t explicit_iv_len = ssl->transform_in->ivlen -
-                                 ssl->transform_in->fixed_ivlen;
+    dec_msglen = ssl->in_msglen - explicit_iv_len - taglen;
 
-        if( ssl->in_msglen < explicit_iv_len + taglen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < explicit_iv_len (%d) "
-                                "+ taglen (%d)", ssl->in_msglen,
-                                explicit_iv_len, taglen ) );
-            return( MBEDTLS_ERR_SSL_INVALID_MAC );
-        }
-        dec_msglen = ssl->in_msglen - explicit_iv_len - taglen;
+    dec_msg = ssl->in_msg;
+    dec_msg_result = ssl->in_msg;
+    ssl->in_msglen = dec_msglen;
 
-        dec_msg = ssl->in_msg;
-        dec_msg_result = ssl->in_msg;
-        ssl->in_msglen = dec_msglen;
+    memcpy( add_data, ssl->in_ctr, 8 );
+    add_data[8]  = ssl->in_msgtype;
+    mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
+                       ssl->conf->transport, add_data + 9 );
+    add_data[11] = ( ssl->in_msglen >> 8 ) & 0xFF;
+    add_data[12] = ssl->in_msglen & 0xFF;
 
-        memcpy( add_data, ssl->in_ctr, 8 );
-        add_data[8]  = ssl->in_msgtype;
-        mbedtls_ssl_write_version( ssl->major_ver, ssl->minor_ver,
-                           ssl->conf->transport, add_data + 9 );
-        add_data[11] = ( ssl->in_msglen >> 8 ) & 0xFF;
-        add_data[12] = ssl->in_msglen & 0xFF;
+    MBEDTLS_SSL_DEBUG_BUF( 4, "additional data used for AEAD",
+                   add_data, 13 );
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if( mode == MBEDTLS_MODE_CHACHAPOLY )
+    {
+        size_t i;
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "additional data used for AEAD",
-                       add_data, 13 );
+        /* No explicit part on the wire: XOR the 64-bit sequence
+         * number into the static IV (RFC 7905) */
+        memcpy( iv, ssl->transform_in->iv_dec, 12 );
+        for( i = 0; i < 8; i++ )
+            iv[i + 4] ^= ssl->in_ctr[i];
 
+        aead_iv = iv;
+    }
+    else
+#endif /* MBEDTLS_CHACHAPOLY_C */
+    {
         memcpy( ssl->transform_in->iv_dec + ssl->transform_in->fixed_ivlen,
                 ssl->in_iv,
                 ssl->transform_in->ivlen - ssl->transform_in->fixed_ivlen );
+    }
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "IV used", ssl->transform_in->iv_dec,
-                                     ssl->transform_in->ivlen );
-        MBEDTLS_SSL_DEBUG_BUF( 4, "TAG used", dec_msg + dec_msglen, taglen );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "IV used", aead_iv,
+                                 ssl->transform_in->ivlen );
+    MBEDTLS_SSL_DEBUG_BUF( 4, "TAG used", dec_msg + dec_msglen, taglen );
 
-        /*
-         * Decrypt and authenticate
-         */
-        if( ( ret = mbedtls_cipher_auth_decrypt( &ssl->transform_in->cipher_ctx_dec,
-                                         ssl->transform_in->iv_dec,
-                                         ssl->transform_in->ivlen,
-                                         add_data, 13,
-                                         dec_msg, dec_msglen,
-                                         dec_msg_result, &olen,
-                                         dec_msg + dec_msglen, taglen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_auth_decrypt", ret );
+    /*
+     * Decrypt and authenticate
+     */
+    if( ( ret = mbedtls_cipher_auth_decrypt( &ssl->transform_in->cipher_ctx_dec,
+                                     aead_iv,
+                                     ssl->transform_in->ivlen,
+                                     add_data, 13,
+                                     dec_msg, dec_msglen,
+                                     dec_msg_result, &olen,
+                                     dec_msg + dec_msglen, taglen ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_auth_decrypt", ret );
 
-            if( ret == MBEDTLS_ERR_CIPHER_AUTH_FAILED )
-                return( MBEDTLS_ERR_SSL_INVALID_MAC );
+        if( ret == MBEDTLS_ERR_CIPHER_AUTH_FAILED )
+            return( MBEDTLS_ERR_SSL_INVALID_MAC );
 
-            return( ret );
-        }
-        auth_done++;
+        return( ret );
+    }
 
-        if( olen != dec_msglen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+    if( olen != dec_msglen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
-    else
-#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C */
+
+    MBEDTLS_SSL_DEBUG_BUF( 4, "raw buffer after decryption",
+                   ssl->in_msg, ssl->in_msglen );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C || MBEDTLS_CHACHAPOLY_C */
+
 #if defined(MBEDTLS_CIPHER_MODE_CBC) &&                                    \
     ( defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) )
-    if( mode == MBEDTLS_MODE_CBC )
-    {
-        /*
-         * Decrypt and check the padding
-         */
-        int ret;
-        unsigned char *dec_msg;
-        unsigned char *dec_msg_result;
-        size_t dec_msglen;
-        size_t minlen = 0;
-        size_t olen = 0;
+/*
+ * Decrypt and check the padding
+ */
+static int ssl_decrypt_cbc( mbedtls_ssl_context *ssl, int etm )
+{
+    int ret;
+    unsigned char *dec_msg;
+    unsigned char *dec_msg_result;
+    size_t i;
+    size_t dec_msglen;
+    size_t minlen = 0;
+    size_t olen = 0;
+    size_t padlen = 0, correct = 1;
 
-        /*
-         * Check immediate ciphertext sanity
-         */
+    /*
+     * Check immediate ciphertext sanity
+     */
 #if defined(MBEDTLS_SSL_PROTO_TLS1_1) || defined(MBEDTLS_SSL_PROTO_TLS1_2)
-        if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
-            minlen += ssl->transform_in->ivlen;
+    if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+        minlen += ssl->transform_in->ivlen;
 #endif
 
-        if( ssl->in_msglen < minlen + ssl->transform_in->ivlen ||
-            ssl->in_msglen < minlen + ssl->transform_in->maclen + 1 )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < max( ivlen(%d), maclen (%d) "
-                                "+ 1 ) ( + expl IV )", ssl->in_msglen,
-                                ssl->transform_in->ivlen,
-                                ssl->transform_in->maclen ) );
-            return( MBEDTLS_ERR_SSL_INVALID_MAC );
-        }
+    if( ssl->in_msglen < minlen + ssl->transform_in->ivlen ||
+        ssl->in_msglen < minlen + ssl->transform_in->maclen + 1 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < max( ivlen(%d), maclen (%d) "
+                            "+ 1 ) ( + expl IV )", ssl->in_msglen,
+                            ssl->transform_in->ivlen,
+                            ssl->transform_in->maclen ) );
+        return( MBEDTLS_ERR_SSL_INVALID_MAC );
+    }
 
-        dec_msglen = ssl->in_msglen;
-        dec_msg = ssl->in_msg;
-        dec_msg_result = ssl->in_msg;
+    dec_msglen = ssl->in_msglen;
+    dec_msg = ssl->in_msg;
+    dec_msg_result = ssl->in_msg;
 
-        /*
-         * Authenticate before decrypt if enabled
-         */
+    /*
+     * Authenticate before decrypt if enabled
+     */
 #if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
-        if( ssl->session_in->encrypt_then_mac == MBEDTLS_SSL_ETM_ENABLED )
-        {
-            unsigned char computed_mac[SSL_MAX_MAC_SIZE];
-            unsigned char pseudo_hdr[13];
+    if( etm != 0 )
+    {
+        unsigned char computed_mac[SSL_MAX_MAC_SIZE];
+        unsigned char pseudo_hdr[13];
 
-            MBEDTLS_SSL_DEBUG_MSG( 3, ( "using encrypt then mac" ) );
+        MBEDTLS_SSL_DEBUG_MSG( 3, ( "using encrypt then mac" ) );
 
-            dec_msglen -= ssl->transform_in->maclen;
-            ssl->in_msglen -= ssl->transform_in->maclen;
+        dec_msglen -= ssl->transform_in->maclen;
+        ssl->in_msglen -= ssl->transform_in->maclen;
 
-            memcpy( pseudo_hdr +  0, ssl->in_ctr, 8 );
-            memcpy( pseudo_hdr +  8, ssl->in_hdr, 3 );
-            pseudo_hdr[11] = (unsigned char)( ( ssl->in_msglen >> 8 ) & 0xFF );
-            pseudo_hdr[12] = (unsigned char)( ( ssl->in_msglen      ) & 0xFF );
+        memcpy( pseudo_hdr +  0, ssl->in_ctr, 8 );
+        memcpy( pseudo_hdr +  8, ssl->in_hdr, 3 );
+        pseudo_hdr[11] = (unsigned char)( ( ssl->in_msglen >> 8 ) & 0xFF );
+        pseudo_hdr[12] = (unsigned char)( ( ssl->in_msglen      ) & 0xFF );
 
-            MBEDTLS_SSL_DEBUG_BUF( 4, "MAC'd meta-data", pseudo_hdr, 13 );
+        MBEDTLS_SSL_DEBUG_BUF( 4, "MAC'd meta-data", pseudo_hdr, 13 );
 
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, pseudo_hdr, 13 );
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec,
-                             ssl->in_iv, ssl->in_msglen );
-            mbedtls_md_hmac_finish( &ssl->transform_in->md_ctx_dec, computed_mac );
-            mbedtls_md_hmac_reset( &ssl->transform_in->md_ctx_dec );
+        mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, pseudo_hdr, 13 );
+        mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec,
+                         ssl->in_iv, ssl->in_msglen );
+        mbedtls_md_hmac_finish( &ssl->transform_in->md_ctx_dec, computed_mac );
+        mbedtls_md_hmac_reset( &ssl->transform_in->md_ctx_dec );
 
-            MBEDTLS_SSL_DEBUG_BUF( 4, "message  mac", ssl->in_iv + ssl->in_msglen,
-                                              ssl->transform_in->maclen );
-            MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac", computed_mac,
-                                              ssl->transform_in->maclen );
+        MBEDTLS_SSL_DEBUG_BUF( 4, "message  mac", ssl->in_iv + ssl->in_msglen,
+                                          ssl->transform_in->maclen );
+        MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac", computed_mac,
+                                          ssl->transform_in->maclen );
 
-            if( mbedtls_ssl_safer_memcmp( ssl->in_iv + ssl->in_msglen, computed_mac,
-                              ssl->transform_in->maclen ) != 0 )
-            {
-                MBEDTLS_SSL_DEBUG_MSG( 1, ( "message mac does not match" ) );
+        if( mbedtls_ssl_safer_memcmp( ssl->in_iv + ssl->in_msglen, computed_mac,
+                          ssl->transform_in->maclen ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "message mac does not match" ) );
 
-                return( MBEDTLS_ERR_SSL_INVALID_MAC );
-            }
-            auth_done++;
+            return( MBEDTLS_ERR_SSL_INVALID_MAC );
         }
+    }
 #endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
 
-        /*
-         * Check length sanity
-         */
-        if( ssl->in_msglen % ssl->transform_in->ivlen != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) %% ivlen (%d) != 0",
-                           ssl->in_msglen, ssl->transform_in->ivlen ) );
-            return( MBEDTLS_ERR_SSL_INVALID_MAC );
-        }
+    /*
+     * Check length sanity
+     */
+    if( ssl->in_msglen % ssl->transform_in->ivlen != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) %% ivlen (%d) != 0",
+                       ssl->in_msglen, ssl->transform_in->ivlen ) );
+        return( MBEDTLS_ERR_SSL_INVALID_MAC );
+    }
 
 #if defined(MBEDTLS_SSL_PROTO_TLS1_1) || defined(MBEDTLS_SSL_PROTO_TLS1_2)
-        /*
-         * Initialize for prepended IV for block cipher in TLS v1.1 and up
-         */
-        if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
-        {
-            dec_msglen -= ssl->transform_in->ivlen;
-            ssl->in_msglen -= ssl->transform_in->ivlen;
+    /*
+     * Initialize for prepended IV for block cipher in TLS v1.1 and up
+     */
+    if( ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        dec_msglen -= ssl->transform_in->ivlen;
+        ssl->in_msglen -= ssl->transform_in->ivlen;
 
-            for( i = 0; i < ssl->transform_in->ivlen; i++ )
-                ssl->transform_in->iv_dec[i] = ssl->in_iv[i];
-        }
+        for( i = 0; i < ssl->transform_in->ivlen; i++ )
+            ssl->transform_in->iv_dec[i] = ssl->in_iv[i];
+    }
 #endif /* MBEDTLS_SSL_PROTO_TLS1_1 || MBEDTLS_SSL_PROTO_TLS1_2 */
 
-        if( ( ret = mbedtls_cipher_crypt( &ssl->transform_in->cipher_ctx_dec,
-                                   ssl->transform_in->iv_dec,
-                                   ssl->transform_in->ivlen,
-                                   dec_msg, dec_msglen,
-                                   dec_msg_result, &olen ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
-            return( ret );
-        }
+    if( ( ret = mbedtls_cipher_crypt( &ssl->transform_in->cipher_ctx_dec,
+                               ssl->transform_in->iv_dec,
+                               ssl->transform_in->ivlen,
+                               dec_msg, dec_msglen,
+                               dec_msg_result, &olen ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_cipher_crypt", ret );
+        return( ret );
+    }
 
-        if( dec_msglen != olen )
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
+    if( dec_msglen != olen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3) || defined(MBEDTLS_SSL_PROTO_TLS1)
-        if( ssl->minor_ver < MBEDTLS_SSL_MINOR_VERSION_2 )
-        {
-            /*
-             * Save IV in SSL3 and TLS1
-             */
-            memcpy( ssl->transform_in->iv_dec,
-                    ssl->transform_in->cipher_ctx_dec.iv,
-                    ssl->transform_in->ivlen );
-        }
+    if( ssl->minor_ver < MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        /*
+         * Save IV in SSL3 and TLS1
+         */
+        memcpy( ssl->transform_in->iv_dec,
+                ssl->transform_in->cipher_ctx_dec.iv,
+                ssl->transform_in->ivlen );
+    }
 #endif
 
-        padlen = 1 + ssl->in_msg[ssl->in_msglen - 1];
+    padlen = 1 + ssl->in_msg[ssl->in_msglen - 1];
 
-        if( ssl->in_msglen < ssl->transform_in->maclen + padlen &&
-            auth_done == 0 )
-        {
+    if( ssl->in_msglen < ssl->transform_in->maclen + padlen &&
+        etm == 0 )
+    {
 #if defined(MBEDTLS_SSL_DEBUG_ALL)
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < maclen (%d) + padlen (%d)",
-                        ssl->in_msglen, ssl->transform_in->maclen, padlen ) );
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "msglen (%d) < maclen (%d) + padlen (%d)",
+                    ssl->in_msglen, ssl->transform_in->maclen, padlen ) );
 #endif
-            padlen = 0;
-            correct = 0;
-        }
+        padlen = 0;
+        correct = 0;
+    }
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3)
-        if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
+    if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        if( padlen > ssl->transform_in->ivlen )
         {
-            if( padlen > ssl->transform_in->ivlen )
-            {
 #if defined(MBEDTLS_SSL_DEBUG_ALL)
-                MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad padding length: is %d, "
-                                    "should be no more than %d",
-                               padlen, ssl->transform_in->ivlen ) );
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad padding length: is %d, "
+                                "should be no more than %d",
+                           padlen, ssl->transform_in->ivlen ) );
 #endif
-                correct = 0;
-            }
+            correct = 0;
         }
-        else
+    }
+    else
 #endif /* MBEDTLS_SSL_PROTO_SSL3 */
 #if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
     defined(MBEDTLS_SSL_PROTO_TLS1_2)
-        if( ssl->minor_ver > MBEDTLS_SSL_MINOR_VERSION_0 )
-        {
-            /*
-             * TLSv1+: always check the padding up to the first failure
-             * and fake check up to 256 bytes of padding
-             */
-            size_t pad_count = 0, real_count = 1;
-            size_t padding_idx = ssl->in_msglen - padlen - 1;
+    if( ssl->minor_ver > MBEDTLS_SSL_MINOR_VERSION_0 )
+    {
+        /*
+         * TLSv1+: always check the padding up to the first failure
+         * and fake check up to 256 bytes of padding
+         */
+        size_t pad_count = 0, real_count = 1;
+        size_t padding_idx = ssl->in_msglen - padlen - 1;
 
-            /*
-             * Padding is guaranteed to be incorrect if:
-             *   1. padlen >= ssl->in_msglen
-             *
-             *   2. padding_idx >= MBEDTLS_SSL_MAX_CONTENT_LEN +
-             *                     ssl->transform_in->maclen
-             *
-             * In both cases we reset padding_idx to a safe value (0) to
-             * prevent out-of-buffer reads.
-             */
-            correct &= ( ssl->in_msglen >= padlen + 1 );
-            correct &= ( padding_idx < MBEDTLS_SSL_MAX_CONTENT_LEN +
-                                       ssl->transform_in->maclen );
+        /*
+         * Padding is guaranteed to be incorrect if:
+         *   1. padlen >= ssl->in_msglen
+         *
+         *   2. padding_idx >= MBEDTLS_SSL_MAX_CONTENT_LEN +
+         *                     ssl->transform_in->maclen
+         *
+         * In both cases we reset padding_idx to a safe value (0) to
+         * prevent out-of-buffer reads.
+         */
+        correct &= ( ssl->in_msglen >= padlen + 1 );
+        correct &= ( padding_idx < MBEDTLS_SSL_MAX_CONTENT_LEN +
+                                   ssl->transform_in->maclen );
 
-            padding_idx *= correct;
+        padding_idx *= correct;
 
-            for( i = 1; i <= 256; i++ )
-            {
-                real_count &= ( i <= padlen );
-                pad_count += real_count *
-                             ( ssl->in_msg[padding_idx + i] == padlen - 1 );
-            }
+        for( i = 1; i <= 256; i++ )
+        {
+            real_count &= ( i <= padlen );
+            pad_count += real_count *
+                         ( ssl->in_msg[padding_idx + i] == padlen - 1 );
+        }
 
-            correct &= ( pad_count == padlen ); /* Only 1 on correct padding */
+        correct &= ( pad_count == padlen ); /* Only 1 on correct padding */
 
 #if defined(MBEDTLS_SSL_DEBUG_ALL)
-            if( padlen > 0 && correct == 0 )
-                MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad padding byte detected" ) );
+        if( padlen > 0 && correct == 0 )
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad padding byte detected" ) );
 #endif
-            padlen &= correct * 0x1FF;
-        }
-        else
-#endif /* MBEDTLS_SSL_PROTO_TLS1 || MBEDTLS_SSL_PROTO_TLS1_1 || \
-          MBEDTLS_SSL_PROTO_TLS1_2 */
-        {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-            return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
-        }
-
-        ssl->in_msglen -= padlen;
+        padlen &= correct * 0x1FF;
     }
     else
-#endif /* MBEDTLS_CIPHER_MODE_CBC &&
-          ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
+#endif /* MBEDTLS_SSL_PROTO_TLS1 || MBEDTLS_SSL_PROTO_TLS1_1 || \
+          MBEDTLS_SSL_PROTO_TLS1_2 */
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
+    ssl->in_msglen -= padlen;
+
+    if( etm == 0 )
+        return( ssl_decrypt_mac_check( ssl, padlen, correct ) );
+
     MBEDTLS_SSL_DEBUG_BUF( 4, "raw buffer after decryption",
                    ssl->in_msg, ssl->in_msglen );
 
-    /*
-     * Authenticate if not done yet.
-     * Compute the MAC regardless of the padding result (RFC4346, CBCTIME).
-     */
-#if defined(SSL_SOME_MODES_USE_MAC)
-    if( auth_done == 0 )
-    {
-        unsigned char tmp[SSL_MAX_MAC_SIZE];
+    return( 0 );
+}
 
-        ssl->in_msglen -= ssl->transform_in->maclen;
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+static int ssl_decrypt_cbc_mte( mbedtls_ssl_context *ssl )
+{
+    return( ssl_decrypt_cbc( ssl, 0 ) );
+}
 
-        ssl->in_len[0] = (unsigned char)( ssl->in_msglen >> 8 );
-        ssl->in_len[1] = (unsigned char)( ssl->in_msglen      );
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+static int ssl_decrypt_cbc_etm( mbedtls_ssl_context *ssl )
+{
+    return( ssl_decrypt_cbc( ssl, 1 ) );
+}
+#endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
+#endif /* MBEDTLS_CIPHER_MODE_CBC &&
+          ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
 
-        memcpy( tmp, ssl->in_msg + ssl->in_msglen, ssl->transform_in->maclen );
+static int ssl_decrypt_buf( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    size_t i;
 
-#if defined(MBEDTLS_SSL_PROTO_SSL3)
-        if( ssl->minor_ver == MBEDTLS_SSL_MINOR_VERSION_0 )
-        {
-            ssl_mac( &ssl->transform_in->md_ctx_dec,
-                      ssl->transform_in->mac_dec,
-                      ssl->in_msg, ssl->in_msglen,
-                      ssl->in_ctr, ssl->in_msgtype );
-        }
-        else
-#endif /* MBEDTLS_SSL_PROTO_SSL3 */
-#if defined(MBEDTLS_SSL_PROTO_TLS1) || defined(MBEDTLS_SSL_PROTO_TLS1_1) || \
-        defined(MBEDTLS_SSL_PROTO_TLS1_2)
-        if( ssl->minor_ver > MBEDTLS_SSL_MINOR_VERSION_0 )
-        {
-            /*
-             * Process MAC and always update for padlen afterwards to make
-             * total time independent of padlen
-             *
-             * extra_run compensates MAC check for padlen
-             *
-             * Known timing attacks:
-             *  - Lucky Thirteen (http://www.isg.rhul.ac.uk/tls/TLStiming.pdf)
-             *
-             * We use ( ( Lx + 8 ) / 64 ) to handle 'negative Lx' values
-             * correctly. (We round down instead of up, so -56 is the correct
-             * value for our calculations instead of -55)
-             */
-            size_t j, extra_run = 0;
-            extra_run = ( 13 + ssl->in_msglen + padlen + 8 ) / 64 -
-                        ( 13 + ssl->in_msglen          + 8 ) / 64;
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> decrypt buf" ) );
 
-            extra_run &= correct * 0xFF;
+    if( MBEDTLS_UNLIKELY( ssl->session_in == NULL ||
+                          ssl->transform_in == NULL ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
+
+    if( MBEDTLS_UNLIKELY( ssl->in_msglen < ssl->transform_in->minlen ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "in_msglen (%d) < minlen (%d)",
+                       ssl->in_msglen, ssl->transform_in->minlen ) );
+        return( MBEDTLS_ERR_SSL_INVALID_MAC );
+    }
+
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+    if( MBEDTLS_UNLIKELY( ssl->transform_in->f_decrypt == NULL ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
 
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, ssl->in_ctr, 8 );
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, ssl->in_hdr, 3 );
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, ssl->in_len, 2 );
-            mbedtls_md_hmac_update( &ssl->transform_in->md_ctx_dec, ssl->in_msg,
-                             ssl->in_msglen );
-            mbedtls_md_hmac_finish( &ssl->transform_in->md_ctx_dec,
-                             ssl->in_msg + ssl->in_msglen );
-            /* Call mbedtls_md_process at least once due to cache attacks */
-            for( j = 0; j < extra_run + 1; j++ )
-                mbedtls_md_process( &ssl->transform_in->md_ctx_dec, ssl->in_msg );
+    if( MBEDTLS_UNLIKELY( ( ret = ssl->transform_in->f_decrypt( ssl ) ) != 0 ) )
+        return( ret );
+#else /* MBEDTLS_SSL_RECORD_SPECIALIZE */
+    {
+        mbedtls_cipher_mode_t mode = mbedtls_cipher_get_cipher_mode(
+                                        &ssl->transform_in->cipher_ctx_dec );
 
-            mbedtls_md_hmac_reset( &ssl->transform_in->md_ctx_dec );
+#if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
+        if( mode == MBEDTLS_MODE_STREAM )
+            ret = ssl_decrypt_stream( ssl );
+        else
+#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
+#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C) || \
+    defined(MBEDTLS_CHACHAPOLY_C)
+        if( mode == MBEDTLS_MODE_GCM ||
+            mode == MBEDTLS_MODE_CCM ||
+            mode == MBEDTLS_MODE_CHACHAPOLY )
+            ret = ssl_decrypt_aead( ssl );
+        else
+#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C || MBEDTLS_CHACHAPOLY_C */
+#if defined(MBEDTLS_CIPHER_MODE_CBC) &&                                    \
+    ( defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) )
+        if( mode == MBEDTLS_MODE_CBC )
+        {
+            int etm = 0;
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+            etm = ( ssl->session_in->encrypt_then_mac ==
+                    MBEDTLS_SSL_ETM_ENABLED );
+#endif
+            ret = ssl_decrypt_cbc( ssl, etm );
         }
         else
-#endif /* MBEDTLS_SSL_PROTO_TLS1 || MBEDTLS_SSL_PROTO_TLS1_1 || \
-              MBEDTLS_SSL_PROTO_TLS1_2 */
+#endif /* MBEDTLS_CIPHER_MODE_CBC &&
+          ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
         {
             MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
             return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
         }
 
-        MBEDTLS_SSL_DEBUG_BUF( 4, "message  mac", tmp, ssl->transform_in->maclen );
-        MBEDTLS_SSL_DEBUG_BUF( 4, "computed mac", ssl->in_msg + ssl->in_msglen,
-                       ssl->transform_in->maclen );
-
-        if( mbedtls_ssl_safer_memcmp( tmp, ssl->in_msg + ssl->in_msglen,
-                         ssl->transform_in->maclen ) != 0 )
-        {
-#if defined(MBEDTLS_SSL_DEBUG_ALL)
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "message mac does not match" ) );
-#endif
-            correct = 0;
-        }
-        auth_done++;
-
-        /*
-         * Finally check the correct flag
-         */
-        if( correct == 0 )
-            return( MBEDTLS_ERR_SSL_INVALID_MAC );
-    }
-#endif /* SSL_SOME_MODES_USE_MAC */
-
-    /* Make extra sure authentication was performed, exactly once */
-    if( auth_done != 1 )
-    {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
-        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+        if( MBEDTLS_UNLIKELY( ret != 0 ) )
+            return( ret );
     }
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
 
     if( ssl->in_msglen == 0 )
     {
@@ -2050,6 +2574,75 @@ static int ssl_decrypt_buf( mbedtls_ssl_context *ssl )
     return( 0 );
 }
 
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+/*
+ * Bind the record processing functions matching the negotiated
+ * ciphersuite family to the transform, so that ssl_encrypt_buf() and
+ * ssl_decrypt_buf() dispatch with one indirect call instead of
+ * re-examining the cipher mode for every record.
+ */
+static int ssl_transform_set_record_funcs( mbedtls_ssl_context *ssl,
+                                           mbedtls_ssl_transform *transform )
+{
+    mbedtls_cipher_mode_t mode =
+        mbedtls_cipher_get_cipher_mode( &transform->cipher_ctx_enc );
+
+    ((void) ssl);
+
+    transform->f_encrypt = NULL;
+    transform->f_decrypt = NULL;
+
+#if defined(MBEDTLS_ARC4_C) || defined(MBEDTLS_CIPHER_NULL_CIPHER)
+    if( mode == MBEDTLS_MODE_STREAM )
+    {
+        transform->f_encrypt = ssl_encrypt_stream;
+        transform->f_decrypt = ssl_decrypt_stream;
+    }
+#endif /* MBEDTLS_ARC4_C || MBEDTLS_CIPHER_NULL_CIPHER */
+
+#if defined(MBEDTLS_GCM_C) || defined(MBEDTLS_CCM_C) || \
+    defined(MBEDTLS_CHACHAPOLY_C)
+    if( mode == MBEDTLS_MODE_GCM ||
+        mode == MBEDTLS_MODE_CCM ||
+        mode == MBEDTLS_MODE_CHACHAPOLY )
+    {
+        transform->f_encrypt = ssl_encrypt_aead;
+        transform->f_decrypt = ssl_decrypt_aead;
+    }
+#endif /* MBEDTLS_GCM_C || MBEDTLS_CCM_C || MBEDTLS_CHACHAPOLY_C */
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC) &&                                    \
+    ( defined(MBEDTLS_AES_C) || defined(MBEDTLS_CAMELLIA_C) )
+    if( mode == MBEDTLS_MODE_CBC )
+    {
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+        if( ssl->session_negotiate->encrypt_then_mac ==
+            MBEDTLS_SSL_ETM_ENABLED )
+        {
+            transform->f_encrypt = ssl_encrypt_cbc_etm;
+            transform->f_decrypt = ssl_decrypt_cbc_etm;
+        }
+        else
+#endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
+        {
+            transform->f_encrypt = ssl_encrypt_cbc_mte;
+            transform->f_decrypt = ssl_decrypt_cbc_mte;
+        }
+    }
+#endif /* MBEDTLS_CIPHER_MODE_CBC &&
+          ( MBEDTLS_AES_C || MBEDTLS_CAMELLIA_C ) */
+
+    if( transform->f_encrypt == NULL || transform->f_decrypt == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "no record processing functions "
+                                    "for the negotiated ciphersuite" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
+
 #undef MAC_NONE
 #undef MAC_PLAINTEXT
 #undef MAC_CIPHERTEXT
@@ -2124,63 +2717,402 @@ static int ssl_decompress_buf( mbedtls_ssl_context *ssl )
     MBEDTLS_SSL_DEBUG_BUF( 4, "before decompression: input payload",
                    ssl->in_msg, ssl->in_msglen );
 
-    ssl->transform_in->ctx_inflate.next_in = msg_pre;
-    ssl->transform_in->ctx_inflate.avail_in = len_pre;
-    ssl->transform_in->ctx_inflate.next_out = msg_post;
-    ssl->transform_in->ctx_inflate.avail_out = MBEDTLS_SSL_MAX_CONTENT_LEN;
+    ssl->transform_in->ctx_inflate.next_in = msg_pre;
+    ssl->transform_in->ctx_inflate.avail_in = len_pre;
+    ssl->transform_in->ctx_inflate.next_out = msg_post;
+    ssl->transform_in->ctx_inflate.avail_out = MBEDTLS_SSL_MAX_CONTENT_LEN;
+
+    ret = inflate( &ssl->transform_in->ctx_inflate, Z_SYNC_FLUSH );
+    if( ret != Z_OK )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "failed to perform decompression (%d)", ret ) );
+        return( MBEDTLS_ERR_SSL_COMPRESSION_FAILED );
+    }
+
+    ssl->in_msglen = MBEDTLS_SSL_MAX_CONTENT_LEN -
+                     ssl->transform_in->ctx_inflate.avail_out;
+
+    /* Decompression may write past the wire length of the record */
+    if( (size_t)( ssl->in_msg - ssl->in_buf ) + ssl->in_msglen >
+        ssl->in_buf_hwm )
+    {
+        ssl->in_buf_hwm = (size_t)( ssl->in_msg - ssl->in_buf ) +
+                          ssl->in_msglen;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "after decompression: msglen = %d, ",
+                   ssl->in_msglen ) );
+
+    MBEDTLS_SSL_DEBUG_BUF( 4, "after decompression: input payload",
+                   ssl->in_msg, ssl->in_msglen );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= decompress buf" ) );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_ZLIB_SUPPORT */
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_RENEGOTIATION)
+static int ssl_write_hello_request( mbedtls_ssl_context *ssl );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+static int ssl_resend_hello_request( mbedtls_ssl_context *ssl )
+{
+    /* If renegotiation is not enforced, retransmit until we would reach max
+     * timeout if we were using the usual handshake doubling scheme */
+    if( ssl->conf->renego_max_records < 0 )
+    {
+        uint32_t ratio = ssl->conf->hs_timeout_max / ssl->conf->hs_timeout_min + 1;
+        unsigned char doublings = 1;
+
+        while( ratio != 0 )
+        {
+            ++doublings;
+            ratio >>= 1;
+        }
+
+        if( ++ssl->renego_records_seen > doublings )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 2, ( "no longer retransmitting hello request" ) );
+            return( 0 );
+        }
+    }
+
+    return( ssl_write_hello_request( ssl ) );
+}
+#endif
+#endif /* MBEDTLS_SSL_SRV_C && MBEDTLS_SSL_RENEGOTIATION */
+
+/*
+ * Point the record pointers at a freshly (re)allocated I/O buffer
+ */
+static void ssl_reset_in_pointers( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        ssl->in_hdr = ssl->in_buf;
+        ssl->in_ctr = ssl->in_buf +  3;
+        ssl->in_len = ssl->in_buf + 11;
+    }
+    else
+#endif
+    {
+        ssl->in_ctr = ssl->in_buf;
+        ssl->in_hdr = ssl->in_buf +  8;
+        ssl->in_len = ssl->in_buf + 11;
+    }
+
+    ssl->in_iv  = ssl->in_buf + 13;
+    ssl->in_msg = ssl->in_buf + 13;
+    ssl->in_offt = NULL;
+}
+
+static void ssl_reset_out_pointers( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        ssl->out_hdr = ssl->out_buf;
+        ssl->out_ctr = ssl->out_buf +  3;
+        ssl->out_len = ssl->out_buf + 11;
+    }
+    else
+#endif
+    {
+        ssl->out_ctr = ssl->out_buf;
+        ssl->out_hdr = ssl->out_buf +  8;
+        ssl->out_len = ssl->out_buf + 11;
+    }
+
+    ssl->out_iv  = ssl->out_buf + 13;
+    ssl->out_msg = ssl->out_buf + 13;
+}
+
+/*
+ * Size the record buffers should have when (re)acquired or shrunk: the
+ * configured content size once the handshake is over, except with DTLS
+ * (we must be able to slurp a full datagram) and with compression (the
+ * (de)compression code assumes full-size buffers).
+ */
+static size_t ssl_in_buf_preferred_len( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( MBEDTLS_SSL_BUFFER_LEN );
+#endif
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    if( ssl->session != NULL &&
+        ssl->session->compression != MBEDTLS_SSL_COMPRESS_NULL )
+        return( MBEDTLS_SSL_BUFFER_LEN );
+#endif
+
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+        ssl->conf->in_content_len != 0 &&
+        ssl->conf->in_content_len < MBEDTLS_SSL_MAX_CONTENT_LEN )
+    {
+        return( ssl->conf->in_content_len + MBEDTLS_SSL_BUFFER_OVERHEAD );
+    }
+
+    return( MBEDTLS_SSL_BUFFER_LEN );
+}
+
+static size_t ssl_out_buf_preferred_len( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( MBEDTLS_SSL_BUFFER_LEN );
+#endif
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    if( ssl->session != NULL &&
+        ssl->session->compression != MBEDTLS_SSL_COMPRESS_NULL )
+        return( MBEDTLS_SSL_BUFFER_LEN );
+#endif
+
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+        ssl->conf->out_content_len != 0 &&
+        ssl->conf->out_content_len < MBEDTLS_SSL_MAX_CONTENT_LEN )
+    {
+        return( ssl->conf->out_content_len + MBEDTLS_SSL_BUFFER_OVERHEAD );
+    }
+
+    return( MBEDTLS_SSL_BUFFER_LEN );
+}
+
+/*
+ * (Re)allocate an I/O buffer released by mbedtls_ssl_release_buffers().
+ * With TLS the record counters live inside the buffers, so restore the
+ * values saved when the buffer was released.
+ */
+static int ssl_acquire_in_buf( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl->in_buf != NULL )
+        return( 0 );
+
+    if( ( ssl->in_buf = mbedtls_calloc( 1, len ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", len ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    ssl->in_buf_len = len;
+    ssl->in_buf_hwm = 0;
+    ssl_reset_in_pointers( ssl );
+    memcpy( ssl->in_ctr, ssl->saved_in_ctr, 8 );
+
+    /* Skip the explicit IV of the active transform, like
+     * mbedtls_ssl_parse_finished() does when it is set up */
+    if( ssl->transform_in != NULL &&
+        ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        ssl->in_msg = ssl->in_iv + ssl->transform_in->ivlen -
+                                   ssl->transform_in->fixed_ivlen;
+    }
+
+    return( 0 );
+}
+
+static int ssl_acquire_out_buf( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl->out_buf != NULL )
+        return( 0 );
+
+    if( ( ssl->out_buf = mbedtls_calloc( 1, len ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", len ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    ssl->out_buf_len = len;
+    ssl->out_buf_hwm = 0;
+    ssl_reset_out_pointers( ssl );
+    memcpy( ssl->out_ctr, ssl->saved_out_ctr, 8 );
+
+    /* Skip the explicit IV of the active transform, like
+     * mbedtls_ssl_write_finished() does when it is set up */
+    if( ssl->transform_out != NULL &&
+        ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        ssl->out_msg = ssl->out_iv + ssl->transform_out->ivlen -
+                                     ssl->transform_out->fixed_ivlen;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Resize an I/O buffer, preserving its content and fixing up the record
+ * pointers into it (see mbedtls_ssl_conf_buffer_sizes()).
+ * No-op if the buffer already has the requested size.
+ */
+static int ssl_resize_in_buf( mbedtls_ssl_context *ssl, size_t new_len )
+{
+    unsigned char *buf;
+    size_t copy_len;
+
+    if( new_len == ssl->in_buf_len )
+        return( 0 );
+
+    if( ( buf = mbedtls_calloc( 1, new_len ) ) == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    copy_len = ssl->in_buf_len < new_len ? ssl->in_buf_len : new_len;
+    memcpy( buf, ssl->in_buf, copy_len );
+
+    ssl->in_ctr = buf + ( ssl->in_ctr - ssl->in_buf );
+    ssl->in_hdr = buf + ( ssl->in_hdr - ssl->in_buf );
+    ssl->in_len = buf + ( ssl->in_len - ssl->in_buf );
+    ssl->in_iv  = buf + ( ssl->in_iv  - ssl->in_buf );
+    ssl->in_msg = buf + ( ssl->in_msg - ssl->in_buf );
+    if( ssl->in_offt != NULL )
+        ssl->in_offt = buf + ( ssl->in_offt - ssl->in_buf );
+
+    mbedtls_zeroize( ssl->in_buf, ssl->in_buf_len );
+    mbedtls_free( ssl->in_buf );
+
+    ssl->in_buf = buf;
+    ssl->in_buf_len = new_len;
+    if( ssl->in_buf_hwm > new_len )
+        ssl->in_buf_hwm = new_len;
+
+    return( 0 );
+}
+
+static int ssl_resize_out_buf( mbedtls_ssl_context *ssl, size_t new_len )
+{
+    unsigned char *buf;
+    size_t copy_len;
+
+    if( new_len == ssl->out_buf_len )
+        return( 0 );
 
-    ret = inflate( &ssl->transform_in->ctx_inflate, Z_SYNC_FLUSH );
-    if( ret != Z_OK )
-    {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "failed to perform decompression (%d)", ret ) );
-        return( MBEDTLS_ERR_SSL_COMPRESSION_FAILED );
-    }
+    if( ( buf = mbedtls_calloc( 1, new_len ) ) == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
 
-    ssl->in_msglen = MBEDTLS_SSL_MAX_CONTENT_LEN -
-                     ssl->transform_in->ctx_inflate.avail_out;
+    copy_len = ssl->out_buf_len < new_len ? ssl->out_buf_len : new_len;
+    memcpy( buf, ssl->out_buf, copy_len );
 
-    MBEDTLS_SSL_DEBUG_MSG( 3, ( "after decompression: msglen = %d, ",
-                   ssl->in_msglen ) );
+    ssl->out_ctr = buf + ( ssl->out_ctr - ssl->out_buf );
+    ssl->out_hdr = buf + ( ssl->out_hdr - ssl->out_buf );
+    ssl->out_len = buf + ( ssl->out_len - ssl->out_buf );
+    ssl->out_iv  = buf + ( ssl->out_iv  - ssl->out_buf );
+    ssl->out_msg = buf + ( ssl->out_msg - ssl->out_buf );
 
-    MBEDTLS_SSL_DEBUG_BUF( 4, "after decompression: input payload",
-                   ssl->in_msg, ssl->in_msglen );
+    mbedtls_zeroize( ssl->out_buf, ssl->out_buf_len );
+    mbedtls_free( ssl->out_buf );
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= decompress buf" ) );
+    ssl->out_buf = buf;
+    ssl->out_buf_len = new_len;
+    if( ssl->out_buf_hwm > new_len )
+        ssl->out_buf_hwm = new_len;
 
     return( 0 );
 }
-#endif /* MBEDTLS_ZLIB_SUPPORT */
-
-#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_RENEGOTIATION)
-static int ssl_write_hello_request( mbedtls_ssl_context *ssl );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
-static int ssl_resend_hello_request( mbedtls_ssl_context *ssl )
+/*
+ * Read one datagram using the batched receive callback.
+ *
+ * Deliver a datagram held over from a previous batch if there is one,
+ * otherwise read up to MBEDTLS_SSL_DGRAM_BATCH datagrams in one call:
+ * the first lands in the input buffer, the extra ones are held for
+ * subsequent calls so that draining a burst costs a single syscall.
+ *
+ * Returns the length of the datagram placed in ssl->in_hdr (like f_recv),
+ * or a negative error code.
+ */
+static int ssl_fetch_datagram_batch( mbedtls_ssl_context *ssl, size_t len )
 {
-    /* If renegotiation is not enforced, retransmit until we would reach max
-     * timeout if we were using the usual handshake doubling scheme */
-    if( ssl->conf->renego_max_records < 0 )
+    int ret;
+    size_t i, n;
+    unsigned char *bufs[MBEDTLS_SSL_DGRAM_BATCH];
+    size_t lens[MBEDTLS_SSL_DGRAM_BATCH];
+
+    if( ssl->dgram_held_count != 0 )
     {
-        uint32_t ratio = ssl->conf->hs_timeout_max / ssl->conf->hs_timeout_min + 1;
-        unsigned char doublings = 1;
+        size_t first = ssl->dgram_held_first;
+        size_t dgram_len = ssl->dgram_held_len[first];
 
-        while( ratio != 0 )
+        /* Emulate the truncation the kernel would have applied if the
+         * datagram had been read straight into the input buffer */
+        if( dgram_len > len )
+            dgram_len = len;
+
+        memcpy( ssl->in_hdr, ssl->dgram_held[first], dgram_len );
+
+        ssl->dgram_held_first = ( first + 1 ) %
+                                ( MBEDTLS_SSL_DGRAM_BATCH - 1 );
+        ssl->dgram_held_count--;
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "delivering held datagram, length %d",
+                                    (int) dgram_len ) );
+
+        return( (int) dgram_len );
+    }
+
+    /* Allocate storage for held datagrams on first use; on failure,
+     * degrade to reading a single datagram per call */
+    if( ssl->dgram_held[0] == NULL )
+    {
+        for( i = 0; i < MBEDTLS_SSL_DGRAM_BATCH - 1; i++ )
         {
-            ++doublings;
-            ratio >>= 1;
+            ssl->dgram_held[i] = mbedtls_calloc( 1, MBEDTLS_SSL_BUFFER_LEN );
+            if( ssl->dgram_held[i] == NULL )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed",
+                                            MBEDTLS_SSL_BUFFER_LEN ) );
+                while( i > 0 )
+                {
+                    mbedtls_free( ssl->dgram_held[--i] );
+                    ssl->dgram_held[i] = NULL;
+                }
+                break;
+            }
         }
+    }
 
-        if( ++ssl->renego_records_seen > doublings )
+    bufs[0] = ssl->in_hdr;
+    lens[0] = len;
+    n = 1;
+
+    if( ssl->dgram_held[0] != NULL )
+    {
+        for( i = 1; i < MBEDTLS_SSL_DGRAM_BATCH; i++ )
         {
-            MBEDTLS_SSL_DEBUG_MSG( 2, ( "no longer retransmitting hello request" ) );
-            return( 0 );
+            bufs[i] = ssl->dgram_held[i - 1];
+            lens[i] = MBEDTLS_SSL_BUFFER_LEN;
         }
+        n = MBEDTLS_SSL_DGRAM_BATCH;
     }
 
-    return( ssl_write_hello_request( ssl ) );
+    ret = ssl->f_recv_batch( ssl->p_bio, bufs, lens, n );
+
+    MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_recv_batch", ret );
+
+    if( ret <= 0 )
+        return( ret );
+
+    n = (size_t) ret;
+    if( n > MBEDTLS_SSL_DGRAM_BATCH )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "f_recv_batch returned more datagrams "
+                                    "than requested" ) );
+        return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+    }
+
+    for( i = 1; i < n; i++ )
+        ssl->dgram_held_len[i - 1] = lens[i];
+
+    ssl->dgram_held_first = 0;
+    ssl->dgram_held_count = (unsigned char)( n - 1 );
+
+    if( n > 1 )
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "batched read: %d datagrams, %d held",
+                                    (int) n, (int)( n - 1 ) ) );
+
+    return( (int) lens[0] );
 }
-#endif
-#endif /* MBEDTLS_SSL_SRV_C && MBEDTLS_SSL_RENEGOTIATION */
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
 
 /*
  * Fill the input message buffer by appending data to it.
@@ -2192,11 +3124,25 @@ static int ssl_resend_hello_request( mbedtls_ssl_context *ssl )
  *
  * With stream transport (TLS) on success ssl->in_left == nb_want, but
  * with datagram transport (DTLS) on success ssl->in_left >= nb_want,
- * since we always read a whole datagram at once.
+ * since we always read a whole datagram at once. With read-ahead enabled
+ * a stream may over-deliver too, so that several records arriving in one
+ * TCP segment cost a single receive call.
  *
- * For DTLS, it is up to the caller to set ssl->next_record_offset when
- * they're done reading a record.
+ * For DTLS and for streams with read-ahead, it is up to the caller to
+ * set ssl->next_record_offset when they're done reading a record.
+ */
+/*
+ * Track how far into the input buffer data has ever been written, so that
+ * mbedtls_ssl_session_reset() only needs to clear the used prefix
  */
+static void ssl_update_in_hwm( mbedtls_ssl_context *ssl )
+{
+    size_t used = (size_t)( ssl->in_hdr - ssl->in_buf ) + ssl->in_left;
+
+    if( used > ssl->in_buf_hwm )
+        ssl->in_buf_hwm = used;
+}
+
 int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
 {
     int ret;
@@ -2204,19 +3150,39 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> fetch input" ) );
 
-    if( ssl->f_recv == NULL && ssl->f_recv_timeout == NULL )
+    if( ssl->f_recv == NULL && ssl->f_recv_timeout == NULL
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        && ssl->f_recv_batch == NULL
+#endif
+      )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "Bad usage of mbedtls_ssl_set_bio() "
                             "or mbedtls_ssl_set_bio()" ) );
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
+    /* Re-acquire the input buffer if it was released while idle */
+    if( ssl->in_buf == NULL &&
+        ( ret = ssl_acquire_in_buf( ssl, ssl_in_buf_preferred_len( ssl ) ) ) != 0 )
+    {
+        return( ret );
+    }
+
     if( nb_want > MBEDTLS_SSL_BUFFER_LEN - (size_t)( ssl->in_hdr - ssl->in_buf ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "requesting more data than fits" ) );
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
+    /* Transparently grow a previously shrunk input buffer if the current
+     * record doesn't fit (see mbedtls_ssl_conf_buffer_sizes()) */
+    if( nb_want > ssl->in_buf_len - (size_t)( ssl->in_hdr - ssl->in_buf ) &&
+        ( ret = ssl_resize_in_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "failed to grow input buffer" ) );
+        return( ret );
+    }
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
     {
@@ -2294,7 +3260,7 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
             ret = MBEDTLS_ERR_SSL_TIMEOUT;
         else
         {
-            len = MBEDTLS_SSL_BUFFER_LEN - ( ssl->in_hdr - ssl->in_buf );
+            len = ssl->in_buf_len - ( ssl->in_hdr - ssl->in_buf );
 
             if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
                 timeout = ssl->handshake->retransmit_timeout;
@@ -2303,7 +3269,9 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
 
             MBEDTLS_SSL_DEBUG_MSG( 3, ( "f_recv_timeout: %u ms", timeout ) );
 
-            if( ssl->f_recv_timeout != NULL )
+            if( ssl->f_recv_batch != NULL )
+                ret = ssl_fetch_datagram_batch( ssl, len );
+            else if( ssl->f_recv_timeout != NULL )
                 ret = ssl->f_recv_timeout( ssl->p_bio, ssl->in_hdr, len,
                                                                     timeout );
             else
@@ -2355,16 +3323,47 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
             return( ret );
 
         ssl->in_left = ret;
+        ssl_update_in_hwm( ssl );
     }
     else
 #endif
     {
+        /*
+         * Discard the record just consumed; with read-ahead the surplus
+         * after it is kept and moved to the front of the buffer
+         */
+        if( ssl->next_record_offset != 0 )
+        {
+            if( ssl->in_left < ssl->next_record_offset )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
+                return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
+            }
+
+            ssl->in_left -= ssl->next_record_offset;
+
+            if( ssl->in_left != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 2, ( "next record in same segment, offset: %d",
+                                    ssl->next_record_offset ) );
+                memmove( ssl->in_hdr,
+                         ssl->in_hdr + ssl->next_record_offset,
+                         ssl->in_left );
+            }
+
+            ssl->next_record_offset = 0;
+        }
+
         MBEDTLS_SSL_DEBUG_MSG( 2, ( "in_left: %d, nb_want: %d",
                        ssl->in_left, nb_want ) );
 
         while( ssl->in_left < nb_want )
         {
-            len = nb_want - ssl->in_left;
+            if( ssl->conf->read_ahead )
+                len = ssl->in_buf_len - ( ssl->in_hdr - ssl->in_buf )
+                      - ssl->in_left;
+            else
+                len = nb_want - ssl->in_left;
 
             if( ssl_check_timer( ssl ) != 0 )
                 ret = MBEDTLS_ERR_SSL_TIMEOUT;
@@ -2394,6 +3393,7 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
                 return( ret );
 
             ssl->in_left += ret;
+            ssl_update_in_hwm( ssl );
         }
     }
 
@@ -2402,23 +3402,120 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
     return( 0 );
 }
 
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+/*
+ * Retire the output buffer so its unsent bytes can drain in the
+ * background: swap in the spare buffer, point out_drain at the bytes
+ * still to send, and rebase the record pointers so the next record is
+ * encrypted into the fresh buffer. Only for application data on a
+ * stream transport once the handshake is over - everything else relies
+ * on out_left describing the last record. Returns non-zero when the
+ * record cannot be stashed and the caller must report WANT_WRITE.
+ */
+static int ssl_out_stash( mbedtls_ssl_context *ssl )
+{
+    unsigned char *retired = ssl->out_buf;
+
+    /* Only one retired buffer at a time */
+    if( ssl->out_drain_len != 0 )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+#endif
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        ssl->out_msgtype != MBEDTLS_SSL_MSG_APPLICATION_DATA )
+        return( MBEDTLS_ERR_SSL_WANT_WRITE );
+
+    /* A spare of a different size is stale (the buffers were resized
+     * since it was retired): replace it */
+    if( ssl->out_spare != NULL && ssl->out_spare_len != ssl->out_buf_len )
+    {
+        mbedtls_zeroize( ssl->out_spare, ssl->out_spare_len );
+        mbedtls_free( ssl->out_spare );
+        ssl->out_spare = NULL;
+        ssl->out_spare_len = 0;
+    }
+
+    if( ssl->out_spare == NULL )
+    {
+        if( ( ssl->out_spare = mbedtls_calloc( 1, ssl->out_buf_len ) ) == NULL )
+            return( MBEDTLS_ERR_SSL_WANT_WRITE );
+        ssl->out_spare_len = ssl->out_buf_len;
+    }
+
+    /* Unsent bytes of the retired buffer; when records were held for
+     * coalescing the record pointers are already past them
+     * (see mbedtls_ssl_flush_output()) */
+    if( ssl->out_held != 0 )
+        ssl->out_drain = ssl->out_hdr - ssl->out_left;
+    else
+        ssl->out_drain = ssl->out_hdr + mbedtls_ssl_hdr_len( ssl ) +
+                         ssl->out_msglen - ssl->out_left;
+    ssl->out_drain_len = ssl->out_left;
+
+    /* With TLS the outgoing record counter lives in the buffer */
+    memcpy( ssl->out_spare, ssl->out_ctr, 8 );
+
+    ssl->out_buf = ssl->out_spare;
+    ssl->out_spare = retired;
+
+    ssl_reset_out_pointers( ssl );
+
+    if( ssl->transform_out != NULL &&
+        ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+    {
+        ssl->out_msg = ssl->out_iv + ssl->transform_out->ivlen -
+                                     ssl->transform_out->fixed_ivlen;
+    }
+
+    ssl->out_left = 0;
+    ssl->out_held = 0;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_OUT_DOUBLE_BUFFER */
+
 /*
  * Flush any data not yet written
  */
 int mbedtls_ssl_flush_output( mbedtls_ssl_context *ssl )
 {
     int ret;
-    unsigned char *buf, i;
+    unsigned char *buf;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> flush output" ) );
 
-    if( ssl->f_send == NULL )
+    if( ssl->f_send == NULL
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        && ssl->f_send_batch == NULL
+#endif
+      )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "Bad usage of mbedtls_ssl_set_bio() "
                             "or mbedtls_ssl_set_bio()" ) );
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    /* The retired buffer drains first: its records are older than
+     * anything in the active buffer */
+    while( ssl->out_drain_len > 0 )
+    {
+        ret = ssl->f_send( ssl->p_bio, ssl->out_drain, ssl->out_drain_len );
+
+        MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send (retired)", ret );
+
+        if( ret <= 0 )
+            return( ret );
+
+        ssl->out_drain += ret;
+        ssl->out_drain_len -= ret;
+    }
+#endif
+
     /* Avoid incrementing counter if data is flushed */
     if( ssl->out_left == 0 )
     {
@@ -2431,8 +3528,28 @@ int mbedtls_ssl_flush_output( mbedtls_ssl_context *ssl )
         MBEDTLS_SSL_DEBUG_MSG( 2, ( "message length: %d, out_left: %d",
                        mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen, ssl->out_left ) );
 
-        buf = ssl->out_hdr + mbedtls_ssl_hdr_len( ssl ) +
-              ssl->out_msglen - ssl->out_left;
+        /* While records are held back for coalescing the record pointers
+         * are past the pending data; otherwise they describe its last
+         * record */
+        if( ssl->out_held != 0 )
+            buf = ssl->out_hdr - ssl->out_left;
+        else
+            buf = ssl->out_hdr + mbedtls_ssl_hdr_len( ssl ) +
+                  ssl->out_msglen - ssl->out_left;
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        if( ssl->f_send == NULL )
+        {
+            /* Send the record as a single-datagram batch */
+            const unsigned char *batch_buf = buf;
+            size_t batch_len = ssl->out_left;
+
+            ret = ssl->f_send_batch( ssl->p_bio, &batch_buf, &batch_len, 1 );
+            if( ret > 0 )
+                ret = (int) batch_len;
+        }
+        else
+#endif
         ret = ssl->f_send( ssl->p_bio, buf, ssl->out_left );
 
         MBEDTLS_SSL_DEBUG_RET( 2, "ssl->f_send", ret );
@@ -2443,15 +3560,41 @@ int mbedtls_ssl_flush_output( mbedtls_ssl_context *ssl )
         ssl->out_left -= ret;
     }
 
-    for( i = 8; i > ssl_ep_len( ssl ); i-- )
-        if( ++ssl->out_ctr[i - 1] != 0 )
-            break;
+    ssl->out_held = 0;
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    /* With DTLS the counter is part of the datagram that was just sent;
+     * with TLS it was already updated when the record was made
+     * (see mbedtls_ssl_write_record()) */
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        unsigned char i;
+
+        for( i = 8; i > ssl_ep_len( ssl ); i-- )
+            if( ++ssl->out_ctr[i - 1] != 0 )
+                break;
 
-    /* The loop goes to its end iff the counter is wrapping */
-    if( i == ssl_ep_len( ssl ) )
+        /* The loop goes to its end iff the counter is wrapping */
+        if( i == ssl_ep_len( ssl ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "outgoing message counter would wrap" ) );
+            return( MBEDTLS_ERR_SSL_COUNTER_WRAPPING );
+        }
+    }
+    else
+#endif
+    /* If records were coalesced, the record pointers were moved past the
+     * held data: bring them back to the start of the buffer */
+    if( ssl->out_hdr != ssl->out_buf + 8 )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "outgoing message counter would wrap" ) );
-        return( MBEDTLS_ERR_SSL_COUNTER_WRAPPING );
+        ssl_reset_out_pointers( ssl );
+
+        if( ssl->transform_out != NULL &&
+            ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+        {
+            ssl->out_msg = ssl->out_iv + ssl->transform_out->ivlen -
+                                         ssl->transform_out->fixed_ivlen;
+        }
     }
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= flush output" ) );
@@ -2585,6 +3728,8 @@ static void ssl_swap_epochs( mbedtls_ssl_context *ssl )
  */
 int mbedtls_ssl_resend( mbedtls_ssl_context *ssl )
 {
+    unsigned int records_sent = 0;
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> mbedtls_ssl_resend" ) );
 
     if( ssl->handshake->retransmit_state != MBEDTLS_SSL_RETRANS_SENDING )
@@ -2595,6 +3740,12 @@ int mbedtls_ssl_resend( mbedtls_ssl_context *ssl )
         ssl_swap_epochs( ssl );
 
         ssl->handshake->retransmit_state = MBEDTLS_SSL_RETRANS_SENDING;
+
+#if defined(MBEDTLS_TIMING_C)
+        /* The reply may answer the original flight or this retransmission:
+         * don't take an RTT sample from it (Karn's algorithm) */
+        ssl->handshake->rtt_sample_open = 0;
+#endif
     }
 
     while( ssl->handshake->cur_msg != NULL )
@@ -2602,6 +3753,18 @@ int mbedtls_ssl_resend( mbedtls_ssl_context *ssl )
         int ret;
         mbedtls_ssl_flight_item *cur = ssl->handshake->cur_msg;
 
+        /* Pace large flights if a burst limit is configured: leave the
+         * remaining messages for a later call, they will be picked up
+         * since we stay in the SENDING state */
+        if( ssl->conf->hs_burst != 0 &&
+            records_sent >= ssl->conf->hs_burst )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 2, ( "burst limit reached (%u records), "
+                                        "pausing retransmission",
+                                        ssl->conf->hs_burst ) );
+            return( MBEDTLS_ERR_SSL_WANT_WRITE );
+        }
+
         /* Swap epochs before sending Finished: we can't do it after
          * sending ChangeCipherSpec, in case write returns WANT_READ.
          * Must be done before copying, may change out_msg pointer */
@@ -2624,6 +3787,8 @@ int mbedtls_ssl_resend( mbedtls_ssl_context *ssl )
             MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_write_record", ret );
             return( ret );
         }
+
+        records_sent++;
     }
 
     if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
@@ -2672,6 +3837,13 @@ void mbedtls_ssl_send_flight_completed( mbedtls_ssl_context *ssl )
     ssl_reset_retransmit_timeout( ssl );
     ssl_set_timer( ssl, ssl->handshake->retransmit_timeout );
 
+#if defined(MBEDTLS_TIMING_C)
+    /* Time this flight: the delay until the peer's reply gives an RTT
+     * sample, used to adapt the timeout for subsequent flights */
+    (void) mbedtls_timing_get_timer( &ssl->handshake->flight_sent_time, 1 );
+    ssl->handshake->rtt_sample_open = 1;
+#endif
+
     if( ssl->in_msgtype == MBEDTLS_SSL_MSG_HANDSHAKE &&
         ssl->in_msg[0] == MBEDTLS_SSL_HS_FINISHED )
     {
@@ -2690,6 +3862,112 @@ void mbedtls_ssl_send_flight_completed( mbedtls_ssl_context *ssl )
  * Write current record.
  * Uses ssl->out_msgtype, ssl->out_msglen and bytes at ssl->out_msg.
  */
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+/*
+ * Maximum number of handshake body bytes a single outgoing fragment may
+ * carry: bounded by the path MTU (when set) minus the record and handshake
+ * header overhead, and by the (negotiated) maximum fragment length.
+ */
+static size_t ssl_get_max_out_hs_frag( mbedtls_ssl_context *ssl )
+{
+    size_t max_len = MBEDTLS_SSL_MAX_CONTENT_LEN - 12;
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    size_t mfl = mfl_code_to_length[ssl->conf->mfl_code];
+
+    if( ssl->session_out != NULL &&
+        mfl_code_to_length[ssl->session_out->mfl_code] < mfl )
+    {
+        mfl = mfl_code_to_length[ssl->session_out->mfl_code];
+    }
+
+    if( mfl - 12 < max_len )
+        max_len = mfl - 12;
+#endif
+
+    if( ssl->mtu != 0 )
+    {
+        int expansion = mbedtls_ssl_get_record_expansion( ssl );
+
+        /* Refuse pathological MTUs instead of making no progress */
+        if( expansion >= 0 &&
+            (size_t) ssl->mtu > (size_t) expansion + 12 + 16 &&
+            (size_t) ssl->mtu - expansion - 12 < max_len )
+        {
+            max_len = (size_t) ssl->mtu - expansion - 12;
+        }
+    }
+
+    return( max_len );
+}
+
+/*
+ * Send the handshake message pending in out_msg (with its 12-byte DTLS
+ * handshake header already built) as a sequence of fragments of at most
+ * max_frag body bytes each, every one in its own record. The checksum and
+ * the flight backup always cover the unfragmented message, so resends go
+ * through here again and can re-fragment to a smaller MTU.
+ */
+static int ssl_write_hs_fragments( mbedtls_ssl_context *ssl, size_t max_frag )
+{
+    int ret = 0;
+    unsigned char hdr[12];
+    unsigned char *msg;
+    size_t msg_len = ssl->out_msglen - 12;
+    size_t frag_off = 0, frag_len;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> fragmenting handshake message "
+                                "(%d bytes into chunks of %d)",
+                                (int) msg_len, (int) max_frag ) );
+
+    memcpy( hdr, ssl->out_msg, 12 );
+
+    if( ( msg = mbedtls_calloc( 1, msg_len ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc %d bytes failed", (int) msg_len ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+    memcpy( msg, ssl->out_msg + 12, msg_len );
+
+    ssl->handshake->out_frag = 1;
+
+    while( frag_off < msg_len )
+    {
+        frag_len = msg_len - frag_off;
+        if( frag_len > max_frag )
+            frag_len = max_frag;
+
+        /* Same type, total length and message_seq in every fragment */
+        memcpy( ssl->out_msg, hdr, 6 );
+        ssl->out_msg[6]  = (unsigned char)( frag_off >> 16 );
+        ssl->out_msg[7]  = (unsigned char)( frag_off >>  8 );
+        ssl->out_msg[8]  = (unsigned char)( frag_off       );
+        ssl->out_msg[9]  = (unsigned char)( frag_len >> 16 );
+        ssl->out_msg[10] = (unsigned char)( frag_len >>  8 );
+        ssl->out_msg[11] = (unsigned char)( frag_len       );
+        memcpy( ssl->out_msg + 12, msg + frag_off, frag_len );
+
+        ssl->out_msglen = 12 + frag_len;
+        ssl->out_msgtype = MBEDTLS_SSL_MSG_HANDSHAKE;
+
+        if( ( ret = mbedtls_ssl_write_record( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_write_record", ret );
+            break;
+        }
+
+        frag_off += frag_len;
+    }
+
+    ssl->handshake->out_frag = 0;
+    mbedtls_free( msg );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= fragmenting handshake message" ) );
+
+    return( ret );
+}
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
 int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
 {
     int ret, done = 0;
@@ -2700,9 +3978,11 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
         ssl->handshake != NULL &&
-        ssl->handshake->retransmit_state == MBEDTLS_SSL_RETRANS_SENDING )
+        ( ssl->handshake->retransmit_state == MBEDTLS_SSL_RETRANS_SENDING ||
+          ssl->handshake->out_frag != 0 ) )
     {
-        ; /* Skip special handshake treatment when resending */
+        ; /* Skip special handshake treatment when resending, or when
+           * sending the fragments of a message already processed whole */
     }
     else
 #endif
@@ -2762,6 +4042,7 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
         ssl->handshake != NULL &&
         ssl->handshake->retransmit_state != MBEDTLS_SSL_RETRANS_SENDING &&
+        ssl->handshake->out_frag == 0 &&
         ( ssl->out_msgtype == MBEDTLS_SSL_MSG_CHANGE_CIPHER_SPEC ||
           ssl->out_msgtype == MBEDTLS_SSL_MSG_HANDSHAKE ) )
     {
@@ -2771,6 +4052,23 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
             return( ret );
         }
     }
+
+    /* Fragment handshake messages that would not fit the path MTU; done
+     * after the checksum and flight backup so both always see the whole
+     * message (resends re-fragment). ClientHello is never fragmented as
+     * our own (and many other) servers can't reassemble it while doing
+     * stateless cookie verification, see ssl_parse_client_hello() */
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
+        ssl->out_msgtype == MBEDTLS_SSL_MSG_HANDSHAKE &&
+        ssl->out_msg[0] != MBEDTLS_SSL_HS_CLIENT_HELLO &&
+        ssl->handshake != NULL &&
+        ssl->handshake->out_frag == 0 )
+    {
+        size_t max_frag = ssl_get_max_out_hs_frag( ssl );
+
+        if( ssl->out_msglen - 12 > max_frag )
+            return( ssl_write_hs_fragments( ssl, max_frag ) );
+    }
 #endif
 
 #if defined(MBEDTLS_ZLIB_SUPPORT)
@@ -2812,9 +4110,25 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
         ssl->out_len[0] = (unsigned char)( len >> 8 );
         ssl->out_len[1] = (unsigned char)( len      );
 
+#if defined(MBEDTLS_SSL_STATS)
+        /* Count the payload before encryption pads and MACs it */
+        ssl->stats.records_out++;
+        ssl->stats.bytes_out += len;
+#endif
+
         if( ssl->transform_out != NULL )
         {
-            if( ( ret = ssl_encrypt_buf( ssl ) ) != 0 )
+#if defined(MBEDTLS_TIMING_TRACE)
+            unsigned long trace_start = mbedtls_timing_hardclock();
+#endif
+            ret = ssl_encrypt_buf( ssl );
+
+#if defined(MBEDTLS_TIMING_TRACE)
+            mbedtls_timing_trace( MBEDTLS_TIMING_TRACE_SSL_ENCRYPT,
+                                  mbedtls_timing_hardclock() - trace_start );
+#endif
+
+            if( ret != 0 )
             {
                 MBEDTLS_SSL_DEBUG_RET( 1, "ssl_encrypt_buf", ret );
                 return( ret );
@@ -2825,7 +4139,21 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
             ssl->out_len[1] = (unsigned char)( len      );
         }
 
-        ssl->out_left = mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen;
+        /* Account for held records too: with coalescing enabled several
+         * complete records may be pending in the buffer */
+        if( ssl->out_held != 0 )
+            ssl->out_left += mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen;
+        else
+            ssl->out_left = mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen;
+
+        /* The record is in the buffer whether or not it gets flushed:
+         * update the high-water mark now (see mbedtls_ssl_session_reset()) */
+        if( (size_t)( ssl->out_hdr - ssl->out_buf ) +
+            mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen > ssl->out_buf_hwm )
+        {
+            ssl->out_buf_hwm = (size_t)( ssl->out_hdr - ssl->out_buf ) +
+                               mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen;
+        }
 
         MBEDTLS_SSL_DEBUG_MSG( 3, ( "output record: msgtype = %d, "
                             "version = [%d:%d], msglen = %d",
@@ -2836,8 +4164,82 @@ int mbedtls_ssl_write_record( mbedtls_ssl_context *ssl )
                        ssl->out_hdr, mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen );
     }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_STREAM )
+#endif
+    {
+        unsigned char i;
+
+        /* Count the record now: with TLS the counter is not part of the
+         * data on the wire, and several records may share one flush when
+         * coalescing. With DTLS it is updated after transmission instead
+         * (see mbedtls_ssl_flush_output()) */
+        for( i = 8; i > ssl_ep_len( ssl ); i-- )
+            if( ++ssl->out_ctr[i - 1] != 0 )
+                break;
+
+        /* The loop goes to its end iff the counter is wrapping */
+        if( i == ssl_ep_len( ssl ) )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "outgoing message counter would wrap" ) );
+            return( MBEDTLS_ERR_SSL_COUNTER_WRAPPING );
+        }
+    }
+
+    /* When coalescing, keep small application data records in the output
+     * buffer: move the record pointers past the pending bytes, and send
+     * everything in one go once enough has accumulated, on a record of
+     * another type, or on an explicit mbedtls_ssl_flush() */
+    if( !done &&
+        ssl->conf->out_coalesce != 0 &&
+        ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_STREAM &&
+        ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+        ssl->out_msgtype == MBEDTLS_SSL_MSG_APPLICATION_DATA &&
+        ssl->out_left < ssl->conf->out_coalesce &&
+        (size_t)( ssl->out_buf + ssl->out_buf_len - ssl->out_hdr ) >=
+            mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen +
+            (size_t) MBEDTLS_SSL_BUFFER_OVERHEAD )
+    {
+        ssl->out_hdr += mbedtls_ssl_hdr_len( ssl ) + ssl->out_msglen;
+        ssl->out_len  = ssl->out_hdr + 3;
+        ssl->out_iv   = ssl->out_hdr + 5;
+        ssl->out_msg  = ssl->out_iv;
+
+        if( ssl->transform_out != NULL &&
+            ssl->minor_ver >= MBEDTLS_SSL_MINOR_VERSION_2 )
+        {
+            ssl->out_msg = ssl->out_iv + ssl->transform_out->ivlen -
+                                         ssl->transform_out->fixed_ivlen;
+        }
+
+        ssl->out_held = ssl->out_left;
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "record held back for coalescing "
+                                    "(%d bytes pending)", ssl->out_left ) );
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write record" ) );
+
+        return( 0 );
+    }
+
+    ssl->out_held = 0;
+
     if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
     {
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+        /* The socket cannot take the record right now: retire the buffer
+         * so the bytes drain on later flushes while the next record is
+         * encrypted into the spare, and report the record as written */
+        if( ret == MBEDTLS_ERR_SSL_WANT_WRITE &&
+            ssl_out_stash( ssl ) == 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 2, ( "record queued on retired buffer "
+                                        "(%d bytes draining)",
+                                        ssl->out_drain_len ) );
+            MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write record" ) );
+
+            return( 0 );
+        }
+#endif
         MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
         return( ret );
     }
@@ -2948,12 +4350,29 @@ static int ssl_reassemble_dtls_handshake( mbedtls_ssl_context *ssl )
         /* The bitmask needs one bit per byte of message excluding header */
         alloc_len = 12 + msg_len + msg_len / 8 + ( msg_len % 8 != 0 );
 
-        ssl->handshake->hs_msg = mbedtls_calloc( 1, alloc_len );
-        if( ssl->handshake->hs_msg == NULL )
+        /*
+         * Reuse the arena of the previous fragmented message if it is
+         * big enough: certificate flights reassemble several messages
+         * in a row and this keeps the allocator out of the loop
+         */
+        if( ssl->handshake->hs_arena_len < alloc_len )
         {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc failed (%d bytes)", alloc_len ) );
-            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+            mbedtls_free( ssl->handshake->hs_arena );
+            ssl->handshake->hs_arena_len = 0;
+
+            ssl->handshake->hs_arena = mbedtls_calloc( 1, alloc_len );
+            if( ssl->handshake->hs_arena == NULL )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc failed (%d bytes)", alloc_len ) );
+                return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+            }
+
+            ssl->handshake->hs_arena_len = alloc_len;
         }
+        else
+            memset( ssl->handshake->hs_arena, 0, alloc_len );
+
+        ssl->handshake->hs_msg = ssl->handshake->hs_arena;
 
         /* Prepare final header: copy msg_type, length and message_seq,
          * then add standardised fragment_offset and fragment_length */
@@ -3055,7 +4474,7 @@ static int ssl_reassemble_dtls_handshake( mbedtls_ssl_context *ssl )
 
     memcpy( ssl->in_msg, ssl->handshake->hs_msg, ssl->in_hslen );
 
-    mbedtls_free( ssl->handshake->hs_msg );
+    /* Keep the arena for the next fragmented message */
     ssl->handshake->hs_msg = NULL;
 
     MBEDTLS_SSL_DEBUG_BUF( 3, "reassembled handshake message",
@@ -3065,6 +4484,36 @@ static int ssl_reassemble_dtls_handshake( mbedtls_ssl_context *ssl )
 }
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+/*
+ * Hold a complete handshake message that arrived ahead of sequence, so
+ * that a reordered datagram does not cost a retransmission timeout. On
+ * allocation failure the message is simply dropped, as before.
+ */
+static void ssl_buffer_future_dtls_msg( mbedtls_ssl_context *ssl,
+                                        unsigned int recv_msg_seq )
+{
+    size_t slot = recv_msg_seq % MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS;
+
+    if( ssl->handshake->future_msg[slot] != NULL )
+        return;
+
+    ssl->handshake->future_msg[slot] = mbedtls_calloc( 1, ssl->in_hslen );
+    if( ssl->handshake->future_msg[slot] == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "alloc failed, dropping future message" ) );
+        return;
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "holding future message, message_seq = %d, "
+                                "expected = %d", recv_msg_seq,
+                                ssl->handshake->in_msg_seq ) );
+
+    memcpy( ssl->handshake->future_msg[slot], ssl->in_msg, ssl->in_hslen );
+    ssl->handshake->future_msg_len[slot] = ssl->in_hslen;
+}
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
 static int ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
 {
     if( ssl->in_msglen < mbedtls_ssl_hs_hdr_len( ssl ) )
@@ -3110,6 +4559,17 @@ static int ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
                     return( ret );
                 }
             }
+            else if( recv_msg_seq > ssl->handshake->in_msg_seq &&
+                     recv_msg_seq - ssl->handshake->in_msg_seq <=
+                         MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS &&
+                     ssl->in_msglen >= ssl->in_hslen &&
+                     memcmp( ssl->in_msg + 6, "\0\0\0",        3 ) == 0 &&
+                     memcmp( ssl->in_msg + 9, ssl->in_msg + 1, 3 ) == 0 )
+            {
+                /* Complete unfragmented message from the near future:
+                 * keep it for when its turn comes */
+                ssl_buffer_future_dtls_msg( ssl, recv_msg_seq );
+            }
             else
             {
                 MBEDTLS_SSL_DEBUG_MSG( 2, ( "dropping out-of-sequence message: "
@@ -3120,6 +4580,18 @@ static int ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
 
             return( MBEDTLS_ERR_SSL_WANT_READ );
         }
+
+#if defined(MBEDTLS_TIMING_C)
+        /* First in-sequence message of the peer's reply: if our last
+         * flight is still being timed, take an RTT sample from it */
+        if( ssl->handshake != NULL &&
+            ssl->handshake->rtt_sample_open &&
+            ssl->handshake->retransmit_state == MBEDTLS_SSL_RETRANS_WAITING )
+        {
+            ssl_update_rtt_estimate( ssl );
+        }
+#endif
+
         /* Wait until message completion to increment in_msg_seq */
 
         /* Reassemble if current message is fragmented or reassembly is
@@ -3165,21 +4637,63 @@ static int ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
     return( 0 );
 }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+/*
+ * Deliver a held future handshake message whose turn has come, if any.
+ *
+ * Returns 1 if a message was loaded into ssl->in_msg and prepared, 0 if
+ * nothing is held for the current sequence number, or a negative error.
+ */
+static int ssl_load_buffered_dtls_msg( mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_handshake_params *hs = ssl->handshake;
+    size_t slot = hs->in_msg_seq % MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS;
+    int ret;
+
+    if( hs->future_msg[slot] == NULL )
+        return( 0 );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "delivering held message, message_seq = %d",
+                                hs->in_msg_seq ) );
+
+    memcpy( ssl->in_msg, hs->future_msg[slot], hs->future_msg_len[slot] );
+    ssl->in_msglen = hs->future_msg_len[slot];
+    ssl->in_msgtype = MBEDTLS_SSL_MSG_HANDSHAKE;
+
+    mbedtls_free( hs->future_msg[slot] );
+    hs->future_msg[slot] = NULL;
+    hs->future_msg_len[slot] = 0;
+
+    if( ( ret = ssl_prepare_handshake_record( ssl ) ) != 0 )
+        return( ret );
+
+    return( 1 );
+}
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
 /*
  * DTLS anti-replay: RFC 6347 4.1.2.6
  *
- * in_window is a field of bits numbered from 0 (lsb) to 63 (msb).
- * Bit n is set iff record number in_window_top - n has been seen.
+ * in_window is a ring bitmap covering the sequence numbers in
+ * ( in_window_top - MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE,
+ * in_window_top ]. Record number n is tracked by bit n % 64 of word
+ * ( n / 64 ) % ( number of words ): bits keep a fixed position as the
+ * window slides, so advancing the top only zeroes the words that newly
+ * enter the window instead of shifting the whole bitmap. One word more
+ * than the window size is kept (cf RFC 6479), so the word holding the
+ * oldest in-window bits is never among the zeroed ones.
  *
- * Usually, in_window_top is the last record number seen and the lsb of
- * in_window is set. The only exception is the initial state (record number 0
- * not seen yet).
+ * Usually, in_window_top is the last record number seen and its bit is
+ * set. The only exception is the initial state (record number 0 not
+ * seen yet).
  */
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
+#define SSL_REPLAY_WINDOW_WORDS ( MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE / 64 + 1 )
+
 static void ssl_dtls_replay_reset( mbedtls_ssl_context *ssl )
 {
     ssl->in_window_top = 0;
-    ssl->in_window = 0;
+    memset( ssl->in_window, 0, sizeof( ssl->in_window ) );
 }
 
 static inline uint64_t ssl_load_six_bytes( unsigned char *buf )
@@ -3198,7 +4712,7 @@ static inline uint64_t ssl_load_six_bytes( unsigned char *buf )
 int mbedtls_ssl_dtls_replay_check( mbedtls_ssl_context *ssl )
 {
     uint64_t rec_seqnum = ssl_load_six_bytes( ssl->in_ctr + 2 );
-    uint64_t bit;
+    uint64_t word;
 
     if( ssl->conf->anti_replay == MBEDTLS_SSL_ANTI_REPLAY_DISABLED )
         return( 0 );
@@ -3206,12 +4720,15 @@ int mbedtls_ssl_dtls_replay_check( mbedtls_ssl_context *ssl )
     if( rec_seqnum > ssl->in_window_top )
         return( 0 );
 
-    bit = ssl->in_window_top - rec_seqnum;
-
-    if( bit >= 64 )
+    if( ssl->in_window_top - rec_seqnum >=
+        MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE )
+    {
         return( -1 );
+    }
+
+    word = ( rec_seqnum >> 6 ) % SSL_REPLAY_WINDOW_WORDS;
 
-    if( ( ssl->in_window & ( (uint64_t) 1 << bit ) ) != 0 )
+    if( ( ssl->in_window[word] & ( (uint64_t) 1 << ( rec_seqnum & 63 ) ) ) != 0 )
         return( -1 );
 
     return( 0 );
@@ -3223,33 +4740,36 @@ int mbedtls_ssl_dtls_replay_check( mbedtls_ssl_context *ssl )
 void mbedtls_ssl_dtls_replay_update( mbedtls_ssl_context *ssl )
 {
     uint64_t rec_seqnum = ssl_load_six_bytes( ssl->in_ctr + 2 );
+    uint64_t word;
 
     if( ssl->conf->anti_replay == MBEDTLS_SSL_ANTI_REPLAY_DISABLED )
         return;
 
     if( rec_seqnum > ssl->in_window_top )
     {
-        /* Update window_top and the contents of the window */
-        uint64_t shift = rec_seqnum - ssl->in_window_top;
+        /* Zero the words sliding from the old side of the window to the
+         * new one; within a word the stale bits fall out of range by
+         * themselves */
+        uint64_t w_old = ssl->in_window_top >> 6;
+        uint64_t w_new = rec_seqnum >> 6;
 
-        if( shift >= 64 )
-            ssl->in_window = 1;
+        if( w_new - w_old >= SSL_REPLAY_WINDOW_WORDS )
+            memset( ssl->in_window, 0, sizeof( ssl->in_window ) );
         else
-        {
-            ssl->in_window <<= shift;
-            ssl->in_window |= 1;
-        }
+            while( w_old < w_new )
+                ssl->in_window[++w_old % SSL_REPLAY_WINDOW_WORDS] = 0;
 
         ssl->in_window_top = rec_seqnum;
     }
-    else
+    else if( ssl->in_window_top - rec_seqnum >=
+             MBEDTLS_SSL_DTLS_ANTI_REPLAY_WINDOW_SIZE )
     {
-        /* Mark that number as seen in the current window */
-        uint64_t bit = ssl->in_window_top - rec_seqnum;
-
-        if( bit < 64 ) /* Always true, but be extra sure */
-            ssl->in_window |= (uint64_t) 1 << bit;
+        /* Always outside the window here, but be extra sure */
+        return;
     }
+
+    word = ( rec_seqnum >> 6 ) % SSL_REPLAY_WINDOW_WORDS;
+    ssl->in_window[word] |= (uint64_t) 1 << ( rec_seqnum & 63 );
 }
 #endif /* MBEDTLS_SSL_DTLS_ANTI_REPLAY */
 
@@ -3284,6 +4804,14 @@ static int ssl_parse_record_header( mbedtls_ssl_context *ssl )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "unknown record type" ) );
 
+        /* With DTLS, drop silently: answering unauthenticated junk with a
+         * fatal alert would let anyone who can spoof a datagram kill the
+         * connection */
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+            return( MBEDTLS_ERR_SSL_INVALID_RECORD );
+#endif
+
         if( ( ret = mbedtls_ssl_send_alert_message( ssl,
                         MBEDTLS_SSL_ALERT_LEVEL_FATAL,
                         MBEDTLS_SSL_ALERT_MSG_UNEXPECTED_MESSAGE ) ) != 0 )
@@ -3516,6 +5044,23 @@ int mbedtls_ssl_read_record( mbedtls_ssl_context *ssl )
 
     ssl->in_hslen = 0;
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    /*
+     * Serve a held future handshake message before reading new records
+     */
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
+        ssl->handshake != NULL &&
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        if( ( ret = ssl_load_buffered_dtls_msg( ssl ) ) != 0 )
+        {
+            if( ret == 1 )
+                ret = 0;
+            return( ret );
+        }
+    }
+#endif
+
     /*
      * Read the record header and parse it
      */
@@ -3539,6 +5084,19 @@ read_record_header:
             ssl->next_record_offset = 0;
             ssl->in_left = 0;
 
+#if defined(MBEDTLS_SSL_STATS)
+            ssl->stats.records_dropped++;
+#endif
+
+#if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
+            if( ssl->conf->badhdr_limit != 0 &&
+                ++ssl->badhdr_seen >= ssl->conf->badhdr_limit )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "too many records with bad header" ) );
+                return( MBEDTLS_ERR_SSL_INVALID_RECORD );
+            }
+#endif
+
             MBEDTLS_SSL_DEBUG_MSG( 1, ( "discarding invalid record (header)" ) );
             goto read_record_header;
         }
@@ -3562,10 +5120,28 @@ read_record_header:
         ssl->next_record_offset = ssl->in_msglen + mbedtls_ssl_hdr_len( ssl );
     else
 #endif
+    if( ssl->conf->read_ahead )
+    {
+        ssl->next_record_offset = ssl->in_msglen + mbedtls_ssl_hdr_len( ssl );
+
+        /* Nothing read ahead past this record: consume it right away so
+         * an idle connection can still shrink or release its buffer */
+        if( ssl->next_record_offset == ssl->in_left )
+        {
+            ssl->next_record_offset = 0;
+            ssl->in_left = 0;
+        }
+    }
+    else
         ssl->in_left = 0;
 
     if( ( ret = ssl_prepare_record_content( ssl ) ) != 0 )
     {
+#if defined(MBEDTLS_SSL_STATS)
+        if( ret == MBEDTLS_ERR_SSL_INVALID_MAC )
+            ssl->stats.mac_failures++;
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
         if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
         {
@@ -3599,6 +5175,10 @@ read_record_header:
                 }
 #endif
 
+#if defined(MBEDTLS_SSL_STATS)
+                ssl->stats.records_dropped++;
+#endif
+
                 MBEDTLS_SSL_DEBUG_MSG( 1, ( "discarding invalid record (mac)" ) );
                 goto read_record_header;
             }
@@ -3621,6 +5201,11 @@ read_record_header:
         }
     }
 
+#if defined(MBEDTLS_SSL_STATS)
+    ssl->stats.records_in++;
+    ssl->stats.bytes_in += ssl->in_msglen;
+#endif
+
     /*
      * When we sent the last flight of the handshake, we MUST respond to a
      * retransmit of the peer's previous flight with a retransmit. (In
@@ -3720,6 +5305,13 @@ int mbedtls_ssl_send_alert_message( mbedtls_ssl_context *ssl,
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> send alert message" ) );
 
+    /* Re-acquire the output buffer if it was released while idle */
+    if( ssl->out_buf == NULL &&
+        ( ret = ssl_acquire_out_buf( ssl, ssl_out_buf_preferred_len( ssl ) ) ) != 0 )
+    {
+        return( ret );
+    }
+
     ssl->out_msgtype = MBEDTLS_SSL_MSG_ALERT;
     ssl->out_msglen = 2;
     ssl->out_msg[0] = level;
@@ -3789,6 +5381,7 @@ int mbedtls_ssl_write_certificate( mbedtls_ssl_context *ssl )
     int ret = MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
     size_t i, n;
     const mbedtls_x509_crt *crt;
+    const mbedtls_ssl_key_cert *key_cert;
     const mbedtls_ssl_ciphersuite_t *ciphersuite_info = ssl->transform_negotiate->ciphersuite_info;
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write certificate" ) );
@@ -3853,34 +5446,46 @@ int mbedtls_ssl_write_certificate( mbedtls_ssl_context *ssl )
      *     n  . n+2   length of cert. 2
      *    n+3 . ...   upper level cert, etc.
      */
-    i = 7;
-    crt = mbedtls_ssl_own_cert( ssl );
+    key_cert = mbedtls_ssl_own_key_cert( ssl );
 
-    while( crt != NULL )
+    if( key_cert != NULL && key_cert->cert_wire != NULL )
     {
-        n = crt->raw.len;
-        if( n > MBEDTLS_SSL_MAX_CONTENT_LEN - 3 - i )
+        /* Message serialized once when the pair was configured */
+        memcpy( ssl->out_msg, key_cert->cert_wire, key_cert->cert_wire_len );
+        i = key_cert->cert_wire_len;
+    }
+    else
+    {
+        i = 7;
+        crt = mbedtls_ssl_own_cert( ssl );
+
+        while( crt != NULL )
         {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "certificate too large, %d > %d",
-                           i + 3 + n, MBEDTLS_SSL_MAX_CONTENT_LEN ) );
-            return( MBEDTLS_ERR_SSL_CERTIFICATE_TOO_LARGE );
+            n = crt->raw.len;
+            if( n > MBEDTLS_SSL_MAX_CONTENT_LEN - 3 - i )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "certificate too large, %d > %d",
+                               i + 3 + n, MBEDTLS_SSL_MAX_CONTENT_LEN ) );
+                return( MBEDTLS_ERR_SSL_CERTIFICATE_TOO_LARGE );
+            }
+
+            ssl->out_msg[i    ] = (unsigned char)( n >> 16 );
+            ssl->out_msg[i + 1] = (unsigned char)( n >>  8 );
+            ssl->out_msg[i + 2] = (unsigned char)( n       );
+
+            i += 3; memcpy( ssl->out_msg + i, crt->raw.p, n );
+            i += n; crt = crt->next;
         }
 
-        ssl->out_msg[i    ] = (unsigned char)( n >> 16 );
-        ssl->out_msg[i + 1] = (unsigned char)( n >>  8 );
-        ssl->out_msg[i + 2] = (unsigned char)( n       );
+        ssl->out_msg[4]  = (unsigned char)( ( i - 7 ) >> 16 );
+        ssl->out_msg[5]  = (unsigned char)( ( i - 7 ) >>  8 );
+        ssl->out_msg[6]  = (unsigned char)( ( i - 7 )       );
 
-        i += 3; memcpy( ssl->out_msg + i, crt->raw.p, n );
-        i += n; crt = crt->next;
+        ssl->out_msg[0]  = MBEDTLS_SSL_HS_CERTIFICATE;
     }
 
-    ssl->out_msg[4]  = (unsigned char)( ( i - 7 ) >> 16 );
-    ssl->out_msg[5]  = (unsigned char)( ( i - 7 ) >>  8 );
-    ssl->out_msg[6]  = (unsigned char)( ( i - 7 )       );
-
     ssl->out_msglen  = i;
     ssl->out_msgtype = MBEDTLS_SSL_MSG_HANDSHAKE;
-    ssl->out_msg[0]  = MBEDTLS_SSL_HS_CERTIFICATE;
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3) && defined(MBEDTLS_SSL_CLI_C)
 write_msg:
@@ -4029,6 +5634,9 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
         mbedtls_x509_crt_free( ssl->session_negotiate->peer_cert );
         mbedtls_free( ssl->session_negotiate->peer_cert );
     }
+#if defined(MBEDTLS_SHA256_C)
+    ssl->session_negotiate->peer_cert_digest_set = 0;
+#endif
 
     if( ( ssl->session_negotiate->peer_cert = mbedtls_calloc( 1,
                     sizeof( mbedtls_x509_crt ) ) ) == NULL )
@@ -4060,6 +5668,13 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
             return( MBEDTLS_ERR_SSL_BAD_HS_CERTIFICATE );
         }
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+        if( ssl->conf->crt_cache != NULL )
+            ret = mbedtls_x509_crt_cache_parse_der( ssl->conf->crt_cache,
+                                      ssl->session_negotiate->peer_cert,
+                                      ssl->in_msg + i, n );
+        else
+#endif
         ret = mbedtls_x509_crt_parse_der( ssl->session_negotiate->peer_cert,
                                   ssl->in_msg + i, n );
         if( ret != 0 )
@@ -4081,19 +5696,41 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT &&
         ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_IN_PROGRESS )
     {
-        if( ssl->session->peer_cert == NULL )
+        if( ssl->session->peer_cert != NULL )
         {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "new server cert during renegotiation" ) );
-            return( MBEDTLS_ERR_SSL_BAD_HS_CERTIFICATE );
+            if( ssl->session->peer_cert->raw.len !=
+                ssl->session_negotiate->peer_cert->raw.len ||
+                memcmp( ssl->session->peer_cert->raw.p,
+                        ssl->session_negotiate->peer_cert->raw.p,
+                        ssl->session->peer_cert->raw.len ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "server cert changed during renegotiation" ) );
+                return( MBEDTLS_ERR_SSL_BAD_HS_CERTIFICATE );
+            }
         }
+#if defined(MBEDTLS_SHA256_C)
+        else if( ssl->session->peer_cert_digest_set != 0 )
+        {
+            unsigned char digest[MBEDTLS_SSL_PEER_CERT_DIGEST_LEN];
 
-        if( ssl->session->peer_cert->raw.len !=
-            ssl->session_negotiate->peer_cert->raw.len ||
-            memcmp( ssl->session->peer_cert->raw.p,
-                    ssl->session_negotiate->peer_cert->raw.p,
-                    ssl->session->peer_cert->raw.len ) != 0 )
+            mbedtls_sha256( ssl->session_negotiate->peer_cert->raw.p,
+                            ssl->session_negotiate->peer_cert->raw.len,
+                            digest, 0 );
+
+            if( memcmp( digest, ssl->session->peer_cert_digest,
+                        sizeof( digest ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 1, ( "server cert changed during renegotiation" ) );
+                return( MBEDTLS_ERR_SSL_BAD_HS_CERTIFICATE );
+            }
+        }
+#endif /* MBEDTLS_SHA256_C */
+        else
         {
-            MBEDTLS_SSL_DEBUG_MSG( 1, ( "server cert changed during renegotiation" ) );
+            /* Covers both a server that didn't send a certificate in the
+             * initial handshake, and a retention policy that kept nothing
+             * to compare against */
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "new server cert during renegotiation" ) );
             return( MBEDTLS_ERR_SSL_BAD_HS_CERTIFICATE );
         }
     }
@@ -4103,6 +5740,12 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
     {
         mbedtls_x509_crt *ca_chain;
         mbedtls_x509_crl *ca_crl;
+#if defined(MBEDTLS_X509_TRUST_C)
+        const mbedtls_x509_trust *ca_trust = NULL;
+#endif
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+        const void *vrfy_authority;
+#endif
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
         if( ssl->handshake->sni_ca_chain != NULL )
@@ -4115,17 +5758,69 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
         {
             ca_chain = ssl->conf->ca_chain;
             ca_crl   = ssl->conf->ca_crl;
+#if defined(MBEDTLS_X509_TRUST_C)
+            ca_trust = ssl->conf->ca_trust;
+#endif
         }
 
-        if( ca_chain == NULL )
+        if( ca_chain == NULL
+#if defined(MBEDTLS_X509_TRUST_C)
+            && ca_trust == NULL
+#endif
+          )
         {
             MBEDTLS_SSL_DEBUG_MSG( 1, ( "got no CA chain" ) );
             return( MBEDTLS_ERR_SSL_CA_CHAIN_REQUIRED );
         }
 
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+        vrfy_authority = ca_chain;
+#if defined(MBEDTLS_X509_TRUST_C)
+        if( ca_trust != NULL )
+            vrfy_authority = ca_trust;
+#endif
+#endif /* MBEDTLS_X509_VERIFY_CACHE_C */
+
         /*
          * Main check: verify certificate
          */
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+        /* Results may only be memoized without a verification callback,
+         * since a cache hit would skip the callback */
+        if( ssl->conf->vrfy_cache != NULL && ssl->conf->f_vrfy == NULL &&
+            mbedtls_x509_verify_cache_lookup( ssl->conf->vrfy_cache,
+                                ssl->session_negotiate->peer_cert,
+                                ssl->hostname, vrfy_authority,
+                                ssl->conf->cert_profile, &ret,
+                               &ssl->session_negotiate->verify_result ) == 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "peer chain verification served from cache" ) );
+        }
+        else
+#endif /* MBEDTLS_X509_VERIFY_CACHE_C */
+        {
+#if defined(MBEDTLS_X509_TRUST_C)
+        if( ca_trust != NULL )
+            ret = mbedtls_x509_crt_verify_trust(
+                                ssl->session_negotiate->peer_cert,
+                                ca_trust, ca_crl,
+                                ssl->conf->cert_profile,
+                                ssl->hostname,
+                               &ssl->session_negotiate->verify_result,
+                                ssl->conf->f_vrfy, ssl->conf->p_vrfy );
+        else
+#endif
+        /* The pipelined variant runs no per-certificate callback, so it
+         * is only a valid substitute when none is configured */
+        if( ssl->conf->vrfy_executor != NULL && ssl->conf->f_vrfy == NULL )
+            ret = mbedtls_x509_crt_verify_pipelined(
+                                ssl->session_negotiate->peer_cert,
+                                ca_chain, ca_crl,
+                                ssl->conf->cert_profile,
+                                ssl->hostname,
+                               &ssl->session_negotiate->verify_result,
+                                ssl->conf->vrfy_executor );
+        else
         ret = mbedtls_x509_crt_verify_with_profile(
                                 ssl->session_negotiate->peer_cert,
                                 ca_chain, ca_crl,
@@ -4134,6 +5829,16 @@ int mbedtls_ssl_parse_certificate( mbedtls_ssl_context *ssl )
                                &ssl->session_negotiate->verify_result,
                                 ssl->conf->f_vrfy, ssl->conf->p_vrfy );
 
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+        if( ssl->conf->vrfy_cache != NULL && ssl->conf->f_vrfy == NULL )
+            mbedtls_x509_verify_cache_store( ssl->conf->vrfy_cache,
+                                ssl->session_negotiate->peer_cert,
+                                ssl->hostname, vrfy_authority,
+                                ssl->conf->cert_profile, ret,
+                                ssl->session_negotiate->verify_result );
+#endif
+        }
+
         if( ret != 0 )
         {
             MBEDTLS_SSL_DEBUG_RET( 1, "x509_verify_cert", ret );
@@ -4508,7 +6213,7 @@ static void ssl_calc_finished_tls(
     mbedtls_md5_finish(  &md5, padbuf );
     mbedtls_sha1_finish( &sha1, padbuf + 16 );
 
-    ssl->handshake->tls_prf( session->master, 48, sender,
+    ssl->handshake->tls_prf( session, session->master, 48, sender,
                              padbuf, 36, buf, len );
 
     MBEDTLS_SSL_DEBUG_BUF( 3, "calc finished result", buf, len );
@@ -4559,7 +6264,7 @@ static void ssl_calc_finished_tls_sha256(
 
     mbedtls_sha256_finish( &sha256, padbuf );
 
-    ssl->handshake->tls_prf( session->master, 48, sender,
+    ssl->handshake->tls_prf( session, session->master, 48, sender,
                              padbuf, 32, buf, len );
 
     MBEDTLS_SSL_DEBUG_BUF( 3, "calc finished result", buf, len );
@@ -4581,46 +6286,174 @@ static void ssl_calc_finished_tls_sha384(
     mbedtls_sha512_context sha512;
     unsigned char padbuf[48];
 
-    mbedtls_ssl_session *session = ssl->session_negotiate;
-    if( !session )
-        session = ssl->session;
+    mbedtls_ssl_session *session = ssl->session_negotiate;
+    if( !session )
+        session = ssl->session;
+
+    mbedtls_sha512_init( &sha512 );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> calc  finished tls sha384" ) );
+
+    mbedtls_sha512_clone( &sha512, &ssl->handshake->fin_sha512 );
+
+    /*
+     * TLSv1.2:
+     *   hash = PRF( master, finished_label,
+     *               Hash( handshake ) )[0.11]
+     */
+
+#if !defined(MBEDTLS_SHA512_ALT)
+    MBEDTLS_SSL_DEBUG_BUF( 4, "finished sha512 state", (unsigned char *)
+                   sha512.state, sizeof( sha512.state ) );
+#endif
+
+    sender = ( from == MBEDTLS_SSL_IS_CLIENT )
+             ? "client finished"
+             : "server finished";
+
+    mbedtls_sha512_finish( &sha512, padbuf );
+
+    ssl->handshake->tls_prf( session, session->master, 48, sender,
+                             padbuf, 48, buf, len );
+
+    MBEDTLS_SSL_DEBUG_BUF( 3, "calc finished result", buf, len );
+
+    mbedtls_sha512_free( &sha512 );
+
+    mbedtls_zeroize(  padbuf, sizeof( padbuf ) );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= calc  finished" ) );
+}
+#endif /* MBEDTLS_SHA512_C */
+#endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
+
+/*
+ * Per-handshake substructures are acquired and released through these
+ * helpers; with MBEDTLS_SSL_HANDSHAKE_POOL and a pool attached to the
+ * config they become freelist operations, otherwise they are the plain
+ * allocator calls. A structure must have been cleaned out by its matching
+ * mbedtls_ssl_*_free() before it is released, just as before freeing.
+ */
+#define SSL_POOL_HANDSHAKE  0
+#define SSL_POOL_TRANSFORM  1
+#define SSL_POOL_SESSION    2
+
+static const size_t ssl_pool_sizes[3] =
+{
+    sizeof( mbedtls_ssl_handshake_params ),
+    sizeof( mbedtls_ssl_transform ),
+    sizeof( mbedtls_ssl_session )
+};
+
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+static void *ssl_pool_acquire( const mbedtls_ssl_config *conf, int type )
+{
+    void *blk = NULL;
+    mbedtls_ssl_handshake_pool *pool = conf->hs_pool;
+
+    if( pool != NULL )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        if( mbedtls_mutex_lock( &pool->mutex ) == 0 )
+        {
+#endif
+            blk = pool->free_list[type];
+            if( blk != NULL )
+                pool->free_list[type] = *(void **) blk;
+#if defined(MBEDTLS_THREADING_C)
+            mbedtls_mutex_unlock( &pool->mutex );
+        }
+#endif
+    }
+
+    if( blk != NULL )
+        memset( blk, 0, ssl_pool_sizes[type] );
+    else
+        blk = mbedtls_calloc( 1, ssl_pool_sizes[type] );
 
-    mbedtls_sha512_init( &sha512 );
+    return( blk );
+}
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> calc  finished tls sha384" ) );
+static void ssl_pool_release( const mbedtls_ssl_config *conf, int type,
+                              void *blk )
+{
+    mbedtls_ssl_handshake_pool *pool = conf != NULL ? conf->hs_pool : NULL;
 
-    mbedtls_sha512_clone( &sha512, &ssl->handshake->fin_sha512 );
+    if( blk == NULL )
+        return;
 
-    /*
-     * TLSv1.2:
-     *   hash = PRF( master, finished_label,
-     *               Hash( handshake ) )[0.11]
-     */
+    if( pool == NULL )
+    {
+        mbedtls_free( blk );
+        return;
+    }
 
-#if !defined(MBEDTLS_SHA512_ALT)
-    MBEDTLS_SSL_DEBUG_BUF( 4, "finished sha512 state", (unsigned char *)
-                   sha512.state, sizeof( sha512.state ) );
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+    {
+        mbedtls_free( blk );
+        return;
+    }
 #endif
 
-    sender = ( from == MBEDTLS_SSL_IS_CLIENT )
-             ? "client finished"
-             : "server finished";
+    *(void **) blk = pool->free_list[type];
+    pool->free_list[type] = blk;
 
-    mbedtls_sha512_finish( &sha512, padbuf );
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_unlock( &pool->mutex );
+#endif
+}
+#else /* MBEDTLS_SSL_HANDSHAKE_POOL */
+static void *ssl_pool_acquire( const mbedtls_ssl_config *conf, int type )
+{
+    ((void) conf);
 
-    ssl->handshake->tls_prf( session->master, 48, sender,
-                             padbuf, 48, buf, len );
+    return( mbedtls_calloc( 1, ssl_pool_sizes[type] ) );
+}
 
-    MBEDTLS_SSL_DEBUG_BUF( 3, "calc finished result", buf, len );
+static void ssl_pool_release( const mbedtls_ssl_config *conf, int type,
+                              void *blk )
+{
+    ((void) conf);
+    ((void) type);
 
-    mbedtls_sha512_free( &sha512 );
+    mbedtls_free( blk );
+}
+#endif /* MBEDTLS_SSL_HANDSHAKE_POOL */
 
-    mbedtls_zeroize(  padbuf, sizeof( padbuf ) );
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+/*
+ * Retire a transform: keep the structure and its cipher contexts for reuse
+ * by the next handshake on this SSL context instead of freeing them. The
+ * cipher contexts keep their last key schedule until they are rekeyed by
+ * mbedtls_ssl_derive_keys(); everything else is cleared here.
+ */
+static void ssl_transform_retire( mbedtls_ssl_context *ssl,
+                                  mbedtls_ssl_transform *transform )
+{
+    mbedtls_cipher_context_t cipher_enc, cipher_dec;
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= calc  finished" ) );
+    if( ssl->transform_pool != NULL )
+    {
+        mbedtls_ssl_transform_free( transform );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM, transform );
+        return;
+    }
+
+    cipher_enc = transform->cipher_ctx_enc;
+    cipher_dec = transform->cipher_ctx_dec;
+
+    mbedtls_cipher_init( &transform->cipher_ctx_enc );
+    mbedtls_cipher_init( &transform->cipher_ctx_dec );
+
+    mbedtls_ssl_transform_free( transform );
+
+    transform->cipher_ctx_enc = cipher_enc;
+    transform->cipher_ctx_dec = cipher_dec;
+
+    ssl->transform_pool = transform;
 }
-#endif /* MBEDTLS_SHA512_C */
-#endif /* MBEDTLS_SSL_PROTO_TLS1_2 */
+#endif /* MBEDTLS_SSL_TRANSFORM_POOL */
 
 static void ssl_handshake_wrapup_free_hs_transform( mbedtls_ssl_context *ssl )
 {
@@ -4630,7 +6463,7 @@ static void ssl_handshake_wrapup_free_hs_transform( mbedtls_ssl_context *ssl )
      * Free our handshake params
      */
     mbedtls_ssl_handshake_free( ssl->handshake );
-    mbedtls_free( ssl->handshake );
+    ssl_pool_release( ssl->conf, SSL_POOL_HANDSHAKE, ssl->handshake );
     ssl->handshake = NULL;
 
     /*
@@ -4638,8 +6471,12 @@ static void ssl_handshake_wrapup_free_hs_transform( mbedtls_ssl_context *ssl )
      */
     if( ssl->transform )
     {
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+        ssl_transform_retire( ssl, ssl->transform );
+#else
         mbedtls_ssl_transform_free( ssl->transform );
-        mbedtls_free( ssl->transform );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM, ssl->transform );
+#endif
     }
     ssl->transform = ssl->transform_negotiate;
     ssl->transform_negotiate = NULL;
@@ -4653,14 +6490,61 @@ void mbedtls_ssl_handshake_wrapup( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "=> handshake wrapup" ) );
 
+#if defined(MBEDTLS_SSL_STATS)
+    ssl->stats.handshakes++;
+    if( resume != 0 )
+        ssl->stats.resumptions++;
+#endif
+
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     if( ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_IN_PROGRESS )
     {
         ssl->renego_status =  MBEDTLS_SSL_RENEGOTIATION_DONE;
         ssl->renego_records_seen = 0;
     }
+    ssl->rekey = 0;
 #endif
 
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    /*
+     * The peer's public key is no longer needed; apply the certificate
+     * retention policy before the session gets copied into the cache.
+     * The retained chain is only ever read back through
+     * mbedtls_ssl_get_peer_cert() and the renegotiation cert-change
+     * check, so most deployments can keep much less than all of it.
+     */
+    if( ssl->session_negotiate->peer_cert != NULL &&
+        ssl->conf->cert_retain != MBEDTLS_SSL_CERT_RETAIN_FULL )
+    {
+        mbedtls_x509_crt *peer_cert = ssl->session_negotiate->peer_cert;
+
+        if( ssl->conf->cert_retain == MBEDTLS_SSL_CERT_RETAIN_LEAF )
+        {
+            if( peer_cert->next != NULL )
+            {
+                mbedtls_x509_crt_free( peer_cert->next );
+                mbedtls_free( peer_cert->next );
+                peer_cert->next = NULL;
+            }
+        }
+        else
+        {
+#if defined(MBEDTLS_SHA256_C)
+            if( ssl->conf->cert_retain == MBEDTLS_SSL_CERT_RETAIN_DIGEST )
+            {
+                mbedtls_sha256( peer_cert->raw.p, peer_cert->raw.len,
+                                ssl->session_negotiate->peer_cert_digest, 0 );
+                ssl->session_negotiate->peer_cert_digest_set = 1;
+            }
+#endif /* MBEDTLS_SHA256_C */
+
+            mbedtls_x509_crt_free( peer_cert );
+            mbedtls_free( peer_cert );
+            ssl->session_negotiate->peer_cert = NULL;
+        }
+    }
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
     /*
      * Free the previous session and switch in the current one
      */
@@ -4673,7 +6557,7 @@ void mbedtls_ssl_handshake_wrapup( mbedtls_ssl_context *ssl )
 #endif
 
         mbedtls_ssl_session_free( ssl->session );
-        mbedtls_free( ssl->session );
+        ssl_pool_release( ssl->conf, SSL_POOL_SESSION, ssl->session );
     }
     ssl->session = ssl->session_negotiate;
     ssl->session_negotiate = NULL;
@@ -4706,6 +6590,16 @@ void mbedtls_ssl_handshake_wrapup( mbedtls_ssl_context *ssl )
 
     ssl->state++;
 
+    /*
+     * Shrink the I/O buffers to the configured content sizes, if any.
+     * Failure to shrink is not an error: we just keep the larger buffer.
+     */
+    if( ssl->in_left == 0 && ssl->in_offt == NULL && ssl->record_read == 0 )
+        (void) ssl_resize_in_buf( ssl, ssl_in_buf_preferred_len( ssl ) );
+
+    if( ssl->out_left == 0 )
+        (void) ssl_resize_out_buf( ssl, ssl_out_buf_preferred_len( ssl ) );
+
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "<= handshake wrapup" ) );
 }
 
@@ -4940,10 +6834,23 @@ static void ssl_handshake_params_init( mbedtls_ssl_handshake_params *handshake )
 
 static void ssl_transform_init( mbedtls_ssl_transform *transform )
 {
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+    /* A transform taken from the pool still owns its cipher contexts;
+     * carry them across the memset so mbedtls_cipher_setup() can reuse
+     * them. On a freshly allocated transform these are all-zero. */
+    mbedtls_cipher_context_t cipher_enc = transform->cipher_ctx_enc;
+    mbedtls_cipher_context_t cipher_dec = transform->cipher_ctx_dec;
+#endif
+
     memset( transform, 0, sizeof(mbedtls_ssl_transform) );
 
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+    transform->cipher_ctx_enc = cipher_enc;
+    transform->cipher_ctx_dec = cipher_dec;
+#else
     mbedtls_cipher_init( &transform->cipher_ctx_enc );
     mbedtls_cipher_init( &transform->cipher_ctx_dec );
+#endif
 
     mbedtls_md_init( &transform->md_ctx_enc );
     mbedtls_md_init( &transform->md_ctx_dec );
@@ -4954,9 +6861,42 @@ void mbedtls_ssl_session_init( mbedtls_ssl_session *session )
     memset( session, 0, sizeof(mbedtls_ssl_session) );
 }
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+/*
+ * If an asynchronous private key operation is outstanding, tell its owner
+ * that its result will never be collected
+ */
+static void ssl_async_cancel( mbedtls_ssl_context *ssl )
+{
+    if( ssl->handshake != NULL &&
+        ssl->handshake->async_in_progress != MBEDTLS_SSL_ASYNC_OP_NONE )
+    {
+        if( ssl->conf != NULL && ssl->conf->f_async_cancel != NULL )
+            ssl->conf->f_async_cancel( ssl );
+
+        ssl->handshake->async_in_progress = MBEDTLS_SSL_ASYNC_OP_NONE;
+    }
+}
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
 static int ssl_handshake_init( mbedtls_ssl_context *ssl )
 {
+    /* The handshake assumes full-size I/O buffers: re-acquire them if they
+     * were released while idle, and grow them back if they were shrunk
+     * after a previous handshake (see mbedtls_ssl_conf_buffer_sizes()) */
+    if( ssl_acquire_in_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) != 0 ||
+        ssl_acquire_out_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) != 0 ||
+        ssl_resize_in_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) != 0 ||
+        ssl_resize_out_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc() of full-size I/O buffers failed" ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
     /* Clear old handshake information if present */
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+    ssl_async_cancel( ssl );
+#endif
     if( ssl->transform_negotiate )
         mbedtls_ssl_transform_free( ssl->transform_negotiate );
     if( ssl->session_negotiate )
@@ -4970,17 +6910,27 @@ static int ssl_handshake_init( mbedtls_ssl_context *ssl )
      */
     if( ssl->transform_negotiate == NULL )
     {
-        ssl->transform_negotiate = mbedtls_calloc( 1, sizeof(mbedtls_ssl_transform) );
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+        if( ssl->transform_pool != NULL )
+        {
+            ssl->transform_negotiate = ssl->transform_pool;
+            ssl->transform_pool = NULL;
+        }
+        else
+#endif
+        ssl->transform_negotiate = ssl_pool_acquire( ssl->conf,
+                                                     SSL_POOL_TRANSFORM );
     }
 
     if( ssl->session_negotiate == NULL )
     {
-        ssl->session_negotiate = mbedtls_calloc( 1, sizeof(mbedtls_ssl_session) );
+        ssl->session_negotiate = ssl_pool_acquire( ssl->conf,
+                                                   SSL_POOL_SESSION );
     }
 
     if( ssl->handshake == NULL )
     {
-        ssl->handshake = mbedtls_calloc( 1, sizeof(mbedtls_ssl_handshake_params) );
+        ssl->handshake = ssl_pool_acquire( ssl->conf, SSL_POOL_HANDSHAKE );
     }
 
     /* All pointers should exist and can be directly freed without issue */
@@ -4990,9 +6940,11 @@ static int ssl_handshake_init( mbedtls_ssl_context *ssl )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc() of ssl sub-contexts failed" ) );
 
-        mbedtls_free( ssl->handshake );
-        mbedtls_free( ssl->transform_negotiate );
-        mbedtls_free( ssl->session_negotiate );
+        ssl_pool_release( ssl->conf, SSL_POOL_HANDSHAKE, ssl->handshake );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM,
+                          ssl->transform_negotiate );
+        ssl_pool_release( ssl->conf, SSL_POOL_SESSION,
+                          ssl->session_negotiate );
 
         ssl->handshake = NULL;
         ssl->transform_negotiate = NULL;
@@ -5068,56 +7020,32 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
 {
     int ret;
     const size_t len = MBEDTLS_SSL_BUFFER_LEN;
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    int prev_tag = mbedtls_memory_buffer_set_tag( MBEDTLS_MEMORY_TAG_SSL );
+#endif
 
     ssl->conf = conf;
 
     /*
      * Prepare base structures
      */
-    if( ( ssl-> in_buf = mbedtls_calloc( 1, len ) ) == NULL ||
-        ( ssl->out_buf = mbedtls_calloc( 1, len ) ) == NULL )
+    if( ssl_acquire_in_buf( ssl, len ) != 0 ||
+        ssl_acquire_out_buf( ssl, len ) != 0 )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", len ) );
         mbedtls_free( ssl->in_buf );
         ssl->in_buf = NULL;
-        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+        goto exit;
     }
 
-#if defined(MBEDTLS_SSL_PROTO_DTLS)
-    if( conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
-    {
-        ssl->out_hdr = ssl->out_buf;
-        ssl->out_ctr = ssl->out_buf +  3;
-        ssl->out_len = ssl->out_buf + 11;
-        ssl->out_iv  = ssl->out_buf + 13;
-        ssl->out_msg = ssl->out_buf + 13;
+    ret = ssl_handshake_init( ssl );
 
-        ssl->in_hdr = ssl->in_buf;
-        ssl->in_ctr = ssl->in_buf +  3;
-        ssl->in_len = ssl->in_buf + 11;
-        ssl->in_iv  = ssl->in_buf + 13;
-        ssl->in_msg = ssl->in_buf + 13;
-    }
-    else
+exit:
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    (void) mbedtls_memory_buffer_set_tag( prev_tag );
 #endif
-    {
-        ssl->out_ctr = ssl->out_buf;
-        ssl->out_hdr = ssl->out_buf +  8;
-        ssl->out_len = ssl->out_buf + 11;
-        ssl->out_iv  = ssl->out_buf + 13;
-        ssl->out_msg = ssl->out_buf + 13;
-
-        ssl->in_ctr = ssl->in_buf;
-        ssl->in_hdr = ssl->in_buf +  8;
-        ssl->in_len = ssl->in_buf + 11;
-        ssl->in_iv  = ssl->in_buf + 13;
-        ssl->in_msg = ssl->in_buf + 13;
-    }
-
-    if( ( ret = ssl_handshake_init( ssl ) ) != 0 )
-        return( ret );
 
-    return( 0 );
+    return( ret );
 }
 
 /*
@@ -5130,12 +7058,20 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
 
     ssl->state = MBEDTLS_SSL_HELLO_REQUEST;
 
+    /* Re-acquire the I/O buffers if they were released while idle */
+    if( ( ret = ssl_acquire_in_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) ) != 0 ||
+        ( ret = ssl_acquire_out_buf( ssl, MBEDTLS_SSL_BUFFER_LEN ) ) != 0 )
+    {
+        return( ret );
+    }
+
     /* Cancel any possibly running timer */
     ssl_set_timer( ssl, 0 );
 
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     ssl->renego_status = MBEDTLS_SSL_INITIAL_HANDSHAKE;
     ssl->renego_records_seen = 0;
+    ssl->rekey = 0;
 
     ssl->verify_data_len = 0;
     memset( ssl->own_verify_data, 0, MBEDTLS_SSL_VERIFY_DATA_MAX_LEN );
@@ -5149,9 +7085,13 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
     ssl->in_msgtype = 0;
     ssl->in_msglen = 0;
     ssl->in_left = 0;
-#if defined(MBEDTLS_SSL_PROTO_DTLS)
     ssl->next_record_offset = 0;
+    ssl->pending_fatal = 0;
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
     ssl->in_epoch = 0;
+    /* Drop datagrams held over from a batched read (keep their storage) */
+    ssl->dgram_held_first = 0;
+    ssl->dgram_held_count = 0;
 #endif
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
     ssl_dtls_replay_reset( ssl );
@@ -5161,10 +7101,17 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
     ssl->nb_zero = 0;
     ssl->record_read = 0;
 
-    ssl->out_msg = ssl->out_buf + 13;
+    ssl_reset_out_pointers( ssl );
     ssl->out_msgtype = 0;
     ssl->out_msglen = 0;
     ssl->out_left = 0;
+    ssl->out_held = 0;
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    ssl->out_drain = NULL;
+    ssl->out_drain_len = 0;
+#endif
+    ssl->dyn_rec_cur = 0;
+    ssl->dyn_rec_sent = 0;
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     if( ssl->split_done != MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED )
         ssl->split_done = 0;
@@ -5173,8 +7120,19 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
     ssl->transform_in = NULL;
     ssl->transform_out = NULL;
 
-    memset( ssl->out_buf, 0, MBEDTLS_SSL_BUFFER_LEN );
-    memset( ssl->in_buf, 0, MBEDTLS_SSL_BUFFER_LEN );
+    /* Only clear the used prefix of each buffer: with full-size 16KB
+     * buffers and mostly small records, clearing it all is measurable
+     * on servers that cycle one context through many clients. The first
+     * 13 bytes hold the record counter, which may have been restored
+     * there without going through the record layer, so always clear them */
+    memset( ssl->out_buf, 0,
+            ssl->out_buf_hwm > 13 ? ssl->out_buf_hwm : 13 );
+    memset( ssl->in_buf, 0,
+            ssl->in_buf_hwm > 13 ? ssl->in_buf_hwm : 13 );
+    ssl->out_buf_hwm = 0;
+    ssl->in_buf_hwm = 0;
+    memset( ssl->saved_out_ctr, 0, 8 );
+    memset( ssl->saved_in_ctr, 0, 8 );
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
     if( mbedtls_ssl_hw_record_reset != NULL )
@@ -5190,15 +7148,19 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
 
     if( ssl->transform )
     {
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+        ssl_transform_retire( ssl, ssl->transform );
+#else
         mbedtls_ssl_transform_free( ssl->transform );
-        mbedtls_free( ssl->transform );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM, ssl->transform );
+#endif
         ssl->transform = NULL;
     }
 
     if( ssl->session )
     {
         mbedtls_ssl_session_free( ssl->session );
-        mbedtls_free( ssl->session );
+        ssl_pool_release( ssl->conf, SSL_POOL_SESSION, ssl->session );
         ssl->session = NULL;
     }
 
@@ -5229,6 +7191,7 @@ void mbedtls_ssl_conf_endpoint( mbedtls_ssl_config *conf, int endpoint )
 void mbedtls_ssl_conf_transport( mbedtls_ssl_config *conf, int transport )
 {
     conf->transport = transport;
+    ssl_conf_update_suite_gates( conf );
 }
 
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
@@ -5243,6 +7206,11 @@ void mbedtls_ssl_conf_dtls_badmac_limit( mbedtls_ssl_config *conf, unsigned limi
 {
     conf->badmac_limit = limit;
 }
+
+void mbedtls_ssl_conf_dtls_badhdr_limit( mbedtls_ssl_config *conf, unsigned limit )
+{
+    conf->badhdr_limit = limit;
+}
 #endif
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -5251,6 +7219,11 @@ void mbedtls_ssl_conf_handshake_timeout( mbedtls_ssl_config *conf, uint32_t min,
     conf->hs_timeout_min = min;
     conf->hs_timeout_max = max;
 }
+
+void mbedtls_ssl_conf_handshake_burst( mbedtls_ssl_config *conf, unsigned int burst )
+{
+    conf->hs_burst = burst;
+}
 #endif
 
 void mbedtls_ssl_conf_authmode( mbedtls_ssl_config *conf, int authmode )
@@ -5296,11 +7269,41 @@ void mbedtls_ssl_set_bio( mbedtls_ssl_context *ssl,
     ssl->f_recv_timeout = f_recv_timeout;
 }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+void mbedtls_ssl_set_bio_batch( mbedtls_ssl_context *ssl,
+        void *p_bio,
+        int (*f_send_batch)(void *, const unsigned char **, const size_t *,
+                            size_t),
+        int (*f_recv_batch)(void *, unsigned char **, size_t *, size_t) )
+{
+    ssl->p_bio        = p_bio;
+    ssl->f_send_batch = f_send_batch;
+    ssl->f_recv_batch = f_recv_batch;
+}
+
+void mbedtls_ssl_set_mtu( mbedtls_ssl_context *ssl, uint16_t mtu )
+{
+    ssl->mtu = mtu;
+}
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+
 void mbedtls_ssl_conf_read_timeout( mbedtls_ssl_config *conf, uint32_t timeout )
 {
     conf->read_timeout   = timeout;
 }
 
+void mbedtls_ssl_conf_read_ahead( mbedtls_ssl_config *conf, int enable )
+{
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    /* Decompression expands records in place and would overwrite data
+     * read ahead of the current record */
+    ( (void) enable );
+    conf->read_ahead = MBEDTLS_SSL_READ_AHEAD_DISABLED;
+#else
+    conf->read_ahead = enable;
+#endif
+}
+
 void mbedtls_ssl_set_timer_cb( mbedtls_ssl_context *ssl,
                                void *p_timer,
                                void (*f_set_timer)(void *, uint32_t int_ms, uint32_t fin_ms),
@@ -5326,6 +7329,85 @@ void mbedtls_ssl_conf_session_cache( mbedtls_ssl_config *conf,
 }
 #endif /* MBEDTLS_SSL_SRV_C */
 
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+void mbedtls_ssl_ecdh_reuse_init( mbedtls_ssl_ecdh_reuse_context *ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_ssl_ecdh_reuse_context ) );
+
+    ctx->grp_id = MBEDTLS_ECP_DP_NONE;
+    mbedtls_mpi_init( &ctx->d );
+    mbedtls_ecp_point_init( &ctx->Q );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &ctx->mutex );
+#endif
+}
+
+void mbedtls_ssl_ecdh_reuse_free( mbedtls_ssl_ecdh_reuse_context *ctx )
+{
+    mbedtls_mpi_free( &ctx->d );
+    mbedtls_ecp_point_free( &ctx->Q );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &ctx->mutex );
+#endif
+
+    memset( ctx, 0, sizeof( mbedtls_ssl_ecdh_reuse_context ) );
+}
+
+void mbedtls_ssl_conf_ecdh_reuse( mbedtls_ssl_config *conf,
+                                  mbedtls_ssl_ecdh_reuse_context *ctx,
+                                  int max_uses, uint32_t max_age )
+{
+    ctx->max_uses = max_uses;
+#if defined(MBEDTLS_HAVE_TIME)
+    ctx->max_age = max_age;
+#else
+    ((void) max_age);
+#endif
+
+    conf->ecdh_reuse = ctx;
+}
+#endif /* MBEDTLS_SSL_ECDH_REUSE */
+
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+void mbedtls_ssl_handshake_pool_init( mbedtls_ssl_handshake_pool *pool )
+{
+    memset( pool, 0, sizeof( mbedtls_ssl_handshake_pool ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &pool->mutex );
+#endif
+}
+
+void mbedtls_ssl_handshake_pool_free( mbedtls_ssl_handshake_pool *pool )
+{
+    void *blk, *next;
+    int i;
+
+    for( i = 0; i < 3; i++ )
+    {
+        for( blk = pool->free_list[i]; blk != NULL; blk = next )
+        {
+            next = *(void **) blk;
+            mbedtls_free( blk );
+        }
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &pool->mutex );
+#endif
+
+    memset( pool, 0, sizeof( mbedtls_ssl_handshake_pool ) );
+}
+
+void mbedtls_ssl_conf_handshake_pool( mbedtls_ssl_config *conf,
+                                      mbedtls_ssl_handshake_pool *pool )
+{
+    conf->hs_pool = pool;
+}
+#endif /* MBEDTLS_SSL_HANDSHAKE_POOL */
+
 #if defined(MBEDTLS_SSL_CLI_C)
 int mbedtls_ssl_set_session( mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session )
 {
@@ -5339,35 +7421,206 @@ int mbedtls_ssl_set_session( mbedtls_ssl_context *ssl, const mbedtls_ssl_session
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
-    if( ( ret = ssl_session_copy( ssl->session_negotiate, session ) ) != 0 )
-        return( ret );
+    if( ( ret = mbedtls_ssl_session_copy( ssl->session_negotiate, session ) ) != 0 )
+        return( ret );
+
+    ssl->handshake->resume = 1;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_CLI_C */
+
+/*
+ * Resolve a 0-terminated list of ciphersuite ids into an index-aligned
+ * array of definition pointers, so that per-connection suite handling
+ * does not have to scan the whole definitions table for each id again.
+ * Unknown ids resolve to NULL entries. Returns NULL on allocation
+ * failure, in which case the users fall back to looking ids up with
+ * mbedtls_ssl_ciphersuite_from_id().
+ */
+static const mbedtls_ssl_ciphersuite_t **ssl_resolve_ciphersuites(
+                                                const int *ciphersuites )
+{
+    const mbedtls_ssl_ciphersuite_t **info;
+    size_t i, count;
+
+    for( count = 0; ciphersuites[count] != 0; count++ )
+        ;
+
+    info = mbedtls_calloc( count + 1, sizeof( *info ) );
+    if( info == NULL )
+        return( NULL );
+
+    for( i = 0; i < count; i++ )
+        info[i] = mbedtls_ssl_ciphersuite_from_id( ciphersuites[i] );
+
+    return( info );
+}
+
+/*
+ * Free the resolved lists; distinct versions may share one array
+ */
+static void ssl_conf_free_ciphersuite_info( mbedtls_ssl_config *conf )
+{
+    int i, j;
+
+    for( i = 0; i < 4; i++ )
+    {
+        for( j = 0; j < i; j++ )
+            if( conf->ciphersuite_info_list[j] ==
+                conf->ciphersuite_info_list[i] )
+                break;
+
+        if( j == i )
+            mbedtls_free( conf->ciphersuite_info_list[i] );
+    }
+
+    for( i = 0; i < 4; i++ )
+    {
+        conf->ciphersuite_info_list[i] = NULL;
+
+        mbedtls_free( conf->ciphersuite_gate[i] );
+        conf->ciphersuite_gate[i] = NULL;
+    }
+}
+
+/*
+ * Acceptance flags of one suite at one protocol version under the
+ * current configuration. Unknown ids (NULL info) stay accepted so that
+ * the selection loop still reports them as the internal error it
+ * always did.
+ */
+static unsigned char ssl_suite_gate( const mbedtls_ssl_config *conf,
+                                     const mbedtls_ssl_ciphersuite_t *suite,
+                                     int minor )
+{
+    unsigned char gate = MBEDTLS_SSL_SUITE_GATE_VALID |
+                         MBEDTLS_SSL_SUITE_GATE_ACCEPT;
+
+    if( suite == NULL )
+        return( gate );
+
+    if( suite->min_minor_ver > minor || suite->max_minor_ver < minor )
+        gate &= ~MBEDTLS_SSL_SUITE_GATE_ACCEPT;
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
+        ( suite->flags & MBEDTLS_CIPHERSUITE_NODTLS ) )
+        gate &= ~MBEDTLS_SSL_SUITE_GATE_ACCEPT;
+#endif
+
+#if defined(MBEDTLS_ARC4_C)
+    if( conf->arc4_disabled == MBEDTLS_SSL_ARC4_DISABLED &&
+        suite->cipher == MBEDTLS_CIPHER_ARC4_128 )
+        gate &= ~MBEDTLS_SSL_SUITE_GATE_ACCEPT;
+#endif
+
+#if defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED)
+    if( mbedtls_ssl_ciphersuite_uses_psk( suite ) &&
+        conf->f_psk == NULL &&
+        ( conf->psk == NULL || conf->psk_identity == NULL ||
+          conf->psk_identity_len == 0 || conf->psk_len == 0 ) )
+        gate &= ~MBEDTLS_SSL_SUITE_GATE_ACCEPT;
+#endif
+
+#if defined(MBEDTLS_ECDH_C) || defined(MBEDTLS_ECDSA_C)
+    if( mbedtls_ssl_ciphersuite_uses_ec( suite ) )
+        gate |= MBEDTLS_SSL_SUITE_GATE_USES_EC;
+#endif
+
+    return( gate );
+}
+
+/*
+ * Re-resolve, for each protocol version, which suites of the configured
+ * list can ever be accepted under the configuration-static predicates
+ * (version window, DTLS, RC4 policy, PSK availability), so ClientHello
+ * processing tests one flag byte per suite instead of re-running the
+ * predicates. Called from every setter that changes an input of these
+ * predicates; on allocation failure the servers fall back to the full
+ * per-suite checks.
+ */
+static void ssl_conf_update_suite_gates( mbedtls_ssl_config *conf )
+{
+    int minor;
+    size_t i, count;
+
+    for( minor = 0; minor < 4; minor++ )
+    {
+        const int *list = conf->ciphersuite_list[minor];
+        const mbedtls_ssl_ciphersuite_t **info =
+            conf->ciphersuite_info_list[minor];
+        unsigned char *gate;
+
+        mbedtls_free( conf->ciphersuite_gate[minor] );
+        conf->ciphersuite_gate[minor] = NULL;
 
-    ssl->handshake->resume = 1;
+        if( list == NULL || info == NULL )
+            continue;
 
-    return( 0 );
+        for( count = 0; list[count] != 0; count++ )
+            ;
+
+        gate = mbedtls_calloc( count + 1, 1 );
+        if( gate == NULL )
+            continue;
+
+        for( i = 0; i < count; i++ )
+            gate[i] = ssl_suite_gate( conf, info[i], minor );
+
+        conf->ciphersuite_gate[minor] = gate;
+    }
 }
-#endif /* MBEDTLS_SSL_CLI_C */
 
 void mbedtls_ssl_conf_ciphersuites( mbedtls_ssl_config *conf,
                                    const int *ciphersuites )
 {
+    const mbedtls_ssl_ciphersuite_t **info;
+
+    ssl_conf_free_ciphersuite_info( conf );
+    info = ssl_resolve_ciphersuites( ciphersuites );
+
     conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_0] = ciphersuites;
     conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_1] = ciphersuites;
     conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_2] = ciphersuites;
     conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_3] = ciphersuites;
+
+    conf->ciphersuite_info_list[MBEDTLS_SSL_MINOR_VERSION_0] = info;
+    conf->ciphersuite_info_list[MBEDTLS_SSL_MINOR_VERSION_1] = info;
+    conf->ciphersuite_info_list[MBEDTLS_SSL_MINOR_VERSION_2] = info;
+    conf->ciphersuite_info_list[MBEDTLS_SSL_MINOR_VERSION_3] = info;
+
+    ssl_conf_update_suite_gates( conf );
 }
 
 void mbedtls_ssl_conf_ciphersuites_for_version( mbedtls_ssl_config *conf,
                                        const int *ciphersuites,
                                        int major, int minor )
 {
+    int i;
+
     if( major != MBEDTLS_SSL_MAJOR_VERSION_3 )
         return;
 
     if( minor < MBEDTLS_SSL_MINOR_VERSION_0 || minor > MBEDTLS_SSL_MINOR_VERSION_3 )
         return;
 
+    if( conf->ciphersuite_info_list[minor] != NULL )
+    {
+        for( i = 0; i < 4; i++ )
+            if( i != minor && conf->ciphersuite_info_list[i] ==
+                              conf->ciphersuite_info_list[minor] )
+                break;
+
+        if( i == 4 )
+            mbedtls_free( conf->ciphersuite_info_list[minor] );
+    }
+
     conf->ciphersuite_list[minor] = ciphersuites;
+    conf->ciphersuite_info_list[minor] =
+        ssl_resolve_ciphersuites( ciphersuites );
+
+    ssl_conf_update_suite_gates( conf );
 }
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
@@ -5377,6 +7630,11 @@ void mbedtls_ssl_conf_cert_profile( mbedtls_ssl_config *conf,
     conf->cert_profile = profile;
 }
 
+void mbedtls_ssl_conf_cert_retention( mbedtls_ssl_config *conf, int retain )
+{
+    conf->cert_retain = retain;
+}
+
 /* Append a new keycert entry to a (possibly empty) list */
 static int ssl_append_key_cert( mbedtls_ssl_key_cert **head,
                                 mbedtls_x509_crt *cert,
@@ -5408,11 +7666,76 @@ static int ssl_append_key_cert( mbedtls_ssl_key_cert **head,
     return( 0 );
 }
 
+/*
+ * Serialize the Certificate handshake message for a keycert entry, so
+ * writing it later is a single copy instead of a walk over the chain.
+ * The handshake length in bytes 1..3 is filled in by the record layer.
+ * A chain too large for the output buffer is left unserialized; the
+ * fallback path in mbedtls_ssl_write_certificate() reports it.
+ */
+static int ssl_key_cert_serialize( mbedtls_ssl_key_cert *key_cert )
+{
+    size_t i, n;
+    unsigned char *p;
+    const mbedtls_x509_crt *crt;
+
+    i = 7;
+    for( crt = key_cert->cert; crt != NULL; crt = crt->next )
+    {
+        if( crt->raw.len > MBEDTLS_SSL_MAX_CONTENT_LEN - 3 - i )
+            return( 0 );
+
+        i += 3 + crt->raw.len;
+    }
+
+    p = mbedtls_calloc( 1, i );
+    if( p == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    p[0] = MBEDTLS_SSL_HS_CERTIFICATE;
+    p[4] = (unsigned char)( ( i - 7 ) >> 16 );
+    p[5] = (unsigned char)( ( i - 7 ) >>  8 );
+    p[6] = (unsigned char)( ( i - 7 )       );
+
+    i = 7;
+    for( crt = key_cert->cert; crt != NULL; crt = crt->next )
+    {
+        n = crt->raw.len;
+
+        p[i    ] = (unsigned char)( n >> 16 );
+        p[i + 1] = (unsigned char)( n >>  8 );
+        p[i + 2] = (unsigned char)( n       );
+
+        i += 3; memcpy( p + i, crt->raw.p, n );
+        i += n;
+    }
+
+    key_cert->cert_wire = p;
+    key_cert->cert_wire_len = i;
+
+    return( 0 );
+}
+
 int mbedtls_ssl_conf_own_cert( mbedtls_ssl_config *conf,
                               mbedtls_x509_crt *own_cert,
                               mbedtls_pk_context *pk_key )
 {
-    return( ssl_append_key_cert( &conf->key_cert, own_cert, pk_key ) );
+    int ret;
+    mbedtls_ssl_key_cert *cur;
+
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ( ret = ssl_append_key_cert( &conf->key_cert, own_cert, pk_key ) ) != 0 )
+        return( ret );
+
+    /* Pairs set through the SNI callback are skipped here: serializing
+     * a multi-KB chain on every handshake would cost more than the walk
+     * it replaces */
+    for( cur = conf->key_cert; cur->next != NULL; cur = cur->next )
+        ;
+
+    return( ssl_key_cert_serialize( cur ) );
 }
 
 void mbedtls_ssl_conf_ca_chain( mbedtls_ssl_config *conf,
@@ -5422,6 +7745,38 @@ void mbedtls_ssl_conf_ca_chain( mbedtls_ssl_config *conf,
     conf->ca_chain   = ca_chain;
     conf->ca_crl     = ca_crl;
 }
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+void mbedtls_ssl_conf_cert_cache( mbedtls_ssl_config *conf,
+                                  mbedtls_x509_crt_cache *cache )
+{
+    conf->crt_cache = cache;
+}
+#endif
+
+#if defined(MBEDTLS_X509_TRUST_C)
+void mbedtls_ssl_conf_ca_trust( mbedtls_ssl_config *conf,
+                                const mbedtls_x509_trust *ca_trust,
+                                mbedtls_x509_crl *ca_crl )
+{
+    conf->ca_trust = ca_trust;
+    conf->ca_crl   = ca_crl;
+}
+#endif
+
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+void mbedtls_ssl_conf_verify_cache( mbedtls_ssl_config *conf,
+                                    mbedtls_x509_verify_cache *cache )
+{
+    conf->vrfy_cache = cache;
+}
+#endif
+
+void mbedtls_ssl_conf_verify_executor( mbedtls_ssl_config *conf,
+                            const mbedtls_x509_verify_executor *executor )
+{
+    conf->vrfy_executor = executor;
+}
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
@@ -5453,6 +7808,9 @@ int mbedtls_ssl_conf_psk( mbedtls_ssl_config *conf,
                 const unsigned char *psk, size_t psk_len,
                 const unsigned char *psk_identity, size_t psk_identity_len )
 {
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
     if( psk == NULL || psk_identity == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
@@ -5479,6 +7837,8 @@ int mbedtls_ssl_conf_psk( mbedtls_ssl_config *conf,
     memcpy( conf->psk, psk, conf->psk_len );
     memcpy( conf->psk_identity, psk_identity, conf->psk_identity_len );
 
+    ssl_conf_update_suite_gates( conf );
+
     return( 0 );
 }
 
@@ -5514,6 +7874,8 @@ void mbedtls_ssl_conf_psk_cb( mbedtls_ssl_config *conf,
 {
     conf->f_psk = f_psk;
     conf->p_psk = p_psk;
+
+    ssl_conf_update_suite_gates( conf );
 }
 #endif /* MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED */
 
@@ -5522,100 +7884,426 @@ int mbedtls_ssl_conf_dh_param( mbedtls_ssl_config *conf, const char *dhm_P, cons
 {
     int ret;
 
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
     if( ( ret = mbedtls_mpi_read_string( &conf->dhm_P, 16, dhm_P ) ) != 0 ||
         ( ret = mbedtls_mpi_read_string( &conf->dhm_G, 16, dhm_G ) ) != 0 )
     {
-        mbedtls_mpi_free( &conf->dhm_P );
-        mbedtls_mpi_free( &conf->dhm_G );
-        return( ret );
+        mbedtls_mpi_free( &conf->dhm_P );
+        mbedtls_mpi_free( &conf->dhm_G );
+        return( ret );
+    }
+
+    conf->dhm_group = MBEDTLS_DHM_GROUP_NONE;
+
+    return( 0 );
+}
+
+int mbedtls_ssl_conf_dh_param_ctx( mbedtls_ssl_config *conf, mbedtls_dhm_context *dhm_ctx )
+{
+    int ret;
+
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ( ret = mbedtls_mpi_copy( &conf->dhm_P, &dhm_ctx->P ) ) != 0 ||
+        ( ret = mbedtls_mpi_copy( &conf->dhm_G, &dhm_ctx->G ) ) != 0 )
+    {
+        mbedtls_mpi_free( &conf->dhm_P );
+        mbedtls_mpi_free( &conf->dhm_G );
+        return( ret );
+    }
+
+    conf->dhm_group = MBEDTLS_DHM_GROUP_NONE;
+
+    return( 0 );
+}
+
+int mbedtls_ssl_conf_dh_group( mbedtls_ssl_config *conf, mbedtls_dhm_group_id group_id )
+{
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    conf->dhm_group = (int) group_id;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_DHM_C && MBEDTLS_SSL_SRV_C */
+
+#if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
+/*
+ * Set the minimum length for Diffie-Hellman parameters
+ */
+void mbedtls_ssl_conf_dhm_min_bitlen( mbedtls_ssl_config *conf,
+                                      unsigned int bitlen )
+{
+    conf->dhm_min_bitlen = bitlen;
+}
+#endif /* MBEDTLS_DHM_C && MBEDTLS_SSL_CLI_C */
+
+#if defined(MBEDTLS_KEY_EXCHANGE__SOME__SIGNATURE_ENABLED)
+/*
+ * Set allowed/preferred hashes for handshake signatures.
+ *
+ * Also precompute the rank tables so that picking the preferred hash from
+ * an offered signature_algorithms list is a table lookup per pair instead
+ * of a rescan of the preference list (see ssl_srv.c).
+ */
+void mbedtls_ssl_conf_sig_hashes( mbedtls_ssl_config *conf,
+                                  const int *hashes )
+{
+    const int *md;
+    unsigned char hash, rank = 0;
+
+    conf->sig_hashes = hashes;
+
+    memset( conf->sig_hash_rank, 0, sizeof( conf->sig_hash_rank ) );
+    memset( conf->sig_hash_by_rank, 0, sizeof( conf->sig_hash_by_rank ) );
+
+    if( hashes == NULL )
+        return;
+
+    for( md = hashes; *md != MBEDTLS_MD_NONE; md++ )
+    {
+        hash = mbedtls_ssl_hash_from_md_alg( *md );
+        if( hash == MBEDTLS_SSL_HASH_NONE ||
+            conf->sig_hash_rank[hash] != 0 )
+            continue;
+
+        conf->sig_hash_by_rank[rank] = hash;
+        conf->sig_hash_rank[hash] = (unsigned char)( rank + 1 );
+        rank++;
+    }
+}
+#endif
+
+#if defined(MBEDTLS_ECP_C)
+#if MBEDTLS_ECP_DP_MAX > 31
+#error "Curve bitmasks assume group ids fit a uint32_t"
+#endif
+
+/*
+ * Compute the bitmask equivalent of a curve list, for O(1) membership
+ * tests during negotiation
+ */
+static uint32_t ssl_curve_list_mask( const mbedtls_ecp_group_id *curve_list )
+{
+    uint32_t mask = 0;
+    const mbedtls_ecp_group_id *gid;
+
+    if( curve_list == NULL )
+        return( 0 );
+
+    for( gid = curve_list; *gid != MBEDTLS_ECP_DP_NONE; gid++ )
+        mask |= (uint32_t) 1 << *gid;
+
+    return( mask );
+}
+
+/*
+ * Set the allowed elliptic curves
+ */
+void mbedtls_ssl_conf_curves( mbedtls_ssl_config *conf,
+                             const mbedtls_ecp_group_id *curve_list )
+{
+    conf->curve_list = curve_list;
+    conf->curve_mask = ssl_curve_list_mask( curve_list );
+}
+#endif
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+int mbedtls_ssl_set_hostname( mbedtls_ssl_context *ssl, const char *hostname )
+{
+    size_t hostname_len;
+
+    if( hostname == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    hostname_len = strlen( hostname );
+
+    if( hostname_len + 1 == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ssl->hostname = mbedtls_calloc( 1, hostname_len + 1 );
+
+    if( ssl->hostname == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    memcpy( ssl->hostname, hostname, hostname_len );
+
+    ssl->hostname[hostname_len] = '\0';
+
+    return( 0 );
+}
+#endif
+
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+void mbedtls_ssl_conf_sni( mbedtls_ssl_config *conf,
+                  int (*f_sni)(void *, mbedtls_ssl_context *,
+                                const unsigned char *, size_t),
+                  void *p_sni )
+{
+    conf->f_sni = f_sni;
+    conf->p_sni = p_sni;
+}
+
+/*
+ * Case-insensitive hash and comparison for DNS names (ASCII only,
+ * like certificate verification)
+ */
+static unsigned long ssl_sni_name_hash( const unsigned char *name, size_t len )
+{
+    unsigned long hash = 0;
+    size_t i;
+
+    for( i = 0; i < len; i++ )
+    {
+        unsigned char c = name[i];
+
+        if( c >= 'A' && c <= 'Z' )
+            c += 'a' - 'A';
+
+        hash = hash * 257 + c;
+    }
+
+    return( hash );
+}
+
+static int ssl_sni_name_cmp( const unsigned char *name, size_t len,
+                             const mbedtls_ssl_sni_entry *entry )
+{
+    size_t i;
+
+    if( len != entry->name_len )
+        return( -1 );
+
+    for( i = 0; i < len; i++ )
+    {
+        unsigned char c = name[i];
+
+        if( c >= 'A' && c <= 'Z' )
+            c += 'a' - 'A';
+
+        if( c != (unsigned char) entry->name[i] )
+            return( -1 );
+    }
+
+    return( 0 );
+}
+
+/*
+ * Insert one name -> cert/key mapping, growing the table as needed
+ */
+static int ssl_sni_table_insert( mbedtls_ssl_config *conf,
+                                 const unsigned char *name, size_t name_len,
+                                 mbedtls_x509_crt *own_cert,
+                                 mbedtls_pk_context *pk_key )
+{
+    mbedtls_ssl_sni_entry *entry;
+    unsigned char wildcard = 0;
+    size_t i, bucket;
+
+    if( name_len > 2 && name[0] == '*' && name[1] == '.' )
+    {
+        name += 2;
+        name_len -= 2;
+        wildcard = 1;
+    }
+
+    if( name_len == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Keep the load factor at one entry per bucket at most */
+    if( conf->sni_table_count >= conf->sni_table_size )
+    {
+        mbedtls_ssl_sni_entry **table, *cur, *next;
+        size_t size = conf->sni_table_size == 0 ? 16
+                    : conf->sni_table_size * 2;
+
+        if( ( table = mbedtls_calloc( size, sizeof( *table ) ) ) == NULL )
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+        for( i = 0; i < conf->sni_table_size; i++ )
+        {
+            for( cur = conf->sni_table[i]; cur != NULL; cur = next )
+            {
+                next = cur->next;
+                bucket = ssl_sni_name_hash( (unsigned char *) cur->name,
+                                            cur->name_len ) % size;
+                cur->next = table[bucket];
+                table[bucket] = cur;
+            }
+        }
+
+        mbedtls_free( conf->sni_table );
+        conf->sni_table = table;
+        conf->sni_table_size = size;
+    }
+
+    if( ( entry = mbedtls_calloc( 1, sizeof( *entry ) ) ) == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    if( ( entry->name = mbedtls_calloc( 1, name_len + 1 ) ) == NULL )
+    {
+        mbedtls_free( entry );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    for( i = 0; i < name_len; i++ )
+    {
+        unsigned char c = name[i];
+
+        if( c >= 'A' && c <= 'Z' )
+            c += 'a' - 'A';
+
+        entry->name[i] = (char) c;
     }
 
+    entry->name_len = name_len;
+    entry->wildcard = wildcard;
+    entry->cert = own_cert;
+    entry->key = pk_key;
+
+    bucket = ssl_sni_name_hash( (unsigned char *) entry->name, name_len )
+             % conf->sni_table_size;
+    entry->next = conf->sni_table[bucket];
+    conf->sni_table[bucket] = entry;
+    conf->sni_table_count++;
+
     return( 0 );
 }
 
-int mbedtls_ssl_conf_dh_param_ctx( mbedtls_ssl_config *conf, mbedtls_dhm_context *dhm_ctx )
+int mbedtls_ssl_conf_sni_cert( mbedtls_ssl_config *conf,
+                               mbedtls_x509_crt *own_cert,
+                               mbedtls_pk_context *pk_key )
 {
     int ret;
+    int found = 0;
 
-    if( ( ret = mbedtls_mpi_copy( &conf->dhm_P, &dhm_ctx->P ) ) != 0 ||
-        ( ret = mbedtls_mpi_copy( &conf->dhm_G, &dhm_ctx->G ) ) != 0 )
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Same name sources and precedence as certificate verification:
+     * subjectAltName dNSNames if present, the subject CN otherwise */
+    if( own_cert->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
     {
-        mbedtls_mpi_free( &conf->dhm_P );
-        mbedtls_mpi_free( &conf->dhm_G );
-        return( ret );
+        const mbedtls_x509_sequence *cur;
+
+        for( cur = &own_cert->subject_alt_names; cur != NULL; cur = cur->next )
+        {
+            if( cur->buf.len == 0 )
+                continue;
+
+            if( ( ret = ssl_sni_table_insert( conf, cur->buf.p, cur->buf.len,
+                                              own_cert, pk_key ) ) != 0 )
+                return( ret );
+
+            found = 1;
+        }
     }
+    else
+    {
+        const mbedtls_x509_name *name;
 
-    return( 0 );
-}
-#endif /* MBEDTLS_DHM_C && MBEDTLS_SSL_SRV_C */
+        for( name = &own_cert->subject; name != NULL; name = name->next )
+        {
+            if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name->oid ) != 0 ||
+                name->val.len == 0 )
+                continue;
 
-#if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
-/*
- * Set the minimum length for Diffie-Hellman parameters
- */
-void mbedtls_ssl_conf_dhm_min_bitlen( mbedtls_ssl_config *conf,
-                                      unsigned int bitlen )
-{
-    conf->dhm_min_bitlen = bitlen;
-}
-#endif /* MBEDTLS_DHM_C && MBEDTLS_SSL_CLI_C */
+            if( ( ret = ssl_sni_table_insert( conf, name->val.p, name->val.len,
+                                              own_cert, pk_key ) ) != 0 )
+                return( ret );
 
-#if defined(MBEDTLS_KEY_EXCHANGE__SOME__SIGNATURE_ENABLED)
-/*
- * Set allowed/preferred hashes for handshake signatures
- */
-void mbedtls_ssl_conf_sig_hashes( mbedtls_ssl_config *conf,
-                                  const int *hashes )
-{
-    conf->sig_hashes = hashes;
-}
-#endif
+            found = 1;
+        }
+    }
 
-#if defined(MBEDTLS_ECP_C)
-/*
- * Set the allowed elliptic curves
- */
-void mbedtls_ssl_conf_curves( mbedtls_ssl_config *conf,
-                             const mbedtls_ecp_group_id *curve_list )
-{
-    conf->curve_list = curve_list;
+    if( found == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    return( 0 );
 }
-#endif
 
-#if defined(MBEDTLS_X509_CRT_PARSE_C)
-int mbedtls_ssl_set_hostname( mbedtls_ssl_context *ssl, const char *hostname )
+int mbedtls_ssl_sni_select_cert( mbedtls_ssl_context *ssl,
+                                 const unsigned char *name, size_t name_len )
 {
-    size_t hostname_len;
+    const mbedtls_ssl_config *conf = ssl->conf;
+    const mbedtls_ssl_sni_entry *cur;
+    int ret;
+    int found = 0;
+    size_t label_len;
 
-    if( hostname == NULL )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    if( conf->sni_table == NULL || name_len == 0 )
+        return( 0 );
 
-    hostname_len = strlen( hostname );
+    /* Exact matches take precedence over wildcards */
+    cur = conf->sni_table[ ssl_sni_name_hash( name, name_len )
+                           % conf->sni_table_size ];
+    for( ; cur != NULL; cur = cur->next )
+    {
+        if( cur->wildcard == 0 &&
+            ssl_sni_name_cmp( name, name_len, cur ) == 0 )
+        {
+            if( ( ret = mbedtls_ssl_set_hs_own_cert( ssl, cur->cert,
+                                                     cur->key ) ) != 0 )
+                return( ret );
 
-    if( hostname_len + 1 == 0 )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+            found = 1;
+        }
+    }
 
-    ssl->hostname = mbedtls_calloc( 1, hostname_len + 1 );
+    if( found != 0 )
+        return( 0 );
 
-    if( ssl->hostname == NULL )
-        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    /* Then wildcards covering the first label, which like certificate
+     * verification stand for exactly one label */
+    for( label_len = 0; label_len < name_len; label_len++ )
+        if( name[label_len] == '.' )
+            break;
 
-    memcpy( ssl->hostname, hostname, hostname_len );
+    if( label_len == 0 || label_len + 1 >= name_len )
+        return( 0 );
 
-    ssl->hostname[hostname_len] = '\0';
+    name += label_len + 1;
+    name_len -= label_len + 1;
+
+    cur = conf->sni_table[ ssl_sni_name_hash( name, name_len )
+                           % conf->sni_table_size ];
+    for( ; cur != NULL; cur = cur->next )
+    {
+        if( cur->wildcard != 0 &&
+            ssl_sni_name_cmp( name, name_len, cur ) == 0 )
+        {
+            if( ( ret = mbedtls_ssl_set_hs_own_cert( ssl, cur->cert,
+                                                     cur->key ) ) != 0 )
+                return( ret );
+        }
+    }
 
     return( 0 );
 }
-#endif
 
-#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
-void mbedtls_ssl_conf_sni( mbedtls_ssl_config *conf,
-                  int (*f_sni)(void *, mbedtls_ssl_context *,
-                                const unsigned char *, size_t),
-                  void *p_sni )
+static void ssl_sni_table_free( mbedtls_ssl_config *conf )
 {
-    conf->f_sni = f_sni;
-    conf->p_sni = p_sni;
+    mbedtls_ssl_sni_entry *cur, *next;
+    size_t i;
+
+    for( i = 0; i < conf->sni_table_size; i++ )
+    {
+        for( cur = conf->sni_table[i]; cur != NULL; cur = next )
+        {
+            next = cur->next;
+            mbedtls_free( cur->name );
+            mbedtls_free( cur );
+        }
+    }
+
+    mbedtls_free( conf->sni_table );
+    conf->sni_table = NULL;
+    conf->sni_table_size = 0;
+    conf->sni_table_count = 0;
 }
 #endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
 
@@ -5625,6 +8313,9 @@ int mbedtls_ssl_conf_alpn_protocols( mbedtls_ssl_config *conf, const char **prot
     size_t cur_len, tot_len;
     const char **p;
 
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
     /*
      * "Empty strings MUST NOT be included and byte strings MUST NOT be
      * truncated". Check lengths now rather than later.
@@ -5687,12 +8378,16 @@ void mbedtls_ssl_conf_extended_master_secret( mbedtls_ssl_config *conf, char ems
 void mbedtls_ssl_conf_arc4_support( mbedtls_ssl_config *conf, char arc4 )
 {
     conf->arc4_disabled = arc4;
+    ssl_conf_update_suite_gates( conf );
 }
 #endif
 
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
 int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_code )
 {
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
     if( mfl_code >= MBEDTLS_SSL_MAX_FRAG_LEN_INVALID ||
         mfl_code_to_length[mfl_code] > MBEDTLS_SSL_MAX_CONTENT_LEN )
     {
@@ -5705,6 +8400,29 @@ int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_c
 }
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+void mbedtls_ssl_conf_buffer_sizes( mbedtls_ssl_config *conf,
+                                    size_t in_len, size_t out_len )
+{
+    conf->in_content_len = in_len;
+    conf->out_content_len = out_len;
+}
+
+void mbedtls_ssl_conf_output_coalescing( mbedtls_ssl_config *conf,
+                                         size_t watermark )
+{
+    conf->out_coalesce = watermark;
+}
+
+void mbedtls_ssl_conf_dynamic_record_sizing( mbedtls_ssl_config *conf,
+                                             size_t start_len,
+                                             size_t grow_bytes,
+                                             uint32_t idle_ms )
+{
+    conf->dyn_rec_start = start_len;
+    conf->dyn_rec_grow = grow_bytes;
+    conf->dyn_rec_idle = idle_ms;
+}
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 void mbedtls_ssl_conf_truncated_hmac( mbedtls_ssl_config *conf, int truncate )
 {
@@ -5719,6 +8437,17 @@ void mbedtls_ssl_conf_cbc_record_splitting( mbedtls_ssl_config *conf, char split
 }
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+void mbedtls_ssl_conf_record_pad( mbedtls_ssl_config *conf, size_t boundary )
+{
+    /* Total padding is at most 256 bytes, larger boundaries can't be hit */
+    if( boundary > MBEDTLS_SSL_PADDING_ADD )
+        boundary = MBEDTLS_SSL_PADDING_ADD;
+
+    conf->record_pad = (uint16_t) boundary;
+}
+#endif
+
 void mbedtls_ssl_conf_legacy_renegotiation( mbedtls_ssl_config *conf, int allow_legacy )
 {
     conf->allow_legacy_renegotiation = allow_legacy;
@@ -5730,6 +8459,13 @@ void mbedtls_ssl_conf_renegotiation( mbedtls_ssl_config *conf, int renegotiation
     conf->disable_renegotiation = renegotiation;
 }
 
+#if defined(MBEDTLS_SSL_SRV_C)
+void mbedtls_ssl_conf_rekey( mbedtls_ssl_config *conf, int rekey )
+{
+    conf->rekey = rekey;
+}
+#endif
+
 void mbedtls_ssl_conf_renegotiation_enforced( mbedtls_ssl_config *conf, int max_records )
 {
     conf->renego_max_records = max_records;
@@ -5750,6 +8486,13 @@ void mbedtls_ssl_conf_session_tickets( mbedtls_ssl_config *conf, int use_tickets
 }
 #endif
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+void mbedtls_ssl_conf_false_start( mbedtls_ssl_config *conf, int false_start )
+{
+    conf->false_start = false_start;
+}
+#endif
+
 #if defined(MBEDTLS_SSL_SRV_C)
 void mbedtls_ssl_conf_session_tickets_cb( mbedtls_ssl_config *conf,
         mbedtls_ssl_ticket_write_t *f_ticket_write,
@@ -5763,6 +8506,45 @@ void mbedtls_ssl_conf_session_tickets_cb( mbedtls_ssl_config *conf,
 #endif
 #endif /* MBEDTLS_SSL_SESSION_TICKETS */
 
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+void mbedtls_ssl_conf_async_private_cb( mbedtls_ssl_config *conf,
+        int (*f_async_sign)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                             mbedtls_md_type_t, const unsigned char *, size_t ),
+        int (*f_async_decrypt)( mbedtls_ssl_context *, mbedtls_x509_crt *,
+                                const unsigned char *, size_t ),
+        int (*f_async_resume)( mbedtls_ssl_context *, unsigned char *,
+                               size_t *, size_t ),
+        void (*f_async_cancel)( mbedtls_ssl_context * ),
+        void *p_async )
+{
+    conf->f_async_sign    = f_async_sign;
+    conf->f_async_decrypt = f_async_decrypt;
+    conf->f_async_resume  = f_async_resume;
+    conf->f_async_cancel  = f_async_cancel;
+    conf->p_async         = p_async;
+}
+
+void *mbedtls_ssl_conf_get_async_config_data( const mbedtls_ssl_config *conf )
+{
+    return( conf->p_async );
+}
+
+void *mbedtls_ssl_get_async_operation_data( const mbedtls_ssl_context *ssl )
+{
+    if( ssl->handshake == NULL )
+        return( NULL );
+
+    return( ssl->handshake->user_async_ctx );
+}
+
+void mbedtls_ssl_set_async_operation_data( mbedtls_ssl_context *ssl,
+                                           void *ctx )
+{
+    if( ssl->handshake != NULL )
+        ssl->handshake->user_async_ctx = ctx;
+}
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
+
 /*
  * SSL get accessors
  */
@@ -5771,6 +8553,22 @@ size_t mbedtls_ssl_get_bytes_avail( const mbedtls_ssl_context *ssl )
     return( ssl->in_offt == NULL ? 0 : ssl->in_msglen );
 }
 
+#if defined(MBEDTLS_SSL_STATS)
+void mbedtls_ssl_get_stats( const mbedtls_ssl_context *ssl,
+                            mbedtls_ssl_stats *stats )
+{
+    *stats = ssl->stats;
+}
+#endif /* MBEDTLS_SSL_STATS */
+
+#if defined(MBEDTLS_SSL_HS_TIMING)
+void mbedtls_ssl_get_hs_timing( const mbedtls_ssl_context *ssl,
+                                mbedtls_ssl_hs_timing *timing )
+{
+    *timing = ssl->hs_timing;
+}
+#endif /* MBEDTLS_SSL_HS_TIMING */
+
 uint32_t mbedtls_ssl_get_verify_result( const mbedtls_ssl_context *ssl )
 {
     if( ssl->session != NULL )
@@ -5845,6 +8643,7 @@ int mbedtls_ssl_get_record_expansion( const mbedtls_ssl_context *ssl )
     {
         case MBEDTLS_MODE_GCM:
         case MBEDTLS_MODE_CCM:
+        case MBEDTLS_MODE_CHACHAPOLY:
         case MBEDTLS_MODE_STREAM:
             transform_expansion = transform->minlen;
             break;
@@ -5868,24 +8667,207 @@ const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert( const mbedtls_ssl_context *ss
     if( ssl == NULL || ssl->session == NULL )
         return( NULL );
 
-    return( ssl->session->peer_cert );
-}
+    return( ssl->session->peer_cert );
+}
+
+#if defined(MBEDTLS_SHA256_C)
+const unsigned char *mbedtls_ssl_get_peer_cert_digest(
+                                            const mbedtls_ssl_context *ssl )
+{
+    if( ssl == NULL || ssl->session == NULL ||
+        ssl->session->peer_cert_digest_set == 0 )
+    {
+        return( NULL );
+    }
+
+    return( ssl->session->peer_cert_digest );
+}
+#endif /* MBEDTLS_SHA256_C */
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+#if defined(MBEDTLS_SSL_CLI_C)
+int mbedtls_ssl_get_session( const mbedtls_ssl_context *ssl, mbedtls_ssl_session *dst )
+{
+    if( ssl == NULL ||
+        dst == NULL ||
+        ssl->session == NULL ||
+        ssl->conf->endpoint != MBEDTLS_SSL_IS_CLIENT )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    return( mbedtls_ssl_session_copy( dst, ssl->session ) );
+}
+#endif /* MBEDTLS_SSL_CLI_C */
+
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+int mbedtls_ssl_get_record_keys( const mbedtls_ssl_context *ssl,
+                                 mbedtls_ssl_record_keys *keys )
+{
+    const mbedtls_ssl_transform *out, *in;
+    size_t iv_copy_len;
+
+    if( ssl == NULL || keys == NULL ||
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        ssl->transform_out == NULL || ssl->transform_in == NULL )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    /* With DTLS the epoch is part of the record sequence number and
+     * retransmission may still need the record layer */
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+#endif
+
+    out = ssl->transform_out;
+    in = ssl->transform_in;
+
+    memset( keys, 0, sizeof( mbedtls_ssl_record_keys ) );
+
+    keys->cipher = out->ciphersuite_info->cipher;
+    keys->minor_ver = ssl->minor_ver;
+    keys->key_len = out->keylen;
+    keys->iv_len = out->ivlen;
+    keys->fixed_iv_len = out->fixed_ivlen;
+    keys->mac_len = out->maclen;
+
+    memcpy( keys->tx_key, out->key_enc, out->keylen );
+    memcpy( keys->rx_key, in->key_dec, in->keylen );
+
+    /* Only the implicit part of an AEAD IV is kept in the transform */
+    iv_copy_len = out->fixed_ivlen != 0 ? out->fixed_ivlen : out->ivlen;
+    memcpy( keys->tx_iv, out->iv_enc, iv_copy_len );
+    iv_copy_len = in->fixed_ivlen != 0 ? in->fixed_ivlen : in->ivlen;
+    memcpy( keys->rx_iv, in->iv_dec, iv_copy_len );
+
+    /* The counters are updated as records are made resp. received, so
+     * they already hold the next record's sequence number. While the
+     * I/O buffers are released they live in the saved copies. */
+    memcpy( keys->tx_seq,
+            ssl->out_buf != NULL ? ssl->out_ctr : ssl->saved_out_ctr, 8 );
+    memcpy( keys->rx_seq,
+            ssl->in_buf != NULL ? ssl->in_ctr : ssl->saved_in_ctr, 8 );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_RECORD_KEY_EXPORT */
+
+/*
+ * Serialize a session in the following format:
+ *  0   .   n-1     session structure, n = sizeof(mbedtls_ssl_session)
+ *  n   .   n+2     peer_cert length = m (0 if no certificate)
+ *  n+3 .   n+2+m   peer cert ASN.1
+ */
+int mbedtls_ssl_session_save( const mbedtls_ssl_session *session,
+                              unsigned char *buf, size_t buf_len,
+                              size_t *olen )
+{
+    unsigned char *p = buf;
+    size_t left = buf_len;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    size_t cert_len;
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+    if( left < sizeof( mbedtls_ssl_session ) )
+        return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
+
+    memcpy( p, session, sizeof( mbedtls_ssl_session ) );
+    p += sizeof( mbedtls_ssl_session );
+    left -= sizeof( mbedtls_ssl_session );
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if( session->peer_cert == NULL )
+        cert_len = 0;
+    else
+        cert_len = session->peer_cert->raw.len;
+
+    if( left < 3 + cert_len )
+        return( MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL );
+
+    *p++ = (unsigned char)( cert_len >> 16 & 0xFF );
+    *p++ = (unsigned char)( cert_len >>  8 & 0xFF );
+    *p++ = (unsigned char)( cert_len       & 0xFF );
+
+    if( session->peer_cert != NULL )
+        memcpy( p, session->peer_cert->raw.p, cert_len );
+
+    p += cert_len;
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+    *olen = p - buf;
+
+    return( 0 );
+}
+
+/*
+ * Unserialise session, see mbedtls_ssl_session_save()
+ */
+int mbedtls_ssl_session_load( mbedtls_ssl_session *session,
+                              const unsigned char *buf, size_t len )
+{
+    const unsigned char *p = buf;
+    const unsigned char * const end = buf + len;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    size_t cert_len;
+#endif /* MBEDTLS_X509_CRT_PARSE_C */
+
+    if( p + sizeof( mbedtls_ssl_session ) > end )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    memcpy( session, p, sizeof( mbedtls_ssl_session ) );
+    p += sizeof( mbedtls_ssl_session );
+
+    /* The pointers in the serialized copy are meaningless in this
+     * process, don't let them escape */
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    session->peer_cert = NULL;
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    session->ticket = NULL;
+    session->ticket_len = 0;
+#endif
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if( p + 3 > end )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    cert_len = ( p[0] << 16 ) | ( p[1] << 8 ) | p[2];
+    p += 3;
+
+    if( cert_len != 0 )
+    {
+        int ret;
+
+        if( cert_len > (size_t)( end - p ) )
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+        session->peer_cert = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt ) );
+
+        if( session->peer_cert == NULL )
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+        mbedtls_x509_crt_init( session->peer_cert );
+
+        if( ( ret = mbedtls_x509_crt_parse_der( session->peer_cert,
+                                        p, cert_len ) ) != 0 )
+        {
+            mbedtls_x509_crt_free( session->peer_cert );
+            mbedtls_free( session->peer_cert );
+            session->peer_cert = NULL;
+            return( ret );
+        }
+
+        p += cert_len;
+    }
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
-#if defined(MBEDTLS_SSL_CLI_C)
-int mbedtls_ssl_get_session( const mbedtls_ssl_context *ssl, mbedtls_ssl_session *dst )
-{
-    if( ssl == NULL ||
-        dst == NULL ||
-        ssl->session == NULL ||
-        ssl->conf->endpoint != MBEDTLS_SSL_IS_CLIENT )
-    {
+    if( p != end )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-    }
 
-    return( ssl_session_copy( dst, ssl->session ) );
+    return( 0 );
 }
-#endif /* MBEDTLS_SSL_CLI_C */
 
 /*
  * Perform a single step of the SSL handshake
@@ -5894,6 +8876,22 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
 {
     int ret = MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
 
+#if defined(MBEDTLS_SSL_HS_TIMING)
+    int entry_state = ssl->state;
+    unsigned long t_enter = mbedtls_timing_hardclock();
+
+    /* A fresh handshake (or a renegotiation) starts over in
+     * MBEDTLS_SSL_HELLO_REQUEST: restart the breakdown */
+    if( entry_state == MBEDTLS_SSL_HELLO_REQUEST || ssl->hs_timing.done != 0 )
+    {
+        memset( &ssl->hs_timing, 0, sizeof( ssl->hs_timing ) );
+        ssl->hs_timing_start = t_enter;
+        ssl->hs_timing_last = t_enter;
+    }
+
+    ssl->hs_timing.wait_cycles += t_enter - ssl->hs_timing_last;
+#endif
+
 #if defined(MBEDTLS_SSL_CLI_C)
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT )
         ret = mbedtls_ssl_handshake_client_step( ssl );
@@ -5903,6 +8901,22 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
         ret = mbedtls_ssl_handshake_server_step( ssl );
 #endif
 
+#if defined(MBEDTLS_SSL_HS_TIMING)
+    ssl->hs_timing_last = mbedtls_timing_hardclock();
+
+    if( entry_state >= 0 && entry_state < MBEDTLS_SSL_HS_TIMING_STATES )
+        ssl->hs_timing.state_cycles[entry_state] +=
+            ssl->hs_timing_last - t_enter;
+    ssl->hs_timing.steps++;
+
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        ssl->hs_timing.total_cycles =
+            ssl->hs_timing_last - ssl->hs_timing_start;
+        ssl->hs_timing.done = 1;
+    }
+#endif
+
     return( ret );
 }
 
@@ -5939,6 +8953,13 @@ static int ssl_write_hello_request( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write hello request" ) );
 
+    /* Re-acquire the output buffer if it was released while idle */
+    if( ssl->out_buf == NULL &&
+        ( ret = ssl_acquire_out_buf( ssl, ssl_out_buf_preferred_len( ssl ) ) ) != 0 )
+    {
+        return( ret );
+    }
+
     ssl->out_msglen  = 4;
     ssl->out_msgtype = MBEDTLS_SSL_MSG_HANDSHAKE;
     ssl->out_msg[0]  = MBEDTLS_SSL_HS_HELLO_REQUEST;
@@ -5973,6 +8994,25 @@ static int ssl_start_renegotiation( mbedtls_ssl_context *ssl )
     if( ( ret = ssl_handshake_init( ssl ) ) != 0 )
         return( ret );
 
+#if defined(MBEDTLS_SSL_STATS)
+    ssl->stats.renegotiations++;
+#endif
+
+#if defined(MBEDTLS_SSL_CLI_C)
+    /*
+     * Abbreviated rekey: offer to resume the current session so that only
+     * new randoms and a fresh key block are exchanged
+     */
+    if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT && ssl->rekey != 0 )
+    {
+        if( ( ret = mbedtls_ssl_session_copy( ssl->session_negotiate,
+                                              ssl->session ) ) != 0 )
+            return( ret );
+
+        ssl->handshake->resume = 1;
+    }
+#endif
+
     /* RFC 6347 4.2.2: "[...] the HelloRequest will have message_seq = 0 and
      * the ServerHello will have message_seq = 1" */
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -6017,8 +9057,9 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl )
 
         ssl->renego_status = MBEDTLS_SSL_RENEGOTIATION_PENDING;
 
-        /* Did we already try/start sending HelloRequest? */
-        if( ssl->out_left != 0 )
+        /* Did we already try/start sending HelloRequest?
+         * (held records go out together with it) */
+        if( ssl->out_left != 0 && ssl->out_held == 0 )
             return( mbedtls_ssl_flush_output( ssl ) );
 
         return( ssl_write_hello_request( ssl ) );
@@ -6054,6 +9095,38 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl )
     return( ret );
 }
 
+#if defined(MBEDTLS_SSL_CLI_C)
+/*
+ * Abbreviated rekey on client: renegotiate while resuming the current
+ * session, so that no certificate exchange or asymmetric crypto is done
+ */
+int mbedtls_ssl_rekey( mbedtls_ssl_context *ssl )
+{
+    int ret;
+
+    if( ssl->conf->endpoint != MBEDTLS_SSL_IS_CLIENT )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Continue an ongoing rekey handshake */
+    if( ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_IN_PROGRESS )
+        return( mbedtls_ssl_renegotiate( ssl ) );
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Nothing to resume without a server-assigned session id */
+    if( ssl->session == NULL || ssl->session->id_len == 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ssl->rekey = 1;
+
+    if( ( ret = ssl_start_renegotiation( ssl ) ) != 0 )
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_start_renegotiation", ret );
+
+    return( ret );
+}
+#endif /* MBEDTLS_SSL_CLI_C */
+
 /*
  * Check record counters and renegotiate if they're above the limit.
  */
@@ -6078,14 +9151,35 @@ static int ssl_check_ctr_renegotiate( mbedtls_ssl_context *ssl )
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
 /*
- * Receive application data decrypted from the SSL layer
+ * Tell whether one more complete record already sits in the input buffer
+ * behind the one just consumed (streams with read-ahead only)
  */
-int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+static int ssl_next_record_buffered( const mbedtls_ssl_context *ssl )
 {
-    int ret, record_read = 0;
-    size_t n;
+    size_t ofs = ssl->next_record_offset;
+    size_t reclen;
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( 0 );
+#endif
+
+    if( ssl->in_left < ofs + mbedtls_ssl_hdr_len( ssl ) )
+        return( 0 );
+
+    reclen = ( (size_t) ssl->in_hdr[ofs + 3] << 8 ) | ssl->in_hdr[ofs + 4];
+
+    return( ssl->in_left - ofs >= mbedtls_ssl_hdr_len( ssl ) + reclen );
+}
+
+/*
+ * Make sure a decrypted application data record is pending in in_msg,
+ * fetching a new one if needed. On success ssl->in_offt points to the
+ * unconsumed part of the record and ssl->in_msglen bytes are available.
+ */
+static int ssl_read_prepare( mbedtls_ssl_context *ssl )
+{
+    int ret, record_read = 0;
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
@@ -6137,10 +9231,8 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
         {
             if( ( ret = mbedtls_ssl_read_record( ssl ) ) != 0 )
             {
-                if( ret == MBEDTLS_ERR_SSL_CONN_EOF )
-                    return( 0 );
-
-                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_read_record", ret );
+                if( ret != MBEDTLS_ERR_SSL_CONN_EOF )
+                    MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_read_record", ret );
                 return( ret );
             }
         }
@@ -6153,10 +9245,8 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
              */
             if( ( ret = mbedtls_ssl_read_record( ssl ) ) != 0 )
             {
-                if( ret == MBEDTLS_ERR_SSL_CONN_EOF )
-                    return( 0 );
-
-                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_read_record", ret );
+                if( ret != MBEDTLS_ERR_SSL_CONN_EOF )
+                    MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_read_record", ret );
                 return( ret );
             }
         }
@@ -6289,68 +9379,349 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
 
         ssl->in_offt = ssl->in_msg;
 
-        /* We're going to return something now, cancel timer,
-         * except if handshake (renegotiation) is in progress */
-        if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
-            ssl_set_timer( ssl, 0 );
+        /* We're going to return something now, cancel timer,
+         * except if handshake (renegotiation) is in progress */
+        if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
+            ssl_set_timer( ssl, 0 );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        /* If we requested renego but received AppData, resend HelloRequest.
+         * Do it now, after setting in_offt, to avoid taking this branch
+         * again if ssl_write_hello_request() returns WANT_WRITE */
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_RENEGOTIATION)
+        if( ssl->conf->endpoint == MBEDTLS_SSL_IS_SERVER &&
+            ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_PENDING )
+        {
+            if( ( ret = ssl_resend_hello_request( ssl ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "ssl_resend_hello_request", ret );
+                return( ret );
+            }
+        }
+#endif /* MBEDTLS_SSL_SRV_C && MBEDTLS_SSL_RENEGOTIATION */
+#endif
+    }
+
+    return( 0 );
+}
+
+/*
+ * Receive application data decrypted from the SSL layer
+ */
+int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+{
+    int ret;
+    size_t n, total = 0;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
+
+    /* Deliver an error held back by a previous draining read */
+    if( ssl->pending_fatal != 0 )
+    {
+        ret = ssl->pending_fatal;
+        ssl->pending_fatal = 0;
+        return( ret == MBEDTLS_ERR_SSL_CONN_EOF ? 0 : ret );
+    }
+
+    if( ( ret = ssl_read_prepare( ssl ) ) != 0 )
+        return( ret == MBEDTLS_ERR_SSL_CONN_EOF ? 0 : ret );
+
+    /* Overlap the staged record's first-line miss with the loop setup */
+    MBEDTLS_PREFETCH_R( ssl->in_offt );
+
+    for( ;; )
+    {
+        n = ( len - total < ssl->in_msglen )
+            ? len - total : ssl->in_msglen;
+
+        memcpy( buf + total, ssl->in_offt, n );
+        ssl->in_msglen -= n;
+        total += n;
+
+        if( ssl->in_msglen != 0 )
+        {
+            /* more data available */
+            ssl->in_offt += n;
+            break;
+        }
+
+        /* all bytes consumed  */
+        ssl->in_offt = NULL;
+
+        /*
+         * With read-ahead, drain every further record already complete
+         * in the input buffer into the caller's span; no transport read
+         * happens past this point
+         */
+        if( total == len || ! ssl->conf->read_ahead ||
+            ! ssl_next_record_buffered( ssl ) )
+            break;
+
+        if( ( ret = ssl_read_prepare( ssl ) ) != 0 )
+        {
+            /* Records were already consumed: return them and hold the
+             * error for the next call rather than losing either */
+            if( ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+                ssl->pending_fatal = ret;
+            break;
+        }
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read" ) );
+
+    return( (int) total );
+}
+
+/*
+ * Lend the unconsumed part of the current record to the caller,
+ * without copying it out of the input buffer
+ */
+int mbedtls_ssl_read_borrow( mbedtls_ssl_context *ssl,
+                             const unsigned char **buf, size_t *len )
+{
+    int ret;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read borrow" ) );
+
+    *buf = NULL;
+    *len = 0;
+
+    if( ( ret = ssl_read_prepare( ssl ) ) != 0 )
+        return( ret == MBEDTLS_ERR_SSL_CONN_EOF ? 0 : ret );
+
+    *buf = ssl->in_offt;
+    *len = ssl->in_msglen;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read borrow" ) );
+
+    return( 0 );
+}
+
+/*
+ * Mark bytes at the front of a borrowed record as consumed
+ */
+int mbedtls_ssl_read_consume( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl->in_offt == NULL || len > ssl->in_msglen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ssl->in_msglen -= len;
+
+    if( ssl->in_msglen == 0 )
+        /* all bytes consumed  */
+        ssl->in_offt = NULL;
+    else
+        /* more data available */
+        ssl->in_offt += len;
+
+    return( 0 );
+}
+
+/*
+ * Current limit on the payload of outgoing application data records when
+ * dynamic record sizing is enabled (0: no limit), updating the growth and
+ * idle-fallback state. Only to be called when a fresh record is about to
+ * be made: retries after WANT_WRITE reuse ssl->dyn_rec_cur unchanged, so
+ * that they are clamped like the record they resume.
+ */
+static size_t ssl_dyn_rec_limit( mbedtls_ssl_context *ssl )
+{
+    if( ssl->conf->dyn_rec_start == 0 ||
+        ssl->conf->transport != MBEDTLS_SSL_TRANSPORT_STREAM )
+        return( 0 );
+
+#if defined(MBEDTLS_TIMING_C)
+    if( ssl->conf->dyn_rec_idle != 0 && ssl->dyn_rec_cur != 0 &&
+        mbedtls_timing_get_timer( &ssl->dyn_rec_last, 0 ) >=
+            (unsigned long) ssl->conf->dyn_rec_idle )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "connection was idle: record size limit "
+                                    "back to %d bytes",
+                                    ssl->conf->dyn_rec_start ) );
+        ssl->dyn_rec_cur = ssl->conf->dyn_rec_start;
+        ssl->dyn_rec_sent = 0;
+    }
+#endif
+
+    if( ssl->dyn_rec_cur == 0 )
+        ssl->dyn_rec_cur = ssl->conf->dyn_rec_start;
+
+    if( ssl->dyn_rec_cur < (size_t) MBEDTLS_SSL_MAX_CONTENT_LEN &&
+        ssl->dyn_rec_sent >= ssl->conf->dyn_rec_grow )
+    {
+        ssl->dyn_rec_cur *= 2;
+        if( ssl->dyn_rec_cur > (size_t) MBEDTLS_SSL_MAX_CONTENT_LEN )
+            ssl->dyn_rec_cur = MBEDTLS_SSL_MAX_CONTENT_LEN;
+        ssl->dyn_rec_sent = 0;
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "record size limit grown to %d bytes",
+                                    ssl->dyn_rec_cur ) );
+    }
+
+    return( ssl->dyn_rec_cur );
+}
+
+/*
+ * Account for an application data record that was just made
+ */
+static void ssl_dyn_rec_update( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl->conf->dyn_rec_start == 0 )
+        return;
+
+    ssl->dyn_rec_sent += len;
+#if defined(MBEDTLS_TIMING_C)
+    (void) mbedtls_timing_get_timer( &ssl->dyn_rec_last, 1 );
+#endif
+}
+
+/*
+ * Send application data to be encrypted by the SSL layer,
+ * taking care of max fragment length and buffer size
+ */
+static int ssl_write_real( mbedtls_ssl_context *ssl,
+                           const unsigned char *buf, size_t len )
+{
+    int ret;
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    unsigned int max_len;
+#endif
+
+    /* Re-acquire the output buffer if it was released while idle */
+    if( ssl->out_buf == NULL &&
+        ( ret = ssl_acquire_out_buf( ssl, ssl_out_buf_preferred_len( ssl ) ) ) != 0 )
+    {
+        return( ret );
+    }
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    /*
+     * Assume mfl_code is correct since it was checked when set
+     */
+    max_len = mfl_code_to_length[ssl->conf->mfl_code];
+
+    /*
+     * Check if a smaller max length was negotiated
+     */
+    if( ssl->session_out != NULL &&
+        mfl_code_to_length[ssl->session_out->mfl_code] < max_len )
+    {
+        max_len = mfl_code_to_length[ssl->session_out->mfl_code];
+    }
+
+    if( len > max_len )
+    {
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "fragment larger than the (negotiated) "
+                                "maximum fragment length: %d > %d",
+                                len, max_len ) );
+            return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+        }
+        else
+#endif
+            len = max_len;
+    }
+#endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+
+    /* Adjust for a smaller run-time configured output buffer; this can't
+     * trigger with DTLS since DTLS buffers are never shrunk
+     * (see mbedtls_ssl_conf_buffer_sizes()) */
+    if( len > ssl->out_buf_len - (size_t) MBEDTLS_SSL_BUFFER_OVERHEAD )
+        len = ssl->out_buf_len - MBEDTLS_SSL_BUFFER_OVERHEAD;
+
+    /* Held records were already reported as written: only resume a
+     * transmission that is actually in progress */
+    if( ssl->out_left != 0 && ssl->out_held == 0 )
+    {
+        /* The record being resumed was clamped to the then-current
+         * dynamic size limit */
+        if( ssl->dyn_rec_cur != 0 && len > ssl->dyn_rec_cur )
+            len = ssl->dyn_rec_cur;
+
+        if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+            return( ret );
+        }
+    }
+    else
+    {
+        size_t dyn_limit = ssl_dyn_rec_limit( ssl );
+
+        if( dyn_limit != 0 && len > dyn_limit )
+            len = dyn_limit;
 
-#if defined(MBEDTLS_SSL_PROTO_DTLS)
-        /* If we requested renego but received AppData, resend HelloRequest.
-         * Do it now, after setting in_offt, to avoid taking this branch
-         * again if ssl_write_hello_request() returns WANT_WRITE */
-#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_RENEGOTIATION)
-        if( ssl->conf->endpoint == MBEDTLS_SSL_IS_SERVER &&
-            ssl->renego_status == MBEDTLS_SSL_RENEGOTIATION_PENDING )
+        /* If this record may not fit after the held ones, make room by
+         * sending them first */
+        if( ssl->out_held != 0 &&
+            (size_t)( ssl->out_buf + ssl->out_buf_len - ssl->out_hdr ) <
+                len + (size_t) MBEDTLS_SSL_BUFFER_OVERHEAD )
         {
-            if( ( ret = ssl_resend_hello_request( ssl ) ) != 0 )
+            if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
             {
-                MBEDTLS_SSL_DEBUG_RET( 1, "ssl_resend_hello_request", ret );
+                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
                 return( ret );
             }
         }
-#endif /* MBEDTLS_SSL_SRV_C && MBEDTLS_SSL_RENEGOTIATION */
-#endif
-    }
-
-    n = ( len < ssl->in_msglen )
-        ? len : ssl->in_msglen;
 
-    memcpy( buf, ssl->in_offt, n );
-    ssl->in_msglen -= n;
+        ssl->out_msglen  = len;
+        ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+        memcpy( ssl->out_msg, buf, len );
 
-    if( ssl->in_msglen == 0 )
-        /* all bytes consumed  */
-        ssl->in_offt = NULL;
-    else
-        /* more data available */
-        ssl->in_offt += n;
+        if( ( ret = mbedtls_ssl_write_record( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_write_record", ret );
+            return( ret );
+        }
 
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read" ) );
+        ssl_dyn_rec_update( ssl, len );
+    }
 
-    return( (int) n );
+    return( (int) len );
 }
 
 /*
- * Send application data to be encrypted by the SSL layer,
- * taking care of max fragment length and buffer size
+ * Gather variant of ssl_write_real(): assemble the fragments directly in
+ * the output buffer, after skipping the first 'skip' bytes of the logical
+ * stream (used for 1/n-1 splitting). Returns the number of bytes written,
+ * not counting the skipped ones.
  */
-static int ssl_write_real( mbedtls_ssl_context *ssl,
-                           const unsigned char *buf, size_t len )
+static int ssl_write_gather( mbedtls_ssl_context *ssl,
+                             const mbedtls_ssl_iovec *iov, size_t iovcnt,
+                             size_t skip )
 {
     int ret;
+    size_t len = 0, i, take;
+    unsigned char *p;
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
     unsigned int max_len;
 #endif
 
+    /* Re-acquire the output buffer if it was released while idle */
+    if( ssl->out_buf == NULL &&
+        ( ret = ssl_acquire_out_buf( ssl, ssl_out_buf_preferred_len( ssl ) ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    for( i = 0; i < iovcnt; i++ )
+        len += iov[i].len;
+    len -= skip;
+
+    if( len > MBEDTLS_SSL_MAX_CONTENT_LEN )
+        len = MBEDTLS_SSL_MAX_CONTENT_LEN;
+
+    /* Adjust for a smaller run-time configured output buffer
+     * (see mbedtls_ssl_conf_buffer_sizes()) */
+    if( len > ssl->out_buf_len - (size_t) MBEDTLS_SSL_BUFFER_OVERHEAD )
+        len = ssl->out_buf_len - MBEDTLS_SSL_BUFFER_OVERHEAD;
+
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
-    /*
-     * Assume mfl_code is correct since it was checked when set
-     */
     max_len = mfl_code_to_length[ssl->conf->mfl_code];
 
-    /*
-     * Check if a smaller max length was negotiated
-     */
     if( ssl->session_out != NULL &&
         mfl_code_to_length[ssl->session_out->mfl_code] < max_len )
     {
@@ -6373,8 +9744,15 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
     }
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
-    if( ssl->out_left != 0 )
+    /* Held records were already reported as written: only resume a
+     * transmission that is actually in progress */
+    if( ssl->out_left != 0 && ssl->out_held == 0 )
     {
+        /* The record being resumed was clamped to the then-current
+         * dynamic size limit */
+        if( ssl->dyn_rec_cur != 0 && len > ssl->dyn_rec_cur )
+            len = ssl->dyn_rec_cur;
+
         if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
         {
             MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
@@ -6383,15 +9761,53 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
     }
     else
     {
+        size_t dyn_limit = ssl_dyn_rec_limit( ssl );
+
+        if( dyn_limit != 0 && len > dyn_limit )
+            len = dyn_limit;
+
+        /* If this record may not fit after the held ones, make room by
+         * sending them first */
+        if( ssl->out_held != 0 &&
+            (size_t)( ssl->out_buf + ssl->out_buf_len - ssl->out_hdr ) <
+                len + (size_t) MBEDTLS_SSL_BUFFER_OVERHEAD )
+        {
+            if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+            {
+                MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+                return( ret );
+            }
+        }
+
+        p = ssl->out_msg;
+
+        for( i = 0; i < iovcnt && (size_t)( p - ssl->out_msg ) < len; i++ )
+        {
+            if( skip >= iov[i].len )
+            {
+                skip -= iov[i].len;
+                continue;
+            }
+
+            take = iov[i].len - skip;
+            if( take > len - (size_t)( p - ssl->out_msg ) )
+                take = len - (size_t)( p - ssl->out_msg );
+
+            memcpy( p, iov[i].base + skip, take );
+            p += take;
+            skip = 0;
+        }
+
         ssl->out_msglen  = len;
         ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
-        memcpy( ssl->out_msg, buf, len );
 
         if( ( ret = mbedtls_ssl_write_record( ssl ) ) != 0 )
         {
             MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_write_record", ret );
             return( ret );
         }
+
+        ssl_dyn_rec_update( ssl, len );
     }
 
     return( (int) len );
@@ -6435,6 +9851,93 @@ static int ssl_write_split( mbedtls_ssl_context *ssl,
 }
 #endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+/*
+ * Check whether it is safe to send application data now even though the
+ * handshake is not over: we are a client in a full (initial, non-resumed)
+ * TLS 1.2 handshake whose Finished message is already out, and the
+ * negotiated suite is forward-secret with an AEAD cipher, as required by
+ * draft-ietf-tls-falsestart.
+ */
+static int ssl_false_start_ready( const mbedtls_ssl_context *ssl )
+{
+    const mbedtls_ssl_ciphersuite_t *suite;
+    const mbedtls_cipher_info_t *cipher_info;
+
+    if( ssl->conf->endpoint != MBEDTLS_SSL_IS_CLIENT )
+        return( 0 );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport != MBEDTLS_SSL_TRANSPORT_STREAM )
+        return( 0 );
+#endif
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if( ssl->renego_status != MBEDTLS_SSL_INITIAL_HANDSHAKE )
+        return( 0 );
+#endif
+
+    /* On a full handshake this state is only reached once our Finished
+     * has been written; on a resumed one it comes before, so rule that out */
+    if( ssl->state != MBEDTLS_SSL_SERVER_CHANGE_CIPHER_SPEC ||
+        ssl->handshake == NULL || ssl->handshake->resume != 0 ||
+        ssl->minor_ver < MBEDTLS_SSL_MINOR_VERSION_3 )
+        return( 0 );
+
+    if( ssl->transform_out == NULL ||
+        ( suite = ssl->transform_out->ciphersuite_info ) == NULL )
+        return( 0 );
+
+    if( suite->key_exchange != MBEDTLS_KEY_EXCHANGE_DHE_RSA &&
+        suite->key_exchange != MBEDTLS_KEY_EXCHANGE_DHE_PSK &&
+        suite->key_exchange != MBEDTLS_KEY_EXCHANGE_ECDHE_RSA &&
+        suite->key_exchange != MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA &&
+        suite->key_exchange != MBEDTLS_KEY_EXCHANGE_ECDHE_PSK )
+        return( 0 );
+
+    cipher_info = mbedtls_cipher_info_from_type( suite->cipher );
+    if( cipher_info == NULL ||
+        ( cipher_info->mode != MBEDTLS_MODE_GCM &&
+          cipher_info->mode != MBEDTLS_MODE_CCM ) )
+        return( 0 );
+
+    return( 1 );
+}
+#endif /* MBEDTLS_SSL_FALSE_START */
+
+/*
+ * Complete as much of the handshake as a write needs: everything, unless
+ * False Start lets us stop as soon as our Finished is on the wire.
+ */
+static int ssl_handshake_for_write( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_FALSE_START)
+    if( ssl->conf->false_start == MBEDTLS_SSL_FALSE_START_ENABLED )
+    {
+        int ret;
+
+        while( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            if( ssl_false_start_ready( ssl ) )
+            {
+                MBEDTLS_SSL_DEBUG_MSG( 2, ( "false start: writing early data" ) );
+                return( 0 );
+            }
+
+            if( ( ret = mbedtls_ssl_handshake_step( ssl ) ) != 0 )
+                return( ret );
+        }
+
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_FALSE_START */
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return( mbedtls_ssl_handshake( ssl ) );
+
+    return( 0 );
+}
+
 /*
  * Write application data (public-facing wrapper)
  */
@@ -6452,13 +9955,10 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
     }
 #endif
 
-    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    if( ( ret = ssl_handshake_for_write( ssl ) ) != 0 )
     {
-        if( ( ret = mbedtls_ssl_handshake( ssl ) ) != 0 )
-        {
-            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_handshake", ret );
-            return( ret );
-        }
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_handshake_for_write", ret );
+        return( ret );
     }
 
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
@@ -6472,6 +9972,96 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
     return( ret );
 }
 
+/*
+ * Write application data gathered from several fragments
+ */
+int mbedtls_ssl_writev( mbedtls_ssl_context *ssl,
+                        const mbedtls_ssl_iovec *iov, size_t iovcnt )
+{
+    int ret;
+    size_t i, total = 0;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> writev" ) );
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if( ( ret = ssl_check_ctr_renegotiate( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_check_ctr_renegotiate", ret );
+        return( ret );
+    }
+#endif
+
+    if( ( ret = ssl_handshake_for_write( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_handshake_for_write", ret );
+        return( ret );
+    }
+
+    for( i = 0; i < iovcnt; i++ )
+        total += iov[i].len;
+
+#if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+    if( ssl->conf->cbc_record_splitting !=
+            MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED &&
+        total > 1 &&
+        ssl->minor_ver <= MBEDTLS_SSL_MINOR_VERSION_1 &&
+        mbedtls_cipher_get_cipher_mode( &ssl->transform_out->cipher_ctx_enc )
+                                == MBEDTLS_MODE_CBC )
+    {
+        if( ssl->split_done == 0 )
+        {
+            /* Write the first byte of the first non-empty fragment alone */
+            for( i = 0; i < iovcnt && iov[i].len == 0; i++ )
+                ;
+
+            if( ( ret = ssl_write_real( ssl, iov[i].base, 1 ) ) <= 0 )
+                return( ret );
+            ssl->split_done = 1;
+        }
+
+        if( ( ret = ssl_write_gather( ssl, iov, iovcnt, 1 ) ) <= 0 )
+            return( ret );
+        ssl->split_done = 0;
+
+        MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= writev" ) );
+
+        return( ret + 1 );
+    }
+#endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+
+    ret = ssl_write_gather( ssl, iov, iovcnt, 0 );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= writev" ) );
+
+    return( ret );
+}
+
+/*
+ * Transmit records held back for coalescing, if any
+ */
+int mbedtls_ssl_flush( mbedtls_ssl_context *ssl )
+{
+    int ret;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> flush" ) );
+
+    if( ssl->out_buf != NULL &&
+        ( ssl->out_left != 0
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+          || ssl->out_drain_len != 0
+#endif
+        ) &&
+        ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+        return( ret );
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= flush" ) );
+
+    return( 0 );
+}
+
 /*
  * Notify the peer that the connection is being closed
  */
@@ -6481,7 +10071,8 @@ int mbedtls_ssl_close_notify( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write close notify" ) );
 
-    if( ssl->out_left != 0 )
+    /* Held records go out together with the alert below */
+    if( ssl->out_left != 0 && ssl->out_held == 0 )
         return( mbedtls_ssl_flush_output( ssl ) );
 
     if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER )
@@ -6500,6 +10091,63 @@ int mbedtls_ssl_close_notify( mbedtls_ssl_context *ssl )
     return( 0 );
 }
 
+/*
+ * Free the I/O buffers of an idle connection; they are transparently
+ * re-allocated by the next read or write. Best effort: a buffer that
+ * still holds data (or a running handshake) is simply kept.
+ */
+void mbedtls_ssl_release_buffers( mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    /* The retransmission code writes to the buffers directly */
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return;
+#endif
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return;
+
+    if( ssl->in_buf != NULL &&
+        ssl->in_left == 0 && ssl->in_offt == NULL && ssl->record_read == 0 )
+    {
+        /* With TLS the incoming record counter lives in the buffer */
+        memcpy( ssl->saved_in_ctr, ssl->in_ctr, 8 );
+
+        mbedtls_zeroize( ssl->in_buf, ssl->in_buf_len );
+        mbedtls_free( ssl->in_buf );
+        ssl->in_buf = NULL;
+        ssl->in_buf_len = 0;
+        ssl->in_ctr = ssl->in_hdr = ssl->in_len = NULL;
+        ssl->in_iv = ssl->in_msg = NULL;
+    }
+
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    if( ssl->out_spare != NULL && ssl->out_drain_len == 0 )
+    {
+        mbedtls_zeroize( ssl->out_spare, ssl->out_spare_len );
+        mbedtls_free( ssl->out_spare );
+        ssl->out_spare = NULL;
+        ssl->out_spare_len = 0;
+    }
+#endif
+
+    if( ssl->out_buf != NULL && ssl->out_left == 0
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+        && ssl->out_drain_len == 0
+#endif
+      )
+    {
+        memcpy( ssl->saved_out_ctr, ssl->out_ctr, 8 );
+
+        mbedtls_zeroize( ssl->out_buf, ssl->out_buf_len );
+        mbedtls_free( ssl->out_buf );
+        ssl->out_buf = NULL;
+        ssl->out_buf_len = 0;
+        ssl->out_ctr = ssl->out_hdr = ssl->out_len = NULL;
+        ssl->out_iv = ssl->out_msg = NULL;
+    }
+}
+
 void mbedtls_ssl_transform_free( mbedtls_ssl_transform *transform )
 {
     if( transform == NULL )
@@ -6527,6 +10175,7 @@ static void ssl_key_cert_free( mbedtls_ssl_key_cert *key_cert )
     while( cur != NULL )
     {
         next = cur->next;
+        mbedtls_free( cur->cert_wire );
         mbedtls_free( cur );
         cur = next;
     }
@@ -6559,11 +10208,6 @@ void mbedtls_ssl_handshake_free( mbedtls_ssl_handshake_params *handshake )
     mbedtls_ecdh_free( &handshake->ecdh_ctx );
 #endif
 
-#if defined(MBEDTLS_ECDH_C) || defined(MBEDTLS_ECDSA_C)
-    /* explicit void pointer cast for buggy MS compiler */
-    mbedtls_free( (void *) handshake->curves );
-#endif
-
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__PSK_ENABLED)
     if( handshake->psk != NULL )
     {
@@ -6592,8 +10236,14 @@ void mbedtls_ssl_handshake_free( mbedtls_ssl_handshake_params *handshake )
 #endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_SERVER_NAME_INDICATION */
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
+    {
+        size_t i;
+
+        for( i = 0; i < MBEDTLS_SSL_DTLS_MAX_BUFFERED_HS; i++ )
+            mbedtls_free( handshake->future_msg[i] );
+    }
     mbedtls_free( handshake->verify_cookie );
-    mbedtls_free( handshake->hs_msg );
+    mbedtls_free( handshake->hs_arena );
     ssl_flight_free( handshake->flight );
 #endif
 
@@ -6632,16 +10282,38 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
 
     if( ssl->out_buf != NULL )
     {
-        mbedtls_zeroize( ssl->out_buf, MBEDTLS_SSL_BUFFER_LEN );
+        mbedtls_zeroize( ssl->out_buf, ssl->out_buf_len );
         mbedtls_free( ssl->out_buf );
     }
 
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    if( ssl->out_spare != NULL )
+    {
+        mbedtls_zeroize( ssl->out_spare, ssl->out_spare_len );
+        mbedtls_free( ssl->out_spare );
+    }
+#endif
+
     if( ssl->in_buf != NULL )
     {
-        mbedtls_zeroize( ssl->in_buf, MBEDTLS_SSL_BUFFER_LEN );
+        mbedtls_zeroize( ssl->in_buf, ssl->in_buf_len );
         mbedtls_free( ssl->in_buf );
     }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    {
+        size_t i;
+        for( i = 0; i < MBEDTLS_SSL_DGRAM_BATCH - 1; i++ )
+        {
+            if( ssl->dgram_held[i] != NULL )
+            {
+                mbedtls_zeroize( ssl->dgram_held[i], MBEDTLS_SSL_BUFFER_LEN );
+                mbedtls_free( ssl->dgram_held[i] );
+            }
+        }
+    }
+#endif
+
 #if defined(MBEDTLS_ZLIB_SUPPORT)
     if( ssl->compress_buf != NULL )
     {
@@ -6653,24 +10325,38 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
     if( ssl->transform )
     {
         mbedtls_ssl_transform_free( ssl->transform );
-        mbedtls_free( ssl->transform );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM, ssl->transform );
+    }
+
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+    if( ssl->transform_pool )
+    {
+        mbedtls_ssl_transform_free( ssl->transform_pool );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM,
+                          ssl->transform_pool );
     }
+#endif
 
     if( ssl->handshake )
     {
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+        ssl_async_cancel( ssl );
+#endif
         mbedtls_ssl_handshake_free( ssl->handshake );
         mbedtls_ssl_transform_free( ssl->transform_negotiate );
         mbedtls_ssl_session_free( ssl->session_negotiate );
 
-        mbedtls_free( ssl->handshake );
-        mbedtls_free( ssl->transform_negotiate );
-        mbedtls_free( ssl->session_negotiate );
+        ssl_pool_release( ssl->conf, SSL_POOL_HANDSHAKE, ssl->handshake );
+        ssl_pool_release( ssl->conf, SSL_POOL_TRANSFORM,
+                          ssl->transform_negotiate );
+        ssl_pool_release( ssl->conf, SSL_POOL_SESSION,
+                          ssl->session_negotiate );
     }
 
     if( ssl->session )
     {
         mbedtls_ssl_session_free( ssl->session );
-        mbedtls_free( ssl->session );
+        ssl_pool_release( ssl->conf, SSL_POOL_SESSION, ssl->session );
     }
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
@@ -6739,6 +10425,9 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
     int ret;
 #endif
 
+    if( conf->frozen )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
     /* Use the functions here so that they are covered in tests,
      * but otherwise access member directly for efficiency */
     mbedtls_ssl_conf_endpoint( conf, endpoint );
@@ -6796,9 +10485,8 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_SRV_C)
             if( endpoint == MBEDTLS_SSL_IS_SERVER )
             {
-                if( ( ret = mbedtls_ssl_conf_dh_param( conf,
-                                MBEDTLS_DHM_RFC5114_MODP_2048_P,
-                                MBEDTLS_DHM_RFC5114_MODP_2048_G ) ) != 0 )
+                if( ( ret = mbedtls_ssl_conf_dh_group( conf,
+                                MBEDTLS_DHM_GROUP_RFC5114_2048 ) ) != 0 )
                 {
                     return( ret );
                 }
@@ -6819,22 +10507,19 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
             conf->max_major_ver = MBEDTLS_SSL_MAX_MAJOR_VERSION;
             conf->max_minor_ver = MBEDTLS_SSL_MAX_MINOR_VERSION;
 
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_0] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_1] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_2] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_3] =
-                                   ssl_preset_suiteb_ciphersuites;
+            mbedtls_ssl_conf_ciphersuites( conf,
+                                           ssl_preset_suiteb_ciphersuites );
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
             conf->cert_profile = &mbedtls_x509_crt_profile_suiteb;
 #endif
 
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__SIGNATURE_ENABLED)
-            conf->sig_hashes = ssl_preset_suiteb_hashes;
+            mbedtls_ssl_conf_sig_hashes( conf, ssl_preset_suiteb_hashes );
 #endif
 
 #if defined(MBEDTLS_ECP_C)
-            conf->curve_list = ssl_preset_suiteb_curves;
+            mbedtls_ssl_conf_curves( conf, ssl_preset_suiteb_curves );
 #endif
             break;
 
@@ -6852,22 +10537,19 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
                 conf->min_minor_ver = MBEDTLS_SSL_MINOR_VERSION_2;
 #endif
 
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_0] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_1] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_2] =
-            conf->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_3] =
-                                   mbedtls_ssl_list_ciphersuites();
+            mbedtls_ssl_conf_ciphersuites( conf,
+                                           mbedtls_ssl_list_ciphersuites() );
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
             conf->cert_profile = &mbedtls_x509_crt_profile_default;
 #endif
 
 #if defined(MBEDTLS_KEY_EXCHANGE__SOME__SIGNATURE_ENABLED)
-            conf->sig_hashes = mbedtls_md_list();
+            mbedtls_ssl_conf_sig_hashes( conf, mbedtls_md_list() );
 #endif
 
 #if defined(MBEDTLS_ECP_C)
-            conf->curve_list = mbedtls_ecp_grp_id_list();
+            mbedtls_ssl_conf_curves( conf, mbedtls_ecp_grp_id_list() );
 #endif
 
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
@@ -6878,6 +10560,22 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
     return( 0 );
 }
 
+/*
+ * Declare a config complete: reject further changes so that sharing it
+ * between threads without locking is safe by construction
+ */
+int mbedtls_ssl_config_freeze( mbedtls_ssl_config *conf )
+{
+    /* A config without RNG can't handshake; catch that now rather than
+     * on the first connection */
+    if( conf->f_rng == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    conf->frozen = 1;
+
+    return( 0 );
+}
+
 /*
  * Free mbedtls_ssl_config
  */
@@ -6904,6 +10602,12 @@ void mbedtls_ssl_config_free( mbedtls_ssl_config *conf )
     ssl_key_cert_free( conf->key_cert );
 #endif
 
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+    ssl_sni_table_free( conf );
+#endif
+
+    ssl_conf_free_ciphersuite_info( conf );
+
     mbedtls_zeroize( conf, sizeof( mbedtls_ssl_config ) );
 }
 
@@ -7013,14 +10717,8 @@ unsigned char mbedtls_ssl_hash_from_md_alg( int md )
  */
 int mbedtls_ssl_check_curve( const mbedtls_ssl_context *ssl, mbedtls_ecp_group_id grp_id )
 {
-    const mbedtls_ecp_group_id *gid;
-
-    if( ssl->conf->curve_list == NULL )
-        return( -1 );
-
-    for( gid = ssl->conf->curve_list; *gid != MBEDTLS_ECP_DP_NONE; gid++ )
-        if( *gid == grp_id )
-            return( 0 );
+    if( ssl->conf->curve_mask & ( (uint32_t) 1 << grp_id ) )
+        return( 0 );
 
     return( -1 );
 }
@@ -7034,14 +10732,11 @@ int mbedtls_ssl_check_curve( const mbedtls_ssl_context *ssl, mbedtls_ecp_group_i
 int mbedtls_ssl_check_sig_hash( const mbedtls_ssl_context *ssl,
                                 mbedtls_md_type_t md )
 {
-    const int *cur;
+    unsigned char hash = mbedtls_ssl_hash_from_md_alg( md );
 
-    if( ssl->conf->sig_hashes == NULL )
-        return( -1 );
-
-    for( cur = ssl->conf->sig_hashes; *cur != MBEDTLS_MD_NONE; cur++ )
-        if( *cur == (int) md )
-            return( 0 );
+    if( hash != MBEDTLS_SSL_HASH_NONE &&
+        ssl->conf->sig_hash_rank[hash] != 0 )
+        return( 0 );
 
     return( -1 );
 }
@@ -37,6 +37,9 @@ static void threading_mutex_init_pthread( mbedtls_threading_mutex_t *mutex )
         return;
 
     mutex->is_valid = pthread_mutex_init( &mutex->mutex, NULL ) == 0;
+#if defined(MBEDTLS_THREADING_SPIN)
+    mutex->spin = 0;
+#endif
 }
 
 static void threading_mutex_free_pthread( mbedtls_threading_mutex_t *mutex )
@@ -47,6 +50,59 @@ static void threading_mutex_free_pthread( mbedtls_threading_mutex_t *mutex )
     (void) pthread_mutex_destroy( &mutex->mutex );
 }
 
+#if defined(MBEDTLS_THREADING_SPIN)
+
+#if defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+#define THREADING_SPIN_PAUSE()  __asm__ __volatile__( "pause" )
+#elif defined(__GNUC__) && ( defined(__arm__) || defined(__aarch64__) )
+#define THREADING_SPIN_PAUSE()  __asm__ __volatile__( "yield" )
+#else
+#define THREADING_SPIN_PAUSE()  do { } while( 0 )
+#endif
+
+/* Never spin longer than this many trylock attempts */
+#define THREADING_SPIN_MAX      128
+
+static int threading_mutex_lock_pthread( mbedtls_threading_mutex_t *mutex )
+{
+    int limit, spins;
+
+    if( mutex == NULL || ! mutex->is_valid )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    /*
+     * The critical sections in this library hold their locks for far
+     * less than a futex sleep and wakeup cost, so try to ride out
+     * contention with a bounded trylock loop before blocking. The bound
+     * follows how long acquisition took recently; mutex->spin is read
+     * and updated without synchronization, which only perturbs the
+     * heuristic, never correctness.
+     */
+    limit = mutex->spin * 2 + 10;
+    if( limit > THREADING_SPIN_MAX )
+        limit = THREADING_SPIN_MAX;
+
+    for( spins = 0; spins < limit; spins++ )
+    {
+        if( pthread_mutex_trylock( &mutex->mutex ) == 0 )
+        {
+            mutex->spin += ( spins - mutex->spin ) / 8;
+            return( 0 );
+        }
+
+        THREADING_SPIN_PAUSE();
+    }
+
+    mutex->spin += ( limit - mutex->spin ) / 8;
+
+    if( pthread_mutex_lock( &mutex->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( 0 );
+}
+
+#else /* MBEDTLS_THREADING_SPIN */
+
 static int threading_mutex_lock_pthread( mbedtls_threading_mutex_t *mutex )
 {
     if( mutex == NULL || ! mutex->is_valid )
@@ -58,6 +114,8 @@ static int threading_mutex_lock_pthread( mbedtls_threading_mutex_t *mutex )
     return( 0 );
 }
 
+#endif /* MBEDTLS_THREADING_SPIN */
+
 static int threading_mutex_unlock_pthread( mbedtls_threading_mutex_t *mutex )
 {
     if( mutex == NULL || ! mutex->is_valid )
@@ -74,10 +132,75 @@ void (*mbedtls_mutex_free)( mbedtls_threading_mutex_t * ) = threading_mutex_free
 int (*mbedtls_mutex_lock)( mbedtls_threading_mutex_t * ) = threading_mutex_lock_pthread;
 int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t * ) = threading_mutex_unlock_pthread;
 
+void mbedtls_rwlock_init( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return;
+
+    rwlock->is_valid = pthread_rwlock_init( &rwlock->rwlock, NULL ) == 0;
+}
+
+void mbedtls_rwlock_free( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return;
+
+    (void) pthread_rwlock_destroy( &rwlock->rwlock );
+}
+
+int mbedtls_rwlock_rdlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL || ! rwlock->is_valid )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( pthread_rwlock_rdlock( &rwlock->rwlock ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( 0 );
+}
+
+int mbedtls_rwlock_wrlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL || ! rwlock->is_valid )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( pthread_rwlock_wrlock( &rwlock->rwlock ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( 0 );
+}
+
+int mbedtls_rwlock_unlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL || ! rwlock->is_valid )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( pthread_rwlock_unlock( &rwlock->rwlock ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( 0 );
+}
+
+int mbedtls_once( mbedtls_threading_once_t *once,
+                  void (*init_routine)( void ) )
+{
+    if( once == NULL || init_routine == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( pthread_once( once, init_routine ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+
+    return( 0 );
+}
+
 /*
  * With phtreads we can statically initialize mutexes
  */
+#if defined(MBEDTLS_THREADING_SPIN)
+#define MUTEX_INIT  = { PTHREAD_MUTEX_INITIALIZER, 1, 0 }
+#else
 #define MUTEX_INIT  = { PTHREAD_MUTEX_INITIALIZER, 1 }
+#endif
 
 #endif /* MBEDTLS_THREADING_PTHREAD */
 
@@ -98,6 +221,72 @@ void (*mbedtls_mutex_free)( mbedtls_threading_mutex_t * ) = threading_mutex_dumm
 int (*mbedtls_mutex_lock)( mbedtls_threading_mutex_t * ) = threading_mutex_fail;
 int (*mbedtls_mutex_unlock)( mbedtls_threading_mutex_t * ) = threading_mutex_fail;
 
+/*
+ * Read-write locks and once objects on top of the alternate mutex
+ * callbacks: correct, but readers exclude each other.
+ */
+static mbedtls_threading_mutex_t threading_once_mutex;
+
+void mbedtls_rwlock_init( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return;
+
+    mbedtls_mutex_init( &rwlock->mutex );
+}
+
+void mbedtls_rwlock_free( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return;
+
+    mbedtls_mutex_free( &rwlock->mutex );
+}
+
+int mbedtls_rwlock_rdlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    return( mbedtls_mutex_lock( &rwlock->mutex ) );
+}
+
+int mbedtls_rwlock_wrlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    return( mbedtls_mutex_lock( &rwlock->mutex ) );
+}
+
+int mbedtls_rwlock_unlock( mbedtls_threading_rwlock_t *rwlock )
+{
+    if( rwlock == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    return( mbedtls_mutex_unlock( &rwlock->mutex ) );
+}
+
+int mbedtls_once( mbedtls_threading_once_t *once,
+                  void (*init_routine)( void ) )
+{
+    int ret;
+
+    if( once == NULL || init_routine == NULL )
+        return( MBEDTLS_ERR_THREADING_BAD_INPUT_DATA );
+
+    if( ( ret = mbedtls_mutex_lock( &threading_once_mutex ) ) != 0 )
+        return( ret );
+
+    if( once->done == 0 )
+    {
+        init_routine();
+        once->done = 1;
+    }
+
+    return( mbedtls_mutex_unlock( &threading_once_mutex ) );
+}
+
 /*
  * Set functions pointers and initialize global mutexes
  */
@@ -113,6 +302,8 @@ void mbedtls_threading_set_alt( void (*mutex_init)( mbedtls_threading_mutex_t *
 
     mbedtls_mutex_init( &mbedtls_threading_readdir_mutex );
     mbedtls_mutex_init( &mbedtls_threading_gmtime_mutex );
+    mbedtls_mutex_init( &mbedtls_threading_ecp_mutex );
+    mbedtls_mutex_init( &threading_once_mutex );
 }
 
 /*
@@ -122,6 +313,8 @@ void mbedtls_threading_free_alt( void )
 {
     mbedtls_mutex_free( &mbedtls_threading_readdir_mutex );
     mbedtls_mutex_free( &mbedtls_threading_gmtime_mutex );
+    mbedtls_mutex_free( &mbedtls_threading_ecp_mutex );
+    mbedtls_mutex_free( &threading_once_mutex );
 }
 #endif /* MBEDTLS_THREADING_ALT */
 
@@ -133,5 +326,6 @@ void mbedtls_threading_free_alt( void )
 #endif
 mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex MUTEX_INIT;
 mbedtls_threading_mutex_t mbedtls_threading_gmtime_mutex MUTEX_INIT;
+mbedtls_threading_mutex_t mbedtls_threading_ecp_mutex MUTEX_INIT;
 
 #endif /* MBEDTLS_THREADING_C */
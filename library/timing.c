@@ -279,13 +279,36 @@ void mbedtls_set_alarm( int seconds )
 
 #else /* _WIN32 && !EFIX64 && !EFI32 */
 
+#if defined(MBEDTLS_TIMING_COARSE) && defined(CLOCK_MONOTONIC_COARSE)
+/*
+ * The coarse clock is the kernel's own periodic tick, published through
+ * the vDSO: reading it is a memory load, not a syscall, at the price of
+ * tick (1-4 ms) resolution. That suits the millisecond-granularity DTLS
+ * retransmit timers that poll mbedtls_timing_get_timer() per packet.
+ */
+static void timing_get_time( struct timeval *tv )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC_COARSE, &ts );
+
+    tv->tv_sec  = ts.tv_sec;
+    tv->tv_usec = ts.tv_nsec / 1000;
+}
+#else
+static void timing_get_time( struct timeval *tv )
+{
+    gettimeofday( tv, NULL );
+}
+#endif /* MBEDTLS_TIMING_COARSE && CLOCK_MONOTONIC_COARSE */
+
 unsigned long mbedtls_timing_get_timer( struct mbedtls_timing_hr_time *val, int reset )
 {
     unsigned long delta;
     struct timeval offset;
     struct _hr_time *t = (struct _hr_time *) val;
 
-    gettimeofday( &offset, NULL );
+    timing_get_time( &offset );
 
     if( reset )
     {
@@ -351,8 +374,106 @@ int mbedtls_timing_get_delay( void *data )
     return( 0 );
 }
 
+/*
+ * Virtual time. The delay logic mirrors mbedtls_timing_set/get_delay
+ * above, but elapsed time is read off an application-driven clock, so a
+ * protocol simulation can step through retransmission timeouts without
+ * sleeping through them.
+ */
+void mbedtls_timing_virt_clock_init( mbedtls_timing_virt_clock *clock )
+{
+    clock->ms = 0;
+}
+
+void mbedtls_timing_virt_advance( mbedtls_timing_virt_clock *clock,
+                                  uint32_t ms )
+{
+    clock->ms += ms;
+}
+
+void mbedtls_timing_virt_delay_init( mbedtls_timing_virt_delay_context *ctx,
+                                     mbedtls_timing_virt_clock *clock )
+{
+    ctx->clock = clock;
+    ctx->snapshot = 0;
+    ctx->int_ms = 0;
+    ctx->fin_ms = 0;
+}
+
+void mbedtls_timing_virt_set_delay( void *data, uint32_t int_ms,
+                                    uint32_t fin_ms )
+{
+    mbedtls_timing_virt_delay_context *ctx =
+        (mbedtls_timing_virt_delay_context *) data;
+
+    ctx->int_ms = int_ms;
+    ctx->fin_ms = fin_ms;
+
+    if( fin_ms != 0 )
+        ctx->snapshot = ctx->clock->ms;
+}
+
+int mbedtls_timing_virt_get_delay( void *data )
+{
+    mbedtls_timing_virt_delay_context *ctx =
+        (mbedtls_timing_virt_delay_context *) data;
+    uint64_t elapsed_ms;
+
+    if( ctx->fin_ms == 0 )
+        return( -1 );
+
+    elapsed_ms = ctx->clock->ms - ctx->snapshot;
+
+    if( elapsed_ms >= ctx->fin_ms )
+        return( 2 );
+
+    if( elapsed_ms >= ctx->int_ms )
+        return( 1 );
+
+    return( 0 );
+}
+
 #endif /* !MBEDTLS_TIMING_ALT */
 
+#if defined(MBEDTLS_TIMING_TRACE)
+/*
+ * Trace ring for the instrumented crypto operations. The ring belongs to
+ * the application; we only remember where it is and keep a running write
+ * index. Writes are a store and an index increment, cheap enough for the
+ * hot paths they sit in, and records are overwritten oldest-first when
+ * the reader falls behind.
+ */
+static mbedtls_timing_trace_record *trace_ring = NULL;
+static size_t trace_ring_len = 0;
+static size_t trace_count = 0;
+
+void mbedtls_timing_trace_setup( mbedtls_timing_trace_record *ring,
+                                 size_t len )
+{
+    trace_ring = NULL;
+    trace_count = 0;
+    trace_ring_len = len;
+
+    if( len != 0 )
+        trace_ring = ring;
+}
+
+size_t mbedtls_timing_trace_count( void )
+{
+    return( trace_count );
+}
+
+void mbedtls_timing_trace( int op, unsigned long cycles )
+{
+    if( trace_ring == NULL )
+        return;
+
+    trace_ring[trace_count % trace_ring_len].op = op;
+    trace_ring[trace_count % trace_ring_len].cycles = cycles;
+    trace_count++;
+}
+#endif /* MBEDTLS_TIMING_TRACE */
+
 #if defined(MBEDTLS_SELF_TEST)
 
 /*
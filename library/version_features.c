@@ -157,6 +157,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
     "MBEDTLS_ENTROPY_HARDWARE_ALT",
 #endif /* MBEDTLS_ENTROPY_HARDWARE_ALT */
+#if defined(MBEDTLS_ENTROPY_RDSEED)
+    "MBEDTLS_ENTROPY_RDSEED",
+#endif /* MBEDTLS_ENTROPY_RDSEED */
 #if defined(MBEDTLS_AES_ROM_TABLES)
     "MBEDTLS_AES_ROM_TABLES",
 #endif /* MBEDTLS_AES_ROM_TABLES */
@@ -172,9 +175,15 @@ static const char *features[] = {
 #if defined(MBEDTLS_CIPHER_MODE_CTR)
     "MBEDTLS_CIPHER_MODE_CTR",
 #endif /* MBEDTLS_CIPHER_MODE_CTR */
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+    "MBEDTLS_CIPHER_MODE_XTS",
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
 #if defined(MBEDTLS_CIPHER_NULL_CIPHER)
     "MBEDTLS_CIPHER_NULL_CIPHER",
 #endif /* MBEDTLS_CIPHER_NULL_CIPHER */
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH)
+    "MBEDTLS_SINGLE_BACKEND_DISPATCH",
+#endif /* MBEDTLS_SINGLE_BACKEND_DISPATCH */
 #if defined(MBEDTLS_CIPHER_PADDING_PKCS7)
     "MBEDTLS_CIPHER_PADDING_PKCS7",
 #endif /* MBEDTLS_CIPHER_PADDING_PKCS7 */
@@ -232,6 +241,12 @@ static const char *features[] = {
 #if defined(MBEDTLS_ECP_NIST_OPTIM)
     "MBEDTLS_ECP_NIST_OPTIM",
 #endif /* MBEDTLS_ECP_NIST_OPTIM */
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+    "MBEDTLS_ECP_COMB_TABLE_CACHE",
+#endif /* MBEDTLS_ECP_COMB_TABLE_CACHE */
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+    "MBEDTLS_ECP_RESTARTABLE",
+#endif /* MBEDTLS_ECP_RESTARTABLE */
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
     "MBEDTLS_ECDSA_DETERMINISTIC",
 #endif /* MBEDTLS_ECDSA_DETERMINISTIC */
@@ -277,6 +292,12 @@ static const char *features[] = {
 #if defined(MBEDTLS_FS_IO)
     "MBEDTLS_FS_IO",
 #endif /* MBEDTLS_FS_IO */
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+    "MBEDTLS_CTR_DRBG_FORK_CHECK",
+#endif /* MBEDTLS_CTR_DRBG_FORK_CHECK */
+#if defined(MBEDTLS_GCM_LARGETABLE)
+    "MBEDTLS_GCM_LARGETABLE",
+#endif /* MBEDTLS_GCM_LARGETABLE */
 #if defined(MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES)
     "MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES",
 #endif /* MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES */
@@ -286,12 +307,27 @@ static const char *features[] = {
 #if defined(MBEDTLS_ENTROPY_FORCE_SHA256)
     "MBEDTLS_ENTROPY_FORCE_SHA256",
 #endif /* MBEDTLS_ENTROPY_FORCE_SHA256 */
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+    "MBEDTLS_ENTROPY_PREFETCH",
+#endif /* MBEDTLS_ENTROPY_PREFETCH */
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+    "MBEDTLS_MD_HMAC_CACHE",
+#endif /* MBEDTLS_MD_HMAC_CACHE */
 #if defined(MBEDTLS_MEMORY_DEBUG)
     "MBEDTLS_MEMORY_DEBUG",
 #endif /* MBEDTLS_MEMORY_DEBUG */
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     "MBEDTLS_MEMORY_BACKTRACE",
 #endif /* MBEDTLS_MEMORY_BACKTRACE */
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    "MBEDTLS_MEMORY_TAGGING",
+#endif /* MBEDTLS_MEMORY_TAGGING */
+#if defined(MBEDTLS_MEMORY_ARENAS)
+    "MBEDTLS_MEMORY_ARENAS",
+#endif /* MBEDTLS_MEMORY_ARENAS */
+#if defined(MBEDTLS_MPI_MUL_WIDE)
+    "MBEDTLS_MPI_MUL_WIDE",
+#endif /* MBEDTLS_MPI_MUL_WIDE */
 #if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
     "MBEDTLS_PK_RSA_ALT_SUPPORT",
 #endif /* MBEDTLS_PK_RSA_ALT_SUPPORT */
@@ -319,6 +355,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_SSL_DEBUG_ALL)
     "MBEDTLS_SSL_DEBUG_ALL",
 #endif /* MBEDTLS_SSL_DEBUG_ALL */
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+    "MBEDTLS_SSL_ECDH_REUSE",
+#endif /* MBEDTLS_SSL_ECDH_REUSE */
 #if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
     "MBEDTLS_SSL_ENCRYPT_THEN_MAC",
 #endif /* MBEDTLS_SSL_ENCRYPT_THEN_MAC */
@@ -328,12 +367,30 @@ static const char *features[] = {
 #if defined(MBEDTLS_SSL_FALLBACK_SCSV)
     "MBEDTLS_SSL_FALLBACK_SCSV",
 #endif /* MBEDTLS_SSL_FALLBACK_SCSV */
+#if defined(MBEDTLS_SSL_FALSE_START)
+    "MBEDTLS_SSL_FALSE_START",
+#endif /* MBEDTLS_SSL_FALSE_START */
+#if defined(MBEDTLS_SSL_HS_TIMING)
+    "MBEDTLS_SSL_HS_TIMING",
+#endif /* MBEDTLS_SSL_HS_TIMING */
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
     "MBEDTLS_SSL_HW_RECORD_ACCEL",
 #endif /* MBEDTLS_SSL_HW_RECORD_ACCEL */
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+    "MBEDTLS_SSL_OUT_DOUBLE_BUFFER",
+#endif /* MBEDTLS_SSL_OUT_DOUBLE_BUFFER */
 #if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
     "MBEDTLS_SSL_CBC_RECORD_SPLITTING",
 #endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+    "MBEDTLS_SSL_RECORD_PADDING",
+#endif /* MBEDTLS_SSL_RECORD_PADDING */
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+    "MBEDTLS_SSL_RECORD_KEY_EXPORT",
+#endif /* MBEDTLS_SSL_RECORD_KEY_EXPORT */
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+    "MBEDTLS_SSL_RECORD_SPECIALIZE",
+#endif /* MBEDTLS_SSL_RECORD_SPECIALIZE */
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     "MBEDTLS_SSL_RENEGOTIATION",
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
@@ -364,6 +421,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_SSL_ALPN)
     "MBEDTLS_SSL_ALPN",
 #endif /* MBEDTLS_SSL_ALPN */
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+    "MBEDTLS_SSL_ASYNC_PRIVATE",
+#endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
 #if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
     "MBEDTLS_SSL_DTLS_ANTI_REPLAY",
 #endif /* MBEDTLS_SSL_DTLS_ANTI_REPLAY */
@@ -379,15 +439,33 @@ static const char *features[] = {
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     "MBEDTLS_SSL_SERVER_NAME_INDICATION",
 #endif /* MBEDTLS_SSL_SERVER_NAME_INDICATION */
+#if defined(MBEDTLS_SSL_STATS)
+    "MBEDTLS_SSL_STATS",
+#endif /* MBEDTLS_SSL_STATS */
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
     "MBEDTLS_SSL_TRUNCATED_HMAC",
 #endif /* MBEDTLS_SSL_TRUNCATED_HMAC */
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+    "MBEDTLS_SSL_TRANSFORM_POOL",
+#endif /* MBEDTLS_SSL_TRANSFORM_POOL */
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+    "MBEDTLS_SSL_HANDSHAKE_POOL",
+#endif /* MBEDTLS_SSL_HANDSHAKE_POOL */
 #if defined(MBEDTLS_THREADING_ALT)
     "MBEDTLS_THREADING_ALT",
 #endif /* MBEDTLS_THREADING_ALT */
 #if defined(MBEDTLS_THREADING_PTHREAD)
     "MBEDTLS_THREADING_PTHREAD",
 #endif /* MBEDTLS_THREADING_PTHREAD */
+#if defined(MBEDTLS_THREADING_SPIN)
+    "MBEDTLS_THREADING_SPIN",
+#endif /* MBEDTLS_THREADING_SPIN */
+#if defined(MBEDTLS_TIMING_COARSE)
+    "MBEDTLS_TIMING_COARSE",
+#endif /* MBEDTLS_TIMING_COARSE */
+#if defined(MBEDTLS_TIMING_TRACE)
+    "MBEDTLS_TIMING_TRACE",
+#endif /* MBEDTLS_TIMING_TRACE */
 #if defined(MBEDTLS_VERSION_FEATURES)
     "MBEDTLS_VERSION_FEATURES",
 #endif /* MBEDTLS_VERSION_FEATURES */
@@ -397,6 +475,18 @@ static const char *features[] = {
 #if defined(MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION)
     "MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION",
 #endif /* MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION */
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+    "MBEDTLS_X509_CRT_LAZY_EXTENSIONS",
+#endif /* MBEDTLS_X509_CRT_LAZY_EXTENSIONS */
+#if defined(MBEDTLS_X509_CRT_ARENA)
+    "MBEDTLS_X509_CRT_ARENA",
+#endif /* MBEDTLS_X509_CRT_ARENA */
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+    "MBEDTLS_X509_CRT_HOST_TABLE",
+#endif /* MBEDTLS_X509_CRT_HOST_TABLE */
+#if defined(MBEDTLS_X509_DN_CACHE)
+    "MBEDTLS_X509_DN_CACHE",
+#endif /* MBEDTLS_X509_DN_CACHE */
 #if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
     "MBEDTLS_X509_CHECK_KEY_USAGE",
 #endif /* MBEDTLS_X509_CHECK_KEY_USAGE */
@@ -412,6 +502,12 @@ static const char *features[] = {
 #if defined(MBEDTLS_AESNI_C)
     "MBEDTLS_AESNI_C",
 #endif /* MBEDTLS_AESNI_C */
+#if defined(MBEDTLS_ARMCE_C)
+    "MBEDTLS_ARMCE_C",
+#endif /* MBEDTLS_ARMCE_C */
+#if defined(MBEDTLS_AESCT_C)
+    "MBEDTLS_AESCT_C",
+#endif /* MBEDTLS_AESCT_C */
 #if defined(MBEDTLS_AES_C)
     "MBEDTLS_AES_C",
 #endif /* MBEDTLS_AES_C */
@@ -442,6 +538,12 @@ static const char *features[] = {
 #if defined(MBEDTLS_CERTS_C)
     "MBEDTLS_CERTS_C",
 #endif /* MBEDTLS_CERTS_C */
+#if defined(MBEDTLS_CHACHA20_C)
+    "MBEDTLS_CHACHA20_C",
+#endif /* MBEDTLS_CHACHA20_C */
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    "MBEDTLS_CHACHAPOLY_C",
+#endif /* MBEDTLS_CHACHAPOLY_C */
 #if defined(MBEDTLS_CIPHER_C)
     "MBEDTLS_CIPHER_C",
 #endif /* MBEDTLS_CIPHER_C */
@@ -532,6 +634,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_PLATFORM_C)
     "MBEDTLS_PLATFORM_C",
 #endif /* MBEDTLS_PLATFORM_C */
+#if defined(MBEDTLS_POLY1305_C)
+    "MBEDTLS_POLY1305_C",
+#endif /* MBEDTLS_POLY1305_C */
 #if defined(MBEDTLS_RIPEMD160_C)
     "MBEDTLS_RIPEMD160_C",
 #endif /* MBEDTLS_RIPEMD160_C */
@@ -544,15 +649,36 @@ static const char *features[] = {
 #if defined(MBEDTLS_SHA256_C)
     "MBEDTLS_SHA256_C",
 #endif /* MBEDTLS_SHA256_C */
+#if defined(MBEDTLS_SHA256MB_C)
+    "MBEDTLS_SHA256MB_C",
+#endif /* MBEDTLS_SHA256MB_C */
 #if defined(MBEDTLS_SHA512_C)
     "MBEDTLS_SHA512_C",
 #endif /* MBEDTLS_SHA512_C */
+#if defined(MBEDTLS_SHANI_C)
+    "MBEDTLS_SHANI_C",
+#endif /* MBEDTLS_SHANI_C */
+#if defined(MBEDTLS_SSL_BIO_PAIR_C)
+    "MBEDTLS_SSL_BIO_PAIR_C",
+#endif /* MBEDTLS_SSL_BIO_PAIR_C */
 #if defined(MBEDTLS_SSL_CACHE_C)
     "MBEDTLS_SSL_CACHE_C",
 #endif /* MBEDTLS_SSL_CACHE_C */
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    "MBEDTLS_SSL_CACHE_SHM_C",
+#endif /* MBEDTLS_SSL_CACHE_SHM_C */
 #if defined(MBEDTLS_SSL_COOKIE_C)
     "MBEDTLS_SSL_COOKIE_C",
 #endif /* MBEDTLS_SSL_COOKIE_C */
+#if defined(MBEDTLS_SSL_DEMUX_C)
+    "MBEDTLS_SSL_DEMUX_C",
+#endif /* MBEDTLS_SSL_DEMUX_C */
+#if defined(MBEDTLS_SSL_PSK_STORE_C)
+    "MBEDTLS_SSL_PSK_STORE_C",
+#endif /* MBEDTLS_SSL_PSK_STORE_C */
+#if defined(MBEDTLS_SSL_SCHED_C)
+    "MBEDTLS_SSL_SCHED_C",
+#endif /* MBEDTLS_SSL_SCHED_C */
 #if defined(MBEDTLS_SSL_TICKET_C)
     "MBEDTLS_SSL_TICKET_C",
 #endif /* MBEDTLS_SSL_TICKET_C */
@@ -574,15 +700,30 @@ static const char *features[] = {
 #if defined(MBEDTLS_VERSION_C)
     "MBEDTLS_VERSION_C",
 #endif /* MBEDTLS_VERSION_C */
+#if defined(MBEDTLS_WARMUP_C)
+    "MBEDTLS_WARMUP_C",
+#endif /* MBEDTLS_WARMUP_C */
 #if defined(MBEDTLS_X509_USE_C)
     "MBEDTLS_X509_USE_C",
 #endif /* MBEDTLS_X509_USE_C */
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     "MBEDTLS_X509_CRT_PARSE_C",
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    "MBEDTLS_X509_CRT_CACHE_C",
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+#if defined(MBEDTLS_X509_TRUST_C)
+    "MBEDTLS_X509_TRUST_C",
+#endif /* MBEDTLS_X509_TRUST_C */
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+    "MBEDTLS_X509_VERIFY_CACHE_C",
+#endif /* MBEDTLS_X509_VERIFY_CACHE_C */
 #if defined(MBEDTLS_X509_CRL_PARSE_C)
     "MBEDTLS_X509_CRL_PARSE_C",
 #endif /* MBEDTLS_X509_CRL_PARSE_C */
+#if defined(MBEDTLS_X509_CRL_SET_C)
+    "MBEDTLS_X509_CRL_SET_C",
+#endif /* MBEDTLS_X509_CRL_SET_C */
 #if defined(MBEDTLS_X509_CSR_PARSE_C)
     "MBEDTLS_X509_CSR_PARSE_C",
 #endif /* MBEDTLS_X509_CSR_PARSE_C */
@@ -602,6 +743,1427 @@ static const char *features[] = {
     NULL
 };
 
+#if defined(MBEDTLS_VERSION_FEATURES)
+/*
+ * Packed presence bitmap, indexed by mbedtls_feature_t: identifier i is
+ * bit i % 8 of byte i / 8. Built at compile time from one 0/1 macro per
+ * feature so that a check is a single bit test.
+ */
+#if defined(MBEDTLS_HAVE_ASM)
+#define FB_MBEDTLS_HAVE_ASM 1
+#else
+#define FB_MBEDTLS_HAVE_ASM 0
+#endif
+#if defined(MBEDTLS_HAVE_SSE2)
+#define FB_MBEDTLS_HAVE_SSE2 1
+#else
+#define FB_MBEDTLS_HAVE_SSE2 0
+#endif
+#if defined(MBEDTLS_HAVE_TIME)
+#define FB_MBEDTLS_HAVE_TIME 1
+#else
+#define FB_MBEDTLS_HAVE_TIME 0
+#endif
+#if defined(MBEDTLS_HAVE_TIME_DATE)
+#define FB_MBEDTLS_HAVE_TIME_DATE 1
+#else
+#define FB_MBEDTLS_HAVE_TIME_DATE 0
+#endif
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+#define FB_MBEDTLS_PLATFORM_MEMORY 1
+#else
+#define FB_MBEDTLS_PLATFORM_MEMORY 0
+#endif
+#if defined(MBEDTLS_PLATFORM_NO_STD_FUNCTIONS)
+#define FB_MBEDTLS_PLATFORM_NO_STD_FUNCTIONS 1
+#else
+#define FB_MBEDTLS_PLATFORM_NO_STD_FUNCTIONS 0
+#endif
+#if defined(MBEDTLS_PLATFORM_EXIT_ALT)
+#define FB_MBEDTLS_PLATFORM_EXIT_ALT 1
+#else
+#define FB_MBEDTLS_PLATFORM_EXIT_ALT 0
+#endif
+#if defined(MBEDTLS_PLATFORM_FPRINTF_ALT)
+#define FB_MBEDTLS_PLATFORM_FPRINTF_ALT 1
+#else
+#define FB_MBEDTLS_PLATFORM_FPRINTF_ALT 0
+#endif
+#if defined(MBEDTLS_PLATFORM_PRINTF_ALT)
+#define FB_MBEDTLS_PLATFORM_PRINTF_ALT 1
+#else
+#define FB_MBEDTLS_PLATFORM_PRINTF_ALT 0
+#endif
+#if defined(MBEDTLS_PLATFORM_SNPRINTF_ALT)
+#define FB_MBEDTLS_PLATFORM_SNPRINTF_ALT 1
+#else
+#define FB_MBEDTLS_PLATFORM_SNPRINTF_ALT 0
+#endif
+#if defined(MBEDTLS_DEPRECATED_WARNING)
+#define FB_MBEDTLS_DEPRECATED_WARNING 1
+#else
+#define FB_MBEDTLS_DEPRECATED_WARNING 0
+#endif
+#if defined(MBEDTLS_DEPRECATED_REMOVED)
+#define FB_MBEDTLS_DEPRECATED_REMOVED 1
+#else
+#define FB_MBEDTLS_DEPRECATED_REMOVED 0
+#endif
+#if defined(MBEDTLS_TIMING_ALT)
+#define FB_MBEDTLS_TIMING_ALT 1
+#else
+#define FB_MBEDTLS_TIMING_ALT 0
+#endif
+#if defined(MBEDTLS_AES_ALT)
+#define FB_MBEDTLS_AES_ALT 1
+#else
+#define FB_MBEDTLS_AES_ALT 0
+#endif
+#if defined(MBEDTLS_ARC4_ALT)
+#define FB_MBEDTLS_ARC4_ALT 1
+#else
+#define FB_MBEDTLS_ARC4_ALT 0
+#endif
+#if defined(MBEDTLS_BLOWFISH_ALT)
+#define FB_MBEDTLS_BLOWFISH_ALT 1
+#else
+#define FB_MBEDTLS_BLOWFISH_ALT 0
+#endif
+#if defined(MBEDTLS_CAMELLIA_ALT)
+#define FB_MBEDTLS_CAMELLIA_ALT 1
+#else
+#define FB_MBEDTLS_CAMELLIA_ALT 0
+#endif
+#if defined(MBEDTLS_DES_ALT)
+#define FB_MBEDTLS_DES_ALT 1
+#else
+#define FB_MBEDTLS_DES_ALT 0
+#endif
+#if defined(MBEDTLS_XTEA_ALT)
+#define FB_MBEDTLS_XTEA_ALT 1
+#else
+#define FB_MBEDTLS_XTEA_ALT 0
+#endif
+#if defined(MBEDTLS_MD2_ALT)
+#define FB_MBEDTLS_MD2_ALT 1
+#else
+#define FB_MBEDTLS_MD2_ALT 0
+#endif
+#if defined(MBEDTLS_MD4_ALT)
+#define FB_MBEDTLS_MD4_ALT 1
+#else
+#define FB_MBEDTLS_MD4_ALT 0
+#endif
+#if defined(MBEDTLS_MD5_ALT)
+#define FB_MBEDTLS_MD5_ALT 1
+#else
+#define FB_MBEDTLS_MD5_ALT 0
+#endif
+#if defined(MBEDTLS_RIPEMD160_ALT)
+#define FB_MBEDTLS_RIPEMD160_ALT 1
+#else
+#define FB_MBEDTLS_RIPEMD160_ALT 0
+#endif
+#if defined(MBEDTLS_SHA1_ALT)
+#define FB_MBEDTLS_SHA1_ALT 1
+#else
+#define FB_MBEDTLS_SHA1_ALT 0
+#endif
+#if defined(MBEDTLS_SHA256_ALT)
+#define FB_MBEDTLS_SHA256_ALT 1
+#else
+#define FB_MBEDTLS_SHA256_ALT 0
+#endif
+#if defined(MBEDTLS_SHA512_ALT)
+#define FB_MBEDTLS_SHA512_ALT 1
+#else
+#define FB_MBEDTLS_SHA512_ALT 0
+#endif
+#if defined(MBEDTLS_MD2_PROCESS_ALT)
+#define FB_MBEDTLS_MD2_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_MD2_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_MD4_PROCESS_ALT)
+#define FB_MBEDTLS_MD4_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_MD4_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_MD5_PROCESS_ALT)
+#define FB_MBEDTLS_MD5_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_MD5_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_RIPEMD160_PROCESS_ALT)
+#define FB_MBEDTLS_RIPEMD160_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_RIPEMD160_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_SHA1_PROCESS_ALT)
+#define FB_MBEDTLS_SHA1_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_SHA1_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_SHA256_PROCESS_ALT)
+#define FB_MBEDTLS_SHA256_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_SHA256_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_SHA512_PROCESS_ALT)
+#define FB_MBEDTLS_SHA512_PROCESS_ALT 1
+#else
+#define FB_MBEDTLS_SHA512_PROCESS_ALT 0
+#endif
+#if defined(MBEDTLS_DES_SETKEY_ALT)
+#define FB_MBEDTLS_DES_SETKEY_ALT 1
+#else
+#define FB_MBEDTLS_DES_SETKEY_ALT 0
+#endif
+#if defined(MBEDTLS_DES_CRYPT_ECB_ALT)
+#define FB_MBEDTLS_DES_CRYPT_ECB_ALT 1
+#else
+#define FB_MBEDTLS_DES_CRYPT_ECB_ALT 0
+#endif
+#if defined(MBEDTLS_DES3_CRYPT_ECB_ALT)
+#define FB_MBEDTLS_DES3_CRYPT_ECB_ALT 1
+#else
+#define FB_MBEDTLS_DES3_CRYPT_ECB_ALT 0
+#endif
+#if defined(MBEDTLS_AES_SETKEY_ENC_ALT)
+#define FB_MBEDTLS_AES_SETKEY_ENC_ALT 1
+#else
+#define FB_MBEDTLS_AES_SETKEY_ENC_ALT 0
+#endif
+#if defined(MBEDTLS_AES_SETKEY_DEC_ALT)
+#define FB_MBEDTLS_AES_SETKEY_DEC_ALT 1
+#else
+#define FB_MBEDTLS_AES_SETKEY_DEC_ALT 0
+#endif
+#if defined(MBEDTLS_AES_ENCRYPT_ALT)
+#define FB_MBEDTLS_AES_ENCRYPT_ALT 1
+#else
+#define FB_MBEDTLS_AES_ENCRYPT_ALT 0
+#endif
+#if defined(MBEDTLS_AES_DECRYPT_ALT)
+#define FB_MBEDTLS_AES_DECRYPT_ALT 1
+#else
+#define FB_MBEDTLS_AES_DECRYPT_ALT 0
+#endif
+#if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
+#define FB_MBEDTLS_ENTROPY_HARDWARE_ALT 1
+#else
+#define FB_MBEDTLS_ENTROPY_HARDWARE_ALT 0
+#endif
+#if defined(MBEDTLS_ENTROPY_RDSEED)
+#define FB_MBEDTLS_ENTROPY_RDSEED 1
+#else
+#define FB_MBEDTLS_ENTROPY_RDSEED 0
+#endif
+#if defined(MBEDTLS_AES_ROM_TABLES)
+#define FB_MBEDTLS_AES_ROM_TABLES 1
+#else
+#define FB_MBEDTLS_AES_ROM_TABLES 0
+#endif
+#if defined(MBEDTLS_CAMELLIA_SMALL_MEMORY)
+#define FB_MBEDTLS_CAMELLIA_SMALL_MEMORY 1
+#else
+#define FB_MBEDTLS_CAMELLIA_SMALL_MEMORY 0
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+#define FB_MBEDTLS_CIPHER_MODE_CBC 1
+#else
+#define FB_MBEDTLS_CIPHER_MODE_CBC 0
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+#define FB_MBEDTLS_CIPHER_MODE_CFB 1
+#else
+#define FB_MBEDTLS_CIPHER_MODE_CFB 0
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+#define FB_MBEDTLS_CIPHER_MODE_CTR 1
+#else
+#define FB_MBEDTLS_CIPHER_MODE_CTR 0
+#endif
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+#define FB_MBEDTLS_CIPHER_MODE_XTS 1
+#else
+#define FB_MBEDTLS_CIPHER_MODE_XTS 0
+#endif
+#if defined(MBEDTLS_CIPHER_NULL_CIPHER)
+#define FB_MBEDTLS_CIPHER_NULL_CIPHER 1
+#else
+#define FB_MBEDTLS_CIPHER_NULL_CIPHER 0
+#endif
+#if defined(MBEDTLS_SINGLE_BACKEND_DISPATCH)
+#define FB_MBEDTLS_SINGLE_BACKEND_DISPATCH 1
+#else
+#define FB_MBEDTLS_SINGLE_BACKEND_DISPATCH 0
+#endif
+#if defined(MBEDTLS_CIPHER_PADDING_PKCS7)
+#define FB_MBEDTLS_CIPHER_PADDING_PKCS7 1
+#else
+#define FB_MBEDTLS_CIPHER_PADDING_PKCS7 0
+#endif
+#if defined(MBEDTLS_CIPHER_PADDING_ONE_AND_ZEROS)
+#define FB_MBEDTLS_CIPHER_PADDING_ONE_AND_ZEROS 1
+#else
+#define FB_MBEDTLS_CIPHER_PADDING_ONE_AND_ZEROS 0
+#endif
+#if defined(MBEDTLS_CIPHER_PADDING_ZEROS_AND_LEN)
+#define FB_MBEDTLS_CIPHER_PADDING_ZEROS_AND_LEN 1
+#else
+#define FB_MBEDTLS_CIPHER_PADDING_ZEROS_AND_LEN 0
+#endif
+#if defined(MBEDTLS_CIPHER_PADDING_ZEROS)
+#define FB_MBEDTLS_CIPHER_PADDING_ZEROS 1
+#else
+#define FB_MBEDTLS_CIPHER_PADDING_ZEROS 0
+#endif
+#if defined(MBEDTLS_ENABLE_WEAK_CIPHERSUITES)
+#define FB_MBEDTLS_ENABLE_WEAK_CIPHERSUITES 1
+#else
+#define FB_MBEDTLS_ENABLE_WEAK_CIPHERSUITES 0
+#endif
+#if defined(MBEDTLS_REMOVE_ARC4_CIPHERSUITES)
+#define FB_MBEDTLS_REMOVE_ARC4_CIPHERSUITES 1
+#else
+#define FB_MBEDTLS_REMOVE_ARC4_CIPHERSUITES 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP192R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP192R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP224R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP224R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP256R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP256R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP384R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP384R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP521R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP521R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192K1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP192K1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP192K1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224K1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP224K1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP224K1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_SECP256K1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_SECP256K1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_BP256R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_BP256R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_BP256R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_BP384R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_BP384R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_BP384R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_BP512R1_ENABLED)
+#define FB_MBEDTLS_ECP_DP_BP512R1_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_BP512R1_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
+#define FB_MBEDTLS_ECP_DP_CURVE25519_ENABLED 1
+#else
+#define FB_MBEDTLS_ECP_DP_CURVE25519_ENABLED 0
+#endif
+#if defined(MBEDTLS_ECP_NIST_OPTIM)
+#define FB_MBEDTLS_ECP_NIST_OPTIM 1
+#else
+#define FB_MBEDTLS_ECP_NIST_OPTIM 0
+#endif
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+#define FB_MBEDTLS_ECP_COMB_TABLE_CACHE 1
+#else
+#define FB_MBEDTLS_ECP_COMB_TABLE_CACHE 0
+#endif
+#if defined(MBEDTLS_ECP_RESTARTABLE)
+#define FB_MBEDTLS_ECP_RESTARTABLE 1
+#else
+#define FB_MBEDTLS_ECP_RESTARTABLE 0
+#endif
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+#define FB_MBEDTLS_ECDSA_DETERMINISTIC 1
+#else
+#define FB_MBEDTLS_ECDSA_DETERMINISTIC 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_DHE_PSK_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_DHE_PSK_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_DHE_PSK_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_RSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_RSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_RSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED)
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED 1
+#else
+#define FB_MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED 0
+#endif
+#if defined(MBEDTLS_PK_PARSE_EC_EXTENDED)
+#define FB_MBEDTLS_PK_PARSE_EC_EXTENDED 1
+#else
+#define FB_MBEDTLS_PK_PARSE_EC_EXTENDED 0
+#endif
+#if defined(MBEDTLS_ERROR_STRERROR_DUMMY)
+#define FB_MBEDTLS_ERROR_STRERROR_DUMMY 1
+#else
+#define FB_MBEDTLS_ERROR_STRERROR_DUMMY 0
+#endif
+#if defined(MBEDTLS_GENPRIME)
+#define FB_MBEDTLS_GENPRIME 1
+#else
+#define FB_MBEDTLS_GENPRIME 0
+#endif
+#if defined(MBEDTLS_FS_IO)
+#define FB_MBEDTLS_FS_IO 1
+#else
+#define FB_MBEDTLS_FS_IO 0
+#endif
+#if defined(MBEDTLS_CTR_DRBG_FORK_CHECK)
+#define FB_MBEDTLS_CTR_DRBG_FORK_CHECK 1
+#else
+#define FB_MBEDTLS_CTR_DRBG_FORK_CHECK 0
+#endif
+#if defined(MBEDTLS_GCM_LARGETABLE)
+#define FB_MBEDTLS_GCM_LARGETABLE 1
+#else
+#define FB_MBEDTLS_GCM_LARGETABLE 0
+#endif
+#if defined(MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES)
+#define FB_MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES 1
+#else
+#define FB_MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES 0
+#endif
+#if defined(MBEDTLS_NO_PLATFORM_ENTROPY)
+#define FB_MBEDTLS_NO_PLATFORM_ENTROPY 1
+#else
+#define FB_MBEDTLS_NO_PLATFORM_ENTROPY 0
+#endif
+#if defined(MBEDTLS_ENTROPY_FORCE_SHA256)
+#define FB_MBEDTLS_ENTROPY_FORCE_SHA256 1
+#else
+#define FB_MBEDTLS_ENTROPY_FORCE_SHA256 0
+#endif
+#if defined(MBEDTLS_ENTROPY_PREFETCH)
+#define FB_MBEDTLS_ENTROPY_PREFETCH 1
+#else
+#define FB_MBEDTLS_ENTROPY_PREFETCH 0
+#endif
+#if defined(MBEDTLS_MD_HMAC_CACHE)
+#define FB_MBEDTLS_MD_HMAC_CACHE 1
+#else
+#define FB_MBEDTLS_MD_HMAC_CACHE 0
+#endif
+#if defined(MBEDTLS_MEMORY_DEBUG)
+#define FB_MBEDTLS_MEMORY_DEBUG 1
+#else
+#define FB_MBEDTLS_MEMORY_DEBUG 0
+#endif
+#if defined(MBEDTLS_MEMORY_BACKTRACE)
+#define FB_MBEDTLS_MEMORY_BACKTRACE 1
+#else
+#define FB_MBEDTLS_MEMORY_BACKTRACE 0
+#endif
+#if defined(MBEDTLS_MEMORY_TAGGING)
+#define FB_MBEDTLS_MEMORY_TAGGING 1
+#else
+#define FB_MBEDTLS_MEMORY_TAGGING 0
+#endif
+#if defined(MBEDTLS_MEMORY_ARENAS)
+#define FB_MBEDTLS_MEMORY_ARENAS 1
+#else
+#define FB_MBEDTLS_MEMORY_ARENAS 0
+#endif
+#if defined(MBEDTLS_MPI_MUL_WIDE)
+#define FB_MBEDTLS_MPI_MUL_WIDE 1
+#else
+#define FB_MBEDTLS_MPI_MUL_WIDE 0
+#endif
+#if defined(MBEDTLS_PK_RSA_ALT_SUPPORT)
+#define FB_MBEDTLS_PK_RSA_ALT_SUPPORT 1
+#else
+#define FB_MBEDTLS_PK_RSA_ALT_SUPPORT 0
+#endif
+#if defined(MBEDTLS_PKCS1_V15)
+#define FB_MBEDTLS_PKCS1_V15 1
+#else
+#define FB_MBEDTLS_PKCS1_V15 0
+#endif
+#if defined(MBEDTLS_PKCS1_V21)
+#define FB_MBEDTLS_PKCS1_V21 1
+#else
+#define FB_MBEDTLS_PKCS1_V21 0
+#endif
+#if defined(MBEDTLS_RSA_NO_CRT)
+#define FB_MBEDTLS_RSA_NO_CRT 1
+#else
+#define FB_MBEDTLS_RSA_NO_CRT 0
+#endif
+#if defined(MBEDTLS_SELF_TEST)
+#define FB_MBEDTLS_SELF_TEST 1
+#else
+#define FB_MBEDTLS_SELF_TEST 0
+#endif
+#if defined(MBEDTLS_SHA256_SMALLER)
+#define FB_MBEDTLS_SHA256_SMALLER 1
+#else
+#define FB_MBEDTLS_SHA256_SMALLER 0
+#endif
+#if defined(MBEDTLS_SSL_AEAD_RANDOM_IV)
+#define FB_MBEDTLS_SSL_AEAD_RANDOM_IV 1
+#else
+#define FB_MBEDTLS_SSL_AEAD_RANDOM_IV 0
+#endif
+#if defined(MBEDTLS_SSL_ALL_ALERT_MESSAGES)
+#define FB_MBEDTLS_SSL_ALL_ALERT_MESSAGES 1
+#else
+#define FB_MBEDTLS_SSL_ALL_ALERT_MESSAGES 0
+#endif
+#if defined(MBEDTLS_SSL_DEBUG_ALL)
+#define FB_MBEDTLS_SSL_DEBUG_ALL 1
+#else
+#define FB_MBEDTLS_SSL_DEBUG_ALL 0
+#endif
+#if defined(MBEDTLS_SSL_ECDH_REUSE)
+#define FB_MBEDTLS_SSL_ECDH_REUSE 1
+#else
+#define FB_MBEDTLS_SSL_ECDH_REUSE 0
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+#define FB_MBEDTLS_SSL_ENCRYPT_THEN_MAC 1
+#else
+#define FB_MBEDTLS_SSL_ENCRYPT_THEN_MAC 0
+#endif
+#if defined(MBEDTLS_SSL_EXTENDED_MASTER_SECRET)
+#define FB_MBEDTLS_SSL_EXTENDED_MASTER_SECRET 1
+#else
+#define FB_MBEDTLS_SSL_EXTENDED_MASTER_SECRET 0
+#endif
+#if defined(MBEDTLS_SSL_FALLBACK_SCSV)
+#define FB_MBEDTLS_SSL_FALLBACK_SCSV 1
+#else
+#define FB_MBEDTLS_SSL_FALLBACK_SCSV 0
+#endif
+#if defined(MBEDTLS_SSL_FALSE_START)
+#define FB_MBEDTLS_SSL_FALSE_START 1
+#else
+#define FB_MBEDTLS_SSL_FALSE_START 0
+#endif
+#if defined(MBEDTLS_SSL_HS_TIMING)
+#define FB_MBEDTLS_SSL_HS_TIMING 1
+#else
+#define FB_MBEDTLS_SSL_HS_TIMING 0
+#endif
+#if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
+#define FB_MBEDTLS_SSL_HW_RECORD_ACCEL 1
+#else
+#define FB_MBEDTLS_SSL_HW_RECORD_ACCEL 0
+#endif
+#if defined(MBEDTLS_SSL_OUT_DOUBLE_BUFFER)
+#define FB_MBEDTLS_SSL_OUT_DOUBLE_BUFFER 1
+#else
+#define FB_MBEDTLS_SSL_OUT_DOUBLE_BUFFER 0
+#endif
+#if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+#define FB_MBEDTLS_SSL_CBC_RECORD_SPLITTING 1
+#else
+#define FB_MBEDTLS_SSL_CBC_RECORD_SPLITTING 0
+#endif
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+#define FB_MBEDTLS_SSL_RECORD_PADDING 1
+#else
+#define FB_MBEDTLS_SSL_RECORD_PADDING 0
+#endif
+#if defined(MBEDTLS_SSL_RECORD_KEY_EXPORT)
+#define FB_MBEDTLS_SSL_RECORD_KEY_EXPORT 1
+#else
+#define FB_MBEDTLS_SSL_RECORD_KEY_EXPORT 0
+#endif
+#if defined(MBEDTLS_SSL_RECORD_SPECIALIZE)
+#define FB_MBEDTLS_SSL_RECORD_SPECIALIZE 1
+#else
+#define FB_MBEDTLS_SSL_RECORD_SPECIALIZE 0
+#endif
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+#define FB_MBEDTLS_SSL_RENEGOTIATION 1
+#else
+#define FB_MBEDTLS_SSL_RENEGOTIATION 0
+#endif
+#if defined(MBEDTLS_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO)
+#define FB_MBEDTLS_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO 1
+#else
+#define FB_MBEDTLS_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO 0
+#endif
+#if defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
+#define FB_MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE 1
+#else
+#define FB_MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE 0
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+#define FB_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH 1
+#else
+#define FB_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH 0
+#endif
+#if defined(MBEDTLS_SSL_PROTO_SSL3)
+#define FB_MBEDTLS_SSL_PROTO_SSL3 1
+#else
+#define FB_MBEDTLS_SSL_PROTO_SSL3 0
+#endif
+#if defined(MBEDTLS_SSL_PROTO_TLS1)
+#define FB_MBEDTLS_SSL_PROTO_TLS1 1
+#else
+#define FB_MBEDTLS_SSL_PROTO_TLS1 0
+#endif
+#if defined(MBEDTLS_SSL_PROTO_TLS1_1)
+#define FB_MBEDTLS_SSL_PROTO_TLS1_1 1
+#else
+#define FB_MBEDTLS_SSL_PROTO_TLS1_1 0
+#endif
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2)
+#define FB_MBEDTLS_SSL_PROTO_TLS1_2 1
+#else
+#define FB_MBEDTLS_SSL_PROTO_TLS1_2 0
+#endif
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+#define FB_MBEDTLS_SSL_PROTO_DTLS 1
+#else
+#define FB_MBEDTLS_SSL_PROTO_DTLS 0
+#endif
+#if defined(MBEDTLS_SSL_ALPN)
+#define FB_MBEDTLS_SSL_ALPN 1
+#else
+#define FB_MBEDTLS_SSL_ALPN 0
+#endif
+#if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
+#define FB_MBEDTLS_SSL_ASYNC_PRIVATE 1
+#else
+#define FB_MBEDTLS_SSL_ASYNC_PRIVATE 0
+#endif
+#if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
+#define FB_MBEDTLS_SSL_DTLS_ANTI_REPLAY 1
+#else
+#define FB_MBEDTLS_SSL_DTLS_ANTI_REPLAY 0
+#endif
+#if defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY)
+#define FB_MBEDTLS_SSL_DTLS_HELLO_VERIFY 1
+#else
+#define FB_MBEDTLS_SSL_DTLS_HELLO_VERIFY 0
+#endif
+#if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
+#define FB_MBEDTLS_SSL_DTLS_BADMAC_LIMIT 1
+#else
+#define FB_MBEDTLS_SSL_DTLS_BADMAC_LIMIT 0
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+#define FB_MBEDTLS_SSL_SESSION_TICKETS 1
+#else
+#define FB_MBEDTLS_SSL_SESSION_TICKETS 0
+#endif
+#if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
+#define FB_MBEDTLS_SSL_SERVER_NAME_INDICATION 1
+#else
+#define FB_MBEDTLS_SSL_SERVER_NAME_INDICATION 0
+#endif
+#if defined(MBEDTLS_SSL_STATS)
+#define FB_MBEDTLS_SSL_STATS 1
+#else
+#define FB_MBEDTLS_SSL_STATS 0
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+#define FB_MBEDTLS_SSL_TRUNCATED_HMAC 1
+#else
+#define FB_MBEDTLS_SSL_TRUNCATED_HMAC 0
+#endif
+#if defined(MBEDTLS_SSL_TRANSFORM_POOL)
+#define FB_MBEDTLS_SSL_TRANSFORM_POOL 1
+#else
+#define FB_MBEDTLS_SSL_TRANSFORM_POOL 0
+#endif
+#if defined(MBEDTLS_SSL_HANDSHAKE_POOL)
+#define FB_MBEDTLS_SSL_HANDSHAKE_POOL 1
+#else
+#define FB_MBEDTLS_SSL_HANDSHAKE_POOL 0
+#endif
+#if defined(MBEDTLS_THREADING_ALT)
+#define FB_MBEDTLS_THREADING_ALT 1
+#else
+#define FB_MBEDTLS_THREADING_ALT 0
+#endif
+#if defined(MBEDTLS_THREADING_PTHREAD)
+#define FB_MBEDTLS_THREADING_PTHREAD 1
+#else
+#define FB_MBEDTLS_THREADING_PTHREAD 0
+#endif
+#if defined(MBEDTLS_THREADING_SPIN)
+#define FB_MBEDTLS_THREADING_SPIN 1
+#else
+#define FB_MBEDTLS_THREADING_SPIN 0
+#endif
+#if defined(MBEDTLS_TIMING_COARSE)
+#define FB_MBEDTLS_TIMING_COARSE 1
+#else
+#define FB_MBEDTLS_TIMING_COARSE 0
+#endif
+#if defined(MBEDTLS_TIMING_TRACE)
+#define FB_MBEDTLS_TIMING_TRACE 1
+#else
+#define FB_MBEDTLS_TIMING_TRACE 0
+#endif
+#if defined(MBEDTLS_VERSION_FEATURES)
+#define FB_MBEDTLS_VERSION_FEATURES 1
+#else
+#define FB_MBEDTLS_VERSION_FEATURES 0
+#endif
+#if defined(MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3)
+#define FB_MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3 1
+#else
+#define FB_MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3 0
+#endif
+#if defined(MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION)
+#define FB_MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION 1
+#else
+#define FB_MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION 0
+#endif
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+#define FB_MBEDTLS_X509_CRT_LAZY_EXTENSIONS 1
+#else
+#define FB_MBEDTLS_X509_CRT_LAZY_EXTENSIONS 0
+#endif
+#if defined(MBEDTLS_X509_CRT_ARENA)
+#define FB_MBEDTLS_X509_CRT_ARENA 1
+#else
+#define FB_MBEDTLS_X509_CRT_ARENA 0
+#endif
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+#define FB_MBEDTLS_X509_CRT_HOST_TABLE 1
+#else
+#define FB_MBEDTLS_X509_CRT_HOST_TABLE 0
+#endif
+#if defined(MBEDTLS_X509_DN_CACHE)
+#define FB_MBEDTLS_X509_DN_CACHE 1
+#else
+#define FB_MBEDTLS_X509_DN_CACHE 0
+#endif
+#if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
+#define FB_MBEDTLS_X509_CHECK_KEY_USAGE 1
+#else
+#define FB_MBEDTLS_X509_CHECK_KEY_USAGE 0
+#endif
+#if defined(MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE)
+#define FB_MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE 1
+#else
+#define FB_MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE 0
+#endif
+#if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT)
+#define FB_MBEDTLS_X509_RSASSA_PSS_SUPPORT 1
+#else
+#define FB_MBEDTLS_X509_RSASSA_PSS_SUPPORT 0
+#endif
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+#define FB_MBEDTLS_ZLIB_SUPPORT 1
+#else
+#define FB_MBEDTLS_ZLIB_SUPPORT 0
+#endif
+#if defined(MBEDTLS_AESNI_C)
+#define FB_MBEDTLS_AESNI_C 1
+#else
+#define FB_MBEDTLS_AESNI_C 0
+#endif
+#if defined(MBEDTLS_ARMCE_C)
+#define FB_MBEDTLS_ARMCE_C 1
+#else
+#define FB_MBEDTLS_ARMCE_C 0
+#endif
+#if defined(MBEDTLS_AESCT_C)
+#define FB_MBEDTLS_AESCT_C 1
+#else
+#define FB_MBEDTLS_AESCT_C 0
+#endif
+#if defined(MBEDTLS_AES_C)
+#define FB_MBEDTLS_AES_C 1
+#else
+#define FB_MBEDTLS_AES_C 0
+#endif
+#if defined(MBEDTLS_ARC4_C)
+#define FB_MBEDTLS_ARC4_C 1
+#else
+#define FB_MBEDTLS_ARC4_C 0
+#endif
+#if defined(MBEDTLS_ASN1_PARSE_C)
+#define FB_MBEDTLS_ASN1_PARSE_C 1
+#else
+#define FB_MBEDTLS_ASN1_PARSE_C 0
+#endif
+#if defined(MBEDTLS_ASN1_WRITE_C)
+#define FB_MBEDTLS_ASN1_WRITE_C 1
+#else
+#define FB_MBEDTLS_ASN1_WRITE_C 0
+#endif
+#if defined(MBEDTLS_BASE64_C)
+#define FB_MBEDTLS_BASE64_C 1
+#else
+#define FB_MBEDTLS_BASE64_C 0
+#endif
+#if defined(MBEDTLS_BIGNUM_C)
+#define FB_MBEDTLS_BIGNUM_C 1
+#else
+#define FB_MBEDTLS_BIGNUM_C 0
+#endif
+#if defined(MBEDTLS_BLOWFISH_C)
+#define FB_MBEDTLS_BLOWFISH_C 1
+#else
+#define FB_MBEDTLS_BLOWFISH_C 0
+#endif
+#if defined(MBEDTLS_CAMELLIA_C)
+#define FB_MBEDTLS_CAMELLIA_C 1
+#else
+#define FB_MBEDTLS_CAMELLIA_C 0
+#endif
+#if defined(MBEDTLS_CCM_C)
+#define FB_MBEDTLS_CCM_C 1
+#else
+#define FB_MBEDTLS_CCM_C 0
+#endif
+#if defined(MBEDTLS_CERTS_C)
+#define FB_MBEDTLS_CERTS_C 1
+#else
+#define FB_MBEDTLS_CERTS_C 0
+#endif
+#if defined(MBEDTLS_CHACHA20_C)
+#define FB_MBEDTLS_CHACHA20_C 1
+#else
+#define FB_MBEDTLS_CHACHA20_C 0
+#endif
+#if defined(MBEDTLS_CHACHAPOLY_C)
+#define FB_MBEDTLS_CHACHAPOLY_C 1
+#else
+#define FB_MBEDTLS_CHACHAPOLY_C 0
+#endif
+#if defined(MBEDTLS_CIPHER_C)
+#define FB_MBEDTLS_CIPHER_C 1
+#else
+#define FB_MBEDTLS_CIPHER_C 0
+#endif
+#if defined(MBEDTLS_CTR_DRBG_C)
+#define FB_MBEDTLS_CTR_DRBG_C 1
+#else
+#define FB_MBEDTLS_CTR_DRBG_C 0
+#endif
+#if defined(MBEDTLS_DEBUG_C)
+#define FB_MBEDTLS_DEBUG_C 1
+#else
+#define FB_MBEDTLS_DEBUG_C 0
+#endif
+#if defined(MBEDTLS_DES_C)
+#define FB_MBEDTLS_DES_C 1
+#else
+#define FB_MBEDTLS_DES_C 0
+#endif
+#if defined(MBEDTLS_DHM_C)
+#define FB_MBEDTLS_DHM_C 1
+#else
+#define FB_MBEDTLS_DHM_C 0
+#endif
+#if defined(MBEDTLS_ECDH_C)
+#define FB_MBEDTLS_ECDH_C 1
+#else
+#define FB_MBEDTLS_ECDH_C 0
+#endif
+#if defined(MBEDTLS_ECDSA_C)
+#define FB_MBEDTLS_ECDSA_C 1
+#else
+#define FB_MBEDTLS_ECDSA_C 0
+#endif
+#if defined(MBEDTLS_ECP_C)
+#define FB_MBEDTLS_ECP_C 1
+#else
+#define FB_MBEDTLS_ECP_C 0
+#endif
+#if defined(MBEDTLS_ENTROPY_C)
+#define FB_MBEDTLS_ENTROPY_C 1
+#else
+#define FB_MBEDTLS_ENTROPY_C 0
+#endif
+#if defined(MBEDTLS_ERROR_C)
+#define FB_MBEDTLS_ERROR_C 1
+#else
+#define FB_MBEDTLS_ERROR_C 0
+#endif
+#if defined(MBEDTLS_GCM_C)
+#define FB_MBEDTLS_GCM_C 1
+#else
+#define FB_MBEDTLS_GCM_C 0
+#endif
+#if defined(MBEDTLS_HAVEGE_C)
+#define FB_MBEDTLS_HAVEGE_C 1
+#else
+#define FB_MBEDTLS_HAVEGE_C 0
+#endif
+#if defined(MBEDTLS_HMAC_DRBG_C)
+#define FB_MBEDTLS_HMAC_DRBG_C 1
+#else
+#define FB_MBEDTLS_HMAC_DRBG_C 0
+#endif
+#if defined(MBEDTLS_MD_C)
+#define FB_MBEDTLS_MD_C 1
+#else
+#define FB_MBEDTLS_MD_C 0
+#endif
+#if defined(MBEDTLS_MD2_C)
+#define FB_MBEDTLS_MD2_C 1
+#else
+#define FB_MBEDTLS_MD2_C 0
+#endif
+#if defined(MBEDTLS_MD4_C)
+#define FB_MBEDTLS_MD4_C 1
+#else
+#define FB_MBEDTLS_MD4_C 0
+#endif
+#if defined(MBEDTLS_MD5_C)
+#define FB_MBEDTLS_MD5_C 1
+#else
+#define FB_MBEDTLS_MD5_C 0
+#endif
+#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+#define FB_MBEDTLS_MEMORY_BUFFER_ALLOC_C 1
+#else
+#define FB_MBEDTLS_MEMORY_BUFFER_ALLOC_C 0
+#endif
+#if defined(MBEDTLS_NET_C)
+#define FB_MBEDTLS_NET_C 1
+#else
+#define FB_MBEDTLS_NET_C 0
+#endif
+#if defined(MBEDTLS_OID_C)
+#define FB_MBEDTLS_OID_C 1
+#else
+#define FB_MBEDTLS_OID_C 0
+#endif
+#if defined(MBEDTLS_PADLOCK_C)
+#define FB_MBEDTLS_PADLOCK_C 1
+#else
+#define FB_MBEDTLS_PADLOCK_C 0
+#endif
+#if defined(MBEDTLS_PEM_PARSE_C)
+#define FB_MBEDTLS_PEM_PARSE_C 1
+#else
+#define FB_MBEDTLS_PEM_PARSE_C 0
+#endif
+#if defined(MBEDTLS_PEM_WRITE_C)
+#define FB_MBEDTLS_PEM_WRITE_C 1
+#else
+#define FB_MBEDTLS_PEM_WRITE_C 0
+#endif
+#if defined(MBEDTLS_PK_C)
+#define FB_MBEDTLS_PK_C 1
+#else
+#define FB_MBEDTLS_PK_C 0
+#endif
+#if defined(MBEDTLS_PK_PARSE_C)
+#define FB_MBEDTLS_PK_PARSE_C 1
+#else
+#define FB_MBEDTLS_PK_PARSE_C 0
+#endif
+#if defined(MBEDTLS_PK_WRITE_C)
+#define FB_MBEDTLS_PK_WRITE_C 1
+#else
+#define FB_MBEDTLS_PK_WRITE_C 0
+#endif
+#if defined(MBEDTLS_PKCS5_C)
+#define FB_MBEDTLS_PKCS5_C 1
+#else
+#define FB_MBEDTLS_PKCS5_C 0
+#endif
+#if defined(MBEDTLS_PKCS11_C)
+#define FB_MBEDTLS_PKCS11_C 1
+#else
+#define FB_MBEDTLS_PKCS11_C 0
+#endif
+#if defined(MBEDTLS_PKCS12_C)
+#define FB_MBEDTLS_PKCS12_C 1
+#else
+#define FB_MBEDTLS_PKCS12_C 0
+#endif
+#if defined(MBEDTLS_PLATFORM_C)
+#define FB_MBEDTLS_PLATFORM_C 1
+#else
+#define FB_MBEDTLS_PLATFORM_C 0
+#endif
+#if defined(MBEDTLS_POLY1305_C)
+#define FB_MBEDTLS_POLY1305_C 1
+#else
+#define FB_MBEDTLS_POLY1305_C 0
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+#define FB_MBEDTLS_RIPEMD160_C 1
+#else
+#define FB_MBEDTLS_RIPEMD160_C 0
+#endif
+#if defined(MBEDTLS_RSA_C)
+#define FB_MBEDTLS_RSA_C 1
+#else
+#define FB_MBEDTLS_RSA_C 0
+#endif
+#if defined(MBEDTLS_SHA1_C)
+#define FB_MBEDTLS_SHA1_C 1
+#else
+#define FB_MBEDTLS_SHA1_C 0
+#endif
+#if defined(MBEDTLS_SHA256_C)
+#define FB_MBEDTLS_SHA256_C 1
+#else
+#define FB_MBEDTLS_SHA256_C 0
+#endif
+#if defined(MBEDTLS_SHA256MB_C)
+#define FB_MBEDTLS_SHA256MB_C 1
+#else
+#define FB_MBEDTLS_SHA256MB_C 0
+#endif
+#if defined(MBEDTLS_SHA512_C)
+#define FB_MBEDTLS_SHA512_C 1
+#else
+#define FB_MBEDTLS_SHA512_C 0
+#endif
+#if defined(MBEDTLS_SHANI_C)
+#define FB_MBEDTLS_SHANI_C 1
+#else
+#define FB_MBEDTLS_SHANI_C 0
+#endif
+#if defined(MBEDTLS_SSL_BIO_PAIR_C)
+#define FB_MBEDTLS_SSL_BIO_PAIR_C 1
+#else
+#define FB_MBEDTLS_SSL_BIO_PAIR_C 0
+#endif
+#if defined(MBEDTLS_SSL_CACHE_C)
+#define FB_MBEDTLS_SSL_CACHE_C 1
+#else
+#define FB_MBEDTLS_SSL_CACHE_C 0
+#endif
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+#define FB_MBEDTLS_SSL_CACHE_SHM_C 1
+#else
+#define FB_MBEDTLS_SSL_CACHE_SHM_C 0
+#endif
+#if defined(MBEDTLS_SSL_COOKIE_C)
+#define FB_MBEDTLS_SSL_COOKIE_C 1
+#else
+#define FB_MBEDTLS_SSL_COOKIE_C 0
+#endif
+#if defined(MBEDTLS_SSL_DEMUX_C)
+#define FB_MBEDTLS_SSL_DEMUX_C 1
+#else
+#define FB_MBEDTLS_SSL_DEMUX_C 0
+#endif
+#if defined(MBEDTLS_SSL_PSK_STORE_C)
+#define FB_MBEDTLS_SSL_PSK_STORE_C 1
+#else
+#define FB_MBEDTLS_SSL_PSK_STORE_C 0
+#endif
+#if defined(MBEDTLS_SSL_SCHED_C)
+#define FB_MBEDTLS_SSL_SCHED_C 1
+#else
+#define FB_MBEDTLS_SSL_SCHED_C 0
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+#define FB_MBEDTLS_SSL_TICKET_C 1
+#else
+#define FB_MBEDTLS_SSL_TICKET_C 0
+#endif
+#if defined(MBEDTLS_SSL_CLI_C)
+#define FB_MBEDTLS_SSL_CLI_C 1
+#else
+#define FB_MBEDTLS_SSL_CLI_C 0
+#endif
+#if defined(MBEDTLS_SSL_SRV_C)
+#define FB_MBEDTLS_SSL_SRV_C 1
+#else
+#define FB_MBEDTLS_SSL_SRV_C 0
+#endif
+#if defined(MBEDTLS_SSL_TLS_C)
+#define FB_MBEDTLS_SSL_TLS_C 1
+#else
+#define FB_MBEDTLS_SSL_TLS_C 0
+#endif
+#if defined(MBEDTLS_THREADING_C)
+#define FB_MBEDTLS_THREADING_C 1
+#else
+#define FB_MBEDTLS_THREADING_C 0
+#endif
+#if defined(MBEDTLS_TIMING_C)
+#define FB_MBEDTLS_TIMING_C 1
+#else
+#define FB_MBEDTLS_TIMING_C 0
+#endif
+#if defined(MBEDTLS_VERSION_C)
+#define FB_MBEDTLS_VERSION_C 1
+#else
+#define FB_MBEDTLS_VERSION_C 0
+#endif
+#if defined(MBEDTLS_WARMUP_C)
+#define FB_MBEDTLS_WARMUP_C 1
+#else
+#define FB_MBEDTLS_WARMUP_C 0
+#endif
+#if defined(MBEDTLS_X509_USE_C)
+#define FB_MBEDTLS_X509_USE_C 1
+#else
+#define FB_MBEDTLS_X509_USE_C 0
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+#define FB_MBEDTLS_X509_CRT_PARSE_C 1
+#else
+#define FB_MBEDTLS_X509_CRT_PARSE_C 0
+#endif
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+#define FB_MBEDTLS_X509_CRT_CACHE_C 1
+#else
+#define FB_MBEDTLS_X509_CRT_CACHE_C 0
+#endif
+#if defined(MBEDTLS_X509_TRUST_C)
+#define FB_MBEDTLS_X509_TRUST_C 1
+#else
+#define FB_MBEDTLS_X509_TRUST_C 0
+#endif
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+#define FB_MBEDTLS_X509_VERIFY_CACHE_C 1
+#else
+#define FB_MBEDTLS_X509_VERIFY_CACHE_C 0
+#endif
+#if defined(MBEDTLS_X509_CRL_PARSE_C)
+#define FB_MBEDTLS_X509_CRL_PARSE_C 1
+#else
+#define FB_MBEDTLS_X509_CRL_PARSE_C 0
+#endif
+#if defined(MBEDTLS_X509_CRL_SET_C)
+#define FB_MBEDTLS_X509_CRL_SET_C 1
+#else
+#define FB_MBEDTLS_X509_CRL_SET_C 0
+#endif
+#if defined(MBEDTLS_X509_CSR_PARSE_C)
+#define FB_MBEDTLS_X509_CSR_PARSE_C 1
+#else
+#define FB_MBEDTLS_X509_CSR_PARSE_C 0
+#endif
+#if defined(MBEDTLS_X509_CREATE_C)
+#define FB_MBEDTLS_X509_CREATE_C 1
+#else
+#define FB_MBEDTLS_X509_CREATE_C 0
+#endif
+#if defined(MBEDTLS_X509_CRT_WRITE_C)
+#define FB_MBEDTLS_X509_CRT_WRITE_C 1
+#else
+#define FB_MBEDTLS_X509_CRT_WRITE_C 0
+#endif
+#if defined(MBEDTLS_X509_CSR_WRITE_C)
+#define FB_MBEDTLS_X509_CSR_WRITE_C 1
+#else
+#define FB_MBEDTLS_X509_CSR_WRITE_C 0
+#endif
+#if defined(MBEDTLS_XTEA_C)
+#define FB_MBEDTLS_XTEA_C 1
+#else
+#define FB_MBEDTLS_XTEA_C 0
+#endif
+
+static const unsigned char feature_bitmap[] = {
+    (unsigned char)( FB_MBEDTLS_HAVE_ASM << 0 |
+                     FB_MBEDTLS_HAVE_SSE2 << 1 |
+                     FB_MBEDTLS_HAVE_TIME << 2 |
+                     FB_MBEDTLS_HAVE_TIME_DATE << 3 |
+                     FB_MBEDTLS_PLATFORM_MEMORY << 4 |
+                     FB_MBEDTLS_PLATFORM_NO_STD_FUNCTIONS << 5 |
+                     FB_MBEDTLS_PLATFORM_EXIT_ALT << 6 |
+                     FB_MBEDTLS_PLATFORM_FPRINTF_ALT << 7 ),
+    (unsigned char)( FB_MBEDTLS_PLATFORM_PRINTF_ALT << 0 |
+                     FB_MBEDTLS_PLATFORM_SNPRINTF_ALT << 1 |
+                     FB_MBEDTLS_DEPRECATED_WARNING << 2 |
+                     FB_MBEDTLS_DEPRECATED_REMOVED << 3 |
+                     FB_MBEDTLS_TIMING_ALT << 4 |
+                     FB_MBEDTLS_AES_ALT << 5 |
+                     FB_MBEDTLS_ARC4_ALT << 6 |
+                     FB_MBEDTLS_BLOWFISH_ALT << 7 ),
+    (unsigned char)( FB_MBEDTLS_CAMELLIA_ALT << 0 |
+                     FB_MBEDTLS_DES_ALT << 1 |
+                     FB_MBEDTLS_XTEA_ALT << 2 |
+                     FB_MBEDTLS_MD2_ALT << 3 |
+                     FB_MBEDTLS_MD4_ALT << 4 |
+                     FB_MBEDTLS_MD5_ALT << 5 |
+                     FB_MBEDTLS_RIPEMD160_ALT << 6 |
+                     FB_MBEDTLS_SHA1_ALT << 7 ),
+    (unsigned char)( FB_MBEDTLS_SHA256_ALT << 0 |
+                     FB_MBEDTLS_SHA512_ALT << 1 |
+                     FB_MBEDTLS_MD2_PROCESS_ALT << 2 |
+                     FB_MBEDTLS_MD4_PROCESS_ALT << 3 |
+                     FB_MBEDTLS_MD5_PROCESS_ALT << 4 |
+                     FB_MBEDTLS_RIPEMD160_PROCESS_ALT << 5 |
+                     FB_MBEDTLS_SHA1_PROCESS_ALT << 6 |
+                     FB_MBEDTLS_SHA256_PROCESS_ALT << 7 ),
+    (unsigned char)( FB_MBEDTLS_SHA512_PROCESS_ALT << 0 |
+                     FB_MBEDTLS_DES_SETKEY_ALT << 1 |
+                     FB_MBEDTLS_DES_CRYPT_ECB_ALT << 2 |
+                     FB_MBEDTLS_DES3_CRYPT_ECB_ALT << 3 |
+                     FB_MBEDTLS_AES_SETKEY_ENC_ALT << 4 |
+                     FB_MBEDTLS_AES_SETKEY_DEC_ALT << 5 |
+                     FB_MBEDTLS_AES_ENCRYPT_ALT << 6 |
+                     FB_MBEDTLS_AES_DECRYPT_ALT << 7 ),
+    (unsigned char)( FB_MBEDTLS_ENTROPY_HARDWARE_ALT << 0 |
+                     FB_MBEDTLS_ENTROPY_RDSEED << 1 |
+                     FB_MBEDTLS_AES_ROM_TABLES << 2 |
+                     FB_MBEDTLS_CAMELLIA_SMALL_MEMORY << 3 |
+                     FB_MBEDTLS_CIPHER_MODE_CBC << 4 |
+                     FB_MBEDTLS_CIPHER_MODE_CFB << 5 |
+                     FB_MBEDTLS_CIPHER_MODE_CTR << 6 |
+                     FB_MBEDTLS_CIPHER_MODE_XTS << 7 ),
+    (unsigned char)( FB_MBEDTLS_CIPHER_NULL_CIPHER << 0 |
+                     FB_MBEDTLS_SINGLE_BACKEND_DISPATCH << 1 |
+                     FB_MBEDTLS_CIPHER_PADDING_PKCS7 << 2 |
+                     FB_MBEDTLS_CIPHER_PADDING_ONE_AND_ZEROS << 3 |
+                     FB_MBEDTLS_CIPHER_PADDING_ZEROS_AND_LEN << 4 |
+                     FB_MBEDTLS_CIPHER_PADDING_ZEROS << 5 |
+                     FB_MBEDTLS_ENABLE_WEAK_CIPHERSUITES << 6 |
+                     FB_MBEDTLS_REMOVE_ARC4_CIPHERSUITES << 7 ),
+    (unsigned char)( FB_MBEDTLS_ECP_DP_SECP192R1_ENABLED << 0 |
+                     FB_MBEDTLS_ECP_DP_SECP224R1_ENABLED << 1 |
+                     FB_MBEDTLS_ECP_DP_SECP256R1_ENABLED << 2 |
+                     FB_MBEDTLS_ECP_DP_SECP384R1_ENABLED << 3 |
+                     FB_MBEDTLS_ECP_DP_SECP521R1_ENABLED << 4 |
+                     FB_MBEDTLS_ECP_DP_SECP192K1_ENABLED << 5 |
+                     FB_MBEDTLS_ECP_DP_SECP224K1_ENABLED << 6 |
+                     FB_MBEDTLS_ECP_DP_SECP256K1_ENABLED << 7 ),
+    (unsigned char)( FB_MBEDTLS_ECP_DP_BP256R1_ENABLED << 0 |
+                     FB_MBEDTLS_ECP_DP_BP384R1_ENABLED << 1 |
+                     FB_MBEDTLS_ECP_DP_BP512R1_ENABLED << 2 |
+                     FB_MBEDTLS_ECP_DP_CURVE25519_ENABLED << 3 |
+                     FB_MBEDTLS_ECP_NIST_OPTIM << 4 |
+                     FB_MBEDTLS_ECP_COMB_TABLE_CACHE << 5 |
+                     FB_MBEDTLS_ECP_RESTARTABLE << 6 |
+                     FB_MBEDTLS_ECDSA_DETERMINISTIC << 7 ),
+    (unsigned char)( FB_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED << 0 |
+                     FB_MBEDTLS_KEY_EXCHANGE_DHE_PSK_ENABLED << 1 |
+                     FB_MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED << 2 |
+                     FB_MBEDTLS_KEY_EXCHANGE_RSA_PSK_ENABLED << 3 |
+                     FB_MBEDTLS_KEY_EXCHANGE_RSA_ENABLED << 4 |
+                     FB_MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED << 5 |
+                     FB_MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED << 6 |
+                     FB_MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED << 7 ),
+    (unsigned char)( FB_MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED << 0 |
+                     FB_MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED << 1 |
+                     FB_MBEDTLS_PK_PARSE_EC_EXTENDED << 2 |
+                     FB_MBEDTLS_ERROR_STRERROR_DUMMY << 3 |
+                     FB_MBEDTLS_GENPRIME << 4 |
+                     FB_MBEDTLS_FS_IO << 5 |
+                     FB_MBEDTLS_CTR_DRBG_FORK_CHECK << 6 |
+                     FB_MBEDTLS_GCM_LARGETABLE << 7 ),
+    (unsigned char)( FB_MBEDTLS_NO_DEFAULT_ENTROPY_SOURCES << 0 |
+                     FB_MBEDTLS_NO_PLATFORM_ENTROPY << 1 |
+                     FB_MBEDTLS_ENTROPY_FORCE_SHA256 << 2 |
+                     FB_MBEDTLS_ENTROPY_PREFETCH << 3 |
+                     FB_MBEDTLS_MD_HMAC_CACHE << 4 |
+                     FB_MBEDTLS_MEMORY_DEBUG << 5 |
+                     FB_MBEDTLS_MEMORY_BACKTRACE << 6 |
+                     FB_MBEDTLS_MEMORY_TAGGING << 7 ),
+    (unsigned char)( FB_MBEDTLS_MEMORY_ARENAS << 0 |
+                     FB_MBEDTLS_MPI_MUL_WIDE << 1 |
+                     FB_MBEDTLS_PK_RSA_ALT_SUPPORT << 2 |
+                     FB_MBEDTLS_PKCS1_V15 << 3 |
+                     FB_MBEDTLS_PKCS1_V21 << 4 |
+                     FB_MBEDTLS_RSA_NO_CRT << 5 |
+                     FB_MBEDTLS_SELF_TEST << 6 |
+                     FB_MBEDTLS_SHA256_SMALLER << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_AEAD_RANDOM_IV << 0 |
+                     FB_MBEDTLS_SSL_ALL_ALERT_MESSAGES << 1 |
+                     FB_MBEDTLS_SSL_DEBUG_ALL << 2 |
+                     FB_MBEDTLS_SSL_ECDH_REUSE << 3 |
+                     FB_MBEDTLS_SSL_ENCRYPT_THEN_MAC << 4 |
+                     FB_MBEDTLS_SSL_EXTENDED_MASTER_SECRET << 5 |
+                     FB_MBEDTLS_SSL_FALLBACK_SCSV << 6 |
+                     FB_MBEDTLS_SSL_FALSE_START << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_HS_TIMING << 0 |
+                     FB_MBEDTLS_SSL_HW_RECORD_ACCEL << 1 |
+                     FB_MBEDTLS_SSL_OUT_DOUBLE_BUFFER << 2 |
+                     FB_MBEDTLS_SSL_CBC_RECORD_SPLITTING << 3 |
+                     FB_MBEDTLS_SSL_RECORD_PADDING << 4 |
+                     FB_MBEDTLS_SSL_RECORD_KEY_EXPORT << 5 |
+                     FB_MBEDTLS_SSL_RECORD_SPECIALIZE << 6 |
+                     FB_MBEDTLS_SSL_RENEGOTIATION << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_SRV_SUPPORT_SSLV2_CLIENT_HELLO << 0 |
+                     FB_MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE << 1 |
+                     FB_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH << 2 |
+                     FB_MBEDTLS_SSL_PROTO_SSL3 << 3 |
+                     FB_MBEDTLS_SSL_PROTO_TLS1 << 4 |
+                     FB_MBEDTLS_SSL_PROTO_TLS1_1 << 5 |
+                     FB_MBEDTLS_SSL_PROTO_TLS1_2 << 6 |
+                     FB_MBEDTLS_SSL_PROTO_DTLS << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_ALPN << 0 |
+                     FB_MBEDTLS_SSL_ASYNC_PRIVATE << 1 |
+                     FB_MBEDTLS_SSL_DTLS_ANTI_REPLAY << 2 |
+                     FB_MBEDTLS_SSL_DTLS_HELLO_VERIFY << 3 |
+                     FB_MBEDTLS_SSL_DTLS_BADMAC_LIMIT << 4 |
+                     FB_MBEDTLS_SSL_SESSION_TICKETS << 5 |
+                     FB_MBEDTLS_SSL_SERVER_NAME_INDICATION << 6 |
+                     FB_MBEDTLS_SSL_STATS << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_TRUNCATED_HMAC << 0 |
+                     FB_MBEDTLS_SSL_TRANSFORM_POOL << 1 |
+                     FB_MBEDTLS_SSL_HANDSHAKE_POOL << 2 |
+                     FB_MBEDTLS_THREADING_ALT << 3 |
+                     FB_MBEDTLS_THREADING_PTHREAD << 4 |
+                     FB_MBEDTLS_THREADING_SPIN << 5 |
+                     FB_MBEDTLS_TIMING_COARSE << 6 |
+                     FB_MBEDTLS_TIMING_TRACE << 7 ),
+    (unsigned char)( FB_MBEDTLS_VERSION_FEATURES << 0 |
+                     FB_MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3 << 1 |
+                     FB_MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION << 2 |
+                     FB_MBEDTLS_X509_CRT_LAZY_EXTENSIONS << 3 |
+                     FB_MBEDTLS_X509_CRT_ARENA << 4 |
+                     FB_MBEDTLS_X509_CRT_HOST_TABLE << 5 |
+                     FB_MBEDTLS_X509_DN_CACHE << 6 |
+                     FB_MBEDTLS_X509_CHECK_KEY_USAGE << 7 ),
+    (unsigned char)( FB_MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE << 0 |
+                     FB_MBEDTLS_X509_RSASSA_PSS_SUPPORT << 1 |
+                     FB_MBEDTLS_ZLIB_SUPPORT << 2 |
+                     FB_MBEDTLS_AESNI_C << 3 |
+                     FB_MBEDTLS_ARMCE_C << 4 |
+                     FB_MBEDTLS_AESCT_C << 5 |
+                     FB_MBEDTLS_AES_C << 6 |
+                     FB_MBEDTLS_ARC4_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_ASN1_PARSE_C << 0 |
+                     FB_MBEDTLS_ASN1_WRITE_C << 1 |
+                     FB_MBEDTLS_BASE64_C << 2 |
+                     FB_MBEDTLS_BIGNUM_C << 3 |
+                     FB_MBEDTLS_BLOWFISH_C << 4 |
+                     FB_MBEDTLS_CAMELLIA_C << 5 |
+                     FB_MBEDTLS_CCM_C << 6 |
+                     FB_MBEDTLS_CERTS_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_CHACHA20_C << 0 |
+                     FB_MBEDTLS_CHACHAPOLY_C << 1 |
+                     FB_MBEDTLS_CIPHER_C << 2 |
+                     FB_MBEDTLS_CTR_DRBG_C << 3 |
+                     FB_MBEDTLS_DEBUG_C << 4 |
+                     FB_MBEDTLS_DES_C << 5 |
+                     FB_MBEDTLS_DHM_C << 6 |
+                     FB_MBEDTLS_ECDH_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_ECDSA_C << 0 |
+                     FB_MBEDTLS_ECP_C << 1 |
+                     FB_MBEDTLS_ENTROPY_C << 2 |
+                     FB_MBEDTLS_ERROR_C << 3 |
+                     FB_MBEDTLS_GCM_C << 4 |
+                     FB_MBEDTLS_HAVEGE_C << 5 |
+                     FB_MBEDTLS_HMAC_DRBG_C << 6 |
+                     FB_MBEDTLS_MD_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_MD2_C << 0 |
+                     FB_MBEDTLS_MD4_C << 1 |
+                     FB_MBEDTLS_MD5_C << 2 |
+                     FB_MBEDTLS_MEMORY_BUFFER_ALLOC_C << 3 |
+                     FB_MBEDTLS_NET_C << 4 |
+                     FB_MBEDTLS_OID_C << 5 |
+                     FB_MBEDTLS_PADLOCK_C << 6 |
+                     FB_MBEDTLS_PEM_PARSE_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_PEM_WRITE_C << 0 |
+                     FB_MBEDTLS_PK_C << 1 |
+                     FB_MBEDTLS_PK_PARSE_C << 2 |
+                     FB_MBEDTLS_PK_WRITE_C << 3 |
+                     FB_MBEDTLS_PKCS5_C << 4 |
+                     FB_MBEDTLS_PKCS11_C << 5 |
+                     FB_MBEDTLS_PKCS12_C << 6 |
+                     FB_MBEDTLS_PLATFORM_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_POLY1305_C << 0 |
+                     FB_MBEDTLS_RIPEMD160_C << 1 |
+                     FB_MBEDTLS_RSA_C << 2 |
+                     FB_MBEDTLS_SHA1_C << 3 |
+                     FB_MBEDTLS_SHA256_C << 4 |
+                     FB_MBEDTLS_SHA256MB_C << 5 |
+                     FB_MBEDTLS_SHA512_C << 6 |
+                     FB_MBEDTLS_SHANI_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_BIO_PAIR_C << 0 |
+                     FB_MBEDTLS_SSL_CACHE_C << 1 |
+                     FB_MBEDTLS_SSL_CACHE_SHM_C << 2 |
+                     FB_MBEDTLS_SSL_COOKIE_C << 3 |
+                     FB_MBEDTLS_SSL_DEMUX_C << 4 |
+                     FB_MBEDTLS_SSL_PSK_STORE_C << 5 |
+                     FB_MBEDTLS_SSL_SCHED_C << 6 |
+                     FB_MBEDTLS_SSL_TICKET_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_SSL_CLI_C << 0 |
+                     FB_MBEDTLS_SSL_SRV_C << 1 |
+                     FB_MBEDTLS_SSL_TLS_C << 2 |
+                     FB_MBEDTLS_THREADING_C << 3 |
+                     FB_MBEDTLS_TIMING_C << 4 |
+                     FB_MBEDTLS_VERSION_C << 5 |
+                     FB_MBEDTLS_WARMUP_C << 6 |
+                     FB_MBEDTLS_X509_USE_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_X509_CRT_PARSE_C << 0 |
+                     FB_MBEDTLS_X509_CRT_CACHE_C << 1 |
+                     FB_MBEDTLS_X509_TRUST_C << 2 |
+                     FB_MBEDTLS_X509_VERIFY_CACHE_C << 3 |
+                     FB_MBEDTLS_X509_CRL_PARSE_C << 4 |
+                     FB_MBEDTLS_X509_CRL_SET_C << 5 |
+                     FB_MBEDTLS_X509_CSR_PARSE_C << 6 |
+                     FB_MBEDTLS_X509_CREATE_C << 7 ),
+    (unsigned char)( FB_MBEDTLS_X509_CRT_WRITE_C << 0 |
+                     FB_MBEDTLS_X509_CSR_WRITE_C << 1 |
+                     FB_MBEDTLS_XTEA_C << 2 ),
+};
+#endif /* MBEDTLS_VERSION_FEATURES */
+
 int mbedtls_version_check_feature( const char *feature )
 {
     const char **idx = features;
@@ -621,4 +2183,43 @@ int mbedtls_version_check_feature( const char *feature )
     return( -1 );
 }
 
+int mbedtls_version_check_feature_id( mbedtls_feature_t feature )
+{
+#if defined(MBEDTLS_VERSION_FEATURES)
+    size_t idx = (size_t) feature;
+
+    if( idx >= (size_t) MBEDTLS_FEATURE_COUNT )
+        return( -1 );
+
+    if( ( feature_bitmap[idx >> 3] >> ( idx & 7 ) ) & 1 )
+        return( 0 );
+
+    return( -1 );
+#else
+    ((void) feature);
+
+    return( -2 );
+#endif /* MBEDTLS_VERSION_FEATURES */
+}
+
+size_t mbedtls_version_feature_bitmap( unsigned char *bitmap, size_t len )
+{
+#if defined(MBEDTLS_VERSION_FEATURES)
+    if( bitmap != NULL )
+    {
+        if( len > sizeof( feature_bitmap ) )
+            len = sizeof( feature_bitmap );
+
+        memcpy( bitmap, feature_bitmap, len );
+    }
+
+    return( sizeof( feature_bitmap ) );
+#else
+    ((void) bitmap);
+    ((void) len);
+
+    return( 0 );
+#endif /* MBEDTLS_VERSION_FEATURES */
+}
+
 #endif /* MBEDTLS_VERSION_C */
@@ -0,0 +1,151 @@
+/*
+ *  Precompute lazily-built tables during process initialization
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_WARMUP_C)
+
+#include "mbedtls/warmup.h"
+
+#if defined(MBEDTLS_AES_C)
+#include "mbedtls/aes.h"
+#endif
+
+#if defined(MBEDTLS_GCM_C)
+#include "mbedtls/gcm.h"
+#endif
+
+#if defined(MBEDTLS_ECP_C)
+#include "mbedtls/ecp.h"
+#endif
+
+#include <string.h>
+
+int mbedtls_warmup( void )
+{
+    int ret = 0;
+
+#if defined(MBEDTLS_AES_C)
+    {
+        mbedtls_aes_context aes;
+        unsigned char key[16];
+        unsigned char block[16];
+
+        memset( key, 0, sizeof( key ) );
+        memset( block, 0, sizeof( block ) );
+
+        /* The key schedules generate the S-boxes and round tables when
+         * MBEDTLS_AES_ROM_TABLES is unset; the encryption walks the
+         * forward tables so they are resident too */
+        mbedtls_aes_init( &aes );
+
+        if( ( ret = mbedtls_aes_setkey_enc( &aes, key, 128 ) ) == 0 &&
+            ( ret = mbedtls_aes_setkey_dec( &aes, key, 128 ) ) == 0 )
+        {
+            ret = mbedtls_aes_crypt_ecb( &aes, MBEDTLS_AES_ENCRYPT,
+                                         block, block );
+        }
+
+        mbedtls_aes_free( &aes );
+
+        if( ret != 0 )
+            return( ret );
+    }
+#endif /* MBEDTLS_AES_C */
+
+#if defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+    {
+        mbedtls_gcm_context gcm;
+        unsigned char key[16];
+
+        memset( key, 0, sizeof( key ) );
+
+        /* GHASH tables are per key, so they cannot be built for keys
+         * that do not exist yet; one key schedule pages in the table
+         * generation code and settles the CLMUL/PMULL dispatch */
+        mbedtls_gcm_init( &gcm );
+
+        ret = mbedtls_gcm_setkey( &gcm, MBEDTLS_CIPHER_ID_AES, key, 128 );
+
+        mbedtls_gcm_free( &gcm );
+
+        if( ret != 0 )
+            return( ret );
+    }
+#endif /* MBEDTLS_GCM_C && MBEDTLS_AES_C */
+
+#if defined(MBEDTLS_ECP_C)
+    {
+        const mbedtls_ecp_curve_info *info;
+        mbedtls_ecp_group grp;
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+        mbedtls_ecp_point R;
+        mbedtls_mpi m;
+
+        mbedtls_ecp_point_init( &R );
+        mbedtls_mpi_init( &m );
+#endif
+        mbedtls_ecp_group_init( &grp );
+
+        for( info = mbedtls_ecp_curve_list();
+             info->grp_id != MBEDTLS_ECP_DP_NONE; info++ )
+        {
+            /* Loads the curve constants */
+            if( ( ret = mbedtls_ecp_group_load( &grp, info->grp_id ) ) != 0 )
+                break;
+
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+            /* Montgomery curves have no comb table */
+#if defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
+            if( info->grp_id == MBEDTLS_ECP_DP_CURVE25519 )
+                continue;
+#endif
+            /* One multiplication of the base point computes and
+             * publishes the shared comb table for this curve */
+            if( ( ret = mbedtls_mpi_lset( &m, 2 ) ) != 0 ||
+                ( ret = mbedtls_ecp_mul( &grp, &R, &m, &grp.G,
+                                         NULL, NULL ) ) != 0 )
+            {
+                break;
+            }
+#endif /* MBEDTLS_ECP_COMB_TABLE_CACHE */
+        }
+
+        mbedtls_ecp_group_free( &grp );
+#if defined(MBEDTLS_ECP_COMB_TABLE_CACHE)
+        mbedtls_ecp_point_free( &R );
+        mbedtls_mpi_free( &m );
+#endif
+
+        if( ret != 0 )
+            return( ret );
+    }
+#endif /* MBEDTLS_ECP_C */
+
+    return( 0 );
+}
+
+#endif /* MBEDTLS_WARMUP_C */
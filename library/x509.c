@@ -422,8 +422,42 @@ static int x509_get_attr_type_value( unsigned char **p,
  * same set so that they are "merged" together in the functions that consume
  * this list, eg mbedtls_x509_dn_gets().
  */
+/*
+ * Carve a zeroed node out of an arena, or fall back to the heap when no
+ * arena (or no arena buffer) is given. Arena-backed nodes must not be
+ * freed individually; the owner frees the whole block at once.
+ */
+void *mbedtls_x509_arena_alloc( mbedtls_x509_arena *arena, size_t size )
+{
+    unsigned char *ret;
+
+    /* Keep subsequent nodes naturally aligned */
+    size = ( size + sizeof( void * ) - 1 ) & ~( sizeof( void * ) - 1 );
+
+    if( arena == NULL )
+        return( mbedtls_calloc( 1, size ) );
+
+#if defined(MBEDTLS_X509_CRT_ARENA)
+    if( size <= sizeof( arena->fixed ) - arena->fixed_used )
+    {
+        ret = arena->fixed + arena->fixed_used;
+        arena->fixed_used += size;
+
+        return( ret );
+    }
+#endif
+
+    if( arena->buf == NULL || size > arena->len - arena->used )
+        return( mbedtls_calloc( 1, size ) );
+
+    ret = arena->buf + arena->used;
+    arena->used += size;
+
+    return( ret );
+}
+
 int mbedtls_x509_get_name( unsigned char **p, const unsigned char *end,
-                   mbedtls_x509_name *cur )
+                   mbedtls_x509_name *cur, mbedtls_x509_arena *arena )
 {
     int ret;
     size_t set_len;
@@ -452,7 +486,8 @@ int mbedtls_x509_get_name( unsigned char **p, const unsigned char *end,
             /* Mark this item as being no the only one in a set */
             cur->next_merged = 1;
 
-            cur->next = mbedtls_calloc( 1, sizeof( mbedtls_x509_name ) );
+            cur->next = mbedtls_x509_arena_alloc( arena,
+                                                  sizeof( mbedtls_x509_name ) );
 
             if( cur->next == NULL )
                 return( MBEDTLS_ERR_X509_ALLOC_FAILED );
@@ -466,7 +501,8 @@ int mbedtls_x509_get_name( unsigned char **p, const unsigned char *end,
         if( *p == end )
             return( 0 );
 
-        cur->next = mbedtls_calloc( 1, sizeof( mbedtls_x509_name ) );
+        cur->next = mbedtls_x509_arena_alloc( arena,
+                                              sizeof( mbedtls_x509_name ) );
 
         if( cur->next == NULL )
             return( MBEDTLS_ERR_X509_ALLOC_FAILED );
@@ -0,0 +1,392 @@
+/*
+ *  Compact sorted-array representation of CRL revocation data
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Revoked serials are stored as fixed-size records: one length byte, then
+ * the serial value right-aligned in a zero-padded 20-octet field. Records
+ * therefore order by (length, value) under a plain memcmp(), which gives
+ * binary search, sorted merge for delta updates, and a storage format that
+ * doubles as the file format.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_X509_CRL_SET_C)
+
+#include "mbedtls/x509_crl_set.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_free       free
+#define mbedtls_calloc    calloc
+#endif
+
+#define RECORD_SIZE     MBEDTLS_X509_CRL_SET_RECORD_SIZE
+#define RECORD( set, i )    ( (set)->records + (i) * RECORD_SIZE )
+
+void mbedtls_x509_crl_set_init( mbedtls_x509_crl_set *set )
+{
+    memset( set, 0, sizeof( mbedtls_x509_crl_set ) );
+}
+
+/*
+ * Canonicalize a raw serial into record form: strip leading zero octets,
+ * right-align the value. Serials longer than 20 octets are not valid
+ * (RFC 5280) and cannot be represented.
+ */
+static int x509_crl_set_record( unsigned char rec[RECORD_SIZE],
+                                const mbedtls_x509_buf *serial )
+{
+    size_t len = serial->len;
+    const unsigned char *p = serial->p;
+
+    while( len > 0 && *p == 0 )
+    {
+        p++;
+        len--;
+    }
+
+    if( len > RECORD_SIZE - 1 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    memset( rec, 0, RECORD_SIZE );
+    rec[0] = (unsigned char) len;
+    memcpy( rec + RECORD_SIZE - len, p, len );
+
+    return( 0 );
+}
+
+/*
+ * In-place heapsort of the record array; the C library's qsort() is not
+ * used anywhere in this library
+ */
+static void x509_crl_set_sift_down( unsigned char *recs, size_t start,
+                                    size_t end )
+{
+    size_t root = start, child;
+    unsigned char tmp[RECORD_SIZE];
+
+    while( ( child = 2 * root + 1 ) < end )
+    {
+        if( child + 1 < end &&
+            memcmp( recs + child * RECORD_SIZE,
+                    recs + ( child + 1 ) * RECORD_SIZE, RECORD_SIZE ) < 0 )
+            child++;
+
+        if( memcmp( recs + root * RECORD_SIZE,
+                    recs + child * RECORD_SIZE, RECORD_SIZE ) >= 0 )
+            return;
+
+        memcpy( tmp, recs + root * RECORD_SIZE, RECORD_SIZE );
+        memcpy( recs + root * RECORD_SIZE,
+                recs + child * RECORD_SIZE, RECORD_SIZE );
+        memcpy( recs + child * RECORD_SIZE, tmp, RECORD_SIZE );
+
+        root = child;
+    }
+}
+
+static void x509_crl_set_sort( unsigned char *recs, size_t count )
+{
+    size_t i;
+    unsigned char tmp[RECORD_SIZE];
+
+    if( count < 2 )
+        return;
+
+    for( i = count / 2; i > 0; i-- )
+        x509_crl_set_sift_down( recs, i - 1, count );
+
+    for( i = count - 1; i > 0; i-- )
+    {
+        memcpy( tmp, recs, RECORD_SIZE );
+        memcpy( recs, recs + i * RECORD_SIZE, RECORD_SIZE );
+        memcpy( recs + i * RECORD_SIZE, tmp, RECORD_SIZE );
+
+        x509_crl_set_sift_down( recs, 0, i );
+    }
+}
+
+/*
+ * Remove adjacent duplicates from a sorted record array, returns the new
+ * count
+ */
+static size_t x509_crl_set_dedup( unsigned char *recs, size_t count )
+{
+    size_t i, out = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( out > 0 &&
+            memcmp( recs + ( out - 1 ) * RECORD_SIZE,
+                    recs + i * RECORD_SIZE, RECORD_SIZE ) == 0 )
+            continue;
+
+        if( out != i )
+            memcpy( recs + out * RECORD_SIZE,
+                    recs + i * RECORD_SIZE, RECORD_SIZE );
+        out++;
+    }
+
+    return( out );
+}
+
+/*
+ * Collect the entries of a CRL chain into a fresh sorted, deduplicated
+ * record array
+ */
+static int x509_crl_set_collect( const mbedtls_x509_crl *crl,
+                                 unsigned char **recs, size_t *count )
+{
+    int ret;
+    size_t n = 0;
+    const mbedtls_x509_crl *cur;
+    const mbedtls_x509_crl_entry *entry;
+    unsigned char *buf;
+
+    for( cur = crl; cur != NULL && cur->version != 0; cur = cur->next )
+        for( entry = &cur->entry; entry != NULL; entry = entry->next )
+            if( entry->serial.p != NULL )
+                n++;
+
+    *recs = NULL;
+    *count = 0;
+
+    if( n == 0 )
+        return( 0 );
+
+    if( ( buf = mbedtls_calloc( n, RECORD_SIZE ) ) == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    n = 0;
+    for( cur = crl; cur != NULL && cur->version != 0; cur = cur->next )
+    {
+        for( entry = &cur->entry; entry != NULL; entry = entry->next )
+        {
+            if( entry->serial.p == NULL )
+                continue;
+
+            if( ( ret = x509_crl_set_record( buf + n * RECORD_SIZE,
+                                             &entry->serial ) ) != 0 )
+            {
+                mbedtls_free( buf );
+                return( ret );
+            }
+            n++;
+        }
+    }
+
+    x509_crl_set_sort( buf, n );
+
+    *recs = buf;
+    *count = x509_crl_set_dedup( buf, n );
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_from_crl( mbedtls_x509_crl_set *set,
+                                   const mbedtls_x509_crl *crl )
+{
+    int ret;
+    unsigned char *recs;
+    size_t count;
+
+    if( ( ret = x509_crl_set_collect( crl, &recs, &count ) ) != 0 )
+        return( ret );
+
+    mbedtls_x509_crl_set_free( set );
+
+    set->records = recs;
+    set->count = count;
+    set->owned = 1;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_apply( mbedtls_x509_crl_set *set,
+                                const mbedtls_x509_crl *delta )
+{
+    int ret;
+    unsigned char *add, *merged, *out;
+    const unsigned char *a, *a_end, *b, *b_end;
+    size_t add_count;
+    int cmp;
+
+    if( ( ret = x509_crl_set_collect( delta, &add, &add_count ) ) != 0 )
+        return( ret );
+
+    if( add_count == 0 )
+        return( 0 );
+
+    if( set->count == 0 )
+    {
+        mbedtls_x509_crl_set_free( set );
+        set->records = add;
+        set->count = add_count;
+        set->owned = 1;
+        return( 0 );
+    }
+
+    merged = mbedtls_calloc( set->count + add_count, RECORD_SIZE );
+    if( merged == NULL )
+    {
+        mbedtls_free( add );
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+    }
+
+    a = set->records;
+    a_end = a + set->count * RECORD_SIZE;
+    b = add;
+    b_end = b + add_count * RECORD_SIZE;
+    out = merged;
+
+    while( a < a_end || b < b_end )
+    {
+        if( a == a_end )
+            cmp = 1;
+        else if( b == b_end )
+            cmp = -1;
+        else
+            cmp = memcmp( a, b, RECORD_SIZE );
+
+        if( cmp <= 0 )
+        {
+            memcpy( out, a, RECORD_SIZE );
+            a += RECORD_SIZE;
+            if( cmp == 0 )
+                b += RECORD_SIZE;
+        }
+        else
+        {
+            memcpy( out, b, RECORD_SIZE );
+            b += RECORD_SIZE;
+        }
+        out += RECORD_SIZE;
+    }
+
+    mbedtls_free( add );
+    mbedtls_x509_crl_set_free( set );
+
+    set->records = merged;
+    set->count = ( out - merged ) / RECORD_SIZE;
+    set->owned = 1;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_setup_buf( mbedtls_x509_crl_set *set,
+                                    const unsigned char *buf, size_t buflen )
+{
+    size_t i, count;
+
+    if( buflen % RECORD_SIZE != 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    count = buflen / RECORD_SIZE;
+
+    for( i = 1; i < count; i++ )
+        if( memcmp( buf + ( i - 1 ) * RECORD_SIZE,
+                    buf + i * RECORD_SIZE, RECORD_SIZE ) >= 0 )
+            return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    mbedtls_x509_crl_set_free( set );
+
+    set->records = (unsigned char *) buf;
+    set->count = count;
+    set->owned = 0;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_export( const mbedtls_x509_crl_set *set,
+                                 unsigned char *buf, size_t size,
+                                 size_t *olen )
+{
+    *olen = set->count * RECORD_SIZE;
+
+    if( size < *olen )
+        return( MBEDTLS_ERR_X509_BUFFER_TOO_SMALL );
+
+    memcpy( buf, set->records, *olen );
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_is_revoked( const mbedtls_x509_crl_set *set,
+                                     const mbedtls_x509_buf *serial )
+{
+    unsigned char rec[RECORD_SIZE];
+    size_t lo, hi, mid;
+    int cmp;
+
+    if( set->count == 0 ||
+        x509_crl_set_record( rec, serial ) != 0 )
+        return( 0 );
+
+    lo = 0;
+    hi = set->count;
+    while( lo < hi )
+    {
+        mid = lo + ( hi - lo ) / 2;
+        cmp = memcmp( RECORD( set, mid ), rec, RECORD_SIZE );
+
+        if( cmp == 0 )
+            return( 1 );
+        if( cmp < 0 )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return( 0 );
+}
+
+int mbedtls_x509_crl_set_check_crt( const mbedtls_x509_crl_set *set,
+                                    const mbedtls_x509_crt *crt )
+{
+    if( mbedtls_x509_crl_set_is_revoked( set, &crt->serial ) )
+        return( MBEDTLS_X509_BADCERT_REVOKED );
+
+    return( 0 );
+}
+
+size_t mbedtls_x509_crl_set_len( const mbedtls_x509_crl_set *set )
+{
+    return( set->count );
+}
+
+void mbedtls_x509_crl_set_free( mbedtls_x509_crl_set *set )
+{
+    if( set->owned )
+        mbedtls_free( set->records );
+
+    memset( set, 0, sizeof( mbedtls_x509_crl_set ) );
+}
+
+#endif /* MBEDTLS_X509_CRL_SET_C */
@@ -41,6 +41,14 @@
 #include "mbedtls/x509_crt.h"
 #include "mbedtls/oid.h"
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+#include "mbedtls/x509_crt_cache.h"
+#endif
+
+#if defined(MBEDTLS_X509_TRUST_C)
+#include "mbedtls/x509_trust.h"
+#endif
+
 #include <stdio.h>
 #include <string.h>
 
@@ -61,6 +69,10 @@
 #include "mbedtls/threading.h"
 #endif
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+#include "mbedtls/memory_buffer_alloc.h"
+#endif
+
 #if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
 #include <windows.h>
 #else
@@ -76,10 +88,35 @@
 #endif /* !_WIN32 || EFIX64 || EFI32 */
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
+#include "mbedtls/constant_time.h"
+
+/*
+ * Allocation source for a certificate's name and sequence list nodes:
+ * the per-certificate arena when enabled, the heap otherwise
+ */
+#if defined(MBEDTLS_X509_CRT_ARENA)
+#define X509_CRT_ARENA( crt )   ( &(crt)->arena )
+#else
+#define X509_CRT_ARENA( crt )   NULL
+#endif
+
+#if defined(MBEDTLS_X509_CRT_ARENA)
+/*
+ * Whether a list node was carved from this certificate's arena (inline
+ * block or spill buffer) rather than individually heap-allocated
+ */
+static int x509_crt_node_in_arena( const mbedtls_x509_arena *arena,
+                                   const void *node )
+{
+    const unsigned char *p = (const unsigned char *) node;
+
+    if( p >= arena->fixed && p < arena->fixed + sizeof( arena->fixed ) )
+        return( 1 );
+
+    return( arena->buf != NULL &&
+            p >= arena->buf && p < arena->buf + arena->len );
 }
+#endif /* MBEDTLS_X509_CRT_ARENA */
 
 /*
  * Default profile
@@ -398,13 +435,56 @@ static int x509_get_key_usage( unsigned char **p,
  */
 static int x509_get_ext_key_usage( unsigned char **p,
                                const unsigned char *end,
-                               mbedtls_x509_sequence *ext_key_usage)
+                               mbedtls_x509_sequence *ext_key_usage,
+                               mbedtls_x509_arena *arena )
 {
     int ret;
+    size_t len;
+    mbedtls_asn1_buf *buf;
+    mbedtls_asn1_sequence *cur = ext_key_usage;
 
-    if( ( ret = mbedtls_asn1_get_sequence_of( p, end, ext_key_usage, MBEDTLS_ASN1_OID ) ) != 0 )
+    /* Same as mbedtls_asn1_get_sequence_of( ..., MBEDTLS_ASN1_OID ),
+     * with the list nodes taken from the certificate's arena */
+    if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
         return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
 
+    if( *p + len != end )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    while( *p < end )
+    {
+        /* Allocate and assign next pointer */
+        if( cur->buf.p != NULL )
+        {
+            if( cur->next != NULL )
+                return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS );
+
+            cur->next = mbedtls_x509_arena_alloc( arena,
+                                            sizeof( mbedtls_asn1_sequence ) );
+
+            if( cur->next == NULL )
+                return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                        MBEDTLS_ERR_ASN1_ALLOC_FAILED );
+
+            cur = cur->next;
+        }
+
+        buf = &(cur->buf);
+        buf->tag = **p;
+
+        if( ( ret = mbedtls_asn1_get_tag( p, end, &buf->len,
+                                          MBEDTLS_ASN1_OID ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        buf->p = *p;
+        *p += buf->len;
+    }
+
+    /* Set final sequence entry's next pointer to NULL */
+    cur->next = NULL;
+
     /* Sequence length must be >= 1 */
     if( ext_key_usage->buf.p == NULL )
         return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
@@ -441,7 +521,8 @@ static int x509_get_ext_key_usage( unsigned char **p,
  */
 static int x509_get_subject_alt_name( unsigned char **p,
                                       const unsigned char *end,
-                                      mbedtls_x509_sequence *subject_alt_name )
+                                      mbedtls_x509_sequence *subject_alt_name,
+                                      mbedtls_x509_arena *arena )
 {
     int ret;
     size_t len, tag_len;
@@ -486,7 +567,8 @@ static int x509_get_subject_alt_name( unsigned char **p,
             if( cur->next != NULL )
                 return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS );
 
-            cur->next = mbedtls_calloc( 1, sizeof( mbedtls_asn1_sequence ) );
+            cur->next = mbedtls_x509_arena_alloc( arena,
+                                            sizeof( mbedtls_asn1_sequence ) );
 
             if( cur->next == NULL )
                 return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
@@ -626,17 +708,31 @@ static int x509_get_crt_ext( unsigned char **p,
             break;
 
         case MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE:
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+            /* Record the raw extension, parsed on first use */
+            crt->eku_raw.p = *p;
+            crt->eku_raw.len = end_ext_octet - *p;
+            *p = end_ext_octet;
+#else
             /* Parse extended key usage */
             if( ( ret = x509_get_ext_key_usage( p, end_ext_octet,
-                    &crt->ext_key_usage ) ) != 0 )
+                    &crt->ext_key_usage, X509_CRT_ARENA( crt ) ) ) != 0 )
                 return( ret );
+#endif
             break;
 
         case MBEDTLS_X509_EXT_SUBJECT_ALT_NAME:
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+            /* Record the raw extension, parsed on first use */
+            crt->san_raw.p = *p;
+            crt->san_raw.len = end_ext_octet - *p;
+            *p = end_ext_octet;
+#else
             /* Parse subject alt name */
             if( ( ret = x509_get_subject_alt_name( p, end_ext_octet,
-                    &crt->subject_alt_names ) ) != 0 )
+                    &crt->subject_alt_names, X509_CRT_ARENA( crt ) ) ) != 0 )
                 return( ret );
+#endif
             break;
 
         case MBEDTLS_X509_EXT_NS_CERT_TYPE:
@@ -658,9 +754,110 @@ static int x509_get_crt_ext( unsigned char **p,
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+/*
+ * Build the subjectAltName and extendedKeyUsage lists from the raw
+ * extension data recorded at parse time. Idempotent.
+ */
+int mbedtls_x509_crt_materialize_exts( mbedtls_x509_crt *crt )
+{
+    int ret;
+    unsigned char *p;
+
+    if( ( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME ) != 0 &&
+        crt->subject_alt_names.buf.p == NULL && crt->san_raw.p != NULL )
+    {
+        p = crt->san_raw.p;
+        if( ( ret = x509_get_subject_alt_name( &p,
+                crt->san_raw.p + crt->san_raw.len,
+                &crt->subject_alt_names, X509_CRT_ARENA( crt ) ) ) != 0 )
+            return( ret );
+    }
+
+    if( ( crt->ext_types & MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE ) != 0 &&
+        crt->ext_key_usage.buf.p == NULL && crt->eku_raw.p != NULL )
+    {
+        p = crt->eku_raw.p;
+        if( ( ret = x509_get_ext_key_usage( &p,
+                crt->eku_raw.p + crt->eku_raw.len,
+                &crt->ext_key_usage, X509_CRT_ARENA( crt ) ) ) != 0 )
+            return( ret );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_X509_CRT_LAZY_EXTENSIONS */
+
+#if defined(MBEDTLS_X509_CRT_ARENA)
+/*
+ * Count the TLVs in a DER blob, recursing into constructed ones.
+ *
+ * Every list node allocated while parsing a certificate corresponds to a
+ * distinct TLV (an AttributeTypeAndValue for name nodes, a GeneralName or
+ * KeyPurposeId for sequence nodes) and the head nodes are embedded in the
+ * structure, so this is an upper bound on the nodes the arena must hold.
+ * Recursion is capped; certificates nested deeper than any real-world
+ * profile are undercounted and fail cleanly with an allocation error.
+ */
+#define X509_CRT_ARENA_MAX_DEPTH    32
+
+static size_t x509_crt_count_tlvs( const unsigned char *p,
+                                   const unsigned char *end,
+                                   size_t depth )
+{
+    int ret;
+    size_t len, count = 0;
+    unsigned char tag, *q = (unsigned char *) p;
+
+    if( depth >= X509_CRT_ARENA_MAX_DEPTH )
+        return( 0 );
+
+    while( q < end )
+    {
+        tag = *q++;
+        if( ( ret = mbedtls_asn1_get_len( &q, end, &len ) ) != 0 ||
+            len > (size_t) ( end - q ) )
+            break;
+
+        count++;
+
+        if( ( tag & MBEDTLS_ASN1_CONSTRUCTED ) != 0 )
+            count += x509_crt_count_tlvs( q, q + len, depth + 1 );
+
+        q += len;
+    }
+
+    return( count );
+}
+#endif /* MBEDTLS_X509_CRT_ARENA */
+
 /*
  * Parse and fill a single X.509 certificate in DER format
  */
+#if defined(MBEDTLS_X509_DN_CACHE)
+/*
+ * Render a DN to a fresh heap string, or NULL on truncation or
+ * allocation failure (callers then fall back to mbedtls_x509_dn_gets())
+ */
+static char *x509_crt_render_dn( const mbedtls_x509_name *dn )
+{
+    int n;
+    char buf[512], *s;
+
+    n = mbedtls_x509_dn_gets( buf, sizeof( buf ), dn );
+    if( n < 0 )
+        return( NULL );
+
+    s = mbedtls_calloc( 1, (size_t) n + 1 );
+    if( s == NULL )
+        return( NULL );
+
+    memcpy( s, buf, (size_t) n );
+
+    return( s );
+}
+#endif /* MBEDTLS_X509_DN_CACHE */
+
 static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *buf,
                                     size_t buflen )
 {
@@ -689,6 +886,32 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
     crt->raw.len = len;
     end = p + len;
 
+#if defined(MBEDTLS_X509_CRT_ARENA)
+    /*
+     * Size the arena from a pre-scan of the DER structure. The inline
+     * block absorbs the typical certificate's name and sequence nodes;
+     * only what spills past it needs one heap allocation. On failure
+     * fall back to per-node heap allocations.
+     */
+    {
+        size_t node_size = sizeof( mbedtls_x509_name );
+        size_t count = x509_crt_count_tlvs( p, end, 0 );
+
+        if( node_size < sizeof( mbedtls_asn1_sequence ) )
+            node_size = sizeof( mbedtls_asn1_sequence );
+
+        if( count != 0 && count < (size_t) -1 / node_size &&
+            count * node_size > sizeof( crt->arena.fixed ) )
+        {
+            size_t spill = count * node_size - sizeof( crt->arena.fixed );
+
+            crt->arena.buf = mbedtls_calloc( 1, spill );
+            if( crt->arena.buf != NULL )
+                crt->arena.len = spill;
+        }
+    }
+#endif /* MBEDTLS_X509_CRT_ARENA */
+
     /*
      * Certificate  ::=  SEQUENCE  {
      *      tbsCertificate       TBSCertificate,
@@ -769,7 +992,8 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
-    if( ( ret = mbedtls_x509_get_name( &p, p + len, &crt->issuer ) ) != 0 )
+    if( ( ret = mbedtls_x509_get_name( &p, p + len, &crt->issuer,
+                                       X509_CRT_ARENA( crt ) ) ) != 0 )
     {
         mbedtls_x509_crt_free( crt );
         return( ret );
@@ -802,7 +1026,8 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
-    if( len && ( ret = mbedtls_x509_get_name( &p, p + len, &crt->subject ) ) != 0 )
+    if( len && ( ret = mbedtls_x509_get_name( &p, p + len, &crt->subject,
+                                              X509_CRT_ARENA( crt ) ) ) != 0 )
     {
         mbedtls_x509_crt_free( crt );
         return( ret );
@@ -904,6 +1129,11 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
                 MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
     }
 
+#if defined(MBEDTLS_X509_DN_CACHE)
+    crt->subject_dn = x509_crt_render_dn( &crt->subject );
+    crt->issuer_dn = x509_crt_render_dn( &crt->issuer );
+#endif
+
     return( 0 );
 }
 
@@ -916,6 +1146,9 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
 {
     int ret;
     mbedtls_x509_crt *crt = chain, *prev = NULL;
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    int prev_tag;
+#endif
 
     /*
      * Check for valid input
@@ -923,6 +1156,10 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
     if( crt == NULL || buf == NULL )
         return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    prev_tag = mbedtls_memory_buffer_set_tag( MBEDTLS_MEMORY_TAG_X509 );
+#endif
+
     while( crt->version != 0 && crt->next != NULL )
     {
         prev = crt;
@@ -937,7 +1174,10 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
         crt->next = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt ) );
 
         if( crt->next == NULL )
-            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+        {
+            ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+            goto exit;
+        }
 
         prev = crt;
         mbedtls_x509_crt_init( crt->next );
@@ -951,11 +1191,14 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
 
         if( crt != chain )
             mbedtls_free( crt );
-
-        return( ret );
     }
 
-    return( 0 );
+exit:
+#if defined(MBEDTLS_MEMORY_TAGGING)
+    (void) mbedtls_memory_buffer_set_tag( prev_tag );
+#endif
+
+    return( ret );
 }
 
 /*
@@ -1069,6 +1312,63 @@ int mbedtls_x509_crt_parse( mbedtls_x509_crt *chain, const unsigned char *buf, s
         return( MBEDTLS_ERR_X509_CERT_UNKNOWN_FORMAT );
 }
 
+/*
+ * Load every certificate from a packed bundle image
+ */
+int mbedtls_x509_crt_parse_packed( mbedtls_x509_crt *chain,
+                                   const unsigned char *buf, size_t buflen )
+{
+    int ret;
+    int success = 0, first_error = 0, total_failed = 0;
+    size_t i, count, offset, len;
+    const unsigned char *entry;
+
+    if( buflen < MBEDTLS_X509_PACKED_HEADER_LEN ||
+        memcmp( buf, MBEDTLS_X509_PACKED_MAGIC,
+                MBEDTLS_X509_PACKED_MAGIC_LEN ) != 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    count = ( (size_t) buf[8] << 24 ) | ( (size_t) buf[9]  << 16 ) |
+            ( (size_t) buf[10] << 8 ) |   (size_t) buf[11];
+
+    if( count > ( buflen - MBEDTLS_X509_PACKED_HEADER_LEN ) /
+                MBEDTLS_X509_PACKED_ENTRY_LEN )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    for( i = 0; i < count; i++ )
+    {
+        entry = buf + MBEDTLS_X509_PACKED_HEADER_LEN +
+                i * MBEDTLS_X509_PACKED_ENTRY_LEN;
+
+        offset = ( (size_t) entry[0] << 24 ) | ( (size_t) entry[1] << 16 ) |
+                 ( (size_t) entry[2] << 8 )  |   (size_t) entry[3];
+        len    = ( (size_t) entry[4] << 24 ) | ( (size_t) entry[5] << 16 ) |
+                 ( (size_t) entry[6] << 8 )  |   (size_t) entry[7];
+
+        if( offset > buflen || len > buflen - offset )
+            return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+        if( ( ret = mbedtls_x509_crt_parse_der( chain,
+                                                buf + offset, len ) ) != 0 )
+        {
+            if( first_error == 0 )
+                first_error = ret;
+
+            total_failed++;
+            continue;
+        }
+
+        success = 1;
+    }
+
+    if( success || count == 0 )
+        return( total_failed );
+    else if( first_error )
+        return( first_error );
+    else
+        return( MBEDTLS_ERR_X509_CERT_UNKNOWN_FORMAT );
+}
+
 #if defined(MBEDTLS_FS_IO)
 /*
  * Load one or more certificates and add them to the chained list
@@ -1417,6 +1717,12 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
         }
     }
 
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+    if( ( ret = mbedtls_x509_crt_materialize_exts(
+                    (mbedtls_x509_crt *) crt ) ) != 0 )
+        return( ret );
+#endif
+
     if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
     {
         ret = mbedtls_snprintf( p, n, "\n%ssubject alt name  : ", prefix );
@@ -1461,6 +1767,18 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
     return( (int) ( size - n ) );
 }
 
+#if defined(MBEDTLS_X509_DN_CACHE)
+const char *mbedtls_x509_crt_subject_dn( const mbedtls_x509_crt *crt )
+{
+    return( crt->subject_dn );
+}
+
+const char *mbedtls_x509_crt_issuer_dn( const mbedtls_x509_crt *crt )
+{
+    return( crt->issuer_dn );
+}
+#endif /* MBEDTLS_X509_DN_CACHE */
+
 struct x509_crt_verify_string {
     int code;
     const char *string;
@@ -1554,6 +1872,13 @@ int mbedtls_x509_crt_check_extended_key_usage( const mbedtls_x509_crt *crt,
     if( ( crt->ext_types & MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE ) == 0 )
         return( 0 );
 
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+    /* Parsing the deferred list caches it in the certificate; the
+     * certificate data itself is still never modified */
+    if( mbedtls_x509_crt_materialize_exts( (mbedtls_x509_crt *) crt ) != 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+#endif
+
     /*
      * Look for the requested usage (or wildcard ANY) in our list
      */
@@ -1758,6 +2083,243 @@ static int x509_check_wildcard( const char *cn, mbedtls_x509_buf *name )
     return( -1 );
 }
 
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+/*
+ * Normalized hostname table: the names a certificate is valid for
+ * (subjectAltName entries, or CN attributes when there is no SAN),
+ * lowercased and sorted once, so that per-handshake hostname checks are
+ * a binary search instead of a case-folding walk of the ASN.1 lists.
+ * Wildcard names are stored twice: in full among the exact names (a
+ * literal "*.x" reference identifier still matches) and as their
+ * ".domain" suffix in the wildcard partition.
+ *
+ * Everything lives in one allocation: this header, then the records,
+ * then the lowercased name bytes.
+ */
+typedef struct x509_host_rec
+{
+    uint32_t off;               /* offset of the name in the byte pool  */
+    uint32_t len;
+}
+x509_host_rec;
+
+typedef struct x509_host_table
+{
+    size_t exact_count;         /* full names, sorted                   */
+    size_t wc_count;            /* wildcard suffixes, sorted            */
+}
+x509_host_table;
+
+static int x509_host_is_wildcard( const mbedtls_x509_buf *name )
+{
+    return( name->len > 2 && name->p[0] == '*' && name->p[1] == '.' );
+}
+
+/*
+ * Records order by (length, bytes), which is all a membership test needs
+ */
+static int x509_host_rec_cmp( const x509_host_rec *rec,
+                              const unsigned char *pool,
+                              const unsigned char *s, size_t len )
+{
+    if( rec->len != len )
+        return( rec->len < len ? -1 : 1 );
+
+    return( memcmp( pool + rec->off, s, len ) );
+}
+
+static void x509_host_add( x509_host_rec *recs, size_t *count,
+                           unsigned char *pool, size_t *pool_used,
+                           const unsigned char *name, size_t len )
+{
+    size_t i, j;
+
+    for( i = 0; i < len; i++ )
+    {
+        unsigned char c = name[i];
+
+        if( c >= 'A' && c <= 'Z' )
+            c += 'a' - 'A';
+
+        pool[*pool_used + i] = c;
+    }
+
+    /* Insertion sort: certificates carry a handful of names */
+    for( i = 0; i < *count; i++ )
+        if( x509_host_rec_cmp( &recs[i], pool,
+                               pool + *pool_used, len ) > 0 )
+            break;
+
+    for( j = *count; j > i; j-- )
+        recs[j] = recs[j - 1];
+
+    recs[i].off = (uint32_t) *pool_used;
+    recs[i].len = (uint32_t) len;
+    *pool_used += len;
+    (*count)++;
+}
+
+int mbedtls_x509_crt_build_host_table( mbedtls_x509_crt *crt )
+{
+    size_t n = 0, wc = 0, bytes = 0;
+    size_t exact_count = 0, wc_count = 0, pool_used = 0;
+    x509_host_table *tab;
+    x509_host_rec *recs;
+    unsigned char *pool;
+    const mbedtls_x509_sequence *cur;
+    const mbedtls_x509_name *name;
+
+    if( crt->host_table != NULL )
+        return( 0 );
+
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+    {
+        int ret;
+        if( ( ret = mbedtls_x509_crt_materialize_exts( crt ) ) != 0 )
+            return( ret );
+    }
+#endif
+
+    if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
+    {
+        for( cur = &crt->subject_alt_names; cur != NULL; cur = cur->next )
+        {
+            n++;
+            bytes += cur->buf.len;
+            if( x509_host_is_wildcard( &cur->buf ) )
+            {
+                wc++;
+                bytes += cur->buf.len - 1;
+            }
+        }
+    }
+    else
+    {
+        for( name = &crt->subject; name != NULL; name = name->next )
+        {
+            if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name->oid ) != 0 )
+                continue;
+
+            n++;
+            bytes += name->val.len;
+            if( x509_host_is_wildcard( &name->val ) )
+            {
+                wc++;
+                bytes += name->val.len - 1;
+            }
+        }
+    }
+
+    tab = mbedtls_calloc( 1, sizeof( x509_host_table ) +
+                          ( n + wc ) * sizeof( x509_host_rec ) + bytes );
+    if( tab == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    recs = (x509_host_rec *)( tab + 1 );
+    pool = (unsigned char *)( recs + n + wc );
+
+    if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
+    {
+        for( cur = &crt->subject_alt_names; cur != NULL; cur = cur->next )
+        {
+            x509_host_add( recs, &exact_count, pool, &pool_used,
+                           cur->buf.p, cur->buf.len );
+            if( x509_host_is_wildcard( &cur->buf ) )
+                x509_host_add( recs + n, &wc_count, pool, &pool_used,
+                               cur->buf.p + 1, cur->buf.len - 1 );
+        }
+    }
+    else
+    {
+        for( name = &crt->subject; name != NULL; name = name->next )
+        {
+            if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name->oid ) != 0 )
+                continue;
+
+            x509_host_add( recs, &exact_count, pool, &pool_used,
+                           name->val.p, name->val.len );
+            if( x509_host_is_wildcard( &name->val ) )
+                x509_host_add( recs + n, &wc_count, pool, &pool_used,
+                               name->val.p + 1, name->val.len - 1 );
+        }
+    }
+
+    tab->exact_count = exact_count;
+    tab->wc_count = wc_count;
+    crt->host_table = tab;
+
+    return( 0 );
+}
+
+static int x509_host_search( const x509_host_rec *recs, size_t count,
+                             const unsigned char *pool,
+                             const unsigned char *s, size_t len )
+{
+    size_t lo = 0, hi = count, mid;
+    int cmp;
+
+    while( lo < hi )
+    {
+        mid = lo + ( hi - lo ) / 2;
+        cmp = x509_host_rec_cmp( &recs[mid], pool, s, len );
+
+        if( cmp == 0 )
+            return( 1 );
+        if( cmp < 0 )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Check a hostname against the table. Returns 0 on a match, -1 on a
+ * mismatch, and 1 when no table is available and the caller must fall
+ * back to walking the lists.
+ */
+static int x509_crt_check_host_table( const mbedtls_x509_crt *crt,
+                                      const char *cn, size_t cn_len )
+{
+    const x509_host_table *tab = crt->host_table;
+    const x509_host_rec *recs;
+    const unsigned char *pool;
+    unsigned char lc[255];
+    size_t i, dot;
+
+    if( tab == NULL || cn_len == 0 || cn_len > sizeof( lc ) )
+        return( 1 );
+
+    for( i = 0; i < cn_len; i++ )
+    {
+        unsigned char c = (unsigned char) cn[i];
+
+        if( c >= 'A' && c <= 'Z' )
+            c += 'a' - 'A';
+
+        lc[i] = c;
+    }
+
+    recs = (const x509_host_rec *)( tab + 1 );
+    pool = (const unsigned char *)( recs + tab->exact_count + tab->wc_count );
+
+    if( x509_host_search( recs, tab->exact_count, pool, lc, cn_len ) )
+        return( 0 );
+
+    for( dot = 0; dot < cn_len; dot++ )
+        if( lc[dot] == '.' )
+            break;
+
+    if( dot != 0 && dot != cn_len &&
+        x509_host_search( recs + tab->exact_count, tab->wc_count, pool,
+                          lc + dot, cn_len - dot ) )
+        return( 0 );
+
+    return( -1 );
+}
+#endif /* MBEDTLS_X509_CRT_HOST_TABLE */
+
 /*
  * Compare two X.509 strings, case-insensitive, and allowing for some encoding
  * variations (but not all).
@@ -1872,8 +2434,63 @@ static int x509_crt_check_parent( const mbedtls_x509_crt *child,
     return( 0 );
 }
 
+/*
+ * Deferred signature checks for mbedtls_x509_crt_verify_pipelined():
+ * the tasks collected here are handed to the caller's executor and
+ * their results folded into the flags once the chain walk is done
+ */
+typedef struct
+{
+    const mbedtls_x509_verify_executor *exec;
+    mbedtls_x509_verify_task *tasks;
+}
+x509_crt_verify_pipeline;
+
+static void x509_crt_verify_task_run( mbedtls_x509_verify_task *task )
+{
+    task->result = mbedtls_pk_verify_ext( task->sig_pk, task->sig_opts,
+                                          task->parent_pk, task->sig_md,
+                                          task->hash, task->hash_len,
+                                          task->sig, task->sig_len );
+}
+
+static int x509_crt_defer_sig_check( x509_crt_verify_pipeline *pl,
+                                     mbedtls_x509_crt *child,
+                                     mbedtls_pk_context *parent_pk,
+                                     const unsigned char *hash,
+                                     size_t hash_len )
+{
+    int ret;
+    mbedtls_x509_verify_task *task;
+
+    task = mbedtls_calloc( 1, sizeof( mbedtls_x509_verify_task ) );
+    if( task == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    task->f_run = x509_crt_verify_task_run;
+    task->sig_pk = child->sig_pk;
+    task->sig_opts = child->sig_opts;
+    task->parent_pk = parent_pk;
+    task->sig_md = child->sig_md;
+    memcpy( task->hash, hash, hash_len );
+    task->hash_len = hash_len;
+    task->sig = child->sig.p;
+    task->sig_len = child->sig.len;
+
+    task->next = pl->tasks;
+    pl->tasks = task;
+
+    if( ( ret = pl->exec->f_submit( pl->exec->p_ctx, task ) ) != 0 )
+        return( ret );
+
+    return( 0 );
+}
+
 static int x509_crt_verify_top(
                 mbedtls_x509_crt *child, mbedtls_x509_crt *trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                const mbedtls_x509_trust *trust,
+#endif
                 mbedtls_x509_crl *ca_crl,
                 const mbedtls_x509_crt_profile *profile,
                 int path_cnt, uint32_t *flags,
@@ -1885,6 +2502,9 @@ static int x509_crt_verify_top(
     int check_path_cnt;
     unsigned char hash[MBEDTLS_MD_MAX_SIZE];
     const mbedtls_md_info_t *md_info;
+#if defined(MBEDTLS_X509_TRUST_C)
+    const mbedtls_x509_trust_entry *te = NULL;
+#endif
 
     if( mbedtls_x509_time_is_past( &child->valid_to ) )
         *flags |= MBEDTLS_X509_BADCERT_EXPIRED;
@@ -1910,14 +2530,26 @@ static int x509_crt_verify_top(
          * Cannot check 'unknown', no need to try any CA
          */
         trust_ca = NULL;
+#if defined(MBEDTLS_X509_TRUST_C)
+        trust = NULL;
+#endif
     }
     else
         mbedtls_md( md_info, child->tbs.p, child->tbs.len, hash );
 
-    for( /* trust_ca */ ; trust_ca != NULL; trust_ca = trust_ca->next )
+#if defined(MBEDTLS_X509_TRUST_C)
+    /* With an indexed trust store, only walk the candidate issuers */
+    if( trust != NULL )
+    {
+        te = mbedtls_x509_trust_find( trust, &child->issuer, NULL );
+        trust_ca = ( te != NULL ) ? te->ca : NULL;
+    }
+#endif
+
+    while( trust_ca != NULL )
     {
         if( x509_crt_check_parent( child, trust_ca, 1, path_cnt == 0 ) != 0 )
-            continue;
+            goto next_ca;
 
         check_path_cnt = path_cnt + 1;
 
@@ -1935,14 +2567,14 @@ static int x509_crt_verify_top(
         if( trust_ca->max_pathlen > 0 &&
             trust_ca->max_pathlen < check_path_cnt )
         {
-            continue;
+            goto next_ca;
         }
 
         if( mbedtls_pk_verify_ext( child->sig_pk, child->sig_opts, &trust_ca->pk,
                            child->sig_md, hash, mbedtls_md_get_size( md_info ),
                            child->sig.p, child->sig.len ) != 0 )
         {
-            continue;
+            goto next_ca;
         }
 
         /*
@@ -1954,6 +2586,17 @@ static int x509_crt_verify_top(
             *flags |= MBEDTLS_X509_BADCERT_BAD_KEY;
 
         break;
+
+next_ca:
+#if defined(MBEDTLS_X509_TRUST_C)
+        if( trust != NULL )
+        {
+            te = mbedtls_x509_trust_find( trust, &child->issuer, te );
+            trust_ca = ( te != NULL ) ? te->ca : NULL;
+        }
+        else
+#endif
+        trust_ca = trust_ca->next;
     }
 
     /*
@@ -2003,11 +2646,16 @@ static int x509_crt_verify_top(
 
 static int x509_crt_verify_child(
                 mbedtls_x509_crt *child, mbedtls_x509_crt *parent,
-                mbedtls_x509_crt *trust_ca, mbedtls_x509_crl *ca_crl,
+                mbedtls_x509_crt *trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                const mbedtls_x509_trust *trust,
+#endif
+                mbedtls_x509_crl *ca_crl,
                 const mbedtls_x509_crt_profile *profile,
                 int path_cnt, uint32_t *flags,
                 int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
-                void *p_vrfy )
+                void *p_vrfy,
+                x509_crt_verify_pipeline *pl )
 {
     int ret;
     uint32_t parent_flags = 0;
@@ -2049,7 +2697,18 @@ static int x509_crt_verify_child(
         if( x509_profile_check_key( profile, child->sig_pk, &parent->pk ) != 0 )
             *flags |= MBEDTLS_X509_BADCERT_BAD_KEY;
 
-        if( mbedtls_pk_verify_ext( child->sig_pk, child->sig_opts, &parent->pk,
+        if( pl != NULL )
+        {
+            /* Chain-link signatures are independent of each other and
+             * of everything below: ship them to the executor and fold
+             * the results in once the walk is complete */
+            ret = x509_crt_defer_sig_check( pl, child, &parent->pk,
+                                            hash,
+                                            mbedtls_md_get_size( md_info ) );
+            if( ret != 0 )
+                return( ret );
+        }
+        else if( mbedtls_pk_verify_ext( child->sig_pk, child->sig_opts, &parent->pk,
                            child->sig_md, hash, mbedtls_md_get_size( md_info ),
                            child->sig.p, child->sig.len ) != 0 )
         {
@@ -2075,14 +2734,23 @@ static int x509_crt_verify_child(
     /* Is our parent part of the chain or at the top? */
     if( grandparent != NULL )
     {
-        ret = x509_crt_verify_child( parent, grandparent, trust_ca, ca_crl, profile,
-                                path_cnt + 1, &parent_flags, f_vrfy, p_vrfy );
+        ret = x509_crt_verify_child( parent, grandparent, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                trust,
+#endif
+                                ca_crl, profile,
+                                path_cnt + 1, &parent_flags, f_vrfy, p_vrfy,
+                                pl );
         if( ret != 0 )
             return( ret );
     }
     else
     {
-        ret = x509_crt_verify_top( parent, trust_ca, ca_crl, profile,
+        ret = x509_crt_verify_top( parent, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                trust,
+#endif
+                                ca_crl, profile,
                                 path_cnt + 1, &parent_flags, f_vrfy, p_vrfy );
         if( ret != 0 )
             return( ret );
@@ -2114,15 +2782,20 @@ int mbedtls_x509_crt_verify( mbedtls_x509_crt *crt,
 
 
 /*
- * Verify the certificate validity, with profile
+ * Verify the certificate validity, with profile, against either a plain
+ * CA list or an indexed trust store
  */
-int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
+static int x509_crt_verify_internal( mbedtls_x509_crt *crt,
                      mbedtls_x509_crt *trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                     const mbedtls_x509_trust *trust,
+#endif
                      mbedtls_x509_crl *ca_crl,
                      const mbedtls_x509_crt_profile *profile,
                      const char *cn, uint32_t *flags,
                      int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
-                     void *p_vrfy )
+                     void *p_vrfy,
+                     x509_crt_verify_pipeline *pl )
 {
     size_t cn_len;
     int ret;
@@ -2138,9 +2811,32 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
 
     if( cn != NULL )
     {
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+        if( ( ret = mbedtls_x509_crt_materialize_exts( crt ) ) != 0 )
+            return( ret );
+#endif
+
         name = &crt->subject;
         cn_len = strlen( cn );
 
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+        if( crt->host_table == NULL
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+            && crt->cache_entry == NULL
+#endif
+          )
+        {
+            /* Best effort: on failure the list walk below still works */
+            (void) mbedtls_x509_crt_build_host_table( crt );
+        }
+
+        if( ( ret = x509_crt_check_host_table( crt, cn, cn_len ) ) <= 0 )
+        {
+            if( ret < 0 )
+                *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
+        }
+        else
+#endif /* MBEDTLS_X509_CRT_HOST_TABLE */
         if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
         {
             cur = &crt->subject_alt_names;
@@ -2198,14 +2894,22 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
     /* Are we part of the chain or at the top? */
     if( parent != NULL )
     {
-        ret = x509_crt_verify_child( crt, parent, trust_ca, ca_crl, profile,
-                                     pathlen, flags, f_vrfy, p_vrfy );
+        ret = x509_crt_verify_child( crt, parent, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                     trust,
+#endif
+                                     ca_crl, profile,
+                                     pathlen, flags, f_vrfy, p_vrfy, pl );
         if( ret != 0 )
             return( ret );
     }
     else
     {
-        ret = x509_crt_verify_top( crt, trust_ca, ca_crl, profile,
+        ret = x509_crt_verify_top( crt, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                   trust,
+#endif
+                                   ca_crl, profile,
                                    pathlen, flags, f_vrfy, p_vrfy );
         if( ret != 0 )
             return( ret );
@@ -2217,6 +2921,97 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
     return( 0 );
 }
 
+/*
+ * Verify the certificate validity, with profile
+ */
+int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
+                     mbedtls_x509_crt *trust_ca,
+                     mbedtls_x509_crl *ca_crl,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags,
+                     int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
+                     void *p_vrfy )
+{
+    return( x509_crt_verify_internal( crt, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                      NULL,
+#endif
+                                      ca_crl, profile, cn, flags,
+                                      f_vrfy, p_vrfy, NULL ) );
+}
+
+/*
+ * Verify the certificate validity, with the signature checks between
+ * chain links run by a caller-provided executor
+ */
+int mbedtls_x509_crt_verify_pipelined( mbedtls_x509_crt *crt,
+                     mbedtls_x509_crt *trust_ca,
+                     mbedtls_x509_crl *ca_crl,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags,
+                     const mbedtls_x509_verify_executor *executor )
+{
+    int ret, wait_ret;
+    x509_crt_verify_pipeline pl;
+    mbedtls_x509_verify_task *task, *next;
+
+    if( executor == NULL ||
+        executor->f_submit == NULL || executor->f_wait == NULL )
+    {
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+    }
+
+    pl.exec = executor;
+    pl.tasks = NULL;
+
+    ret = x509_crt_verify_internal( crt, trust_ca,
+#if defined(MBEDTLS_X509_TRUST_C)
+                                    NULL,
+#endif
+                                    ca_crl, profile, cn, flags,
+                                    NULL, NULL, &pl );
+
+    /* Even on a failed walk every submitted task must have run before
+     * the memory it references can be released */
+    wait_ret = executor->f_wait( executor->p_ctx );
+
+    for( task = pl.tasks; task != NULL; task = next )
+    {
+        next = task->next;
+
+        if( task->result != 0 )
+            *flags |= MBEDTLS_X509_BADCERT_NOT_TRUSTED;
+
+        mbedtls_free( task );
+    }
+
+    if( wait_ret != 0 )
+        return( wait_ret );
+
+    if( ret == 0 && *flags != 0 )
+        ret = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_X509_TRUST_C)
+/*
+ * Verify the certificate validity, with profile, against an indexed
+ * trust store
+ */
+int mbedtls_x509_crt_verify_trust( mbedtls_x509_crt *crt,
+                     const mbedtls_x509_trust *trust,
+                     mbedtls_x509_crl *ca_crl,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags,
+                     int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
+                     void *p_vrfy )
+{
+    return( x509_crt_verify_internal( crt, NULL, trust, ca_crl, profile,
+                                      cn, flags, f_vrfy, p_vrfy, NULL ) );
+}
+#endif /* MBEDTLS_X509_TRUST_C */
+
 /*
  * Initialize a certificate chain
  */
@@ -2242,17 +3037,44 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
 
     do
     {
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+        /* Shared copies own none of the parsed data: just drop the
+         * reference, the node itself is freed below as usual */
+        if( cert_cur->cache_entry != NULL )
+        {
+            mbedtls_x509_crt_cache_release( cert_cur->cache_entry );
+            cert_cur = cert_cur->next;
+            continue;
+        }
+#endif
+
         mbedtls_pk_free( &cert_cur->pk );
 
 #if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT)
         mbedtls_free( cert_cur->sig_opts );
 #endif
 
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+        mbedtls_free( cert_cur->host_table );
+#endif
+
+#if defined(MBEDTLS_X509_DN_CACHE)
+        mbedtls_free( cert_cur->subject_dn );
+        mbedtls_free( cert_cur->issuer_dn );
+#endif
+
+        /* Arena-resident nodes (inline block or spill buffer) are
+         * reclaimed with the arena below; only individually allocated
+         * nodes are freed here */
         name_cur = cert_cur->issuer.next;
         while( name_cur != NULL )
         {
             name_prv = name_cur;
             name_cur = name_cur->next;
+#if defined(MBEDTLS_X509_CRT_ARENA)
+            if( x509_crt_node_in_arena( &cert_cur->arena, name_prv ) )
+                continue;
+#endif
             mbedtls_zeroize( name_prv, sizeof( mbedtls_x509_name ) );
             mbedtls_free( name_prv );
         }
@@ -2262,6 +3084,10 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
         {
             name_prv = name_cur;
             name_cur = name_cur->next;
+#if defined(MBEDTLS_X509_CRT_ARENA)
+            if( x509_crt_node_in_arena( &cert_cur->arena, name_prv ) )
+                continue;
+#endif
             mbedtls_zeroize( name_prv, sizeof( mbedtls_x509_name ) );
             mbedtls_free( name_prv );
         }
@@ -2271,6 +3097,10 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
         {
             seq_prv = seq_cur;
             seq_cur = seq_cur->next;
+#if defined(MBEDTLS_X509_CRT_ARENA)
+            if( x509_crt_node_in_arena( &cert_cur->arena, seq_prv ) )
+                continue;
+#endif
             mbedtls_zeroize( seq_prv, sizeof( mbedtls_x509_sequence ) );
             mbedtls_free( seq_prv );
         }
@@ -2280,10 +3110,22 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
         {
             seq_prv = seq_cur;
             seq_cur = seq_cur->next;
+#if defined(MBEDTLS_X509_CRT_ARENA)
+            if( x509_crt_node_in_arena( &cert_cur->arena, seq_prv ) )
+                continue;
+#endif
             mbedtls_zeroize( seq_prv, sizeof( mbedtls_x509_sequence ) );
             mbedtls_free( seq_prv );
         }
 
+#if defined(MBEDTLS_X509_CRT_ARENA)
+        if( cert_cur->arena.buf != NULL )
+        {
+            mbedtls_zeroize( cert_cur->arena.buf, cert_cur->arena.len );
+            mbedtls_free( cert_cur->arena.buf );
+        }
+#endif
+
         if( cert_cur->raw.p != NULL )
         {
             mbedtls_zeroize( cert_cur->raw.p, cert_cur->raw.len );
@@ -0,0 +1,310 @@
+/*
+ *  Process-wide cache of parsed certificates, keyed by DER digest
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Each distinct certificate is parsed once into a cache entry; chains get
+ * reference-counted shallow copies of that entry's mbedtls_x509_crt. The
+ * copies are read-only by contract and released through the cache_entry
+ * hook in mbedtls_x509_crt_free().
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+
+#include "mbedtls/x509_crt_cache.h"
+#include "mbedtls/sha256.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+void mbedtls_x509_crt_cache_init( mbedtls_x509_crt_cache *cache )
+{
+    memset( cache, 0, sizeof( mbedtls_x509_crt_cache ) );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &cache->mutex );
+#endif
+}
+
+int mbedtls_x509_crt_cache_setup( mbedtls_x509_crt_cache *cache,
+                                  size_t buckets, size_t max_entries )
+{
+    if( buckets == 0 )
+        buckets = MBEDTLS_X509_CRT_CACHE_DEFAULT_BUCKETS;
+    if( max_entries == 0 )
+        max_entries = MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES;
+
+    cache->buckets = mbedtls_calloc( buckets,
+                                     sizeof( mbedtls_x509_crt_cache_entry * ) );
+    if( cache->buckets == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    cache->bucket_count = buckets;
+    cache->max_entries = max_entries;
+    cache->count = 0;
+
+    return( 0 );
+}
+
+static size_t x509_crt_cache_bucket( const mbedtls_x509_crt_cache *cache,
+                                     const unsigned char digest[32] )
+{
+    uint32_t h = ( (uint32_t) digest[0] << 24 ) |
+                 ( (uint32_t) digest[1] << 16 ) |
+                 ( (uint32_t) digest[2] <<  8 ) |
+                   (uint32_t) digest[3];
+
+    return( h % cache->bucket_count );
+}
+
+static mbedtls_x509_crt_cache_entry *x509_crt_cache_lookup(
+                                        mbedtls_x509_crt_cache *cache,
+                                        const unsigned char digest[32] )
+{
+    mbedtls_x509_crt_cache_entry *entry;
+
+    entry = cache->buckets[x509_crt_cache_bucket( cache, digest )];
+    while( entry != NULL && memcmp( entry->digest, digest, 32 ) != 0 )
+        entry = entry->chain;
+
+    return( entry );
+}
+
+/*
+ * Free the parsed data of an entry and the entry itself
+ */
+static void x509_crt_cache_entry_free( mbedtls_x509_crt_cache_entry *entry )
+{
+    mbedtls_x509_crt_free( &entry->crt );
+    mbedtls_free( entry );
+}
+
+/*
+ * Drop one unused entry to make room, if there is one
+ */
+static void x509_crt_cache_evict( mbedtls_x509_crt_cache *cache )
+{
+    size_t i;
+    mbedtls_x509_crt_cache_entry *entry, **prv;
+
+    for( i = 0; i < cache->bucket_count; i++ )
+    {
+        prv = &cache->buckets[i];
+        for( entry = *prv; entry != NULL; prv = &entry->chain, entry = *prv )
+        {
+            if( entry->ref_count == 0 )
+            {
+                *prv = entry->chain;
+                x509_crt_cache_entry_free( entry );
+                cache->count--;
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Append a shared copy of an entry's certificate to a chain, like
+ * mbedtls_x509_crt_parse_der() appends a freshly parsed one.
+ * The reference was already taken by the caller.
+ */
+static int x509_crt_cache_attach( mbedtls_x509_crt_cache_entry *entry,
+                                  mbedtls_x509_crt *chain )
+{
+    mbedtls_x509_crt *crt = chain;
+
+    while( crt->version != 0 && crt->next != NULL )
+        crt = crt->next;
+
+    if( crt->version != 0 && crt->next == NULL )
+    {
+        crt->next = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt ) );
+        if( crt->next == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        crt = crt->next;
+    }
+
+    *crt = entry->crt;
+    crt->next = NULL;
+    crt->cache_entry = entry;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_cache_parse_der( mbedtls_x509_crt_cache *cache,
+                                      mbedtls_x509_crt *chain,
+                                      const unsigned char *buf,
+                                      size_t buflen )
+{
+    int ret;
+    unsigned char digest[32];
+    mbedtls_x509_crt_cache_entry *entry;
+    size_t bucket;
+
+    if( cache == NULL || cache->buckets == NULL ||
+        chain == NULL || buf == NULL )
+    {
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+    }
+
+    mbedtls_sha256( buf, buflen, digest, 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( ( entry = x509_crt_cache_lookup( cache, digest ) ) == NULL )
+    {
+        if( cache->count >= cache->max_entries )
+            x509_crt_cache_evict( cache );
+
+        if( cache->count >= cache->max_entries ||
+            ( entry = mbedtls_calloc( 1,
+                    sizeof( mbedtls_x509_crt_cache_entry ) ) ) == NULL )
+        {
+            /* Full of in-use entries (or out of memory): fall back to a
+             * private parse, the chain just doesn't share this one */
+#if defined(MBEDTLS_THREADING_C)
+            (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+            return( mbedtls_x509_crt_parse_der( chain, buf, buflen ) );
+        }
+
+        mbedtls_x509_crt_init( &entry->crt );
+
+        if( ( ret = mbedtls_x509_crt_parse_der( &entry->crt,
+                                                buf, buflen ) ) != 0 )
+        {
+            mbedtls_free( entry );
+#if defined(MBEDTLS_THREADING_C)
+            (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+            return( ret );
+        }
+
+#if defined(MBEDTLS_X509_CRT_LAZY_EXTENSIONS)
+        /* Shared copies must not build the deferred lists themselves
+         * (they would not be freed with the copy), so do it once here */
+        if( ( ret = mbedtls_x509_crt_materialize_exts( &entry->crt ) ) != 0 )
+        {
+            mbedtls_x509_crt_free( &entry->crt );
+            mbedtls_free( entry );
+#if defined(MBEDTLS_THREADING_C)
+            (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+            return( ret );
+        }
+#endif
+
+#if defined(MBEDTLS_X509_CRT_HOST_TABLE)
+        /* Same for the hostname table: built once on the shared form,
+         * copies fall back to the list walk if this fails */
+        (void) mbedtls_x509_crt_build_host_table( &entry->crt );
+#endif
+
+        memcpy( entry->digest, digest, 32 );
+        entry->cache = cache;
+
+        bucket = x509_crt_cache_bucket( cache, digest );
+        entry->chain = cache->buckets[bucket];
+        cache->buckets[bucket] = entry;
+        cache->count++;
+    }
+
+    entry->ref_count++;
+
+    ret = x509_crt_cache_attach( entry, chain );
+    if( ret != 0 )
+        entry->ref_count--;
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+
+    return( ret );
+}
+
+void mbedtls_x509_crt_cache_release( void *cache_entry )
+{
+    mbedtls_x509_crt_cache_entry *entry = cache_entry;
+
+    if( entry == NULL )
+        return;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &entry->cache->mutex ) != 0 )
+        return;
+#endif
+
+    if( entry->ref_count > 0 )
+        entry->ref_count--;
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &entry->cache->mutex );
+#endif
+}
+
+size_t mbedtls_x509_crt_cache_len( const mbedtls_x509_crt_cache *cache )
+{
+    return( cache->count );
+}
+
+void mbedtls_x509_crt_cache_free( mbedtls_x509_crt_cache *cache )
+{
+    size_t i;
+    mbedtls_x509_crt_cache_entry *entry, *next;
+
+    if( cache->buckets != NULL )
+    {
+        for( i = 0; i < cache->bucket_count; i++ )
+        {
+            for( entry = cache->buckets[i]; entry != NULL; entry = next )
+            {
+                next = entry->chain;
+                x509_crt_cache_entry_free( entry );
+            }
+        }
+
+        mbedtls_free( cache->buckets );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &cache->mutex );
+#endif
+
+    memset( cache, 0, sizeof( mbedtls_x509_crt_cache ) );
+}
+
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
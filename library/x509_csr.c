@@ -61,10 +61,7 @@
 #include <stdio.h>
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 /*
  *  Version  ::=  INTEGER  {  v1(0)  }
@@ -189,7 +186,7 @@ int mbedtls_x509_csr_parse_der( mbedtls_x509_csr *csr,
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
-    if( ( ret = mbedtls_x509_get_name( &p, p + len, &csr->subject ) ) != 0 )
+    if( ( ret = mbedtls_x509_get_name( &p, p + len, &csr->subject, NULL ) ) != 0 )
     {
         mbedtls_x509_csr_free( csr );
         return( ret );
@@ -0,0 +1,284 @@
+/*
+ *  Indexed trust store for fast issuer lookup in large CA bundles
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_X509_TRUST_C)
+
+#include "mbedtls/x509_trust.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+void mbedtls_x509_trust_init( mbedtls_x509_trust *trust )
+{
+    memset( trust, 0, sizeof( mbedtls_x509_trust ) );
+}
+
+int mbedtls_x509_trust_setup( mbedtls_x509_trust *trust, size_t buckets )
+{
+    if( buckets == 0 )
+        buckets = MBEDTLS_X509_TRUST_DEFAULT_BUCKETS;
+
+    trust->buckets = mbedtls_calloc( buckets,
+                                     sizeof( mbedtls_x509_trust_entry * ) );
+    if( trust->buckets == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    trust->bucket_count = buckets;
+    trust->count = 0;
+
+    return( 0 );
+}
+
+/*
+ * Hash an X.509 name, folding the variations that x509_name_cmp() (in
+ * x509_crt.c) tolerates: letter case, and the UTF8String/PrintableString
+ * tag distinction. Equal names always hash equal; unequal names may
+ * collide, which only sends an extra candidate through the full parent
+ * checks.
+ */
+uint32_t mbedtls_x509_trust_name_hash( const mbedtls_x509_name *name )
+{
+    uint32_t h = 2166136261UL;
+    size_t i;
+
+    while( name != NULL )
+    {
+        for( i = 0; i < name->oid.len; i++ )
+            h = ( h ^ name->oid.p[i] ) * 16777619UL;
+
+        for( i = 0; i < name->val.len; i++ )
+        {
+            unsigned char c = name->val.p[i];
+
+            if( c >= 'A' && c <= 'Z' )
+                c += 'a' - 'A';
+
+            h = ( h ^ c ) * 16777619UL;
+        }
+
+        h = ( h ^ ( name->next_merged != 0 ) ) * 16777619UL;
+
+        name = name->next;
+    }
+
+    return( h );
+}
+
+int mbedtls_x509_trust_add( mbedtls_x509_trust *trust,
+                            mbedtls_x509_crt *ca_list )
+{
+    mbedtls_x509_crt *ca;
+    mbedtls_x509_trust_entry *entry;
+    size_t bucket;
+
+    if( trust->buckets == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    for( ca = ca_list; ca != NULL; ca = ca->next )
+    {
+        if( ca->version == 0 )
+            continue;
+
+        entry = mbedtls_calloc( 1, sizeof( mbedtls_x509_trust_entry ) );
+        if( entry == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        entry->ca = ca;
+        entry->hash = mbedtls_x509_trust_name_hash( &ca->subject );
+
+        bucket = entry->hash % trust->bucket_count;
+        entry->chain = trust->buckets[bucket];
+        trust->buckets[bucket] = entry;
+        trust->count++;
+    }
+
+    return( 0 );
+}
+
+int mbedtls_x509_trust_attach_packed( mbedtls_x509_trust *trust,
+                                      const unsigned char *image,
+                                      size_t imglen )
+{
+    mbedtls_x509_trust_entry *entry;
+    size_t i, count, offset, len, bucket;
+    const unsigned char *idx;
+
+    if( trust->buckets == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    if( imglen < MBEDTLS_X509_PACKED_HEADER_LEN ||
+        memcmp( image, MBEDTLS_X509_PACKED_MAGIC,
+                MBEDTLS_X509_PACKED_MAGIC_LEN ) != 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    count = ( (size_t) image[8] << 24 ) | ( (size_t) image[9]  << 16 ) |
+            ( (size_t) image[10] << 8 ) |   (size_t) image[11];
+
+    if( count > ( imglen - MBEDTLS_X509_PACKED_HEADER_LEN ) /
+                MBEDTLS_X509_PACKED_ENTRY_LEN )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    for( i = 0; i < count; i++ )
+    {
+        idx = image + MBEDTLS_X509_PACKED_HEADER_LEN +
+              i * MBEDTLS_X509_PACKED_ENTRY_LEN;
+
+        offset = ( (size_t) idx[0] << 24 ) | ( (size_t) idx[1] << 16 ) |
+                 ( (size_t) idx[2] << 8 )  |   (size_t) idx[3];
+        len    = ( (size_t) idx[4] << 24 ) | ( (size_t) idx[5] << 16 ) |
+                 ( (size_t) idx[6] << 8 )  |   (size_t) idx[7];
+
+        if( offset > imglen || len > imglen - offset )
+            return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+        entry = mbedtls_calloc( 1, sizeof( mbedtls_x509_trust_entry ) );
+        if( entry == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        entry->hash = ( (uint32_t) idx[8] << 24 ) |
+                      ( (uint32_t) idx[9] << 16 ) |
+                      ( (uint32_t) idx[10] << 8 ) |
+                        (uint32_t) idx[11];
+        entry->der = image + offset;
+        entry->der_len = len;
+
+        bucket = entry->hash % trust->bucket_count;
+        entry->chain = trust->buckets[bucket];
+        trust->buckets[bucket] = entry;
+        trust->count++;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Parse a packed entry's DER on its first hash match. Entries whose DER
+ * fails to parse are disabled rather than retried.
+ */
+static void x509_trust_materialize( mbedtls_x509_trust_entry *entry )
+{
+    mbedtls_x509_crt *crt;
+
+    if( ( crt = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt ) ) ) == NULL )
+        return;     /* left unparsed, tried again on the next match */
+
+    mbedtls_x509_crt_init( crt );
+
+    if( mbedtls_x509_crt_parse_der( crt, entry->der, entry->der_len ) != 0 )
+    {
+        mbedtls_x509_crt_free( crt );
+        mbedtls_free( crt );
+        entry->der = NULL;
+        return;
+    }
+
+    entry->parsed = crt;
+    entry->ca = crt;
+}
+
+const mbedtls_x509_trust_entry *mbedtls_x509_trust_find(
+                                    const mbedtls_x509_trust *trust,
+                                    const mbedtls_x509_name *issuer,
+                                    const mbedtls_x509_trust_entry *prev )
+{
+    uint32_t hash;
+    const mbedtls_x509_trust_entry *entry;
+
+    if( trust->buckets == NULL )
+        return( NULL );
+
+    if( prev != NULL )
+    {
+        hash = prev->hash;
+        entry = prev->chain;
+    }
+    else
+    {
+        hash = mbedtls_x509_trust_name_hash( issuer );
+        entry = trust->buckets[hash % trust->bucket_count];
+    }
+
+    while( entry != NULL )
+    {
+        if( entry->hash == hash )
+        {
+            /* Logically const: materializing only fills in the lazily
+             * parsed form of a packed entry */
+            if( entry->ca == NULL && entry->der != NULL )
+                x509_trust_materialize( (mbedtls_x509_trust_entry *) entry );
+
+            if( entry->ca != NULL )
+                break;
+        }
+
+        entry = entry->chain;
+    }
+
+    return( entry );
+}
+
+size_t mbedtls_x509_trust_len( const mbedtls_x509_trust *trust )
+{
+    return( trust->count );
+}
+
+void mbedtls_x509_trust_free( mbedtls_x509_trust *trust )
+{
+    size_t i;
+    mbedtls_x509_trust_entry *entry, *next;
+
+    if( trust->buckets != NULL )
+    {
+        for( i = 0; i < trust->bucket_count; i++ )
+        {
+            for( entry = trust->buckets[i]; entry != NULL; entry = next )
+            {
+                next = entry->chain;
+                if( entry->parsed != NULL )
+                {
+                    mbedtls_x509_crt_free( entry->parsed );
+                    mbedtls_free( entry->parsed );
+                }
+                mbedtls_free( entry );
+            }
+        }
+
+        mbedtls_free( trust->buckets );
+    }
+
+    memset( trust, 0, sizeof( mbedtls_x509_trust ) );
+}
+
+#endif /* MBEDTLS_X509_TRUST_C */
@@ -0,0 +1,334 @@
+/*
+ *  Memoization of certificate chain verification results
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_X509_VERIFY_CACHE_C)
+
+#include "mbedtls/x509_verify_cache.h"
+#include "mbedtls/sha256.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#if defined(MBEDTLS_HAVE_TIME)
+#include <time.h>
+#endif
+
+void mbedtls_x509_verify_cache_init( mbedtls_x509_verify_cache *cache )
+{
+    memset( cache, 0, sizeof( mbedtls_x509_verify_cache ) );
+
+#if defined(MBEDTLS_HAVE_TIME)
+    cache->timeout = MBEDTLS_X509_VERIFY_CACHE_DEFAULT_TIMEOUT;
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &cache->mutex );
+#endif
+}
+
+int mbedtls_x509_verify_cache_setup( mbedtls_x509_verify_cache *cache,
+                                     size_t buckets, size_t max_entries )
+{
+    if( buckets == 0 )
+        buckets = MBEDTLS_X509_VERIFY_CACHE_DEFAULT_BUCKETS;
+    if( max_entries == 0 )
+        max_entries = MBEDTLS_X509_VERIFY_CACHE_DEFAULT_MAX_ENTRIES;
+
+    cache->buckets = mbedtls_calloc( buckets,
+                            sizeof( mbedtls_x509_verify_cache_entry * ) );
+    if( cache->buckets == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    cache->bucket_count = buckets;
+    cache->max_entries = max_entries;
+    cache->count = 0;
+
+    return( 0 );
+}
+
+#if defined(MBEDTLS_HAVE_TIME)
+void mbedtls_x509_verify_cache_set_timeout( mbedtls_x509_verify_cache *cache,
+                                            uint32_t timeout )
+{
+    cache->timeout = timeout;
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+/*
+ * Digest everything the verification outcome depends on: the raw DER of
+ * every certificate in the chain, the expected name, and the identity of
+ * the trusted CAs and the profile (by address; the caller must flush the
+ * cache if what they point at changes).
+ */
+static void x509_verify_cache_key( const mbedtls_x509_crt *chain,
+                                   const char *cn,
+                                   const void *authority,
+                                   const mbedtls_x509_crt_profile *profile,
+                                   unsigned char key[32] )
+{
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init( &ctx );
+    mbedtls_sha256_starts( &ctx, 0 );
+
+    while( chain != NULL && chain->version != 0 )
+    {
+        mbedtls_sha256_update( &ctx, chain->raw.p, chain->raw.len );
+        chain = chain->next;
+    }
+
+    if( cn != NULL )
+        mbedtls_sha256_update( &ctx, (const unsigned char *) cn,
+                               strlen( cn ) + 1 );
+
+    mbedtls_sha256_update( &ctx, (const unsigned char *) &authority,
+                           sizeof( authority ) );
+    mbedtls_sha256_update( &ctx, (const unsigned char *) &profile,
+                           sizeof( profile ) );
+
+    mbedtls_sha256_finish( &ctx, key );
+    mbedtls_sha256_free( &ctx );
+}
+
+static size_t x509_verify_cache_bucket( const mbedtls_x509_verify_cache *cache,
+                                        const unsigned char key[32] )
+{
+    uint32_t h = ( (uint32_t) key[0] << 24 ) |
+                 ( (uint32_t) key[1] << 16 ) |
+                 ( (uint32_t) key[2] <<  8 ) |
+                   (uint32_t) key[3];
+
+    return( h % cache->bucket_count );
+}
+
+int mbedtls_x509_verify_cache_lookup( mbedtls_x509_verify_cache *cache,
+                                      const mbedtls_x509_crt *chain,
+                                      const char *cn,
+                                      const void *authority,
+                                      const mbedtls_x509_crt_profile *profile,
+                                      int *vrfy_ret, uint32_t *flags )
+{
+    int ret = 1;
+    unsigned char key[32];
+    mbedtls_x509_verify_cache_entry *entry;
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t t = time( NULL );
+#endif
+
+    if( cache->buckets == NULL || chain == NULL )
+        return( 1 );
+
+    x509_verify_cache_key( chain, cn, authority, profile, key );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+        return( 1 );
+#endif
+
+    entry = cache->buckets[x509_verify_cache_bucket( cache, key )];
+    while( entry != NULL && memcmp( entry->key, key, 32 ) != 0 )
+        entry = entry->chain;
+
+    if( entry != NULL
+#if defined(MBEDTLS_HAVE_TIME)
+        && ( cache->timeout == 0 ||
+             (uint32_t)( t - entry->timestamp ) < cache->timeout )
+#endif
+      )
+    {
+        *vrfy_ret = entry->vrfy_ret;
+        *flags = entry->flags;
+        ret = 0;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+
+    return( ret );
+}
+
+/*
+ * Unlink and return the entry to reuse when the cache is full:
+ * the oldest one (any expired entry is at least as old as a live one)
+ */
+static mbedtls_x509_verify_cache_entry *x509_verify_cache_reuse(
+                                        mbedtls_x509_verify_cache *cache )
+{
+    size_t i;
+    mbedtls_x509_verify_cache_entry *entry, **prv;
+    mbedtls_x509_verify_cache_entry **oldest = NULL;
+#if defined(MBEDTLS_HAVE_TIME)
+    time_t oldest_t = 0;
+#endif
+
+    for( i = 0; i < cache->bucket_count; i++ )
+    {
+        prv = &cache->buckets[i];
+        for( entry = *prv; entry != NULL; prv = &entry->chain, entry = *prv )
+        {
+#if defined(MBEDTLS_HAVE_TIME)
+            if( oldest == NULL || entry->timestamp < oldest_t )
+            {
+                oldest = prv;
+                oldest_t = entry->timestamp;
+            }
+#else
+            oldest = prv;
+#endif
+        }
+    }
+
+    if( oldest == NULL )
+        return( NULL );
+
+    entry = *oldest;
+    *oldest = entry->chain;
+    cache->count--;
+
+    return( entry );
+}
+
+int mbedtls_x509_verify_cache_store( mbedtls_x509_verify_cache *cache,
+                                     const mbedtls_x509_crt *chain,
+                                     const char *cn,
+                                     const void *authority,
+                                     const mbedtls_x509_crt_profile *profile,
+                                     int vrfy_ret, uint32_t flags )
+{
+    int ret = 0;
+    unsigned char key[32];
+    mbedtls_x509_verify_cache_entry *entry;
+    size_t bucket;
+
+    if( cache->buckets == NULL || chain == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    x509_verify_cache_key( chain, cn, authority, profile, key );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &cache->mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    bucket = x509_verify_cache_bucket( cache, key );
+    entry = cache->buckets[bucket];
+    while( entry != NULL && memcmp( entry->key, key, 32 ) != 0 )
+        entry = entry->chain;
+
+    if( entry == NULL )
+    {
+        if( cache->count >= cache->max_entries )
+            entry = x509_verify_cache_reuse( cache );
+        else
+            entry = mbedtls_calloc( 1,
+                        sizeof( mbedtls_x509_verify_cache_entry ) );
+
+        if( entry == NULL )
+        {
+            ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+            goto exit;
+        }
+
+        memcpy( entry->key, key, 32 );
+        entry->chain = cache->buckets[bucket];
+        cache->buckets[bucket] = entry;
+        cache->count++;
+    }
+
+    entry->vrfy_ret = vrfy_ret;
+    entry->flags = flags;
+#if defined(MBEDTLS_HAVE_TIME)
+    entry->timestamp = time( NULL );
+#endif
+
+exit:
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+
+    return( ret );
+}
+
+void mbedtls_x509_verify_cache_flush( mbedtls_x509_verify_cache *cache )
+{
+    size_t i;
+    mbedtls_x509_verify_cache_entry *entry, *next;
+
+    if( cache->buckets == NULL )
+        return;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+        return;
+#endif
+
+    for( i = 0; i < cache->bucket_count; i++ )
+    {
+        for( entry = cache->buckets[i]; entry != NULL; entry = next )
+        {
+            next = entry->chain;
+            mbedtls_free( entry );
+        }
+
+        cache->buckets[i] = NULL;
+    }
+
+    cache->count = 0;
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+}
+
+size_t mbedtls_x509_verify_cache_len( const mbedtls_x509_verify_cache *cache )
+{
+    return( cache->count );
+}
+
+void mbedtls_x509_verify_cache_free( mbedtls_x509_verify_cache *cache )
+{
+    mbedtls_x509_verify_cache_flush( cache );
+
+    mbedtls_free( cache->buckets );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &cache->mutex );
+#endif
+
+    memset( cache, 0, sizeof( mbedtls_x509_verify_cache ) );
+}
+
+#endif /* MBEDTLS_X509_VERIFY_CACHE_C */
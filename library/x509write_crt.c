@@ -45,10 +45,15 @@
 #include "mbedtls/pem.h"
 #endif /* MBEDTLS_PEM_WRITE_C */
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free       free
+#endif
+
+#include "mbedtls/constant_time.h"
 
 void mbedtls_x509write_crt_init( mbedtls_x509write_cert *ctx )
 {
@@ -58,9 +63,21 @@ void mbedtls_x509write_crt_init( mbedtls_x509write_cert *ctx )
     ctx->version = MBEDTLS_X509_CRT_VERSION_3;
 }
 
+/*
+ * Drop the cached SubjectPublicKeyInfo + extensions encoding; called by
+ * the setters that change what it covers
+ */
+static void x509write_crt_invalidate_tail( mbedtls_x509write_cert *ctx )
+{
+    mbedtls_free( ctx->tbs_tail );
+    ctx->tbs_tail = NULL;
+    ctx->tbs_tail_len = 0;
+}
+
 void mbedtls_x509write_crt_free( mbedtls_x509write_cert *ctx )
 {
     mbedtls_mpi_free( &ctx->serial );
+    x509write_crt_invalidate_tail( ctx );
 
     mbedtls_asn1_free_named_data_list( &ctx->subject );
     mbedtls_asn1_free_named_data_list( &ctx->issuer );
@@ -82,6 +99,7 @@ void mbedtls_x509write_crt_set_md_alg( mbedtls_x509write_cert *ctx, mbedtls_md_t
 void mbedtls_x509write_crt_set_subject_key( mbedtls_x509write_cert *ctx, mbedtls_pk_context *key )
 {
     ctx->subject_key = key;
+    x509write_crt_invalidate_tail( ctx );
 }
 
 void mbedtls_x509write_crt_set_issuer_key( mbedtls_x509write_cert *ctx, mbedtls_pk_context *key )
@@ -132,6 +150,8 @@ int mbedtls_x509write_crt_set_extension( mbedtls_x509write_cert *ctx,
                                  int critical,
                                  const unsigned char *val, size_t val_len )
 {
+    x509write_crt_invalidate_tail( ctx );
+
     return mbedtls_x509_set_extension( &ctx->extensions, oid, oid_len,
                                critical, val, val_len );
 }
@@ -293,25 +313,25 @@ static int x509_write_time( unsigned char **p, unsigned char *start,
     return( (int) len );
 }
 
-int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf, size_t size,
+static int x509write_crt_der_internal( mbedtls_x509write_cert *ctx,
+                       unsigned char *buf, size_t size,
+                       mbedtls_asn1_writer *wr,
                        int (*f_rng)(void *, unsigned char *, size_t),
                        void *p_rng )
 {
     int ret;
     const char *sig_oid;
     size_t sig_oid_len = 0;
-    unsigned char *c, *c2;
+    unsigned char *c2;
     unsigned char hash[64];
     unsigned char sig[MBEDTLS_MPI_MAX_SIZE];
-    unsigned char tmp_buf[2048];
     size_t sub_len = 0, pub_len = 0, sig_and_oid_len = 0, sig_len;
     size_t len = 0;
     mbedtls_pk_type_t pk_alg;
 
     /*
-     * Prepare data to be signed in tmp_buf
+     * Prepare data to be signed in the writer, growing it as needed
      */
-    c = tmp_buf + sizeof( tmp_buf );
 
     /* Signature algorithm needed in TBS, and later for actual signature */
     pk_alg = mbedtls_pk_get_type( ctx->issuer_key );
@@ -325,28 +345,55 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf,
     }
 
     /*
-     *  Extensions  ::=  SEQUENCE SIZE (1..MAX) OF Extension
+     * The extensions and the SubjectPublicKeyInfo are the innermost part
+     * of the TBS and usually the most expensive to encode; they only
+     * depend on ctx->extensions and ctx->subject_key, so their encoding
+     * is cached across calls for batch issuance where only serial,
+     * subject, validity or issuer change between certificates.
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_extensions( &c, tmp_buf, ctx->extensions ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
-                                                    MBEDTLS_ASN1_SEQUENCE ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONTEXT_SPECIFIC |
-                                                    MBEDTLS_ASN1_CONSTRUCTED | 3 ) );
+    if( ctx->tbs_tail != NULL )
+    {
+        while( (size_t)( wr->p - wr->buf ) < ctx->tbs_tail_len )
+            if( ( ret = mbedtls_asn1_writer_grow( wr, len ) ) != 0 )
+                return( ret );
 
-    /*
-     *  SubjectPublicKeyInfo
-     */
-    MBEDTLS_ASN1_CHK_ADD( pub_len, mbedtls_pk_write_pubkey_der( ctx->subject_key,
-                                                tmp_buf, c - tmp_buf ) );
-    c -= pub_len;
-    len += pub_len;
+        wr->p -= ctx->tbs_tail_len;
+        memcpy( wr->p, ctx->tbs_tail, ctx->tbs_tail_len );
+        len += ctx->tbs_tail_len;
+    }
+    else
+    {
+        /*
+         *  Extensions  ::=  SEQUENCE SIZE (1..MAX) OF Extension
+         */
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_x509_write_extensions( &wr->p, wr->buf, ctx->extensions ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
+                                                        MBEDTLS_ASN1_SEQUENCE ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONTEXT_SPECIFIC |
+                                                        MBEDTLS_ASN1_CONSTRUCTED | 3 ) );
+
+        /*
+         *  SubjectPublicKeyInfo
+         */
+        MBEDTLS_ASN1_CHK_ADD_GROW( pub_len, wr, mbedtls_pk_write_pubkey_der( ctx->subject_key,
+                                                    wr->buf, wr->p - wr->buf ) );
+        wr->p -= pub_len;
+        len += pub_len;
+
+        /* Cache it for the next call; failing to is not an error */
+        if( ( ctx->tbs_tail = mbedtls_calloc( 1, len ) ) != NULL )
+        {
+            memcpy( ctx->tbs_tail, wr->p, len );
+            ctx->tbs_tail_len = len;
+        }
+    }
 
     /*
      *  Subject  ::=  Name
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_names( &c, tmp_buf, ctx->subject ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_x509_write_names( &wr->p, wr->buf, ctx->subject ) );
 
     /*
      *  Validity ::= SEQUENCE {
@@ -355,51 +402,51 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf,
      */
     sub_len = 0;
 
-    MBEDTLS_ASN1_CHK_ADD( sub_len, x509_write_time( &c, tmp_buf, ctx->not_after,
+    MBEDTLS_ASN1_CHK_ADD_GROW( sub_len, wr, x509_write_time( &wr->p, wr->buf, ctx->not_after,
                                             MBEDTLS_X509_RFC5280_UTC_TIME_LEN ) );
 
-    MBEDTLS_ASN1_CHK_ADD( sub_len, x509_write_time( &c, tmp_buf, ctx->not_before,
+    MBEDTLS_ASN1_CHK_ADD_GROW( sub_len, wr, x509_write_time( &wr->p, wr->buf, ctx->not_before,
                                             MBEDTLS_X509_RFC5280_UTC_TIME_LEN ) );
 
     len += sub_len;
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, sub_len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, sub_len ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                     MBEDTLS_ASN1_SEQUENCE ) );
 
     /*
      *  Issuer  ::=  Name
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_names( &c, tmp_buf, ctx->issuer ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_x509_write_names( &wr->p, wr->buf, ctx->issuer ) );
 
     /*
      *  Signature   ::=  AlgorithmIdentifier
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_algorithm_identifier( &c, tmp_buf,
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_algorithm_identifier( &wr->p, wr->buf,
                        sig_oid, strlen( sig_oid ), 0 ) );
 
     /*
      *  Serial   ::=  INTEGER
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &c, tmp_buf, &ctx->serial ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_mpi( &wr->p, wr->buf, &ctx->serial ) );
 
     /*
      *  Version  ::=  INTEGER  {  v1(0), v2(1), v3(2)  }
      */
     sub_len = 0;
-    MBEDTLS_ASN1_CHK_ADD( sub_len, mbedtls_asn1_write_int( &c, tmp_buf, ctx->version ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( sub_len, wr, mbedtls_asn1_write_int( &wr->p, wr->buf, ctx->version ) );
     len += sub_len;
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, sub_len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONTEXT_SPECIFIC |
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, sub_len ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONTEXT_SPECIFIC |
                                                     MBEDTLS_ASN1_CONSTRUCTED | 0 ) );
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                     MBEDTLS_ASN1_SEQUENCE ) );
 
     /*
      * Make signature
      */
-    mbedtls_md( mbedtls_md_info_from_type( ctx->md_alg ), c, len, hash );
+    mbedtls_md( mbedtls_md_info_from_type( ctx->md_alg ), wr->p, len, hash );
 
     if( ( ret = mbedtls_pk_sign( ctx->issuer_key, ctx->md_alg, hash, 0, sig, &sig_len,
                          f_rng, p_rng ) ) != 0 )
@@ -415,7 +462,7 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf,
                                         sig_oid, sig_oid_len, sig, sig_len ) );
 
     c2 -= len;
-    memcpy( c2, c, len );
+    memcpy( c2, wr->p, len );
 
     len += sig_and_oid_len;
     MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c2, buf, len ) );
@@ -425,6 +472,22 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf,
     return( (int) len );
 }
 
+int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx, unsigned char *buf, size_t size,
+                       int (*f_rng)(void *, unsigned char *, size_t),
+                       void *p_rng )
+{
+    int ret;
+    mbedtls_asn1_writer wr;
+
+    mbedtls_asn1_writer_init( &wr );
+
+    ret = x509write_crt_der_internal( ctx, buf, size, &wr, f_rng, p_rng );
+
+    mbedtls_asn1_writer_free( &wr );
+
+    return( ret );
+}
+
 #define PEM_BEGIN_CRT           "-----BEGIN CERTIFICATE-----\n"
 #define PEM_END_CRT             "-----END CERTIFICATE-----\n"
 
@@ -44,10 +44,7 @@
 #include "mbedtls/pem.h"
 #endif
 
-/* Implementation that should never be optimized out by the compiler */
-static void mbedtls_zeroize( void *v, size_t n ) {
-    volatile unsigned char *p = v; while( n-- ) *p++ = 0;
-}
+#include "mbedtls/constant_time.h"
 
 void mbedtls_x509write_csr_init( mbedtls_x509write_csr *ctx )
 {
@@ -127,73 +124,73 @@ int mbedtls_x509write_csr_set_ns_cert_type( mbedtls_x509write_csr *ctx,
     return( 0 );
 }
 
-int mbedtls_x509write_csr_der( mbedtls_x509write_csr *ctx, unsigned char *buf, size_t size,
+static int x509write_csr_der_internal( mbedtls_x509write_csr *ctx,
+                       unsigned char *buf, size_t size,
+                       mbedtls_asn1_writer *wr,
                        int (*f_rng)(void *, unsigned char *, size_t),
                        void *p_rng )
 {
     int ret;
     const char *sig_oid;
     size_t sig_oid_len = 0;
-    unsigned char *c, *c2;
+    unsigned char *c2;
     unsigned char hash[64];
     unsigned char sig[MBEDTLS_MPI_MAX_SIZE];
-    unsigned char tmp_buf[2048];
     size_t pub_len = 0, sig_and_oid_len = 0, sig_len;
     size_t len = 0;
     mbedtls_pk_type_t pk_alg;
 
     /*
-     * Prepare data to be signed in tmp_buf
+     * Prepare data to be signed in the writer, growing it as needed
      */
-    c = tmp_buf + sizeof( tmp_buf );
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_extensions( &c, tmp_buf, ctx->extensions ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_x509_write_extensions( &wr->p, wr->buf, ctx->extensions ) );
 
     if( len )
     {
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                         MBEDTLS_ASN1_SEQUENCE ) );
 
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                         MBEDTLS_ASN1_SET ) );
 
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_oid( &c, tmp_buf, MBEDTLS_OID_PKCS9_CSR_EXT_REQ,
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_oid( &wr->p, wr->buf, MBEDTLS_OID_PKCS9_CSR_EXT_REQ,
                                           MBEDTLS_OID_SIZE( MBEDTLS_OID_PKCS9_CSR_EXT_REQ ) ) );
 
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                         MBEDTLS_ASN1_SEQUENCE ) );
     }
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                     MBEDTLS_ASN1_CONTEXT_SPECIFIC ) );
 
-    MBEDTLS_ASN1_CHK_ADD( pub_len, mbedtls_pk_write_pubkey_der( ctx->key,
-                                                tmp_buf, c - tmp_buf ) );
-    c -= pub_len;
+    MBEDTLS_ASN1_CHK_ADD_GROW( pub_len, wr, mbedtls_pk_write_pubkey_der( ctx->key,
+                                                wr->buf, wr->p - wr->buf ) );
+    wr->p -= pub_len;
     len += pub_len;
 
     /*
      *  Subject  ::=  Name
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_names( &c, tmp_buf, ctx->subject ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_x509_write_names( &wr->p, wr->buf, ctx->subject ) );
 
     /*
      *  Version  ::=  INTEGER  {  v1(0), v2(1), v3(2)  }
      */
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_int( &c, tmp_buf, 0 ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_int( &wr->p, wr->buf, 0 ) );
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, tmp_buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, tmp_buf, MBEDTLS_ASN1_CONSTRUCTED |
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_len( &wr->p, wr->buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD_GROW( len, wr, mbedtls_asn1_write_tag( &wr->p, wr->buf, MBEDTLS_ASN1_CONSTRUCTED |
                                                     MBEDTLS_ASN1_SEQUENCE ) );
 
     /*
      * Prepare signature
      */
-    mbedtls_md( mbedtls_md_info_from_type( ctx->md_alg ), c, len, hash );
+    mbedtls_md( mbedtls_md_info_from_type( ctx->md_alg ), wr->p, len, hash );
 
     pk_alg = mbedtls_pk_get_type( ctx->key );
     if( pk_alg == MBEDTLS_PK_ECKEY )
@@ -215,7 +212,7 @@ int mbedtls_x509write_csr_der( mbedtls_x509write_csr *ctx, unsigned char *buf, s
                                         sig_oid, sig_oid_len, sig, sig_len ) );
 
     c2 -= len;
-    memcpy( c2, c, len );
+    memcpy( c2, wr->p, len );
 
     len += sig_and_oid_len;
     MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c2, buf, len ) );
@@ -225,6 +222,22 @@ int mbedtls_x509write_csr_der( mbedtls_x509write_csr *ctx, unsigned char *buf, s
     return( (int) len );
 }
 
+int mbedtls_x509write_csr_der( mbedtls_x509write_csr *ctx, unsigned char *buf, size_t size,
+                       int (*f_rng)(void *, unsigned char *, size_t),
+                       void *p_rng )
+{
+    int ret;
+    mbedtls_asn1_writer wr;
+
+    mbedtls_asn1_writer_init( &wr );
+
+    ret = x509write_csr_der_internal( ctx, buf, size, &wr, f_rng, p_rng );
+
+    mbedtls_asn1_writer_free( &wr );
+
+    return( ret );
+}
+
 #define PEM_BEGIN_CSR           "-----BEGIN CERTIFICATE REQUEST-----\n"
 #define PEM_END_CSR             "-----END CERTIFICATE REQUEST-----\n"
 
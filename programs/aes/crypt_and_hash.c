@@ -58,6 +58,8 @@
 #define MODE_ENCRYPT    0
 #define MODE_DECRYPT    1
 
+#define IO_CHUNK_SIZE   ( 1 << 16 )
+
 #define USAGE   \
     "\n  crypt_and_hash <mode> <input filename> <output filename> <cipher> <mbedtls_md> <key>\n" \
     "\n   <mode>: 0 = encrypt, 1 = decrypt\n" \
@@ -84,7 +86,7 @@ int main( int argc, char *argv[] )
     unsigned char key[512];
     unsigned char digest[MBEDTLS_MD_MAX_SIZE];
     unsigned char buffer[1024];
-    unsigned char output[1024];
+    unsigned char *ibuf = NULL, *obuf = NULL;
     unsigned char diff;
 
     const mbedtls_cipher_info_t *cipher_info;
@@ -256,6 +258,18 @@ int main( int argc, char *argv[] )
         goto exit;
     }
 
+    /*
+     * Large I/O buffers: reading a chunk at a time instead of a cipher
+     * block at a time is what makes this tool keep up with fast disks.
+     */
+    ibuf = calloc( 1, IO_CHUNK_SIZE );
+    obuf = calloc( 1, IO_CHUNK_SIZE + 16 );
+    if( ibuf == NULL || obuf == NULL )
+    {
+        mbedtls_fprintf( stderr, "calloc(%d bytes) failed\n", IO_CHUNK_SIZE );
+        goto exit;
+    }
+
     if( mode == MODE_ENCRYPT )
     {
         /*
@@ -330,42 +344,43 @@ int main( int argc, char *argv[] )
         mbedtls_md_hmac_starts( &md_ctx, digest, 32 );
 
         /*
-         * Encrypt and write the ciphertext.
+         * Encrypt and write the ciphertext, a chunk at a time; the
+         * library helper interleaves the cipher and the HMAC so each
+         * chunk of ciphertext is hashed while still in cache.
          */
-        for( offset = 0; offset < filesize; offset += mbedtls_cipher_get_block_size( &cipher_ctx ) )
+        for( offset = 0; offset < filesize; offset += ilen )
         {
-            ilen = ( (unsigned int) filesize - offset > mbedtls_cipher_get_block_size( &cipher_ctx ) ) ?
-                mbedtls_cipher_get_block_size( &cipher_ctx ) : (unsigned int) ( filesize - offset );
+            ilen = ( filesize - offset > IO_CHUNK_SIZE ) ?
+                IO_CHUNK_SIZE : (size_t) ( filesize - offset );
 
-            if( fread( buffer, 1, ilen, fin ) != ilen )
+            if( fread( ibuf, 1, ilen, fin ) != ilen )
             {
                 mbedtls_fprintf( stderr, "fread(%ld bytes) failed\n", (long) ilen );
                 goto exit;
             }
 
-            if( mbedtls_cipher_update( &cipher_ctx, buffer, ilen, output, &olen ) != 0 )
+            if( mbedtls_cipher_update_hmac( &cipher_ctx, &md_ctx, ibuf, ilen,
+                                            obuf, &olen, 1 ) != 0 )
             {
-                mbedtls_fprintf( stderr, "mbedtls_cipher_update() returned error\n");
+                mbedtls_fprintf( stderr, "mbedtls_cipher_update_hmac() returned error\n");
                 goto exit;
             }
 
-            mbedtls_md_hmac_update( &md_ctx, output, olen );
-
-            if( fwrite( output, 1, olen, fout ) != olen )
+            if( fwrite( obuf, 1, olen, fout ) != olen )
             {
                 mbedtls_fprintf( stderr, "fwrite(%ld bytes) failed\n", (long) olen );
                 goto exit;
             }
         }
 
-        if( mbedtls_cipher_finish( &cipher_ctx, output, &olen ) != 0 )
+        if( mbedtls_cipher_finish( &cipher_ctx, obuf, &olen ) != 0 )
         {
             mbedtls_fprintf( stderr, "mbedtls_cipher_finish() returned error\n" );
             goto exit;
         }
-        mbedtls_md_hmac_update( &md_ctx, output, olen );
+        mbedtls_md_hmac_update( &md_ctx, obuf, olen );
 
-        if( fwrite( output, 1, olen, fout ) != olen )
+        if( fwrite( obuf, 1, olen, fout ) != olen )
         {
             mbedtls_fprintf( stderr, "fwrite(%ld bytes) failed\n", (long) olen );
             goto exit;
@@ -464,28 +479,27 @@ int main( int argc, char *argv[] )
         mbedtls_md_hmac_starts( &md_ctx, digest, 32 );
 
         /*
-         * Decrypt and write the plaintext.
+         * Decrypt and write the plaintext, a chunk at a time.
          */
-        for( offset = 0; offset < filesize; offset += mbedtls_cipher_get_block_size( &cipher_ctx ) )
+        for( offset = 0; offset < filesize; offset += ilen )
         {
-            if( fread( buffer, 1, mbedtls_cipher_get_block_size( &cipher_ctx ), fin ) !=
-                (size_t) mbedtls_cipher_get_block_size( &cipher_ctx ) )
+            ilen = ( filesize - offset > IO_CHUNK_SIZE ) ?
+                IO_CHUNK_SIZE : (size_t) ( filesize - offset );
+
+            if( fread( ibuf, 1, ilen, fin ) != ilen )
             {
-                mbedtls_fprintf( stderr, "fread(%d bytes) failed\n",
-                    mbedtls_cipher_get_block_size( &cipher_ctx ) );
+                mbedtls_fprintf( stderr, "fread(%ld bytes) failed\n", (long) ilen );
                 goto exit;
             }
 
-            mbedtls_md_hmac_update( &md_ctx, buffer, mbedtls_cipher_get_block_size( &cipher_ctx ) );
-            if( mbedtls_cipher_update( &cipher_ctx, buffer,
-                               mbedtls_cipher_get_block_size( &cipher_ctx ),
-                               output, &olen ) != 0 )
+            if( mbedtls_cipher_update_hmac( &cipher_ctx, &md_ctx, ibuf, ilen,
+                                            obuf, &olen, 0 ) != 0 )
             {
-                mbedtls_fprintf( stderr, "mbedtls_cipher_update() returned error\n" );
+                mbedtls_fprintf( stderr, "mbedtls_cipher_update_hmac() returned error\n" );
                 goto exit;
             }
 
-            if( fwrite( output, 1, olen, fout ) != olen )
+            if( fwrite( obuf, 1, olen, fout ) != olen )
             {
                 mbedtls_fprintf( stderr, "fwrite(%ld bytes) failed\n", (long) olen );
                 goto exit;
@@ -518,9 +532,9 @@ int main( int argc, char *argv[] )
         /*
          * Write the final block of data
          */
-        mbedtls_cipher_finish( &cipher_ctx, output, &olen );
+        mbedtls_cipher_finish( &cipher_ctx, obuf, &olen );
 
-        if( fwrite( output, 1, olen, fout ) != olen )
+        if( fwrite( obuf, 1, olen, fout ) != olen )
         {
             mbedtls_fprintf( stderr, "fwrite(%ld bytes) failed\n", (long) olen );
             goto exit;
@@ -538,6 +552,17 @@ exit:
     memset( buffer, 0, sizeof( buffer ) );
     memset( digest, 0, sizeof( digest ) );
 
+    if( ibuf != NULL )
+    {
+        memset( ibuf, 0, IO_CHUNK_SIZE );
+        free( ibuf );
+    }
+    if( obuf != NULL )
+    {
+        memset( obuf, 0, IO_CHUNK_SIZE + 16 );
+        free( obuf );
+    }
+
     mbedtls_cipher_free( &cipher_ctx );
     mbedtls_md_free( &md_ctx );
 
@@ -30,8 +30,11 @@
 #include "mbedtls/platform.h"
 #else
 #include <stdio.h>
+#include <stdlib.h>
 #define mbedtls_fprintf    fprintf
 #define mbedtls_printf     printf
+#define mbedtls_calloc     calloc
+#define mbedtls_free       free
 #endif
 
 #if defined(MBEDTLS_MD_C) && defined(MBEDTLS_FS_IO)
@@ -41,6 +44,10 @@
 #include <string.h>
 #endif
 
+#if defined(MBEDTLS_THREADING_PTHREAD)
+#include <pthread.h>
+#endif
+
 #if !defined(MBEDTLS_MD_C) || !defined(MBEDTLS_FS_IO)
 int main( void )
 {
@@ -76,6 +83,110 @@ static int generic_print( const mbedtls_md_info_t *md_info, char *filename )
     return( 0 );
 }
 
+#if defined(MBEDTLS_THREADING_PTHREAD)
+#define MAX_WORKER_THREADS  8
+
+typedef struct
+{
+    const mbedtls_md_info_t *md_info;
+    char **filenames;
+    int nb_files;
+    unsigned char *sums;        /*!< nb_files * MBEDTLS_MD_MAX_SIZE bytes  */
+    int *results;               /*!< per-file return code of the wrapper   */
+    int next;                   /*!< next file index, protected by mutex   */
+    pthread_mutex_t mutex;
+} generic_job_list;
+
+static void *generic_worker( void *arg )
+{
+    generic_job_list *jobs = (generic_job_list *) arg;
+    int idx;
+
+    for( ; ; )
+    {
+        pthread_mutex_lock( &jobs->mutex );
+        idx = jobs->next++;
+        pthread_mutex_unlock( &jobs->mutex );
+
+        if( idx >= jobs->nb_files )
+            break;
+
+        jobs->results[idx] = generic_wrapper( jobs->md_info,
+                                jobs->filenames[idx],
+                                jobs->sums + idx * MBEDTLS_MD_MAX_SIZE );
+    }
+
+    return( NULL );
+}
+
+/*
+ * Hash the files on several threads, then print the digests in
+ * command-line order so the output matches the serial version.
+ */
+static int generic_print_parallel( const mbedtls_md_info_t *md_info,
+                                   char **filenames, int nb_files )
+{
+    int i, j, ret = 0, nb_threads, nb_started;
+    pthread_t threads[MAX_WORKER_THREADS];
+    generic_job_list jobs;
+
+    jobs.md_info = md_info;
+    jobs.filenames = filenames;
+    jobs.nb_files = nb_files;
+    jobs.next = 0;
+    jobs.sums = mbedtls_calloc( nb_files, MBEDTLS_MD_MAX_SIZE );
+    jobs.results = mbedtls_calloc( nb_files, sizeof( int ) );
+
+    if( jobs.sums == NULL || jobs.results == NULL )
+    {
+        mbedtls_free( jobs.sums );
+        mbedtls_free( jobs.results );
+
+        for( i = 0; i < nb_files; i++ )
+            ret |= generic_print( md_info, filenames[i] );
+
+        return( ret );
+    }
+
+    pthread_mutex_init( &jobs.mutex, NULL );
+
+    /* The main thread works too, so start one thread fewer */
+    nb_threads = nb_files < MAX_WORKER_THREADS ? nb_files : MAX_WORKER_THREADS;
+    nb_started = 0;
+    for( i = 0; i < nb_threads - 1; i++ )
+    {
+        if( pthread_create( &threads[i], NULL, generic_worker, &jobs ) != 0 )
+            break;
+        nb_started++;
+    }
+
+    generic_worker( &jobs );
+
+    for( i = 0; i < nb_started; i++ )
+        pthread_join( threads[i], NULL );
+
+    for( i = 0; i < nb_files; i++ )
+    {
+        if( jobs.results[i] != 0 )
+        {
+            ret |= 1;
+            continue;
+        }
+
+        for( j = 0; j < mbedtls_md_get_size( md_info ); j++ )
+            mbedtls_printf( "%02x", jobs.sums[i * MBEDTLS_MD_MAX_SIZE + j] );
+
+        mbedtls_printf( "  %s\n", filenames[i] );
+    }
+
+    pthread_mutex_destroy( &jobs.mutex );
+    mbedtls_free( jobs.sums );
+    mbedtls_free( jobs.results );
+
+    return( ret );
+}
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
 static int generic_check( const mbedtls_md_info_t *md_info, char *filename )
 {
     int i;
@@ -165,7 +276,10 @@ static int generic_check( const mbedtls_md_info_t *md_info, char *filename )
 
 int main( int argc, char *argv[] )
 {
-    int ret, i;
+    int ret;
+#if !defined(MBEDTLS_THREADING_PTHREAD)
+    int i;
+#endif
     const mbedtls_md_info_t *md_info;
     mbedtls_md_context_t md_ctx;
 
@@ -217,8 +331,12 @@ int main( int argc, char *argv[] )
         goto exit;
     }
 
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    ret |= generic_print_parallel( md_info, &argv[2], argc - 2 );
+#else
     for( i = 2; i < argc; i++ )
         ret |= generic_print( md_info, argv[i] );
+#endif
 
 exit:
     mbedtls_md_free( &md_ctx );
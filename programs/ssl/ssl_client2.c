@@ -80,14 +80,19 @@ int main( void )
 #define DFL_RENEGOTIATION       MBEDTLS_SSL_RENEGOTIATION_DISABLED
 #define DFL_ALLOW_LEGACY        -2
 #define DFL_RENEGOTIATE         0
+#define DFL_REKEY               0
 #define DFL_EXCHANGES           1
+#define DFL_BENCH_BYTES         1024
+#define DFL_BENCH_DURATION      10
 #define DFL_MIN_VERSION         -1
 #define DFL_MAX_VERSION         -1
 #define DFL_ARC4                -1
 #define DFL_AUTH_MODE           -1
+#define DFL_CERT_RETAIN         -1
 #define DFL_MFL_CODE            MBEDTLS_SSL_MAX_FRAG_LEN_NONE
 #define DFL_TRUNC_HMAC          -1
 #define DFL_RECSPLIT            -1
+#define DFL_RECORD_PAD          0
 #define DFL_DHMLEN              -1
 #define DFL_RECONNECT           0
 #define DFL_RECO_DELAY          0
@@ -96,7 +101,10 @@ int main( void )
 #define DFL_TRANSPORT           MBEDTLS_SSL_TRANSPORT_STREAM
 #define DFL_HS_TO_MIN           0
 #define DFL_HS_TO_MAX           0
+#define DFL_HS_BURST            0
+#define DFL_MTU                 0
 #define DFL_FALLBACK            -1
+#define DFL_FALSE_START         -1
 #define DFL_EXTENDED_MS         -1
 #define DFL_ETM                 -1
 
@@ -158,6 +166,13 @@ int main( void )
 #define USAGE_RECSPLIT
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+#define USAGE_RECORD_PAD \
+    "    record_pad=%%d       default: 0 (minimal CBC padding)\n"
+#else
+#define USAGE_RECORD_PAD
+#endif
+
 #if defined(MBEDTLS_DHM_C)
 #define USAGE_DHMLEN \
     "    dhmlen=%%d           default: (library default: 1024 bits)\n"
@@ -177,7 +192,11 @@ int main( void )
 #define USAGE_DTLS \
     "    dtls=%%d             default: 0 (TLS)\n"                           \
     "    hs_timeout=%%d-%%d    default: (library default: 1000-60000)\n"    \
-    "                        range of DTLS handshake timeouts in millisecs\n"
+    "                        range of DTLS handshake timeouts in millisecs\n" \
+    "    hs_burst=%%d         default: 0 (no limit)\n"                      \
+    "                        max records per retransmitted flight burst\n"  \
+    "    mtu=%%d              default: 0 (unset, no fragmentation)\n"       \
+    "                        path MTU for outgoing handshake fragments\n"
 #else
 #define USAGE_DTLS ""
 #endif
@@ -189,6 +208,13 @@ int main( void )
 #define USAGE_FALLBACK ""
 #endif
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+#define USAGE_FALSE_START \
+    "    falsestart=0/1      default: (library default: off)\n"
+#else
+#define USAGE_FALSE_START ""
+#endif
+
 #if defined(MBEDTLS_SSL_EXTENDED_MASTER_SECRET)
 #define USAGE_EMS \
     "    extended_ms=0/1     default: (library default: on)\n"
@@ -206,7 +232,8 @@ int main( void )
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
 #define USAGE_RENEGO \
     "    renegotiation=%%d    default: 0 (disabled)\n"      \
-    "    renegotiate=%%d      default: 0 (disabled)\n"
+    "    renegotiate=%%d      default: 0 (disabled)\n"     \
+    "    rekey=%%d            default: 0 (disabled)\n"
 #else
 #define USAGE_RENEGO ""
 #endif
@@ -230,6 +257,8 @@ int main( void )
     "\n"                                                    \
     "    auth_mode=%%s        default: (library default: none)\n"      \
     "                        options: none, optional, required\n" \
+    "    cert_retain=%%s      default: (library default: full)\n" \
+    "                        options: full, leaf, digest, none\n" \
     USAGE_IO                                                \
     "\n"                                                    \
     USAGE_PSK                                               \
@@ -237,6 +266,9 @@ int main( void )
     "    allow_legacy=%%d     default: (library default: no)\n"      \
     USAGE_RENEGO                                            \
     "    exchanges=%%d        default: 1\n"                 \
+    "                        -1: throughput mode, stream records (see bytes/duration)\n" \
+    "    bytes=%%d            default: 1024 (record payload in throughput mode)\n" \
+    "    duration=%%d         default: 10 seconds (throughput mode)\n" \
     "    reconnect=%%d        default: 0 (disabled)\n"      \
     "    reco_delay=%%d       default: 0 seconds\n"         \
     USAGE_TICKETS                                           \
@@ -244,9 +276,11 @@ int main( void )
     USAGE_TRUNC_HMAC                                        \
     USAGE_ALPN                                              \
     USAGE_FALLBACK                                          \
+    USAGE_FALSE_START                                       \
     USAGE_EMS                                               \
     USAGE_ETM                                               \
     USAGE_RECSPLIT                                          \
+    USAGE_RECORD_PAD                                        \
     USAGE_DHMLEN                                            \
     "\n"                                                    \
     "    arc4=%%d             default: (library default: 0)\n" \
@@ -283,14 +317,19 @@ struct options
     int allow_legacy;           /* allow legacy renegotiation               */
     int renegotiate;            /* attempt renegotiation?                   */
     int renego_delay;           /* delay before enforcing renegotiation     */
+    int rekey;                  /* attempt an abbreviated rekey?            */
     int exchanges;              /* number of data exchanges                 */
+    int bytes;                  /* record payload in throughput mode        */
+    int duration;               /* how long to stream, in seconds           */
     int min_version;            /* minimum protocol version accepted        */
     int max_version;            /* maximum protocol version accepted        */
     int arc4;                   /* flag for arc4 suites support             */
     int auth_mode;              /* verify mode for connection               */
+    int cert_retain;            /* peer certificate retention policy        */
     unsigned char mfl_code;     /* code for maximum fragment length         */
     int trunc_hmac;             /* negotiate truncated hmac or not          */
     int recsplit;               /* enable record splitting?                 */
+    int record_pad;             /* CBC record padding boundary              */
     int dhmlen;                 /* minimum DHM params len in bits           */
     int reconnect;              /* attempt to resume session                */
     int reco_delay;             /* delay in seconds before resuming session */
@@ -299,7 +338,10 @@ struct options
     int transport;              /* TLS or DTLS?                             */
     uint32_t hs_to_min;         /* Initial value of DTLS handshake timer    */
     uint32_t hs_to_max;         /* Max value of DTLS handshake timer        */
+    unsigned int hs_burst;      /* Max records per retransmission burst     */
+    int mtu;                    /* path MTU for DTLS handshake fragments    */
     int fallback;               /* is this a fallback connection?           */
+    int false_start;            /* send early data after client Finished?   */
     int extended_ms;            /* negotiate extended master secret?        */
     int etm;                    /* negotiate encrypt then mac?              */
 } opt;
@@ -471,14 +513,19 @@ int main( int argc, char *argv[] )
     opt.renegotiation       = DFL_RENEGOTIATION;
     opt.allow_legacy        = DFL_ALLOW_LEGACY;
     opt.renegotiate         = DFL_RENEGOTIATE;
+    opt.rekey               = DFL_REKEY;
     opt.exchanges           = DFL_EXCHANGES;
+    opt.bytes               = DFL_BENCH_BYTES;
+    opt.duration            = DFL_BENCH_DURATION;
     opt.min_version         = DFL_MIN_VERSION;
     opt.max_version         = DFL_MAX_VERSION;
     opt.arc4                = DFL_ARC4;
     opt.auth_mode           = DFL_AUTH_MODE;
+    opt.cert_retain         = DFL_CERT_RETAIN;
     opt.mfl_code            = DFL_MFL_CODE;
     opt.trunc_hmac          = DFL_TRUNC_HMAC;
     opt.recsplit            = DFL_RECSPLIT;
+    opt.record_pad          = DFL_RECORD_PAD;
     opt.dhmlen              = DFL_DHMLEN;
     opt.reconnect           = DFL_RECONNECT;
     opt.reco_delay          = DFL_RECO_DELAY;
@@ -487,7 +534,10 @@ int main( int argc, char *argv[] )
     opt.transport           = DFL_TRANSPORT;
     opt.hs_to_min           = DFL_HS_TO_MIN;
     opt.hs_to_max           = DFL_HS_TO_MAX;
+    opt.hs_burst            = DFL_HS_BURST;
+    opt.mtu                 = DFL_MTU;
     opt.fallback            = DFL_FALLBACK;
+    opt.false_start         = DFL_FALSE_START;
     opt.extended_ms         = DFL_EXTENDED_MS;
     opt.etm                 = DFL_ETM;
 
@@ -586,10 +636,28 @@ int main( int argc, char *argv[] )
             if( opt.renegotiate < 0 || opt.renegotiate > 1 )
                 goto usage;
         }
+        else if( strcmp( p, "rekey" ) == 0 )
+        {
+            opt.rekey = atoi( q );
+            if( opt.rekey < 0 || opt.rekey > 1 )
+                goto usage;
+        }
         else if( strcmp( p, "exchanges" ) == 0 )
         {
             opt.exchanges = atoi( q );
-            if( opt.exchanges < 1 )
+            if( opt.exchanges < 1 && opt.exchanges != -1 )
+                goto usage;
+        }
+        else if( strcmp( p, "bytes" ) == 0 )
+        {
+            opt.bytes = atoi( q );
+            if( opt.bytes < 1 || opt.bytes > MBEDTLS_SSL_MAX_CONTENT_LEN )
+                goto usage;
+        }
+        else if( strcmp( p, "duration" ) == 0 )
+        {
+            opt.duration = atoi( q );
+            if( opt.duration < 1 )
                 goto usage;
         }
         else if( strcmp( p, "reconnect" ) == 0 )
@@ -623,6 +691,15 @@ int main( int argc, char *argv[] )
                 default: goto usage;
             }
         }
+        else if( strcmp( p, "falsestart" ) == 0 )
+        {
+            switch( atoi( q ) )
+            {
+                case 0: opt.false_start = MBEDTLS_SSL_FALSE_START_DISABLED; break;
+                case 1: opt.false_start = MBEDTLS_SSL_FALSE_START_ENABLED; break;
+                default: goto usage;
+            }
+        }
         else if( strcmp( p, "extended_ms" ) == 0 )
         {
             switch( atoi( q ) )
@@ -728,6 +805,19 @@ int main( int argc, char *argv[] )
             else
                 goto usage;
         }
+        else if( strcmp( p, "cert_retain" ) == 0 )
+        {
+            if( strcmp( q, "full" ) == 0 )
+                opt.cert_retain = MBEDTLS_SSL_CERT_RETAIN_FULL;
+            else if( strcmp( q, "leaf" ) == 0 )
+                opt.cert_retain = MBEDTLS_SSL_CERT_RETAIN_LEAF;
+            else if( strcmp( q, "digest" ) == 0 )
+                opt.cert_retain = MBEDTLS_SSL_CERT_RETAIN_DIGEST;
+            else if( strcmp( q, "none" ) == 0 )
+                opt.cert_retain = MBEDTLS_SSL_CERT_RETAIN_NONE;
+            else
+                goto usage;
+        }
         else if( strcmp( p, "max_frag_len" ) == 0 )
         {
             if( strcmp( q, "512" ) == 0 )
@@ -760,12 +850,30 @@ int main( int argc, char *argv[] )
             if( opt.hs_to_min == 0 || opt.hs_to_max < opt.hs_to_min )
                 goto usage;
         }
+        else if( strcmp( p, "hs_burst" ) == 0 )
+        {
+            if( atoi( q ) < 0 )
+                goto usage;
+            opt.hs_burst = (unsigned int) atoi( q );
+        }
+        else if( strcmp( p, "mtu" ) == 0 )
+        {
+            opt.mtu = atoi( q );
+            if( opt.mtu < 0 || opt.mtu > 0xFFFF )
+                goto usage;
+        }
         else if( strcmp( p, "recsplit" ) == 0 )
         {
             opt.recsplit = atoi( q );
             if( opt.recsplit < 0 || opt.recsplit > 1 )
                 goto usage;
         }
+        else if( strcmp( p, "record_pad" ) == 0 )
+        {
+            opt.record_pad = atoi( q );
+            if( opt.record_pad < 0 || opt.record_pad > 256 )
+                goto usage;
+        }
         else if( strcmp( p, "dhmlen" ) == 0 )
         {
             opt.dhmlen = atoi( q );
@@ -1071,9 +1179,17 @@ int main( int argc, char *argv[] )
     if( opt.auth_mode != DFL_AUTH_MODE )
         mbedtls_ssl_conf_authmode( &conf, opt.auth_mode );
 
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if( opt.cert_retain != DFL_CERT_RETAIN )
+        mbedtls_ssl_conf_cert_retention( &conf, opt.cert_retain );
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( opt.hs_to_min != DFL_HS_TO_MIN || opt.hs_to_max != DFL_HS_TO_MAX )
         mbedtls_ssl_conf_handshake_timeout( &conf, opt.hs_to_min, opt.hs_to_max );
+
+    if( opt.hs_burst != DFL_HS_BURST )
+        mbedtls_ssl_conf_handshake_burst( &conf, opt.hs_burst );
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
@@ -1106,6 +1222,11 @@ int main( int argc, char *argv[] )
                                     : MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED );
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+    if( opt.record_pad != DFL_RECORD_PAD )
+        mbedtls_ssl_conf_record_pad( &conf, opt.record_pad );
+#endif
+
 #if defined(MBEDTLS_DHM_C)
     if( opt.dhmlen != DFL_DHMLEN )
         mbedtls_ssl_conf_dhm_min_bitlen( &conf, opt.dhmlen );
@@ -1181,12 +1302,22 @@ int main( int argc, char *argv[] )
         mbedtls_ssl_conf_fallback( &conf, opt.fallback );
 #endif
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+    if( opt.false_start != DFL_FALSE_START )
+        mbedtls_ssl_conf_false_start( &conf, opt.false_start );
+#endif
+
     if( ( ret = mbedtls_ssl_setup( &ssl, &conf ) ) != 0 )
     {
         mbedtls_printf( " failed\n  ! mbedtls_ssl_setup returned -0x%x\n\n", -ret );
         goto exit;
     }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( opt.mtu != DFL_MTU )
+        mbedtls_ssl_set_mtu( &ssl, (uint16_t) opt.mtu );
+#endif
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     if( ( ret = mbedtls_ssl_set_hostname( &ssl, opt.server_name ) ) != 0 )
     {
@@ -1214,6 +1345,17 @@ int main( int argc, char *argv[] )
     mbedtls_printf( "  . Performing the SSL/TLS handshake..." );
     fflush( stdout );
 
+#if defined(MBEDTLS_SSL_FALSE_START)
+    if( opt.false_start == MBEDTLS_SSL_FALSE_START_ENABLED )
+    {
+        /* Let the first mbedtls_ssl_write() drive the handshake, so that
+         * the request can go out right after our Finished message */
+        mbedtls_printf( " deferred to first write (false start)\n" );
+        retry_left = opt.max_resend;
+        goto send_request;
+    }
+#endif
+
     while( ( ret = mbedtls_ssl_handshake( &ssl ) ) != 0 )
     {
         if( ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE )
@@ -1311,12 +1453,113 @@ int main( int argc, char *argv[] )
         }
         mbedtls_printf( " ok\n" );
     }
+
+    if( opt.rekey )
+    {
+        /*
+         * Perform an abbreviated rekey (like renegotiation, the server must
+         * be waiting for input from our side).
+         */
+        mbedtls_printf( "  . Performing abbreviated rekey..." );
+        fflush( stdout );
+        while( ( ret = mbedtls_ssl_rekey( &ssl ) ) != 0 )
+        {
+            if( ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+            {
+                mbedtls_printf( " failed\n  ! mbedtls_ssl_rekey returned %d\n\n", ret );
+                goto exit;
+            }
+        }
+        mbedtls_printf( " ok\n" );
+    }
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
+    retry_left = opt.max_resend;
+
+    /*
+     * 6a. Throughput mode: stream fixed-size records for a fixed
+     *     duration and report the steady-state record-layer rate
+     */
+    if( opt.exchanges == -1 )
+    {
+        unsigned long elapsed_ms, record_ms, max_record_ms = 0;
+        unsigned long records = 0;
+        unsigned long long total_bytes = 0, rate, avg_us;
+        struct mbedtls_timing_hr_time total_timer, record_timer;
+
+        mbedtls_printf( "  . Streaming %d-byte records for %d seconds...",
+                        opt.bytes, opt.duration );
+        fflush( stdout );
+
+        memset( buf, 'B', opt.bytes );
+
+        (void) mbedtls_timing_get_timer( &total_timer, 1 );
+
+        do
+        {
+            (void) mbedtls_timing_get_timer( &record_timer, 1 );
+
+            if( opt.transport == MBEDTLS_SSL_TRANSPORT_STREAM )
+            {
+                for( written = 0; written < opt.bytes; written += ret )
+                {
+                    while( ( ret = mbedtls_ssl_write( &ssl, buf + written,
+                                                  opt.bytes - written ) ) <= 0 )
+                    {
+                        if( ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                            ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+                        {
+                            mbedtls_printf( " failed\n  ! mbedtls_ssl_write returned -0x%x\n\n", -ret );
+                            goto exit;
+                        }
+                    }
+                }
+            }
+            else /* Not stream, so datagram */
+            {
+                do ret = mbedtls_ssl_write( &ssl, buf, opt.bytes );
+                while( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+                       ret == MBEDTLS_ERR_SSL_WANT_WRITE );
+
+                if( ret < 0 )
+                {
+                    mbedtls_printf( " failed\n  ! mbedtls_ssl_write returned %d\n\n", ret );
+                    goto exit;
+                }
+            }
+
+            record_ms = mbedtls_timing_get_timer( &record_timer, 0 );
+            if( record_ms > max_record_ms )
+                max_record_ms = record_ms;
+
+            records++;
+            total_bytes += (unsigned long long) opt.bytes;
+
+            elapsed_ms = mbedtls_timing_get_timer( &total_timer, 0 );
+        }
+        while( elapsed_ms < (unsigned long) opt.duration * 1000 );
+
+        /* rate in hundredths of MB/s, latency in microseconds */
+        rate = total_bytes / ( (unsigned long long) elapsed_ms * 10 );
+        avg_us = (unsigned long long) elapsed_ms * 1000 / records;
+
+        mbedtls_printf( " done\n" );
+        mbedtls_printf( "    %lu records, %llu bytes in %lu.%03lu s\n",
+                        records, total_bytes,
+                        elapsed_ms / 1000, elapsed_ms % 1000 );
+        mbedtls_printf( "    %llu.%02llu MB/s, avg %llu.%03llu ms/record, "
+                        "max %lu ms\n",
+                        rate / 100, rate % 100,
+                        avg_us / 1000, avg_us % 1000, max_record_ms );
+
+        ret = 0;
+        goto close_notify;
+    }
+
     /*
      * 6. Write the GET request
      */
-    retry_left = opt.max_resend;
 send_request:
     mbedtls_printf( "  > Write to server:" );
     fflush( stdout );
@@ -0,0 +1,530 @@
+/*
+ *  SSL server demonstration program using an epoll event loop
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_fprintf    fprintf
+#define mbedtls_printf     printf
+#define mbedtls_snprintf   snprintf
+#define mbedtls_calloc     calloc
+#define mbedtls_free       free
+#endif
+
+#if !defined(MBEDTLS_BIGNUM_C) || !defined(MBEDTLS_CERTS_C) ||    \
+    !defined(MBEDTLS_ENTROPY_C) || !defined(MBEDTLS_SSL_TLS_C) || \
+    !defined(MBEDTLS_SSL_SRV_C) || !defined(MBEDTLS_NET_C) ||     \
+    !defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_CTR_DRBG_C) ||    \
+    !defined(MBEDTLS_X509_CRT_PARSE_C) || !defined(MBEDTLS_PEM_PARSE_C) || \
+    !defined(__linux__)
+int main( void )
+{
+    mbedtls_printf("MBEDTLS_BIGNUM_C and/or MBEDTLS_CERTS_C and/or MBEDTLS_ENTROPY_C "
+           "and/or MBEDTLS_SSL_TLS_C and/or MBEDTLS_SSL_SRV_C and/or "
+           "MBEDTLS_NET_C and/or MBEDTLS_RSA_C and/or "
+           "MBEDTLS_CTR_DRBG_C and/or MBEDTLS_X509_CRT_PARSE_C "
+           "and/or MBEDTLS_PEM_PARSE_C not defined, or not running "
+           "on Linux (epoll).\n");
+    return( 0 );
+}
+#else
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/x509.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/net.h"
+#include "mbedtls/error.h"
+#include "mbedtls/debug.h"
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+#include "mbedtls/ssl_cache.h"
+#endif
+
+#define HTTP_RESPONSE \
+    "HTTP/1.0 200 OK\r\nContent-Type: text/html\r\n\r\n" \
+    "<h2>mbed TLS Test Server</h2>\r\n" \
+    "<p>Successful connection using: %s</p>\r\n"
+
+#define DEBUG_LEVEL 0
+
+#define MAX_EVENTS 64
+
+static void my_debug( void *ctx, int level,
+                      const char *file, int line,
+                      const char *str )
+{
+    ((void) level);
+
+    mbedtls_fprintf( (FILE *) ctx, "%s:%04d: %s", file, line, str );
+    fflush(  (FILE *) ctx  );
+}
+
+/*
+ * One connection, driven through its states by socket readiness. A
+ * connection never blocks: whenever the stack returns WANT_READ or
+ * WANT_WRITE we park it and wait for epoll to wake us up again.
+ */
+enum conn_state
+{
+    CONN_HANDSHAKE = 0,     /* mbedtls_ssl_handshake() in progress  */
+    CONN_READ_REQUEST,      /* waiting for the HTTP request         */
+    CONN_WRITE_RESPONSE,    /* (re)sending the HTTP response        */
+    CONN_CLOSING            /* close_notify not fully sent yet      */
+};
+
+typedef struct ssl_conn
+{
+    mbedtls_net_context net;
+    mbedtls_ssl_context ssl;
+    enum conn_state state;
+    unsigned char buf[1024];    /* response being written   */
+    size_t len;                 /* total length of buf      */
+    size_t off;                 /* bytes of buf written     */
+} ssl_conn;
+
+/*
+ * Register interest in the events the stack is waiting for
+ */
+static int conn_rearm( int epfd, ssl_conn *conn, int want_write )
+{
+    struct epoll_event ev;
+
+    memset( &ev, 0, sizeof( ev ) );
+    ev.events = want_write ? EPOLLOUT : EPOLLIN;
+    ev.data.ptr = conn;
+
+    return( epoll_ctl( epfd, EPOLL_CTL_MOD,
+                       mbedtls_net_fd( &conn->net ), &ev ) );
+}
+
+static void conn_close( int epfd, ssl_conn *conn )
+{
+    epoll_ctl( epfd, EPOLL_CTL_DEL, mbedtls_net_fd( &conn->net ), NULL );
+    mbedtls_ssl_free( &conn->ssl );
+    mbedtls_net_free( &conn->net );
+    mbedtls_free( conn );
+}
+
+/*
+ * Advance a connection as far as it will go without blocking.
+ * Returns 0 if the connection is parked waiting for an event,
+ * or a non-zero value if it has been torn down.
+ */
+static int conn_step( int epfd, ssl_conn *conn )
+{
+    int ret;
+    int fd = mbedtls_net_fd( &conn->net );
+
+    while( 1 )
+    {
+        switch( conn->state )
+        {
+        case CONN_HANDSHAKE:
+            ret = mbedtls_ssl_handshake( &conn->ssl );
+            if( ret == 0 )
+            {
+                mbedtls_printf( "  fd %d: handshake done, %s\n", fd,
+                        mbedtls_ssl_get_ciphersuite( &conn->ssl ) );
+                conn->state = CONN_READ_REQUEST;
+                continue;
+            }
+            break;
+
+        case CONN_READ_REQUEST:
+            ret = mbedtls_ssl_read( &conn->ssl, conn->buf,
+                                    sizeof( conn->buf ) - 1 );
+            if( ret > 0 )
+            {
+                conn->buf[ret] = '\0';
+                mbedtls_printf( "  fd %d: %d bytes read\n", fd, ret );
+
+                conn->len = mbedtls_snprintf( (char *) conn->buf,
+                                sizeof( conn->buf ), HTTP_RESPONSE,
+                                mbedtls_ssl_get_ciphersuite( &conn->ssl ) );
+                conn->off = 0;
+                conn->state = CONN_WRITE_RESPONSE;
+                continue;
+            }
+            if( ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY )
+            {
+                mbedtls_printf( "  fd %d: connection closed by peer\n", fd );
+                conn_close( epfd, conn );
+                return( 1 );
+            }
+            break;
+
+        case CONN_WRITE_RESPONSE:
+            ret = mbedtls_ssl_write( &conn->ssl, conn->buf + conn->off,
+                                     conn->len - conn->off );
+            if( ret >= 0 )
+            {
+                conn->off += ret;
+                if( conn->off < conn->len )
+                    continue;
+
+                mbedtls_printf( "  fd %d: %d bytes written\n",
+                                fd, (int) conn->len );
+                conn->state = CONN_CLOSING;
+                continue;
+            }
+            break;
+
+        case CONN_CLOSING:
+        default:
+            ret = mbedtls_ssl_close_notify( &conn->ssl );
+            if( ret == 0 )
+            {
+                mbedtls_printf( "  fd %d: closed\n", fd );
+                conn_close( epfd, conn );
+                return( 1 );
+            }
+            break;
+        }
+
+        if( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+            ret == MBEDTLS_ERR_SSL_WANT_WRITE )
+        {
+            if( conn_rearm( epfd, conn,
+                            ret == MBEDTLS_ERR_SSL_WANT_WRITE ) != 0 )
+            {
+                mbedtls_printf( "  fd %d: epoll_ctl failed\n", fd );
+                conn_close( epfd, conn );
+                return( 1 );
+            }
+            return( 0 );
+        }
+
+        mbedtls_printf( "  fd %d: failed in state %d: -0x%04x\n",
+                        fd, conn->state, -ret );
+        conn_close( epfd, conn );
+        return( 1 );
+    }
+}
+
+/*
+ * Accept as many pending connections as the listening socket holds
+ */
+static void accept_pending( int epfd, mbedtls_net_context *listen_fd,
+                            const mbedtls_ssl_config *conf )
+{
+    int ret;
+    ssl_conn *conn;
+    struct epoll_event ev;
+
+    while( 1 )
+    {
+        if( ( conn = mbedtls_calloc( 1, sizeof( ssl_conn ) ) ) == NULL )
+        {
+            mbedtls_printf( "  failed: alloc of connection state\n" );
+            return;
+        }
+
+        mbedtls_net_init( &conn->net );
+        mbedtls_ssl_init( &conn->ssl );
+
+        ret = mbedtls_net_accept( listen_fd, &conn->net, NULL, 0, NULL );
+        if( ret == MBEDTLS_ERR_SSL_WANT_READ )
+        {
+            /* No more pending connections */
+            mbedtls_free( conn );
+            return;
+        }
+        if( ret != 0 )
+        {
+            mbedtls_printf( "  failed: mbedtls_net_accept returned -0x%04x\n",
+                            -ret );
+            mbedtls_free( conn );
+            return;
+        }
+
+        if( ( ret = mbedtls_net_set_nonblock( &conn->net ) ) != 0 ||
+            ( ret = mbedtls_ssl_setup( &conn->ssl, conf ) ) != 0 )
+        {
+            mbedtls_printf( "  failed: connection setup returned -0x%04x\n",
+                            -ret );
+            mbedtls_ssl_free( &conn->ssl );
+            mbedtls_net_free( &conn->net );
+            mbedtls_free( conn );
+            continue;
+        }
+
+        /* For DTLS, a mbedtls_ssl_set_timer_cb() pair would be set here
+         * as well, and the shortest running timer used as the
+         * epoll_wait() timeout; TLS needs no timers */
+        mbedtls_ssl_set_bio( &conn->ssl, &conn->net,
+                             mbedtls_net_send, mbedtls_net_recv, NULL );
+
+        memset( &ev, 0, sizeof( ev ) );
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if( epoll_ctl( epfd, EPOLL_CTL_ADD,
+                       mbedtls_net_fd( &conn->net ), &ev ) != 0 )
+        {
+            mbedtls_printf( "  failed: epoll_ctl on new connection\n" );
+            mbedtls_ssl_free( &conn->ssl );
+            mbedtls_net_free( &conn->net );
+            mbedtls_free( conn );
+            continue;
+        }
+
+        mbedtls_printf( "  fd %d: accepted\n", mbedtls_net_fd( &conn->net ) );
+
+        conn->state = CONN_HANDSHAKE;
+        conn_step( epfd, conn );
+    }
+}
+
+int main( void )
+{
+    int ret, epfd = -1, nev, i;
+    mbedtls_net_context listen_fd;
+    struct epoll_event ev, events[MAX_EVENTS];
+    const char *pers = "ssl_epoll_server";
+
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_ssl_config conf;
+    mbedtls_x509_crt srvcert;
+    mbedtls_pk_context pkey;
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_context cache;
+#endif
+
+    mbedtls_net_init( &listen_fd );
+    mbedtls_ssl_config_init( &conf );
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_init( &cache );
+#endif
+    mbedtls_x509_crt_init( &srvcert );
+    mbedtls_pk_init( &pkey );
+    mbedtls_entropy_init( &entropy );
+    mbedtls_ctr_drbg_init( &ctr_drbg );
+
+#if defined(MBEDTLS_DEBUG_C)
+    mbedtls_debug_set_threshold( DEBUG_LEVEL );
+#endif
+
+    /*
+     * 1. Load the certificates and private RSA key
+     */
+    mbedtls_printf( "\n  . Loading the server cert. and key..." );
+    fflush( stdout );
+
+    ret = mbedtls_x509_crt_parse( &srvcert, (const unsigned char *) mbedtls_test_srv_crt,
+                          mbedtls_test_srv_crt_len );
+    if( ret != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse returned %d\n\n", ret );
+        goto exit;
+    }
+
+    ret = mbedtls_x509_crt_parse( &srvcert, (const unsigned char *) mbedtls_test_cas_pem,
+                          mbedtls_test_cas_pem_len );
+    if( ret != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse returned %d\n\n", ret );
+        goto exit;
+    }
+
+    ret =  mbedtls_pk_parse_key( &pkey, (const unsigned char *) mbedtls_test_srv_key,
+                         mbedtls_test_srv_key_len, NULL, 0 );
+    if( ret != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_pk_parse_key returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n" );
+
+    /*
+     * 2. Setup the listening TCP socket, non-blocking so that accept()
+     *    can be driven by the event loop as well
+     */
+    mbedtls_printf( "  . Bind on https://localhost:4433/ ..." );
+    fflush( stdout );
+
+    if( ( ret = mbedtls_net_bind( &listen_fd, NULL, "4433", MBEDTLS_NET_PROTO_TCP ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_net_bind returned %d\n\n", ret );
+        goto exit;
+    }
+
+    if( ( ret = mbedtls_net_set_nonblock( &listen_fd ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_net_set_nonblock returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n" );
+
+    /*
+     * 3. Seed the RNG
+     */
+    mbedtls_printf( "  . Seeding the random number generator..." );
+    fflush( stdout );
+
+    if( ( ret = mbedtls_ctr_drbg_seed( &ctr_drbg, mbedtls_entropy_func, &entropy,
+                               (const unsigned char *) pers,
+                               strlen( pers ) ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ctr_drbg_seed returned %d\n", ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n" );
+
+    /*
+     * 4. Prepare the shared SSL configuration
+     */
+    mbedtls_printf( "  . Setting up the SSL data...." );
+    fflush( stdout );
+
+    if( ( ret = mbedtls_ssl_config_defaults( &conf,
+                    MBEDTLS_SSL_IS_SERVER,
+                    MBEDTLS_SSL_TRANSPORT_STREAM,
+                    MBEDTLS_SSL_PRESET_DEFAULT ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_config_defaults returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_ssl_conf_rng( &conf, mbedtls_ctr_drbg_random, &ctr_drbg );
+    mbedtls_ssl_conf_dbg( &conf, my_debug, stdout );
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_conf_session_cache( &conf, &cache,
+                                   mbedtls_ssl_cache_get,
+                                   mbedtls_ssl_cache_set );
+#endif
+
+    mbedtls_ssl_conf_ca_chain( &conf, srvcert.next, NULL );
+    if( ( ret = mbedtls_ssl_conf_own_cert( &conf, &srvcert, &pkey ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_conf_own_cert returned %d\n\n", ret );
+        goto exit;
+    }
+
+    /* Done mutating the config: freeze it, so that sharing it with worker
+     * threads (one event loop per core) would be safe without locks */
+    if( ( ret = mbedtls_ssl_config_freeze( &conf ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_config_freeze returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n" );
+
+    /*
+     * 5. Create the epoll instance and register the listening socket
+     */
+    mbedtls_printf( "  . Setting up the event loop..." );
+    fflush( stdout );
+
+    if( ( epfd = epoll_create1( 0 ) ) < 0 )
+    {
+        mbedtls_printf( " failed\n  ! epoll_create1 failed\n\n" );
+        ret = 1;
+        goto exit;
+    }
+
+    memset( &ev, 0, sizeof( ev ) );
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;     /* NULL marks the listening socket */
+    if( epoll_ctl( epfd, EPOLL_CTL_ADD,
+                   mbedtls_net_fd( &listen_fd ), &ev ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! epoll_ctl failed\n\n" );
+        ret = 1;
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n" );
+
+    /*
+     * 6. The event loop: all connections are serviced from this single
+     *    thread, so the cost of a connection is one allocation and one
+     *    descriptor rather than a thread or a process
+     */
+    mbedtls_printf( "  . Waiting for remote connections...\n\n" );
+    fflush( stdout );
+
+    while( 1 )
+    {
+        nev = epoll_wait( epfd, events, MAX_EVENTS, -1 );
+        if( nev < 0 )
+        {
+            mbedtls_printf( "  ! epoll_wait failed\n" );
+            ret = 1;
+            goto exit;
+        }
+
+        for( i = 0; i < nev; i++ )
+        {
+            if( events[i].data.ptr == NULL )
+                accept_pending( epfd, &listen_fd, &conf );
+            else
+                conn_step( epfd, (ssl_conn *) events[i].data.ptr );
+        }
+    }
+
+exit:
+
+#ifdef MBEDTLS_ERROR_C
+    if( ret != 0 )
+    {
+        char error_buf[100];
+        mbedtls_strerror( ret, error_buf, 100 );
+        mbedtls_printf( "Last error was: %d - %s\n\n", ret, error_buf );
+    }
+#endif
+
+    if( epfd >= 0 )
+        close( epfd );
+    mbedtls_net_free( &listen_fd );
+    mbedtls_x509_crt_free( &srvcert );
+    mbedtls_pk_free( &pkey );
+    mbedtls_ssl_config_free( &conf );
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_free( &cache );
+#endif
+    mbedtls_ctr_drbg_free( &ctr_drbg );
+    mbedtls_entropy_free( &entropy );
+
+    return( ret != 0 );
+}
+#endif /* MBEDTLS_BIGNUM_C && MBEDTLS_CERTS_C && MBEDTLS_ENTROPY_C &&
+          MBEDTLS_SSL_TLS_C && MBEDTLS_SSL_SRV_C && MBEDTLS_NET_C &&
+          MBEDTLS_RSA_C && MBEDTLS_CTR_DRBG_C && __linux__ */
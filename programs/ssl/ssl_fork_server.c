@@ -69,6 +69,10 @@ int main( void )
 #include "mbedtls/net.h"
 #include "mbedtls/timing.h"
 
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+#include "mbedtls/ssl_cache_shm.h"
+#endif
+
 #include <string.h>
 #include <signal.h>
 
@@ -106,6 +110,9 @@ int main( void )
     mbedtls_ssl_config conf;
     mbedtls_x509_crt srvcert;
     mbedtls_pk_context pkey;
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_context cache;
+#endif
 
     mbedtls_net_init( &listen_fd );
     mbedtls_net_init( &client_fd );
@@ -115,6 +122,9 @@ int main( void )
     mbedtls_pk_init( &pkey );
     mbedtls_x509_crt_init( &srvcert );
     mbedtls_ctr_drbg_init( &ctr_drbg );
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_init( &cache );
+#endif
 
     signal( SIGCHLD, SIG_IGN );
 
@@ -196,6 +206,22 @@ int main( void )
         goto exit;
     }
 
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    /*
+     * Set up the session cache in an anonymous shared mapping now, so
+     * every forked child shares it and clients resume across workers
+     */
+    if( ( ret = mbedtls_ssl_cache_shm_setup( &cache, NULL, 0 ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_cache_shm_setup returned %d\n\n", ret );
+        goto exit;
+    }
+
+    mbedtls_ssl_conf_session_cache( &conf, &cache,
+                                    mbedtls_ssl_cache_shm_get,
+                                    mbedtls_ssl_cache_shm_set );
+#endif
+
     mbedtls_printf( " ok\n" );
 
     /*
@@ -394,6 +420,9 @@ exit:
     mbedtls_ssl_config_free( &conf );
     mbedtls_ctr_drbg_free( &ctr_drbg );
     mbedtls_entropy_free( &entropy );
+#if defined(MBEDTLS_SSL_CACHE_SHM_C)
+    mbedtls_ssl_cache_shm_free( &cache );
+#endif
 
 #if defined(_WIN32)
     mbedtls_printf( "  Press Enter to exit this program.\n" );
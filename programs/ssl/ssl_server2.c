@@ -111,6 +111,7 @@ int main( void )
 #define DFL_RENEGOTIATE         0
 #define DFL_RENEGO_DELAY        -2
 #define DFL_RENEGO_PERIOD       -1
+#define DFL_REKEY               0
 #define DFL_EXCHANGES           1
 #define DFL_MIN_VERSION         -1
 #define DFL_MAX_VERSION         -1
@@ -118,8 +119,11 @@ int main( void )
 #define DFL_AUTH_MODE           -1
 #define DFL_MFL_CODE            MBEDTLS_SSL_MAX_FRAG_LEN_NONE
 #define DFL_TRUNC_HMAC          -1
+#define DFL_RECORD_PAD          0
 #define DFL_TICKETS             MBEDTLS_SSL_SESSION_TICKETS_ENABLED
 #define DFL_TICKET_TIMEOUT      86400
+#define DFL_TICKET_JITTER       0
+#define DFL_TICKET_REFRESH      0
 #define DFL_CACHE_MAX           -1
 #define DFL_CACHE_TIMEOUT       -1
 #define DFL_SNI                 NULL
@@ -130,7 +134,10 @@ int main( void )
 #define DFL_ANTI_REPLAY         -1
 #define DFL_HS_TO_MIN           0
 #define DFL_HS_TO_MAX           0
+#define DFL_HS_BURST            0
+#define DFL_MTU                 0
 #define DFL_BADMAC_LIMIT        -1
+#define DFL_BADHDR_LIMIT        -1
 #define DFL_EXTENDED_MS         -1
 #define DFL_ETM                 -1
 
@@ -195,7 +202,10 @@ int main( void )
 #if defined(MBEDTLS_SSL_SESSION_TICKETS)
 #define USAGE_TICKETS                                       \
     "    tickets=%%d          default: 1 (enabled)\n"       \
-    "    ticket_timeout=%%d   default: 86400 (one day)\n"
+    "    ticket_timeout=%%d   default: 86400 (one day)\n"   \
+    "    ticket_jitter=%%d    default: 0 (disabled)\n"      \
+    "    ticket_refresh=%%d   default: 0 (disabled)\n"      \
+    "                        renewal window, percent of ticket lifetime\n"
 #else
 #define USAGE_TICKETS ""
 #endif /* MBEDTLS_SSL_SESSION_TICKETS */
@@ -231,6 +241,13 @@ int main( void )
 #define USAGE_TRUNC_HMAC ""
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+#define USAGE_RECORD_PAD \
+    "    record_pad=%%d       default: 0 (minimal CBC padding)\n"
+#else
+#define USAGE_RECORD_PAD ""
+#endif
+
 #if defined(MBEDTLS_SSL_ALPN)
 #define USAGE_ALPN \
     "    alpn=%%s             default: \"\" (disabled)\n"   \
@@ -256,7 +273,8 @@ int main( void )
 
 #if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
 #define USAGE_BADMAC_LIMIT \
-    "    badmac_limit=%%d     default: (library default: disabled)\n"
+    "    badmac_limit=%%d     default: (library default: disabled)\n" \
+    "    badhdr_limit=%%d     default: (library default: disabled)\n"
 #else
 #define USAGE_BADMAC_LIMIT ""
 #endif
@@ -265,7 +283,11 @@ int main( void )
 #define USAGE_DTLS \
     "    dtls=%%d             default: 0 (TLS)\n"                           \
     "    hs_timeout=%%d-%%d    default: (library default: 1000-60000)\n"    \
-    "                        range of DTLS handshake timeouts in millisecs\n"
+    "                        range of DTLS handshake timeouts in millisecs\n" \
+    "    hs_burst=%%d         default: 0 (no limit)\n"                      \
+    "                        max records per retransmitted flight burst\n"  \
+    "    mtu=%%d              default: 0 (unset, no fragmentation)\n"       \
+    "                        path MTU for outgoing handshake fragments\n"
 #else
 #define USAGE_DTLS ""
 #endif
@@ -289,7 +311,8 @@ int main( void )
     "    renegotiation=%%d    default: 0 (disabled)\n"      \
     "    renegotiate=%%d      default: 0 (disabled)\n"      \
     "    renego_delay=%%d     default: -2 (library default)\n" \
-    "    renego_period=%%d    default: (library default)\n"
+    "    renego_period=%%d    default: (library default)\n" \
+    "    rekey=%%d            default: 0 (disabled)\n"
 #else
 #define USAGE_RENEGO ""
 #endif
@@ -319,11 +342,13 @@ int main( void )
     "    allow_legacy=%%d     default: (library default: no)\n"      \
     USAGE_RENEGO                                            \
     "    exchanges=%%d        default: 1\n"                 \
+    "                        -1: throughput mode, sink records and report the rate\n" \
     "\n"                                                    \
     USAGE_TICKETS                                           \
     USAGE_CACHE                                             \
     USAGE_MAX_FRAG_LEN                                      \
     USAGE_TRUNC_HMAC                                        \
+    USAGE_RECORD_PAD                                        \
     USAGE_ALPN                                              \
     USAGE_EMS                                               \
     USAGE_ETM                                               \
@@ -366,6 +391,7 @@ struct options
     int renegotiate;            /* attempt renegotiation?                   */
     int renego_delay;           /* delay before enforcing renegotiation     */
     int renego_period;          /* period for automatic renegotiation       */
+    int rekey;                  /* allow abbreviated rekeying?              */
     int exchanges;              /* number of data exchanges                 */
     int min_version;            /* minimum protocol version accepted        */
     int max_version;            /* maximum protocol version accepted        */
@@ -373,8 +399,11 @@ struct options
     int auth_mode;              /* verify mode for connection               */
     unsigned char mfl_code;     /* code for maximum fragment length         */
     int trunc_hmac;             /* accept truncated hmac?                   */
+    int record_pad;             /* CBC record padding boundary              */
     int tickets;                /* enable / disable session tickets         */
     int ticket_timeout;         /* session ticket lifetime                  */
+    int ticket_jitter;          /* max ticket lifetime jitter               */
+    int ticket_refresh;         /* ticket renewal window, percent           */
     int cache_max;              /* max number of session cache entries      */
     int cache_timeout;          /* expiration delay of session cache entries */
     char *sni;                  /* string describing sni information        */
@@ -387,7 +416,10 @@ struct options
     int anti_replay;            /* Use anti-replay for DTLS? -1 for default */
     uint32_t hs_to_min;         /* Initial value of DTLS handshake timer    */
     uint32_t hs_to_max;         /* Max value of DTLS handshake timer        */
+    unsigned int hs_burst;      /* Max records per retransmission burst     */
+    int mtu;                    /* path MTU for DTLS handshake fragments    */
     int badmac_limit;           /* Limit of records with bad MAC            */
+    int badhdr_limit;           /* Limit of records with bad header         */
 } opt;
 
 static void my_debug( void *ctx, int level,
@@ -908,6 +940,7 @@ int main( int argc, char *argv[] )
     opt.renegotiate         = DFL_RENEGOTIATE;
     opt.renego_delay        = DFL_RENEGO_DELAY;
     opt.renego_period       = DFL_RENEGO_PERIOD;
+    opt.rekey               = DFL_REKEY;
     opt.exchanges           = DFL_EXCHANGES;
     opt.min_version         = DFL_MIN_VERSION;
     opt.max_version         = DFL_MAX_VERSION;
@@ -915,8 +948,11 @@ int main( int argc, char *argv[] )
     opt.auth_mode           = DFL_AUTH_MODE;
     opt.mfl_code            = DFL_MFL_CODE;
     opt.trunc_hmac          = DFL_TRUNC_HMAC;
+    opt.record_pad          = DFL_RECORD_PAD;
     opt.tickets             = DFL_TICKETS;
     opt.ticket_timeout      = DFL_TICKET_TIMEOUT;
+    opt.ticket_jitter       = DFL_TICKET_JITTER;
+    opt.ticket_refresh      = DFL_TICKET_REFRESH;
     opt.cache_max           = DFL_CACHE_MAX;
     opt.cache_timeout       = DFL_CACHE_TIMEOUT;
     opt.sni                 = DFL_SNI;
@@ -927,7 +963,10 @@ int main( int argc, char *argv[] )
     opt.anti_replay         = DFL_ANTI_REPLAY;
     opt.hs_to_min           = DFL_HS_TO_MIN;
     opt.hs_to_max           = DFL_HS_TO_MAX;
+    opt.hs_burst            = DFL_HS_BURST;
+    opt.mtu                 = DFL_MTU;
     opt.badmac_limit        = DFL_BADMAC_LIMIT;
+    opt.badhdr_limit        = DFL_BADHDR_LIMIT;
     opt.extended_ms         = DFL_EXTENDED_MS;
     opt.etm                 = DFL_ETM;
 
@@ -1030,10 +1069,16 @@ int main( int argc, char *argv[] )
             if( opt.renego_period < 2 || opt.renego_period > 255 )
                 goto usage;
         }
+        else if( strcmp( p, "rekey" ) == 0 )
+        {
+            opt.rekey = atoi( q );
+            if( opt.rekey < 0 || opt.rekey > 1 )
+                goto usage;
+        }
         else if( strcmp( p, "exchanges" ) == 0 )
         {
             opt.exchanges = atoi( q );
-            if( opt.exchanges < 0 )
+            if( opt.exchanges < -1 )
                 goto usage;
         }
         else if( strcmp( p, "min_version" ) == 0 )
@@ -1143,6 +1188,12 @@ int main( int argc, char *argv[] )
                 default: goto usage;
             }
         }
+        else if( strcmp( p, "record_pad" ) == 0 )
+        {
+            opt.record_pad = atoi( q );
+            if( opt.record_pad < 0 || opt.record_pad > 256 )
+                goto usage;
+        }
         else if( strcmp( p, "extended_ms" ) == 0 )
         {
             switch( atoi( q ) )
@@ -1167,6 +1218,18 @@ int main( int argc, char *argv[] )
             if( opt.tickets < 0 || opt.tickets > 1 )
                 goto usage;
         }
+        else if( strcmp( p, "ticket_jitter" ) == 0 )
+        {
+            opt.ticket_jitter = atoi( q );
+            if( opt.ticket_jitter < 0 )
+                goto usage;
+        }
+        else if( strcmp( p, "ticket_refresh" ) == 0 )
+        {
+            opt.ticket_refresh = atoi( q );
+            if( opt.ticket_refresh < 0 || opt.ticket_refresh > 100 )
+                goto usage;
+        }
         else if( strcmp( p, "ticket_timeout" ) == 0 )
         {
             opt.ticket_timeout = atoi( q );
@@ -1203,6 +1266,12 @@ int main( int argc, char *argv[] )
             if( opt.badmac_limit < 0 )
                 goto usage;
         }
+        else if( strcmp( p, "badhdr_limit" ) == 0 )
+        {
+            opt.badhdr_limit = atoi( q );
+            if( opt.badhdr_limit < 0 )
+                goto usage;
+        }
         else if( strcmp( p, "hs_timeout" ) == 0 )
         {
             if( ( p = strchr( q, '-' ) ) == NULL )
@@ -1213,6 +1282,18 @@ int main( int argc, char *argv[] )
             if( opt.hs_to_min == 0 || opt.hs_to_max < opt.hs_to_min )
                 goto usage;
         }
+        else if( strcmp( p, "hs_burst" ) == 0 )
+        {
+            if( atoi( q ) < 0 )
+                goto usage;
+            opt.hs_burst = (unsigned int) atoi( q );
+        }
+        else if( strcmp( p, "mtu" ) == 0 )
+        {
+            opt.mtu = atoi( q );
+            if( opt.mtu < 0 || opt.mtu > 0xFFFF )
+                goto usage;
+        }
         else if( strcmp( p, "sni" ) == 0 )
         {
             opt.sni = q;
@@ -1599,6 +1680,9 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( opt.hs_to_min != DFL_HS_TO_MIN || opt.hs_to_max != DFL_HS_TO_MAX )
         mbedtls_ssl_conf_handshake_timeout( &conf, opt.hs_to_min, opt.hs_to_max );
+
+    if( opt.hs_burst != DFL_HS_BURST )
+        mbedtls_ssl_conf_handshake_burst( &conf, opt.hs_burst );
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
 
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
@@ -1614,6 +1698,11 @@ int main( int argc, char *argv[] )
         mbedtls_ssl_conf_truncated_hmac( &conf, opt.trunc_hmac );
 #endif
 
+#if defined(MBEDTLS_SSL_RECORD_PADDING)
+    if( opt.record_pad != DFL_RECORD_PAD )
+        mbedtls_ssl_conf_record_pad( &conf, opt.record_pad );
+#endif
+
 #if defined(MBEDTLS_SSL_EXTENDED_MASTER_SECRET)
     if( opt.extended_ms != DFL_EXTENDED_MS )
         mbedtls_ssl_conf_extended_master_secret( &conf, opt.extended_ms );
@@ -1660,6 +1749,14 @@ int main( int argc, char *argv[] )
             goto exit;
         }
 
+        if( opt.ticket_jitter != DFL_TICKET_JITTER ||
+            opt.ticket_refresh != DFL_TICKET_REFRESH )
+        {
+            mbedtls_ssl_ticket_conf_refresh( &ticket_ctx,
+                    opt.ticket_jitter,
+                    (unsigned char) opt.ticket_refresh );
+        }
+
         mbedtls_ssl_conf_session_tickets_cb( &conf,
                 mbedtls_ssl_ticket_write,
                 mbedtls_ssl_ticket_parse,
@@ -1704,6 +1801,9 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_SSL_DTLS_BADMAC_LIMIT)
         if( opt.badmac_limit != DFL_BADMAC_LIMIT )
             mbedtls_ssl_conf_dtls_badmac_limit( &conf, opt.badmac_limit );
+
+        if( opt.badhdr_limit != DFL_BADHDR_LIMIT )
+            mbedtls_ssl_conf_dtls_badhdr_limit( &conf, opt.badhdr_limit );
 #endif
     }
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
@@ -1745,6 +1845,9 @@ int main( int argc, char *argv[] )
         renego_period[7] = opt.renego_period;
         mbedtls_ssl_conf_renegotiation_period( &conf, renego_period );
     }
+
+    if( opt.rekey )
+        mbedtls_ssl_conf_rekey( &conf, MBEDTLS_SSL_REKEY_ENABLED );
 #endif
 
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
@@ -1816,6 +1919,11 @@ int main( int argc, char *argv[] )
         goto exit;
     }
 
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( opt.mtu != DFL_MTU )
+        mbedtls_ssl_set_mtu( &ssl, (uint16_t) opt.mtu );
+#endif
+
     if( opt.nbio == 2 )
         mbedtls_ssl_set_bio( &ssl, &client_fd, my_send, my_recv, NULL );
     else
@@ -1988,6 +2096,78 @@ reset:
     if( opt.exchanges == 0 )
         goto close_notify;
 
+    /*
+     * 5b. Throughput mode: sink the client's records until it closes
+     *     the connection and report the record-layer rate
+     */
+    if( opt.exchanges == -1 )
+    {
+        unsigned long elapsed_ms;
+        unsigned long records = 0;
+        unsigned long long total_bytes = 0, rate, avg_us;
+        struct mbedtls_timing_hr_time total_timer;
+        unsigned char *sink_buf;
+        size_t sink_len = MBEDTLS_SSL_MAX_CONTENT_LEN;
+
+        mbedtls_printf( "  . Sinking client records..." );
+        fflush( stdout );
+
+        /* Use a full-size buffer so one read drains one record */
+        if( ( sink_buf = mbedtls_calloc( 1, sink_len ) ) == NULL )
+        {
+            sink_buf = buf;
+            sink_len = sizeof( buf ) - 1;
+        }
+
+        (void) mbedtls_timing_get_timer( &total_timer, 1 );
+
+        for( ; ; )
+        {
+            ret = mbedtls_ssl_read( &ssl, sink_buf, sink_len );
+
+            if( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+                ret == MBEDTLS_ERR_SSL_WANT_WRITE )
+                continue;
+
+            if( ret <= 0 )
+                break;
+
+            /* Don't count the idle time before the first record */
+            if( records == 0 )
+                (void) mbedtls_timing_get_timer( &total_timer, 1 );
+
+            records++;
+            total_bytes += (unsigned long long) ret;
+        }
+
+        elapsed_ms = mbedtls_timing_get_timer( &total_timer, 0 );
+
+        if( sink_buf != buf )
+            mbedtls_free( sink_buf );
+
+        mbedtls_printf( " done\n" );
+        mbedtls_printf( "    %lu records, %llu bytes in %lu.%03lu s\n",
+                        records, total_bytes,
+                        elapsed_ms / 1000, elapsed_ms % 1000 );
+
+        if( records > 0 && elapsed_ms > 0 )
+        {
+            /* rate in hundredths of MB/s, latency in microseconds */
+            rate = total_bytes / ( (unsigned long long) elapsed_ms * 10 );
+            avg_us = (unsigned long long) elapsed_ms * 1000 / records;
+
+            mbedtls_printf( "    %llu.%02llu MB/s, avg %llu.%03llu ms/record\n",
+                            rate / 100, rate % 100,
+                            avg_us / 1000, avg_us % 1000 );
+        }
+
+        if( ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY )
+            goto close_notify;
+
+        mbedtls_printf( " mbedtls_ssl_read returned -0x%x\n", -ret );
+        goto reset;
+    }
+
     exchanges_left = opt.exchanges;
 data_exchange:
     /*
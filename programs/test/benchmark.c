@@ -59,6 +59,7 @@ int main( void )
 #include "mbedtls/des.h"
 #include "mbedtls/aes.h"
 #include "mbedtls/blowfish.h"
+#include "mbedtls/xtea.h"
 #include "mbedtls/camellia.h"
 #include "mbedtls/gcm.h"
 #include "mbedtls/ccm.h"
@@ -71,6 +72,16 @@ int main( void )
 #include "mbedtls/ecdh.h"
 #include "mbedtls/error.h"
 
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_SSL_SRV_C) && \
+    defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
+#include "mbedtls/ssl.h"
+#define BENCHMARK_SSL
+#endif
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+#include <pthread.h>
+#endif
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
 #include "mbedtls/memory_buffer_alloc.h"
 #endif
@@ -84,8 +95,10 @@ int main( void )
 
 /*
  * Size to use for the alloc buffer if MEMORY_BUFFER_ALLOC_C is defined.
+ * Needs room for the two in-process SSL contexts (four full-size record
+ * buffers) of the record layer benchmark on top of the primitives.
  */
-#define HEAP_SIZE       (1u << 16)  // 64k
+#define HEAP_SIZE       (1u << 18)  // 256k
 
 #define BUFSIZE         1024
 #define HEADER_FORMAT   "  %-24s :  "
@@ -94,8 +107,18 @@ int main( void )
 #define OPTIONS                                                         \
     "md4, md5, ripemd160, sha1, sha256, sha512,\n"                      \
     "arc4, des3, des, aes_cbc, aes_gcm, aes_ccm, camellia, blowfish,\n" \
+    "xtea,\n"                                                           \
     "havege, ctr_drbg, hmac_drbg\n"                                     \
-    "rsa, dhm, ecdsa, ecdh.\n"
+    "rsa, dhm, ecdsa, ecdh, ssl_write.\n"                               \
+    "Modifiers: csv (machine-readable output),\n"                       \
+    "threads=<n> (multi-threaded scaling runs, needs "                  \
+    "MBEDTLS_THREADING_PTHREAD).\n"
+
+/*
+ * Output and scaling modifiers, settable from the command line
+ */
+static int csv_output = 0;
+static int num_threads = 1;
 
 #if defined(MBEDTLS_ERROR_C)
 #define PRINT_ERROR                                                     \
@@ -109,9 +132,13 @@ int main( void )
 #define TIME_AND_TSC( TITLE, CODE )                                     \
 do {                                                                    \
     unsigned long i, j, tsc;                                            \
+    MEMORY_MEASURE_INIT;                                                \
                                                                         \
-    mbedtls_printf( HEADER_FORMAT, TITLE );                            \
-    fflush( stdout );                                                   \
+    if( ! csv_output )                                                  \
+    {                                                                   \
+        mbedtls_printf( HEADER_FORMAT, TITLE );                        \
+        fflush( stdout );                                               \
+    }                                                                   \
                                                                         \
     mbedtls_set_alarm( 1 );                                                     \
     for( i = 1; ! mbedtls_timing_alarmed; i++ )                                        \
@@ -125,9 +152,18 @@ do {                                                                    \
         CODE;                                                           \
     }                                                                   \
                                                                         \
-    mbedtls_printf( "%9lu Kb/s,  %9lu cycles/byte\n",                  \
+    if( csv_output )                                                    \
+        mbedtls_printf( "%s,throughput,1,%lu,%lu\n", TITLE,            \
                      i * BUFSIZE / 1024,                                \
                      ( mbedtls_timing_hardclock() - tsc ) / ( j * BUFSIZE ) );         \
+    else                                                                \
+    {                                                                   \
+        mbedtls_printf( "%9lu Kb/s,  %9lu cycles/byte",                \
+                     i * BUFSIZE / 1024,                                \
+                     ( mbedtls_timing_hardclock() - tsc ) / ( j * BUFSIZE ) );         \
+        MEMORY_MEASURE_PRINT( 10 );                                     \
+        mbedtls_printf( "\n" );                                        \
+    }                                                                   \
 } while( 0 )
 
 #if defined(MBEDTLS_ERROR_C)
@@ -148,42 +184,111 @@ do {                                                                    \
     mbedtls_memory_buffer_alloc_max_reset( );
 
 #define MEMORY_MEASURE_PRINT( title_len )                               \
-    mbedtls_memory_buffer_alloc_max_get( &max_used, &max_blocks );              \
-    for( i = 12 - title_len; i != 0; i-- ) mbedtls_printf( " " );      \
-    max_used -= prv_used;                                               \
-    max_blocks -= prv_blocks;                                           \
-    max_bytes = max_used + MEM_BLOCK_OVERHEAD * max_blocks;             \
-    mbedtls_printf( "%6u heap bytes", (unsigned) max_bytes );
+    do {                                                                \
+        size_t mm_pad;                                                  \
+        mbedtls_memory_buffer_alloc_max_get( &max_used, &max_blocks );          \
+        for( mm_pad = 12 - ( title_len ); mm_pad != 0; mm_pad-- )       \
+            mbedtls_printf( " " );                                     \
+        /* An operation working entirely in place never grows the heap
+         * past what was live at INIT time, so the peak can come out
+         * below the baseline: report that as zero, not underflow */    \
+        max_used = max_used > prv_used ? max_used - prv_used : 0;       \
+        max_blocks = max_blocks > prv_blocks ? max_blocks - prv_blocks : 0; \
+        max_bytes = max_used + MEM_BLOCK_OVERHEAD * max_blocks;         \
+        mbedtls_printf( "%6u heap bytes", (unsigned) max_bytes );      \
+    } while( 0 )
 
 #else
 #define MEMORY_MEASURE_INIT
 #define MEMORY_MEASURE_PRINT( title_len )
 #endif
 
+/*
+ * Per-operation latency samples for the percentile report. The public-key
+ * benchmarks record one hardclock() delta per operation; at their rates a
+ * 3-second alarm window stays well within the buffer, and if it does not
+ * the remaining operations simply go unsampled.
+ */
+#define MAX_SAMPLES     16384
+
+static unsigned long lat_samples[MAX_SAMPLES];
+static size_t lat_count;
+
+static void lat_record( unsigned long cycles )
+{
+    if( lat_count < MAX_SAMPLES )
+        lat_samples[lat_count] = cycles;
+    lat_count++;
+}
+
+static int lat_cmp( const void *a, const void *b )
+{
+    unsigned long la = *(const unsigned long *) a;
+    unsigned long lb = *(const unsigned long *) b;
+
+    return( la < lb ? -1 : la > lb );
+}
+
+/* Return the q-per-mille latency percentile, in hardclock() units */
+static unsigned long lat_percentile( unsigned q )
+{
+    size_t n = lat_count < MAX_SAMPLES ? lat_count : MAX_SAMPLES;
+
+    if( n == 0 )
+        return( 0 );
+
+    return( lat_samples[ ( n - 1 ) * q / 1000 ] );
+}
+
+static void lat_sort( void )
+{
+    size_t n = lat_count < MAX_SAMPLES ? lat_count : MAX_SAMPLES;
+
+    qsort( lat_samples, n, sizeof( lat_samples[0] ), lat_cmp );
+}
+
 #define TIME_PUBLIC( TITLE, TYPE, CODE )                                \
 do {                                                                    \
     unsigned long i;                                                    \
+    unsigned long lat_tsc;                                              \
     int ret;                                                            \
     MEMORY_MEASURE_INIT;                                                \
                                                                         \
-    mbedtls_printf( HEADER_FORMAT, TITLE );                            \
-    fflush( stdout );                                                   \
+    if( ! csv_output )                                                  \
+    {                                                                   \
+        mbedtls_printf( HEADER_FORMAT, TITLE );                        \
+        fflush( stdout );                                               \
+    }                                                                   \
     mbedtls_set_alarm( 3 );                                                     \
                                                                         \
     ret = 0;                                                            \
+    lat_count = 0;                                                      \
     for( i = 1; ! mbedtls_timing_alarmed && ! ret ; i++ )                              \
     {                                                                   \
+        lat_tsc = mbedtls_timing_hardclock();                           \
         CODE;                                                           \
+        lat_record( mbedtls_timing_hardclock() - lat_tsc );             \
     }                                                                   \
                                                                         \
     if( ret != 0 )                                                      \
     {                                                                   \
         PRINT_ERROR;                                                    \
     }                                                                   \
+    else if( csv_output )                                               \
+    {                                                                   \
+        lat_sort();                                                     \
+        mbedtls_printf( "%s," TYPE ",1,%lu,%lu,%lu,%lu\n", TITLE,      \
+                        i / 3, lat_percentile( 500 ),                   \
+                        lat_percentile( 990 ), lat_percentile( 999 ) ); \
+    }                                                                   \
     else                                                                \
     {                                                                   \
+        lat_sort();                                                     \
         mbedtls_printf( "%6lu " TYPE "/s", i / 3 );                    \
         MEMORY_MEASURE_PRINT( sizeof( TYPE ) + 1 );                     \
+        mbedtls_printf( "  p50/p99/p999 %lu/%lu/%lu cycles",           \
+                        lat_percentile( 500 ), lat_percentile( 990 ),   \
+                        lat_percentile( 999 ) );                        \
         mbedtls_printf( "\n" );                                        \
     }                                                                   \
 } while( 0 )
@@ -211,6 +316,114 @@ static int myrand( void *rng_state, unsigned char *output, size_t len )
     return( 0 );
 }
 
+#if defined(MBEDTLS_THREADING_PTHREAD)
+/*
+ * Multi-threaded scaling runs: hammer one shared context from N threads
+ * and report the aggregate rate next to the single-threaded one, so
+ * contention on the context mutexes shows up as a scaling loss rather
+ * than going unnoticed until deployment.
+ */
+#define MAX_BENCH_THREADS   64
+
+typedef struct
+{
+    int (*op)( void *ctx, unsigned char *tbuf );
+    void *ctx;
+    unsigned long ops;
+    int ret;
+} bench_thread_arg;
+
+static void *bench_thread_main( void *v )
+{
+    bench_thread_arg *t = (bench_thread_arg *) v;
+    unsigned char tbuf[BUFSIZE];
+
+    memset( tbuf, 0xAA, sizeof( tbuf ) );
+
+    while( ! mbedtls_timing_alarmed && t->ret == 0 )
+    {
+        t->ret = t->op( t->ctx, tbuf );
+        t->ops++;
+    }
+
+    return( NULL );
+}
+
+static void time_threaded( const char *title, const char *type,
+                           int (*op)( void *ctx, unsigned char *tbuf ),
+                           void *ctx )
+{
+    pthread_t tid[MAX_BENCH_THREADS];
+    bench_thread_arg arg[MAX_BENCH_THREADS];
+    char tt_title[TITLE_LEN + 16];
+    unsigned long total_ops = 0;
+    int n, ret = 0;
+    unsigned char tmp[200];
+
+    if( num_threads < 2 )
+        return;
+
+    if( num_threads > MAX_BENCH_THREADS )
+        num_threads = MAX_BENCH_THREADS;
+
+    mbedtls_snprintf( tt_title, sizeof( tt_title ), "%s x%d",
+                      title, num_threads );
+
+    if( ! csv_output )
+    {
+        mbedtls_printf( HEADER_FORMAT, tt_title );
+        fflush( stdout );
+    }
+
+    mbedtls_set_alarm( 3 );
+
+    for( n = 0; n < num_threads; n++ )
+    {
+        arg[n].op = op;
+        arg[n].ctx = ctx;
+        arg[n].ops = 0;
+        arg[n].ret = 0;
+
+        if( pthread_create( &tid[n], NULL, bench_thread_main, &arg[n] ) != 0 )
+        {
+            mbedtls_printf( "FAILED: pthread_create\n" );
+            mbedtls_exit( 1 );
+        }
+    }
+
+    for( n = 0; n < num_threads; n++ )
+    {
+        pthread_join( tid[n], NULL );
+        total_ops += arg[n].ops;
+        if( arg[n].ret != 0 )
+            ret = arg[n].ret;
+    }
+
+    if( ret != 0 )
+    {
+        PRINT_ERROR;
+    }
+    else if( csv_output )
+        mbedtls_printf( "%s,%s,%d,%lu\n", title, type, num_threads,
+                        total_ops / 3 );
+    else
+        mbedtls_printf( "%6lu %s/s\n", total_ops / 3, type );
+}
+
+static int bench_rsa_private_op( void *ctx, unsigned char *tbuf )
+{
+    tbuf[0] = 0;
+    return( mbedtls_rsa_private( (mbedtls_rsa_context *) ctx,
+                                 myrand, NULL, tbuf, tbuf ) );
+}
+
+static int bench_ctr_drbg_op( void *ctx, unsigned char *tbuf )
+{
+    return( mbedtls_ctr_drbg_random( (mbedtls_ctr_drbg_context *) ctx,
+                                     tbuf, BUFSIZE ) );
+}
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
 /*
  * Clear some memory that was used to prepare the context
  */
@@ -233,11 +446,186 @@ void ecp_clear_precomputed( mbedtls_ecp_group *grp )
 
 unsigned char buf[BUFSIZE];
 
+#if defined(BENCHMARK_SSL)
+/*
+ * End-to-end record layer benchmark: a PSK handshake between two contexts
+ * in this process, connected by in-memory BIOs, then mbedtls_ssl_write()
+ * with mbedtls_ssl_read() draining on the other side. This times the full
+ * record path (MAC, encrypt, header handling) rather than the bare cipher.
+ */
+#define SSL_BENCH_BIO_SIZE  ( MBEDTLS_SSL_MAX_CONTENT_LEN + 2048 )
+
+typedef struct
+{
+    unsigned char data[SSL_BENCH_BIO_SIZE];
+    size_t len;
+} ssl_bench_bio;
+
+/* One endpoint's view of the two directional buffers: it sends into out
+ * and reads from in, the other endpoint sees them swapped */
+typedef struct
+{
+    ssl_bench_bio *in;
+    ssl_bench_bio *out;
+} ssl_bench_ep;
+
+static int ssl_bench_send( void *ctx, const unsigned char *b, size_t len )
+{
+    ssl_bench_bio *bio = ( (ssl_bench_ep *) ctx )->out;
+
+    if( len > sizeof( bio->data ) - bio->len )
+    {
+        if( bio->len == sizeof( bio->data ) )
+            return( MBEDTLS_ERR_SSL_WANT_WRITE );
+        len = sizeof( bio->data ) - bio->len;
+    }
+
+    memcpy( bio->data + bio->len, b, len );
+    bio->len += len;
+
+    return( (int) len );
+}
+
+static int ssl_bench_recv( void *ctx, unsigned char *b, size_t len )
+{
+    ssl_bench_bio *bio = ( (ssl_bench_ep *) ctx )->in;
+
+    if( bio->len == 0 )
+        return( MBEDTLS_ERR_SSL_WANT_READ );
+
+    if( len > bio->len )
+        len = bio->len;
+
+    memcpy( b, bio->data, len );
+    bio->len -= len;
+    memmove( bio->data, bio->data + len, bio->len );
+
+    return( (int) len );
+}
+
+static void ssl_record_benchmark( void )
+{
+    mbedtls_ssl_context cli, srv;
+    mbedtls_ssl_config conf_cli, conf_srv;
+    ssl_bench_bio cli_to_srv, srv_to_cli;
+    ssl_bench_ep cli_ep, srv_ep;
+    const unsigned char psk[32] = { 0x2A };
+    unsigned char rbuf[BUFSIZE];
+    int ret = 0;
+    unsigned rounds;
+    MEMORY_MEASURE_INIT;
+
+    mbedtls_ssl_init( &cli );
+    mbedtls_ssl_init( &srv );
+    mbedtls_ssl_config_init( &conf_cli );
+    mbedtls_ssl_config_init( &conf_srv );
+
+    memset( &cli_to_srv, 0, sizeof( cli_to_srv ) );
+    memset( &srv_to_cli, 0, sizeof( srv_to_cli ) );
+
+    if( mbedtls_ssl_config_defaults( &conf_cli, MBEDTLS_SSL_IS_CLIENT,
+                                     MBEDTLS_SSL_TRANSPORT_STREAM,
+                                     MBEDTLS_SSL_PRESET_DEFAULT ) != 0 ||
+        mbedtls_ssl_config_defaults( &conf_srv, MBEDTLS_SSL_IS_SERVER,
+                                     MBEDTLS_SSL_TRANSPORT_STREAM,
+                                     MBEDTLS_SSL_PRESET_DEFAULT ) != 0 )
+    {
+        mbedtls_printf( "SSL record write           : setup FAILED\n" );
+        goto exit;
+    }
+
+    mbedtls_ssl_conf_rng( &conf_cli, myrand, NULL );
+    mbedtls_ssl_conf_rng( &conf_srv, myrand, NULL );
+    mbedtls_ssl_conf_authmode( &conf_cli, MBEDTLS_SSL_VERIFY_NONE );
+
+    if( mbedtls_ssl_conf_psk( &conf_cli, psk, sizeof( psk ),
+                              (const unsigned char *) "bench", 5 ) != 0 ||
+        mbedtls_ssl_conf_psk( &conf_srv, psk, sizeof( psk ),
+                              (const unsigned char *) "bench", 5 ) != 0 ||
+        mbedtls_ssl_setup( &cli, &conf_cli ) != 0 ||
+        mbedtls_ssl_setup( &srv, &conf_srv ) != 0 )
+    {
+        mbedtls_printf( "SSL record write           : setup FAILED\n" );
+        goto exit;
+    }
+
+    cli_ep.in = &srv_to_cli; cli_ep.out = &cli_to_srv;
+    srv_ep.in = &cli_to_srv; srv_ep.out = &srv_to_cli;
+
+    mbedtls_ssl_set_bio( &cli, &cli_ep, ssl_bench_send,
+                         ssl_bench_recv, NULL );
+    mbedtls_ssl_set_bio( &srv, &srv_ep, ssl_bench_send,
+                         ssl_bench_recv, NULL );
+
+    for( rounds = 0; rounds < 4096; rounds++ )
+    {
+        if( cli.state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+            srv.state == MBEDTLS_SSL_HANDSHAKE_OVER )
+            break;
+
+        if( cli.state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            ret = mbedtls_ssl_handshake( &cli );
+            if( ret != 0 && ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+                break;
+        }
+
+        if( srv.state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            ret = mbedtls_ssl_handshake( &srv );
+            if( ret != 0 && ret != MBEDTLS_ERR_SSL_WANT_READ &&
+                ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+                break;
+        }
+
+        ret = 0;
+    }
+
+    if( ret != 0 || cli.state != MBEDTLS_SSL_HANDSHAKE_OVER ||
+        srv.state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        mbedtls_printf( "SSL record write           : "
+                        "handshake FAILED: -0x%04x\n", -ret );
+        goto exit;
+    }
+
+#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) && defined(MBEDTLS_MEMORY_DEBUG)
+    /*
+     * Peak heap from context init through handshake completion: the
+     * total footprint of establishing one connection, which is the
+     * number that matters for the embedded profiles in configs/.
+     */
+    if( ! csv_output )
+    {
+        mbedtls_printf( HEADER_FORMAT, "SSL PSK handshake" );
+        MEMORY_MEASURE_PRINT( 12 );
+        mbedtls_printf( " peak\n" );
+    }
+#endif
+
+    TIME_AND_TSC( "SSL record write",
+        if( mbedtls_ssl_write( &cli, buf, BUFSIZE ) != BUFSIZE ||
+            mbedtls_ssl_read( &srv, rbuf, sizeof( rbuf ) ) != BUFSIZE )
+        {
+            mbedtls_printf( "SSL record write FAILED\n" );
+            mbedtls_exit( 1 );
+        } );
+
+exit:
+    mbedtls_ssl_free( &cli );
+    mbedtls_ssl_free( &srv );
+    mbedtls_ssl_config_free( &conf_cli );
+    mbedtls_ssl_config_free( &conf_srv );
+}
+#endif /* BENCHMARK_SSL */
+
 typedef struct {
     char md4, md5, ripemd160, sha1, sha256, sha512,
          arc4, des3, des, aes_cbc, aes_gcm, aes_ccm, camellia, blowfish,
+         xtea,
          havege, ctr_drbg, hmac_drbg,
-         rsa, dhm, ecdsa, ecdh;
+         rsa, dhm, ecdsa, ecdh, ssl_write;
 } todo_list;
 
 int main( int argc, char *argv[] )
@@ -250,16 +638,33 @@ int main( int argc, char *argv[] )
     unsigned char alloc_buf[HEAP_SIZE] = { 0 };
 #endif
 
-    if( argc <= 1 )
-    {
-        memset( &todo, 1, sizeof( todo ) );
-    }
-    else
     {
+        int todo_any = 0;
+
         memset( &todo, 0, sizeof( todo ) );
 
         for( i = 1; i < argc; i++ )
         {
+            if( strcmp( argv[i], "csv" ) == 0 )
+            {
+                csv_output = 1;
+                continue;
+            }
+
+            if( strncmp( argv[i], "threads=", 8 ) == 0 )
+            {
+                num_threads = atoi( argv[i] + 8 );
+#if !defined(MBEDTLS_THREADING_PTHREAD)
+                if( num_threads > 1 )
+                    mbedtls_printf( "threads=%d ignored: "
+                            "MBEDTLS_THREADING_PTHREAD not defined\n",
+                            num_threads );
+#endif
+                continue;
+            }
+
+            todo_any = 1;
+
             if( strcmp( argv[i], "md4" ) == 0 )
                 todo.md4 = 1;
             else if( strcmp( argv[i], "md5" ) == 0 )
@@ -288,6 +693,8 @@ int main( int argc, char *argv[] )
                 todo.camellia = 1;
             else if( strcmp( argv[i], "blowfish" ) == 0 )
                 todo.blowfish = 1;
+            else if( strcmp( argv[i], "xtea" ) == 0 )
+                todo.xtea = 1;
             else if( strcmp( argv[i], "havege" ) == 0 )
                 todo.havege = 1;
             else if( strcmp( argv[i], "ctr_drbg" ) == 0 )
@@ -302,15 +709,21 @@ int main( int argc, char *argv[] )
                 todo.ecdsa = 1;
             else if( strcmp( argv[i], "ecdh" ) == 0 )
                 todo.ecdh = 1;
+            else if( strcmp( argv[i], "ssl_write" ) == 0 )
+                todo.ssl_write = 1;
             else
             {
                 mbedtls_printf( "Unrecognized option: %s\n", argv[i] );
                 mbedtls_printf( "Available options: " OPTIONS );
             }
         }
+
+        if( ! todo_any )
+            memset( &todo, 1, sizeof( todo ) );
     }
 
-    mbedtls_printf( "\n" );
+    if( ! csv_output )
+        mbedtls_printf( "\n" );
 
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     mbedtls_memory_buffer_alloc_init( alloc_buf, sizeof( alloc_buf ) );
@@ -496,6 +909,24 @@ int main( int argc, char *argv[] )
     }
 #endif
 
+#if defined(MBEDTLS_XTEA_C) && defined(MBEDTLS_CIPHER_MODE_CBC)
+    if( todo.xtea )
+    {
+        mbedtls_xtea_context xtea;
+        mbedtls_xtea_init( &xtea );
+
+        memset( buf, 0, sizeof( buf ) );
+        memset( tmp, 0, sizeof( tmp ) );
+        mbedtls_xtea_setup( &xtea, tmp );
+
+        TIME_AND_TSC( "XTEA-CBC-128",
+                mbedtls_xtea_crypt_cbc( &xtea, MBEDTLS_XTEA_ENCRYPT, BUFSIZE,
+                    tmp, buf, buf ) );
+
+        mbedtls_xtea_free( &xtea );
+    }
+#endif
+
 #if defined(MBEDTLS_HAVEGE_C)
     if( todo.havege )
     {
@@ -526,6 +957,18 @@ int main( int argc, char *argv[] )
                 if( mbedtls_ctr_drbg_random( &ctr_drbg, buf, BUFSIZE ) != 0 )
                 mbedtls_exit(1) );
         mbedtls_ctr_drbg_free( &ctr_drbg );
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+        if( num_threads > 1 )
+        {
+            mbedtls_ctr_drbg_init( &ctr_drbg );
+            if( mbedtls_ctr_drbg_seed( &ctr_drbg, myrand, NULL, NULL, 0 ) != 0 )
+                mbedtls_exit(1);
+            time_threaded( "CTR_DRBG (NOPR)", "req",
+                           bench_ctr_drbg_op, &ctr_drbg );
+            mbedtls_ctr_drbg_free( &ctr_drbg );
+        }
+#endif
     }
 #endif
 
@@ -601,6 +1044,10 @@ int main( int argc, char *argv[] )
                     buf[0] = 0;
                     ret = mbedtls_rsa_private( &rsa, myrand, NULL, buf, buf ) );
 
+#if defined(MBEDTLS_THREADING_PTHREAD)
+            time_threaded( title, "private", bench_rsa_private_op, &rsa );
+#endif
+
             mbedtls_rsa_free( &rsa );
         }
     }
@@ -808,7 +1255,13 @@ int main( int argc, char *argv[] )
     }
 #endif
 
-    mbedtls_printf( "\n" );
+#if defined(BENCHMARK_SSL)
+    if( todo.ssl_write )
+        ssl_record_benchmark();
+#endif
+
+    if( ! csv_output )
+        mbedtls_printf( "\n" );
 
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     mbedtls_memory_buffer_alloc_free();
@@ -32,6 +32,9 @@
 #include "mbedtls/dhm.h"
 #include "mbedtls/gcm.h"
 #include "mbedtls/ccm.h"
+#include "mbedtls/chacha20.h"
+#include "mbedtls/poly1305.h"
+#include "mbedtls/chachapoly.h"
 #include "mbedtls/md2.h"
 #include "mbedtls/md4.h"
 #include "mbedtls/md5.h"
@@ -200,6 +203,21 @@ int main( int argc, char *argv[] )
         return( ret );
 #endif
 
+#if defined(MBEDTLS_CHACHA20_C)
+    if( ( ret = mbedtls_chacha20_self_test( v ) ) != 0 )
+        return( ret );
+#endif
+
+#if defined(MBEDTLS_POLY1305_C)
+    if( ( ret = mbedtls_poly1305_self_test( v ) ) != 0 )
+        return( ret );
+#endif
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if( ( ret = mbedtls_chachapoly_self_test( v ) ) != 0 )
+        return( ret );
+#endif
+
 #if defined(MBEDTLS_BASE64_C)
     if( ( ret = mbedtls_base64_self_test( v ) ) != 0 )
         return( ret );
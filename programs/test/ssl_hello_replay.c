@@ -0,0 +1,461 @@
+/*
+ *  ClientHello corpus replay harness
+ *
+ *  Copyright (C) 2006-2016, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc     calloc
+#define mbedtls_free       free
+#define mbedtls_printf     printf
+#define mbedtls_snprintf   snprintf
+#endif
+
+#if !defined(MBEDTLS_SSL_TLS_C) || !defined(MBEDTLS_SSL_SRV_C) ||   \
+    !defined(MBEDTLS_TIMING_C) || !defined(MBEDTLS_FS_IO) ||        \
+    !defined(MBEDTLS_ENTROPY_C) || !defined(MBEDTLS_CTR_DRBG_C)
+int main( void )
+{
+    mbedtls_printf("MBEDTLS_SSL_TLS_C and/or MBEDTLS_SSL_SRV_C and/or "
+           "MBEDTLS_TIMING_C and/or MBEDTLS_FS_IO and/or "
+           "MBEDTLS_ENTROPY_C and/or MBEDTLS_CTR_DRBG_C not defined.\n");
+    return( 0 );
+}
+#else
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/error.h"
+#include "mbedtls/timing.h"
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/certs.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#define DFL_ITERATIONS          1000
+#define MAX_FLIGHT_SIZE         65536
+
+#define USAGE \
+    "\n usage: ssl_hello_replay corpus=<path> [param=<>...]\n"          \
+    "\n acceptable parameters:\n"                                       \
+    "    corpus=%%s           file or directory of raw ClientHello\n"   \
+    "                        flights (TLS record layer bytes)\n"        \
+    "    iterations=%%d       replays per flight, default: 1000\n"      \
+    "\n"
+
+/*
+ * global options
+ */
+static struct options
+{
+    const char *corpus;         /* file or directory of raw flights         */
+    int iterations;             /* how many times to replay each flight     */
+} opt;
+
+/*
+ * Memory BIO: reads are served from the loaded flight, writes (the
+ * ServerHello the stack tries to send back, or fatal alerts) are
+ * swallowed. A short read past the end of the flight shows up as
+ * WANT_READ, which the replay loop treats as a truncated capture.
+ */
+typedef struct
+{
+    const unsigned char *buf;
+    size_t len;
+    size_t off;
+} replay_bio;
+
+static int replay_recv( void *ctx, unsigned char *buf, size_t len )
+{
+    replay_bio *bio = (replay_bio *) ctx;
+
+    if( bio->off >= bio->len )
+        return( MBEDTLS_ERR_SSL_WANT_READ );
+
+    if( len > bio->len - bio->off )
+        len = bio->len - bio->off;
+
+    memcpy( buf, bio->buf + bio->off, len );
+    bio->off += len;
+
+    return( (int) len );
+}
+
+static int replay_send( void *ctx, const unsigned char *buf, size_t len )
+{
+    (void) ctx;
+    (void) buf;
+
+    return( (int) len );
+}
+
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+/*
+ * Counting allocator: forwards to the C library but keeps per-run
+ * call and byte counts, so each flight can report how many heap
+ * allocations a single hello costs.
+ */
+static unsigned long alloc_calls;
+static unsigned long alloc_bytes;
+
+static void *counting_calloc( size_t n, size_t size )
+{
+    alloc_calls++;
+    alloc_bytes += (unsigned long)( n * size );
+
+    return( calloc( n, size ) );
+}
+
+static void counting_free( void *ptr )
+{
+    free( ptr );
+}
+#endif /* MBEDTLS_PLATFORM_MEMORY */
+
+/*
+ * Replay one loaded flight opt.iterations times and print one
+ * result line. Parse outcomes are counted but never fatal: attack
+ * captures are expected to be rejected, and rejecting them fast is
+ * exactly what we want to measure.
+ */
+static void replay_flight( mbedtls_ssl_context *ssl, const char *name,
+                           const unsigned char *flight, size_t flight_len,
+                           unsigned long cycles_per_us,
+                           unsigned long *total_hellos )
+{
+    int ret, i;
+    unsigned long accepted = 0, rejected = 0, truncated = 0;
+    unsigned long cycles = 0, t_start;
+    replay_bio bio;
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+    unsigned long calls_start = alloc_calls;
+    unsigned long bytes_start = alloc_bytes;
+#endif
+
+    for( i = 0; i < opt.iterations; i++ )
+    {
+        if( mbedtls_ssl_session_reset( ssl ) != 0 )
+            return;
+
+        bio.buf = flight;
+        bio.len = flight_len;
+        bio.off = 0;
+        mbedtls_ssl_set_bio( ssl, &bio, replay_send, replay_recv, NULL );
+
+        ret = 0;
+        t_start = mbedtls_timing_hardclock();
+
+        while( ssl->state == MBEDTLS_SSL_HELLO_REQUEST ||
+               ssl->state == MBEDTLS_SSL_CLIENT_HELLO )
+        {
+            ret = mbedtls_ssl_handshake_step( ssl );
+            if( ret != 0 )
+                break;
+        }
+
+        cycles += mbedtls_timing_hardclock() - t_start;
+
+        if( ret == 0 )
+            accepted++;
+        else if( ret == MBEDTLS_ERR_SSL_WANT_READ )
+            truncated++;
+        else
+            rejected++;
+    }
+
+    *total_hellos += (unsigned long) opt.iterations;
+
+    mbedtls_printf( "  %-24s %6lu B  %8lu us/hello "
+                    "(ok %lu, rejected %lu, truncated %lu)",
+                    name, (unsigned long) flight_len,
+                    cycles / opt.iterations / cycles_per_us,
+                    accepted, rejected, truncated );
+
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+    mbedtls_printf( "  %lu allocs, %lu B/hello",
+                    ( alloc_calls - calls_start ) / opt.iterations,
+                    ( alloc_bytes - bytes_start ) / opt.iterations );
+#endif
+
+    mbedtls_printf( "\n" );
+}
+
+static int replay_path( mbedtls_ssl_context *ssl, const char *path,
+                        const char *name, unsigned long cycles_per_us,
+                        unsigned long *total_hellos )
+{
+    FILE *f;
+    size_t n;
+    unsigned char *flight;
+
+    if( ( f = fopen( path, "rb" ) ) == NULL )
+    {
+        mbedtls_printf( "  %-24s skipped (cannot open)\n", name );
+        return( 0 );
+    }
+
+    if( ( flight = mbedtls_calloc( 1, MAX_FLIGHT_SIZE ) ) == NULL )
+    {
+        fclose( f );
+        return( -1 );
+    }
+
+    n = fread( flight, 1, MAX_FLIGHT_SIZE, f );
+    fclose( f );
+
+    if( n == 0 )
+        mbedtls_printf( "  %-24s skipped (empty)\n", name );
+    else
+        replay_flight( ssl, name, flight, n, cycles_per_us, total_hellos );
+
+    mbedtls_free( flight );
+
+    return( 0 );
+}
+
+int main( int argc, char *argv[] )
+{
+    int ret = 0, i;
+    const char *pers = "ssl_hello_replay";
+    char *p, *q;
+    struct stat sb;
+
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_ssl_config conf;
+    mbedtls_ssl_context ssl;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    mbedtls_x509_crt srvcert;
+    mbedtls_pk_context pkey;
+#endif
+
+    unsigned long total_hellos = 0;
+    unsigned long cycles_start, cycles_per_us, elapsed_ms;
+    struct mbedtls_timing_hr_time run_timer;
+
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+    mbedtls_platform_set_calloc_free( counting_calloc, counting_free );
+#endif
+
+    mbedtls_entropy_init( &entropy );
+    mbedtls_ctr_drbg_init( &ctr_drbg );
+    mbedtls_ssl_config_init( &conf );
+    mbedtls_ssl_init( &ssl );
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    mbedtls_x509_crt_init( &srvcert );
+    mbedtls_pk_init( &pkey );
+#endif
+
+    opt.corpus      = NULL;
+    opt.iterations  = DFL_ITERATIONS;
+
+    for( i = 1; i < argc; i++ )
+    {
+        p = argv[i];
+        if( ( q = strchr( p, '=' ) ) == NULL )
+            goto usage;
+        *q++ = '\0';
+
+        if( strcmp( p, "corpus" ) == 0 )
+            opt.corpus = q;
+        else if( strcmp( p, "iterations" ) == 0 )
+        {
+            opt.iterations = atoi( q );
+            if( opt.iterations < 1 || opt.iterations > 1000000 )
+                goto usage;
+        }
+        else
+        {
+usage:
+            mbedtls_printf( USAGE );
+            ret = 1;
+            goto exit;
+        }
+    }
+
+    if( opt.corpus == NULL )
+        goto usage;
+
+    if( ( ret = mbedtls_ctr_drbg_seed( &ctr_drbg, mbedtls_entropy_func,
+                                       &entropy, (const unsigned char *) pers,
+                                       strlen( pers ) ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ctr_drbg_seed returned -0x%x\n",
+                        -ret );
+        goto exit;
+    }
+
+    if( ( ret = mbedtls_ssl_config_defaults( &conf, MBEDTLS_SSL_IS_SERVER,
+                                             MBEDTLS_SSL_TRANSPORT_STREAM,
+                                             MBEDTLS_SSL_PRESET_DEFAULT ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_config_defaults "
+                        "returned -0x%x\n", -ret );
+        goto exit;
+    }
+
+    mbedtls_ssl_conf_rng( &conf, mbedtls_ctr_drbg_random, &ctr_drbg );
+
+    /*
+     * A server certificate is needed for ciphersuite selection at the
+     * end of ClientHello parsing; use the embedded test certificates
+     * so the harness has no file dependencies beyond the corpus.
+     */
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && defined(MBEDTLS_CERTS_C)
+#if defined(MBEDTLS_RSA_C)
+    if( mbedtls_x509_crt_parse( &srvcert,
+                        (const unsigned char *) mbedtls_test_srv_crt_rsa,
+                        mbedtls_test_srv_crt_rsa_len ) == 0 &&
+        mbedtls_pk_parse_key( &pkey,
+                        (const unsigned char *) mbedtls_test_srv_key_rsa,
+                        mbedtls_test_srv_key_rsa_len, NULL, 0 ) == 0 )
+    {
+        mbedtls_ssl_conf_own_cert( &conf, &srvcert, &pkey );
+    }
+#else
+    if( mbedtls_x509_crt_parse( &srvcert,
+                        (const unsigned char *) mbedtls_test_srv_crt_ec,
+                        mbedtls_test_srv_crt_ec_len ) == 0 &&
+        mbedtls_pk_parse_key( &pkey,
+                        (const unsigned char *) mbedtls_test_srv_key_ec,
+                        mbedtls_test_srv_key_ec_len, NULL, 0 ) == 0 )
+    {
+        mbedtls_ssl_conf_own_cert( &conf, &srvcert, &pkey );
+    }
+#endif
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_CERTS_C */
+
+    if( ( ret = mbedtls_ssl_setup( &ssl, &conf ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_setup returned -0x%x\n",
+                        -ret );
+        goto exit;
+    }
+
+    if( stat( opt.corpus, &sb ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! cannot stat '%s'\n", opt.corpus );
+        ret = 1;
+        goto exit;
+    }
+
+    mbedtls_printf( "\n  . Replaying '%s', %d iterations per flight\n\n",
+                    opt.corpus, opt.iterations );
+
+    (void) mbedtls_timing_get_timer( &run_timer, 1 );
+    cycles_start = mbedtls_timing_hardclock();
+
+    /*
+     * Calibrate the cycle counter against the wallclock timer so the
+     * per-hello figures can be reported in microseconds. 100ms of
+     * spinning keeps the calibration error well under the variation
+     * between corpus entries.
+     */
+    while( mbedtls_timing_get_timer( &run_timer, 0 ) < 100 )
+        ;
+
+    elapsed_ms = mbedtls_timing_get_timer( &run_timer, 0 );
+    cycles_per_us = ( mbedtls_timing_hardclock() - cycles_start )
+                        / ( elapsed_ms * 1000 );
+    if( cycles_per_us == 0 )
+        cycles_per_us = 1;
+
+    (void) mbedtls_timing_get_timer( &run_timer, 1 );
+
+    if( S_ISDIR( sb.st_mode ) )
+    {
+        DIR *dir;
+        struct dirent *entry;
+        char path[512];
+
+        if( ( dir = opendir( opt.corpus ) ) == NULL )
+        {
+            mbedtls_printf( " failed\n  ! cannot open '%s'\n", opt.corpus );
+            ret = 1;
+            goto exit;
+        }
+
+        while( ( entry = readdir( dir ) ) != NULL )
+        {
+            if( entry->d_name[0] == '.' )
+                continue;
+
+            mbedtls_snprintf( path, sizeof( path ), "%s/%s",
+                              opt.corpus, entry->d_name );
+
+            if( stat( path, &sb ) != 0 || ! S_ISREG( sb.st_mode ) )
+                continue;
+
+            if( replay_path( &ssl, path, entry->d_name,
+                             cycles_per_us, &total_hellos ) != 0 )
+                break;
+        }
+
+        closedir( dir );
+    }
+    else
+    {
+        replay_path( &ssl, opt.corpus, opt.corpus,
+                     cycles_per_us, &total_hellos );
+    }
+
+    elapsed_ms = mbedtls_timing_get_timer( &run_timer, 0 );
+    if( elapsed_ms == 0 )
+        elapsed_ms = 1;
+
+    mbedtls_printf( "\n  total: %lu hellos in %lu.%03lu s (%lu/s)\n\n",
+                    total_hellos, elapsed_ms / 1000, elapsed_ms % 1000,
+                    total_hellos * 1000 / elapsed_ms );
+
+    ret = 0;
+
+exit:
+    mbedtls_ssl_free( &ssl );
+    mbedtls_ssl_config_free( &conf );
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    mbedtls_x509_crt_free( &srvcert );
+    mbedtls_pk_free( &pkey );
+#endif
+    mbedtls_ctr_drbg_free( &ctr_drbg );
+    mbedtls_entropy_free( &entropy );
+
+    return( ret );
+}
+#endif /* MBEDTLS_SSL_TLS_C && MBEDTLS_SSL_SRV_C && MBEDTLS_TIMING_C &&
+          MBEDTLS_FS_IO && MBEDTLS_ENTROPY_C && MBEDTLS_CTR_DRBG_C */
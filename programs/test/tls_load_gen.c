@@ -0,0 +1,466 @@
+/*
+ *  TLS handshake load generator
+ *
+ *  Copyright (C) 2006-2016, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc     calloc
+#define mbedtls_free       free
+#define mbedtls_printf     printf
+#endif
+
+#if !defined(MBEDTLS_SSL_TLS_C) || !defined(MBEDTLS_SSL_CLI_C) ||   \
+    !defined(MBEDTLS_NET_C) || !defined(MBEDTLS_TIMING_C) ||        \
+    !defined(MBEDTLS_ENTROPY_C) || !defined(MBEDTLS_CTR_DRBG_C)
+int main( void )
+{
+    mbedtls_printf("MBEDTLS_SSL_TLS_C and/or MBEDTLS_SSL_CLI_C and/or "
+           "MBEDTLS_NET_C and/or MBEDTLS_TIMING_C and/or "
+           "MBEDTLS_ENTROPY_C and/or MBEDTLS_CTR_DRBG_C not defined.\n");
+    return( 0 );
+}
+#else
+
+#include "mbedtls/net.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/error.h"
+#include "mbedtls/timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DFL_SERVER_NAME         "localhost"
+#define DFL_SERVER_ADDR         NULL
+#define DFL_SERVER_PORT         "4433"
+#define DFL_CONCURRENCY         64
+#define DFL_DURATION            10
+#define DFL_RESUME_PERCENT      0
+#define DFL_FORCE_CIPHER        0
+
+#define MAX_CONCURRENCY         10000
+#define MAX_LAT_SAMPLES         65536
+
+#define USAGE \
+    "\n usage: tls_load_gen param=<>...\n"                              \
+    "\n acceptable parameters:\n"                                       \
+    "    server_name=%%s      default: localhost\n"                     \
+    "    server_addr=%%s      default: given by name\n"                 \
+    "    server_port=%%d      default: 4433\n"                          \
+    "    concurrency=%%d      handshakes in flight, default: 64\n"      \
+    "    duration=%%d         seconds to run, default: 10\n"            \
+    "    resume=%%d           percent of handshakes using session\n"    \
+    "                        resumption, default: 0\n"                  \
+    "    force_ciphersuite=<name>    default: all enabled\n"            \
+    " acceptable ciphersuite names:\n"
+
+/*
+ * global options
+ */
+static struct options
+{
+    const char *server_name;    /* hostname of the server (client only)     */
+    const char *server_addr;    /* address of the server (client only)      */
+    const char *server_port;    /* port on which the ssl service runs       */
+    int concurrency;            /* number of handshakes kept in flight      */
+    int duration;               /* how long to run, in seconds              */
+    int resume_percent;         /* percentage of resumed handshakes         */
+    int force_ciphersuite[2];   /* protocol/ciphersuite to use, or all      */
+} opt;
+
+/*
+ * One in-flight connection. Connections are recycled for the whole run:
+ * as soon as a handshake completes (or fails) the slot is torn down and
+ * a fresh connection is started.
+ */
+typedef enum
+{
+    CONN_IDLE = 0,      /* slot free, start a new connection            */
+    CONN_CONNECTING,    /* TCP connect in progress                      */
+    CONN_HANDSHAKING,   /* TLS handshake in progress                    */
+} conn_state;
+
+typedef struct
+{
+    conn_state state;
+    mbedtls_net_context net;
+    mbedtls_ssl_context ssl;
+    unsigned long start;        /* hardclock() at handshake start       */
+    int resumed;                /* this attempt carries a saved session */
+} connection;
+
+/*
+ * Handshake latency samples, in hardclock() units; converted to
+ * microseconds at the end using the cycle rate observed over the run.
+ */
+static unsigned long lat_samples[MAX_LAT_SAMPLES];
+static size_t lat_count;
+
+static void lat_record( unsigned long cycles )
+{
+    if( lat_count < MAX_LAT_SAMPLES )
+        lat_samples[lat_count] = cycles;
+    lat_count++;
+}
+
+static int lat_cmp( const void *a, const void *b )
+{
+    unsigned long la = *(const unsigned long *) a;
+    unsigned long lb = *(const unsigned long *) b;
+
+    return( la < lb ? -1 : la > lb );
+}
+
+static unsigned long lat_percentile( unsigned q )
+{
+    size_t n = lat_count < MAX_LAT_SAMPLES ? lat_count : MAX_LAT_SAMPLES;
+
+    if( n == 0 )
+        return( 0 );
+
+    return( lat_samples[ ( n - 1 ) * q / 1000 ] );
+}
+
+int main( int argc, char *argv[] )
+{
+    int ret = 0, i;
+    const char *pers = "tls_load_gen";
+    char *p, *q;
+
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_ssl_config conf;
+    mbedtls_ssl_session saved_session;
+    connection *conns = NULL;
+
+    int have_session = 0;
+    unsigned long full_done = 0, resumed_done = 0, failed = 0;
+    unsigned long hs_counter = 0;
+    unsigned long cycles_start, cycles_total;
+    unsigned long elapsed_ms, cycles_per_us;
+    struct mbedtls_timing_hr_time run_timer;
+
+    mbedtls_entropy_init( &entropy );
+    mbedtls_ctr_drbg_init( &ctr_drbg );
+    mbedtls_ssl_config_init( &conf );
+    memset( &saved_session, 0, sizeof( mbedtls_ssl_session ) );
+
+    opt.server_name         = DFL_SERVER_NAME;
+    opt.server_addr         = DFL_SERVER_ADDR;
+    opt.server_port         = DFL_SERVER_PORT;
+    opt.concurrency         = DFL_CONCURRENCY;
+    opt.duration            = DFL_DURATION;
+    opt.resume_percent      = DFL_RESUME_PERCENT;
+    opt.force_ciphersuite[0] = DFL_FORCE_CIPHER;
+
+    for( i = 1; i < argc; i++ )
+    {
+        p = argv[i];
+        if( ( q = strchr( p, '=' ) ) == NULL )
+            goto usage;
+        *q++ = '\0';
+
+        if( strcmp( p, "server_name" ) == 0 )
+            opt.server_name = q;
+        else if( strcmp( p, "server_addr" ) == 0 )
+            opt.server_addr = q;
+        else if( strcmp( p, "server_port" ) == 0 )
+            opt.server_port = q;
+        else if( strcmp( p, "concurrency" ) == 0 )
+        {
+            opt.concurrency = atoi( q );
+            if( opt.concurrency < 1 || opt.concurrency > MAX_CONCURRENCY )
+                goto usage;
+        }
+        else if( strcmp( p, "duration" ) == 0 )
+        {
+            opt.duration = atoi( q );
+            if( opt.duration < 1 || opt.duration > 86400 )
+                goto usage;
+        }
+        else if( strcmp( p, "resume" ) == 0 )
+        {
+            opt.resume_percent = atoi( q );
+            if( opt.resume_percent < 0 || opt.resume_percent > 100 )
+                goto usage;
+        }
+        else if( strcmp( p, "force_ciphersuite" ) == 0 )
+        {
+            opt.force_ciphersuite[0] = mbedtls_ssl_get_ciphersuite_id( q );
+            if( opt.force_ciphersuite[0] == 0 )
+                goto usage;
+            opt.force_ciphersuite[1] = 0;
+        }
+        else
+        {
+usage:
+            mbedtls_printf( USAGE );
+
+            {
+                const int *list = mbedtls_ssl_list_ciphersuites();
+                while( *list )
+                {
+                    mbedtls_printf("    %s\n",
+                            mbedtls_ssl_get_ciphersuite_name( *list ) );
+                    list++;
+                }
+            }
+            ret = 1;
+            goto exit;
+        }
+    }
+
+    if( opt.server_addr == NULL )
+        opt.server_addr = opt.server_name;
+
+    /*
+     * Shared configuration for all connections
+     */
+    if( ( ret = mbedtls_ctr_drbg_seed( &ctr_drbg, mbedtls_entropy_func,
+                                       &entropy, (const unsigned char *) pers,
+                                       strlen( pers ) ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ctr_drbg_seed returned -0x%x\n",
+                        -ret );
+        goto exit;
+    }
+
+    if( ( ret = mbedtls_ssl_config_defaults( &conf, MBEDTLS_SSL_IS_CLIENT,
+                                             MBEDTLS_SSL_TRANSPORT_STREAM,
+                                             MBEDTLS_SSL_PRESET_DEFAULT ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  ! mbedtls_ssl_config_defaults "
+                        "returned -0x%x\n", -ret );
+        goto exit;
+    }
+
+    /* We are measuring the server, not authenticating it */
+    mbedtls_ssl_conf_authmode( &conf, MBEDTLS_SSL_VERIFY_NONE );
+    mbedtls_ssl_conf_rng( &conf, mbedtls_ctr_drbg_random, &ctr_drbg );
+
+    if( opt.force_ciphersuite[0] != DFL_FORCE_CIPHER )
+        mbedtls_ssl_conf_ciphersuites( &conf, opt.force_ciphersuite );
+
+    if( ( conns = mbedtls_calloc( opt.concurrency,
+                                  sizeof( connection ) ) ) == NULL )
+    {
+        mbedtls_printf( " failed\n  ! alloc of %d connections failed\n",
+                        opt.concurrency );
+        ret = 1;
+        goto exit;
+    }
+
+    for( i = 0; i < opt.concurrency; i++ )
+    {
+        mbedtls_net_init( &conns[i].net );
+        mbedtls_ssl_init( &conns[i].ssl );
+
+        if( ( ret = mbedtls_ssl_setup( &conns[i].ssl, &conf ) ) != 0 )
+        {
+            mbedtls_printf( " failed\n  ! mbedtls_ssl_setup "
+                            "returned -0x%x\n", -ret );
+            goto exit;
+        }
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+        if( ( ret = mbedtls_ssl_set_hostname( &conns[i].ssl,
+                                              opt.server_name ) ) != 0 )
+        {
+            mbedtls_printf( " failed\n  ! mbedtls_ssl_set_hostname "
+                            "returned -0x%x\n", -ret );
+            goto exit;
+        }
+#endif
+    }
+
+    mbedtls_printf( "\n  . Driving %d concurrent handshakes against "
+                    "%s:%s for %d seconds (%d%% resumed)\n",
+                    opt.concurrency, opt.server_addr, opt.server_port,
+                    opt.duration, opt.resume_percent );
+    fflush( stdout );
+
+    (void) mbedtls_timing_get_timer( &run_timer, 1 );
+    cycles_start = mbedtls_timing_hardclock();
+
+    while( ( elapsed_ms = mbedtls_timing_get_timer( &run_timer, 0 ) )
+                < (unsigned long) opt.duration * 1000 )
+    {
+        int progress = 0;
+
+        for( i = 0; i < opt.concurrency; i++ )
+        {
+            connection *c = &conns[i];
+
+            if( c->state == CONN_IDLE )
+            {
+                /* Deterministic full/resumed interleaving gives the exact
+                 * requested mix regardless of completion order */
+                c->resumed = have_session &&
+                    (int)( hs_counter++ % 100 ) < opt.resume_percent;
+
+                c->start = mbedtls_timing_hardclock();
+
+                ret = mbedtls_net_connect_start( &c->net, opt.server_addr,
+                                                 opt.server_port,
+                                                 MBEDTLS_NET_PROTO_TCP );
+                if( ret != 0 && ret != MBEDTLS_ERR_SSL_WANT_WRITE )
+                {
+                    failed++;
+                    mbedtls_net_free( &c->net );
+                    continue;
+                }
+
+                mbedtls_ssl_set_bio( &c->ssl, &c->net, mbedtls_net_send,
+                                     mbedtls_net_recv, NULL );
+
+                if( c->resumed &&
+                    mbedtls_ssl_set_session( &c->ssl, &saved_session ) != 0 )
+                    c->resumed = 0;
+
+                c->state = ret == 0 ? CONN_HANDSHAKING : CONN_CONNECTING;
+                progress = 1;
+            }
+
+            if( c->state == CONN_CONNECTING )
+            {
+                ret = mbedtls_net_connect_finish( &c->net );
+                if( ret == MBEDTLS_ERR_SSL_WANT_WRITE )
+                    continue;
+
+                if( ret != 0 )
+                {
+                    failed++;
+                    goto reset;
+                }
+
+                c->state = CONN_HANDSHAKING;
+                progress = 1;
+            }
+
+            ret = mbedtls_ssl_handshake( &c->ssl );
+
+            if( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+                ret == MBEDTLS_ERR_SSL_WANT_WRITE )
+                continue;
+
+            progress = 1;
+
+            if( ret != 0 )
+            {
+                failed++;
+                goto reset;
+            }
+
+            /*
+             * Handshake complete
+             */
+            lat_record( mbedtls_timing_hardclock() - c->start );
+
+            if( c->resumed )
+                resumed_done++;
+            else
+            {
+                full_done++;
+
+                /* Keep the most recent full-handshake session around for
+                 * the resumed share of the mix */
+                mbedtls_ssl_session_free( &saved_session );
+                if( mbedtls_ssl_get_session( &c->ssl, &saved_session ) == 0 )
+                    have_session = 1;
+                else
+                    have_session = 0;
+            }
+
+            mbedtls_ssl_close_notify( &c->ssl );
+
+reset:
+            mbedtls_net_free( &c->net );
+            mbedtls_ssl_session_reset( &c->ssl );
+            c->state = CONN_IDLE;
+        }
+
+        /* All in-flight handshakes are waiting on the network */
+        if( ! progress )
+            mbedtls_net_usleep( 1000 );
+    }
+
+    cycles_total = mbedtls_timing_hardclock() - cycles_start;
+    elapsed_ms = mbedtls_timing_get_timer( &run_timer, 0 );
+    if( elapsed_ms == 0 )
+        elapsed_ms = 1;
+    cycles_per_us = cycles_total / ( elapsed_ms * 1000 );
+    if( cycles_per_us == 0 )
+        cycles_per_us = 1;
+
+    {
+        size_t n = lat_count < MAX_LAT_SAMPLES ? lat_count : MAX_LAT_SAMPLES;
+        qsort( lat_samples, n, sizeof( lat_samples[0] ), lat_cmp );
+    }
+
+    mbedtls_printf( "\n"
+            "  full handshakes      : %10lu  (%lu/s)\n"
+            "  resumed handshakes   : %10lu  (%lu/s)\n"
+            "  failed attempts      : %10lu\n"
+            "  latency p50/p99/p999 : %lu/%lu/%lu us\n\n",
+            full_done,    full_done    * 1000 / elapsed_ms,
+            resumed_done, resumed_done * 1000 / elapsed_ms,
+            failed,
+            lat_percentile( 500 ) / cycles_per_us,
+            lat_percentile( 990 ) / cycles_per_us,
+            lat_percentile( 999 ) / cycles_per_us );
+
+    if( lat_count > MAX_LAT_SAMPLES )
+        mbedtls_printf( "  (percentiles from the first %d of %lu handshakes)\n",
+                        MAX_LAT_SAMPLES, (unsigned long) lat_count );
+
+    ret = 0;
+
+exit:
+    if( conns != NULL )
+    {
+        for( i = 0; i < opt.concurrency; i++ )
+        {
+            mbedtls_net_free( &conns[i].net );
+            mbedtls_ssl_free( &conns[i].ssl );
+        }
+        mbedtls_free( conns );
+    }
+
+    mbedtls_ssl_session_free( &saved_session );
+    mbedtls_ssl_config_free( &conf );
+    mbedtls_ctr_drbg_free( &ctr_drbg );
+    mbedtls_entropy_free( &entropy );
+
+    return( ret );
+}
+#endif /* MBEDTLS_SSL_TLS_C && MBEDTLS_SSL_CLI_C && MBEDTLS_NET_C &&
+          MBEDTLS_TIMING_C && MBEDTLS_ENTROPY_C && MBEDTLS_CTR_DRBG_C */
@@ -26,6 +26,11 @@
  * example of good general usage.
  */
 
+/* recvmmsg()/sendmmsg() need _GNU_SOURCE before the first libc header */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #if !defined(MBEDTLS_CONFIG_FILE)
 #include "mbedtls/config.h"
 #else
@@ -79,6 +84,12 @@ int main( void )
 #include <sys/time.h>
 #endif
 
+/* For recvmmsg()/sendmmsg() in the batched forwarding mode */
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 #define MAX_MSG_SIZE            16384 + 2048 /* max record/datagram size */
 
 #define DFL_SERVER_ADDR         "localhost"
@@ -107,6 +118,12 @@ int main( void )
     "    protect_hvr=0/1     default: 0 (don't protect HelloVerifyRequest)\n" \
     "    protect_len=%%d     default: (don't protect packets of this size)\n" \
     "\n"                                                                    \
+    "    perf=0/1            default: 0 (log each packet)\n"                \
+    "                        batch packets with recvmmsg()/sendmmsg() and\n"\
+    "                        only print periodic counters; drop, delay,\n"  \
+    "                        duplicate and mtu still apply, bad_ad does\n"  \
+    "                        not (Linux only, ignored elsewhere)\n"         \
+    "\n"                                                                    \
     "    seed=%%d             default: (use current time)\n"                \
     "\n"
 
@@ -128,6 +145,7 @@ static struct options
     int bad_ad;                 /* inject corrupted ApplicationData record  */
     int protect_hvr;            /* never drop or delay HelloVerifyRequest   */
     int protect_len;            /* never drop/delay packet of the given size*/
+    int perf;                   /* batch packets, skip per-packet logging   */
 
     unsigned int seed;          /* seed for "random" events                 */
 } opt;
@@ -217,6 +235,12 @@ static void get_options( int argc, char *argv[] )
             if( opt.protect_len < 0 )
                 exit_usage( p, q );
         }
+        else if( strcmp( p, "perf" ) == 0 )
+        {
+            opt.perf = atoi( q );
+            if( opt.perf < 0 || opt.perf > 1 )
+                exit_usage( p, q );
+        }
         else if( strcmp( p, "seed" ) == 0 )
         {
             opt.seed = atoi( q );
@@ -374,17 +398,17 @@ static unsigned char dropped[2048] = { 0 };
  * OpenSSL groups packets in a datagram the first time it sends them, but not
  * when it resends them. Count every record as seen the first time.
  */
-void update_dropped( const packet *p )
+void update_dropped( const unsigned char *buf, size_t plen )
 {
-    size_t id = p->len % sizeof( dropped );
-    const unsigned char *end = p->buf + p->len;
-    const unsigned char *cur = p->buf;
+    size_t id = plen % sizeof( dropped );
+    const unsigned char *end = buf + plen;
+    const unsigned char *cur = buf;
     size_t len = ( ( cur[11] << 8 ) | cur[12] ) + 13;
 
     ++dropped[id];
 
     /* Avoid counting single record twice */
-    if( len == p->len )
+    if( len == plen )
         return;
 
     while( cur < end )
@@ -432,7 +456,7 @@ int handle_message( const char *way,
           dropped[id] < DROP_MAX &&
           rand() % opt.drop == 0 ) )
     {
-        update_dropped( &cur );
+        update_dropped( cur.buf, cur.len );
     }
     else if( ( opt.delay_ccs == 1 &&
                strcmp( cur.type, "ChangeCipherSpec" ) == 0 ) ||
@@ -466,6 +490,153 @@ int handle_message( const char *way,
     return( 0 );
 }
 
+#if defined(__linux__)
+/*
+ * Batched forwarding for perf=1. Datagrams are received straight into a
+ * static pool of buffers with one recvmmsg() call and the kept ones are
+ * forwarded from those same buffers with one sendmmsg() call, so the
+ * proxy never copies or logs a packet on the fast path and stops being
+ * the bottleneck when soak-testing DTLS under load. Drop, delay,
+ * duplicate and mtu decisions are the same as in handle_message();
+ * bad_ad is not applied (it needs a modified copy).
+ */
+#define PROXY_BATCH     32
+#define DELAY_RING_LEN   8
+
+static unsigned char batch_buf[PROXY_BATCH][MAX_MSG_SIZE];
+
+static packet delay_ring[DELAY_RING_LEN];
+static unsigned delay_cnt = 0;
+
+static unsigned long stat_rx = 0, stat_fwd = 0, stat_drop = 0,
+                     stat_dup = 0, stat_delay = 0;
+
+int handle_message_batch( const char *way,
+                          mbedtls_net_context *dst,
+                          mbedtls_net_context *src )
+{
+    struct mmsghdr in_msgs[PROXY_BATCH], out_msgs[PROXY_BATCH * 2];
+    struct iovec in_iov[PROXY_BATCH], out_iov[PROXY_BATCH * 2];
+    int i, n, n_out = 0, sent;
+    unsigned len;
+    const char *type;
+    size_t id;
+    ((void) way);
+
+    memset( in_msgs, 0, sizeof( in_msgs ) );
+    for( i = 0; i < PROXY_BATCH; i++ )
+    {
+        in_iov[i].iov_base = batch_buf[i];
+        in_iov[i].iov_len  = MAX_MSG_SIZE;
+        in_msgs[i].msg_hdr.msg_iov = &in_iov[i];
+        in_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    n = recvmmsg( src->fd, in_msgs, PROXY_BATCH, MSG_DONTWAIT, NULL );
+    if( n < 0 )
+    {
+        if( errno == EAGAIN || errno == EWOULDBLOCK )
+            return( 0 );
+
+        mbedtls_printf( "  ! recvmmsg failed\n" );
+        return( -1 );
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        len  = in_msgs[i].msg_len;
+        type = msg_type( batch_buf[i], len );
+        id   = len % sizeof( dropped );
+        stat_rx++;
+
+        if( ( opt.mtu != 0 &&
+              len > (unsigned) opt.mtu ) ||
+            ( opt.drop != 0 &&
+              strcmp( type, "ApplicationData" ) != 0 &&
+              ! ( opt.protect_hvr &&
+                  strcmp( type, "HelloVerifyRequest" ) == 0 ) &&
+              len != (size_t) opt.protect_len &&
+              dropped[id] < DROP_MAX &&
+              rand() % opt.drop == 0 ) )
+        {
+            update_dropped( batch_buf[i], len );
+            stat_drop++;
+            continue;
+        }
+
+        if( ( ( opt.delay_ccs == 1 &&
+                strcmp( type, "ChangeCipherSpec" ) == 0 ) ||
+              ( opt.delay != 0 &&
+                strcmp( type, "ApplicationData" ) != 0 &&
+                ! ( opt.protect_hvr &&
+                    strcmp( type, "HelloVerifyRequest" ) == 0 ) &&
+                len != (size_t) opt.protect_len &&
+                dropped[id] < DROP_MAX &&
+                rand() % opt.delay == 0 ) ) &&
+            delay_cnt < DELAY_RING_LEN )
+        {
+            /* the pool buffer is reused next batch, delayed packets are
+             * the one case that still needs a copy */
+            memcpy( delay_ring[delay_cnt].buf, batch_buf[i], len );
+            delay_ring[delay_cnt].len = len;
+            delay_ring[delay_cnt].dst = dst;
+            delay_cnt++;
+            stat_delay++;
+            continue;
+        }
+
+        out_iov[n_out].iov_base = batch_buf[i];
+        out_iov[n_out].iov_len  = len;
+        memset( &out_msgs[n_out], 0, sizeof( out_msgs[n_out] ) );
+        out_msgs[n_out].msg_hdr.msg_iov = &out_iov[n_out];
+        out_msgs[n_out].msg_hdr.msg_iovlen = 1;
+        n_out++;
+
+        if( opt.duplicate != 0 &&
+            strcmp( type, "ApplicationData" ) != 0 &&
+            rand() % opt.duplicate == 0 )
+        {
+            out_iov[n_out] = out_iov[n_out - 1];
+            memset( &out_msgs[n_out], 0, sizeof( out_msgs[n_out] ) );
+            out_msgs[n_out].msg_hdr.msg_iov = &out_iov[n_out];
+            out_msgs[n_out].msg_hdr.msg_iovlen = 1;
+            n_out++;
+            stat_dup++;
+        }
+    }
+
+    if( n_out > 0 )
+    {
+        sent = sendmmsg( dst->fd, out_msgs, n_out, 0 );
+        if( sent < 0 )
+        {
+            mbedtls_printf( "  ! sendmmsg failed\n" );
+            return( -1 );
+        }
+        stat_fwd += sent;
+
+        /* release delayed packets, reordered behind this batch */
+        for( i = 0; i < (int) delay_cnt; i++ )
+        {
+            if( mbedtls_net_send( delay_ring[i].dst, delay_ring[i].buf,
+                                  delay_ring[i].len ) <= 0 )
+                return( -1 );
+            stat_fwd++;
+        }
+        delay_cnt = 0;
+    }
+
+    if( stat_rx % 65536 < (unsigned long) n )
+    {
+        mbedtls_printf( "  proxy: rx %lu fwd %lu drop %lu dup %lu delay %lu\n",
+                        stat_rx, stat_fwd, stat_drop, stat_dup, stat_delay );
+        fflush( stdout );
+    }
+
+    return( 0 );
+}
+#endif /* __linux__ */
+
 int main( int argc, char *argv[] )
 {
     int ret;
@@ -552,6 +723,9 @@ accept:
      */
     clear_pending();
     memset( dropped, 0, sizeof( dropped ) );
+#if defined(__linux__)
+    delay_cnt = 0;
+#endif
 
     nb_fds = client_fd.fd;
     if( nb_fds < server_fd.fd )
@@ -578,15 +752,29 @@ accept:
 
         if( FD_ISSET( client_fd.fd, &read_fds ) )
         {
-            if( ( ret = handle_message( "S <- C",
-                                        &server_fd, &client_fd ) ) != 0 )
+#if defined(__linux__)
+            if( opt.perf )
+                ret = handle_message_batch( "S <- C",
+                                            &server_fd, &client_fd );
+            else
+#endif
+                ret = handle_message( "S <- C",
+                                      &server_fd, &client_fd );
+            if( ret != 0 )
                 goto accept;
         }
 
         if( FD_ISSET( server_fd.fd, &read_fds ) )
         {
-            if( ( ret = handle_message( "S -> C",
-                                        &client_fd, &server_fd ) ) != 0 )
+#if defined(__linux__)
+            if( opt.perf )
+                ret = handle_message_batch( "S -> C",
+                                            &client_fd, &server_fd );
+            else
+#endif
+                ret = handle_message( "S -> C",
+                                      &client_fd, &server_fd );
+            if( ret != 0 )
                 goto accept;
         }
     }
@@ -0,0 +1,165 @@
+/*
+ *  Pack certificates into a single bundle image with a subject index
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#define mbedtls_printf     printf
+#endif
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && defined(MBEDTLS_X509_TRUST_C) && \
+    defined(MBEDTLS_FS_IO)
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/x509_trust.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#define USAGE \
+    "\n usage: crt_pack <output_file> <cert_file>...\n"                 \
+    "\n Packs the given certificate files (PEM or DER) into a single\n" \
+    " bundle image loadable with mbedtls_x509_crt_parse_packed() or\n"  \
+    " mbedtls_x509_trust_attach_packed(). Pass a shell glob such as\n"  \
+    " certs/*.crt to pack a directory.\n\n"
+
+#if !defined(MBEDTLS_X509_CRT_PARSE_C) || !defined(MBEDTLS_X509_TRUST_C) || \
+    !defined(MBEDTLS_FS_IO)
+int main( void )
+{
+    mbedtls_printf( "MBEDTLS_X509_CRT_PARSE_C and/or MBEDTLS_X509_TRUST_C "
+                    "and/or MBEDTLS_FS_IO not defined.\n" );
+    return( 0 );
+}
+#else
+
+static void put_uint32_be( unsigned char *p, size_t x )
+{
+    p[0] = (unsigned char)( x >> 24 );
+    p[1] = (unsigned char)( x >> 16 );
+    p[2] = (unsigned char)( x >>  8 );
+    p[3] = (unsigned char)( x       );
+}
+
+int main( int argc, char *argv[] )
+{
+    int ret = 1;
+    int i;
+    size_t count = 0, offset, total;
+    mbedtls_x509_crt chain;
+    const mbedtls_x509_crt *crt;
+    unsigned char *image = NULL, *p;
+    FILE *f = NULL;
+
+    mbedtls_x509_crt_init( &chain );
+
+    if( argc < 3 )
+    {
+        mbedtls_printf( USAGE );
+        goto exit;
+    }
+
+    /*
+     * Parse every input; the parsed chain keeps each certificate's raw
+     * DER, which is all the image stores
+     */
+    for( i = 2; i < argc; i++ )
+    {
+        if( mbedtls_x509_crt_parse_file( &chain, argv[i] ) != 0 )
+        {
+            mbedtls_printf( " failed\n  !  could not parse %s\n\n", argv[i] );
+            goto exit;
+        }
+    }
+
+    total = MBEDTLS_X509_PACKED_HEADER_LEN;
+    for( crt = &chain; crt != NULL && crt->version != 0; crt = crt->next )
+    {
+        total += MBEDTLS_X509_PACKED_ENTRY_LEN + crt->raw.len;
+        count++;
+    }
+
+    if( count == 0 )
+    {
+        mbedtls_printf( " failed\n  !  no certificates found\n\n" );
+        goto exit;
+    }
+
+    if( ( image = calloc( 1, total ) ) == NULL )
+    {
+        mbedtls_printf( " failed\n  !  out of memory\n\n" );
+        goto exit;
+    }
+
+    memcpy( image, MBEDTLS_X509_PACKED_MAGIC,
+            MBEDTLS_X509_PACKED_MAGIC_LEN );
+    put_uint32_be( image + MBEDTLS_X509_PACKED_MAGIC_LEN, count );
+
+    p = image + MBEDTLS_X509_PACKED_HEADER_LEN;
+    offset = MBEDTLS_X509_PACKED_HEADER_LEN +
+             count * MBEDTLS_X509_PACKED_ENTRY_LEN;
+
+    for( crt = &chain; crt != NULL && crt->version != 0; crt = crt->next )
+    {
+        put_uint32_be( p, offset );
+        put_uint32_be( p + 4, crt->raw.len );
+        put_uint32_be( p + 8,
+                       mbedtls_x509_trust_name_hash( &crt->subject ) );
+        p += MBEDTLS_X509_PACKED_ENTRY_LEN;
+
+        memcpy( image + offset, crt->raw.p, crt->raw.len );
+        offset += crt->raw.len;
+    }
+
+    if( ( f = fopen( argv[1], "wb" ) ) == NULL ||
+        fwrite( image, 1, total, f ) != total )
+    {
+        mbedtls_printf( " failed\n  !  could not write %s\n\n", argv[1] );
+        goto exit;
+    }
+
+    mbedtls_printf( " packed %u certificates into %s (%u bytes)\n",
+                    (unsigned) count, argv[1], (unsigned) total );
+    ret = 0;
+
+exit:
+    if( f != NULL )
+        fclose( f );
+    free( image );
+    mbedtls_x509_crt_free( &chain );
+
+#if defined(_WIN32)
+    mbedtls_printf( "  + Press Enter to exit this program.\n" );
+    fflush( stdout ); getchar();
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_X509_TRUST_C && MBEDTLS_FS_IO */
@@ -24,6 +24,8 @@ if( @ARGV ) {
 }
 
 my $feature_format_file = $data_dir.'/version_features.fmt';
+my $header_format_file = $data_dir.'/version_features_h.fmt';
+my $header_file = $include_dir.'/version_features.h';
 
 my @sections = ( "System support", "mbed TLS modules",
                  "mbed TLS feature support" );
@@ -35,11 +37,16 @@ open(FORMAT_FILE, "$feature_format_file") or die "Opening feature format file '$
 my $feature_format = <FORMAT_FILE>;
 close(FORMAT_FILE);
 
+open(FORMAT_FILE, "$header_format_file") or die "Opening header format file '$header_format_file': $!";
+my $header_format = <FORMAT_FILE>;
+close(FORMAT_FILE);
+
 $/ = $line_separator;
 
 open(CONFIG_H, "$include_dir/config.h") || die("Failure when opening config.h: $!");
 
 my $feature_defines = "";
+my @defines;
 my $in_section = 0;
 
 while (my $line = <CONFIG_H>)
@@ -54,6 +61,7 @@ while (my $line = <CONFIG_H>)
         }
 
         my ($define) = $line =~ /#define (\w+)/;
+        push @defines, $define;
         $feature_defines .= "#if defined(${define})\n";
         $feature_defines .= "    \"${define}\",\n";
         $feature_defines .= "#endif /* ${define} */\n";
@@ -67,8 +75,42 @@ while (my $line = <CONFIG_H>)
     }
 };
 
+# Stable numeric identifiers: every known feature gets one, enabled or not
+my $feature_ids = "";
+foreach my $define (@defines) {
+    my ($id) = $define =~ /^MBEDTLS_(\w+)$/;
+    $feature_ids .= "    MBEDTLS_FEATURE_${id},".
+                    ( ' ' x ( length($id) < 40 ? 40 - length($id) : 1 ) ).
+                    "/**< ${define} */\n";
+}
+
+# One 0/1 macro per feature, then the packed presence bitmap, 8 per byte
+my $feature_bits = "";
+foreach my $define (@defines) {
+    $feature_bits .= "#if defined(${define})\n".
+                     "#define FB_${define} 1\n".
+                     "#else\n".
+                     "#define FB_${define} 0\n".
+                     "#endif\n";
+}
+$feature_bits .= "\nstatic const unsigned char feature_bitmap[] = {\n";
+for (my $i = 0; $i < @defines; $i += 8) {
+    my @byte;
+    for (my $j = 0; $j < 8 && $i + $j < @defines; $j++) {
+        push @byte, "FB_$defines[$i + $j] << $j";
+    }
+    $feature_bits .= "    (unsigned char)( ".join( " |\n                     ", @byte )." ),\n";
+}
+$feature_bits .= "};";
+
 $feature_format =~ s/FEATURE_DEFINES\n/$feature_defines/g;
+$feature_format =~ s/FEATURE_BITS\n/$feature_bits\n/g;
+$header_format =~ s/FEATURE_IDS\n/$feature_ids/g;
 
 open(ERROR_FILE, ">$feature_file") or die "Opening destination file '$feature_file': $!";
 print ERROR_FILE $feature_format;
 close(ERROR_FILE);
+
+open(HEADER_FILE, ">$header_file") or die "Opening destination file '$header_file': $!";
+print HEADER_FILE $header_format;
+close(HEADER_FILE);